@@ -0,0 +1,118 @@
+/* bench_array.c
+	Measures iterating over Blah_Array and Blah_List at 1k, 100k and 1M elements, both through
+	their callWithArg functions and with a loop written out in the caller, as the drawing code
+	does.  Lists are measured freshly built and after churn, where elements have been removed and
+	appended again at random so that neighbouring list elements are no longer neighbours in memory,
+	as in lists which live through many frames.  Prints the best time per element of several passes. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "blah_array.h"
+#include "blah_list.h"
+#include "blah_point.h"
+#include "blah_time.h"
+
+/* Definitions */
+
+#define BENCH_ARRAY_PASS_ELEMENTS 4000000	//Elements visited for each size, over as many passes as it takes
+
+/* Static Functions */
+
+static void bench_array_addX(void *elementData, void *sum)
+{
+	*(double*)sum += ((Blah_Point*)elementData)->x;
+}
+
+static double bench_array_iterateArray(void *container)
+{	//Sums the x coordinates of the points with a loop over the array
+	const Blah_Array *array = container;
+	double sum = 0;
+	for (size_t index = 0; index < array->length; index++) { sum += ((Blah_Point*)array->elements[index])->x; }
+	return sum;
+}
+
+static double bench_array_iterateList(void *container)
+{	//Sums the x coordinates of the points with a loop over the list
+	const Blah_List *list = container;
+	double sum = 0;
+	for (Blah_List_Element *element = list->first; element; element = element->next) { sum += ((Blah_Point*)element->data)->x; }
+	return sum;
+}
+
+static double bench_array_callArray(void *container)
+{
+	double sum = 0;
+	Blah_Array_callWithArg(container, bench_array_addX, &sum);
+	return sum;
+}
+
+static double bench_array_callList(void *container)
+{
+	double sum = 0;
+	Blah_List_callWithArg(container, bench_array_addX, &sum);
+	return sum;
+}
+
+static void bench_array_measure(const char *name, double (*iterate)(void*), void *container, size_t count)
+{	//Prints the best time per element of passes over the container
+	const int passes = (int)(BENCH_ARRAY_PASS_ELEMENTS / count) + 2;
+	uint64_t bestTime = UINT64_MAX;
+	double check = 0;
+
+	for (int pass = 0; pass < passes; pass++) {
+		const uint64_t startTime = blah_time_getNanoseconds();
+		check += iterate(container);
+		const uint64_t elapsed = blah_time_getNanoseconds() - startTime;
+		if (elapsed < bestTime) { bestTime = elapsed; }
+	}
+	printf("%8zu elements  %-26s %7.2f ns per element  (%g)\n", count, name, (double)bestTime / count, check / passes);
+}
+
+static void bench_array_churnList(Blah_List *list, Blah_List_Element **handles, Blah_Point *points, size_t count)
+{	//Removes random elements and appends them again, leaving their order in memory shuffled
+	for (size_t step = 0; step < count; step++) {
+		const size_t index = ((size_t)rand() * RAND_MAX + rand()) % count;
+		Blah_List_removeElementHandle(list, handles[index]);
+		handles[index] = Blah_List_appendElement(list, &points[index]);
+	}
+}
+
+/* Main */
+
+int main()
+{
+	static const size_t counts[] = {1000, 100000, 1000000};
+
+	srand(4);
+	for (size_t sizeIndex = 0; sizeIndex < sizeof(counts) / sizeof(counts[0]); sizeIndex++) {
+		const size_t count = counts[sizeIndex];
+		Blah_Point *points = malloc(count * sizeof(Blah_Point));
+		Blah_List_Element **handles = malloc(count * sizeof(Blah_List_Element*));
+		Blah_Array array;
+		Blah_List list;
+
+		Blah_Array_init(&array, "bench");
+		Blah_List_init(&list, "bench");
+		for (size_t index = 0; index < count; index++) {
+			Blah_Point_set(&points[index], (float)(index & 7), 0, 0);
+			Blah_Array_appendElement(&array, &points[index]);
+			handles[index] = Blah_List_appendElement(&list, &points[index]);
+		}
+
+		bench_array_measure("array loop", bench_array_iterateArray, &array, count);
+		bench_array_measure("array callWithArg", bench_array_callArray, &array, count);
+		bench_array_measure("list loop", bench_array_iterateList, &list, count);
+		bench_array_measure("list callWithArg", bench_array_callList, &list, count);
+		bench_array_churnList(&list, handles, points, count);
+		bench_array_measure("churned list loop", bench_array_iterateList, &list, count);
+		bench_array_measure("churned list callWithArg", bench_array_callList, &list, count);
+
+		Blah_Array_disable(&array);
+		Blah_List_removeAll(&list);
+		free(handles);
+		free(points);
+	}
+	return 0;
+}
@@ -0,0 +1,163 @@
+/* bench_atlas.c
+	Measures packing images of random sizes up to 64 pixels into atlases of two page sizes, printing
+	the pages used, their occupancy and the time to pack and upload them.  Then draws a scene object
+	converted from a model of many small surfaces, each with its own texture, through blah_draw_main,
+	once converted with small textures drawn from the shared atlas and once, the old path, with each
+	texture bound on its own.  Prints the texture changes and draw calls per frame and the best frame
+	time of each.  Drawing is done on an offscreen context, so times are those of the software renderer. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench_video.h"
+#include "blah_atlas.h"
+#include "blah_draw.h"
+#include "blah_model.h"
+#include "blah_object.h"
+#include "blah_scene.h"
+#include "blah_scene_object.h"
+#include "blah_time.h"
+#include "blah_vertex.h"
+
+/* Definitions */
+
+#define BENCH_ATLAS_IMAGES 1000
+#define BENCH_ATLAS_FRAMES 20
+#define BENCH_ATLAS_SURFACES_X 8			//Surfaces along each row of the model
+#define BENCH_ATLAS_SURFACES_Y 4			//Rows of surfaces
+#define BENCH_ATLAS_CELLS 4					//Quadrilaterals along each side of a surface
+#define BENCH_ATLAS_SURFACE_SIDE 1.5f
+#define BENCH_ATLAS_SURFACE_SPACING 2.0f
+
+/* Static Functions */
+
+static Blah_Image *bench_atlas_newImage(const char *name, unsigned int width, unsigned int height)
+{	//Creates a 32 bit image of random pixels
+	Blah_Image *image = Blah_Image_new(name, 32, width, height, BLAH_PIXEL_FORMAT_RGBA);
+	unsigned char *pixels = image->pixelData;
+
+	for (size_t index = 0; index < (size_t)width * height * 4; index++) { pixels[index] = rand(); }
+	return image;
+}
+
+static void bench_atlas_measurePacking(unsigned int pageSize)
+{	//Packs images of random sizes into a new atlas, printing its occupancy
+	Blah_Atlas *atlas = Blah_Atlas_new("bench", pageSize);
+	Blah_Image *images[BENCH_ATLAS_IMAGES];
+	Blah_Atlas_Stats stats;
+	uint64_t startTime, packTime;
+
+	srand(1);
+	for (int index = 0; index < BENCH_ATLAS_IMAGES; index++) {
+		char name[16];
+		snprintf(name, sizeof(name), "image%d", index);
+		images[index] = bench_atlas_newImage(name, 4 + rand() % 61, 4 + rand() % 61);
+	}
+	startTime = blah_time_getNanoseconds();
+	for (int index = 0; index < BENCH_ATLAS_IMAGES; index++) { Blah_Atlas_addImage(atlas, images[index]); }
+	packTime = blah_time_getNanoseconds() - startTime;
+	Blah_Atlas_update(atlas);
+	bench_video_finish();
+	Blah_Atlas_getStats(atlas, &stats);
+	printf("%4u pages  %4u entries on %2u pages  %5.1f%% occupied  pack %7.3f ms  pack and upload %7.3f ms\n", pageSize, stats.entries,
+		stats.pages, 100.0 * stats.usedPixels / stats.pagePixels, packTime / 1e6, (blah_time_getNanoseconds() - startTime) / 1e6);
+
+	for (int index = 0; index < BENCH_ATLAS_IMAGES; index++) { Blah_Image_destroy(images[index]); }
+	Blah_Atlas_destroy(atlas);
+}
+
+static Blah_Model *bench_atlas_newModel()
+{	//Creates a model of square surfaces in rows, each of a grid of quadrilaterals with its own texture projected over it
+	Blah_Model *model = Blah_Model_new("bench");
+	int numVertices = 0;
+
+	srand(2);
+	for (int surfaceIndex = 0; surfaceIndex < BENCH_ATLAS_SURFACES_X * BENCH_ATLAS_SURFACES_Y; surfaceIndex++) {
+		const float left = (surfaceIndex % BENCH_ATLAS_SURFACES_X) * BENCH_ATLAS_SURFACE_SPACING;
+		const float bottom = (surfaceIndex / BENCH_ATLAS_SURFACES_X) * BENCH_ATLAS_SURFACE_SPACING;
+		const float step = BENCH_ATLAS_SURFACE_SIDE / BENCH_ATLAS_CELLS;
+		const unsigned int textureSide = 32 << (surfaceIndex & 1);
+		char name[16];
+
+		snprintf(name, sizeof(name), "surface%d", surfaceIndex);
+		Blah_Model_Surface *surface = Blah_Model_Surface_new(name);
+		Blah_Image *image = bench_atlas_newImage(name, textureSide, textureSide);
+		Blah_Model_Texture_Map *map = Blah_Model_Texture_Map_new(Blah_Texture_fromImage(image), 'z', BLAH_MODEL_TEXTURE_PROJECTION_PLANAR);
+		Blah_Image_destroy(image);
+		Blah_Model_Texture_Map_setSize(map, BENCH_ATLAS_SURFACE_SIDE, BENCH_ATLAS_SURFACE_SIDE, 1);
+		Blah_Model_Texture_Map_setCenter(map, left + BENCH_ATLAS_SURFACE_SIDE / 2, bottom + BENCH_ATLAS_SURFACE_SIDE / 2, 0);
+		Blah_Model_Surface_addTexture(surface, map);
+		Blah_Model_addSurface(model, surface);
+
+		for (int row = 0; row <= BENCH_ATLAS_CELLS; row++) {
+			for (int column = 0; column <= BENCH_ATLAS_CELLS; column++) {
+				Blah_Model_addVertex(model, Blah_Vertex_new(left + column * step, bottom + row * step, 0));
+			}
+		}
+		for (int row = 0; row < BENCH_ATLAS_CELLS; row++) {
+			for (int column = 0; column < BENCH_ATLAS_CELLS; column++) {
+				const int corner = numVertices + row * (BENCH_ATLAS_CELLS + 1) + column;
+				Blah_Model_Face *face = Blah_Model_Face_new();
+				Blah_Model_Face_addIndex(face, corner);
+				Blah_Model_Face_addIndex(face, corner + 1);
+				Blah_Model_Face_addIndex(face, corner + BENCH_ATLAS_CELLS + 2);
+				Blah_Model_Face_addIndex(face, corner + BENCH_ATLAS_CELLS + 1);
+				face->surface = surfaceIndex + 1;
+				Blah_Model_addFace(model, face);
+				Blah_Model_Surface_addFace(surface, face);
+			}
+		}
+		numVertices += (BENCH_ATLAS_CELLS + 1) * (BENCH_ATLAS_CELLS + 1);
+	}
+	return model;
+}
+
+static void bench_atlas_measureDrawing(Blah_Model *model, bool atlasTextures)
+{	//Draws a scene of the model's object, converted with or without the shared atlas
+	uint64_t bestTime = UINT64_MAX;
+	Blah_Draw_Stats stats;
+	Blah_Scene scene;
+
+	blah_object_setAtlasTextures(atlasTextures);
+	Blah_Scene_init(&scene);
+	Blah_Scene_addSceneObject(&scene, Blah_Scene_Object_new("bench", Blah_Object_fromModel(model)));
+	blah_draw_setCurrentScene(&scene);
+	blah_draw_main(); //Compiles the object
+	for (int frame = 0; frame < BENCH_ATLAS_FRAMES; frame++) {
+		const uint64_t startTime = blah_time_getNanoseconds();
+		blah_draw_main();
+		bench_video_finish();
+		const uint64_t elapsed = blah_time_getNanoseconds() - startTime;
+		if (elapsed < bestTime) { bestTime = elapsed; }
+	}
+	blah_draw_getStats(&stats);
+	printf("%-14s %3lu texture changes  %3lu draw calls per frame  %7.3f ms per frame\n",
+		atlasTextures ? "shared atlas" : "own textures", stats.textureChanges, stats.drawCalls, bestTime / 1e6);
+	blah_draw_setCurrentScene(NULL);
+	Blah_Scene_disable(&scene);
+}
+
+/* Main */
+
+int main()
+{
+	if (!bench_video_init(640, 480)) { return 1; }
+	bench_atlas_measurePacking(512);
+	bench_atlas_measurePacking(1024);
+
+	Blah_Model *model = bench_atlas_newModel();
+	blah_draw_setViewpoint(BENCH_ATLAS_SURFACES_X, BENCH_ATLAS_SURFACES_Y, 12);
+	blah_draw_setFocalPoint(BENCH_ATLAS_SURFACES_X, BENCH_ATLAS_SURFACES_Y, 0);
+	blah_draw_setViewNormal(0, 1, 0);
+	blah_draw_setFieldOfVision(1.2f, 0.9f);
+	blah_draw_setDepthOfVision(100);
+	printf("%d surfaces of %d primitives, each with its own texture\n", BENCH_ATLAS_SURFACES_X * BENCH_ATLAS_SURFACES_Y,
+		BENCH_ATLAS_CELLS * BENCH_ATLAS_CELLS);
+	bench_atlas_measureDrawing(model, false);
+	bench_atlas_measureDrawing(model, true);
+
+	Blah_Model_destroy(model);
+	blah_atlas_exit();
+	bench_video_exit();
+	return 0;
+}
@@ -0,0 +1,173 @@
+/* bench_baked.c
+	Measures loading objects from synthetic lightwave files of 10k to 500k polygons, by loading the
+	model and converting it with Blah_Object_fromModel, the old path, and by loading the baked
+	object file saved from it with Blah_Object_loadBaked.  Blah_Object_loadCached, which also hashes
+	the model file to check the baked file is current, is measured as well.  Baked files are mapped,
+	so their pages are read as the mesh is first drawn rather than when loaded.  Files are read from
+	the page cache after the first load, so "cold" here means no parsing or conversion has been done,
+	not that the disk is read.  Prints the best of several loads of each, and the file sizes. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blah_file.h"
+#include "blah_model.h"
+#include "blah_object.h"
+#include "blah_time.h"
+
+/* Definitions */
+
+#define BENCH_BAKED_REPEATS 3
+#define BENCH_BAKED_GRID 200				//Points along each side of the grid of vertices
+#define BENCH_BAKED_MODEL_NAME "bench_baked.lwo"
+#define BENCH_BAKED_OBJECT_NAME "bench_baked.blo"
+
+/* Static Functions */
+
+static unsigned char *bench_baked_put16(unsigned char *dest, unsigned int value)
+{	//Stores a 16 bit value most significant byte first, returning the end of it
+	dest[0] = value >> 8;
+	dest[1] = value & 255;
+	return dest + 2;
+}
+
+static unsigned char *bench_baked_putFloat(unsigned char *dest, float value)
+{	//Stores a float most significant byte first, returning the end of it
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bench_baked_put16(bench_baked_put16(dest, bits >> 16), bits & 65535);
+}
+
+static unsigned char *bench_baked_beginChunk(unsigned char *dest, const char *tag)
+{	//Stores the tag of a chunk, leaving room for its length
+	memcpy(dest, tag, 4);
+	return dest + 8;
+}
+
+static unsigned char *bench_baked_endChunk(unsigned char *start, unsigned char *end)
+{	//Stores the length of the chunk started at start and ending at end, padding it to an even length
+	const size_t length = end - start - 8;
+	bench_baked_put16(bench_baked_put16(start + 4, length >> 16), length & 65535);
+	if (length & 1) { *end++ = 0; }
+	return end;
+}
+
+static size_t bench_baked_generate(unsigned char *data, int numPolygons)
+{	//Writes a lightwave object of triangles and quadrilaterals between neighbouring points of a
+	//rippled grid, over two coloured surfaces.  Returns the length of the file.
+	static const unsigned char surfaces[] = "SURF\0\0\0\x12" "Default\0COLR\0\x04\xc8\x64\x32\0"
+		"SURF\0\0\0\x12" "Second\0\0COLR\0\x04\x14\x0a\xfa\0";
+	unsigned char *form, *chunk, *dest = data;
+	const int numPoints = BENCH_BAKED_GRID * BENCH_BAKED_GRID;
+
+	form = dest;
+	dest = bench_baked_beginChunk(dest, "FORM");
+	memcpy(dest, "LWOB", 4);
+	dest += 4;
+
+	chunk = dest;
+	dest = bench_baked_beginChunk(dest, "PNTS");
+	for (int point = 0; point < numPoints; point++) {
+		dest = bench_baked_putFloat(dest, (point % BENCH_BAKED_GRID) * 0.1f);
+		dest = bench_baked_putFloat(dest, (point / BENCH_BAKED_GRID) * 0.1f);
+		dest = bench_baked_putFloat(dest, 0.2f * rand() / RAND_MAX);
+	}
+	dest = bench_baked_endChunk(chunk, dest);
+
+	chunk = dest;
+	dest = bench_baked_beginChunk(dest, "SRFS");
+	memcpy(dest, "Default\0Second\0\0", 16);
+	dest = bench_baked_endChunk(chunk, dest + 16);
+
+	chunk = dest;
+	dest = bench_baked_beginChunk(dest, "POLS");
+	for (int polygon = 0; polygon < numPolygons; polygon++) {
+		const int cell = polygon % ((BENCH_BAKED_GRID - 1) * (BENCH_BAKED_GRID - 1));
+		const int corner = cell / (BENCH_BAKED_GRID - 1) * BENCH_BAKED_GRID + cell % (BENCH_BAKED_GRID - 1);
+		const int corners[4] = {corner, corner + 1, corner + BENCH_BAKED_GRID + 1, corner + BENCH_BAKED_GRID};
+		const int numIndices = 3 + (polygon & 1);
+		dest = bench_baked_put16(dest, numIndices);
+		for (int index = 0; index < numIndices; index++) { dest = bench_baked_put16(dest, corners[index]); }
+		dest = bench_baked_put16(dest, 1 + (polygon / 64 & 1)); //Surfaces alternate in runs
+	}
+	dest = bench_baked_endChunk(chunk, dest);
+
+	memcpy(dest, surfaces, sizeof(surfaces) - 1);
+	return bench_baked_endChunk(form, dest + sizeof(surfaces) - 1) - data;
+}
+
+static long bench_baked_getFileSize(const char *name)
+{	//Returns the length of the named file, or -1 if it could not be opened
+	FILE *file = fopen(name, "rb");
+	long length;
+
+	if (file == NULL) { return -1; }
+	fseek(file, 0, SEEK_END);
+	length = ftell(file);
+	fclose(file);
+	return length;
+}
+
+static void bench_baked_measure(int numPolygons)
+{	//Loads the object from the model file and then from its baked file, printing the best times
+	uint64_t modelTime = UINT64_MAX, saveTime = UINT64_MAX, bakedTime = UINT64_MAX, cachedTime = UINT64_MAX, hash = 0;
+
+	for (int repeat = 0; repeat < BENCH_BAKED_REPEATS; repeat++) {
+		uint64_t startTime = blah_time_getNanoseconds(), elapsed;
+		Blah_Model *model = Blah_Model_load(BENCH_BAKED_MODEL_NAME);
+		Blah_Object *object = model ? Blah_Object_fromModel(model) : NULL;
+		elapsed = blah_time_getNanoseconds() - startTime;
+		if (object == NULL) { printf("failed to load %s\n", BENCH_BAKED_MODEL_NAME); return; }
+		if (elapsed < modelTime) { modelTime = elapsed; }
+		Blah_Model_destroy(model);
+
+		blah_file_hash(BENCH_BAKED_MODEL_NAME, &hash);
+		startTime = blah_time_getNanoseconds();
+		if (!Blah_Object_save(object, BENCH_BAKED_OBJECT_NAME, hash)) { printf("failed to save %s\n", BENCH_BAKED_OBJECT_NAME); return; }
+		elapsed = blah_time_getNanoseconds() - startTime;
+		if (elapsed < saveTime) { saveTime = elapsed; }
+		Blah_Object_destroy(object);
+
+		startTime = blah_time_getNanoseconds();
+		object = Blah_Object_loadBaked(BENCH_BAKED_OBJECT_NAME, hash);
+		elapsed = blah_time_getNanoseconds() - startTime;
+		if (object == NULL) { printf("failed to load %s\n", BENCH_BAKED_OBJECT_NAME); return; }
+		if (elapsed < bakedTime) { bakedTime = elapsed; }
+		Blah_Object_destroy(object);
+
+		startTime = blah_time_getNanoseconds();
+		object = Blah_Object_loadCached(BENCH_BAKED_MODEL_NAME, BENCH_BAKED_OBJECT_NAME);
+		elapsed = blah_time_getNanoseconds() - startTime;
+		if (object == NULL) { printf("failed to load %s through the cache\n", BENCH_BAKED_MODEL_NAME); return; }
+		if (elapsed < cachedTime) { cachedTime = elapsed; }
+		Blah_Object_destroy(object);
+	}
+	printf("%7d polygons  model %9.2f ms  baked %8.3f ms  cached %8.3f ms  save %8.2f ms  speedup %6.1fx  model %6.2f MB  baked %6.2f MB\n",
+		numPolygons, modelTime / 1e6, bakedTime / 1e6, cachedTime / 1e6, saveTime / 1e6, (double)modelTime / bakedTime,
+		bench_baked_getFileSize(BENCH_BAKED_MODEL_NAME) / 1e6, bench_baked_getFileSize(BENCH_BAKED_OBJECT_NAME) / 1e6);
+}
+
+/* Main */
+
+int main()
+{
+	static const int polygonCounts[] = {10000, 100000, 500000};
+	const size_t maxPolygons = polygonCounts[sizeof(polygonCounts) / sizeof(polygonCounts[0]) - 1];
+	unsigned char *data = malloc(1024 + (size_t)BENCH_BAKED_GRID * BENCH_BAKED_GRID * 12 + maxPolygons * 12);
+
+	if (data == NULL) { return 1; }
+	srand(1);
+	for (size_t count = 0; count < sizeof(polygonCounts) / sizeof(polygonCounts[0]); count++) {
+		const size_t length = bench_baked_generate(data, polygonCounts[count]);
+		FILE *file = fopen(BENCH_BAKED_MODEL_NAME, "wb");
+
+		if (file == NULL || fwrite(data, 1, length, file) != length) { printf("failed to write %s\n", BENCH_BAKED_MODEL_NAME); return 1; }
+		fclose(file);
+		bench_baked_measure(polygonCounts[count]);
+	}
+	remove(BENCH_BAKED_MODEL_NAME);
+	remove(BENCH_BAKED_OBJECT_NAME);
+	free(data);
+	return 0;
+}
@@ -0,0 +1,111 @@
+/* bench_batching.c
+	Measures drawing frames of a scene of grid objects through blah_draw_main, with objects drawn
+	through compiled vertex buffers and with batching disabled, the old path, which submits each
+	vertex of each primitive every frame.  Each grid mixes quadrilaterals and polygons of four
+	materials.  Drawing is done on an offscreen context, so times are those of the software renderer
+	where no display is available.  Prints the best frame time, and the draw calls and vertices
+	submitted per frame, for each path, and the time of the frame which compiles the objects. */
+
+#include <stdio.h>
+
+#include "bench_video.h"
+#include "blah_draw.h"
+#include "blah_material.h"
+#include "blah_object.h"
+#include "blah_primitive.h"
+#include "blah_scene.h"
+#include "blah_scene_object.h"
+#include "blah_time.h"
+
+/* Definitions */
+
+#define BENCH_BATCHING_FRAMES 20
+#define BENCH_BATCHING_WIDTH 640
+#define BENCH_BATCHING_HEIGHT 480
+#define BENCH_BATCHING_OBJECTS 4		//Objects along each side of the scene
+#define BENCH_BATCHING_CELLS 64			//Cells along each side of each grid object
+#define BENCH_BATCHING_MATERIALS 4
+
+/* Static Functions */
+
+static Blah_Object *bench_batching_newGrid(Blah_Material **materials)
+{	//Creates a grid object of square cells with a side of two, of quadrilaterals and polygons
+	Blah_Object *grid = Blah_Object_new();
+	const float step = 2.0f / BENCH_BATCHING_CELLS;
+
+	for (int row = 0; row < BENCH_BATCHING_CELLS; row++) {
+		for (int column = 0; column < BENCH_BATCHING_CELLS; column++) {
+			const float x = -1 + step * column, y = -1 + step * row;
+			Blah_Vertex *vertices[5] = {Blah_Object_addVertex(grid, x, y, 0), Blah_Object_addVertex(grid, x + step, y, 0),
+				Blah_Object_addVertex(grid, x + step, y + step, 0), Blah_Object_addVertex(grid, x, y + step, 0), NULL};
+			for (int index = 0; index < 4; index++) { Blah_Vertex_setNormal(vertices[index], 0, 0, 1); }
+			Blah_Primitive *cell = Blah_Primitive_new((row + column) % 3 ? BLAH_PRIMITIVE_QUADRILATERAL : BLAH_PRIMITIVE_POLYGON, vertices, 4);
+			Blah_Primitive_setMaterial(cell, materials[(row / 8 + column / 8) % BENCH_BATCHING_MATERIALS]);
+			Blah_Object_addPrimitive(grid, cell);
+		}
+	}
+	return grid;
+}
+
+static uint64_t bench_batching_frame()
+{	//Draws a frame and returns its time, including waiting for the renderer to finish
+	const uint64_t startTime = blah_time_getNanoseconds();
+	blah_draw_main();
+	bench_video_finish();
+	return blah_time_getNanoseconds() - startTime;
+}
+
+static void bench_batching_measure(bool batching)
+{	//Draws frames with batching enabled or disabled, printing the best frame time and the stats of the last
+	uint64_t bestTime = UINT64_MAX, firstTime;
+	Blah_Draw_Stats stats;
+
+	blah_draw_setObjectBatching(batching);
+	firstTime = bench_batching_frame();
+	for (int frame = 0; frame < BENCH_BATCHING_FRAMES; frame++) {
+		const uint64_t elapsed = bench_batching_frame();
+		if (elapsed < bestTime) { bestTime = elapsed; }
+	}
+	blah_draw_getStats(&stats);
+	printf("%-9s %8.3f ms per frame  first frame %8.3f ms  %7lu draw calls %8lu vertices per frame\n",
+		batching ? "batched" : "immediate", bestTime / 1e6, firstTime / 1e6, stats.drawCalls, stats.vertices);
+}
+
+/* Main */
+
+int main()
+{
+	Blah_Material *materials[BENCH_BATCHING_MATERIALS];
+	Blah_Scene scene;
+
+	if (!bench_video_init(BENCH_BATCHING_WIDTH, BENCH_BATCHING_HEIGHT)) { return 1; }
+	for (int index = 0; index < BENCH_BATCHING_MATERIALS; index++) {
+		materials[index] = Blah_Material_new();
+		Blah_Material_setColour(materials[index], index & 1, (index >> 1) & 1, 0.5f, 1);
+	}
+
+	Blah_Scene_init(&scene);
+	for (int row = 0; row < BENCH_BATCHING_OBJECTS; row++) {
+		for (int column = 0; column < BENCH_BATCHING_OBJECTS; column++) {
+			Blah_Scene_Object *sceneObject = Blah_Scene_Object_new("grid", bench_batching_newGrid(materials));
+			Blah_Scene_Object_setPosition(sceneObject, (column - BENCH_BATCHING_OBJECTS / 2) * 2.5f + 1.25f,
+				(row - BENCH_BATCHING_OBJECTS / 2) * 2.5f + 1.25f, 0);
+			Blah_Scene_addSceneObject(&scene, sceneObject);
+		}
+	}
+	blah_draw_setCurrentScene(&scene);
+	blah_draw_setViewpoint(0, 0, 12);
+	blah_draw_setFocalPoint(0, 0, 0);
+	blah_draw_setViewNormal(0, 1, 0);
+	blah_draw_setFieldOfVision(1.2f, 0.9f);
+	blah_draw_setDepthOfVision(100);
+
+	printf("%d objects of %d primitives each\n", BENCH_BATCHING_OBJECTS * BENCH_BATCHING_OBJECTS, BENCH_BATCHING_CELLS * BENCH_BATCHING_CELLS);
+	bench_batching_measure(false);
+	bench_batching_measure(true);
+
+	blah_draw_setCurrentScene(NULL);
+	Blah_Scene_disable(&scene);
+	bench_video_exit();
+	return 0;
+}
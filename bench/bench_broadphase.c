@@ -0,0 +1,84 @@
+/* bench_broadphase.c
+	Measures the time of an entity frame, blah_entity_processAll, against the number of actively
+	colliding entities, with each collision broad-phase scheme.  The scheme which is switched off is
+	the old path, testing every pair of entities.  Entities move about an area which grows with
+	their number, so each meets about as many others whatever their number.  Prints the best frame
+	time and the number of collisions reported, which must be the same for each scheme. */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "blah_entity.h"
+#include "blah_entity_broadphase.h"
+#include "blah_object.h"
+#include "blah_time.h"
+
+/* Definitions */
+
+#define BENCH_BROADPHASE_FRAMES 5
+#define BENCH_BROADPHASE_OBJECTS 4			//Objects of different sizes shared between the entities
+#define BENCH_BROADPHASE_SPACING 6.0f		//Average distance between entities
+
+/* Static Globals */
+
+static unsigned long collisions = 0;
+
+/* Static Functions */
+
+static void bench_broadphase_collide(Blah_Entity *thisEntity, Blah_Entity *otherEntity)
+{	//Counts collisions
+	(void)thisEntity;
+	(void)otherEntity;
+	collisions++;
+}
+
+static void bench_broadphase_measure(Blah_Object **objects, int entityCount, blah_entity_broadphase_type type)
+{	//Runs frames of the given number of entities with the given scheme, printing the best frame time
+	static const char *typeNames[] = {"none", "grid", "sweep"};
+	const float side = sqrtf((float)entityCount) * BENCH_BROADPHASE_SPACING;
+	uint64_t bestTime = UINT64_MAX;
+
+	srand(1);
+	blah_entity_broadphase_setType(type);
+	for (int index = 0; index < entityCount; index++) {
+		Blah_Entity *entity = Blah_Entity_new("bench", index, 0);
+		Blah_Entity_addSharedObject(entity, objects[rand() % BENCH_BROADPHASE_OBJECTS]);
+		Blah_Entity_setLocation(entity, side * rand() / RAND_MAX, side * rand() / RAND_MAX, (float)(rand() % 20));
+		Blah_Entity_setVelocity(entity, (rand() % 5 - 2) * 0.3f, (rand() % 5 - 2) * 0.3f, 0);
+		Blah_Entity_setCollisionFunction(entity, bench_broadphase_collide);
+		Blah_Entity_setActiveCollision(entity, true);
+	}
+
+	collisions = 0;
+	for (int frame = 0; frame < BENCH_BROADPHASE_FRAMES; frame++) {
+		const uint64_t startTime = blah_time_getNanoseconds();
+		blah_entity_processAll();
+		const uint64_t elapsed = blah_time_getNanoseconds() - startTime;
+		if (elapsed < bestTime) { bestTime = elapsed; }
+	}
+	printf("%6d entities  %-6s %10.3f ms per frame %8.1f collisions per frame\n", entityCount, typeNames[type],
+		bestTime / 1e6, (double)collisions / BENCH_BROADPHASE_FRAMES);
+	blah_entity_destroyAll();
+}
+
+/* Main */
+
+int main()
+{
+	static const int entityCounts[] = {500, 1000, 2000, 4000, 8000};
+	Blah_Object *objects[BENCH_BROADPHASE_OBJECTS];
+
+	for (int index = 0; index < BENCH_BROADPHASE_OBJECTS; index++) {
+		objects[index] = Blah_Object_new();
+		objects[index]->boundRadius = 0.5f + index;
+	}
+	blah_entity_setDeterministic(true); //Collisions are checked on one thread, whatever the scheme
+	for (size_t count = 0; count < sizeof(entityCounts) / sizeof(entityCounts[0]); count++) {
+		bench_broadphase_measure(objects, entityCounts[count], BLAH_ENTITY_BROADPHASE_NONE);
+		bench_broadphase_measure(objects, entityCounts[count], BLAH_ENTITY_BROADPHASE_GRID);
+		bench_broadphase_measure(objects, entityCounts[count], BLAH_ENTITY_BROADPHASE_SWEEP);
+	}
+	for (int index = 0; index < BENCH_BROADPHASE_OBJECTS; index++) { Blah_Object_destroy(objects[index]); }
+	return 0;
+}
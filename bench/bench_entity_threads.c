@@ -0,0 +1,115 @@
+/* bench_entity_threads.c
+	Measures simulation steps, blah_entity_processAll, of entities whose move functions steer them
+	about with some arithmetic and send an event to a neighbour every few steps.  Steps are run on one
+	thread with entities processed one at a time, the old path, in deterministic mode, and with the
+	moves spread across increasing numbers of threads.  Prints the best step time of each and a
+	checksum of the order events were delivered in, which must be the same for each but the first,
+	where events sent to entities earlier in the list are delivered a step later.  Timings only
+	scale up to the number of processors, which is printed first. */
+
+#include <math.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "blah_entity.h"
+#include "blah_job.h"
+#include "blah_time.h"
+
+/* Definitions */
+
+#define BENCH_ENTITY_THREADS_ENTITIES 20000
+#define BENCH_ENTITY_THREADS_STEPS 10
+#define BENCH_ENTITY_THREADS_WORK 64		//Steering iterations of each move
+#define BENCH_ENTITY_THREADS_EVENT_STEPS 8	//Steps between the events sent by each entity
+
+/* Structure Definitions */
+
+typedef struct Bench_Entity_Threads_Data { //Entity specific data
+	Blah_Entity *neighbour;			//Entity events are sent to
+	unsigned long index;			//Position in order of creation
+	unsigned long steps;			//Steps moved
+	unsigned long checksum;			//Hash of the senders of events received, in order
+} Bench_Entity_Threads_Data;
+
+/* Static Functions */
+
+static bool bench_entity_threads_receive(Blah_Entity *entity, Blah_Entity_Event *event)
+{	//Folds the sender into the entity's checksum, so that the order of delivery changes it
+	Bench_Entity_Threads_Data *data = entity->entityData;
+	const Bench_Entity_Threads_Data *senderData = event->sender->entityData;
+	data->checksum = data->checksum * 31 + senderData->index + 1;
+	return true;
+}
+
+static void bench_entity_threads_move(Blah_Entity *entity)
+{	//Steers the entity around a point, sending its neighbour an event every few steps
+	Bench_Entity_Threads_Data *data = entity->entityData;
+	float x = entity->location.x, y = entity->location.y, velocityX = 0, velocityY = 0;
+
+	for (int iteration = 0; iteration < BENCH_ENTITY_THREADS_WORK; iteration++) {
+		const float distance = sqrtf(x * x + y * y) + 1;
+		velocityX += (-y / distance - x * 0.01f) * 0.01f;
+		velocityY += (x / distance - y * 0.01f) * 0.01f;
+		x += velocityX * 0.01f;
+		y += velocityY * 0.01f;
+	}
+	Blah_Entity_setVelocity(entity, velocityX, velocityY, 0);
+	if (++data->steps % BENCH_ENTITY_THREADS_EVENT_STEPS == data->index % BENCH_ENTITY_THREADS_EVENT_STEPS) {
+		Blah_Entity_sendEvent(data->neighbour, Blah_Entity_Event_new("bench", entity, bench_entity_threads_receive, 0));
+	}
+}
+
+static void bench_entity_threads_measure(Blah_Entity **entities, unsigned int threadCount, bool deterministic)
+{	//Runs steps with the given number of threads, printing the best step time and the event checksum
+	uint64_t bestTime = UINT64_MAX;
+	unsigned long checksum = 0;
+
+	if (!blah_entity_setThreads(threadCount)) { printf("failed to start %u threads\n", threadCount); return; }
+	blah_entity_setDeterministic(deterministic);
+	blah_entity_processAll(); //Delivers events left over from the last run, and starts the threads
+	for (int index = 0; index < BENCH_ENTITY_THREADS_ENTITIES; index++) {
+		Bench_Entity_Threads_Data *data = entities[index]->entityData;
+		data->steps = data->checksum = 0;
+		Blah_Entity_setLocation(entities[index], index % 200, index / 200, 0);
+	}
+	for (int step = 0; step < BENCH_ENTITY_THREADS_STEPS; step++) {
+		const uint64_t startTime = blah_time_getNanoseconds();
+		blah_entity_processAll();
+		const uint64_t elapsed = blah_time_getNanoseconds() - startTime;
+		if (elapsed < bestTime) { bestTime = elapsed; }
+	}
+	for (int index = 0; index < BENCH_ENTITY_THREADS_ENTITIES; index++) {
+		checksum = checksum * 7 + ((Bench_Entity_Threads_Data*)entities[index]->entityData)->checksum;
+	}
+	printf("%2u thread%s %-14s %9.3f ms per step  checksum %016lx\n", threadCount, threadCount == 1 ? " " : "s",
+		deterministic ? "deterministic" : threadCount == 1 ? "one at a time" : "", bestTime / 1e6, checksum);
+}
+
+/* Main */
+
+int main()
+{
+	static Blah_Entity *entities[BENCH_ENTITY_THREADS_ENTITIES];
+	static const unsigned int threadCounts[] = {2, 4, 8};
+
+	printf("%ld processors, %d entities\n", sysconf(_SC_NPROCESSORS_ONLN), BENCH_ENTITY_THREADS_ENTITIES);
+	for (int index = 0; index < BENCH_ENTITY_THREADS_ENTITIES; index++) {
+		entities[index] = Blah_Entity_new("bench", 0, sizeof(Bench_Entity_Threads_Data));
+		((Bench_Entity_Threads_Data*)entities[index]->entityData)->index = index;
+		Blah_Entity_setMoveFunction(entities[index], bench_entity_threads_move);
+	}
+	for (int index = 0; index < BENCH_ENTITY_THREADS_ENTITIES; index++) { //Each sends to one a long way along the list
+		((Bench_Entity_Threads_Data*)entities[index]->entityData)->neighbour = entities[(index * 7919 + 1) % BENCH_ENTITY_THREADS_ENTITIES];
+	}
+
+	bench_entity_threads_measure(entities, 1, false);
+	bench_entity_threads_measure(entities, 1, true);
+	for (size_t count = 0; count < sizeof(threadCounts) / sizeof(threadCounts[0]); count++) {
+		bench_entity_threads_measure(entities, threadCounts[count], false);
+	}
+
+	blah_entity_setThreads(1);
+	blah_entity_destroyAll();
+	blah_job_exit();
+	return 0;
+}
@@ -0,0 +1,133 @@
+/* bench_hud.c
+	Measures drawing a HUD overlay of 100 lines of 100 characters, 10k characters a frame, in a
+	texture font.  The old path, drawing each character as its own textured polygon through
+	blah_draw_polygon2d, is measured against Blah_Overlay_draw with the overlay drawn directly, its
+	characters batched into one draw call, and drawn through its cached layer, both unchanged and
+	with one line changing every frame.  Drawing is done on an offscreen context, so times are those
+	of the software renderer.  Prints the best frame time, draw calls and vertices of each. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench_video.h"
+#include "blah_draw.h"
+#include "blah_draw_gl.h"
+#include "blah_font_texture.h"
+#include "blah_overlay.h"
+#include "blah_overlay_text.h"
+#include "blah_scene.h"
+#include "blah_time.h"
+
+/* Definitions */
+
+#define BENCH_HUD_WIDTH 800
+#define BENCH_HUD_HEIGHT 600
+#define BENCH_HUD_LINES 100
+#define BENCH_HUD_LINE_LENGTH 100
+#define BENCH_HUD_CHAR_SIDE 8
+#define BENCH_HUD_FRAMES 30
+
+/* Externally Referenced Variables */
+
+extern Blah_Video_Mode *blah_video_currentMode;	//Set by bench_video_init
+
+/* Type Definitions */
+
+typedef enum Bench_Hud_Mode {BENCH_HUD_PER_CHARACTER, BENCH_HUD_BATCHED, BENCH_HUD_CACHED, BENCH_HUD_CACHED_CHANGING} bench_hud_mode;
+
+/* Static Functions */
+
+static void bench_hud_drawPerCharacter(Blah_Overlay *overlay)
+{	//Draws each character of the overlay's text as its own polygon, as texture fonts did before batching
+	static Blah_Material material;
+	Blah_List_Element *element;
+
+	Blah_Material_setColour(&material, 1, 1, 1, 1);
+	blah_draw_pushDrawport();
+	blah_draw_setDrawport(overlay->posX, overlay->posY, overlay->posX + overlay->width - 1, overlay->posY + overlay->height - 1);
+	for (element = overlay->textList.first; element; element = element->next) {
+		const Blah_Overlay_Text *text = element->data;
+		const Blah_Font_Texture *font = (const Blah_Font_Texture*)text->fontStyle;
+		int x = text->position.x, y = text->position.y;
+
+		for (const char *character = text->stringBuffer; *character; character++, x += font->fontBase.width) {
+			Blah_Texture_Map *map = font->charMaps[(unsigned char)*character];
+			if (map == NULL) { continue; }
+			const int right = x + font->fontBase.width - 1, top = y + font->fontBase.height - 1;
+			Blah_Vertex corners[4] = {{.location = {x, top, 0}}, {.location = {right, top, 0}}, {.location = {right, y, 0}}, {.location = {x, y, 0}}};
+			Blah_Vertex *vertices[5] = {&corners[0], &corners[1], &corners[2], &corners[3], NULL};
+			blah_draw_polygon2d(vertices, map, &material);
+		}
+	}
+	blah_draw_popDrawport();
+}
+
+static void bench_hud_measure(Blah_Overlay *overlay, Blah_Overlay_Text *changingText, bench_hud_mode mode)
+{	//Draws frames of the overlay in the given mode, printing the best frame time and the stats of the last
+	static const char *modeNames[] = {"per character", "batched", "cached", "cached, changing"};
+	char changingLine[BENCH_HUD_LINE_LENGTH + 1];
+	uint64_t bestTime = UINT64_MAX;
+	Blah_Draw_Stats stats;
+
+	Blah_Overlay_setCached(overlay, mode == BENCH_HUD_CACHED || mode == BENCH_HUD_CACHED_CHANGING);
+	for (int frame = -1; frame < BENCH_HUD_FRAMES; frame++) { //The first frame fills the cached layer
+		if (mode == BENCH_HUD_CACHED_CHANGING) {
+			snprintf(changingLine, sizeof(changingLine), "frame %d", frame);
+			Blah_Overlay_Text_setText(changingText, changingLine);
+		}
+		const uint64_t startTime = blah_time_getNanoseconds();
+		blah_draw_main(); //Begins the frame, the scene being empty
+		if (mode == BENCH_HUD_PER_CHARACTER) { bench_hud_drawPerCharacter(overlay); } else { Blah_Overlay_draw(overlay); }
+		bench_video_finish();
+		const uint64_t elapsed = blah_time_getNanoseconds() - startTime;
+		if (frame >= 0 && elapsed < bestTime) { bestTime = elapsed; }
+	}
+	blah_draw_getStats(&stats);
+	printf("%-17s %8.3f ms per frame  %6lu draw calls  %6lu vertices  %lu redraws  %lu composites\n", modeNames[mode],
+		bestTime / 1e6, stats.drawCalls, stats.vertices, stats.overlayRedraws, stats.overlayComposites);
+}
+
+/* Main */
+
+int main()
+{
+	unsigned int charMap[BLAH_FONT_NUM_CHARS] = {0};
+	Blah_Overlay_Text *lastText = NULL;
+	Blah_Scene scene;
+
+	if (!bench_video_init(BENCH_HUD_WIDTH, BENCH_HUD_HEIGHT)) { return 1; }
+	blah_draw_gl_update2dProjection(blah_video_currentMode);
+	Blah_Scene_init(&scene);
+	blah_draw_setCurrentScene(&scene);
+
+	//A font sheet of 16 by 16 characters, printable characters from the first
+	Blah_Image *sheet = Blah_Image_new("hud", 32, 16 * BENCH_HUD_CHAR_SIDE, 16 * BENCH_HUD_CHAR_SIDE, BLAH_PIXEL_FORMAT_RGBA);
+	unsigned char *pixels = sheet->pixelData;
+	srand(1);
+	for (size_t index = 0; index < (size_t)sheet->width * sheet->height * 4; index++) { pixels[index] = rand(); }
+	for (int character = 32; character < 127; character++) { charMap[character] = character - 31; }
+	Blah_Font_Texture *font = Blah_Font_Texture_new("hud", sheet, charMap, BENCH_HUD_CHAR_SIDE, BENCH_HUD_CHAR_SIDE);
+	Blah_Image_destroy(sheet);
+	if (font == NULL) { printf("failed to create font\n"); return 1; }
+
+	Blah_Overlay *overlay = Blah_Overlay_new(0, "hud", BENCH_HUD_WIDTH, BENCH_HUD_HEIGHT);
+	for (int line = 0; line < BENCH_HUD_LINES; line++) {
+		char name[16], text[BENCH_HUD_LINE_LENGTH + 1];
+		for (int column = 0; column < BENCH_HUD_LINE_LENGTH; column++) { text[column] = 32 + (line * 7 + column) % 95; }
+		text[BENCH_HUD_LINE_LENGTH] = '\0';
+		snprintf(name, sizeof(name), "line%d", line);
+		lastText = Blah_Overlay_addText(overlay, name, text, (Blah_Font*)font, 0, (line * 6) % (BENCH_HUD_HEIGHT - BENCH_HUD_CHAR_SIDE));
+	}
+
+	printf("%d characters per frame\n", BENCH_HUD_LINES * BENCH_HUD_LINE_LENGTH);
+	bench_hud_measure(overlay, lastText, BENCH_HUD_PER_CHARACTER);
+	bench_hud_measure(overlay, lastText, BENCH_HUD_BATCHED);
+	bench_hud_measure(overlay, lastText, BENCH_HUD_CACHED);
+	bench_hud_measure(overlay, lastText, BENCH_HUD_CACHED_CHANGING);
+
+	Blah_Overlay_destroy(overlay);
+	blah_draw_setCurrentScene(NULL);
+	Blah_Scene_disable(&scene);
+	bench_video_exit();
+	return 0;
+}
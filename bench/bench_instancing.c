@@ -0,0 +1,120 @@
+/* bench_instancing.c
+	Measures drawing frames of a scene of 10000 entities sharing one lit cube object through
+	blah_draw_main, with instancing disabled, drawing each entity's cube with its own draw call, and
+	enabled, drawing them as instances.  Entities are turned differently, so each instance has its
+	own transform.  Drawing is done on an offscreen context, so times are those of the software
+	renderer where no display is available, and the renderer's extra work per instance can outweigh
+	the draw calls saved.  Prints the best frame time, and of the time taken to submit the frame
+	before waiting for the renderer, and the draw calls and instanced items per frame, for each. */
+
+#include <stdio.h>
+
+#include "bench_video.h"
+#include "blah_draw.h"
+#include "blah_entity.h"
+#include "blah_light.h"
+#include "blah_object.h"
+#include "blah_primitive.h"
+#include "blah_scene.h"
+#include "blah_time.h"
+
+/* Definitions */
+
+#define BENCH_INSTANCING_FRAMES 15
+#define BENCH_INSTANCING_WIDTH 640
+#define BENCH_INSTANCING_HEIGHT 480
+#define BENCH_INSTANCING_SIDE 100		//Entities along each side of the grid
+#define BENCH_INSTANCING_SPACING 2.5f	//Distance between neighbouring entities
+
+/* Static Functions */
+
+static Blah_Object *bench_instancing_newCube()
+{	//Creates a cube object with a side of two, of two triangles to a face
+	static const int faces[6][4] = {{0, 1, 3, 2}, {4, 6, 7, 5}, {0, 4, 5, 1}, {2, 3, 7, 6}, {0, 2, 6, 4}, {1, 5, 7, 3}};
+	Blah_Object *cube = Blah_Object_new();
+
+	for (int face = 0; face < 6; face++) {
+		Blah_Vertex *corners[4];
+		for (int index = 0; index < 4; index++) {
+			const int corner = faces[face][index];
+			corners[index] = Blah_Object_addVertex(cube, corner & 1 ? 1 : -1, corner & 2 ? 1 : -1, corner & 4 ? 1 : -1);
+		}
+		Blah_Vertex *first[3] = {corners[0], corners[1], corners[2]}, *second[3] = {corners[0], corners[2], corners[3]};
+		Blah_Object_addPrimitive(cube, Blah_Primitive_new(BLAH_PRIMITIVE_TRIANGLE, first, 3));
+		Blah_Object_addPrimitive(cube, Blah_Primitive_new(BLAH_PRIMITIVE_TRIANGLE, second, 3));
+	}
+	Blah_Object_setColour(cube, 0.5f, 0.5f, 0.5f, 1);
+	return cube;
+}
+
+static uint64_t bench_instancing_frame(uint64_t *submitTime)
+{	//Draws a frame and returns its time, including waiting for the renderer to finish, setting
+	//submitTime to the time taken to submit it
+	const uint64_t startTime = blah_time_getNanoseconds();
+	blah_draw_main();
+	*submitTime = blah_time_getNanoseconds() - startTime;
+	bench_video_finish();
+	return blah_time_getNanoseconds() - startTime;
+}
+
+static void bench_instancing_measure(bool instancing)
+{	//Draws frames with instancing enabled or disabled, printing the best frame time and the stats of the last
+	uint64_t bestTime = UINT64_MAX, bestSubmitTime = UINT64_MAX, firstTime, submitTime;
+	Blah_Draw_Stats stats;
+
+	blah_draw_setInstancing(instancing);
+	firstTime = bench_instancing_frame(&submitTime);
+	for (int frame = 0; frame < BENCH_INSTANCING_FRAMES; frame++) {
+		const uint64_t elapsed = bench_instancing_frame(&submitTime);
+		if (elapsed < bestTime) { bestTime = elapsed; }
+		if (submitTime < bestSubmitTime) { bestSubmitTime = submitTime; }
+	}
+	blah_draw_getStats(&stats);
+	printf("%-13s %8.3f ms per frame  %8.3f ms submitting  first frame %8.3f ms  %6lu draw calls %6lu instanced items\n",
+		instancing ? "instanced" : "not instanced", bestTime / 1e6, bestSubmitTime / 1e6, firstTime / 1e6, stats.drawCalls,
+		stats.instancedItems);
+}
+
+/* Main */
+
+int main()
+{
+	const float extent = BENCH_INSTANCING_SIDE * BENCH_INSTANCING_SPACING / 2;
+	Blah_Object *cube;
+	Blah_Light *light;
+	Blah_Scene scene;
+
+	if (!bench_video_init(BENCH_INSTANCING_WIDTH, BENCH_INSTANCING_HEIGHT)) { return 1; }
+	cube = bench_instancing_newCube();
+	light = Blah_Light_new();
+	Blah_Light_setLocation(light, 40, 60, 80);
+	Blah_Light_setDiffuse(light, 0.9f, 0.8f, 0.7f, 1);
+	Blah_Light_setAmbient(light, 0.1f, 0.1f, 0.1f, 1);
+
+	Blah_Scene_init(&scene);
+	Blah_Scene_addLight(&scene, light);
+	for (int index = 0; index < BENCH_INSTANCING_SIDE * BENCH_INSTANCING_SIDE; index++) {
+		Blah_Entity *entity = Blah_Entity_new("cube", index, 0);
+		Blah_Entity_addSharedObject(entity, cube);
+		Blah_Entity_setLocation(entity, (index % BENCH_INSTANCING_SIDE) * BENCH_INSTANCING_SPACING - extent,
+			(index / BENCH_INSTANCING_SIDE) * BENCH_INSTANCING_SPACING - extent, 0);
+		Blah_Entity_rotateEuler(entity, 0.3f * (index % 5), 0.2f * (index % 3), 0.1f * index);
+		Blah_Scene_addEntity(&scene, entity);
+	}
+	blah_draw_setCurrentScene(&scene);
+	blah_draw_setViewpoint(0, 0, 300);
+	blah_draw_setFocalPoint(0, 0, 0);
+	blah_draw_setViewNormal(0, 1, 0);
+	blah_draw_setFieldOfVision(1.2f, 0.9f);
+	blah_draw_setDepthOfVision(500);
+
+	printf("%d entities sharing a cube of %d triangles\n", BENCH_INSTANCING_SIDE * BENCH_INSTANCING_SIDE, 12);
+	bench_instancing_measure(false);
+	bench_instancing_measure(true);
+
+	blah_draw_setCurrentScene(NULL);
+	Blah_Scene_disable(&scene);
+	Blah_Object_destroy(cube);
+	bench_video_exit();
+	return 0;
+}
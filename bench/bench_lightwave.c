@@ -0,0 +1,172 @@
+/* bench_lightwave.c
+	Measures loading synthetic lightwave objects of 100k to 1M triangles and quadrilaterals over
+	a grid of 65536 points, through each reader backend.  The mapped backend is that used by
+	Blah_Model_load and Blah_Model_decode.  The buffered backend reads the file through stdio in
+	blocks, and stands in for the old stdio path, which read each value with its own call and is
+	gone.  Parsing the file from memory, with no file access, is measured as well.  Opening the
+	file is part of each load.  Prints the best of several loads of each. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blah_file.h"
+#include "blah_model.h"
+#include "blah_time.h"
+
+/* Definitions */
+
+#define BENCH_LIGHTWAVE_REPEATS 3
+#define BENCH_LIGHTWAVE_GRID 256			//Points along each side of the grid of vertices
+#define BENCH_LIGHTWAVE_FILE_NAME "bench_lightwave.lwo"
+
+/* External Function Prototypes */
+
+extern Blah_Model *Blah_Model_Lightwave_load(char *filename, Blah_File_Reader *reader, bool deferTextures);
+
+/* Static Functions */
+
+static unsigned char *bench_lightwave_put16(unsigned char *dest, unsigned int value)
+{	//Stores a 16 bit value most significant byte first, returning the end of it
+	dest[0] = value >> 8;
+	dest[1] = value & 255;
+	return dest + 2;
+}
+
+static unsigned char *bench_lightwave_put32(unsigned char *dest, uint32_t value)
+{	//Stores a 32 bit value most significant byte first, returning the end of it
+	return bench_lightwave_put16(bench_lightwave_put16(dest, value >> 16), value & 65535);
+}
+
+static unsigned char *bench_lightwave_putFloat(unsigned char *dest, float value)
+{	//Stores a float most significant byte first, returning the end of it
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bench_lightwave_put32(dest, bits);
+}
+
+static unsigned char *bench_lightwave_putString(unsigned char *dest, const char *string)
+{	//Stores a null terminated string padded to an even length, returning the end of it
+	const size_t length = strlen(string) + 1;
+	memcpy(dest, string, length);
+	dest += length;
+	if (length & 1) { *dest++ = 0; }
+	return dest;
+}
+
+static unsigned char *bench_lightwave_beginChunk(unsigned char *dest, const char *tag, int lengthSize)
+{	//Stores the tag of a chunk, or a subchunk if lengthSize is 2, leaving room for its length
+	memcpy(dest, tag, 4);
+	return dest + 4 + lengthSize;
+}
+
+static unsigned char *bench_lightwave_endChunk(unsigned char *start, unsigned char *end, int lengthSize)
+{	//Stores the length of the chunk started at start and ending at end, padding it to an even length
+	const size_t length = end - start - 4 - lengthSize;
+	if (lengthSize == 2) { bench_lightwave_put16(start + 4, length); } else { bench_lightwave_put32(start + 4, length); }
+	if (length & 1) { *end++ = 0; }
+	return end;
+}
+
+static size_t bench_lightwave_generate(unsigned char *data, int numPolygons)
+{	//Writes a lightwave object of random polygons over a grid of points and two surfaces.
+	//Returns the length of the file.
+	unsigned char *form, *chunk, *subchunk, *dest = data;
+	const int numPoints = BENCH_LIGHTWAVE_GRID * BENCH_LIGHTWAVE_GRID;
+
+	form = dest;
+	dest = bench_lightwave_beginChunk(dest, "FORM", 4);
+	memcpy(dest, "LWOB", 4);
+	dest += 4;
+
+	chunk = dest;
+	dest = bench_lightwave_beginChunk(dest, "PNTS", 4);
+	for (int point = 0; point < numPoints; point++) {
+		dest = bench_lightwave_putFloat(dest, (point % BENCH_LIGHTWAVE_GRID) * 0.1f);
+		dest = bench_lightwave_putFloat(dest, (point / BENCH_LIGHTWAVE_GRID) * 0.1f);
+		dest = bench_lightwave_putFloat(dest, (float)rand() / RAND_MAX);
+	}
+	dest = bench_lightwave_endChunk(chunk, dest, 4);
+
+	chunk = dest;
+	dest = bench_lightwave_beginChunk(dest, "SRFS", 4);
+	dest = bench_lightwave_putString(bench_lightwave_putString(dest, "Default"), "Second");
+	dest = bench_lightwave_endChunk(chunk, dest, 4);
+
+	chunk = dest;
+	dest = bench_lightwave_beginChunk(dest, "POLS", 4);
+	for (int polygon = 0; polygon < numPolygons; polygon++) {
+		const int numIndices = 3 + rand() % 2;
+		dest = bench_lightwave_put16(dest, numIndices);
+		for (int index = 0; index < numIndices; index++) { dest = bench_lightwave_put16(dest, rand() % numPoints); }
+		dest = bench_lightwave_put16(dest, 1 + (polygon & 1)); //Surfaces alternate
+	}
+	dest = bench_lightwave_endChunk(chunk, dest, 4);
+
+	for (int surface = 0; surface < 2; surface++) {
+		chunk = dest;
+		dest = bench_lightwave_beginChunk(dest, "SURF", 4);
+		dest = bench_lightwave_putString(dest, surface ? "Second" : "Default");
+		subchunk = dest;
+		dest = bench_lightwave_beginChunk(dest, "COLR", 2);
+		*dest++ = surface ? 20 : 200; *dest++ = 100; *dest++ = surface ? 250 : 50; *dest++ = 0;
+		dest = bench_lightwave_endChunk(subchunk, dest, 2);
+		dest = bench_lightwave_endChunk(chunk, dest, 4);
+	}
+
+	return bench_lightwave_endChunk(form, dest, 4) - data;
+}
+
+static void bench_lightwave_measure(const unsigned char *data, size_t length, int numPolygons)
+{	//Loads the object repeatedly from memory and then from a file through each backend
+	static const char *sourceNames[] = {"memory", "mapped", "buffered"};
+
+	for (int source = 0; source < 3; source++) {
+		uint64_t bestTime = UINT64_MAX;
+		unsigned long numFaces = 0;
+
+		for (int repeat = 0; repeat < BENCH_LIGHTWAVE_REPEATS; repeat++) {
+			Blah_File_Reader reader;
+			Blah_Model *model = NULL;
+			const uint64_t startTime = blah_time_getNanoseconds();
+			if (source == 0) {
+				Blah_File_Reader_initMemory(&reader, data, length);
+			} else if (!Blah_File_Reader_open(&reader, BENCH_LIGHTWAVE_FILE_NAME, source == 1 ? BLAH_FILE_READER_MAPPED : BLAH_FILE_READER_BUFFERED)) {
+				printf("failed to open %s\n", BENCH_LIGHTWAVE_FILE_NAME);
+				return;
+			}
+			model = Blah_Model_Lightwave_load(BENCH_LIGHTWAVE_FILE_NAME, &reader, true);
+			Blah_File_Reader_close(&reader);
+			const uint64_t elapsed = blah_time_getNanoseconds() - startTime;
+			if (elapsed < bestTime) { bestTime = elapsed; }
+			if (model == NULL) { printf("failed to load %s\n", BENCH_LIGHTWAVE_FILE_NAME); return; }
+			numFaces = model->faces.length;
+			Blah_Model_destroy(model);
+		}
+		printf("%8d polygons %-9s %9.2f ms %8.2f M polygons/s %8.1f MB/s  %lu faces\n", numPolygons, sourceNames[source],
+			bestTime / 1e6, numPolygons / (bestTime / 1e9) / 1e6, length / (bestTime / 1e9) / 1e6, numFaces);
+	}
+}
+
+/* Main */
+
+int main()
+{
+	static const int polygonCounts[] = {100000, 250000, 500000, 1000000};
+	const size_t maxPolygons = polygonCounts[sizeof(polygonCounts) / sizeof(polygonCounts[0]) - 1];
+	unsigned char *data = malloc(1024 + (size_t)BENCH_LIGHTWAVE_GRID * BENCH_LIGHTWAVE_GRID * 12 + maxPolygons * 12);
+
+	if (data == NULL) { return 1; }
+	srand(1);
+	for (size_t count = 0; count < sizeof(polygonCounts) / sizeof(polygonCounts[0]); count++) {
+		const size_t length = bench_lightwave_generate(data, polygonCounts[count]);
+		FILE *file = fopen(BENCH_LIGHTWAVE_FILE_NAME, "wb");
+
+		if (file == NULL || fwrite(data, 1, length, file) != length) { printf("failed to write %s\n", BENCH_LIGHTWAVE_FILE_NAME); return 1; }
+		fclose(file);
+		bench_lightwave_measure(data, length, polygonCounts[count]);
+	}
+	remove(BENCH_LIGHTWAVE_FILE_NAME);
+	free(data);
+	return 0;
+}
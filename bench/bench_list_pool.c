@@ -0,0 +1,99 @@
+/* bench_list_pool.c
+	Measures the throughput of appending, popping and removing list elements.  Built once using the
+	list element pool and once with BLAH_LIST_NO_POOL, where each element is allocated with malloc as
+	before the pool, for comparison.  The pooled build is also measured with the pool shared between
+	threads, so locked around each use.  Prints the best time per element of several rounds. */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "blah_list.h"
+#include "blah_time.h"
+
+/* Definitions */
+
+#define BENCH_LIST_POOL_ELEMENTS 10000
+#define BENCH_LIST_POOL_ROUNDS 200
+#define BENCH_LIST_POOL_EVENTS 4		//Elements in each of the short lists used like entity event queues
+
+/* Static Globals */
+
+static Blah_List_Element *handles[BENCH_LIST_POOL_ELEMENTS];
+
+/* Static Functions */
+
+static void bench_list_pool_appendRemoveAll(Blah_List *list)
+{
+	for (uintptr_t index = 1; index <= BENCH_LIST_POOL_ELEMENTS; index++) { Blah_List_appendElement(list, (void*)index); }
+	Blah_List_removeAll(list);
+}
+
+static void bench_list_pool_appendPop(Blah_List *list)
+{
+	for (uintptr_t index = 1; index <= BENCH_LIST_POOL_ELEMENTS; index++) { Blah_List_appendElement(list, (void*)index); }
+	while (Blah_List_popElement(list)) {}
+}
+
+static void bench_list_pool_insertRemoveHandles(Blah_List *list)
+{	//Removes odd elements then even ones, so that elements are freed out of the order they were made
+	for (uintptr_t index = 1; index <= BENCH_LIST_POOL_ELEMENTS; index++) { handles[index - 1] = Blah_List_insertElement(list, (void*)index); }
+	for (int index = 1; index < BENCH_LIST_POOL_ELEMENTS; index += 2) { Blah_List_removeElementHandle(list, handles[index]); }
+	for (int index = 0; index < BENCH_LIST_POOL_ELEMENTS; index += 2) { Blah_List_removeElementHandle(list, handles[index]); }
+}
+
+static void bench_list_pool_events(Blah_List *list)
+{	//Appends and pops a few elements at a time, as entity events are sent and processed each frame
+	for (int batch = 0; batch < BENCH_LIST_POOL_ELEMENTS / BENCH_LIST_POOL_EVENTS; batch++) {
+		for (uintptr_t index = 1; index <= BENCH_LIST_POOL_EVENTS; index++) { Blah_List_appendElement(list, (void*)index); }
+		while (Blah_List_popElement(list)) {}
+	}
+}
+
+static void bench_list_pool_measure(const char *name, void (*operation)(Blah_List*))
+{	//Prints the best time per element of several rounds of the operation
+	Blah_List list;
+	uint64_t bestTime = UINT64_MAX;
+
+	Blah_List_init(&list, "bench");
+	operation(&list); //Fills the pool, so that rounds measure reuse
+	for (int round = 0; round < BENCH_LIST_POOL_ROUNDS; round++) {
+		const uint64_t startTime = blah_time_getNanoseconds();
+		operation(&list);
+		const uint64_t elapsed = blah_time_getNanoseconds() - startTime;
+		if (elapsed < bestTime) { bestTime = elapsed; }
+	}
+	printf("  %-32s %7.2f ns per element\n", name, (double)bestTime / BENCH_LIST_POOL_ELEMENTS);
+}
+
+static void bench_list_pool_measureAll()
+{
+	bench_list_pool_measure("append, remove all", bench_list_pool_appendRemoveAll);
+	bench_list_pool_measure("append, pop", bench_list_pool_appendPop);
+	bench_list_pool_measure("insert, remove by handle", bench_list_pool_insertRemoveHandles);
+	bench_list_pool_measure("short event queues", bench_list_pool_events);
+}
+
+/* Main */
+
+int main()
+{
+#ifdef BLAH_LIST_NO_POOL
+	printf("malloc per element\n");
+	bench_list_pool_measureAll();
+#else
+	Blah_List_Pool_Stats stats;
+
+	printf("element pool\n");
+	blah_list_pool_resetStats();
+	bench_list_pool_measureAll();
+	blah_list_pool_getStats(&stats);
+	printf("  %lu hits, %lu misses, %lu slabs\n", stats.hits, stats.misses, stats.slabs);
+
+	printf("element pool shared between threads\n");
+	blah_list_pool_share(true);
+	bench_list_pool_measureAll();
+	blah_list_pool_share(false);
+	blah_list_pool_destroyAll();
+#endif
+	return 0;
+}
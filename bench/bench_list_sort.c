@@ -0,0 +1,123 @@
+/* bench_list_sort.c
+	Measures sorting lists of 10k and 100k elements by a float key, as draw lists are sorted by
+	depth, with Blah_List_sort and Blah_List_sortNearly, and with the insertion sort which
+	Blah_List_sort used before for comparison.  Lists are sorted from a random order, and from a
+	nearly sorted order where a few percent of keys have moved a little since the last sort, as
+	when a list is re-sorted every frame.  Insertion sort is quadratic on random lists, so is only
+	measured on the smaller.  Prints the best time of several sorts. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "blah_list.h"
+#include "blah_time.h"
+
+/* Definitions */
+
+#define BENCH_LIST_SORT_REPEATS 5
+#define BENCH_LIST_SORT_MOVED 50		//One key in this many moves between frames of a nearly sorted list
+
+/* Structure Definitions */
+
+typedef struct Bench_List_Sort_Item {
+	float depth;
+} Bench_List_Sort_Item;
+
+/* Static Functions */
+
+static int bench_list_sort_compare(void *elemData1, void *elemData2)
+{	//Orders items by depth
+	const float depth1 = ((Bench_List_Sort_Item*)elemData1)->depth, depth2 = ((Bench_List_Sort_Item*)elemData2)->depth;
+	return depth1 < depth2 ? -1 : depth1 > depth2;
+}
+
+static void bench_list_sort_insertion(Blah_List *list, blah_list_sort_func *compareFunction)
+{	//Insertion sort as done by Blah_List_sort before, moving each element back until in place
+	Blah_List_Element *currentElement = list->first ? list->first->next : NULL;
+
+	while (currentElement) {
+		Blah_List_Element *nextElement = currentElement->next, *compareElement = currentElement->prev;
+		while (compareElement && compareFunction(currentElement->data, compareElement->data) < 0) { compareElement = compareElement->prev; }
+		if (compareElement != currentElement->prev) { //Unlink, then relink after compareElement
+			currentElement->prev->next = currentElement->next;
+			if (currentElement->next) { currentElement->next->prev = currentElement->prev; } else { list->last = currentElement->prev; }
+			if (!compareElement) {
+				currentElement->next = list->first;
+				list->first->prev = currentElement;
+				list->first = currentElement;
+				currentElement->prev = NULL;
+			} else {
+				compareElement->next->prev = currentElement;
+				currentElement->next = compareElement->next;
+				compareElement->next = currentElement;
+				currentElement->prev = compareElement;
+			}
+		}
+		currentElement = nextElement;
+	}
+}
+
+static bool bench_list_sort_isSorted(const Blah_List *list)
+{
+	for (const Blah_List_Element *element = list->first; element && element->next; element = element->next) {
+		if (bench_list_sort_compare(element->data, element->next->data) > 0) { return false; }
+	}
+	return true;
+}
+
+static void bench_list_sort_measure(const char *name, void (*sort)(Blah_List*, blah_list_sort_func*),
+	Bench_List_Sort_Item **order, size_t count)
+{	//Prints the best time of sorting a list built in the given order
+	Blah_List list;
+	uint64_t bestTime = UINT64_MAX;
+	bool sorted = true;
+
+	Blah_List_init(&list, "bench");
+	for (int repeat = 0; repeat < BENCH_LIST_SORT_REPEATS; repeat++) {
+		blah_list_pool_destroyAll(); //Fresh slabs, so list elements start out in order in memory
+		for (size_t index = 0; index < count; index++) { Blah_List_appendElement(&list, order[index]); }
+		const uint64_t startTime = blah_time_getNanoseconds();
+		sort(&list, bench_list_sort_compare);
+		const uint64_t elapsed = blah_time_getNanoseconds() - startTime;
+		if (elapsed < bestTime) { bestTime = elapsed; }
+		sorted = sorted && bench_list_sort_isSorted(&list);
+		Blah_List_removeAll(&list);
+	}
+	printf("%7zu elements  %-28s %10.3f ms%s\n", count, name, bestTime / 1e6, sorted ? "" : "  NOT SORTED");
+}
+
+/* Main */
+
+int main()
+{
+	static const size_t counts[] = {10000, 100000};
+
+	srand(5);
+	for (size_t sizeIndex = 0; sizeIndex < sizeof(counts) / sizeof(counts[0]); sizeIndex++) {
+		const size_t count = counts[sizeIndex];
+		Bench_List_Sort_Item *items = malloc(count * sizeof(Bench_List_Sort_Item));
+		Bench_List_Sort_Item **order = malloc(count * sizeof(Bench_List_Sort_Item*));
+
+		for (size_t index = 0; index < count; index++) { //Random order
+			items[index].depth = (float)rand() / RAND_MAX * 1000;
+			order[index] = &items[index];
+		}
+		bench_list_sort_measure("random, Blah_List_sort", Blah_List_sort, order, count);
+		bench_list_sort_measure("random, Blah_List_sortNearly", Blah_List_sortNearly, order, count);
+		if (count <= 10000) { bench_list_sort_measure("random, insertion sort", bench_list_sort_insertion, order, count); }
+
+		for (size_t index = 0; index < count; index++) { //Sorted order, as left by the last frame's sort
+			items[index].depth = (float)index;
+		}
+		for (size_t index = 0; index < count; index += BENCH_LIST_SORT_MOVED) { //Then some items move a little
+			items[index].depth += (float)(rand() % 21 - 10);
+		}
+		bench_list_sort_measure("nearly sorted, Blah_List_sort", Blah_List_sort, order, count);
+		bench_list_sort_measure("nearly sorted, sortNearly", Blah_List_sortNearly, order, count);
+		bench_list_sort_measure("nearly sorted, insertion", bench_list_sort_insertion, order, count);
+		free(order);
+		free(items);
+	}
+	return 0;
+}
@@ -0,0 +1,90 @@
+/* bench_log.c
+	Measures logging with messages written by the calling thread and with the writer thread of
+	blah_debug_setAsync.  Messages are logged in bursts of a frame's worth, waiting for them to be
+	written after each burst, and then without pause so that the ring buffer fills.  Prints the
+	messages written per second and the time each call took in the logging thread, and the cost of
+	a verbose message while verbose messages are disabled. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "blah_debug.h"
+#include "blah_time.h"
+
+/* Definitions */
+
+#define BENCH_LOG_MESSAGES 100000	//Messages logged in each run
+#define BENCH_LOG_BURST 1024		//Messages logged between flushes, as in a busy frame
+#define BENCH_LOG_DISABLED 10000000	//Disabled verbose messages timed
+#define BENCH_LOG_SYNC_NAME "bench_log_sync"
+#define BENCH_LOG_ASYNC_NAME "bench_log_async"
+
+/* Static Globals */
+
+static uint64_t latencies[BENCH_LOG_MESSAGES];
+
+/* Static Functions */
+
+static int bench_log_compare(const void *first, const void *second)
+{	//Orders latencies from shortest to longest
+	const uint64_t a = *(const uint64_t*)first, b = *(const uint64_t*)second;
+	return a < b ? -1 : a > b;
+}
+
+static void bench_log_run(const char *name, Blah_Debug_Log *log, int burst)
+{	//Logs the messages, flushing after every burst of them, and prints throughput and latencies
+	const unsigned long stallsBefore = blah_debug_getStallCount();
+	const uint64_t startTime = blah_time_getNanoseconds();
+	double totalLatency = 0;
+
+	for (int message = 0; message < BENCH_LOG_MESSAGES; message++) {
+		const uint64_t callTime = blah_time_getNanoseconds();
+		Blah_Debug_Log_message(log, "Loaded chunk %d of model %s at offset %f", message, "ship.lwo", message * 0.5);
+		latencies[message] = blah_time_getNanoseconds() - callTime;
+		if (burst && message % burst == burst - 1) { blah_debug_flush(); }
+	}
+	blah_debug_flush();
+	const uint64_t elapsed = blah_time_getNanoseconds() - startTime;
+
+	qsort(latencies, BENCH_LOG_MESSAGES, sizeof(uint64_t), bench_log_compare);
+	for (int message = 0; message < BENCH_LOG_MESSAGES; message++) { totalLatency += latencies[message]; }
+	printf("%-16s %10.0f msg/s   caller avg %7.0f ns  p50 %7llu ns  p99 %8llu ns  max %9llu ns  stalls %lu\n",
+		name, BENCH_LOG_MESSAGES / (elapsed / 1e9), totalLatency / BENCH_LOG_MESSAGES,
+		(unsigned long long)latencies[BENCH_LOG_MESSAGES / 2], (unsigned long long)latencies[BENCH_LOG_MESSAGES * 99 / 100],
+		(unsigned long long)latencies[BENCH_LOG_MESSAGES - 1], blah_debug_getStallCount() - stallsBefore);
+}
+
+/* Main */
+
+int main()
+{
+	Blah_Debug_Log *syncLog, *asyncLog;
+	uint64_t startTime;
+
+	syncLog = Blah_Debug_Log_new(BENCH_LOG_SYNC_NAME);
+	if (syncLog == NULL) { return 1; }
+	bench_log_run("sync bursts", syncLog, BENCH_LOG_BURST);
+	bench_log_run("sync sustained", syncLog, 0);
+	Blah_Debug_Log_destroy(syncLog);
+
+	if (!blah_debug_setAsync(true)) { printf("writer thread could not be started\n"); return 1; }
+	asyncLog = Blah_Debug_Log_new(BENCH_LOG_ASYNC_NAME);
+	if (asyncLog == NULL) { return 1; }
+	bench_log_run("async bursts", asyncLog, BENCH_LOG_BURST);
+	bench_log_run("async sustained", asyncLog, 0);
+
+	blah_debug_setLevel(BLAH_DEBUG_LEVEL_INFO);
+	startTime = blah_time_getNanoseconds();
+	for (int message = 0; message < BENCH_LOG_DISABLED; message++) {
+		BLAH_DEBUG_LOG_VERBOSE(asyncLog, "Visited node %d", message);
+		__asm__ volatile("" ::: "memory");	//Reloads the level each time, as a loop doing other work would
+	}
+	printf("%-16s %10.2f ns per message\n", "verbose disabled",
+		(blah_time_getNanoseconds() - startTime) / (double)BENCH_LOG_DISABLED);
+
+	Blah_Debug_Log_destroy(asyncLog);
+	blah_debug_setAsync(false);
+	remove(BENCH_LOG_SYNC_NAME ".log");
+	remove(BENCH_LOG_ASYNC_NAME ".log");
+	return 0;
+}
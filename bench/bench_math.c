@@ -0,0 +1,116 @@
+/* bench_math.c
+	Measures the throughput of the inline math layer of blah_math.h, against the per point loop the
+	array transforms replaced.  Built once for each instruction set by the Makefile, as the tests are. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blah_math.h"
+#include "blah_time.h"
+
+/* Definitions */
+
+#define BENCH_MATH_COUNT 4096	//Points and matrices per pass, small enough to stay in cache
+#define BENCH_MATH_POINT_PASSES 2000
+#define BENCH_MATH_MATRIX_PASSES 500
+#define BENCH_MATH_QUATERNIONS 10000000
+
+/* Static Globals */
+
+static Blah_Point points[BENCH_MATH_COUNT];
+static Blah_Matrix matrices[BENCH_MATH_COUNT];
+static volatile float sink;	//Keeps results live
+
+/* Static Functions */
+
+__attribute__((noinline)) static void bench_math_scalarTransformPoint(float *point, const float *elements)
+{	//Transforms the point as Blah_Point_multiplyMatrix did before the math layer
+	float result[3] = {0, 0, 0};
+	for (int row = 0; row < 3; row++) {
+		int elementIndex = row;
+		for (int column = 0; column < 3; column++) {
+			result[row] += point[column] * elements[elementIndex];
+			elementIndex += 4;
+		}
+		result[row] += elements[elementIndex];
+	}
+	memcpy(point, result, sizeof(result));
+}
+
+static void bench_math_report(const char *name, uint64_t startTime, double operations, const char *unit)
+{	//Prints the mean time per operation since startTime
+	printf("%-34s %7.2f ns/%s\n", name, (blah_time_getNanoseconds() - startTime) / operations, unit);
+}
+
+/* Main */
+
+int main()
+{
+	Blah_Matrix matrix;
+	float *elements = (float*)&matrix;
+	Blah_Quaternion quat = {0.1f, 0.2f, 0.3f, 0.9f}, step = {0.01f, 0, 0, 0.99995f};
+	uint64_t startTime;
+
+	for (int index = 0; index < 16; index++) { elements[index] = (float)rand() / RAND_MAX; }
+	for (int index = 0; index < BENCH_MATH_COUNT; index++) {
+		points[index] = (Blah_Point){index, -index, 0.5f * index};
+		matrices[index] = matrix;
+		((float*)&matrices[index])[index & 15] += 1;
+	}
+
+	startTime = blah_time_getNanoseconds();
+	for (int pass = 0; pass < BENCH_MATH_POINT_PASSES; pass++) {
+		for (int index = 0; index < BENCH_MATH_COUNT; index++) { bench_math_scalarTransformPoint((float*)&points[index], elements); }
+		sink += points[pass].x;
+	}
+	bench_math_report("points, plain C per point", startTime, (double)BENCH_MATH_POINT_PASSES * BENCH_MATH_COUNT, "point");
+
+	startTime = blah_time_getNanoseconds();
+	for (int pass = 0; pass < BENCH_MATH_POINT_PASSES; pass++) {
+		blah_math_transformPoints(points, points, BENCH_MATH_COUNT, &matrix);
+		sink += points[pass].x;
+	}
+	bench_math_report("points, blah_math_transformPoints", startTime, (double)BENCH_MATH_POINT_PASSES * BENCH_MATH_COUNT, "point");
+
+	startTime = blah_time_getNanoseconds();
+	for (int pass = 0; pass < BENCH_MATH_POINT_PASSES; pass++) {
+		for (int index = 0; index < BENCH_MATH_COUNT; index++) { blah_math_transformPoint(&points[index], &points[index], &matrix); }
+		sink += points[pass].x;
+	}
+	bench_math_report("points, blah_math_transformPoint", startTime, (double)BENCH_MATH_POINT_PASSES * BENCH_MATH_COUNT, "point");
+
+	startTime = blah_time_getNanoseconds();
+	for (int pass = 0; pass < BENCH_MATH_MATRIX_PASSES; pass++) {
+		for (int index = 1; index < BENCH_MATH_COUNT; index++) { blah_math_multiplyMatrices(&matrices[index], &matrices[index - 1], &matrices[index]); }
+		sink += elements[pass & 15];
+	}
+	bench_math_report("matrix multiply", startTime, (double)BENCH_MATH_MATRIX_PASSES * (BENCH_MATH_COUNT - 1), "matrix");
+
+	startTime = blah_time_getNanoseconds();
+	for (int pass = 0; pass < BENCH_MATH_MATRIX_PASSES; pass++) {
+		for (int index = 0; index < BENCH_MATH_COUNT; index++) { blah_math_invertMatrix(&matrices[index], &matrices[index]); }
+		sink += elements[pass & 15];
+	}
+	bench_math_report("matrix invert", startTime, (double)BENCH_MATH_MATRIX_PASSES * BENCH_MATH_COUNT, "matrix");
+
+	blah_math_normaliseQuaternion(&quat);
+	blah_math_normaliseQuaternion(&step);
+	startTime = blah_time_getNanoseconds();
+	for (int index = 0; index < BENCH_MATH_QUATERNIONS; index++) {
+		blah_math_multiplyQuaternions(&quat, &quat, &step);
+		if ((index & 1023) == 0) { blah_math_normaliseQuaternion(&quat); } //Keep rounding from drifting
+	}
+	sink += quat.x;
+	bench_math_report("quaternion multiply", startTime, BENCH_MATH_QUATERNIONS, "quaternion");
+
+	startTime = blah_time_getNanoseconds();
+	for (int index = 0; index < BENCH_MATH_QUATERNIONS; index++) {
+		Blah_Quaternion interpolated;
+		blah_math_slerpQuaternions(&interpolated, &quat, &step, (index & 255) / 256.0f);
+		sink += interpolated.x;
+	}
+	bench_math_report("quaternion slerp", startTime, BENCH_MATH_QUATERNIONS, "quaternion");
+
+	return 0;
+}
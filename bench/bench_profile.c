@@ -0,0 +1,82 @@
+/* bench_profile.c
+	Measures the cost of a profiler zone, timing a million zones around a trivial body, with recording
+	off, with recording on, and nested two deep, less the time of the body alone, which is also the
+	cost of a zone when built with BLAH_NO_PROFILE.  The cost of reading the monotonic clock, twice of
+	which goes to each recorded zone, is printed for comparison.  Prints the best of several runs. */
+
+#include <stdio.h>
+
+#include "blah_profile.h"
+#include "blah_time.h"
+
+/* Definitions */
+
+#define BENCH_PROFILE_ZONES 1000000
+#define BENCH_PROFILE_REPEATS 5
+
+/* Type Definitions */
+
+typedef enum Bench_Profile_Case {BENCH_PROFILE_BODY, BENCH_PROFILE_OFF, BENCH_PROFILE_ON, BENCH_PROFILE_NESTED,
+	BENCH_PROFILE_CLOCK, BENCH_PROFILE_CASES} bench_profile_case;
+
+/* Static Globals */
+
+static volatile int sink;	//Body of each zone, so that the loop is not removed
+
+/* Static Functions */
+
+static uint64_t bench_profile_run(bench_profile_case testCase)
+{	//Times the zones of the given case, returning the best time of a run
+	uint64_t bestTime = UINT64_MAX;
+
+	blah_profile_setEnabled(testCase == BENCH_PROFILE_ON || testCase == BENCH_PROFILE_NESTED);
+	for (int repeat = 0; repeat < BENCH_PROFILE_REPEATS; repeat++) {
+		const uint64_t startTime = blah_time_getNanoseconds();
+		switch (testCase) {
+			case BENCH_PROFILE_BODY:
+				for (int index = 0; index < BENCH_PROFILE_ZONES; index++) { sink = index; }
+				break;
+			case BENCH_PROFILE_NESTED:
+				for (int index = 0; index < BENCH_PROFILE_ZONES; index++) {
+					BLAH_PROFILE_BEGIN("outer");
+					BLAH_PROFILE_BEGIN("inner");
+					sink = index;
+					BLAH_PROFILE_END();
+					BLAH_PROFILE_END();
+				}
+				break;
+			case BENCH_PROFILE_CLOCK:
+				for (int index = 0; index < BENCH_PROFILE_ZONES; index++) { sink = (int)blah_time_getNanoseconds(); }
+				break;
+			default:
+				for (int index = 0; index < BENCH_PROFILE_ZONES; index++) {
+					BLAH_PROFILE_BEGIN("zone");
+					sink = index;
+					BLAH_PROFILE_END();
+				}
+				break;
+		}
+		const uint64_t elapsed = blah_time_getNanoseconds() - startTime;
+		if (elapsed < bestTime) { bestTime = elapsed; }
+		blah_profile_clear();
+	}
+	return bestTime;
+}
+
+/* Main */
+
+int main()
+{
+	static const char *caseNames[] = {"body alone", "recording off", "recording on", "nested pair", "clock read"};
+	uint64_t times[BENCH_PROFILE_CASES];
+
+	for (bench_profile_case testCase = 0; testCase < BENCH_PROFILE_CASES; testCase++) { times[testCase] = bench_profile_run(testCase); }
+	for (bench_profile_case testCase = 0; testCase < BENCH_PROFILE_CASES; testCase++) {
+		const uint64_t overhead = testCase == BENCH_PROFILE_BODY || testCase == BENCH_PROFILE_CLOCK ? times[testCase]
+			: times[testCase] - times[BENCH_PROFILE_BODY];
+		printf("%-14s %7.1f ns%s\n", caseNames[testCase], (double)overhead / BENCH_PROFILE_ZONES,
+			testCase == BENCH_PROFILE_NESTED ? " for both zones" : testCase == BENCH_PROFILE_CLOCK || testCase == BENCH_PROFILE_BODY ? "" : " per zone");
+	}
+	blah_profile_exit();
+	return 0;
+}
@@ -0,0 +1,154 @@
+/* bench_reader.c
+	Measures the throughput of typed reads through each file reader backend, reading a 32MB file
+	from start to end a value at a time, for each size of value.  The backends are a reader of the
+	file's contents in memory, a mapped reader, a buffered reader and a stream reader over a small
+	4KB buffer.  The old path, reading each value from a FILE with the blah_file_read functions, or
+	fgetc for bytes as the IFF loader did, is measured for comparison.  The file is read from the
+	page cache.  Prints the best rate of several reads of each, in MB/s. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "blah_file.h"
+#include "blah_time.h"
+
+/* Definitions */
+
+#define BENCH_READER_LENGTH (32 << 20)
+#define BENCH_READER_REPEATS 3
+#define BENCH_READER_STREAM_BUFFER_SIZE 4096
+#define BENCH_READER_FILE_NAME "bench_reader.bin"
+
+/* Type Definitions */
+
+typedef enum Bench_Reader_Type {BENCH_READER_UNSIGNED8, BENCH_READER_BIG16, BENCH_READER_BIG32,
+	BENCH_READER_BIG_FLOAT32, BENCH_READER_LITTLE32, BENCH_READER_TYPES} bench_reader_type;
+
+typedef enum Bench_Reader_Source {BENCH_READER_MEMORY, BENCH_READER_MAPPED, BENCH_READER_BUFFERED,
+	BENCH_READER_STREAM, BENCH_READER_STDIO, BENCH_READER_SOURCES} bench_reader_source;
+
+/* Static Functions */
+
+static double bench_reader_sumReader(Blah_File_Reader *reader, bench_reader_type type)
+{	//Reads values of the given type until the end of the reader, returning their sum
+	double sum = 0;
+
+	switch (type) {
+		case BENCH_READER_UNSIGNED8: {
+			blah_unsigned8 value;
+			while (Blah_File_Reader_readUnsigned8(reader, &value)) { sum += value; }
+			break;
+		}
+		case BENCH_READER_BIG16: {
+			blah_unsigned16 value;
+			while (Blah_File_Reader_readBigUnsigned16(reader, &value)) { sum += value; }
+			break;
+		}
+		case BENCH_READER_BIG32: {
+			blah_unsigned32 value;
+			while (Blah_File_Reader_readBigUnsigned32(reader, &value)) { sum += value; }
+			break;
+		}
+		case BENCH_READER_BIG_FLOAT32: {
+			blah_float32 value;
+			while (Blah_File_Reader_readBigFloat32(reader, &value)) { sum += value; }
+			break;
+		}
+		default: {
+			blah_unsigned32 value;
+			while (Blah_File_Reader_readLittleUnsigned32(reader, &value)) { sum += value; }
+			break;
+		}
+	}
+	return sum;
+}
+
+static double bench_reader_sumFile(FILE *file, bench_reader_type type)
+{	//Reads values of the given type a call at a time until the end of the file, returning their sum
+	double sum = 0;
+
+	switch (type) {
+		case BENCH_READER_UNSIGNED8: {
+			int value;
+			while ((value = fgetc(file)) != EOF) { sum += value; }
+			break;
+		}
+		case BENCH_READER_BIG16: {
+			blah_unsigned16 value;
+			while (blah_file_readUnsigned16(file, &value)) { sum += value; }
+			break;
+		}
+		case BENCH_READER_BIG_FLOAT32: {
+			blah_float32 value;
+			while (blah_file_readFloat32(file, &value)) { sum += value; }
+			break;
+		}
+		default: {
+			blah_unsigned32 value;
+			while (blah_file_readUnsigned32(file, &value)) { sum += value; }
+			break;
+		}
+	}
+	return sum;
+}
+
+static void bench_reader_measure(const blah_unsigned8 *data, bench_reader_type type)
+{	//Reads the file with values of the given type from each source, printing the best rate of each
+	static const char *typeNames[] = {"unsigned 8", "big 16", "big 32", "big float 32", "little 32"};
+
+	printf("%-13s", typeNames[type]);
+	for (bench_reader_source source = 0; source < BENCH_READER_SOURCES; source++) {
+		uint64_t bestTime = UINT64_MAX;
+		volatile double sum;
+
+		for (int repeat = 0; repeat < BENCH_READER_REPEATS; repeat++) { //Opening the file is part of reading it
+			Blah_File_Reader reader;
+			FILE *file = NULL;
+			bool opened = true;
+			const uint64_t startTime = blah_time_getNanoseconds();
+			switch (source) {
+				case BENCH_READER_MEMORY: Blah_File_Reader_initMemory(&reader, data, BENCH_READER_LENGTH); break;
+				case BENCH_READER_MAPPED: opened = Blah_File_Reader_open(&reader, BENCH_READER_FILE_NAME, BLAH_FILE_READER_MAPPED); break;
+				case BENCH_READER_BUFFERED: opened = Blah_File_Reader_open(&reader, BENCH_READER_FILE_NAME, BLAH_FILE_READER_BUFFERED); break;
+				default:
+					file = blah_file_open(BENCH_READER_FILE_NAME, "rb");
+					opened = file != NULL && (source == BENCH_READER_STDIO || Blah_File_Reader_initStream(&reader, file, BENCH_READER_STREAM_BUFFER_SIZE));
+					break;
+			}
+			if (!opened) { printf("failed to open %s\n", BENCH_READER_FILE_NAME); return; }
+			if (source == BENCH_READER_STDIO) {
+				sum = bench_reader_sumFile(file, type);
+			} else {
+				sum = bench_reader_sumReader(&reader, type);
+				Blah_File_Reader_close(&reader);
+			}
+			if (file) { fclose(file); }
+			const uint64_t elapsed = blah_time_getNanoseconds() - startTime;
+			if (elapsed < bestTime) { bestTime = elapsed; }
+		}
+		(void)sum;
+		printf(" %9.1f", BENCH_READER_LENGTH / (bestTime / 1e9) / 1e6);
+	}
+	printf("\n");
+}
+
+/* Main */
+
+int main()
+{
+	blah_unsigned8 *data = malloc(BENCH_READER_LENGTH);
+	FILE *file;
+
+	if (data == NULL) { return 1; }
+	srand(1);
+	for (size_t index = 0; index < BENCH_READER_LENGTH; index++) { data[index] = rand(); }
+	file = fopen(BENCH_READER_FILE_NAME, "wb");
+	if (file == NULL || fwrite(data, 1, BENCH_READER_LENGTH, file) != BENCH_READER_LENGTH) { printf("failed to write %s\n", BENCH_READER_FILE_NAME); return 1; }
+	fclose(file);
+
+	printf("MB/s         %9s %9s %9s %9s %9s\n", "memory", "mapped", "buffered", "stream 4K", "stdio");
+	for (bench_reader_type type = 0; type < BENCH_READER_TYPES; type++) { bench_reader_measure(data, type); }
+	remove(BENCH_READER_FILE_NAME);
+	free(data);
+	return 0;
+}
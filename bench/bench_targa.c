@@ -0,0 +1,126 @@
+/* bench_targa.c
+	Measures decoding 4096x4096 targa images of each supported type, from memory and from a file
+	through each reader backend.  The run length encoded images mix raw runs with repeated runs of
+	various lengths, as in painted textures.  Prints the best of several decodes of each. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blah_file.h"
+#include "blah_image.h"
+#include "blah_image_targa.h"
+#include "blah_time.h"
+
+/* Definitions */
+
+#define BENCH_TARGA_SIDE 4096
+#define BENCH_TARGA_REPEATS 5
+#define BENCH_TARGA_HEADER_LENGTH 18
+#define BENCH_TARGA_MAP_COUNT 256
+#define BENCH_TARGA_FILE_NAME "bench_targa.tga"
+
+/* Static Functions */
+
+static size_t bench_targa_generate(uint8_t *data, uint8_t type, uint8_t pixelSize)
+{	//Writes a 4096x4096 targa image of the given type and returns its length
+	const bool mapped = type == BLAH_IMAGE_TARGA_MAPPED || type == BLAH_IMAGE_TARGA_RLE_MAPPED;
+	const bool encoded = type == BLAH_IMAGE_TARGA_RLE_MAPPED || type == BLAH_IMAGE_TARGA_RLE_RGB;
+	const size_t pixelByteSize = pixelSize / 8, numPixels = (size_t)BENCH_TARGA_SIDE * BENCH_TARGA_SIDE;
+	size_t length = BENCH_TARGA_HEADER_LENGTH;
+
+	memset(data, 0, BENCH_TARGA_HEADER_LENGTH);
+	data[1] = mapped;
+	data[2] = type;
+	data[5] = mapped ? BENCH_TARGA_MAP_COUNT & 255 : 0;
+	data[6] = mapped ? BENCH_TARGA_MAP_COUNT >> 8 : 0;
+	data[7] = mapped ? 32 : 0;
+	data[12] = data[14] = BENCH_TARGA_SIDE & 255;
+	data[13] = data[15] = BENCH_TARGA_SIDE >> 8;
+	data[16] = pixelSize;
+	if (mapped) {
+		for (size_t index = 0; index < BENCH_TARGA_MAP_COUNT * 4; index++) { data[length++] = rand(); }
+	}
+
+	for (size_t pixel = 0; pixel < numPixels;) {
+		size_t runLength = 1, dataPixels = 1;
+		if (encoded) { //A third of runs repeat a pixel, mostly short as at the edges of painted areas
+			const bool repeat = rand() % 3 == 0;
+			runLength = 1 + (rand() % 4 ? rand() % 16 : rand() % 128);
+			if (runLength > numPixels - pixel) { runLength = numPixels - pixel; }
+			data[length++] = (repeat ? 128 : 0) | (runLength - 1);
+			dataPixels = repeat ? 1 : runLength;
+		}
+		for (size_t index = 0; index < dataPixels * pixelByteSize; index++) {
+			data[length++] = mapped ? rand() % BENCH_TARGA_MAP_COUNT : rand();
+		}
+		pixel += runLength;
+	}
+	return length;
+}
+
+static void bench_targa_report(const char *name, const char *backend, uint64_t bestTime, const Blah_Image *image)
+{	//Prints the best decoding time and the rate at which the raster was written
+	const double rasterBytes = (double)image->width * image->height * (image->pixelDepth / 8);
+	printf("%-24s %-9s %8.2f ms %8.1f MB/s\n", name, backend, bestTime / 1e6, rasterBytes / (bestTime / 1e9) / 1e6);
+}
+
+static void bench_targa_measure(const char *name, const uint8_t *data, size_t length)
+{	//Decodes the image repeatedly from memory, then from a file through each backend
+	static const blah_file_reader_backend backends[] = {BLAH_FILE_READER_MAPPED, BLAH_FILE_READER_BUFFERED};
+	static const char *backendNames[] = {"mapped", "buffered"};
+	Blah_Image *image = NULL;
+	FILE *file;
+	uint64_t bestTime = UINT64_MAX;
+
+	for (int repeat = 0; repeat < BENCH_TARGA_REPEATS; repeat++) {
+		Blah_File_Reader reader;
+		Blah_File_Reader_initMemory(&reader, data, length);
+		const uint64_t startTime = blah_time_getNanoseconds();
+		if (image) { Blah_Image_destroy(image); }
+		image = Blah_Image_Targa_fromReader(name, &reader);
+		const uint64_t elapsed = blah_time_getNanoseconds() - startTime;
+		Blah_File_Reader_close(&reader);
+		if (elapsed < bestTime) { bestTime = elapsed; }
+	}
+	if (image == NULL) { printf("%s failed to decode\n", name); return; }
+	bench_targa_report(name, "memory", bestTime, image);
+
+	file = fopen(BENCH_TARGA_FILE_NAME, "wb");
+	if (file == NULL || fwrite(data, 1, length, file) != length) { printf("failed to write %s\n", BENCH_TARGA_FILE_NAME); return; }
+	fclose(file);
+	for (int backend = 0; backend < 2; backend++) {
+		bestTime = UINT64_MAX;
+		for (int repeat = 0; repeat < BENCH_TARGA_REPEATS; repeat++) { //Opening the file is part of decoding it
+			Blah_File_Reader reader;
+			const uint64_t startTime = blah_time_getNanoseconds();
+			Blah_Image_destroy(image);
+			if (!Blah_File_Reader_open(&reader, BENCH_TARGA_FILE_NAME, backends[backend])) { return; }
+			image = Blah_Image_Targa_fromReader(name, &reader);
+			Blah_File_Reader_close(&reader);
+			const uint64_t elapsed = blah_time_getNanoseconds() - startTime;
+			if (elapsed < bestTime) { bestTime = elapsed; }
+		}
+		bench_targa_report(name, backendNames[backend], bestTime, image);
+	}
+	Blah_Image_destroy(image);
+	remove(BENCH_TARGA_FILE_NAME);
+}
+
+/* Main */
+
+int main()
+{
+	const size_t numPixels = (size_t)BENCH_TARGA_SIDE * BENCH_TARGA_SIDE;
+	uint8_t *data = malloc(BENCH_TARGA_HEADER_LENGTH + BENCH_TARGA_MAP_COUNT * 4 + numPixels * 5);
+
+	if (data == NULL) { return 1; }
+	srand(1);
+	bench_targa_measure("RLE BGR", data, bench_targa_generate(data, BLAH_IMAGE_TARGA_RLE_RGB, 24));
+	bench_targa_measure("RLE BGRA", data, bench_targa_generate(data, BLAH_IMAGE_TARGA_RLE_RGB, 32));
+	bench_targa_measure("RLE 8 bit mapped BGRA", data, bench_targa_generate(data, BLAH_IMAGE_TARGA_RLE_MAPPED, 8));
+	bench_targa_measure("uncompressed BGR", data, bench_targa_generate(data, BLAH_IMAGE_TARGA_RGB, 24));
+	bench_targa_measure("8 bit mapped BGRA", data, bench_targa_generate(data, BLAH_IMAGE_TARGA_MAPPED, 8));
+	free(data);
+	return 0;
+}
@@ -0,0 +1,133 @@
+/* bench_texture.c
+	Measures making textures from images with their mip chains, against uploading the full size
+	level alone with Blah_Texture_gl_new, the old path.  Then walks past a row of textures, drawing
+	a few at a time, under a texture memory budget below their total size, to show the residency
+	counters as levels of textures left behind are dropped and those coming into view restored.
+	The walk is repeated with a budget above the total size, where no levels are dropped.  Drawing
+	is done on an offscreen context, so upload times are those of the software renderer. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench_video.h"
+#include "blah_image.h"
+#include "blah_texture.h"
+#include "blah_texture_gl.h"
+#include "blah_time.h"
+
+/* Definitions */
+
+#define BENCH_TEXTURE_REPEATS 5
+#define BENCH_TEXTURE_WALK_TEXTURES 64		//Textures along the walk
+#define BENCH_TEXTURE_WALK_SIDE 512
+#define BENCH_TEXTURE_WALK_VISIBLE 8		//Textures drawn in each frame
+#define BENCH_TEXTURE_WALK_STEP 10			//Frames before the next texture comes into view
+#define BENCH_TEXTURE_WALK_REPORT 60		//Frames summarised on each line
+#define BENCH_TEXTURE_WALK_BUDGET ((size_t)24 << 20)
+
+/* Static Functions */
+
+static Blah_Image *bench_texture_newImage(const char *name, unsigned int side, unsigned char pixelDepth)
+{	//Creates a square image of random pixels
+	Blah_Image *image = Blah_Image_new(name, pixelDepth, side, side, pixelDepth == 32 ? BLAH_PIXEL_FORMAT_RGBA : BLAH_PIXEL_FORMAT_RGB);
+	unsigned char *pixels = image->pixelData;
+
+	for (size_t index = 0; index < (size_t)side * side * (pixelDepth / 8); index++) { pixels[index] = rand(); }
+	return image;
+}
+
+static void bench_texture_measureLoad(unsigned int side, unsigned char pixelDepth)
+{	//Makes a texture from an image with and without its mip chain, printing the best time of each
+	Blah_Image *image = bench_texture_newImage("bench", side, pixelDepth);
+	uint64_t baseTime = UINT64_MAX, chainTime = UINT64_MAX;
+	Blah_Texture_Stats stats;
+
+	for (int repeat = 0; repeat < BENCH_TEXTURE_REPEATS; repeat++) {
+		uint64_t startTime = blah_time_getNanoseconds(), elapsed;
+		const blah_texture_handle handle = Blah_Texture_gl_new(image);
+		bench_video_finish();
+		elapsed = blah_time_getNanoseconds() - startTime;
+		if (elapsed < baseTime) { baseTime = elapsed; }
+		Blah_Texture_gl_destroy(handle);
+
+		blah_texture_main(); //Clears the upload counter
+		startTime = blah_time_getNanoseconds();
+		Blah_Texture *texture = Blah_Texture_fromImage(image);
+		bench_video_finish();
+		elapsed = blah_time_getNanoseconds() - startTime;
+		if (elapsed < chainTime) { chainTime = elapsed; }
+		blah_texture_getStats(&stats);
+		Blah_Texture_destroy(texture);
+	}
+	printf("%4ux%-4u %2u bit  full size only %8.2f ms  mip chain %8.2f ms  %3u levels  %6.2f MB uploaded\n", side, side,
+		pixelDepth, baseTime / 1e6, chainTime / 1e6, 1 + (unsigned int)__builtin_ctz(side), stats.uploadBytes / 1048576.0);
+	Blah_Image_destroy(image);
+}
+
+static void bench_texture_measureWalk(Blah_Texture **textures, size_t budget)
+{	//Draws a moving window of the textures each frame, printing the residency counters over each run of frames
+	const int numFrames = BENCH_TEXTURE_WALK_TEXTURES * BENCH_TEXTURE_WALK_STEP;
+	size_t peakUpload = 0, totalUpload = 0;
+	unsigned long dropped = 0, restored = 0;
+	uint64_t peakTime = 0;
+	Blah_Texture_Stats stats;
+
+	for (int index = 0; index < BENCH_TEXTURE_WALK_TEXTURES; index++) { //Each walk begins with all levels uploaded
+		Blah_Texture_setPinned(textures[index], true);
+		Blah_Texture_setPinned(textures[index], false);
+	}
+	blah_texture_setBudget(budget);
+	printf("budget %.0f MB of %d textures of %.2f MB\n", budget / 1048576.0, BENCH_TEXTURE_WALK_TEXTURES, textures[0]->residentBytes / 1048576.0);
+	for (int frame = 1; frame <= numFrames; frame++) {
+		const int first = frame / BENCH_TEXTURE_WALK_STEP;
+		for (int index = first; index < first + BENCH_TEXTURE_WALK_VISIBLE; index++) {
+			Blah_Texture_use(textures[index % BENCH_TEXTURE_WALK_TEXTURES]);
+		}
+		const uint64_t startTime = blah_time_getNanoseconds();
+		blah_texture_main();
+		bench_video_finish();
+		const uint64_t elapsed = blah_time_getNanoseconds() - startTime;
+		blah_texture_getStats(&stats);
+		if (elapsed > peakTime) { peakTime = elapsed; }
+		if (stats.uploadBytes > peakUpload) { peakUpload = stats.uploadBytes; }
+		totalUpload += stats.uploadBytes;
+		dropped += stats.levelsDropped;
+		restored += stats.levelsRestored;
+		if (frame % BENCH_TEXTURE_WALK_REPORT == 0) {
+			printf("frames %4d-%-4d resident %7.2f MB  uploaded %7.2f MB  peak %6.2f MB per frame  %4lu levels dropped  %4lu restored  peak %7.3f ms\n",
+				frame - BENCH_TEXTURE_WALK_REPORT + 1, frame, stats.residentBytes / 1048576.0, totalUpload / 1048576.0,
+				peakUpload / 1048576.0, dropped, restored, peakTime / 1e6);
+			peakUpload = totalUpload = 0;
+			dropped = restored = 0;
+			peakTime = 0;
+		}
+	}
+}
+
+/* Main */
+
+int main()
+{
+	Blah_Texture *textures[BENCH_TEXTURE_WALK_TEXTURES];
+
+	if (!bench_video_init(64, 64)) { return 1; }
+	srand(1);
+	bench_texture_measureLoad(256, 32);
+	bench_texture_measureLoad(1024, 32);
+	bench_texture_measureLoad(1024, 24);
+	bench_texture_measureLoad(2048, 32);
+
+	for (int index = 0; index < BENCH_TEXTURE_WALK_TEXTURES; index++) {
+		char name[16];
+		snprintf(name, sizeof(name), "walk%d", index);
+		Blah_Image *image = bench_texture_newImage(name, BENCH_TEXTURE_WALK_SIDE, 32);
+		textures[index] = Blah_Texture_fromImage(image);
+		Blah_Image_destroy(image);
+	}
+	bench_texture_measureWalk(textures, BENCH_TEXTURE_WALK_BUDGET);
+	bench_texture_measureWalk(textures, BLAH_TEXTURE_DEFAULT_BUDGET);
+
+	blah_texture_destroyAll();
+	bench_video_exit();
+	return 0;
+}
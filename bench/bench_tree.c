@@ -0,0 +1,160 @@
+/* bench_tree.c
+	Measures inserting 10k keys into a Blah_Tree in sorted order, as textures and images named by
+	number are loaded, then finding each of them in random order, and finding keys which are absent.
+	The balanced tree is measured with and without its hash index, and an unbalanced binary tree
+	like Blah_Tree before it was balanced is measured for comparison, which sorted insertion turns
+	into a linked list.  Prints the best time of several runs and the height of each tree. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blah_time.h"
+#include "blah_tree.h"
+
+/* Definitions */
+
+#define BENCH_TREE_KEYS 10000
+#define BENCH_TREE_REPEATS 5
+#define BENCH_TREE_KEY_LENGTH 16
+
+/* Structure Definitions */
+
+typedef struct Bench_Tree_Node { //Element of the unbalanced reference tree
+	char keystring[BLAH_TREE_ELEMENT_NAME_LENGTH+1];
+	struct Bench_Tree_Node *left, *right;
+	void *data;
+} Bench_Tree_Node;
+
+/* Static Globals */
+
+static char keys[BENCH_TREE_KEYS][BENCH_TREE_KEY_LENGTH];
+static char missingKeys[BENCH_TREE_KEYS][BENCH_TREE_KEY_LENGTH];
+static int lookupOrder[BENCH_TREE_KEYS];
+static Bench_Tree_Node nodes[BENCH_TREE_KEYS];
+
+/* Static Functions */
+
+static Bench_Tree_Node **bench_tree_findPosition(Bench_Tree_Node **root, const char *key)
+{	//Returns the address of the pointer to the node with the key, or where it would be inserted
+	Bench_Tree_Node **position = root;
+	int compare;
+
+	while (*position && (compare = strcmp(key, (*position)->keystring)) != 0) {
+		position = compare < 0 ? &(*position)->left : &(*position)->right;
+	}
+	return position;
+}
+
+static int bench_tree_height(const Blah_Tree_Element *element)
+{
+	return element ? element->height : 0;
+}
+
+static int bench_tree_referenceHeight(const Bench_Tree_Node *root)
+{	//Walks down the right of the reference tree, which holds every node after sorted insertion
+	int height = 0;
+	for (; root; root = root->right) { height++; }
+	return height;
+}
+
+static void bench_tree_report(const char *name, uint64_t insertTime, uint64_t findTime, uint64_t missTime, long found, int height)
+{
+	printf("%-22s insert %8.3f ms  find %8.1f ns  miss %8.1f ns  height %5d  found %ld\n", name, insertTime / 1e6,
+		(double)findTime / BENCH_TREE_KEYS, (double)missTime / BENCH_TREE_KEYS, height, found);
+}
+
+static void bench_tree_measure(bool hashIndex)
+{	//Times insertion and finding in a balanced tree, with or without its hash index
+	uint64_t insertTime = UINT64_MAX, findTime = UINT64_MAX, missTime = UINT64_MAX;
+	long found = 0;
+	int height = 0;
+
+	for (int repeat = 0; repeat < BENCH_TREE_REPEATS; repeat++) {
+		Blah_Tree tree;
+		uint64_t startTime, elapsed;
+
+		Blah_Tree_init(&tree, "bench");
+		Blah_Tree_setHashIndex(&tree, hashIndex);
+		startTime = blah_time_getNanoseconds();
+		for (int index = 0; index < BENCH_TREE_KEYS; index++) { Blah_Tree_insertElement(&tree, keys[index], keys[index]); }
+		elapsed = blah_time_getNanoseconds() - startTime;
+		if (elapsed < insertTime) { insertTime = elapsed; }
+
+		found = 0;
+		startTime = blah_time_getNanoseconds();
+		for (int index = 0; index < BENCH_TREE_KEYS; index++) { found += Blah_Tree_findElement(&tree, keys[lookupOrder[index]]) != NULL; }
+		elapsed = blah_time_getNanoseconds() - startTime;
+		if (elapsed < findTime) { findTime = elapsed; }
+
+		startTime = blah_time_getNanoseconds();
+		for (int index = 0; index < BENCH_TREE_KEYS; index++) { found += Blah_Tree_findElement(&tree, missingKeys[index]) != NULL; }
+		elapsed = blah_time_getNanoseconds() - startTime;
+		if (elapsed < missTime) { missTime = elapsed; }
+
+		height = bench_tree_height(tree.first);
+		Blah_Tree_disable(&tree);
+	}
+	bench_tree_report(hashIndex ? "balanced, hash index" : "balanced", insertTime, findTime, missTime, found, height);
+}
+
+static void bench_tree_measureReference()
+{	//Times insertion and finding in the unbalanced reference tree
+	uint64_t insertTime = UINT64_MAX, findTime = UINT64_MAX, missTime = UINT64_MAX;
+	Bench_Tree_Node *root = NULL;
+	long found = 0;
+
+	for (int repeat = 0; repeat < BENCH_TREE_REPEATS; repeat++) {
+		uint64_t startTime, elapsed;
+
+		root = NULL;
+		startTime = blah_time_getNanoseconds();
+		for (int index = 0; index < BENCH_TREE_KEYS; index++) {
+			Bench_Tree_Node **position = bench_tree_findPosition(&root, keys[index]);
+			if (*position == NULL) {
+				Bench_Tree_Node *node = &nodes[index];
+				strcpy(node->keystring, keys[index]);
+				node->left = node->right = NULL;
+				node->data = keys[index];
+				*position = node;
+			}
+		}
+		elapsed = blah_time_getNanoseconds() - startTime;
+		if (elapsed < insertTime) { insertTime = elapsed; }
+
+		found = 0;
+		startTime = blah_time_getNanoseconds();
+		for (int index = 0; index < BENCH_TREE_KEYS; index++) { found += *bench_tree_findPosition(&root, keys[lookupOrder[index]]) != NULL; }
+		elapsed = blah_time_getNanoseconds() - startTime;
+		if (elapsed < findTime) { findTime = elapsed; }
+
+		startTime = blah_time_getNanoseconds();
+		for (int index = 0; index < BENCH_TREE_KEYS; index++) { found += *bench_tree_findPosition(&root, missingKeys[index]) != NULL; }
+		elapsed = blah_time_getNanoseconds() - startTime;
+		if (elapsed < missTime) { missTime = elapsed; }
+	}
+	bench_tree_report("unbalanced reference", insertTime, findTime, missTime, found, bench_tree_referenceHeight(root));
+}
+
+/* Main */
+
+int main()
+{
+	srand(7);
+	for (int index = 0; index < BENCH_TREE_KEYS; index++) {
+		snprintf(keys[index], BENCH_TREE_KEY_LENGTH, "texture%06d", index);
+		snprintf(missingKeys[index], BENCH_TREE_KEY_LENGTH, "texture%06dx", index);
+		lookupOrder[index] = index;
+	}
+	for (int index = BENCH_TREE_KEYS - 1; index > 0; index--) { //Shuffle
+		const int other = rand() % (index + 1), swap = lookupOrder[index];
+		lookupOrder[index] = lookupOrder[other];
+		lookupOrder[other] = swap;
+	}
+
+	bench_tree_measureReference();
+	bench_tree_measure(false);
+	bench_tree_measure(true);
+	return 0;
+}
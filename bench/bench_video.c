@@ -0,0 +1,88 @@
+/* bench_video.c
+	Headless drawing context for the benchmarks.  See bench_video.h for reference. */
+
+#include <stdio.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+
+#include "bench_video.h"
+#include "blah_draw.h"
+#include "blah_draw_gl.h"
+#include "blah_video.h"
+
+/* Externally Referenced Variables */
+
+Blah_Video_Mode *blah_video_currentMode = NULL;	//Set by bench_video_init
+
+/* Static Globals */
+
+static Blah_Video_Mode bench_video_mode;
+static EGLDisplay bench_video_display = EGL_NO_DISPLAY;
+static EGLSurface bench_video_surface = EGL_NO_SURFACE;
+static EGLContext bench_video_context = EGL_NO_CONTEXT;
+
+/* Video Functions */
+
+void *blah_video_getProcAddress(const char *name)
+{	//Looks up OpenGL extension functions through EGL
+	return (void*)eglGetProcAddress(name);
+}
+
+/* Function Definitions */
+
+void bench_video_exit()
+{
+	if (bench_video_display == EGL_NO_DISPLAY) { return; }
+	eglMakeCurrent(bench_video_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext(bench_video_display, bench_video_context);
+	eglDestroySurface(bench_video_display, bench_video_surface);
+	eglTerminate(bench_video_display);
+	bench_video_display = EGL_NO_DISPLAY;
+	blah_video_currentMode = NULL;
+}
+
+void bench_video_finish()
+{
+	glFinish();
+}
+
+bool bench_video_init(unsigned int width, unsigned int height)
+{	//Makes a pbuffer surface on a display without a window system, falling back to the default display
+	const EGLint configAttributes[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8, EGL_DEPTH_SIZE, 16, EGL_NONE};
+	const EGLint surfaceAttributes[] = {EGL_WIDTH, (EGLint)width, EGL_HEIGHT, (EGLint)height, EGL_NONE};
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	EGLConfig config;
+	EGLint numConfigs = 0;
+
+	if (getPlatformDisplay) { bench_video_display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL); }
+	if (bench_video_display == EGL_NO_DISPLAY) { bench_video_display = eglGetDisplay(EGL_DEFAULT_DISPLAY); }
+	if (bench_video_display == EGL_NO_DISPLAY || !eglInitialize(bench_video_display, NULL, NULL)) {
+		printf("bench_video: no EGL display\n");
+		return false;
+	}
+	if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(bench_video_display, configAttributes, &config, 1, &numConfigs) || numConfigs == 0) {
+		printf("bench_video: no OpenGL configuration with pbuffers\n");
+		eglTerminate(bench_video_display);
+		bench_video_display = EGL_NO_DISPLAY;
+		return false;
+	}
+	bench_video_surface = eglCreatePbufferSurface(bench_video_display, config, surfaceAttributes);
+	bench_video_context = eglCreateContext(bench_video_display, config, EGL_NO_CONTEXT, NULL);
+	if (bench_video_surface == EGL_NO_SURFACE || bench_video_context == EGL_NO_CONTEXT
+		|| !eglMakeCurrent(bench_video_display, bench_video_surface, bench_video_surface, bench_video_context)) {
+		printf("bench_video: failed to make OpenGL context current\n");
+		bench_video_exit();
+		return false;
+	}
+
+	bench_video_mode.width = width;
+	bench_video_mode.height = height;
+	bench_video_mode.colourDepth = 32;
+	blah_video_currentMode = &bench_video_mode;
+	blah_draw_init();
+	blah_draw_gl_init();
+	glViewport(0, 0, width, height);
+	return true;
+}
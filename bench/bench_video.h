@@ -0,0 +1,24 @@
+/* bench_video.h
+	Headless drawing context for the benchmarks.  Stands in for blah_video.c, which needs SDL, with
+	an offscreen OpenGL context made through EGL, so that drawing benchmarks run on Mesa's software
+	renderer where no display is available. */
+
+#ifndef _BENCH_VIDEO
+
+#define _BENCH_VIDEO
+
+#include "blah_types.h"
+
+/* Function Prototypes */
+
+void bench_video_exit();
+	//Destroys the drawing context made by bench_video_init
+
+void bench_video_finish();
+	//Waits until all drawing commands have completed, so that they are counted in timings
+
+bool bench_video_init(unsigned int width, unsigned int height);
+	//Makes an offscreen drawing context of the given size current, and initialises the drawing
+	//state for it.  Returns false if no context could be made, printing the reason.
+
+#endif
@@ -4,31 +4,42 @@
 
 #define _BLAH_ALL
 
+#include "blah_array.h"
+#include "blah_atlas.h"
 #include "blah_colour.h"
 #include "blah_console.h"
 #include "blah_debug.h"
 #include "blah_draw.h"
+#include "blah_draw_layer.h"
 #include "blah_engine.h"
 #include "blah_entity.h"
+#include "blah_entity_broadphase.h"
+#include "blah_entity_store.h"
 #include "blah_entity_object.h"
 #include "blah_file.h"
 #include "blah_font.h"
 #include "blah_image.h"
 #include "blah_input.h"
 #include "blah_input_keyboard.h"
+#include "blah_job.h"
 #include "blah_list.h"
+#include "blah_loader.h"
 #include "blah_macros.h"
+#include "blah_math.h"
 #include "blah_matrix.h"
+#include "blah_mesh.h"
 #include "blah_model.h"
 #include "blah_model_lightwave.h"
 #include "blah_object.h"
 #include "blah_overlay.h"
 #include "blah_point.h"
 #include "blah_primitive.h"
+#include "blah_profile.h"
 #include "blah_quaternion.h"
 #include "blah_scene.h"
 #include "blah_scene_object.h"
 #include "blah_texture.h"
+#include "blah_transform.h"
 #include "blah_types.h"
 #include "blah_util.h"
 #include "blah_vector.h"
@@ -0,0 +1,213 @@
+/* blah_array.c
+	Defines functions operating upon growable arrays of data pointers.  See blah_array.h for reference. */
+
+#include <malloc.h>
+#include <string.h>
+
+#include "blah_array.h"
+#include "blah_types.h"
+#include "blah_util.h"
+#include "blah_error.h"
+
+/* Static Function Definitions */
+
+static void Blah_Array_grow(Blah_Array *array)
+{	//Doubles storage allocated for data pointers
+	Blah_Array_reserve(array, array->capacity ? array->capacity * 2 : BLAH_ARRAY_INITIAL_CAPACITY);
+}
+
+static void Blah_Array_removeIndex(Blah_Array *array, size_t index)
+{	//Removes element at given index, moving all following elements down
+	array->length--;
+	memmove(&array->elements[index], &array->elements[index + 1], (array->length - index) * sizeof(void*));
+}
+
+static void Blah_Array_mergeSort(void **elements, void **buffer, size_t length, blah_array_sort_func* compareFunction)
+{	//Bottom up merge sort of elements, using buffer of same length as temporary storage.
+	//Equal elements keep their original order.
+	void **source = elements, **dest = buffer;
+
+	for (size_t width = 1; width < length; width *= 2) {
+		for (size_t left = 0; left < length; left += 2 * width) {
+			const size_t middle = left + width < length ? left + width : length;
+			const size_t right = left + 2 * width < length ? left + 2 * width : length;
+			size_t leftIndex = left, rightIndex = middle, destIndex = left;
+			while (leftIndex < middle && rightIndex < right) { //Take from right run only if strictly smaller
+				dest[destIndex++] = compareFunction(source[rightIndex], source[leftIndex]) < 0 ? source[rightIndex++] : source[leftIndex++];
+			}
+			while (leftIndex < middle) { dest[destIndex++] = source[leftIndex++]; }
+			while (rightIndex < right) { dest[destIndex++] = source[rightIndex++]; }
+		}
+		void **swap = source; source = dest; dest = swap;
+	}
+	if (source != elements) { memcpy(elements, source, length * sizeof(void*)); }
+}
+
+/* Array Function Definitions */
+
+void Blah_Array_appendElement(Blah_Array *array, void *data)
+{	//Appends a new element to the end of the array with given data ptr
+	if (array->length == array->capacity) { Blah_Array_grow(array); }
+	array->elements[array->length++] = data;
+}
+
+void Blah_Array_callFunction(Blah_Array *array, blah_array_element_func* function)
+{	//Calls function for each element, using data pointer as argument to given function
+	size_t index = 0;
+
+	while (index < array->length) {
+		void *data = array->elements[index];
+		function(data);
+		//Only advance if function didn't remove the element from the array
+		if (index < array->length && array->elements[index] == data) { index++; }
+	}
+}
+
+void Blah_Array_callWithArg(Blah_Array *array, blah_array_element_func_1arg* function, void *arg)
+{	//Calls function for each element, using data pointer and arg as arguments to given function
+	size_t index = 0;
+
+	while (index < array->length) {
+		void *data = array->elements[index];
+		function(data, arg);
+		//Only advance if function didn't remove the element from the array
+		if (index < array->length && array->elements[index] == data) { index++; }
+	}
+}
+
+blah_pointerstring Blah_Array_createPointerstring(const Blah_Array *array)
+{	//Returns an allocated, NULL pointer terminated copy of the array's data pointers
+	void **newPointerArray = malloc(sizeof(void*) * (array->length + 1));
+
+	if (newPointerArray != NULL) {
+		if (array->length > 0) { memcpy(newPointerArray, array->elements, array->length * sizeof(void*)); }
+		newPointerArray[array->length] = NULL;
+	}
+	return newPointerArray;
+}
+
+void Blah_Array_destroy(Blah_Array *array)
+{	//Clears all memory occupied by array, element data and the array structure itself
+	Blah_Array_destroyElements(array);
+	Blah_Array_disable(array);
+	free(array);
+}
+
+void Blah_Array_destroyElements(Blah_Array *array)
+{	//Destroys all element data and empties array, but does not destroy basic array header
+	blah_array_element_dest_func* destFunc = array->destroyElementFunction ? array->destroyElementFunction : free;
+	//If there is a valid destroy function, we will use it, else we will just use free()
+
+	//Destroy from the end, so that destroy functions removing their own data from the array
+	//do not have to move any elements
+	while (array->length > 0) {
+		destFunc(Blah_Array_popElement(array));
+	}
+}
+
+void Blah_Array_disable(Blah_Array *array)
+{	//Releases storage of data pointers.  Does not destroy element data.
+	free(array->elements);
+	array->elements = NULL;
+	array->length = array->capacity = 0;
+}
+
+long Blah_Array_findIndex(const Blah_Array *array, const void *data)
+{	//Returns index of first element with given data, or -1 if not found
+	for (size_t index = 0; index < array->length; index++) {
+		if (array->elements[index] == data) { return (long)index; }
+	}
+	return -1;
+}
+
+void *Blah_Array_getElement(const Blah_Array *array, size_t index)
+{	//Returns data pointer of element at given index, or NULL if index is out of range
+	return index < array->length ? array->elements[index] : NULL;
+}
+
+void Blah_Array_init(Blah_Array *array, const char *name)
+{	//Sets the name of the array and makes it empty
+	blah_util_strncpy(array->name, name, BLAH_ARRAY_NAME_LENGTH);
+	array->elements = NULL;
+	array->length = array->capacity = 0;
+	array->destroyElementFunction = NULL;
+}
+
+void Blah_Array_insertElement(Blah_Array *array, void *data)
+{	//Inserts a new element at the beginning of the array with given data ptr
+	if (array->length == array->capacity) { Blah_Array_grow(array); }
+	memmove(&array->elements[1], &array->elements[0], array->length * sizeof(void*));
+	array->elements[0] = data;
+	array->length++;
+}
+
+Blah_Array *Blah_Array_new(const char *name)
+{	//Creates a new empty array.  Returns NULL if error occurred.
+	Blah_Array *newArray = malloc(sizeof(Blah_Array));
+	if (newArray != NULL) { Blah_Array_init(newArray, name); }
+	return newArray;
+}
+
+void *Blah_Array_popElement(Blah_Array *array)
+{	//Removes last element from array and returns data pointer, or NULL if array is empty
+	return array->length > 0 ? array->elements[--array->length] : NULL;
+}
+
+void Blah_Array_removeAll(Blah_Array *array)
+{	//Removes all elements but retains allocated storage.  Does not free data
+	array->length = 0;
+}
+
+bool Blah_Array_removeElement(Blah_Array *array, void *data)
+{	//Removes first element with given data from array.  Returns false if not found.
+	const long index = Blah_Array_findIndex(array, data);
+
+	if (index < 0) { return false; }
+	Blah_Array_removeIndex(array, (size_t)index);
+	return true;
+}
+
+void *Blah_Array_removeIndexUnordered(Blah_Array *array, size_t index)
+{	//Removes element at given index by moving the last element into its place.
+	//Returns data pointer of the moved element, or NULL if the last element was removed.
+	if (index >= array->length) { return NULL; }
+	array->length--;
+	if (index == array->length) { return NULL; }
+	array->elements[index] = array->elements[array->length];
+	return array->elements[index];
+}
+
+void Blah_Array_reserve(Blah_Array *array, size_t capacity)
+{	//Ensures storage for at least 'capacity' elements is allocated
+	if (capacity <= array->capacity) { return; }
+
+	void **newElements = realloc(array->elements, capacity * sizeof(void*));
+	if (newElements == NULL) {
+		blah_error_raise(errno, "Failed to allocate storage for %lu elements in array '%s'", (unsigned long)capacity, array->name);
+	}
+	array->elements = newElements;
+	array->capacity = capacity;
+}
+
+void *Blah_Array_search(Blah_Array *array, blah_array_search_func* searchFunction, void *searchArg)
+{	//Returns the data pointer of the first element for which searchFunction returns true, or NULL if no match
+	for (size_t index = 0; index < array->length; index++) {
+		if (searchFunction(array->elements[index], searchArg)) { return array->elements[index]; }
+	}
+	return NULL;
+}
+
+void Blah_Array_setDestroyElementFunction(Blah_Array *array, blah_array_element_dest_func* function)
+{	//Sets the function pointer to the given function used to destroy element data
+	array->destroyElementFunction = function;
+}
+
+void Blah_Array_sort(Blah_Array *array, blah_array_sort_func* compareFunction)
+{	//Performs a stable sort of the array, using the supplied function to compare two elements
+	if (array->length < 2) { return; }
+
+	void **buffer = malloc(array->length * sizeof(void*));
+	if (buffer == NULL) { blah_error_raise(errno, "Failed to allocate buffer to sort array '%s'", array->name); }
+	Blah_Array_mergeSort(array->elements, buffer, array->length, compareFunction);
+	free(buffer);
+}
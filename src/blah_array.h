@@ -0,0 +1,123 @@
+/* blah_array.h - Implements a growable array of data pointers.
+	Offers the same callback style interface as Blah_List, but stores the data pointers contiguously
+	so that iterating over them does not chase a pointer per element.  Appending is amortised
+	constant time, while inserting or removing anywhere but the end moves the following elements. */
+
+#ifndef _BLAH_ARRAY
+
+#define _BLAH_ARRAY
+
+#include <stddef.h>
+
+#include "blah_types.h"
+
+/* Definitions */
+
+#define BLAH_ARRAY_NAME_LENGTH 20  //number of characters allowed for name property
+#define BLAH_ARRAY_INITIAL_CAPACITY 8  //number of data pointers allocated on first append
+
+/* Type Definitions */
+
+typedef bool blah_array_search_func(void* elementData, void* param); // This function type should perform a check on element_data, with given parameter supplied, and return TRUE if check passes
+typedef void blah_array_element_dest_func(void* elementData); // This type of function is used to destroy data pointed to by *element_data
+typedef void blah_array_element_func(void* elementData); // This type of function will perform some sort of non destructive operation using the object pointed to by element_data
+typedef void blah_array_element_func_1arg(void* elementData, void* param); // This type of function will perform some sort of non destructive operation using the object pointed to by element_data with supplied argument
+
+typedef int blah_array_sort_func(void* elemData1, void* elemData2);
+	// Function to sort elements in an array by comparison of two elements at a time.
+	// Function should behave like strcmp() and return a value smaller than 0
+	// if elemData1 < elemData2, return 0 if equal, or > 0 if elemData1 > elemData2
+
+/* Structure Definitions */
+
+typedef struct Blah_Array {
+	char name[BLAH_ARRAY_NAME_LENGTH+1]; //name of array
+	void** elements;				//data pointers, in order
+	size_t length;					//number of elements in the array
+	size_t capacity;				//number of data pointers allocated
+	blah_array_element_dest_func* destroyElementFunction; //custom function to destroy element data
+} Blah_Array;
+
+#ifdef __cplusplus
+	extern "C" {
+#endif //__cplusplus
+
+/* Array Function Prototypes */
+
+void Blah_Array_appendElement(Blah_Array* array, void* data);
+	//Appends a new element to the end of the array with given data ptr
+
+void Blah_Array_callFunction(Blah_Array* array, blah_array_element_func* function);
+	//Calls function for each element, using data pointer as argument to given function.
+	//The function may remove the element it was called for from the array.
+
+void Blah_Array_callWithArg(Blah_Array* array, blah_array_element_func_1arg* function, void* arg);
+	//Calls function for each element, using data pointer and arg as arguments to given function.
+	//The function may remove the element it was called for from the array.
+
+blah_pointerstring Blah_Array_createPointerstring(const Blah_Array *array);
+	//Returns an allocated array of pointers to the data contained in each of the
+	//array elements, in the order they occur.  The last element of the return array
+	//is a NULL pointer to signify the end.
+
+void Blah_Array_destroy(Blah_Array *array);
+	// Clears all memory occupied by array, element data and the array structure itself
+
+void Blah_Array_destroyElements(Blah_Array *array);
+	// Destroys all element data and empties array, but does not destroy basic array header
+
+void Blah_Array_disable(Blah_Array *array);
+	// Releases storage of data pointers.  Does not destroy element data.
+
+long Blah_Array_findIndex(const Blah_Array *array, const void *data);
+	// Returns index of first element with given data, or -1 if not found
+
+void* Blah_Array_getElement(const Blah_Array *array, size_t index);
+	// Returns data pointer of element at given index, or NULL if index is out of range
+
+void Blah_Array_init(Blah_Array *array, const char *name);
+	// Sets the name of the array and makes it empty
+
+void Blah_Array_insertElement(Blah_Array *array, void *data);
+	// Inserts a new element at the beginning of the array with given data ptr
+
+Blah_Array *Blah_Array_new(const char *name);
+	// Creates a new empty array given a name as a null terminated string in parameter 'name'.
+	// Function returns pointer to new array on success, or NULL pointer if error occurred.
+
+void *Blah_Array_popElement(Blah_Array *array);
+	// Removes last element from array and returns data pointer, or NULL if array is empty
+
+void Blah_Array_removeAll(Blah_Array *array);
+	// Removes all elements but retains allocated storage.  Does not free data
+
+bool Blah_Array_removeElement(Blah_Array *array, void *data);
+	// Removes first element with given data from array, preserving order of the remaining elements.
+	// Does not free data.  Returns false if no element has the given data.
+
+void* Blah_Array_removeIndexUnordered(Blah_Array *array, size_t index);
+	// Removes element at given index in constant time by moving the last element into its place,
+	// so the order of the remaining elements is not preserved.  Does not free data.
+	// Returns the data pointer of the element moved into 'index', or NULL if no element was moved.
+
+void Blah_Array_reserve(Blah_Array *array, size_t capacity);
+	// Ensures storage for at least 'capacity' elements is allocated
+
+void* Blah_Array_search(Blah_Array* array, blah_array_search_func* searchFunction, void* searchArg);
+	// Calls searchFunction for each element of the array, using the element's data
+	// as the first argument and 'searchArg' as second.  Returns the data pointer of the first element for which
+	// searchFunction returns true, or NULL if no match;
+
+void Blah_Array_setDestroyElementFunction(Blah_Array* array, blah_array_element_dest_func* function);
+	// Sets the function pointer to the given function used to destroy element data
+
+void Blah_Array_sort(Blah_Array* array, blah_array_sort_func* compareFunction);
+	// Performs a stable sort of the array, using the supplied function to compare two elements.
+	// compareFunction should behave like strcmp() and return a value smaller than 0
+	// if elemData1 < elemData2, return 0 if equal, or > 0 if elemData1 > elemData2
+
+#ifdef __cplusplus
+	}
+#endif //__cplusplus
+
+#endif
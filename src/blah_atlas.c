@@ -0,0 +1,268 @@
+/* blah_atlas.c
+	Defines functions which pack images into shared texture pages.  See blah_atlas.h for reference. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blah_atlas.h"
+#include "blah_error.h"
+#include "blah_util.h"
+
+/* Structure Definitions */
+
+typedef struct Blah_Atlas_Shelf { //Row of entries across a page
+	unsigned int bottom;		//Lowest pixel row of the shelf
+	unsigned int height;		//Height of the tallest padded entry on the shelf
+	unsigned int usedWidth;		//Pixels from the left taken by padded entries
+} Blah_Atlas_Shelf;
+
+/* Static Globals - Private to atlas.c */
+
+static Blah_Atlas sharedAtlas;
+static bool sharedAtlasCreated = false;
+
+/* Static Function Definitions */
+
+static void Blah_Atlas_Page_destroy(Blah_Atlas_Page *page)
+{	//Destroys the page along with its texture
+	Blah_Texture_destroy(page->texture);
+	free(page->pixelData);
+	free(page->shelves);
+	free(page);
+}
+
+static Blah_Atlas_Page *Blah_Atlas_Page_new(Blah_Atlas *atlas, blah_pixel_format pixelFormat, unsigned char pixelDepth)
+{	//Creates an empty page for the given pixel format along with its texture, and adds it to the atlas
+	Blah_Atlas_Page *page = malloc(sizeof(Blah_Atlas_Page));
+	Blah_Image pageImage = { .pixelDepth = pixelDepth, .width = atlas->pageSize, .height = atlas->pageSize, .pixelFormat = pixelFormat };
+
+	if (page == NULL) { blah_error_raise(errno, "Failed to allocate page for atlas '%s'", atlas->name); }
+	page->pixelData = calloc((size_t)atlas->pageSize * atlas->pageSize, pixelDepth >> 3);
+	if (page->pixelData == NULL) { blah_error_raise(errno, "Failed to allocate pixels of page for atlas '%s'", atlas->name); }
+	snprintf(pageImage.name, sizeof(pageImage.name), "%s:page%lu", atlas->name, atlas->pagesCreated++);
+	pageImage.pixelData = page->pixelData;
+	page->texture = Blah_Texture_fromImage(&pageImage);
+	if (page->texture == NULL) { blah_error_raise(errno, "Failed to create texture '%s' for atlas page", pageImage.name); }
+	page->pixelFormat = pixelFormat;
+	page->pixelDepth = pixelDepth;
+	page->shelves = NULL;
+	page->shelfCount = page->shelfCapacity = 0;
+	page->entryCount = 0;
+	page->usedPixels = 0;
+	page->dirty = false;
+	Blah_List_appendElement(&atlas->pages, page);
+	return page;
+}
+
+static bool Blah_Atlas_Page_place(Blah_Atlas_Page *page, unsigned int pageSize, unsigned int paddedWidth,
+	unsigned int paddedHeight, unsigned int *left, unsigned int *bottom)
+{	//Finds room for a padded entry of given size on the page, storing its bottom left corner.
+	//Returns false if the page has no room.
+	Blah_Atlas_Shelf *bestShelf = NULL;
+	const unsigned int shelvesTop = page->shelfCount ? page->shelves[page->shelfCount - 1].bottom + page->shelves[page->shelfCount - 1].height : 0;
+
+	//Use the lowest shelf the entry fits on, unless that wastes over half its height and a new shelf fits
+	for (unsigned int shelfIndex = 0; shelfIndex < page->shelfCount; shelfIndex++) {
+		Blah_Atlas_Shelf *shelf = &page->shelves[shelfIndex];
+		if (shelf->height >= paddedHeight && pageSize - shelf->usedWidth >= paddedWidth
+			&& (bestShelf == NULL || shelf->height < bestShelf->height)) {
+			bestShelf = shelf;
+		}
+	}
+	if ((bestShelf == NULL || bestShelf->height > paddedHeight * 2) && pageSize - shelvesTop >= paddedHeight) {
+		if (page->shelfCount == page->shelfCapacity) {
+			const unsigned int newCapacity = page->shelfCapacity ? page->shelfCapacity * 2 : 8;
+			Blah_Atlas_Shelf *newShelves = realloc(page->shelves, newCapacity * sizeof(Blah_Atlas_Shelf));
+			if (newShelves == NULL) { blah_error_raise(errno, "Failed to grow shelves of atlas page"); }
+			page->shelves = newShelves;
+			page->shelfCapacity = newCapacity;
+		}
+		bestShelf = &page->shelves[page->shelfCount++];
+		bestShelf->bottom = shelvesTop;
+		bestShelf->height = paddedHeight;
+		bestShelf->usedWidth = 0;
+	}
+	if (bestShelf == NULL) { return false; }
+
+	*left = bestShelf->usedWidth;
+	*bottom = bestShelf->bottom;
+	bestShelf->usedWidth += paddedWidth;
+	return true;
+}
+
+static void Blah_Atlas_Page_copyPixels(Blah_Atlas_Page *page, unsigned int pageSize, unsigned int x, unsigned int y,
+	unsigned int width, unsigned int height, const unsigned char *pixelData)
+{	//Copies an image into the page with its bottom left at x,y, repeating its edge pixels into the padding
+	const size_t pixelBytes = page->pixelDepth >> 3, rowBytes = width * pixelBytes, pageRowBytes = pageSize * pixelBytes;
+
+	for (int row = -BLAH_ATLAS_PADDING; row < (int)height + BLAH_ATLAS_PADDING; row++) {
+		const unsigned int sourceRow = row < 0 ? 0 : (row >= (int)height ? height - 1 : (unsigned int)row);
+		const unsigned char *source = pixelData + sourceRow * rowBytes;
+		unsigned char *dest = page->pixelData + (y + row) * pageRowBytes + (x - BLAH_ATLAS_PADDING) * pixelBytes;
+		for (int pad = 0; pad < BLAH_ATLAS_PADDING; pad++, dest += pixelBytes) { memcpy(dest, source, pixelBytes); }
+		memcpy(dest, source, rowBytes);
+		dest += rowBytes;
+		for (int pad = 0; pad < BLAH_ATLAS_PADDING; pad++, dest += pixelBytes) { memcpy(dest, source + rowBytes - pixelBytes, pixelBytes); }
+	}
+	page->dirty = true;
+}
+
+static Blah_Atlas_Entry *Blah_Atlas_addPixels(Blah_Atlas *atlas, const char *name, unsigned int width, unsigned int height,
+	blah_pixel_format pixelFormat, unsigned char pixelDepth, const void *pixelData)
+{	//Packs pixel data of an image into the first page of the same format with room, creating a page if none has
+	const unsigned int paddedWidth = width + 2 * BLAH_ATLAS_PADDING, paddedHeight = height + 2 * BLAH_ATLAS_PADDING;
+	Blah_Atlas_Entry *entry = Blah_Atlas_find(atlas, name);
+	Blah_Atlas_Page *page = NULL;
+	Blah_List_Element *pageElement;
+	unsigned int left, bottom;
+
+	if (entry != NULL) {
+		entry->references++;
+		return entry;
+	}
+	if (pixelData == NULL || width == 0 || height == 0 || paddedWidth > atlas->pageSize || paddedHeight > atlas->pageSize) { return NULL; }
+
+	for (pageElement = atlas->pages.first; pageElement && page == NULL; pageElement = pageElement->next) {
+		Blah_Atlas_Page *candidate = pageElement->data;
+		if (candidate->pixelFormat == pixelFormat && candidate->pixelDepth == pixelDepth
+			&& Blah_Atlas_Page_place(candidate, atlas->pageSize, paddedWidth, paddedHeight, &left, &bottom)) {
+			page = candidate;
+		}
+	}
+	if (page == NULL) { //An empty page always has room, since the entry is no larger than a page
+		page = Blah_Atlas_Page_new(atlas, pixelFormat, pixelDepth);
+		Blah_Atlas_Page_place(page, atlas->pageSize, paddedWidth, paddedHeight, &left, &bottom);
+	}
+
+	entry = malloc(sizeof(Blah_Atlas_Entry));
+	if (entry == NULL) { blah_error_raise(errno, "Failed to allocate entry '%s' of atlas '%s'", name, atlas->name); }
+	blah_util_strncpy(entry->name, name, BLAH_TEXTURE_NAME_LENGTH);
+	entry->page = page;
+	entry->texture = page->texture;
+	entry->x = left + BLAH_ATLAS_PADDING;
+	entry->y = bottom + BLAH_ATLAS_PADDING;
+	entry->width = width;
+	entry->height = height;
+	entry->left = (float)entry->x / atlas->pageSize;
+	entry->bottom = (float)entry->y / atlas->pageSize;
+	entry->right = (float)(entry->x + width) / atlas->pageSize;
+	entry->top = (float)(entry->y + height) / atlas->pageSize;
+	entry->references = 1;
+	Blah_Atlas_Page_copyPixels(page, atlas->pageSize, entry->x, entry->y, width, height, pixelData);
+	page->entryCount++;
+	page->usedPixels += (size_t)width * height;
+	Blah_Tree_insertElement(&atlas->entries, entry->name, entry);
+	return entry;
+}
+
+/* Function Definitions */
+
+Blah_Atlas_Entry *Blah_Atlas_addImage(Blah_Atlas *atlas, const Blah_Image *image)
+{	//Packs the image into a page of the atlas and returns its entry, or NULL if it does not fit a page
+	return Blah_Atlas_addPixels(atlas, image->name, image->width, image->height, image->pixelFormat, image->pixelDepth, image->pixelData);
+}
+
+Blah_Atlas_Entry *Blah_Atlas_addTexture(Blah_Atlas *atlas, const Blah_Texture *texture)
+{	//Packs the full size level of the texture's mip chain into the atlas, or returns NULL if it has none
+	return Blah_Atlas_addPixels(atlas, texture->name, texture->width, texture->height, texture->pixelFormat, texture->pixelDepth, texture->levelData);
+}
+
+void Blah_Atlas_destroy(Blah_Atlas *atlas)
+{	//Destroys the atlas along with its pages and entries
+	Blah_Atlas_disable(atlas);
+	free(atlas);
+}
+
+void Blah_Atlas_disable(Blah_Atlas *atlas)
+{	//Destroys all pages and entries of the atlas
+	Blah_Tree_destroyElements(&atlas->entries);
+	Blah_Tree_disable(&atlas->entries);
+	Blah_List_destroyElements(&atlas->pages);
+}
+
+void blah_atlas_exit()
+{	//Releases the shared atlas, if it was created
+	if (sharedAtlasCreated) {
+		Blah_Atlas_disable(&sharedAtlas);
+		sharedAtlasCreated = false;
+	}
+}
+
+Blah_Atlas_Entry *Blah_Atlas_find(Blah_Atlas *atlas, const char *name)
+{	//Returns the entry of the image of given name, or NULL if there is none
+	Blah_Tree_Element *entryElement = Blah_Tree_findElement(&atlas->entries, name);
+	return entryElement != NULL ? (Blah_Atlas_Entry*)entryElement->data : NULL;
+}
+
+Blah_Atlas *blah_atlas_getShared()
+{	//Returns the atlas shared by texture fonts and small model textures, creating it on first use
+	if (!sharedAtlasCreated) {
+		Blah_Atlas_init(&sharedAtlas, "shared atlas", BLAH_ATLAS_DEFAULT_PAGE_SIZE);
+		sharedAtlasCreated = true;
+	}
+	return &sharedAtlas;
+}
+
+void Blah_Atlas_getStats(const Blah_Atlas *atlas, Blah_Atlas_Stats *stats)
+{	//Copies the occupancy of the atlas into *stats
+	stats->pages = stats->entries = 0;
+	stats->usedPixels = stats->pagePixels = 0;
+	for (const Blah_List_Element *pageElement = atlas->pages.first; pageElement; pageElement = pageElement->next) {
+		const Blah_Atlas_Page *page = pageElement->data;
+		stats->pages++;
+		stats->entries += page->entryCount;
+		stats->usedPixels += page->usedPixels;
+		stats->pagePixels += (size_t)atlas->pageSize * atlas->pageSize;
+	}
+}
+
+void Blah_Atlas_init(Blah_Atlas *atlas, const char *name, unsigned int pageSize)
+{	//Initialises an empty atlas with pages of the given width and height in pixels
+	blah_util_strncpy(atlas->name, name, BLAH_ATLAS_NAME_LENGTH);
+	atlas->pageSize = pageSize;
+	Blah_List_init(&atlas->pages, "atlas pages");
+	atlas->pages.destroyElementFunction = (blah_list_element_dest_func*)Blah_Atlas_Page_destroy;
+	Blah_Tree_init(&atlas->entries, "atlas entries");
+	Blah_Tree_setHashIndex(&atlas->entries, true);
+	atlas->pagesCreated = 0;
+}
+
+Blah_Atlas *Blah_Atlas_new(const char *name, unsigned int pageSize)
+{	//Creates an empty atlas with pages of the given width and height in pixels
+	Blah_Atlas *newAtlas = malloc(sizeof(Blah_Atlas));
+	if (newAtlas != NULL) { Blah_Atlas_init(newAtlas, name, pageSize); }
+	return newAtlas;
+}
+
+void Blah_Atlas_removeEntry(Blah_Atlas *atlas, Blah_Atlas_Entry *entry)
+{	//Removes the entry once, destroying it when no references remain, and its page once empty
+	Blah_Atlas_Page *page = entry->page;
+
+	if (--entry->references > 0) { return; }
+	Blah_Tree_removeElement(&atlas->entries, entry->name);
+	page->entryCount--;
+	page->usedPixels -= (size_t)entry->width * entry->height;
+	free(entry);
+	if (page->entryCount == 0) {
+		Blah_List_removeElement(&atlas->pages, page);
+		Blah_Atlas_Page_destroy(page);
+	}
+}
+
+void Blah_Atlas_update(Blah_Atlas *atlas)
+{	//Uploads the pages which have changed since the last update
+	for (Blah_List_Element *pageElement = atlas->pages.first; pageElement; pageElement = pageElement->next) {
+		Blah_Atlas_Page *page = pageElement->data;
+		if (page->dirty) {
+			Blah_Texture_update(page->texture, page->pixelData);
+			page->dirty = false;
+		}
+	}
+}
+
+void Blah_Atlas_Entry_mapPoint(const Blah_Atlas_Entry *entry, Blah_Point *point)
+{	//Maps texture coordinates of the whole image into the entry's region of its page
+	point->x = entry->left + point->x * (entry->right - entry->left);
+	point->y = entry->bottom + point->y * (entry->top - entry->bottom);
+}
@@ -0,0 +1,129 @@
+/* blah_atlas.h
+	An atlas packs many small images into a few large textures, its pages, so that drawing them needs
+	far fewer texture bindings.  Each image added becomes an entry, a rectangle of one page, and texture
+	coordinates meant for the whole image are mapped into that rectangle with Blah_Atlas_Entry_mapPoint.
+	Images are packed on shelves, rows of entries the height of their tallest image, and each is padded
+	by repeating its edge pixels, so that filtering does not blend neighbouring entries at full size and
+	the finer mip levels.  Texture coordinates outside 0 to 1 would reach other entries, so images which
+	are tiled must keep their own textures.
+	Pages hold images of a single pixel format.  Pages changed by adding entries are uploaded by
+	Blah_Atlas_update.  Space of removed entries is only reclaimed once their page is empty.
+	The shared atlas from blah_atlas_getShared is used by texture fonts, and by Blah_Object_fromModel
+	for small model textures if enabled with blah_object_setAtlasTextures.  It is released by
+	blah_atlas_exit when the engine exits. */
+
+#ifndef _BLAH_ATLAS
+
+#define _BLAH_ATLAS
+
+#include <stddef.h>
+
+#include "blah_types.h"
+#include "blah_image.h"
+#include "blah_list.h"
+#include "blah_point.h"
+#include "blah_texture.h"
+#include "blah_tree.h"
+
+/* Definitions */
+
+#define BLAH_ATLAS_NAME_LENGTH 30
+#define BLAH_ATLAS_DEFAULT_PAGE_SIZE 1024	//Width and height of pages of the shared atlas, in pixels
+#define BLAH_ATLAS_PADDING 2	//Pixels repeated around each entry
+
+/* Structure Definitions */
+
+struct Blah_Atlas_Shelf;
+
+typedef struct Blah_Atlas_Page { //Texture holding the entries of one pixel format
+	Blah_Texture* texture;
+	unsigned char* pixelData;		//Copy of the page contents in system memory
+	blah_pixel_format pixelFormat;
+	unsigned char pixelDepth;
+	struct Blah_Atlas_Shelf* shelves;	//Rows of entries, from the bottom of the page up
+	unsigned int shelfCount;
+	unsigned int shelfCapacity;
+	unsigned int entryCount;		//Number of entries placed on the page and not yet removed
+	size_t usedPixels;				//Pixels of those entries, not including padding
+	bool dirty;						//True if the page has changed since it was last uploaded
+} Blah_Atlas_Page;
+
+typedef struct Blah_Atlas_Entry { //Region of a page holding one image
+	char name[BLAH_TEXTURE_NAME_LENGTH+1];	//Name of the image
+	Blah_Atlas_Page* page;
+	Blah_Texture* texture;			//Texture of the page, to draw the entry with
+	unsigned int x, y;				//Bottom left of the image within the page, in pixels
+	unsigned int width, height;		//Size of the image, in pixels
+	float left, bottom, right, top;	//Edges of the image in page texture coordinates
+	unsigned int references;		//Number of times the image was added and not yet removed
+} Blah_Atlas_Entry;
+
+typedef struct Blah_Atlas {
+	char name[BLAH_ATLAS_NAME_LENGTH+1];
+	unsigned int pageSize;			//Width and height of each page, in pixels
+	Blah_List pages;
+	Blah_Tree entries;				//Entries by image name
+	unsigned long pagesCreated;		//Used to give each page texture a unique name
+} Blah_Atlas;
+
+typedef struct Blah_Atlas_Stats { //Occupancy of an atlas
+	unsigned int pages;
+	unsigned int entries;
+	size_t usedPixels;				//Pixels of all entries, not including padding
+	size_t pagePixels;				//Pixels of all pages
+} Blah_Atlas_Stats;
+
+/* Function Prototypes */
+
+#ifdef __cplusplus
+	extern "C" {
+#endif //__cplusplus
+
+Blah_Atlas_Entry* Blah_Atlas_addImage(Blah_Atlas* atlas, const Blah_Image* image);
+	//Packs the image into a page of the atlas and returns its entry.  If an image of the same name
+	//was already added, its entry is returned and must be removed once more.  Returns NULL if the
+	//image is too large for a page, or has no pixel data.
+
+Blah_Atlas_Entry* Blah_Atlas_addTexture(Blah_Atlas* atlas, const Blah_Texture* texture);
+	//Packs the full size level of a texture made from an image into the atlas, as Blah_Atlas_addImage
+
+void Blah_Atlas_destroy(Blah_Atlas* atlas);
+	//Destroys the atlas along with its pages and entries
+
+void Blah_Atlas_disable(Blah_Atlas* atlas);
+	//Destroys all pages and entries of the atlas, and their textures
+
+void blah_atlas_exit();
+	//Releases the shared atlas.  Called by the engine before textures are garbage collected.
+
+Blah_Atlas_Entry* Blah_Atlas_find(Blah_Atlas* atlas, const char* name);
+	//Returns the entry of the image of given name, or NULL if there is none
+
+Blah_Atlas* blah_atlas_getShared();
+	//Returns the atlas shared by texture fonts and small model textures, creating it on first use
+
+void Blah_Atlas_getStats(const Blah_Atlas* atlas, Blah_Atlas_Stats* stats);
+	//Copies the occupancy of the atlas into *stats
+
+void Blah_Atlas_init(Blah_Atlas* atlas, const char* name, unsigned int pageSize);
+	//Initialises an empty atlas with pages of the given width and height in pixels
+
+Blah_Atlas* Blah_Atlas_new(const char* name, unsigned int pageSize);
+	//Creates an empty atlas with pages of the given width and height in pixels
+
+void Blah_Atlas_removeEntry(Blah_Atlas* atlas, Blah_Atlas_Entry* entry);
+	//Removes the entry once for each time its image was added.  Once its last entry is removed,
+	//a page is destroyed along with its texture.
+
+void Blah_Atlas_update(Blah_Atlas* atlas);
+	//Uploads the pages which have changed since the last update.  Call once entries are added,
+	//before drawing them.
+
+void Blah_Atlas_Entry_mapPoint(const Blah_Atlas_Entry* entry, Blah_Point* point);
+	//Maps texture coordinates given for the whole image, from 0 to 1, into the entry's region of its page
+
+#ifdef __cplusplus
+	}
+#endif //__cplusplus
+
+#endif
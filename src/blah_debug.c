@@ -1,10 +1,14 @@
 /* blah_debug.c
 	Defines routines for debugging */
 
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <malloc.h>
 #include <string.h>
 #include <stdarg.h>
+#include <threads.h>
+#include <time.h>
 
 #include "blah_debug.h"
 #include "blah_list.h"
@@ -13,6 +17,24 @@
 #include "blah_macros.h"
 #include "blah_error.h"
 #include "blah_console.h"
+#include "blah_time.h"
+
+/* Structure Definitions */
+
+typedef struct Blah_Debug_Record { //Message waiting in the ring buffer for the writer thread
+	atomic_size_t sequence;		//Position in the ring buffer plus 1 once the record is filled, and the
+								//position of its next use once written, so producers know when it is free
+	Blah_Debug_Log* log;
+	struct timespec time;		//Time the message was logged
+	bool isError;
+	int errorCode;
+	char* longText;				//Message too long for the record, or NULL
+	char text[BLAH_DEBUG_RECORD_LENGTH];
+} Blah_Debug_Record;
+
+/* Externally Referenced Variables */
+
+blah_debug_level blah_debug_logLevel = BLAH_DEBUG_LEVEL_INFO;
 
 /* Static Globals - Private to blah_debug.c */
 static Blah_List logList = {
@@ -20,9 +42,25 @@ static Blah_List logList = {
     .destroyElementFunction = (blah_list_element_dest_func*)Blah_Debug_Log_destroy,  // List of all entities, defaults to empty
 };
 
+static Blah_Debug_Record* records = NULL;	//Ring buffer of messages for the writer thread
+static atomic_size_t enqueuePosition;		//Position of the next record to be claimed by a logging thread
+static size_t dequeuePosition = 0;			//Position of the next record to be written, used by writer thread only
+static atomic_size_t writtenPosition;		//Records before this position have been written and flushed
+static atomic_ulong stallCount;				//Number of messages which waited for space in the ring buffer
+static atomic_bool asyncRunning = false;	//True while messages go to the writer thread
+static atomic_uint activeProducers = 0;		//Threads between checking asyncRunning and finishing their push
+static thrd_t writerThread;
+static once_flag syncOnce = ONCE_FLAG_INIT;
+static mtx_t writerMutex;					//Guards the stopping flag and flush requests
+static cnd_t wakeCondition;				//Signalled to wake the writer thread early
+static cnd_t writtenCondition;				//Signalled when the writer thread has written a batch
+static bool writerStopping = false;
+static unsigned int flushWaiting = 0;		//Number of threads waiting for messages to be written
+
 /* Private Function Declarations */
 extern void blah_message_writeToFileVA(FILE* file, const char* messageFormat, va_list varArgs);
 extern void blah_message_writeErrorToFileVA(FILE* file, int errorCode, const char* messageFormat, va_list varArgs);
+extern void blah_message_writeRecordToFile(FILE* file, const char* timeString, bool isError, int errorCode, const char* message);
 
 // Creates a new log file with given log name and returns FILE handle.
 // If the file already exists, it is replaced with a new empty one.
@@ -37,6 +75,143 @@ static FILE* Blah_Debug_Log_createFile(char* logName)
 	return newFile;  //If file creation failed, NULL pointer will be returned
 }
 
+// Creates the mutex and conditions shared with the writer thread, once per process
+static void blah_debug_initSync()
+{
+	if (mtx_init(&writerMutex, mtx_plain) != thrd_success || cnd_init(&wakeCondition) != thrd_success
+		|| cnd_init(&writtenCondition) != thrd_success) {
+		blah_error_raise(errno, "Failed to create debug log synchronisation objects");
+	}
+}
+
+// Claims a record of the ring buffer and formats the message into it.  Safe to call from any number
+// of threads at once without locking.  If the ring buffer is full, waits for the writer thread to free a record.
+static void Blah_Debug_Log_push(Blah_Debug_Log* log, bool isError, int errorCode, const char* messageFormat, va_list varArgs)
+{
+	size_t position = atomic_load_explicit(&enqueuePosition, memory_order_relaxed);
+	Blah_Debug_Record* record;
+	va_list argsCopy;
+	int length;
+	bool stalled = false;
+
+	while (true) { //Claim the record at position, unless another thread claims it first
+		record = &records[position & (BLAH_DEBUG_RING_SIZE - 1)];
+		const intptr_t difference = (intptr_t)atomic_load_explicit(&record->sequence, memory_order_acquire) - (intptr_t)position;
+		if (difference == 0) {
+			if (atomic_compare_exchange_weak_explicit(&enqueuePosition, &position, position + 1,
+				memory_order_relaxed, memory_order_relaxed)) { break; }
+		} else if (difference < 0) { //Record has not yet been written since its last use, so buffer is full
+			if (!stalled) { //Wake the writer thread rather than wait for it to check again
+				stalled = true;
+				atomic_fetch_add_explicit(&stallCount, 1, memory_order_relaxed);
+				mtx_lock(&writerMutex);
+				cnd_signal(&wakeCondition);
+				mtx_unlock(&writerMutex);
+			}
+			thrd_yield();
+			position = atomic_load_explicit(&enqueuePosition, memory_order_relaxed);
+		} else { //Another thread claimed it
+			position = atomic_load_explicit(&enqueuePosition, memory_order_relaxed);
+		}
+	}
+
+	record->log = log;
+	record->isError = isError;
+	record->errorCode = errorCode;
+	record->longText = NULL;
+	timespec_get(&record->time, TIME_UTC);
+	va_copy(argsCopy, varArgs);
+	length = vsnprintf(record->text, BLAH_DEBUG_RECORD_LENGTH, messageFormat, varArgs);
+	if (length >= BLAH_DEBUG_RECORD_LENGTH) { //Rare, so fall back to the heap, or keep the truncated message
+		record->longText = malloc((size_t)length + 1);
+		if (record->longText) { vsnprintf(record->longText, (size_t)length + 1, messageFormat, argsCopy); }
+	}
+	va_end(argsCopy);
+	atomic_store_explicit(&record->sequence, position + 1, memory_order_release); //Hand record to writer thread
+}
+
+// Writes all filled records in order, up to the first not yet filled, then flushes the files.
+// Returns the number of records written.  Called by the writer thread only.
+static size_t blah_debug_writeRecords()
+{
+	static time_t cachedSecond = -1; //Local time string of the second of the last record
+	static char cachedTime[50];
+	char timeString[64];
+	size_t count = 0;
+
+	while (true) {
+		Blah_Debug_Record* record = &records[dequeuePosition & (BLAH_DEBUG_RING_SIZE - 1)];
+		if (atomic_load_explicit(&record->sequence, memory_order_acquire) != dequeuePosition + 1) { break; }
+
+		if (record->time.tv_sec != cachedSecond) { //Only convert to local time once per second
+			cachedSecond = record->time.tv_sec;
+			Blah_Time_toLocalTimeString(&cachedSecond, cachedTime, blah_countof(cachedTime));
+		}
+		snprintf(timeString, blah_countof(timeString), "%s.%03d", cachedTime, (int)(record->time.tv_nsec / 1000000) % 1000);
+		if (record->log->filePointer) {
+			blah_message_writeRecordToFile(record->log->filePointer, timeString, record->isError, record->errorCode,
+				record->longText ? record->longText : record->text);
+		}
+		free(record->longText);
+		atomic_store_explicit(&record->sequence, dequeuePosition + BLAH_DEBUG_RING_SIZE, memory_order_release); //Free for reuse
+		dequeuePosition++;
+		count++;
+	}
+	if (count > 0) {
+		fflush(NULL); //Flush every log written to in one go
+		atomic_store_explicit(&writtenPosition, dequeuePosition, memory_order_release);
+	}
+	return count;
+}
+
+// Writer thread routine.  Writes records as they are filled, checking every millisecond while idle,
+// until asked to stop with no records left.
+static int blah_debug_writer(void* unused)
+{
+	(void)unused;
+	mtx_lock(&writerMutex);
+	while (true) {
+		mtx_unlock(&writerMutex);
+		const size_t count = blah_debug_writeRecords();
+		mtx_lock(&writerMutex);
+		if (count > 0) {
+			cnd_broadcast(&writtenCondition);
+		} else if (writerStopping) {
+			break;
+		} else if (flushWaiting == 0) { //Records are only waited for while a thread is still filling them
+			struct timespec wakeTime;
+			timespec_get(&wakeTime, TIME_UTC);
+			wakeTime.tv_nsec += 1000000;
+			if (wakeTime.tv_nsec >= 1000000000) { wakeTime.tv_sec++; wakeTime.tv_nsec -= 1000000000; }
+			cnd_timedwait(&wakeCondition, &writerMutex, &wakeTime);
+		}
+	}
+	mtx_unlock(&writerMutex);
+	return 0;
+}
+
+// Writes a message to the log, through the writer thread if running, else directly
+static bool Blah_Debug_Log_write(Blah_Debug_Log* log, bool isError, int errorCode, const char* messageFormat, va_list varArgs)
+{
+	if (log->filePointer == NULL) { // If invalid file pointer, return false immediately
+        blah_console_message("Failed to write to log: %s - FILE NOT OPEN", log->name);
+		return false;
+    }
+	atomic_fetch_add(&activeProducers, 1); // Counted before checking, so the ring buffer is not freed under the push
+	if (atomic_load(&asyncRunning)) {
+		Blah_Debug_Log_push(log, isError, errorCode, messageFormat, varArgs);
+		atomic_fetch_sub(&activeProducers, 1);
+		return true;
+	}
+	atomic_fetch_sub(&activeProducers, 1);
+	if (isError) {
+		blah_message_writeErrorToFileVA(log->filePointer, errorCode, messageFormat, varArgs);
+	} else {
+		blah_message_writeToFileVA(log->filePointer, messageFormat, varArgs);
+	}
+	return true;
+}
+
 /* Public Functions */
 
 bool Blah_Debug_Log_close(Blah_Debug_Log *log)
@@ -46,6 +221,7 @@ bool Blah_Debug_Log_close(Blah_Debug_Log *log)
 	bool closeOK = false;
 
 	if (log->filePointer != NULL) {
+		blah_debug_flush(); // Messages still waiting for the writer thread refer to the file
         closeOK = fclose(log->filePointer) == 0; // fclose() returns 0 on success
         log->filePointer = NULL;  //Set file pointer to NULL, indicating no open log file
 	}
@@ -56,7 +232,10 @@ bool Blah_Debug_Log_close(Blah_Debug_Log *log)
 // Unregisters log from log list, frees memory and deallocates file resources
 void Blah_Debug_Log_destroy(Blah_Debug_Log *log)
 {
-	Blah_List_removeElement(&logList, log); //First remove from list of logs
+	if (log->listElement) { //First remove from list of logs
+		Blah_List_removeElementHandle(&logList, log->listElement);
+		log->listElement = NULL;
+	}
 	Blah_Debug_Log_close(log); //Close the log file
 	free(log);
 }
@@ -64,6 +243,7 @@ void Blah_Debug_Log_destroy(Blah_Debug_Log *log)
 // Cleanup routine to do garbage collection for logs exit
 void blah_debug_log_destroyAll()
 {
+	blah_debug_setAsync(false); // Write pending messages while their logs are still open
 	Blah_List_destroyElements(&logList);
 }
 
@@ -73,46 +253,75 @@ void Blah_Debug_Log_disable(Blah_Debug_Log *log)
 	Blah_Debug_Log_close(log);
 }
 
+// Waits until all messages logged so far have been written and flushed to their files
+void blah_debug_flush()
+{
+	const size_t target = atomic_load_explicit(&enqueuePosition, memory_order_relaxed);
+
+	if (!atomic_load_explicit(&asyncRunning, memory_order_acquire)) { return; }
+	mtx_lock(&writerMutex);
+	flushWaiting++;
+	cnd_signal(&wakeCondition);
+	while (atomic_load_explicit(&writtenPosition, memory_order_acquire) < target && !writerStopping) {
+		cnd_wait(&writtenCondition, &writerMutex);
+	}
+	flushWaiting--;
+	mtx_unlock(&writerMutex);
+}
+
+// Returns the number of messages which had to wait because the ring buffer was full
+unsigned long blah_debug_getStallCount()
+{
+	return atomic_load(&stallCount);
+}
+
 // Initialises a given log data structure as a new log with new open file pointer
 // to a log file on the file system with the same name as the given log name.
 void Blah_Debug_Log_init(Blah_Debug_Log *log, const char *logName)
 {
 	log->filePointer = NULL;
 	log->numEntries = 0;
+	log->listElement = NULL;
 	blah_util_strncpy(log->name, logName, BLAH_DEBUG_LOG_NAME_LENGTH); //Copy name string
 	Blah_Debug_Log_open(log);
 }
 
 // Append the given string to the specified log with a following new line char
-// Returns TRUE if success
+// Returns TRUE if success, or if info messages are not logged
 bool Blah_Debug_Log_message(Blah_Debug_Log* log, const char* messageFormat, ...)
 {
-	if (log->filePointer == NULL) { // If invalid file pointer, return false immediately
-        blah_console_message("Failed to write to log: %s - FILE NOT OPEN", log->name);
-		return false;
-    }
+	if (blah_debug_logLevel > BLAH_DEBUG_LEVEL_INFO) { return true; }
 
     // Try to write message to file using the variable args and then release them
     va_list varArgs;
     va_start(varArgs, messageFormat);
-    blah_message_writeToFileVA(log->filePointer, messageFormat, varArgs);
+    const bool writeOK = Blah_Debug_Log_write(log, false, 0, messageFormat, varArgs);
     va_end(varArgs);
-    return true;
+    return writeOK;
+}
+
+// Append the given string to the specified log if the given level is enabled
+bool Blah_Debug_Log_messageLevel(Blah_Debug_Log* log, blah_debug_level level, const char* messageFormat, ...)
+{
+	if (blah_debug_logLevel > level) { return true; }
+
+    va_list varArgs;
+    va_start(varArgs, messageFormat);
+    const bool writeOK = Blah_Debug_Log_write(log, false, 0, messageFormat, varArgs);
+    va_end(varArgs);
+    return writeOK;
 }
 
 bool Blah_Debug_Log_error(Blah_Debug_Log* log, blah_error errorCode, const char* messageFormat, ...)
 {
-	if (log->filePointer == NULL) { // If invalid file pointer, return false immediately
-        blah_console_message("Failed to write to log: %s - FILE NOT OPEN", log->name);
-		return false;
-    }
+	if (blah_debug_logLevel > BLAH_DEBUG_LEVEL_ERROR) { return true; }
 
     // Try to write message to file using the variable args and then release them
     va_list varArgs;
     va_start(varArgs, messageFormat);
-    blah_message_writeErrorToFileVA(log->filePointer, errorCode, messageFormat, varArgs);
+    const bool writeOK = Blah_Debug_Log_write(log, true, errorCode, messageFormat, varArgs);
     va_end(varArgs);
-    return true;
+    return writeOK;
 }
 
 // Creates a new debugging log with given name
@@ -122,7 +331,7 @@ Blah_Debug_Log *Blah_Debug_Log_new(const char *logName)
 
 	if (newLog != NULL) { //If memory allocation ok
 		Blah_Debug_Log_init(newLog, logName);
-		Blah_List_appendElement(&logList, newLog); //Register log in resource list
+		newLog->listElement = Blah_List_appendElement(&logList, newLog); //Register log in resource list
 	} else {
 		blah_error_raise(errno, "Memory allocation for new log failed");
 	}
@@ -133,10 +342,50 @@ Blah_Debug_Log *Blah_Debug_Log_new(const char *logName)
 bool Blah_Debug_Log_open(Blah_Debug_Log *log)
 {	// Attaches a new file to the log.
 	// Implicitly closes the previously associated file if still currently open.
-	if (log->filePointer) { fclose(log->filePointer); } //If there is a current file attached, close it
+	Blah_Debug_Log_close(log); //If there is a current file attached, close it
 
 	log->filePointer = Blah_Debug_Log_createFile(log->name);
 	log->numEntries = 0;
 
 	return log->filePointer != NULL; // Return true if file creation was successful, else false
 }
+
+// Starts or stops the writer thread
+bool blah_debug_setAsync(bool flag)
+{
+	if (flag == atomic_load(&asyncRunning)) { return true; }
+	call_once(&syncOnce, blah_debug_initSync);
+
+	if (flag) {
+		records = malloc(BLAH_DEBUG_RING_SIZE * sizeof(Blah_Debug_Record));
+		if (records == NULL) { return false; }
+		for (size_t index = 0; index < BLAH_DEBUG_RING_SIZE; index++) { atomic_init(&records[index].sequence, index); }
+		atomic_store(&enqueuePosition, 0);
+		atomic_store(&writtenPosition, 0);
+		dequeuePosition = 0;
+		writerStopping = false;
+		if (thrd_create(&writerThread, blah_debug_writer, NULL) != thrd_success) {
+			free(records);
+			records = NULL;
+			return false;
+		}
+		atomic_store(&asyncRunning, true);
+	} else {
+		atomic_store(&asyncRunning, false); // Further messages are written directly
+		while (atomic_load(&activeProducers) != 0) { thrd_yield(); } // Wait for messages already being pushed
+		mtx_lock(&writerMutex);
+		writerStopping = true; // Writer thread writes the remaining records before stopping
+		cnd_signal(&wakeCondition);
+		mtx_unlock(&writerMutex);
+		thrd_join(writerThread, NULL);
+		free(records);
+		records = NULL;
+	}
+	return true;
+}
+
+// Sets the lowest level of message logged
+void blah_debug_setLevel(blah_debug_level level)
+{
+	blah_debug_logLevel = level;
+}
@@ -1,5 +1,14 @@
 /* blah_debug.h
-	Defines debugging routines */
+	Defines debugging routines.
+	Each message has a level, and messages below the level set with blah_debug_setLevel are dropped
+	before being formatted.  Blah_Debug_Log_message is at the info level and Blah_Debug_Log_error at
+	the error level.  BLAH_DEBUG_LOG_VERBOSE checks the level before evaluating its arguments, so
+	detailed messages inside loops cost a single branch while disabled.
+	Once blah_debug_setAsync is enabled, as the engine does on initialisation, messages are formatted
+	by the calling thread into a record of a ring buffer shared by all threads, without taking a lock,
+	and a writer thread timestamps them and writes them to their log files in batches.  A message
+	logged while the ring buffer is full waits for the writer thread to make room, so none are lost
+	unless the process aborts.  Closing a log waits for its messages to be written. */
 
 #ifndef _BLAH_DEBUG
 
@@ -9,11 +18,25 @@
 
 #include "blah_types.h"
 #include "blah_error.h"
+#include "blah_list.h"
 
 /* Constant Definitions */
 
 #define BLAH_DEBUG_LOG_NAME_LENGTH 128 //Doesn't include NULL char
 #define BLAH_DEBUG_MESSAGE_LENGTH 100	//FIXME! - this should not be needed in future
+#define BLAH_DEBUG_RING_SIZE 4096	//Records held for the writer thread, must be a power of 2
+#define BLAH_DEBUG_RECORD_LENGTH 200	//Longest message held in a record, longer ones are copied to the heap
+
+/* Type Definitions */
+
+typedef enum Blah_Debug_Level {BLAH_DEBUG_LEVEL_VERBOSE, BLAH_DEBUG_LEVEL_INFO, BLAH_DEBUG_LEVEL_WARNING,
+	BLAH_DEBUG_LEVEL_ERROR, BLAH_DEBUG_LEVEL_NONE} blah_debug_level;
+
+/* Macros */
+
+#define BLAH_DEBUG_LOG_VERBOSE(log, ...) do { if (blah_debug_logLevel <= BLAH_DEBUG_LEVEL_VERBOSE) { \
+	Blah_Debug_Log_messageLevel((log), BLAH_DEBUG_LEVEL_VERBOSE, __VA_ARGS__); } } while (0)
+	//Logs a detailed message, evaluating the arguments only if verbose messages are enabled
 
 /* Structure Definitions */
 
@@ -22,10 +45,15 @@ typedef struct Blah_Debug_Log
 	char name[BLAH_DEBUG_LOG_NAME_LENGTH+1]; //This is set by funcions
 	FILE *filePointer; //At all times this should be either NULL or a valid pointer
 	int numEntries;
+	Blah_List_Element *listElement; //Element of the list of logs, NULL if not created with Blah_Debug_Log_new
 } Blah_Debug_Log;
 
 //typedef struct Blah_Debug_Log BLAH_DEBUG_LOG;
 
+/* Externally Referenced Variables */
+
+extern blah_debug_level blah_debug_logLevel;	//Lowest level of message logged, set with blah_debug_setLevel
+
 /* Function Prototypes */
 
 #ifdef __cplusplus
@@ -45,6 +73,12 @@ void blah_debug_log_destroyAll();
 void Blah_Debug_Log_disable(Blah_Debug_Log* log);
 	// Disables Log.  Reverses initialisation.  Closes log.
 
+void blah_debug_flush();
+	// Waits until all messages logged so far have been written and flushed to their files
+
+unsigned long blah_debug_getStallCount();
+	// Returns the number of messages which had to wait because the ring buffer was full
+
 void Blah_Debug_Log_init(Blah_Debug_Log* log, const char* log_name);
 	// Initialises a given log data structure as a new log with new open file pointer
 	// to a log file on the file system with the same name as the given log name.
@@ -53,6 +87,9 @@ void Blah_Debug_Log_init(Blah_Debug_Log* log, const char* log_name);
 // Returns TRUE if success.  Uses printf style variable arguments.
 bool Blah_Debug_Log_message(Blah_Debug_Log* log, const char* messageFormat, ...);
 
+// Append the given string to the specified log if the given level is enabled, as Blah_Debug_Log_message
+bool Blah_Debug_Log_messageLevel(Blah_Debug_Log* log, blah_debug_level level, const char* messageFormat, ...);
+
 // Append the given error string to the specified log, followed by a new line character.
 // Returns TRUE if success.  Uses printf style variable arguments.
 bool Blah_Debug_Log_error(Blah_Debug_Log* log, blah_error errorCode, const char* messageFormat, ...);
@@ -65,6 +102,16 @@ bool Blah_Debug_Log_open(Blah_Debug_Log *log);
 	// Attaches a new file to the log.  Implicitly closes the previously associated file
 	// if still currently open. Returns true apon success, else false
 
+bool blah_debug_setAsync(bool flag);
+	// If flag is true, starts the writer thread so that messages are written in the background.
+	// If false, writes all pending messages and stops the writer thread, after which messages are
+	// written by the calling thread.  Messages being logged by other threads while it is switched off
+	// are written before the writer thread stops.
+	// Returns false if the writer thread could not be started.  Default is false.
+
+void blah_debug_setLevel(blah_debug_level level);
+	// Sets the lowest level of message logged.  Default is BLAH_DEBUG_LEVEL_INFO.
+
 #ifdef __cplusplus
 	}
 #endif //__cplusplus
@@ -1,7 +1,9 @@
 /* blah_draw.c
 	Drawing related routines */
 
+#include <math.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "blah_scene.h"
 #include "blah_font.h"
@@ -15,6 +17,7 @@
 #include "blah_region.h"
 #include "blah_stack.h"
 #include "blah_debug.h"
+#include "blah_math.h"
 
 /* Global Variables */
 
@@ -41,10 +44,98 @@ Blah_Region blah_draw_drawport;
 Blah_Stack blah_draw_drawportStack;
 	//An internal stack for push pops
 
+Blah_Draw_Stats blah_draw_stats;
+	//Counters of drawing work in the current frame
+
 static Blah_Debug_Log blah_draw_log = { .filePointer = NULL };
 
+static bool blah_draw_objectBatching = true;
+	//If true, objects are drawn through buffers compiled by the drawing API
+
+static bool blah_draw_renderQueue = true;
+	//If true, compiled objects are sorted by state and depth before drawing
+
+static bool blah_draw_culling = true;
+	//If true, objects outside the viewing volume are not drawn
+
+static struct {
+	bool valid;			//False until the perspective has been set up
+	float halfWidth, halfHeight;	//Half extents of the viewing area about the line of sight
+	float depth;		//Distance of far clipping plane from the viewpoint
+} blah_draw_viewVolume = { .valid = false };
+	//Viewing volume in eye coordinates, matching the projection set by blah_draw_updatePerspective
+
+static Blah_Matrix blah_draw_matrixStack[BLAH_DRAW_MATRIX_STACK_SIZE] = {{{1,0,0},0, {0,1,0},0, {0,0,1},0, {0,0,0},1}};
+	//Drawing matrices saved by blah_draw_pushMatrix, with the current drawing matrix on top
+
+static size_t blah_draw_matrixDepth = 0;
+	//Index of the current drawing matrix in the matrix stack
+
+/* Static Function Definitions */
+
+static void blah_draw_formatViewMatrix(Blah_Matrix *matrix)
+{	//Formats the matrix to take world coordinates to eye coordinates, looking from the viewpoint
+	//towards the focal point with the view normal upwards, as gluLookAt does
+	const Blah_Point *eye = &blah_draw_currentParameters.viewpoint;
+	Blah_Vector forward, side, up;
+
+	Blah_Point_deltaPoint(&blah_draw_currentParameters.viewpoint, &blah_draw_currentParameters.focalPoint, &forward);
+	Blah_Vector_normalise(&forward);
+	blah_vector_crossProduct(&forward, &blah_draw_currentParameters.viewNormal, &side);
+	Blah_Vector_normalise(&side);
+	blah_vector_crossProduct(&side, &forward, &up);
+
+	Blah_Matrix_setAxisX(matrix, side.x, up.x, -forward.x);
+	Blah_Matrix_setAxisY(matrix, side.y, up.y, -forward.y);
+	Blah_Matrix_setAxisZ(matrix, side.z, up.z, -forward.z);
+	Blah_Matrix_setTranslation(matrix, -(side.x * eye->x + side.y * eye->y + side.z * eye->z),
+		-(up.x * eye->x + up.y * eye->y + up.z * eye->z), forward.x * eye->x + forward.y * eye->y + forward.z * eye->z);
+	matrix->scaleX = matrix->scaleY = matrix->scaleZ = 0;
+	matrix->scale = 1;
+}
+
+static float blah_draw_getMatrixStretch(const Blah_Matrix *matrix)
+{	//Returns a bound on how far the matrix can lengthen any vector.  The square of the stretch is the
+	//largest eigenvalue of the products of the axes with each other, bounded by its largest row sum,
+	//which is the longest axis when the axes are perpendicular.  Axes need not be, as a scale
+	//applied after a rotation skews them, and then the longest axis alone falls short.
+	const Blah_Vector *axes[3] = {&matrix->axisX, &matrix->axisY, &matrix->axisZ};
+	float products[3][3], largestSum = 0;
+
+	for (int row = 0; row < 3; row++) {
+		for (int column = 0; column < 3; column++) {
+			products[row][column] = axes[row]->x * axes[column]->x + axes[row]->y * axes[column]->y + axes[row]->z * axes[column]->z;
+		}
+	}
+	for (int row = 0; row < 3; row++) {
+		const float sum = products[row][row] + fabsf(products[row][(row + 1) % 3]) + fabsf(products[row][(row + 2) % 3]);
+		if (sum > largestSum) { largestSum = sum; }
+	}
+	return sqrtf(largestSum);
+}
+
 /* Function Declarations */
 
+bool blah_draw_beginLayer(Blah_Draw_Layer *layer, unsigned int width, unsigned int height)
+{	//Redirects all drawing into the layer until blah_draw_endLayer.  Returns false if unsupported.
+	return blah_draw_gl_beginLayer(layer, width, height);
+}
+
+void blah_draw_beginQueue()
+{	//Begins collecting compiled objects into the render queue, if enabled
+	if (blah_draw_renderQueue && blah_draw_objectBatching) { blah_draw_gl_beginQueue(); }
+}
+
+void blah_draw_compositeLayer(const Blah_Draw_Layer *layer)
+{	//Draws the contents of the layer as a single quad at the origin of the current drawport
+	blah_draw_gl_compositeLayer(layer);
+}
+
+void blah_draw_endLayer(Blah_Draw_Layer *layer)
+{	//Ends drawing into the layer, restoring drawing to the screen
+	blah_draw_gl_endLayer();
+}
+
 void blah_draw_exit()
 {	// This function is called when the engine exits and deallocates resources used
 	// by the drawing engine component
@@ -54,6 +145,16 @@ void blah_draw_exit()
 	Blah_Debug_Log_disable(&blah_draw_log);
 }
 
+void blah_draw_getMatrix(Blah_Matrix *matrix)
+{	//Copies the current drawing matrix into *matrix
+	*matrix = blah_draw_matrixStack[blah_draw_matrixDepth];
+}
+
+void blah_draw_getStats(Blah_Draw_Stats *stats)
+{	//Copies the drawing counters of the current or most recently drawn frame into *stats
+	*stats = blah_draw_stats;
+}
+
 bool blah_draw_init()
 {	// Initialise drawing engine component
 	Blah_Debug_Log_init(&blah_draw_log, "blah_draw");
@@ -79,32 +180,88 @@ bool blah_draw_init()
 	return true;
 }
 
+void blah_draw_flushQueue()
+{	//Sorts and draws all items collected since blah_draw_beginQueue
+	blah_draw_gl_flushQueue();
+}
+
+bool blah_draw_isObjectVisible(const Blah_Object *object)
+{	//Tests bounding sphere of object about the origin of the current drawing matrix against the
+	//viewing volume, in eye coordinates.  The volume is the box of the orthographic projection
+	//set up by the drawing API, between the viewpoint and the depth of vision.
+	Blah_Matrix *matrix = &blah_draw_matrixStack[blah_draw_matrixDepth];
+	const Blah_Point *centre = &matrix->location; //Object origin in eye coordinates
+	float scale, radius;
+
+	if (!blah_draw_culling || !blah_draw_viewVolume.valid) {
+		blah_draw_stats.objectsDrawn++;
+		return true;
+	}
+
+	scale = blah_draw_getMatrixStretch(matrix); //Bounds any scaling of the object, even when skewed
+	radius = object->boundRadius * scale;
+
+	if (fabsf(centre->x) > blah_draw_viewVolume.halfWidth + radius
+		|| fabsf(centre->y) > blah_draw_viewVolume.halfHeight + radius
+		|| centre->z > radius || centre->z < -blah_draw_viewVolume.depth - radius) { //Eye looks down negative z axis
+		blah_draw_stats.objectsCulled++;
+		return false;
+	}
+	blah_draw_stats.objectsDrawn++;
+	return true;
+}
+
 void blah_draw_main()
 {	//Main drawing routine.  Sets perspective and draws enitites/objects
+	memset(&blah_draw_stats, 0, sizeof(blah_draw_stats)); //Begin counting for new frame
 	blah_draw_pushMatrix(); //Save the current
 	blah_draw_updatePerspective();
 	if (blah_draw_currentScene != NULL) { Blah_Scene_draw(blah_draw_currentScene); } //If a current scene has been defined, draw it
 	blah_draw_popMatrix();	//Revert to previous drawing matrix
 }
 
+void blah_draw_loadMatrix(const Blah_Matrix *matrix)
+{	//Replaces the current drawing matrix with the given matrix
+	blah_draw_matrixStack[blah_draw_matrixDepth] = *matrix;
+	blah_draw_gl_loadMatrix(matrix);
+}
+
 void blah_draw_pushMatrix()
-{	//Preserves the current drawing matrix by pushing it on to the matrix stack
-	blah_draw_gl_pushMatrix();
+{	//Preserves the current drawing matrix by pushing it on to the matrix stack.
+	//The drawing API need not be told, as the current matrix is unchanged.
+	if (blah_draw_matrixDepth + 1 >= BLAH_DRAW_MATRIX_STACK_SIZE) { return; }
+	blah_draw_matrixStack[blah_draw_matrixDepth + 1] = blah_draw_matrixStack[blah_draw_matrixDepth];
+	blah_draw_matrixDepth++;
 }
 
 void blah_draw_popMatrix()
 {	//Retrieve (pop) the most recently 'pushed' matrix off stack and make current
-	blah_draw_gl_popMatrix();
+	if (blah_draw_matrixDepth == 0) { return; }
+	blah_draw_matrixDepth--;
+	blah_draw_gl_loadMatrix(&blah_draw_matrixStack[blah_draw_matrixDepth]);
 }
 
 void blah_draw_resetMatrix()
 {	//Set the current matrix to the identity matrix
-	blah_draw_gl_resetMatrix();
+	Blah_Matrix_setIdentity(&blah_draw_matrixStack[blah_draw_matrixDepth]);
+	blah_draw_gl_loadMatrix(&blah_draw_matrixStack[blah_draw_matrixDepth]);
 }
 
-void blah_draw_multMatrix(Blah_Matrix *matrix)
+void blah_draw_multMatrix(const Blah_Matrix *matrix)
 {	//Multiplies the current matrix by given matrix
-	blah_draw_gl_multMatrix(matrix);
+	Blah_Matrix *current = &blah_draw_matrixStack[blah_draw_matrixDepth];
+	blah_math_multiplyMatrices(current, current, matrix);
+	blah_draw_gl_loadMatrix(current);
+}
+
+void blah_draw_releaseLayer(Blah_Draw_Layer *layer)
+{	//Deletes the offscreen target of the layer
+	blah_draw_gl_releaseLayer(layer);
+}
+
+void blah_draw_releaseObject(Blah_Object *object)
+{	//Releases the drawing buffers compiled for the given object
+	blah_draw_gl_releaseObject(object);
 }
 
 void blah_draw_setCurrentScene(Blah_Scene *scene)
@@ -215,7 +372,15 @@ void blah_draw_setViewNormal(float x, float y, float z)
 void blah_draw_updatePerspective()
 {	//Updates viewing perspective before rendering world.  Arranges view
 	//according to the viewing parameters in the current drawing parameters
+	const float distance = Blah_Point_distancePoint(&blah_draw_currentParameters.viewpoint, &blah_draw_currentParameters.focalPoint);
+
+	blah_draw_viewVolume.halfWidth = distance * tanf(blah_draw_currentParameters.fieldOfVisionX / 2);
+	blah_draw_viewVolume.halfHeight = distance * tanf(blah_draw_currentParameters.fieldOfVisionY / 2);
+	blah_draw_viewVolume.depth = blah_draw_currentParameters.depthOfVision;
+	blah_draw_viewVolume.valid = true;
 	blah_draw_gl_updatePerspective();
+	blah_draw_formatViewMatrix(&blah_draw_matrixStack[blah_draw_matrixDepth]);
+	blah_draw_gl_loadMatrix(&blah_draw_matrixStack[blah_draw_matrixDepth]);
 }
 
 
@@ -243,6 +408,16 @@ void blah_draw_lineStrip(Blah_Vertex *points[], Blah_Material *material)
 	blah_draw_gl_lineStrip(points, !material ? &blah_draw_defaultMaterial : material); //If material not specified, use default material
 }
 
+void blah_draw_object(Blah_Object *object)
+{	//Draws all primitives of the given object, through compiled buffers if batching is enabled.
+	//Baked objects have only a mesh, so are always drawn through their buffers.
+	if (blah_draw_objectBatching || object->mesh != NULL) {
+		blah_draw_gl_object(object);
+	} else {
+		Blah_Array_callFunction(&object->primitives, (blah_array_element_func*)Blah_Primitive_draw);
+	}
+}
+
 void blah_draw_pixels2d(void *source, blah_pixel_format format, unsigned int width,	unsigned int height, int screenX, int screenY)
 {	//Draws a rectangle of pixels to the video in 2d mode.  Pixels are copied from
 	//memory pointed to by source, and drawn to video as a block of width * height
@@ -272,6 +447,31 @@ void blah_draw_polygon2d(Blah_Vertex *vertices[], Blah_Texture_Map *textureMap,
 	blah_draw_gl_polygon2d(vertices, textureMap, !material ? &blah_draw_defaultMaterial : material); //If material not specified, use default material
 }
 
+void blah_draw_quads2d(const Blah_Draw_Vertex2d *vertices, size_t quadCount, const Blah_Texture *texture, Blah_Material *material)
+{	//Draws quads of four vertices each in 2d mode, relative to current drawport, in a single draw
+	blah_draw_gl_quads2d(vertices, quadCount, texture, !material ? &blah_draw_defaultMaterial : material); //If material not specified, use default material
+}
+
+void blah_draw_setCulling(bool enabled)
+{	//Enables or disables skipping objects outside the viewing volume
+	blah_draw_culling = enabled;
+}
+
+void blah_draw_setInstancing(bool enabled)
+{	//Enables or disables drawing objects queued several times as instances
+	blah_draw_gl_setInstancing(enabled);
+}
+
+void blah_draw_setObjectBatching(bool enabled)
+{	//Enables or disables drawing objects through compiled vertex buffers
+	blah_draw_objectBatching = enabled;
+}
+
+void blah_draw_setRenderQueue(bool enabled)
+{	//Enables or disables sorting of compiled objects before drawing
+	blah_draw_renderQueue = enabled;
+}
+
 void blah_draw_solidCone(float base, float height, int slices, int stacks, Blah_Material *material)
 {	//Draw solid cone.  Use default material if no pointer to a material is given
 	blah_draw_gl_solidCone(base, height, slices, stacks, !material ? &blah_draw_defaultMaterial : material);
@@ -9,6 +9,7 @@
 #define _BLAH_DRAW
 
 #include "blah_scene.h"
+#include "blah_draw_layer.h"
 #include "blah_matrix.h"
 #include "blah_colour.h"
 #include "blah_list.h"
@@ -19,6 +20,7 @@
 
 #define BLAH_DRAW_API_NAME_LENGTH 20
 #define BLAH_DRAW_DRAWPORT_STACK_SIZE 100
+#define BLAH_DRAW_MATRIX_STACK_SIZE 32	//Deepest nesting of blah_draw_pushMatrix
 
 /* Function Type Declarations */
 
@@ -49,16 +51,58 @@ typedef struct Blah_Draw_Parameters {
 	float depthOfVision;		//depth of viewing area, distance from eye
 } Blah_Draw_Parameters;
 
+typedef struct Blah_Draw_Stats { //Counters of drawing work, reset at the start of each frame by blah_draw_main
+	unsigned long drawCalls;		//Number of primitive batches submitted to the drawing API
+	unsigned long vertices;			//Number of vertices submitted to the drawing API
+	unsigned long objectCompiles;	//Number of objects whose drawing buffers were (re)built
+	unsigned long materialChanges;	//Number of times the drawing API material state was changed
+	unsigned long textureChanges;	//Number of times the drawing API texture binding was changed
+	unsigned long queuedItems;		//Number of items drawn through the render queue
+	unsigned long instancedItems;	//Number of queued items drawn as instances, several to a draw call
+	unsigned long objectsDrawn;		//Number of scene and entity objects which passed view culling
+	unsigned long objectsCulled;	//Number of scene and entity objects skipped as outside the viewing volume
+	unsigned long overlayRedraws;	//Number of overlays whose text was drawn, into their layer or directly
+	unsigned long overlayComposites;	//Number of overlays drawn as a single quad from their cached layer
+} Blah_Draw_Stats;
+
 typedef struct Blah_Draw_Capabilities { //Represents drawing system/hardware capabilities.
 	bool lighting; //This flag indicates whether the drawing system supports Lighting
 } Blah_Draw_Capabilities;
 
+typedef struct Blah_Draw_Vertex2d { //Corner of a textured quad drawn in 2d mode, relative to the current drawport
+	float location[2];
+	float texCoord[2];
+} Blah_Draw_Vertex2d;
+
 /* Function Prototypes */
 
 #ifdef __cplusplus
 	extern "C" {
 #endif //__cplusplus
 
+void blah_draw_getMatrix(Blah_Matrix *matrix);
+	//Copies the current drawing matrix, which takes object coordinates to eye coordinates, into *matrix
+
+void blah_draw_getStats(Blah_Draw_Stats *stats);
+	//Copies the drawing counters of the current or most recently drawn frame into *stats
+
+bool blah_draw_beginLayer(Blah_Draw_Layer *layer, unsigned int width, unsigned int height);
+	//Redirects all drawing into the layer until blah_draw_endLayer, creating or resizing its target
+	//to the given size in pixels and clearing it.  2d coordinates relative to a drawport at 0,0 map
+	//to the pixels of the layer.  Layers cannot be nested.  Returns false, and drawing is not
+	//redirected, if the drawing API has no offscreen targets.
+
+void blah_draw_beginQueue();
+	//Begins collecting compiled objects into the render queue instead of drawing them at once,
+	//if the render queue is enabled.  Each queued item remembers the current drawing matrix.
+
+void blah_draw_compositeLayer(const Blah_Draw_Layer *layer);
+	//Draws the contents of the layer as a single quad in 2d mode, with its bottom left corner at the
+	//origin of the current drawport.  Colours blend as if the layer's drawing were repeated there.
+
+void blah_draw_endLayer(Blah_Draw_Layer *layer);
+	//Ends drawing into the layer begun with blah_draw_beginLayer, restoring drawing to the screen
+
 void blah_draw_exit();
 	//This function is called when the engine exits and deallocates resources used
 	//by the drawing engine component.  Exits video mode etc
@@ -66,21 +110,43 @@ void blah_draw_exit();
 bool blah_draw_init();
 	//Initialise drawing engine component.  Returns true on success.
 
+bool blah_draw_isObjectVisible(const Blah_Object *object);
+	//Returns true if the bounding sphere of the object, placed by the current drawing matrix,
+	//is at least partly inside the viewing volume set by the last blah_draw_updatePerspective.
+	//Counts the object as drawn or culled in the drawing stats.  Always true if culling is disabled.
+
+void blah_draw_flushQueue();
+	//Sorts and draws all items collected since blah_draw_beginQueue, then stops queueing.
+	//Opaque items are drawn first, ordered by texture, material and then front to back.
+	//Translucent items follow, ordered back to front, without writing to the depth buffer.
+
+void blah_draw_loadMatrix(const Blah_Matrix *matrix);
+	//Replaces the current drawing matrix with the given matrix
+
 void blah_draw_main();
 	//Main drawing routine.  Sets perspective and draws enitites/objects
 
-void blah_draw_multMatrix(Blah_Matrix *matrix);
+void blah_draw_multMatrix(const Blah_Matrix *matrix);
 	//Multiplies the current matrix by given matrix
 
 void blah_draw_popMatrix();
 	//Retrieve (pop) the most recently 'pushed' matrix off stack and make current
 
 void blah_draw_pushMatrix();
-	//Preserves the current drawing matrix by pushing it on to the matrix stack
+	//Preserves the current drawing matrix by pushing it on to the matrix stack.  The stack is kept by
+	//the engine rather than the drawing API, and each change of the current matrix is passed to the
+	//drawing API whole, so the matrix never has to be read back from it.  Pushes beyond
+	//BLAH_DRAW_MATRIX_STACK_SIZE deep, and pops of an empty stack, are ignored.
 
 void blah_draw_resetMatrix();
 	//Set the current matrix to the identity matrix
 
+void blah_draw_releaseLayer(Blah_Draw_Layer *layer);
+	//Deletes the offscreen target of the layer.  It is created again if the layer is next drawn into.
+
+void blah_draw_releaseObject(Blah_Object *object);
+	//Releases the drawing buffers compiled for the given object
+
 void blah_draw_setCurrentScene(Blah_Scene *scene);
 	//Sets the pointer to the current scene to be rendered
 
@@ -159,6 +225,11 @@ void blah_draw_lines(Blah_Vertex *points[], Blah_Material *material);
 void blah_draw_lineStrip(Blah_Vertex *points[], Blah_Material *material);
 	//Draws a sequence of lines connected to each other, using single point for next line to
 
+void blah_draw_object(Blah_Object *object);
+	//Draws all primitives of the given object.  Unless batching is disabled, triangles, quadrilaterals,
+	//polygons and triangle strips are compiled once into vertex buffers grouped by material and texture,
+	//so the object is drawn with one call per group.  Buffers are rebuilt after Blah_Object_invalidate.
+
 void blah_draw_pixels2d(void *source, blah_pixel_format format, unsigned int width, unsigned int height, int screenX, int screenY);
 	//Draws a rectangle of pixels to the video in 2d mode.  Pixels are copied from
 	//memory pointed to by source, and drawn to video as a block of width * height
@@ -178,6 +249,28 @@ void blah_draw_polygon2d(Blah_Vertex *vertices[],  Blah_Texture_Map *textureMap,
 	//Draw a polygon in 2d mode with vertices specified by array of points.
 	//Vertex coordinates are rendered relative to current drawport.
 
+void blah_draw_quads2d(const Blah_Draw_Vertex2d *vertices, size_t quadCount, const Blah_Texture *texture, Blah_Material *material);
+	//Draws quads of four vertices each in 2d mode, relative to the current drawport, with one state
+	//setup and one draw call.  Texture may be NULL.  As with blah_draw_polygon2d, ambient light is
+	//full while the quads are drawn.
+
+void blah_draw_setCulling(bool enabled);
+	//Enables or disables skipping scene and entity objects outside the viewing volume.  Enabled by default.
+
+void blah_draw_setInstancing(bool enabled);
+	//Enables or disables drawing compiled objects queued several times in a frame, such as an object
+	//shared by many entities, as instances in one draw call for each of their groups.  Only opaque
+	//groups are drawn as instances, and only if the drawing API supports it.  Enabled by default.
+
+void blah_draw_setObjectBatching(bool enabled);
+	//Enables or disables drawing objects through compiled vertex buffers.  Enabled by default.
+	//The render queue is only used while batching is enabled.  Baked objects (see blah_object.h),
+	//having no primitives, are drawn through compiled buffers either way.
+
+void blah_draw_setRenderQueue(bool enabled);
+	//Enables or disables sorting of the compiled objects of each scene by blah_draw_flushQueue.
+	//Enabled by default.
+
 void blah_draw_solidSphere(float radius, int slices, int stacks, Blah_Material *material);
 	//Draw a solid sphere in given colour with given characteristics
 
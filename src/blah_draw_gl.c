@@ -6,6 +6,10 @@
 #include <GL/glu.h>
 #include <stdio.h>
 #include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #ifdef BLAH_USE_GLUT
 #include <GL/glut.h>
@@ -18,13 +22,154 @@
 #include "blah_debug.h"
 #include "blah_console.h"
 #include "blah_error.h"
+#include "blah_mesh.h"
+#include "blah_primitive.h"
 
 /* Externally Referenced Variables */
 
 extern Blah_Draw_Parameters blah_draw_currentParameters;
+extern Blah_Draw_Stats blah_draw_stats;
+extern Blah_Material blah_draw_defaultMaterial;
 extern Blah_Scene *blah_draw_currentScene;
 extern Blah_Video_Mode *blah_video_currentMode;
 
+/* Structure Definitions */
+
+// Objects are drawn from their mesh (see blah_mesh.h), uploaded into one interleaved vertex buffer
+// and one index buffer of triangles.  The buffers are kept in client memory if the context is older than
+// OpenGL 1.5, or if BLAH_DRAW_GL_NO_VBO is defined.
+// Layers (see blah_draw.h) are drawn into framebuffer objects, from OpenGL 3.0 or ARB_framebuffer_object.
+// Define BLAH_DRAW_GL_NO_FBO to build without them, in which case layers are never begun.
+// Opaque items of the render queue sharing a compiled object are drawn as instances, with one
+// glDrawElementsInstanced call and a buffer of their matrices, from OpenGL 3.3.  A small shader program
+// stands in for fixed function lighting and texturing while they are drawn.  Define
+// BLAH_DRAW_GL_NO_INSTANCING to build without it, in which case every item is drawn on its own.
+
+#if defined(BLAH_DRAW_GL_NO_VBO) && !defined(BLAH_DRAW_GL_NO_INSTANCING)
+	#define BLAH_DRAW_GL_NO_INSTANCING //Instance matrices are read from a buffer object
+#endif
+
+#define BLAH_DRAW_GL_MAX_LIGHTS 8	//Number of lights set up by blah_draw_gl_setLight
+
+#define BLAH_DRAW_GL_INSTANCE_ATTRIBUTE 12	//First of four generic attributes holding the instance matrix,
+	//clear of those which some drivers alias to fixed function arrays
+
+typedef struct Blah_Draw_Batch { //Buffers holding the mesh of an object
+	GLuint vertexBuffer;		//Buffer object names, 0 if not yet generated or kept in client memory
+	GLuint indexBuffer;
+	const Blah_Mesh_Vertex* vertexData;	//Client side buffers, only kept if not using buffer objects
+	const GLuint* indexData;
+	void* clientStorage;		//Allocation holding client side buffers, NULL if they belong to the object's mesh
+	Blah_Mesh_Group* groups;	//Index ranges in order of drawing
+	size_t groupCount;
+	size_t immediateCount;		//Number of primitives which could not be compiled and are drawn individually
+} Blah_Draw_Batch;
+
+#ifndef BLAH_DRAW_GL_NO_INSTANCING
+typedef struct Blah_Draw_GL_Instance_Program { //Shader program drawing instances lit by a given number of lights
+	GLuint program;				//Program name, 0 if not yet built
+	GLint lightingUniform;		//Locations of uniforms
+	GLint texturedUniform;
+} Blah_Draw_GL_Instance_Program;
+#endif
+
+typedef struct Blah_Draw_GL_Queue_Item { //Group of a compiled object waiting in the render queue
+	uint64_t sortKey;			//Pass, texture, material and depth packed so that items sort in drawing order
+	const Blah_Draw_Batch* batch;
+	const Blah_Mesh_Group* group;
+	size_t matrixIndex;			//Modelview matrix to draw with, in the queue matrix array
+	size_t sequence;			//Order in which item was queued, to break ties
+} Blah_Draw_GL_Queue_Item;
+
+/* OpenGL Entry Points */
+
+//Functions added after OpenGL 1.1 are not exported by every OpenGL library, opengl32 on Windows exporting
+//none of them, so they are looked up through the video API (see blah_video_getProcAddress) when the
+//feature using them is first needed.  A feature is left off if any of its functions are missing.
+
+//Buffer objects, OpenGL 1.5
+static PFNGLBINDBUFFERPROC blah_draw_gl_glBindBuffer = NULL;
+#define glBindBuffer blah_draw_gl_glBindBuffer
+static PFNGLBUFFERDATAPROC blah_draw_gl_glBufferData = NULL;
+#define glBufferData blah_draw_gl_glBufferData
+static PFNGLDELETEBUFFERSPROC blah_draw_gl_glDeleteBuffers = NULL;
+#define glDeleteBuffers blah_draw_gl_glDeleteBuffers
+static PFNGLGENBUFFERSPROC blah_draw_gl_glGenBuffers = NULL;
+#define glGenBuffers blah_draw_gl_glGenBuffers
+
+#ifndef BLAH_DRAW_GL_NO_FBO
+//Framebuffer objects, OpenGL 3.0, and separate blending of alpha used when drawing into them
+static PFNGLBINDFRAMEBUFFERPROC blah_draw_gl_glBindFramebuffer = NULL;
+#define glBindFramebuffer blah_draw_gl_glBindFramebuffer
+static PFNGLBINDRENDERBUFFERPROC blah_draw_gl_glBindRenderbuffer = NULL;
+#define glBindRenderbuffer blah_draw_gl_glBindRenderbuffer
+static PFNGLBLENDFUNCSEPARATEPROC blah_draw_gl_glBlendFuncSeparate = NULL;
+#define glBlendFuncSeparate blah_draw_gl_glBlendFuncSeparate
+static PFNGLCHECKFRAMEBUFFERSTATUSPROC blah_draw_gl_glCheckFramebufferStatus = NULL;
+#define glCheckFramebufferStatus blah_draw_gl_glCheckFramebufferStatus
+static PFNGLDELETEFRAMEBUFFERSPROC blah_draw_gl_glDeleteFramebuffers = NULL;
+#define glDeleteFramebuffers blah_draw_gl_glDeleteFramebuffers
+static PFNGLDELETERENDERBUFFERSPROC blah_draw_gl_glDeleteRenderbuffers = NULL;
+#define glDeleteRenderbuffers blah_draw_gl_glDeleteRenderbuffers
+static PFNGLFRAMEBUFFERRENDERBUFFERPROC blah_draw_gl_glFramebufferRenderbuffer = NULL;
+#define glFramebufferRenderbuffer blah_draw_gl_glFramebufferRenderbuffer
+static PFNGLFRAMEBUFFERTEXTURE2DPROC blah_draw_gl_glFramebufferTexture2D = NULL;
+#define glFramebufferTexture2D blah_draw_gl_glFramebufferTexture2D
+static PFNGLGENFRAMEBUFFERSPROC blah_draw_gl_glGenFramebuffers = NULL;
+#define glGenFramebuffers blah_draw_gl_glGenFramebuffers
+static PFNGLGENRENDERBUFFERSPROC blah_draw_gl_glGenRenderbuffers = NULL;
+#define glGenRenderbuffers blah_draw_gl_glGenRenderbuffers
+static PFNGLRENDERBUFFERSTORAGEPROC blah_draw_gl_glRenderbufferStorage = NULL;
+#define glRenderbufferStorage blah_draw_gl_glRenderbufferStorage
+#endif
+
+#ifndef BLAH_DRAW_GL_NO_INSTANCING
+//Shader programs, OpenGL 2.0, and instanced drawing, OpenGL 3.3
+static PFNGLATTACHSHADERPROC blah_draw_gl_glAttachShader = NULL;
+#define glAttachShader blah_draw_gl_glAttachShader
+static PFNGLBINDATTRIBLOCATIONPROC blah_draw_gl_glBindAttribLocation = NULL;
+#define glBindAttribLocation blah_draw_gl_glBindAttribLocation
+static PFNGLCOMPILESHADERPROC blah_draw_gl_glCompileShader = NULL;
+#define glCompileShader blah_draw_gl_glCompileShader
+static PFNGLCREATEPROGRAMPROC blah_draw_gl_glCreateProgram = NULL;
+#define glCreateProgram blah_draw_gl_glCreateProgram
+static PFNGLCREATESHADERPROC blah_draw_gl_glCreateShader = NULL;
+#define glCreateShader blah_draw_gl_glCreateShader
+static PFNGLDELETEPROGRAMPROC blah_draw_gl_glDeleteProgram = NULL;
+#define glDeleteProgram blah_draw_gl_glDeleteProgram
+static PFNGLDELETESHADERPROC blah_draw_gl_glDeleteShader = NULL;
+#define glDeleteShader blah_draw_gl_glDeleteShader
+static PFNGLDISABLEVERTEXATTRIBARRAYPROC blah_draw_gl_glDisableVertexAttribArray = NULL;
+#define glDisableVertexAttribArray blah_draw_gl_glDisableVertexAttribArray
+static PFNGLDRAWELEMENTSINSTANCEDPROC blah_draw_gl_glDrawElementsInstanced = NULL;
+#define glDrawElementsInstanced blah_draw_gl_glDrawElementsInstanced
+static PFNGLENABLEVERTEXATTRIBARRAYPROC blah_draw_gl_glEnableVertexAttribArray = NULL;
+#define glEnableVertexAttribArray blah_draw_gl_glEnableVertexAttribArray
+static PFNGLGETPROGRAMIVPROC blah_draw_gl_glGetProgramiv = NULL;
+#define glGetProgramiv blah_draw_gl_glGetProgramiv
+static PFNGLGETSHADERINFOLOGPROC blah_draw_gl_glGetShaderInfoLog = NULL;
+#define glGetShaderInfoLog blah_draw_gl_glGetShaderInfoLog
+static PFNGLGETSHADERIVPROC blah_draw_gl_glGetShaderiv = NULL;
+#define glGetShaderiv blah_draw_gl_glGetShaderiv
+static PFNGLGETUNIFORMLOCATIONPROC blah_draw_gl_glGetUniformLocation = NULL;
+#define glGetUniformLocation blah_draw_gl_glGetUniformLocation
+static PFNGLLINKPROGRAMPROC blah_draw_gl_glLinkProgram = NULL;
+#define glLinkProgram blah_draw_gl_glLinkProgram
+static PFNGLSHADERSOURCEPROC blah_draw_gl_glShaderSource = NULL;
+#define glShaderSource blah_draw_gl_glShaderSource
+static PFNGLUNIFORM1IPROC blah_draw_gl_glUniform1i = NULL;
+#define glUniform1i blah_draw_gl_glUniform1i
+static PFNGLUSEPROGRAMPROC blah_draw_gl_glUseProgram = NULL;
+#define glUseProgram blah_draw_gl_glUseProgram
+static PFNGLVERTEXATTRIBDIVISORPROC blah_draw_gl_glVertexAttribDivisor = NULL;
+#define glVertexAttribDivisor blah_draw_gl_glVertexAttribDivisor
+static PFNGLVERTEXATTRIBPOINTERPROC blah_draw_gl_glVertexAttribPointer = NULL;
+#define glVertexAttribPointer blah_draw_gl_glVertexAttribPointer
+#endif
+
+#define BLAH_DRAW_GL_LOAD(type, function) ((function = (type)blah_video_getProcAddress(#function)) != NULL)
+	//Looks up the named function, evaluating to false if it is missing
+
 /* Static Private Globals */
 
 //Since OpenGL is a state machine, we should avoid setting the same state repeatedly
@@ -42,21 +187,137 @@ Blah_Matrix blah_draw_gl_2dProjectionMatrix;
 
 static Blah_Debug_Log blah_draw_gl_log = { .filePointer = NULL };
 
+static bool blah_draw_gl_queueActive = false;
+	//If true, compiled objects are queued rather than drawn
+static Blah_Draw_GL_Queue_Item *blah_draw_gl_queueItems = NULL;
+static size_t blah_draw_gl_queueLength = 0, blah_draw_gl_queueCapacity = 0;
+static Blah_Matrix *blah_draw_gl_queueMatrices = NULL;
+static size_t blah_draw_gl_queueMatrixCount = 0, blah_draw_gl_queueMatrixCapacity = 0;
+	//Render queue storage, kept between frames
+
+#ifndef BLAH_DRAW_GL_NO_INSTANCING
+static bool blah_draw_gl_instancing = true;
+	//If true, opaque queue items sharing a compiled object are drawn as instances
+static enum {BLAH_DRAW_GL_INSTANCING_UNKNOWN, BLAH_DRAW_GL_INSTANCING_SUPPORTED, BLAH_DRAW_GL_INSTANCING_UNSUPPORTED}
+	blah_draw_gl_instancingSupport = BLAH_DRAW_GL_INSTANCING_UNKNOWN;
+	//Whether the context can draw instances, checked when the queue is first flushed
+static Blah_Draw_GL_Instance_Program blah_draw_gl_instancePrograms[BLAH_DRAW_GL_MAX_LIGHTS + 1];
+	//Programs built so far, indexed by number of lights, so that the lighting loop of each is unrolled
+static const Blah_Draw_GL_Instance_Program *blah_draw_gl_flushProgram = NULL;
+	//Program drawing instances of the queue being flushed, or NULL while not instancing
+static GLuint blah_draw_gl_instanceBuffer = 0;
+static bool blah_draw_gl_instanceTexturing = false;
+	//True if texturing was enabled when the queue being flushed began drawing instances
+static Blah_Matrix *blah_draw_gl_instanceMatrices = NULL;
+static size_t blah_draw_gl_instanceMatrixCapacity = 0;
+	//Matrices of opaque queue items in drawing order, uploaded to the instance buffer by each flush
+
+static const char *blah_draw_gl_instanceVertexShader =
+	//Preceded by the version and a definition of LIGHT_COUNT
+	"attribute mat4 instanceMatrix;\n" //Modelview matrix of the instance
+	"uniform bool lighting;\n"
+	"void main()\n"
+	"{\n"
+	"	vec4 eye = instanceMatrix * gl_Vertex;\n"
+	"	vec3 x = instanceMatrix[0].xyz, y = instanceMatrix[1].xyz, z = instanceMatrix[2].xyz;\n"
+	"	vec3 normal = mat3(cross(y, z), cross(z, x), cross(x, y)) / dot(x, cross(y, z)) * gl_Normal;\n" //Inverse transpose
+	"	vec4 colour = gl_FrontLightModelProduct.sceneColor;\n"
+	"	for (int light = 0; light < LIGHT_COUNT; light++) {\n" //Fixed function lighting, with an infinite viewer
+	"		vec4 position = gl_LightSource[light].position;\n"
+	"		vec3 direction = normalize(position.xyz);\n"
+	"		float attenuation = 1.0;\n"
+	"		if (position.w != 0.0) {\n"
+	"			direction = position.xyz / position.w - eye.xyz / eye.w;\n"
+	"			float distance = length(direction);\n"
+	"			direction /= distance;\n"
+	"			attenuation = 1.0 / (gl_LightSource[light].constantAttenuation + gl_LightSource[light].linearAttenuation * distance\n"
+	"				+ gl_LightSource[light].quadraticAttenuation * distance * distance);\n"
+	"		}\n"
+	"		if (gl_LightSource[light].spotCutoff != 180.0) {\n"
+	"			float spot = max(dot(-direction, normalize(gl_LightSource[light].spotDirection)), 0.0);\n"
+	"			attenuation *= spot < gl_LightSource[light].spotCosCutoff ? 0.0 : pow(spot, gl_LightSource[light].spotExponent);\n"
+	"		}\n"
+	"		vec4 lit = gl_FrontLightProduct[light].ambient;\n"
+	"		float diffuse = dot(normal, direction);\n"
+	"		if (diffuse > 0.0) {\n"
+	"			float specular = max(dot(normal, normalize(direction + vec3(0.0, 0.0, 1.0))), 0.0);\n"
+	"			lit += diffuse * gl_FrontLightProduct[light].diffuse + (gl_FrontMaterial.shininess > 0.0 ?\n"
+	"				pow(specular, gl_FrontMaterial.shininess) : 1.0) * gl_FrontLightProduct[light].specular;\n"
+	"		}\n"
+	"		colour += attenuation * lit;\n"
+	"	}\n"
+	"	colour.a = gl_FrontMaterial.diffuse.a;\n"
+	"	gl_FrontColor = lighting ? colour : gl_Color;\n"
+	"	gl_TexCoord[0] = gl_TextureMatrix[0] * gl_MultiTexCoord0;\n"
+	"	gl_Position = gl_ProjectionMatrix * eye;\n"
+	"}\n";
+
+static const char *blah_draw_gl_instanceFragmentShader =
+	//Preceded by the version, as the vertex shader
+	"uniform bool textured;\n"
+	"uniform sampler2D image;\n"
+	"void main()\n"
+	"{\n"
+	"	gl_FragColor = textured ? gl_Color * texture2D(image, gl_TexCoord[0].st) : gl_Color;\n" //Modulate, as fixed function
+	"}\n";
+#endif
+
+static enum {BLAH_DRAW_GL_BUFFERS_UNKNOWN, BLAH_DRAW_GL_BUFFERS_SUPPORTED, BLAH_DRAW_GL_BUFFERS_UNSUPPORTED}
+	blah_draw_gl_bufferSupport = BLAH_DRAW_GL_BUFFERS_UNKNOWN;
+	//Whether the context has buffer objects, checked when an object is first compiled
+
+#ifndef BLAH_DRAW_GL_NO_FBO
+static enum {BLAH_DRAW_GL_LAYERS_UNKNOWN, BLAH_DRAW_GL_LAYERS_SUPPORTED, BLAH_DRAW_GL_LAYERS_UNSUPPORTED}
+	blah_draw_gl_layerSupport = BLAH_DRAW_GL_LAYERS_UNKNOWN;
+	//Whether the context has framebuffer objects, checked when a layer is first begun
+#endif
+
 int blah_draw_gl_activeLights = 0;
-GLenum blah_draw_gl_lightSymbols[8] = {GL_LIGHT0, GL_LIGHT1, GL_LIGHT2, GL_LIGHT3,	GL_LIGHT4, GL_LIGHT5, GL_LIGHT6, GL_LIGHT7};
+GLenum blah_draw_gl_lightSymbols[BLAH_DRAW_GL_MAX_LIGHTS] = {GL_LIGHT0, GL_LIGHT1, GL_LIGHT2, GL_LIGHT3,	GL_LIGHT4, GL_LIGHT5, GL_LIGHT6, GL_LIGHT7};
 
 /* Static Function Prototypes */
 
+static void blah_draw_gl_pop2dMatrices();
+
 static void blah_draw_gl_primitive(Blah_Vertex *vertices[], GLenum mode, Blah_Texture_Map *textureMap, Blah_Material *material);
 
 static void blah_draw_gl_primitive2d(Blah_Vertex *vertices[], GLenum mode, Blah_Texture_Map *textureMap, Blah_Material *material);
 
+static void blah_draw_gl_push2dMatrices();
+
 static void blah_draw_gl_resetLights();
 
+static void blah_draw_gl_restoreTexture();
+
+static void blah_draw_gl_setMaterial(Blah_Material* material);
+
+static void blah_draw_gl_setTexture(const Blah_Texture* texture);
+
 /* Function Declarations */
 
 void blah_draw_gl_exit()
 {	//Exit the opengl drawing engine component.  Deallocates resources
+	free(blah_draw_gl_queueItems);
+	free(blah_draw_gl_queueMatrices);
+	blah_draw_gl_queueItems = NULL;
+	blah_draw_gl_queueMatrices = NULL;
+	blah_draw_gl_queueCapacity = blah_draw_gl_queueMatrixCapacity = 0;
+#ifndef BLAH_DRAW_GL_NO_INSTANCING
+	for (size_t lightCount = 0; lightCount <= BLAH_DRAW_GL_MAX_LIGHTS; lightCount++) {
+		if (blah_draw_gl_instancePrograms[lightCount].program != 0) { glDeleteProgram(blah_draw_gl_instancePrograms[lightCount].program); }
+		blah_draw_gl_instancePrograms[lightCount].program = 0;
+	}
+	if (blah_draw_gl_instanceBuffer != 0) { glDeleteBuffers(1, &blah_draw_gl_instanceBuffer); }
+	blah_draw_gl_instanceBuffer = 0;
+	blah_draw_gl_instancingSupport = BLAH_DRAW_GL_INSTANCING_UNKNOWN;
+	free(blah_draw_gl_instanceMatrices);
+	blah_draw_gl_instanceMatrices = NULL;
+	blah_draw_gl_instanceMatrixCapacity = 0;
+#endif
+#ifndef BLAH_DRAW_GL_NO_FBO
+	blah_draw_gl_layerSupport = BLAH_DRAW_GL_LAYERS_UNKNOWN;
+#endif
+	blah_draw_gl_bufferSupport = BLAH_DRAW_GL_BUFFERS_UNKNOWN; //Functions are looked up again for the next context
 	Blah_Debug_Log_disable(&blah_draw_gl_log);
 }
 
@@ -152,9 +413,9 @@ void blah_draw_gl_lineStrip(Blah_Vertex *points[], Blah_Material *material)
 	blah_draw_gl_primitive(points, GL_LINE_STRIP, NULL, material);
 }
 
-void blah_draw_gl_multMatrix(Blah_Matrix *matrix)
-{	//Multiply current matrix by supplied matrix
-	glMultMatrixf((GLfloat*)matrix);
+void blah_draw_gl_loadMatrix(const Blah_Matrix *matrix)
+{	//Replaces the modelview matrix with the given matrix
+	glLoadMatrixf((const GLfloat*)matrix);
 }
 
 void blah_draw_gl_pixels2d(void *source, blah_pixel_format format, unsigned int width, unsigned int height, int screenX, int screenY)
@@ -227,12 +488,191 @@ void blah_draw_gl_polygon2d(Blah_Vertex *vertices[], Blah_Texture_Map *textureMa
 
 	blah_draw_gl_primitive2d(vertices, GL_POLYGON, textureMap, material);
 
-	blah_draw_gl_setAmbientLight(ambientLightRed, ambientLightBlue, ambientLightGreen, ambientLightAlpha);
+	blah_draw_gl_setAmbientLight(ambientLightRed, ambientLightGreen, ambientLightBlue, ambientLightAlpha);
 }
 
-void blah_draw_gl_popMatrix()
-{	//Pop OpenGL matrix and restore previous state
-	glPopMatrix();
+void blah_draw_gl_quads2d(const Blah_Draw_Vertex2d *vertices, size_t quadCount, const Blah_Texture *texture, Blah_Material *material)
+{	//Draws quads in 2d mode from one vertex array, relative to current drawport, with state set up once
+	const Blah_Scene *scene = blah_draw_currentScene;
+
+	if (quadCount == 0) { return; }
+	blah_draw_gl_setAmbientLight(1,1,1,1);
+	blah_draw_gl_setMaterial(material);
+	blah_draw_gl_setTexture(texture);
+
+	blah_draw_gl_push2dMatrices();
+	glNormal3f(0, 0, 1); //All quads face the viewer
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(Blah_Draw_Vertex2d), vertices->location);
+	glTexCoordPointer(2, GL_FLOAT, sizeof(Blah_Draw_Vertex2d), vertices->texCoord);
+	glDrawArrays(GL_QUADS, 0, (GLsizei)(quadCount * 4));
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	blah_draw_stats.drawCalls++;
+	blah_draw_stats.vertices += quadCount * 4;
+
+	blah_draw_gl_pop2dMatrices();
+	blah_draw_gl_setAmbientLight(scene->ambientLightRed, scene->ambientLightGreen, scene->ambientLightBlue, scene->ambientLightAlpha);
+}
+
+#if !defined(BLAH_DRAW_GL_NO_VBO) || !defined(BLAH_DRAW_GL_NO_FBO)
+static bool blah_draw_gl_isVersion(int major, int minor)
+{	//Returns true if the context provides at least the given version of OpenGL
+	const char *version = (const char*)glGetString(GL_VERSION);
+	int contextMajor = 0, contextMinor = 0;
+
+	return version != NULL && sscanf(version, "%d.%d", &contextMajor, &contextMinor) == 2 &&
+		(contextMajor > major || (contextMajor == major && contextMinor >= minor));
+}
+#endif
+
+static bool blah_draw_gl_hasBufferObjects()
+{	//Returns true if the context provides buffer objects, looking up their functions only once
+#ifdef BLAH_DRAW_GL_NO_VBO
+	return false;
+#else
+	if (blah_draw_gl_bufferSupport == BLAH_DRAW_GL_BUFFERS_UNKNOWN) {
+		blah_draw_gl_bufferSupport = blah_draw_gl_isVersion(1, 5) &&
+			BLAH_DRAW_GL_LOAD(PFNGLBINDBUFFERPROC, glBindBuffer) && BLAH_DRAW_GL_LOAD(PFNGLBUFFERDATAPROC, glBufferData) &&
+			BLAH_DRAW_GL_LOAD(PFNGLDELETEBUFFERSPROC, glDeleteBuffers) && BLAH_DRAW_GL_LOAD(PFNGLGENBUFFERSPROC, glGenBuffers) ?
+			BLAH_DRAW_GL_BUFFERS_SUPPORTED : BLAH_DRAW_GL_BUFFERS_UNSUPPORTED;
+		if (blah_draw_gl_bufferSupport == BLAH_DRAW_GL_BUFFERS_UNSUPPORTED) {
+			Blah_Debug_Log_message(&blah_draw_gl_log, "Buffer objects are not available, keeping compiled objects in client memory\n");
+		}
+	}
+	return blah_draw_gl_bufferSupport == BLAH_DRAW_GL_BUFFERS_SUPPORTED;
+#endif
+}
+
+#ifndef BLAH_DRAW_GL_NO_FBO
+static bool blah_draw_gl_hasFramebuffers()
+{	//Returns true if the context provides framebuffer objects, checking and looking up their functions only once
+	if (blah_draw_gl_layerSupport == BLAH_DRAW_GL_LAYERS_UNKNOWN) {
+		const char *extensions = (const char*)glGetString(GL_EXTENSIONS);
+		blah_draw_gl_layerSupport = (blah_draw_gl_isVersion(3, 0) ||
+			(extensions != NULL && strstr(extensions, "GL_ARB_framebuffer_object") != NULL)) &&
+			BLAH_DRAW_GL_LOAD(PFNGLBINDFRAMEBUFFERPROC, glBindFramebuffer) &&
+			BLAH_DRAW_GL_LOAD(PFNGLBINDRENDERBUFFERPROC, glBindRenderbuffer) &&
+			BLAH_DRAW_GL_LOAD(PFNGLBLENDFUNCSEPARATEPROC, glBlendFuncSeparate) &&
+			BLAH_DRAW_GL_LOAD(PFNGLCHECKFRAMEBUFFERSTATUSPROC, glCheckFramebufferStatus) &&
+			BLAH_DRAW_GL_LOAD(PFNGLDELETEFRAMEBUFFERSPROC, glDeleteFramebuffers) &&
+			BLAH_DRAW_GL_LOAD(PFNGLDELETERENDERBUFFERSPROC, glDeleteRenderbuffers) &&
+			BLAH_DRAW_GL_LOAD(PFNGLFRAMEBUFFERRENDERBUFFERPROC, glFramebufferRenderbuffer) &&
+			BLAH_DRAW_GL_LOAD(PFNGLFRAMEBUFFERTEXTURE2DPROC, glFramebufferTexture2D) &&
+			BLAH_DRAW_GL_LOAD(PFNGLGENFRAMEBUFFERSPROC, glGenFramebuffers) &&
+			BLAH_DRAW_GL_LOAD(PFNGLGENRENDERBUFFERSPROC, glGenRenderbuffers) &&
+			BLAH_DRAW_GL_LOAD(PFNGLRENDERBUFFERSTORAGEPROC, glRenderbufferStorage) ?
+			BLAH_DRAW_GL_LAYERS_SUPPORTED : BLAH_DRAW_GL_LAYERS_UNSUPPORTED;
+	}
+	return blah_draw_gl_layerSupport == BLAH_DRAW_GL_LAYERS_SUPPORTED;
+}
+
+static bool blah_draw_gl_createLayer(Blah_Draw_Layer *layer, unsigned int width, unsigned int height)
+{	//Creates the texture, depth buffer and framebuffer of the layer at the given size.  Returns false on failure.
+	GLenum status;
+
+	blah_draw_gl_releaseLayer(layer);
+	glGenTextures(1, (GLuint*)&layer->textureHandle);
+	glBindTexture(GL_TEXTURE_2D, (GLuint)layer->textureHandle);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST); //Composited pixel for pixel
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, (GLsizei)width, (GLsizei)height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	blah_draw_gl_restoreTexture();
+
+	//Depth is kept so that overlapping 2d drawing is resolved as when drawn to the screen
+	glGenRenderbuffers(1, (GLuint*)&layer->depthHandle);
+	glBindRenderbuffer(GL_RENDERBUFFER, (GLuint)layer->depthHandle);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, (GLsizei)width, (GLsizei)height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, (GLuint*)&layer->framebufferHandle);
+	glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)layer->framebufferHandle);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, (GLuint)layer->textureHandle, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, (GLuint)layer->depthHandle);
+	status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		Blah_Debug_Log_message(&blah_draw_gl_log, "Framebuffer of layer is incomplete\n");
+		blah_draw_gl_releaseLayer(layer);
+		return false;
+	}
+	layer->width = width;
+	layer->height = height;
+	return true;
+}
+#endif
+
+bool blah_draw_gl_beginLayer(Blah_Draw_Layer *layer, unsigned int width, unsigned int height)
+{	//Binds the framebuffer of the layer, creating or resizing it first, and clears it
+#ifdef BLAH_DRAW_GL_NO_FBO
+	return false;
+#else
+	if (width == 0 || height == 0 || !blah_draw_gl_hasFramebuffers()) { return false; }
+	if (layer->framebufferHandle == 0 || layer->width != width || layer->height != height) {
+		if (!blah_draw_gl_createLayer(layer, width, height)) { return false; }
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)layer->framebufferHandle);
+	glPushAttrib(GL_VIEWPORT_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	//2d projection maps the video mode, so a full screen viewport places drawport coordinates on layer pixels
+	glViewport(0, 0, (GLsizei)blah_video_currentMode->width, (GLsizei)blah_video_currentMode->height);
+	glClearColor(0, 0, 0, 0);
+	glDepthMask(GL_TRUE);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	//Keep colours premultiplied by their coverage, so that the layer composites as its drawing would blend
+	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	return true;
+#endif
+}
+
+void blah_draw_gl_compositeLayer(const Blah_Draw_Layer *layer)
+{	//Draws the layer texture as one quad at the current drawport, blending its premultiplied colours
+	const GLfloat width = (GLfloat)layer->width, height = (GLfloat)layer->height;
+	const GLfloat locations[] = {0, 0, width, 0, width, height, 0, height};
+	const GLfloat texCoords[] = {0, 0, 1, 0, 1, 1, 0, 1};
+
+	if (layer->textureHandle == 0) { return; }
+	glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT);
+	glDisable(GL_LIGHTING); //Layer already holds lit colours
+	glDisable(GL_DEPTH_TEST); //Composited over whatever is below, as overlays are drawn in order
+	glEnable(GL_TEXTURE_2D);
+	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	glColor4f(1, 1, 1, 1);
+	glBindTexture(GL_TEXTURE_2D, (GLuint)layer->textureHandle);
+	blah_draw_gl_push2dMatrices();
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, locations);
+	glTexCoordPointer(2, GL_FLOAT, 0, texCoords);
+	glDrawArrays(GL_QUADS, 0, 4);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	blah_draw_stats.drawCalls++;
+	blah_draw_stats.vertices += 4;
+
+	blah_draw_gl_pop2dMatrices();
+	blah_draw_gl_restoreTexture();
+	glPopAttrib();
+}
+
+void blah_draw_gl_endLayer()
+{	//Restores drawing to the default framebuffer, along with state changed by blah_draw_gl_beginLayer
+#ifndef BLAH_DRAW_GL_NO_FBO
+	glPopAttrib();
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+#endif
+}
+
+static void blah_draw_gl_pop2dMatrices()
+{	//Restores the projection and model view matrices saved by blah_draw_gl_push2dMatrices
+	glPopMatrix(); //restore projection matrix
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix(); //restore model view matrix
 }
 
 // Set the current material properties of the GL state machine.  Parameter 'material' must not be NULL
@@ -242,6 +682,7 @@ static void blah_draw_gl_setMaterial(Blah_Material* material)
         blah_error_raise(GL_INVALID_VALUE, "OpenGL Material cannot be set to NULL");
     } else if (material != blah_draw_gl_currentMaterial) { // If using a different material than previous, change opengl state
 		blah_draw_gl_currentMaterial = material;
+		blah_draw_stats.materialChanges++;
 		glMaterialfv(GL_FRONT, GL_AMBIENT, (GLfloat*)&material->ambient);
 		glMaterialfv(GL_FRONT, GL_DIFFUSE, (GLfloat*)&material->diffuse);
 		glMaterialfv(GL_FRONT, GL_SPECULAR, (GLfloat*)&material->specular);
@@ -254,7 +695,9 @@ static void blah_draw_gl_setMaterial(Blah_Material* material)
 // This function may be called with 'texture' set to a NULL pointer, which will disable the use of textures for the current state.
 static void blah_draw_gl_setTexture(const Blah_Texture* texture)
 {
+    if (texture != NULL) { Blah_Texture_use(texture); } // Keep levels of drawn textures uploaded
     if (texture != blah_draw_gl_currentTexture) { // Only update OpenGL state if current texture has changed
+        blah_draw_stats.textureChanges++;
         if (texture == NULL) {
             glBindTexture(GL_TEXTURE_2D, 0); // Bind to default texture (should be none)
             blah_draw_gl_currentTexture = NULL;
@@ -283,6 +726,61 @@ static void blah_draw_gl_primitive(Blah_Vertex *vertices[], GLenum mode, Blah_Te
         vertexIndex++; // For each vertex there is a corresponding texture coord
     }
 	glEnd(); //End GL primitive
+	blah_draw_stats.drawCalls++;
+	blah_draw_stats.vertices += vertexIndex;
+}
+
+/* Object Batch Functions */
+
+static void blah_draw_gl_compileObject(Blah_Object *object)
+{	//Builds vertex and index buffers from the mesh of the object, compiling the mesh from its
+	//primitives unless it was loaded baked, replacing any buffers compiled previously
+	Blah_Draw_Batch *batch = object->drawBatch;
+	Blah_Mesh compiledMesh;
+	const Blah_Mesh *mesh = object->mesh;
+
+	if (batch == NULL) {
+		batch = calloc(1, sizeof(Blah_Draw_Batch));
+		if (batch == NULL) { blah_error_raise(errno, "Failed to allocate draw batch for object"); }
+		object->drawBatch = batch;
+	}
+	if (mesh == NULL) {
+		Blah_Mesh_init(&compiledMesh);
+		Blah_Mesh_compileObject(&compiledMesh, object);
+		mesh = &compiledMesh;
+	}
+
+	free(batch->groups);
+	batch->groups = malloc(sizeof(Blah_Mesh_Group) * (mesh->groupCount + 1));
+	if (batch->groups == NULL) { blah_error_raise(errno, "Failed to allocate %lu groups to compile object", (unsigned long)mesh->groupCount); }
+	if (mesh->groupCount > 0) { memcpy(batch->groups, mesh->groups, sizeof(Blah_Mesh_Group) * mesh->groupCount); }
+	batch->groupCount = mesh->groupCount;
+	batch->immediateCount = mesh->immediateCount;
+
+	if (blah_draw_gl_hasBufferObjects()) {
+		if (batch->vertexBuffer == 0) { glGenBuffers(1, &batch->vertexBuffer); }
+		if (batch->indexBuffer == 0) { glGenBuffers(1, &batch->indexBuffer); }
+		glBindBuffer(GL_ARRAY_BUFFER, batch->vertexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(Blah_Mesh_Vertex) * mesh->vertexCount, mesh->vertices, GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch->indexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * mesh->indexCount, mesh->indices, GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	} else {
+		free(batch->clientStorage);
+		batch->vertexData = mesh->vertices;
+		batch->indexData = mesh->indices;
+		if (mesh == &compiledMesh) { //Keep the compiled arrays, a baked mesh lives as long as its object
+			batch->clientStorage = compiledMesh.storage;
+			compiledMesh.storage = NULL;
+		} else {
+			batch->clientStorage = NULL;
+		}
+	}
+	if (mesh == &compiledMesh) { Blah_Mesh_disable(&compiledMesh); } //Data now belongs to OpenGL or the batch
+
+	object->drawBatchDirty = false;
+	blah_draw_stats.objectCompiles++;
 }
 
 static void blah_draw_gl_primitive2d(Blah_Vertex *vertices[], GLenum mode, Blah_Texture_Map *textureMap, Blah_Material *material) {
@@ -303,6 +801,386 @@ static void blah_draw_gl_primitive2d(Blah_Vertex *vertices[], GLenum mode, Blah_
 	glPopMatrix(); //restore model view matrix
 }
 
+static void blah_draw_gl_beginBatches()
+{	//Enables the vertex arrays used to draw compiled objects
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
+static void blah_draw_gl_endBatches()
+{	//Disables the vertex arrays used to draw compiled objects, restoring state for immediate drawing
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	if (blah_draw_gl_bufferSupport == BLAH_DRAW_GL_BUFFERS_SUPPORTED) {
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}
+
+static void blah_draw_gl_bindBatch(const Blah_Draw_Batch *batch)
+{	//Points the vertex arrays at the buffers of the given batch
+	const Blah_Mesh_Vertex *vertexBase;
+
+	if (batch->vertexBuffer != 0) {
+		glBindBuffer(GL_ARRAY_BUFFER, batch->vertexBuffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch->indexBuffer);
+		vertexBase = NULL; //Pointers are offsets into bound buffers
+	} else {
+		vertexBase = batch->vertexData;
+	}
+	glVertexPointer(3, GL_FLOAT, sizeof(Blah_Mesh_Vertex), (const char*)vertexBase + offsetof(Blah_Mesh_Vertex, location));
+	glNormalPointer(GL_FLOAT, sizeof(Blah_Mesh_Vertex), (const char*)vertexBase + offsetof(Blah_Mesh_Vertex, normal));
+	glTexCoordPointer(2, GL_FLOAT, sizeof(Blah_Mesh_Vertex), (const char*)vertexBase + offsetof(Blah_Mesh_Vertex, texCoord));
+}
+
+static void blah_draw_gl_drawGroup(const Blah_Draw_Batch *batch, const Blah_Mesh_Group *group)
+{	//Draws the triangles of a group of the currently bound batch
+	const GLuint *indexBase = batch->indexBuffer != 0 ? NULL : batch->indexData; //Offset into bound index buffer, if any
+	blah_draw_gl_setMaterial(group->material);
+	blah_draw_gl_setTexture(group->texture);
+	glDrawElements(GL_TRIANGLES, (GLsizei)group->indexCount, GL_UNSIGNED_INT, indexBase + group->firstIndex);
+	blah_draw_stats.drawCalls++;
+	blah_draw_stats.vertices += group->indexCount;
+}
+
+static uint64_t blah_draw_gl_sortKey(const Blah_Mesh_Group *group, float depth)
+{	//Packs the drawing order of a group at given distance from the viewpoint into a key.
+	//Opaque groups: texture (16 bits), material (16 bits), then depth front to back (24 bits).
+	//Translucent groups, with top bit set to draw after opaque: depth back to front, texture, material.
+	const uint64_t texture = group->texture ? (uint64_t)(group->texture->handle & 0xFFFF) : 0;
+	const uint64_t material = ((uintptr_t)group->material >> 4) & 0xFFFF; //Address bits are enough to group materials
+	const float range = blah_draw_currentParameters.depthOfVision;
+	const uint64_t quantisedDepth = depth <= 0 || range <= 0 ? 0 : depth >= range ? 0xFFFFFF : (uint64_t)(depth / range * 0xFFFFFF);
+
+	if (Blah_Material_isTranslucent(group->material)) {
+		return (UINT64_C(1) << 63) | ((0xFFFFFF - quantisedDepth) << 39) | (texture << 23) | (material << 7);
+	} else {
+		return (texture << 47) | (material << 31) | (quantisedDepth << 7);
+	}
+}
+
+static void blah_draw_gl_queueObject(const Blah_Draw_Batch *batch)
+{	//Adds all groups of the compiled batch to the render queue, with the current modelview matrix
+	Blah_Matrix *matrix;
+	float depth;
+
+	if (blah_draw_gl_queueMatrixCount == blah_draw_gl_queueMatrixCapacity) {
+		const size_t newCapacity = blah_draw_gl_queueMatrixCapacity ? blah_draw_gl_queueMatrixCapacity * 2 : 64;
+		Blah_Matrix *newMatrices = realloc(blah_draw_gl_queueMatrices, sizeof(Blah_Matrix) * newCapacity);
+		if (newMatrices == NULL) { blah_error_raise(errno, "Failed to grow render queue to %lu matrices", (unsigned long)newCapacity); }
+		blah_draw_gl_queueMatrices = newMatrices;
+		blah_draw_gl_queueMatrixCapacity = newCapacity;
+	}
+	if (blah_draw_gl_queueLength + batch->groupCount > blah_draw_gl_queueCapacity) {
+		size_t newCapacity = blah_draw_gl_queueCapacity ? blah_draw_gl_queueCapacity * 2 : 256;
+		while (newCapacity < blah_draw_gl_queueLength + batch->groupCount) { newCapacity *= 2; }
+		Blah_Draw_GL_Queue_Item *newItems = realloc(blah_draw_gl_queueItems, sizeof(Blah_Draw_GL_Queue_Item) * newCapacity);
+		if (newItems == NULL) { blah_error_raise(errno, "Failed to grow render queue to %lu items", (unsigned long)newCapacity); }
+		blah_draw_gl_queueItems = newItems;
+		blah_draw_gl_queueCapacity = newCapacity;
+	}
+
+	matrix = &blah_draw_gl_queueMatrices[blah_draw_gl_queueMatrixCount];
+	blah_draw_getMatrix(matrix); //Kept by blah_draw, so not read back from GL
+	depth = -((GLfloat*)matrix)[14]; //Distance of object origin along the viewing direction
+
+	for (size_t groupIndex = 0; groupIndex < batch->groupCount; groupIndex++) {
+		Blah_Draw_GL_Queue_Item *item = &blah_draw_gl_queueItems[blah_draw_gl_queueLength];
+		item->batch = batch;
+		item->group = &batch->groups[groupIndex];
+		item->sortKey = blah_draw_gl_sortKey(item->group, depth);
+		item->matrixIndex = blah_draw_gl_queueMatrixCount;
+		item->sequence = blah_draw_gl_queueLength++;
+	}
+	blah_draw_gl_queueMatrixCount++;
+}
+
+static int blah_draw_gl_compareQueueItems(const void *item1, const void *item2)
+{	//Orders render queue items by sort key, then by order of queueing.  While instancing, opaque items
+	//of the same texture and material are ordered by compiled object and group before depth, so that
+	//instances of each are next to each other.
+	const Blah_Draw_GL_Queue_Item *queueItem1 = item1, *queueItem2 = item2;
+
+#ifndef BLAH_DRAW_GL_NO_INSTANCING
+	if (blah_draw_gl_flushProgram != NULL && !(queueItem1->sortKey >> 63) && (queueItem1->sortKey >> 31) == (queueItem2->sortKey >> 31)) {
+		if (queueItem1->batch != queueItem2->batch) { return (uintptr_t)queueItem1->batch < (uintptr_t)queueItem2->batch ? -1 : 1; }
+		if (queueItem1->group != queueItem2->group) { return (uintptr_t)queueItem1->group < (uintptr_t)queueItem2->group ? -1 : 1; }
+	}
+#endif
+	if (queueItem1->sortKey != queueItem2->sortKey) { return queueItem1->sortKey < queueItem2->sortKey ? -1 : 1; }
+	return queueItem1->sequence < queueItem2->sequence ? -1 : (queueItem1->sequence > queueItem2->sequence);
+}
+
+#ifndef BLAH_DRAW_GL_NO_INSTANCING
+static bool blah_draw_gl_loadInstancingFunctions()
+{	//Looks up the shader and instanced drawing functions, returning false if any are missing
+	return BLAH_DRAW_GL_LOAD(PFNGLATTACHSHADERPROC, glAttachShader) &&
+		BLAH_DRAW_GL_LOAD(PFNGLBINDATTRIBLOCATIONPROC, glBindAttribLocation) &&
+		BLAH_DRAW_GL_LOAD(PFNGLCOMPILESHADERPROC, glCompileShader) &&
+		BLAH_DRAW_GL_LOAD(PFNGLCREATEPROGRAMPROC, glCreateProgram) &&
+		BLAH_DRAW_GL_LOAD(PFNGLCREATESHADERPROC, glCreateShader) &&
+		BLAH_DRAW_GL_LOAD(PFNGLDELETEPROGRAMPROC, glDeleteProgram) &&
+		BLAH_DRAW_GL_LOAD(PFNGLDELETESHADERPROC, glDeleteShader) &&
+		BLAH_DRAW_GL_LOAD(PFNGLDISABLEVERTEXATTRIBARRAYPROC, glDisableVertexAttribArray) &&
+		BLAH_DRAW_GL_LOAD(PFNGLDRAWELEMENTSINSTANCEDPROC, glDrawElementsInstanced) &&
+		BLAH_DRAW_GL_LOAD(PFNGLENABLEVERTEXATTRIBARRAYPROC, glEnableVertexAttribArray) &&
+		BLAH_DRAW_GL_LOAD(PFNGLGETPROGRAMIVPROC, glGetProgramiv) &&
+		BLAH_DRAW_GL_LOAD(PFNGLGETSHADERINFOLOGPROC, glGetShaderInfoLog) &&
+		BLAH_DRAW_GL_LOAD(PFNGLGETSHADERIVPROC, glGetShaderiv) &&
+		BLAH_DRAW_GL_LOAD(PFNGLGETUNIFORMLOCATIONPROC, glGetUniformLocation) &&
+		BLAH_DRAW_GL_LOAD(PFNGLLINKPROGRAMPROC, glLinkProgram) &&
+		BLAH_DRAW_GL_LOAD(PFNGLSHADERSOURCEPROC, glShaderSource) &&
+		BLAH_DRAW_GL_LOAD(PFNGLUNIFORM1IPROC, glUniform1i) &&
+		BLAH_DRAW_GL_LOAD(PFNGLUSEPROGRAMPROC, glUseProgram) &&
+		BLAH_DRAW_GL_LOAD(PFNGLVERTEXATTRIBDIVISORPROC, glVertexAttribDivisor) &&
+		BLAH_DRAW_GL_LOAD(PFNGLVERTEXATTRIBPOINTERPROC, glVertexAttribPointer);
+}
+
+static GLuint blah_draw_gl_compileShader(GLenum type, const char *source, int lightCount)
+{	//Compiles a shader from source for the given number of lights, returning its name, or 0 after
+	//logging the reason if it failed
+	char header[48];
+	const char *sources[2] = {header, source};
+	GLuint shader = glCreateShader(type);
+	GLint compiled = GL_FALSE;
+
+	snprintf(header, sizeof(header), "#version 120\n#define LIGHT_COUNT %d\n", lightCount);
+	glShaderSource(shader, 2, sources, NULL);
+	glCompileShader(shader);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+	if (compiled != GL_TRUE) {
+		char infoLog[512];
+		glGetShaderInfoLog(shader, sizeof(infoLog), NULL, infoLog);
+		Blah_Debug_Log_message(&blah_draw_gl_log, "Instancing shader failed to compile: %s\n", infoLog);
+		glDeleteShader(shader);
+		return 0;
+	}
+	return shader;
+}
+
+static bool blah_draw_gl_buildInstanceProgram(Blah_Draw_GL_Instance_Program *program, int lightCount)
+{	//Builds the shader program drawing instances lit by the given number of lights.  Returns false on failure.
+	const GLuint vertexShader = blah_draw_gl_compileShader(GL_VERTEX_SHADER, blah_draw_gl_instanceVertexShader, lightCount);
+	const GLuint fragmentShader = blah_draw_gl_compileShader(GL_FRAGMENT_SHADER, blah_draw_gl_instanceFragmentShader, lightCount);
+	GLint linked = GL_FALSE;
+
+	if (vertexShader != 0 && fragmentShader != 0) {
+		program->program = glCreateProgram();
+		glAttachShader(program->program, vertexShader);
+		glAttachShader(program->program, fragmentShader);
+		glBindAttribLocation(program->program, BLAH_DRAW_GL_INSTANCE_ATTRIBUTE, "instanceMatrix");
+		glLinkProgram(program->program);
+		glGetProgramiv(program->program, GL_LINK_STATUS, &linked);
+	}
+	if (vertexShader != 0) { glDeleteShader(vertexShader); } //Freed with the program once attached
+	if (fragmentShader != 0) { glDeleteShader(fragmentShader); }
+	if (linked != GL_TRUE) {
+		if (program->program != 0) { glDeleteProgram(program->program); }
+		program->program = 0;
+		return false;
+	}
+	program->lightingUniform = glGetUniformLocation(program->program, "lighting");
+	program->texturedUniform = glGetUniformLocation(program->program, "textured");
+	glUseProgram(program->program);
+	glUniform1i(glGetUniformLocation(program->program, "image"), 0); //Texture unit 0, as fixed function
+	glUseProgram(0);
+	return true;
+}
+
+static const Blah_Draw_GL_Instance_Program *blah_draw_gl_getInstanceProgram()
+{	//Returns the program drawing instances lit by the lights currently set up, building it the first
+	//time those lights are drawn with, or NULL if the context cannot draw instances
+	Blah_Draw_GL_Instance_Program *program;
+
+	if (blah_draw_gl_instancingSupport == BLAH_DRAW_GL_INSTANCING_UNKNOWN) {
+		blah_draw_gl_instancingSupport = blah_draw_gl_isVersion(3, 3) && blah_draw_gl_hasBufferObjects() &&
+			blah_draw_gl_loadInstancingFunctions() ? BLAH_DRAW_GL_INSTANCING_SUPPORTED : BLAH_DRAW_GL_INSTANCING_UNSUPPORTED;
+		if (blah_draw_gl_instancingSupport == BLAH_DRAW_GL_INSTANCING_SUPPORTED) { glGenBuffers(1, &blah_draw_gl_instanceBuffer); }
+	}
+	if (blah_draw_gl_instancingSupport != BLAH_DRAW_GL_INSTANCING_SUPPORTED) { return NULL; }
+
+	program = &blah_draw_gl_instancePrograms[blah_draw_gl_activeLights];
+	if (program->program == 0 && !blah_draw_gl_buildInstanceProgram(program, blah_draw_gl_activeLights)) {
+		Blah_Debug_Log_message(&blah_draw_gl_log, "Instancing shader program could not be built, drawing items singly\n");
+		blah_draw_gl_instancingSupport = BLAH_DRAW_GL_INSTANCING_UNSUPPORTED;
+		return NULL;
+	}
+	return program;
+}
+
+static void blah_draw_gl_beginInstances()
+{	//Uploads the matrices of all opaque items of the sorted queue, in drawing order, to the instance
+	//buffer, and sets up the shader program for the lighting and texturing state of the queue
+	size_t opaqueCount = 0;
+
+	while (opaqueCount < blah_draw_gl_queueLength && !(blah_draw_gl_queueItems[opaqueCount].sortKey >> 63)) { opaqueCount++; }
+	if (opaqueCount > blah_draw_gl_instanceMatrixCapacity) {
+		size_t newCapacity = blah_draw_gl_instanceMatrixCapacity ? blah_draw_gl_instanceMatrixCapacity * 2 : 64;
+		while (newCapacity < opaqueCount) { newCapacity *= 2; }
+		Blah_Matrix *newMatrices = realloc(blah_draw_gl_instanceMatrices, sizeof(Blah_Matrix) * newCapacity);
+		if (newMatrices == NULL) { blah_error_raise(errno, "Failed to grow instance buffer to %lu matrices", (unsigned long)newCapacity); }
+		blah_draw_gl_instanceMatrices = newMatrices;
+		blah_draw_gl_instanceMatrixCapacity = newCapacity;
+	}
+	for (size_t itemIndex = 0; itemIndex < opaqueCount; itemIndex++) {
+		blah_draw_gl_instanceMatrices[itemIndex] = blah_draw_gl_queueMatrices[blah_draw_gl_queueItems[itemIndex].matrixIndex];
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, blah_draw_gl_instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(Blah_Matrix) * opaqueCount, blah_draw_gl_instanceMatrices, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	for (GLuint column = 0; column < 4; column++) {
+		glEnableVertexAttribArray(BLAH_DRAW_GL_INSTANCE_ATTRIBUTE + column);
+		glVertexAttribDivisor(BLAH_DRAW_GL_INSTANCE_ATTRIBUTE + column, 1);
+	}
+
+	glUseProgram(blah_draw_gl_flushProgram->program);
+	glUniform1i(blah_draw_gl_flushProgram->lightingUniform, glIsEnabled(GL_LIGHTING));
+	glUseProgram(0);
+	blah_draw_gl_instanceTexturing = glIsEnabled(GL_TEXTURE_2D);
+}
+
+static void blah_draw_gl_endInstances()
+{	//Disables the instance matrix attributes once the queue has been drawn
+	for (GLuint column = 0; column < 4; column++) {
+		glVertexAttribDivisor(BLAH_DRAW_GL_INSTANCE_ATTRIBUTE + column, 0);
+		glDisableVertexAttribArray(BLAH_DRAW_GL_INSTANCE_ATTRIBUTE + column);
+	}
+}
+
+static size_t blah_draw_gl_countInstances(size_t firstItem)
+{	//Returns the number of opaque items of the sorted queue from firstItem on which draw the same group
+	const Blah_Draw_GL_Queue_Item *first = &blah_draw_gl_queueItems[firstItem];
+	size_t itemIndex = firstItem + 1;
+
+	while (itemIndex < blah_draw_gl_queueLength && blah_draw_gl_queueItems[itemIndex].group == first->group
+		&& blah_draw_gl_queueItems[itemIndex].batch == first->batch && !(blah_draw_gl_queueItems[itemIndex].sortKey >> 63)) {
+		itemIndex++;
+	}
+	return itemIndex - firstItem;
+}
+
+static void blah_draw_gl_drawGroupInstances(const Blah_Draw_Batch *batch, const Blah_Mesh_Group *group, size_t firstInstance, size_t instanceCount)
+{	//Draws the triangles of a group of the currently bound batch once for each of instanceCount matrices
+	//of the instance buffer, starting with firstInstance, in one draw call
+	glBindBuffer(GL_ARRAY_BUFFER, blah_draw_gl_instanceBuffer);
+	for (GLuint column = 0; column < 4; column++) {
+		glVertexAttribPointer(BLAH_DRAW_GL_INSTANCE_ATTRIBUTE + column, 4, GL_FLOAT, GL_FALSE, sizeof(Blah_Matrix),
+			(const char*)NULL + sizeof(Blah_Matrix) * firstInstance + sizeof(GLfloat) * 4 * column);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, batch->vertexBuffer);
+
+	blah_draw_gl_setMaterial(group->material);
+	blah_draw_gl_setTexture(group->texture);
+	glUseProgram(blah_draw_gl_flushProgram->program);
+	glUniform1i(blah_draw_gl_flushProgram->texturedUniform, blah_draw_gl_instanceTexturing && blah_draw_gl_currentTexture != NULL);
+	glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)group->indexCount, GL_UNSIGNED_INT,
+		(const GLuint*)NULL + group->firstIndex, (GLsizei)instanceCount);
+	glUseProgram(0);
+	blah_draw_stats.drawCalls++;
+	blah_draw_stats.vertices += group->indexCount * instanceCount;
+	blah_draw_stats.instancedItems += instanceCount;
+}
+#endif
+
+void blah_draw_gl_beginQueue()
+{	//Begins collecting compiled objects into the render queue
+	blah_draw_gl_queueActive = true;
+	blah_draw_gl_queueLength = 0;
+	blah_draw_gl_queueMatrixCount = 0;
+}
+
+void blah_draw_gl_flushQueue()
+{	//Sorts the render queue by key and draws it, changing state only between differing items
+	const Blah_Draw_Batch *boundBatch = NULL;
+	size_t currentMatrix = SIZE_MAX;
+	bool translucentPass = false;
+
+	if (!blah_draw_gl_queueActive) { return; }
+	blah_draw_gl_queueActive = false;
+	if (blah_draw_gl_queueLength == 0) { return; }
+
+#ifndef BLAH_DRAW_GL_NO_INSTANCING
+	blah_draw_gl_flushProgram = blah_draw_gl_instancing ? blah_draw_gl_getInstanceProgram() : NULL;
+#endif
+	qsort(blah_draw_gl_queueItems, blah_draw_gl_queueLength, sizeof(Blah_Draw_GL_Queue_Item), blah_draw_gl_compareQueueItems);
+
+	glPushMatrix(); //Matrices of items replace the modelview matrix
+	blah_draw_gl_beginBatches();
+#ifndef BLAH_DRAW_GL_NO_INSTANCING
+	if (blah_draw_gl_flushProgram != NULL) { blah_draw_gl_beginInstances(); }
+#endif
+	for (size_t itemIndex = 0; itemIndex < blah_draw_gl_queueLength; itemIndex++) {
+		const Blah_Draw_GL_Queue_Item *item = &blah_draw_gl_queueItems[itemIndex];
+		if (!translucentPass && (item->sortKey >> 63)) { //Translucent items are depth tested but don't hide each other
+			glDepthMask(GL_FALSE);
+			translucentPass = true;
+		}
+		if (item->batch != boundBatch) {
+			blah_draw_gl_bindBatch(item->batch);
+			boundBatch = item->batch;
+		}
+#ifndef BLAH_DRAW_GL_NO_INSTANCING
+		if (blah_draw_gl_flushProgram != NULL && !translucentPass) { //Translucent items keep their back to front order
+			const size_t instanceCount = blah_draw_gl_countInstances(itemIndex);
+			if (instanceCount > 1) {
+				blah_draw_gl_drawGroupInstances(item->batch, item->group, itemIndex, instanceCount);
+				itemIndex += instanceCount - 1;
+				continue;
+			}
+		}
+#endif
+		if (item->matrixIndex != currentMatrix) {
+			glLoadMatrixf((GLfloat*)&blah_draw_gl_queueMatrices[item->matrixIndex]);
+			currentMatrix = item->matrixIndex;
+		}
+		blah_draw_gl_drawGroup(item->batch, item->group);
+	}
+	if (translucentPass) { glDepthMask(GL_TRUE); }
+#ifndef BLAH_DRAW_GL_NO_INSTANCING
+	if (blah_draw_gl_flushProgram != NULL) {
+		blah_draw_gl_endInstances();
+		blah_draw_gl_flushProgram = NULL;
+	}
+#endif
+	blah_draw_gl_endBatches();
+	glPopMatrix();
+
+	blah_draw_stats.queuedItems += blah_draw_gl_queueLength;
+	blah_draw_gl_queueLength = 0;
+	blah_draw_gl_queueMatrixCount = 0;
+}
+
+void blah_draw_gl_object(Blah_Object *object)
+{	//Draws the given object from its compiled buffers, compiling them first if needed.
+	//While the render queue is active, the compiled groups are queued instead.
+	Blah_Draw_Batch *batch;
+
+	if (object->drawBatch == NULL || object->drawBatchDirty) { blah_draw_gl_compileObject(object); }
+	batch = object->drawBatch;
+
+	if (batch->groupCount > 0) {
+		if (blah_draw_gl_queueActive) {
+			blah_draw_gl_queueObject(batch);
+		} else {
+			blah_draw_gl_beginBatches();
+			blah_draw_gl_bindBatch(batch);
+			for (size_t groupIndex = 0; groupIndex < batch->groupCount; groupIndex++) {
+				blah_draw_gl_drawGroup(batch, &batch->groups[groupIndex]);
+			}
+			blah_draw_gl_endBatches();
+		}
+	}
+
+	if (batch->immediateCount > 0) { //Draw remaining primitives such as lines and points individually
+		for (size_t primIndex = 0; primIndex < object->primitives.length; primIndex++) {
+			Blah_Primitive *primitive = object->primitives.elements[primIndex];
+			if (!Blah_Mesh_isCompilable(primitive)) { Blah_Primitive_draw(primitive); }
+		}
+	}
+}
+
 // Print information about current GL error to standard error out
 /* void blah_draw_gl_printError()
 {
@@ -335,24 +1213,53 @@ static void blah_draw_gl_primitive2d(Blah_Vertex *vertices[], GLenum mode, Blah_
 	}
 } */
 
-void blah_draw_gl_pushMatrix()
-{	//Push OpenGL matrix and save video state
+static void blah_draw_gl_push2dMatrices()
+{	//Saves the model view and projection matrices, and loads those of the 2D drawport, as blah_draw_gl_primitive2d
 	glPushMatrix();
+	glLoadMatrixf((GLfloat*)&blah_draw_gl_drawportMatrix);
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadMatrixf((GLfloat*)&blah_draw_gl_2dProjectionMatrix);
+}
+
+static void blah_draw_gl_restoreTexture()
+{	//Binds the current texture again, after another texture was bound directly
+	glBindTexture(GL_TEXTURE_2D, blah_draw_gl_currentTexture != NULL ? (GLuint)blah_draw_gl_currentTexture->handle : 0);
 }
 
 static void blah_draw_gl_resetLights()
 {
 	int lightCount;
 
-	for (lightCount = 0; lightCount < 8; lightCount++)
+	for (lightCount = 0; lightCount < BLAH_DRAW_GL_MAX_LIGHTS; lightCount++)
 		glDisable(blah_draw_gl_lightSymbols[lightCount]);
 
 	blah_draw_gl_activeLights = 0;
 }
 
-void blah_draw_gl_resetMatrix()
-{	//Set the current matrix to the identity matrix
-	glLoadIdentity();
+void blah_draw_gl_releaseLayer(Blah_Draw_Layer *layer)
+{	//Deletes the framebuffer, texture and depth buffer of the layer
+#ifndef BLAH_DRAW_GL_NO_FBO
+	if (layer->framebufferHandle != 0) { glDeleteFramebuffers(1, (const GLuint*)&layer->framebufferHandle); }
+	if (layer->depthHandle != 0) { glDeleteRenderbuffers(1, (const GLuint*)&layer->depthHandle); }
+#endif
+	if (layer->textureHandle != 0) { glDeleteTextures(1, (const GLuint*)&layer->textureHandle); }
+	layer->framebufferHandle = layer->depthHandle = layer->textureHandle = 0;
+	layer->width = layer->height = 0;
+}
+
+void blah_draw_gl_releaseObject(Blah_Object *object)
+{	//Deletes the vertex and index buffers compiled for the given object
+	Blah_Draw_Batch *batch = object->drawBatch;
+
+	if (batch != NULL) {
+		free(batch->clientStorage);
+		if (batch->vertexBuffer) { glDeleteBuffers(1, &batch->vertexBuffer); }
+		if (batch->indexBuffer) { glDeleteBuffers(1, &batch->indexBuffer); }
+		free(batch->groups);
+		free(batch);
+		object->drawBatch = NULL;
+	}
 }
 
 void blah_draw_gl_setAmbientLight(float red, float green, float blue, float alpha)
@@ -362,6 +1269,15 @@ void blah_draw_gl_setAmbientLight(float red, float green, float blue, float alph
 	glLightModelfv(GL_LIGHT_MODEL_AMBIENT, lightParams);
 }
 
+void blah_draw_gl_setInstancing(bool enabled)
+{	//Enables or disables drawing opaque queue items sharing a compiled object as instances
+#ifndef BLAH_DRAW_GL_NO_INSTANCING
+	blah_draw_gl_instancing = enabled;
+#else
+	(void)enabled;
+#endif
+}
+
 void blah_draw_gl_setDrawport(unsigned int left, unsigned int bottom, unsigned int right, unsigned int top)
 {	//Updates the local GL specific 2D drawport matrix
 	//2D drawport matrix is identity matrix with simple translation
@@ -435,8 +1351,7 @@ void blah_draw_gl_update2dProjection(const Blah_Video_Mode* mode)
 
 void blah_draw_gl_updatePerspective()
 {	//Sets up the viewing perspective by setting up view clipping planes and normal
-	//etc in the projection matrix and applies
-	//a transform matrix to the modelview matrix to simulate a vantage point
+	//etc in the projection matrix.  The modelview matrix is loaded by blah_draw_updatePerspective.
 	float distance = Blah_Point_distancePoint(&blah_draw_currentParameters.viewpoint, &blah_draw_currentParameters.focalPoint); //get distance to focal point
 	float halfAngleX = blah_draw_currentParameters.fieldOfVisionX/2;
 	float halfAngleY = blah_draw_currentParameters.fieldOfVisionY/2;
@@ -449,12 +1364,6 @@ void blah_draw_gl_updatePerspective()
 	glLoadIdentity();
 	glOrtho(-halfWidth, halfWidth, -halfHeight, halfHeight, 0, blah_draw_currentParameters.depthOfVision);
 	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-	gluLookAt(blah_draw_currentParameters.viewpoint.x, blah_draw_currentParameters.viewpoint.y,
-		blah_draw_currentParameters.viewpoint.z, blah_draw_currentParameters.focalPoint.x,
-		blah_draw_currentParameters.focalPoint.y, blah_draw_currentParameters.focalPoint.z,
-		blah_draw_currentParameters.viewNormal.x, blah_draw_currentParameters.viewNormal.y,
-		blah_draw_currentParameters.viewNormal.z);
 }
 
 /* void blah_draw_gl_wire_cube(float side_length, Blah_Material *material) {
@@ -7,10 +7,12 @@
 
 #include "blah_point.h"
 #include "blah_colour.h"
+#include "blah_draw.h"
 #include "blah_matrix.h"
 #include "blah_list.h"
 #include "blah_texture.h"
 #include "blah_material.h"
+#include "blah_object.h"
 #include "blah_video.h"
 
 /* Function prototypes */
@@ -21,9 +23,27 @@
 	extern "C" {
 #endif //__cplusplus
 
+bool blah_draw_gl_beginLayer(Blah_Draw_Layer *layer, unsigned int width, unsigned int height);
+	//Binds the framebuffer of the layer, creating or resizing it first, and clears it.  Returns
+	//false if framebuffer objects are unsupported.
+
+void blah_draw_gl_beginQueue();
+	//Begins collecting the groups of compiled objects drawn with blah_draw_gl_object into the
+	//render queue, along with the current modelview matrix
+
+void blah_draw_gl_compositeLayer(const Blah_Draw_Layer *layer);
+	//Draws the layer texture as one quad at the current drawport, blending its premultiplied colours
+
+void blah_draw_gl_endLayer();
+	//Restores drawing to the default framebuffer, along with state changed by blah_draw_gl_beginLayer
+
 void blah_draw_gl_exit();
 	//Exit the opengl drawing engine component.  Deallocates resources
 
+void blah_draw_gl_flushQueue();
+	//Sorts the render queue by key and draws it, changing state only between differing items.
+	//Does nothing if the queue was not begun.
+
 void blah_draw_gl_image2d(Blah_Image *image, int screenX, int screenY);
 	//Draw the given image in 2D mode at the position specified by
 	//given physical screen coordinates.
@@ -38,8 +58,13 @@ void blah_draw_gl_lines(Blah_Vertex *points[], Blah_Material *material);
 
 void blah_draw_gl_lineStrip(Blah_Vertex *points[], Blah_Material *material);
 
-void blah_draw_gl_multMatrix(Blah_Matrix *matrix);
- 	//Multiply current matrix by supplied matrix
+void blah_draw_gl_loadMatrix(const Blah_Matrix *matrix);
+	//Replaces the modelview matrix with the given matrix
+
+void blah_draw_gl_object(Blah_Object *object);
+	//Draws the given object from vertex and index buffers, compiling them first if the
+	//object has none or they are out of date.  Primitives which cannot be batched, such as
+	//lines and points, are drawn individually.
 
 void blah_draw_gl_pixels2d(void *source, blah_pixel_format format, unsigned int width, unsigned int height, int screenX, int screenY);
 	//Draws a rectangle of pixels to the video in 2d mode.  Pixels are copied from
@@ -59,21 +84,25 @@ void blah_draw_gl_polygon2d(Blah_Vertex *vertices[], Blah_Texture_Map *textureMa
 	//Draw a polygon in 2d mode with vertices specified by array of points.
 	//Vertex coordinates are rendered relative to current drawport.
 
-void blah_draw_gl_popMatrix();
-	//Pop OpenGL matrix and restore previous state
+void blah_draw_gl_quads2d(const Blah_Draw_Vertex2d *vertices, size_t quadCount, const Blah_Texture *texture, Blah_Material *material);
+	//Draws quads of four vertices each in 2d mode from a single vertex array, relative to current
+	//drawport, setting up matrices, ambient light, material and texture once for all of them.
 
 void blah_draw_gl_printError();
 	//Print information about current GL error to standard error out
 
-void blah_draw_gl_pushMatrix();
-	//Push OpenGL matrix and save video state
+void blah_draw_gl_releaseLayer(Blah_Draw_Layer *layer);
+	//Deletes the framebuffer, texture and depth buffer of the layer
 
-void blah_draw_gl_resetMatrix();
-	//Set the current matrix to the identity matrix
+void blah_draw_gl_releaseObject(Blah_Object *object);
+	//Deletes the vertex and index buffers compiled for the given object
 
 void blah_draw_gl_setAmbientLight(float red, float green, float blue, float alpha);
 	//Sets the properties of the ambient light used to render current drawing
 
+void blah_draw_gl_setInstancing(bool enabled);
+	//Enables or disables drawing opaque queue items sharing a compiled object as instances
+
 void blah_draw_gl_setDrawport(unsigned int left, unsigned int bottom, unsigned int right, unsigned int top);
 	//Updates the local GL specific 2D drawport matrix
 	//2D drawport matrix is identity matrix with simple translation
@@ -105,8 +134,8 @@ void blah_draw_gl_update2dProjection(const Blah_Video_Mode* mode);
 	// at any other time.
 
 void blah_draw_gl_updatePerspective();
-	// Sets up the viewing perspective by setting up view clipping planes and
-	// applying a transform matrix to the modelview matrix to simulate a vantage point
+	// Sets up the viewing perspective by setting up view clipping planes in the projection matrix.
+	// The modelview matrix, placing the vantage point, is calculated and loaded by blah_draw.
 
 void blah_draw_gl_wireCube(float sideLength, Blah_Material *material);
 
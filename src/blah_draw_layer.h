@@ -0,0 +1,20 @@
+/* blah_draw_layer.h
+	Defines a layer, an offscreen target which 2d drawing can be redirected into and later
+	composited to the screen.  See blah_draw_beginLayer in blah_draw.h. */
+
+#ifndef _BLAH_DRAW_LAYER
+
+#define _BLAH_DRAW_LAYER
+
+#include "blah_types.h"
+
+/* Structure Definitions */
+
+typedef struct Blah_Draw_Layer { //Offscreen target holding 2d drawing
+	unsigned int width, height;		//Size of the target in pixels, 0 until first drawn into
+	unsigned int textureHandle;		//Drawing API handles of the target, 0 if not yet created
+	unsigned int depthHandle;
+	unsigned int framebufferHandle;
+} Blah_Draw_Layer;
+
+#endif
@@ -4,28 +4,46 @@
 #include <stdlib.h>
 
 #include "blah_engine.h"
+#include "blah_atlas.h"
 #include "blah_video.h"
 #include "blah_input.h"
 #include "blah_draw.h"
 #include "blah_entity.h"
+#include "blah_job.h"
+#include "blah_loader.h"
+#include "blah_profile.h"
+#include "blah_texture.h"
 #include "blah_debug.h"
 #include "blah_signal.h"
+#include "blah_time.h"
 
 /* Global variables */
 
 static Blah_Debug_Log blah_engine_log = { .filePointer = NULL };
 
+static uint64_t blah_engine_timestep = BLAH_ENGINE_DEFAULT_TIMESTEP;
+static uint64_t blah_engine_frameLimit = 0;		//Shortest frame in nanoseconds, 0 if not limited
+static uint64_t blah_engine_frameStart = 0;		//Clock when the last frame began, 0 before the first frame
+static uint64_t blah_engine_accumulated = 0;	//Time elapsed but not yet simulated
+static Blah_Engine_Frame_Stats blah_engine_frameStats;
+
 /* Function Declarations */
 
 // Deallocate everything left over from runtime
 static void blah_engine_exit()
 {
+	blah_loader_exit();	//Stop loading assets before they are garbage collected
+	Blah_Debug_Log_message(&blah_engine_log, "Call to loader exit successful");
 	blah_draw_exit();	//Shutdown drawing component
 	Blah_Debug_Log_message(&blah_engine_log, "Call to draw exit successful");
 	blah_video_exit();
 	Blah_Debug_Log_message(&blah_engine_log, "Call to video exit successful");
 	blah_input_exit();  //shutdown the input component
 	Blah_Debug_Log_message(&blah_engine_log, "Call to input exit successful");
+	blah_job_exit();	//Stop worker threads of the entity update
+	Blah_Debug_Log_message(&blah_engine_log, "Stopped job threads");
+	blah_profile_exit();	//Release profiler records, now that no other thread is recording
+	Blah_Debug_Log_message(&blah_engine_log, "Released profiler records");
 	/* Do garbage collection */
 	Blah_Debug_Log_message(&blah_engine_log, "Running garbage collection ...");
 	blah_entity_destroyAll();  //destroy all entities and free memory
@@ -35,16 +53,19 @@ static void blah_engine_exit()
 	// blah_image_destroyAll(); //destroy all remaining images
 	blah_model_destroyAll(); //destroy all models in memory
 	Blah_Debug_Log_message(&blah_engine_log, "Released all models");
+	blah_atlas_exit(); //Release shared atlas pages before their textures are collected
+	Blah_Debug_Log_message(&blah_engine_log, "Released shared atlas");
 	blah_texture_destroyAll(); //Garbage collection on textures
 	Blah_Debug_Log_message(&blah_engine_log, "Released all textures");
 	Blah_Debug_Log_message(&blah_engine_log, "End of engine exit");
-	blah_debug_log_destroyAll();	//Destroy all debugging logs
+	blah_debug_log_destroyAll();	//Write pending messages, stop the log writer thread and destroy all debugging logs
 }
 
 bool blah_engine_init()
 {
     // initialises all engine components and register blah_engine_exit() to execute on program exit via atexit()
     blah_signal_init(); // Install signal handlers
+	blah_debug_setAsync(true); // Write log messages on a background thread
 	Blah_Debug_Log_init(&blah_engine_log, "blah_engine");
 
 	Blah_Debug_Log_message(&blah_engine_log, "Call to video init");
@@ -75,11 +96,80 @@ bool blah_engine_init()
 	return true;
 }
 
+void blah_engine_getFrameStats(Blah_Engine_Frame_Stats* stats)
+{	//Copies the timings of the last frame into *stats
+	*stats = blah_engine_frameStats;
+}
+
+static unsigned int blah_engine_simulate(uint64_t elapsed)
+{	//Runs as many simulation steps as the elapsed time calls for, and sets how far between steps to draw.
+	//Returns the number of steps run.
+	unsigned int steps = 0;
+
+	if (blah_engine_timestep == 0) { //One step per frame
+		blah_entity_main();
+		blah_entity_setInterpolation(1);
+		return 1;
+	}
+
+	blah_engine_accumulated += elapsed;
+	while (blah_engine_accumulated >= blah_engine_timestep && steps < BLAH_ENGINE_MAX_STEPS) {
+		blah_entity_main(); // Call main entity processing
+		blah_engine_accumulated -= blah_engine_timestep;
+		steps++;
+	}
+	if (blah_engine_accumulated >= blah_engine_timestep) { //Too slow to keep up, so drop the time not simulated
+		blah_engine_accumulated = blah_engine_timestep - 1;
+	}
+	blah_entity_setInterpolation((float)blah_engine_accumulated / (float)blah_engine_timestep);
+	return steps;
+}
+
 void blah_engine_main()
 {	//main loop
+	const uint64_t frameStart = blah_time_getNanoseconds();
+	uint64_t elapsed, timeMark;
+
+	BLAH_PROFILE_BEGIN("blah_engine_main");
+	//The first frame runs a single step
+	elapsed = blah_engine_frameStart ? frameStart - blah_engine_frameStart : blah_engine_timestep;
+	blah_engine_frameStart = frameStart;
+	blah_engine_frameStats.frameNanoseconds = elapsed;
+
 	blah_input_main(); // Call main input processing
-	blah_entity_main(); // Call main entity processing
+
+	timeMark = blah_time_getNanoseconds();
+	blah_engine_frameStats.simulationSteps = blah_engine_simulate(elapsed);
+	blah_engine_frameStats.simulationNanoseconds = blah_time_getNanoseconds() - timeMark;
+	blah_engine_frameStats.interpolation = blah_engine_timestep ? (float)blah_engine_accumulated / (float)blah_engine_timestep : 1;
+
+	blah_loader_main(); // Complete assets decoded in the background, within the frame budget
+	blah_texture_main(); // Restore and drop texture levels to fit the texture memory budget
+
+	timeMark = blah_time_getNanoseconds();
 	blah_video_main(); // Call main drawing routine to draw to display
+	blah_engine_frameStats.renderNanoseconds = blah_time_getNanoseconds() - timeMark;
+
+	blah_engine_frameStats.sleepNanoseconds = 0;
+	if (blah_engine_frameLimit > 0) { //Sleep away the rest of the frame rather than starting the next early
+		timeMark = blah_time_getNanoseconds();
+		if (timeMark - frameStart < blah_engine_frameLimit) {
+			blah_time_sleep(blah_engine_frameLimit - (timeMark - frameStart));
+			blah_engine_frameStats.sleepNanoseconds = blah_time_getNanoseconds() - timeMark;
+		}
+	}
+	BLAH_PROFILE_END();
+}
+
+void blah_engine_setFrameRateLimit(unsigned int framesPerSecond)
+{	//Sleeps at the end of each frame so that no more than the given frames run each second
+	blah_engine_frameLimit = framesPerSecond ? 1000000000ULL / framesPerSecond : 0;
+}
+
+void blah_engine_setTimestep(uint64_t nanoseconds)
+{	//Sets the simulated time of each step, 0 for one step per frame
+	blah_engine_timestep = nanoseconds;
+	blah_engine_accumulated = 0;
 }
 
 
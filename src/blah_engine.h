@@ -1,4 +1,9 @@
-/* blah_engine.h */
+/* blah_engine.h
+	Each call of blah_engine_main is one frame.  The simulation advances in fixed steps of
+	blah_engine_setTimestep, as many as the time elapsed since the last frame calls for, so that entity
+	velocities and rates of turn are per step and simulation speed does not depend on frame rate.
+	Time left over is carried to the next frame, and entities are drawn part way between their last two
+	steps according to it.  Input, asset loading and drawing happen once per frame. */
 
 #ifndef _BLAH_ENGINE
 
@@ -8,17 +13,48 @@
 	extern "C" {
 #endif //__cplusplus
 
+#include <stdint.h>
+
 #include "blah_types.h"
 
+/* Definitions */
+
+#define BLAH_ENGINE_DEFAULT_TIMESTEP 16666667	//Nanoseconds per simulation step, 60 steps a second
+#define BLAH_ENGINE_MAX_STEPS 8	//Most simulation steps per frame, beyond which the simulation falls behind
+
+/* Structure Definitions */
+
+typedef struct Blah_Engine_Frame_Stats { //Timings of the last frame
+	uint64_t frameNanoseconds;		//Time from the start of the previous frame to the start of this one
+	uint64_t simulationNanoseconds;	//Time spent in simulation steps
+	uint64_t renderNanoseconds;		//Time spent drawing to the display
+	uint64_t sleepNanoseconds;		//Time spent sleeping to keep to the frame rate limit
+	unsigned int simulationSteps;	//Number of simulation steps run
+	float interpolation;			//Fraction of a step entities were drawn past their previous step
+} Blah_Engine_Frame_Stats;
+
+/* Function Prototypes */
+
 // void blah_engine_exit(); // No longer public, because it is called atexit()
 	//Quit the engine.
 
 bool blah_engine_init();
 	//Initialise all engine components
 
+void blah_engine_getFrameStats(Blah_Engine_Frame_Stats* stats);
+	//Copies the timings of the last frame into *stats
+
 void blah_engine_main();
 	//Main processing function.  Invokes all component routines
 
+void blah_engine_setFrameRateLimit(unsigned int framesPerSecond);
+	//Sleeps at the end of each frame so that no more than the given frames run each second,
+	//rather than spinning.  0, the default, does not limit frame rate.
+
+void blah_engine_setTimestep(uint64_t nanoseconds);
+	//Sets the simulated time of each step.  0 runs exactly one step per frame, however long the
+	//frame took, as the engine did before fixed steps.  Default is BLAH_ENGINE_DEFAULT_TIMESTEP.
+
 
 #ifdef __cplusplus
 	}
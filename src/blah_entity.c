@@ -4,6 +4,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <threads.h>
 
 #ifdef BLAH_USE_GLUT
 #include <GL/glut.h>
@@ -12,13 +13,32 @@
 #include <string.h>
 
 #include "blah_entity.h"
+#include "blah_entity_broadphase.h"
+#include "blah_entity_store.h"
+#include "blah_job.h"
 #include "blah_macros.h"
+#include "blah_profile.h"
 #include "blah_matrix.h"
+#include "blah_math.h"
 #include "blah_list.h"
 #include "blah_draw.h"
+#include "blah_transform.h"
 #include "blah_util.h"
 #include "blah_error.h"
 
+/* Structure Definitions */
+
+typedef struct Blah_Entity_Sent_Event { //Event sent by a move function running as a job, waiting for delivery
+	Blah_Entity* recipient;
+	Blah_Entity_Event* event;
+} Blah_Entity_Sent_Event;
+
+typedef struct Blah_Entity_Event_Buffer { //Events sent during one job, in order of sending
+	Blah_Entity_Sent_Event* events;
+	size_t count;
+	size_t capacity;
+} Blah_Entity_Event_Buffer;
+
 /* Static Globals - Private to entity.c */
 
 // List of those entities which were dynamically allocated, defaults to empty
@@ -27,22 +47,48 @@ Blah_List blah_entity_list = {
     .destroyElementFunction = (blah_list_element_dest_func*)Blah_Entity_destroy,
 };
 
+static unsigned int blah_entity_threads = 1;	//Threads sharing each step, 1 for processing entities one at a time
+static bool blah_entity_deterministic = false;	//If true, phased steps run every job on the calling thread
+static bool blah_entity_stepping = false;		//True during a simulation step
+static float blah_entity_interpolation = 1;		//Fraction of the way from previous to current step to draw entities at
+
+// Entities of the current phased step in list order, and the events sent by each of its jobs
+static Blah_Entity** blah_entity_stepEntities = NULL;
+static size_t blah_entity_stepCount = 0, blah_entity_stepCapacity = 0;
+static Blah_Entity_Event_Buffer* blah_entity_eventBuffers = NULL;
+static size_t blah_entity_eventBufferCount = 0;
+
+static thread_local Blah_Entity_Event_Buffer* blah_entity_jobEvents = NULL;
+	//Buffer for events sent by the job running on this thread, NULL outside of jobs
+
 /* Static Prototypes */
 
 static void Blah_Entity_animate(Blah_Entity *entity);
 	//Alters entity's location and orientation
 
+static void Blah_Entity_integrate(Blah_Entity *entity);
+	//Translates entity by its velocity and turns it by its rates of turn
+
 static void Blah_Entity_checkCollision(Blah_Entity *entity);
 	//Checks if given entity is colliding against all other entities
 
+static void Blah_Entity_checkCollisionCandidate(Blah_Entity *entity, Blah_Entity *currentEntity);
+	//Checks if given entity is colliding with one other entity
+
 static bool Blah_Entity_processEvent(Blah_Entity *entity, Blah_Entity_Event *event);
 	//Deals with pending event
 
+static void Blah_Entity_react(Blah_Entity *entity);
+	//Checks collisions of the entity and deals with its pending events
+
+static void Blah_Entity_savePrevious(Blah_Entity *entity);
+	//Remembers location and orientation of the entity before a simulation step
+
 
 /* Main Entity Functions */
 
-static void Blah_Entity_animate(Blah_Entity *entity)
-{	//Alters entity's location and orientation
+static void Blah_Entity_integrate(Blah_Entity *entity)
+{	//Translates entity by its velocity and turns it by its rates of turn
 	//translate current position by velocity vector
 	Blah_Point_translateByVector(&entity->location, &entity->velocity);
 
@@ -50,9 +96,121 @@ static void Blah_Entity_animate(Blah_Entity *entity)
 	Blah_Entity_rotateEuler(entity, entity->rotationAxisX, entity->rotationAxisY, entity->rotationAxisZ);
 }
 
+static void Blah_Entity_animate(Blah_Entity *entity)
+{	//Alters entity's location and orientation
+	Blah_Entity_integrate(entity);
+
+	//Move entity's bounding volume in the collision broad-phase
+	blah_entity_broadphase_updateEntity(entity);
+}
+
+static void Blah_Entity_savePrevious(Blah_Entity *entity)
+{	//Remembers location and orientation of the entity before a simulation step
+	entity->previousLocation = entity->location;
+	entity->previousOrientation = entity->orientation;
+}
+
+static void Blah_Entity_Event_Buffer_push(Blah_Entity_Event_Buffer *buffer, Blah_Entity *recipient, Blah_Entity_Event *event)
+{	//Appends an event to the buffer, growing it if full
+	if (buffer->count == buffer->capacity) {
+		const size_t newCapacity = buffer->capacity ? buffer->capacity * 2 : 16;
+		Blah_Entity_Sent_Event* newEvents = realloc(buffer->events, newCapacity * sizeof(Blah_Entity_Sent_Event));
+		if (newEvents == NULL) { blah_error_raise(errno, "Failed to grow entity event buffer"); }
+		buffer->events = newEvents;
+		buffer->capacity = newCapacity;
+	}
+	buffer->events[buffer->count].recipient = recipient;
+	buffer->events[buffer->count++].event = event;
+}
+
+static void blah_entity_gatherStep()
+{	//Copies the entity list into the array of entities for a phased step, and makes sure there is
+	//an event buffer for each of its jobs
+	const size_t entityCount = (size_t)blah_entity_list.length;
+	const size_t jobCount = (entityCount + BLAH_ENTITY_JOB_SIZE - 1) / BLAH_ENTITY_JOB_SIZE;
+	size_t index = 0;
+
+	if (entityCount > blah_entity_stepCapacity) {
+		Blah_Entity** newEntities = realloc(blah_entity_stepEntities, entityCount * sizeof(Blah_Entity*));
+		if (newEntities == NULL) { blah_error_raise(errno, "Failed to grow entity step array"); }
+		blah_entity_stepEntities = newEntities;
+		blah_entity_stepCapacity = entityCount;
+	}
+	for (Blah_List_Element* element = blah_entity_list.first; element; element = element->next) {
+		blah_entity_stepEntities[index++] = (Blah_Entity*)element->data;
+	}
+	blah_entity_stepCount = index;
+
+	if (jobCount > blah_entity_eventBufferCount) {
+		Blah_Entity_Event_Buffer* newBuffers = realloc(blah_entity_eventBuffers, jobCount * sizeof(Blah_Entity_Event_Buffer));
+		if (newBuffers == NULL) { blah_error_raise(errno, "Failed to grow entity event buffers"); }
+		memset(newBuffers + blah_entity_eventBufferCount, 0, (jobCount - blah_entity_eventBufferCount) * sizeof(Blah_Entity_Event_Buffer));
+		blah_entity_eventBuffers = newBuffers;
+		blah_entity_eventBufferCount = jobCount;
+	}
+}
+
+static void blah_entity_moveJob(size_t jobIndex, void *data)
+{	//Calls the move functions of one job's range of entities and animates those not batched
+	const size_t first = jobIndex * BLAH_ENTITY_JOB_SIZE;
+	const size_t last = first + BLAH_ENTITY_JOB_SIZE < blah_entity_stepCount ? first + BLAH_ENTITY_JOB_SIZE : blah_entity_stepCount;
+	(void)data;
+
+	BLAH_PROFILE_BEGIN("blah_entity_moveJob");
+	blah_entity_jobEvents = &blah_entity_eventBuffers[jobIndex];
+	for (size_t index = first; index < last; index++) {
+		Blah_Entity* entity = blah_entity_stepEntities[index];
+		Blah_Entity_savePrevious(entity);
+		if (entity->moveFunction != NULL) { entity->moveFunction(entity); }
+		if (entity->storeIndex < 0) { Blah_Entity_integrate(entity); } //Batched entities are integrated together afterwards
+	}
+	blah_entity_jobEvents = NULL;
+	BLAH_PROFILE_END();
+}
+
+static void blah_entity_processPhases()
+{	//Runs a simulation step in phases: moves as jobs, then bounding volumes, then collisions and events
+	size_t jobCount;
+
+	blah_entity_gatherStep();
+	jobCount = (blah_entity_stepCount + BLAH_ENTITY_JOB_SIZE - 1) / BLAH_ENTITY_JOB_SIZE;
+
+	blah_entity_broadphase_deferUpdates(true); //Grid and sweep list are shared, so update them afterwards
+	if (blah_entity_deterministic) {
+		for (size_t jobIndex = 0; jobIndex < jobCount; jobIndex++) { blah_entity_moveJob(jobIndex, NULL); }
+	} else {
+		blah_job_run(blah_entity_moveJob, jobCount, NULL);
+	}
+	blah_entity_broadphase_deferUpdates(false);
+
+	if (blah_entity_store_getCount() > 0) { blah_entity_store_integrate(); } //Also updates bounding volumes
+	for (size_t index = 0; index < blah_entity_stepCount; index++) {
+		if (blah_entity_stepEntities[index]->storeIndex < 0) { blah_entity_broadphase_updateEntity(blah_entity_stepEntities[index]); }
+	}
+
+	//Deliver events in job order, which is the order they would have been sent on a single thread
+	for (size_t jobIndex = 0; jobIndex < jobCount; jobIndex++) {
+		Blah_Entity_Event_Buffer* buffer = &blah_entity_eventBuffers[jobIndex];
+		for (size_t index = 0; index < buffer->count; index++) {
+			Blah_List_appendElement(&buffer->events[index].recipient->events, buffer->events[index].event);
+		}
+		buffer->count = 0;
+	}
+
+	Blah_List_callFunction(&blah_entity_list, (blah_list_element_func*)Blah_Entity_react);
+}
+
 void blah_entity_destroyAll()
 {  	//Cleanup routine to do garbage collection for dynamically allocated entities apon exit
 	Blah_List_destroyElements(&blah_entity_list);
+	blah_entity_store_destroyAll();
+	blah_transform_destroyAll();
+	for (size_t index = 0; index < blah_entity_eventBufferCount; index++) { free(blah_entity_eventBuffers[index].events); }
+	free(blah_entity_eventBuffers);
+	free(blah_entity_stepEntities);
+	blah_entity_eventBuffers = NULL;
+	blah_entity_stepEntities = NULL;
+	blah_entity_eventBufferCount = blah_entity_stepCount = blah_entity_stepCapacity = 0;
 }
 
 void blah_entity_main()
@@ -61,8 +219,34 @@ void blah_entity_main()
 }
 
 void blah_entity_processAll()
-{
-	Blah_List_callFunction(&blah_entity_list, (blah_list_element_func*)Blah_Entity_process);
+{	//Runs one simulation step of all entities, one at a time or in phases
+	BLAH_PROFILE_BEGIN("blah_entity_processAll");
+	blah_entity_stepping = true;
+	if (blah_entity_threads > 1 || blah_entity_deterministic) {
+		blah_entity_processPhases();
+	} else { //Move and animate all batched entities together, then process every entity in the list
+		Blah_List_callFunction(&blah_entity_list, (blah_list_element_func*)Blah_Entity_savePrevious);
+		if (blah_entity_store_getCount() > 0) { blah_entity_store_process(); }
+		Blah_List_callFunction(&blah_entity_list, (blah_list_element_func*)Blah_Entity_process);
+	}
+	blah_entity_stepping = false;
+	BLAH_PROFILE_END();
+}
+
+void blah_entity_setDeterministic(bool flag)
+{	//If flag is true, phased steps run every job on the calling thread in entity list order
+	blah_entity_deterministic = flag;
+}
+
+void blah_entity_setInterpolation(float fraction)
+{	//Sets how far drawing is between the previous and current simulation step
+	blah_entity_interpolation = fraction < 0 ? 0 : (fraction > 1 ? 1 : fraction);
+}
+
+bool blah_entity_setThreads(unsigned int threadCount)
+{	//Sets the number of threads the move functions and animation of entities are spread across
+	blah_entity_threads = threadCount > 0 ? threadCount : 1;
+	return blah_job_init(blah_entity_threads);
 }
 
 /* Entity Function Definitions */
@@ -72,26 +256,50 @@ Blah_Entity_Object *Blah_Entity_addObject(Blah_Entity *entity, Blah_Object *obje
 	Blah_Entity_Object *newEntObj = Blah_Entity_Object_new("an object",object);
 	newEntObj->entity = entity;
 	Blah_List_appendElement(&entity->objects, newEntObj);
+	blah_entity_broadphase_updateEntity(entity); //Bounding volume may have grown
+	return newEntObj;
+}
+
+Blah_Entity_Object *Blah_Entity_addSharedObject(Blah_Entity *entity, Blah_Object *object)
+{	// Adds an object, owned elsewhere, to an entity's list of composing objects
+	Blah_Entity_Object *newEntObj = Blah_Entity_Object_newShared("a shared object", object);
+	newEntObj->entity = entity;
+	Blah_List_appendElement(&entity->objects, newEntObj);
+	blah_entity_broadphase_updateEntity(entity); //Bounding volume may have grown
 	return newEntObj;
 }
 
+static void Blah_Entity_checkCollisionCandidate(Blah_Entity *entity, Blah_Entity *currentEntity)
+{	// Tests given entity against one other entity, calling the other's collision handling function on collision
+	blah_entity_collision_func* colFunc = currentEntity->collisionFunction;
+	Blah_Point impact;
+	if (colFunc != NULL && currentEntity->activeCollision && Blah_Entity_checkCollisionEntity(entity, currentEntity, &impact)) {
+		colFunc(currentEntity, entity); // call collision handler for recipient object
+	}
+}
+
 static void Blah_Entity_checkCollision(Blah_Entity *entity)
 {	// Checks if given entity is colliding against all other entities.
-    // If a collision is detected with another entity, call the collision handling function
-	Blah_List_Element* currentElement = blah_entity_list.first;
-
-	while (currentElement) {
-        Blah_Entity* currentEntity = (Blah_Entity*)currentElement->data;
-        if (currentEntity != entity) { // Don't check collision with itself!
-            blah_entity_collision_func* colFunc = currentEntity->collisionFunction;
-            Blah_Point impact;
-            if (colFunc != NULL && currentEntity->activeCollision && Blah_Entity_checkCollisionEntity(entity, currentEntity, &impact)) {
-                colFunc(currentEntity, entity); // call collision handler for recipient object
-            }
-        }
-		currentElement = currentElement->next;
+    // If a collision is detected with another entity, call the collision handling function.
+    // Unless the broad-phase is switched off, only those entities it finds near the given entity
+    // are tested, in entity list order.
+	BLAH_PROFILE_BEGIN("Blah_Entity_checkCollision");
+	if (blah_entity_broadphase_getType() == BLAH_ENTITY_BROADPHASE_NONE) {
+		Blah_List_Element* currentElement = blah_entity_list.first;
+		while (currentElement) {
+			Blah_Entity* currentEntity = (Blah_Entity*)currentElement->data;
+			currentElement = currentElement->next;
+			if (currentEntity != entity) { Blah_Entity_checkCollisionCandidate(entity, currentEntity); } // Don't check collision with itself!
+		}
+	} else {
+		size_t candidateCount;
+		Blah_Entity** candidates = blah_entity_broadphase_queryEntity(entity, &candidateCount);
+		for (size_t index = 0; index < candidateCount; index++) {
+			// Skip entities destroyed by an earlier collision handler
+			if (candidates[index] != NULL) { Blah_Entity_checkCollisionCandidate(entity, candidates[index]); }
+		}
 	}
-
+	BLAH_PROFILE_END();
 }
 
 bool Blah_Entity_checkCollisionEntity(Blah_Entity *entity1, Blah_Entity *entity2, Blah_Point *impact)
@@ -124,7 +332,12 @@ bool Blah_Entity_checkCollisionEntity(Blah_Entity *entity1, Blah_Entity *entity2
 void Blah_Entity_destroy(Blah_Entity *entity)
 {
 	// TODO - Only remove enity from the list if it was dynamically allocated
-	Blah_List_removeElement(&blah_entity_list, entity);  // Remove from list of entities
+	if (entity->listElement) { // Remove from list of entities
+		Blah_List_removeElementHandle(&blah_entity_list, entity->listElement);
+		entity->listElement = NULL;
+	}
+	blah_entity_broadphase_removeEntity(entity); // and from collision broad-phase
+	blah_entity_store_removeEntity(entity); // and from batched entity store
 
 	if (entity->destroyFunction) { // call custom destroy function if there is one defined
 		entity->destroyFunction(entity);
@@ -136,6 +349,9 @@ void Blah_Entity_destroy(Blah_Entity *entity)
 
 void Blah_Entity_disable(Blah_Entity *entity)
 {	//Disables entity.  Nullifies its existence.  Removes all objects and events associated with it.
+	blah_entity_store_removeEntity(entity);
+	blah_transform_remove(entity->transformIndex); //Entities placed relative to it return to world coordinates
+	entity->transformIndex = BLAH_TRANSFORM_NONE;
 	Blah_List_destroyElements(&entity->objects);  //Destroy all objects composing entity
 	Blah_List_destroyElements(&entity->events);  //Destroy any events in the queue for the entity
 	if (entity->entityData) {//if there is an allocated memory block for entity data
@@ -148,13 +364,46 @@ float Blah_Entity_distanceEntity(Blah_Entity *entity1, Blah_Entity *entity2)
 	return Blah_Point_distancePoint(&entity1->location, &entity2->location);
 }
 
+static void Blah_Entity_ensureTransform(Blah_Entity *entity)
+{	//Gives the entity a root node in the transform hierarchy, if it has none
+	if (entity->transformIndex == BLAH_TRANSFORM_NONE) { entity->transformIndex = blah_transform_add(BLAH_TRANSFORM_NONE); }
+}
+
+static void Blah_Entity_updateObjectTransform(Blah_Entity_Object *entityObject, Blah_Entity *entity)
+{	//Sets the local matrix of the entity object's node, giving it one as a child of the entity's node if it has none
+	if (entityObject->transformIndex == BLAH_TRANSFORM_NONE) {
+		entityObject->transformIndex = blah_transform_add(entity->transformIndex);
+	}
+	blah_transform_setLocal(entityObject->transformIndex, &entityObject->objectMatrix);
+}
+
+static void Blah_Entity_drawObjectAtWorld(Blah_Entity_Object *entityObject, Blah_Entity *entity)
+{	//Draws entity object using its world matrix from the transform hierarchy.  Objects added since the
+	//entity was last updated have no node yet, so are placed by the entity's world matrix instead.
+	if (entityObject->transformIndex != BLAH_TRANSFORM_NONE) {
+		Blah_Entity_Object_drawAt(entityObject, blah_transform_getWorld(entityObject->transformIndex));
+	} else {
+		Blah_Matrix matrix;
+		blah_math_multiplyMatrices(&matrix, blah_transform_getWorld(entity->transformIndex), &entityObject->objectMatrix);
+		Blah_Entity_Object_drawAt(entityObject, &matrix);
+	}
+}
+
 void Blah_Entity_draw(Blah_Entity *entity)
 {
 	if (entity->drawFunction) {
 		entity->drawFunction(entity); // Call custom draw function if it exists for entity
+	} else if (entity->transformIndex != BLAH_TRANSFORM_NONE) { //World matrices already calculated by the hierarchy
+		Blah_List_callWithArg(&entity->objects, (blah_list_element_func_1arg*)Blah_Entity_drawObjectAtWorld, entity);
 	} else {
 		blah_draw_pushMatrix();
-		blah_draw_multMatrix(&entity->fakeMatrix);
+		if (blah_entity_interpolation < 1) { //Drawn between simulation steps
+			Blah_Matrix matrix;
+			Blah_Entity_getInterpolatedMatrix(entity, &matrix);
+			blah_draw_multMatrix(&matrix);
+		} else {
+			blah_draw_multMatrix(&entity->fakeMatrix);
+		}
 		Blah_List_callFunction(&entity->objects, (blah_list_element_func*)Blah_Entity_Object_draw); //call Object_draw for all entity objects
 		blah_draw_popMatrix();
 	}
@@ -165,6 +414,24 @@ void *Blah_Entity_getData(Blah_Entity *entity)
 	return entity->entityData;
 }
 
+void Blah_Entity_getInterpolatedMatrix(const Blah_Entity *entity, Blah_Matrix *matrix)
+{	//Stores in *matrix the entity's transform part way between its previous and current simulation step
+	const float fraction = blah_entity_interpolation;
+	const Blah_Quaternion* previous = &entity->previousOrientation;
+	const Blah_Quaternion* current = &entity->orientation;
+
+	*matrix = entity->fakeMatrix;
+	if (previous->x != current->x || previous->y != current->y || previous->z != current->z || previous->w != current->w) {
+		Blah_Quaternion orientation;
+		Blah_Quaternion_interpolate(&orientation, previous, current, fraction);
+		Blah_Matrix_setRotationQuat(matrix, &orientation);
+	}
+	Blah_Point_set(&matrix->location,
+		entity->previousLocation.x + (entity->location.x - entity->previousLocation.x) * fraction,
+		entity->previousLocation.y + (entity->location.y - entity->previousLocation.y) * fraction,
+		entity->previousLocation.z + (entity->location.z - entity->previousLocation.z) * fraction);
+}
+
 // Gets entity's location in 3D space in 3 coordinates
 void Blah_Entity_getLocation(Blah_Entity *entity,Blah_Point *p)
 {
@@ -192,6 +459,10 @@ void Blah_Entity_init(Blah_Entity *newEntity, char *name, int type, size_t dataS
 	Blah_List_init(&newEntity->events,"Events");
 	newEntity->objects.destroyElementFunction = (blah_list_element_dest_func*)Blah_Entity_Object_destroy;
 	newEntity->activeCollision = false;
+	newEntity->broadphaseProxy = NULL; //Not in collision broad-phase until added to entity list
+	newEntity->storeIndex = -1; //Animated individually unless batching is requested
+	newEntity->listElement = NULL; //Not in entity list until added by Blah_Entity_new
+	newEntity->transformIndex = BLAH_TRANSFORM_NONE; //Given a node when first updated
 
 	Blah_Entity_setLocation(newEntity,0,0,0); //set location to origin
 	Blah_Entity_setVelocity(newEntity,0,0,0); //going nowhere
@@ -205,6 +476,7 @@ void Blah_Entity_init(Blah_Entity *newEntity, char *name, int type, size_t dataS
 	newEntity->destroyFunction = NULL;
 	newEntity->rotationAxisX = newEntity->rotationAxisY = newEntity->rotationAxisZ = 0;
 	Blah_Quaternion_setIdentity(&newEntity->orientation);
+	Blah_Entity_savePrevious(newEntity);
 }
 
 Blah_Entity *Blah_Entity_new(char* name, int type, size_t dataSize)
@@ -213,7 +485,8 @@ Blah_Entity *Blah_Entity_new(char* name, int type, size_t dataSize)
 
 	if (newEntity) {
 		Blah_Entity_init(newEntity, name, type, dataSize);
-		Blah_List_appendElement(&blah_entity_list, newEntity); // Add to list of entities
+		newEntity->listElement = Blah_List_appendElement(&blah_entity_list, newEntity); // Add to list of entities
+		blah_entity_broadphase_insertEntity(newEntity); // and to collision broad-phase
 	} else {
 		blah_error_raise(errno, "Failed to allocate memory for entity '%x'", name);
 	}
@@ -222,12 +495,18 @@ Blah_Entity *Blah_Entity_new(char* name, int type, size_t dataSize)
 
 void Blah_Entity_process(Blah_Entity *entity)
 {	//process entity, update position etc
+	if (entity->storeIndex < 0) { // Batched entities have already been moved and animated by the entity store
+		if (entity->moveFunction != NULL) { entity->moveFunction(entity); } // If a movement control function is defined, call it
+		Blah_Entity_animate(entity);	// Animate the entity
+	}
+	Blah_Entity_react(entity);
+}
+
+static void Blah_Entity_react(Blah_Entity *entity)
+{	//Checks collisions of the entity and deals with its pending events
 	Blah_Entity_Event *temp_event;
 	bool cont = true;
 
-
-	if (entity->moveFunction != NULL) { entity->moveFunction(entity); } // If a movement control function is defined, call it
-	Blah_Entity_animate(entity);	// Animate the entity
 	if (entity->activeCollision) { Blah_Entity_checkCollision(entity); } //If entity is actively colliding, check collisions
     temp_event = (Blah_Entity_Event*)Blah_List_popElement(&entity->events);
 	while (temp_event && cont) {//Take care of all pending events
@@ -246,6 +525,8 @@ void Blah_Entity_rotateEuler(Blah_Entity *entity, float x, float y, float z)
 	Blah_Quaternion_multiplyQuaternion(&entity->orientation, &tempQuat);
 	//Recalculate orientation vectors in entity matrix
 	Blah_Matrix_setRotationQuat(&entity->fakeMatrix, &entity->orientation);
+	blah_entity_store_syncEntity(entity);
+	if (!blah_entity_stepping) { entity->previousOrientation = entity->orientation; } //Turned between steps, so draw without interpolating
 }
 
 void Blah_Entity_setActiveCollision(Blah_Entity *entity,bool flag)
@@ -256,18 +537,38 @@ void Blah_Entity_setActiveCollision(Blah_Entity *entity,bool flag)
 
 void Blah_Entity_setLocation(Blah_Entity *entity, float x, float y, float z)
 {
-	//Sets entity's location in 3D space given 3 coordinates
+	//Sets entity's location in 3D space given 3 coordinates.  Between steps, the entity is placed without interpolating.
 	Blah_Point_set(&entity->location, x, y, z);
+	if (!blah_entity_stepping) { entity->previousLocation = entity->location; }
+	blah_entity_store_syncEntity(entity);
+	blah_entity_broadphase_updateEntity(entity);
+}
+
+void Blah_Entity_setBatched(Blah_Entity *entity, bool flag)
+{	//Adds entity to, or removes it from, the batched entity store
+	if (flag) {
+		blah_entity_store_addEntity(entity);
+	} else {
+		blah_entity_store_removeEntity(entity);
+	}
 }
 
 void Blah_Entity_setRotationAxisX(Blah_Entity *entity, float x)
 {
 	entity->rotationAxisX = x;
+	blah_entity_store_syncEntity(entity);
 }
 
 void Blah_Entity_setRotationAxisY(Blah_Entity *entity, float y)
 {
 	entity->rotationAxisY = y;
+	blah_entity_store_syncEntity(entity);
+}
+
+void Blah_Entity_setRotationAxisZ(Blah_Entity *entity, float z)
+{
+	entity->rotationAxisZ = z;
+	blah_entity_store_syncEntity(entity);
 }
 
 void Blah_Entity_setType(Blah_Entity *entity, int type)
@@ -300,9 +601,31 @@ void Blah_Entity_setMoveFunction(Blah_Entity* entity, blah_entity_move_func* fun
 	//entity->moveFunctionData = externData;
 }
 
+bool Blah_Entity_setParent(Blah_Entity* entity, Blah_Entity* parent)
+{	//Places the entity relative to parent in the transform hierarchy, or in world coordinates if parent is NULL
+	Blah_Entity_ensureTransform(entity);
+	if (parent == NULL) { return blah_transform_setParent(entity->transformIndex, BLAH_TRANSFORM_NONE); }
+	Blah_Entity_ensureTransform(parent);
+	return blah_transform_setParent(entity->transformIndex, parent->transformIndex);
+}
+
 void Blah_Entity_setVelocity(Blah_Entity *entity, float x, float y, float z)
 {
 	Blah_Vector_set(&entity->velocity, x, y, z);
+	blah_entity_store_syncEntity(entity);
+}
+
+void Blah_Entity_updateTransform(Blah_Entity *entity)
+{	//Sets the local matrices of the entity and its objects in the transform hierarchy
+	Blah_Entity_ensureTransform(entity);
+	if (blah_entity_interpolation < 1) { //Drawn between simulation steps
+		Blah_Matrix matrix;
+		Blah_Entity_getInterpolatedMatrix(entity, &matrix);
+		blah_transform_setLocal(entity->transformIndex, &matrix);
+	} else {
+		blah_transform_setLocal(entity->transformIndex, &entity->fakeMatrix);
+	}
+	Blah_List_callWithArg(&entity->objects, (blah_list_element_func_1arg*)Blah_Entity_updateObjectTransform, entity);
 }
 
 /* Entity Event Functions */
@@ -348,5 +671,9 @@ static bool Blah_Entity_processEvent(Blah_Entity *entity,  Blah_Entity_Event *ev
 }
 
 void Blah_Entity_sendEvent(Blah_Entity *recipient, Blah_Entity_Event *event) {
-	Blah_List_appendElement(&recipient->events, event); //Add the new event to the entity's list
+	if (blah_entity_jobEvents != NULL) { //Sent from a job, so hold it until all jobs are done
+		Blah_Entity_Event_Buffer_push(blah_entity_jobEvents, recipient, event);
+	} else {
+		Blah_List_appendElement(&recipient->events, event); //Add the new event to the entity's list
+	}
 }
@@ -3,6 +3,17 @@
  	rendered to the screen when the scene is visible.
  	Regardless of whether they exist in a scene or not, all entities which are active will be processed for general behaviour
  	and collisions/interactions.
+ 	Each call of blah_entity_processAll is one simulation step.  Entities remember their location and orientation
+ 	from before the step, so that they can be drawn part way between steps, see blah_entity_setInterpolation.
+ 	By default entities are processed one at a time on the calling thread, each being moved and animated before its
+ 	collisions and events are dealt with.  With blah_entity_setThreads, a step runs in phases instead.  First the move
+ 	functions and animation of all entities are run as jobs spread across the job pool (see blah_job.h), then bounding
+ 	volumes are updated, and finally collisions and events of each entity are processed in list order on the calling
+ 	thread.  While running as jobs, move functions must only change their own entity, through its fields or the
+ 	Blah_Entity set functions, and must not create or destroy entities, or add objects to them.  Events they send are
+ 	held per job and delivered in entity list order once all jobs are done, so delivery does not depend on timing.
+ 	Move functions which read other entities may see them before or after their own move, so deterministic mode runs
+ 	the same phases with every job on the calling thread, in list order.
  */
 
 #ifndef _BLAH_ENTITY
@@ -24,11 +35,13 @@
 #define BLAH_ENTITY_NAME_LENGTH 20 //Does not include terminating NULL character
 #define BLAH_ENTITY_EVENT_NAME_LENGTH 10 //Does not include terminating NULL character
 #define BLAH_ENTITY_TYPE_LENGTH 10 //Does not include terminating NULL character
+#define BLAH_ENTITY_JOB_SIZE 64 //Number of entities moved and animated by each job of a phased step
 
 /* Forward Declarations */
 
 struct Blah_Entity;
 struct Blah_Entity_Event;
+struct Blah_Entity_Broadphase_Proxy;
 
 /* Function Type Declarations */
 
@@ -87,6 +100,12 @@ typedef struct Blah_Entity {
 	void *entityData;			//Entity specific information
 	Blah_List events;				//List of pending events waiting to be processed
 	bool activeCollision;
+	struct Blah_Entity_Broadphase_Proxy* broadphaseProxy;	//Bounding volume used for collision culling, NULL if not in entity list
+	long storeIndex;				//Slot in the batched entity store, or -1 if entity is animated individually
+	Blah_List_Element* listElement;	//Element of the entity list holding this entity, NULL if not in list
+	Blah_Point previousLocation;	//Location before the last simulation step, for drawing between steps
+	Blah_Quaternion previousOrientation;	//Orientation before the last simulation step
+	long transformIndex;			//Node in the transform hierarchy, or BLAH_TRANSFORM_NONE until first updated
 } Blah_Entity;
 
 typedef struct Blah_Entity_Event {
@@ -108,6 +127,11 @@ Blah_Entity_Object *Blah_Entity_addObject(Blah_Entity *entity, Blah_Object *obje
 	//object structure and adds to the entity's collection of objects, returning
 	//a pointer to the newly created entity_object structure
 
+Blah_Entity_Object *Blah_Entity_addSharedObject(Blah_Entity *entity, Blah_Object *object);
+	//Adds the given object to the specified entity as Blah_Entity_addObject does, but without taking
+	//ownership of it, so the same object can be added to many entities and drawn as instances.
+	//The object is not destroyed with the entity, and must outlive it.
+
 bool Blah_Entity_checkCollisionEntity(Blah_Entity *entity1, Blah_Entity *entity2, Blah_Point *impact);
 	//Returns true if entity_1 is colliding with entity_2
 
@@ -128,6 +152,10 @@ void Blah_Entity_draw(Blah_Entity *entity);
 
 void *Blah_Entity_getData(Blah_Entity *entity);
 
+void Blah_Entity_getInterpolatedMatrix(const Blah_Entity *entity, Blah_Matrix *matrix);
+	//Stores in *matrix the entity's transform part way between its previous and current simulation step,
+	//as set by blah_entity_setInterpolation.  Used by Blah_Entity_draw, and by custom draw functions.
+
 void Blah_Entity_getLocation(Blah_Entity *entity, Blah_Point *p);
 	//Gets entity's location in 3D space in 3 coordinates
 
@@ -158,10 +186,19 @@ void Blah_Entity_setRotationAxisX(Blah_Entity* entity, float x);
 
 void Blah_Entity_setRotationAxisY(Blah_Entity* entity, float y);
 
+void Blah_Entity_setRotationAxisZ(Blah_Entity* entity, float z);
+
 void Blah_Entity_setVelocity(Blah_Entity *entity, float x, float y, float z);
 
 void Blah_Entity_setDrawFunction(Blah_Entity* entity, blah_entity_draw_func* function); //, void *externData);
 
+bool Blah_Entity_setParent(Blah_Entity* entity, Blah_Entity* parent);
+	//Places the entity relative to parent in the transform hierarchy, so that its location and orientation
+	//are taken as relative to the parent's, or back in world coordinates if parent is NULL.  Collisions
+	//still use the entity's own location.  A parent is placed by the last Blah_Entity_updateTransform
+	//on it, so it should be in a drawn scene too.  Returns false, changing nothing, if parent is the
+	//entity or is placed relative to it.
+
 void Blah_Entity_setMoveFunction(Blah_Entity* entity, blah_entity_move_func* function); //, void *externData);
 
 void Blah_Entity_setDestroyFunction(Blah_Entity* entity, blah_entity_destroy_func* function); //, void *externData);
@@ -170,8 +207,30 @@ void Blah_Entity_setCollisionFunction(Blah_Entity* entity, blah_entity_collision
 
 void Blah_Entity_setActiveCollision(Blah_Entity* entity, bool flag);
 
+void blah_entity_setDeterministic(bool flag);
+	//If flag is true, simulation steps run in phases as with several threads, but with every job on
+	//the calling thread in entity list order, so results never depend on timing.  Default is false.
+
+void blah_entity_setInterpolation(float fraction);
+	//Sets how far, from 0 to 1, drawing is between the previous and current simulation step.  Set by
+	//blah_engine_main each frame according to the time left over after its fixed steps.  Default is 1.
+
+bool blah_entity_setThreads(unsigned int threadCount);
+	//Sets the number of threads, including the calling thread, that the move functions and animation
+	//of entities are spread across.  With more than 1, steps run in phases as described above.
+	//Default is 1, processing entities one at a time.  Returns false if no worker thread could be started.
+
+void Blah_Entity_setBatched(Blah_Entity* entity, bool flag);
+	//If flag is true, the entity's transform is kept in the entity store and animated in one batched
+	//pass with all other batched entities.  See blah_entity_store.h.  If false, entity is animated individually.
+
 void Blah_Entity_setType(Blah_Entity *entity, int type);
 
+void Blah_Entity_updateTransform(Blah_Entity *entity);
+	//Sets the local matrices of the entity and its objects in the transform hierarchy, giving them nodes
+	//if they have none, for their world matrices to be recalculated by blah_transform_update.
+	//Called by Blah_Scene_draw for each entity of the scene.
+
 
 /* Event Function Prototypes */
 
@@ -186,7 +245,8 @@ Blah_Entity_Event* Blah_Entity_Event_new(const char *name, const Blah_Entity* se
 	// Creates a new event structure
 
 void Blah_Entity_sendEvent(Blah_Entity* recipient, Blah_Entity_Event* event);
-	// Sends an event to an entity
+	// Sends an event to an entity.  Events sent by move functions running as jobs are held until
+	// all jobs of the step are done.
 
 
 #ifdef __cplusplus
@@ -0,0 +1,446 @@
+/* blah_entity_broadphase.c
+	Defines the broad-phase collision culling used for entities.  See blah_entity_broadphase.h for reference.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "blah_entity_broadphase.h"
+#include "blah_entity.h"
+#include "blah_entity_object.h"
+#include "blah_object.h"
+#include "blah_vector.h"
+#include "blah_list.h"
+#include "blah_error.h"
+
+/* Definitions */
+
+#define BLAH_ENTITY_BROADPHASE_CELL_LIMIT 1.0e9f //Largest magnitude of grid cell coordinate, keeps conversion to int safe
+
+/* Structure Definitions */
+
+typedef struct Blah_Entity_Broadphase_Bucket { //Growable array of proxies stored in one hash bucket
+	Blah_Entity_Broadphase_Proxy** proxies;
+	size_t count;
+	size_t capacity;
+} Blah_Entity_Broadphase_Bucket;
+
+/* Static Globals - Private to entity_broadphase.c */
+
+static blah_entity_broadphase_type broadphaseType = BLAH_ENTITY_BROADPHASE_GRID;
+static float gridCellSize = BLAH_ENTITY_BROADPHASE_DEFAULT_CELL_SIZE;
+static Blah_Entity_Broadphase_Bucket gridBuckets[BLAH_ENTITY_BROADPHASE_GRID_BUCKETS];
+static Blah_Entity_Broadphase_Bucket gridOversize; //Proxies spanning too many cells to store in the grid
+
+// Array of all proxies.  Kept sorted by lowest x coordinate when using sweep and prune.
+static Blah_Entity_Broadphase_Bucket sweepList;
+static float sweepMaxRadius = 0; //Largest proxy radius in sweep list, bounds the backwards search
+
+static unsigned long nextSequence = 0;
+static unsigned long queryStamp = 0;
+static bool updatesDeferred = false; //True while entities are moved on several threads
+
+// Results of the most recent query
+static Blah_Entity** queryResults = NULL;
+static size_t queryCount = 0;
+static size_t queryCapacity = 0;
+
+/* Static Function Definitions */
+
+static void Blah_Entity_Broadphase_Bucket_add(Blah_Entity_Broadphase_Bucket* bucket, Blah_Entity_Broadphase_Proxy* proxy)
+{	//Appends proxy pointer to bucket, growing bucket storage if required
+	if (bucket->count == bucket->capacity) {
+		const size_t newCapacity = bucket->capacity ? bucket->capacity * 2 : 8;
+		Blah_Entity_Broadphase_Proxy** newProxies = realloc(bucket->proxies, newCapacity * sizeof(Blah_Entity_Broadphase_Proxy*));
+		if (newProxies == NULL) { blah_error_raise(errno, "Failed to grow entity broad-phase bucket"); }
+		bucket->proxies = newProxies;
+		bucket->capacity = newCapacity;
+	}
+	bucket->proxies[bucket->count++] = proxy;
+}
+
+static void Blah_Entity_Broadphase_Bucket_remove(Blah_Entity_Broadphase_Bucket* bucket, const Blah_Entity_Broadphase_Proxy* proxy)
+{	//Removes one occurrence of proxy pointer from bucket.  Order of bucket is not preserved.
+	for (size_t index = 0; index < bucket->count; index++) {
+		if (bucket->proxies[index] == proxy) {
+			bucket->proxies[index] = bucket->proxies[--bucket->count];
+			return;
+		}
+	}
+}
+
+static void Blah_Entity_Broadphase_Bucket_disable(Blah_Entity_Broadphase_Bucket* bucket)
+{	//Releases bucket storage
+	free(bucket->proxies);
+	bucket->proxies = NULL;
+	bucket->count = bucket->capacity = 0;
+}
+
+static void Blah_Entity_Broadphase_addResult(Blah_Entity* entity)
+{	//Appends entity to the results of current query
+	if (queryCount == queryCapacity) {
+		const size_t newCapacity = queryCapacity ? queryCapacity * 2 : 32;
+		Blah_Entity** newResults = realloc(queryResults, newCapacity * sizeof(Blah_Entity*));
+		if (newResults == NULL) { blah_error_raise(errno, "Failed to grow entity broad-phase query results"); }
+		queryResults = newResults;
+		queryCapacity = newCapacity;
+	}
+	queryResults[queryCount++] = entity;
+}
+
+static float Blah_Entity_Broadphase_Proxy_minX(const Blah_Entity_Broadphase_Proxy* proxy)
+{	//Returns lowest x coordinate of proxy bounding sphere
+	return proxy->centre.x - proxy->radius;
+}
+
+static bool Blah_Entity_Broadphase_Proxy_overlaps(const Blah_Entity_Broadphase_Proxy* proxy1, const Blah_Entity_Broadphase_Proxy* proxy2)
+{	//Returns true if bounding spheres of two proxies overlap or touch
+	const float dx = proxy2->centre.x - proxy1->centre.x;
+	const float dy = proxy2->centre.y - proxy1->centre.y;
+	const float dz = proxy2->centre.z - proxy1->centre.z;
+	const float reach = proxy1->radius + proxy2->radius;
+	return dx * dx + dy * dy + dz * dz <= reach * reach;
+}
+
+static void Blah_Entity_Broadphase_Proxy_calculate(Blah_Entity_Broadphase_Proxy* proxy)
+{	//Recalculates bounding sphere of proxy from its entity's location and objects.
+	//Object positions are relative to the entity location and are not rotated, matching
+	//the test made by Blah_Entity_Object_checkCollision.
+	const Blah_Entity* entity = proxy->entity;
+	float radius = 0;
+
+	for (const Blah_List_Element* element = entity->objects.first; element != NULL; element = element->next) {
+		const Blah_Entity_Object* entityObject = (const Blah_Entity_Object*)element->data;
+		const Blah_Point* position = &entityObject->position;
+		float reach = sqrtf(position->x * position->x + position->y * position->y + position->z * position->z);
+		if (entityObject->object != NULL) { reach += entityObject->object->boundRadius; }
+		if (reach > radius) { radius = reach; }
+	}
+	proxy->centre = entity->location;
+	proxy->radius = radius;
+}
+
+static unsigned int blah_entity_broadphase_hashCell(int x, int y, int z)
+{	//Returns index of hash bucket for grid cell with given coordinates
+	return ((unsigned int)x * 73856093u ^ (unsigned int)y * 19349663u ^ (unsigned int)z * 83492791u)
+		& (BLAH_ENTITY_BROADPHASE_GRID_BUCKETS - 1);
+}
+
+static bool blah_entity_broadphase_cellRange(const Blah_Entity_Broadphase_Proxy* proxy, int* cellMin, int* cellMax)
+{	//Calculates range of grid cells overlapped by proxy.  Returns false if the range spans
+	//more cells than may be stored in the grid.
+	const float* centre = &proxy->centre.x;
+	long cells = 1;
+
+	for (int axis = 0; axis < 3; axis++) {
+		const float low = floorf((centre[axis] - proxy->radius) / gridCellSize);
+		const float high = floorf((centre[axis] + proxy->radius) / gridCellSize);
+		if (!(low >= -BLAH_ENTITY_BROADPHASE_CELL_LIMIT && high <= BLAH_ENTITY_BROADPHASE_CELL_LIMIT)) { return false; } //Also catches NaN
+		cellMin[axis] = (int)low;
+		cellMax[axis] = (int)high;
+		cells *= cellMax[axis] - cellMin[axis] + 1;
+		if (cells > BLAH_ENTITY_BROADPHASE_GRID_MAX_CELLS) { return false; }
+	}
+	return true;
+}
+
+static void blah_entity_broadphase_gridInsert(Blah_Entity_Broadphase_Proxy* proxy)
+{	//Stores proxy in all grid cells it overlaps, or the oversize list if there are too many
+	proxy->oversize = !blah_entity_broadphase_cellRange(proxy, proxy->cellMin, proxy->cellMax);
+	if (proxy->oversize) {
+		Blah_Entity_Broadphase_Bucket_add(&gridOversize, proxy);
+	} else {
+		for (int x = proxy->cellMin[0]; x <= proxy->cellMax[0]; x++) {
+			for (int y = proxy->cellMin[1]; y <= proxy->cellMax[1]; y++) {
+				for (int z = proxy->cellMin[2]; z <= proxy->cellMax[2]; z++) {
+					Blah_Entity_Broadphase_Bucket_add(&gridBuckets[blah_entity_broadphase_hashCell(x, y, z)], proxy);
+				}
+			}
+		}
+	}
+	proxy->inGrid = true;
+}
+
+static void blah_entity_broadphase_gridRemove(Blah_Entity_Broadphase_Proxy* proxy)
+{	//Removes proxy from all grid cells it was stored in
+	if (!proxy->inGrid) { return; }
+	if (proxy->oversize) {
+		Blah_Entity_Broadphase_Bucket_remove(&gridOversize, proxy);
+	} else {
+		for (int x = proxy->cellMin[0]; x <= proxy->cellMax[0]; x++) {
+			for (int y = proxy->cellMin[1]; y <= proxy->cellMax[1]; y++) {
+				for (int z = proxy->cellMin[2]; z <= proxy->cellMax[2]; z++) {
+					Blah_Entity_Broadphase_Bucket_remove(&gridBuckets[blah_entity_broadphase_hashCell(x, y, z)], proxy);
+				}
+			}
+		}
+	}
+	proxy->inGrid = false;
+}
+
+static void blah_entity_broadphase_gridClear()
+{	//Empties all grid cells and the oversize list, retaining their storage
+	for (size_t index = 0; index < BLAH_ENTITY_BROADPHASE_GRID_BUCKETS; index++) {
+		gridBuckets[index].count = 0;
+	}
+	gridOversize.count = 0;
+	for (size_t index = 0; index < sweepList.count; index++) {
+		sweepList.proxies[index]->inGrid = false;
+	}
+}
+
+static void blah_entity_broadphase_gridUpdate(Blah_Entity_Broadphase_Proxy* proxy)
+{	//Moves proxy between grid cells if the range of cells it overlaps has changed
+	int cellMin[3], cellMax[3];
+	const bool fits = blah_entity_broadphase_cellRange(proxy, cellMin, cellMax);
+
+	if (proxy->inGrid && fits == !proxy->oversize && (proxy->oversize ||
+		(memcmp(cellMin, proxy->cellMin, sizeof(cellMin)) == 0 && memcmp(cellMax, proxy->cellMax, sizeof(cellMax)) == 0))) {
+		return; //Still occupying the same cells
+	}
+	blah_entity_broadphase_gridRemove(proxy);
+	blah_entity_broadphase_gridInsert(proxy);
+}
+
+static void blah_entity_broadphase_gridCollectBucket(const Blah_Entity_Broadphase_Bucket* bucket, const Blah_Entity_Broadphase_Proxy* queryProxy)
+{	//Adds entities from bucket overlapping the query proxy to the query results
+	for (size_t index = 0; index < bucket->count; index++) {
+		Blah_Entity_Broadphase_Proxy* proxy = bucket->proxies[index];
+		if (proxy->queryStamp != queryStamp && proxy != queryProxy && Blah_Entity_Broadphase_Proxy_overlaps(proxy, queryProxy)) {
+			proxy->queryStamp = queryStamp; //Proxy may be stored in several cells, only report it once
+			Blah_Entity_Broadphase_addResult(proxy->entity);
+		}
+	}
+}
+
+static void blah_entity_broadphase_gridQuery(const Blah_Entity_Broadphase_Proxy* queryProxy)
+{	//Collects entities stored in the grid cells overlapped by the query proxy
+	int cellMin[3], cellMax[3];
+
+	if (blah_entity_broadphase_cellRange(queryProxy, cellMin, cellMax)) {
+		for (int x = cellMin[0]; x <= cellMax[0]; x++) {
+			for (int y = cellMin[1]; y <= cellMax[1]; y++) {
+				for (int z = cellMin[2]; z <= cellMax[2]; z++) {
+					blah_entity_broadphase_gridCollectBucket(&gridBuckets[blah_entity_broadphase_hashCell(x, y, z)], queryProxy);
+				}
+			}
+		}
+		blah_entity_broadphase_gridCollectBucket(&gridOversize, queryProxy);
+	} else { //Query volume too large for the grid, so test every proxy
+		blah_entity_broadphase_gridCollectBucket(&sweepList, queryProxy);
+	}
+}
+
+static void blah_entity_broadphase_sweepSet(size_t index, Blah_Entity_Broadphase_Proxy* proxy)
+{	//Stores proxy at given position in sweep list
+	sweepList.proxies[index] = proxy;
+	proxy->sweepIndex = index;
+}
+
+static void blah_entity_broadphase_sweepUpdate(Blah_Entity_Broadphase_Proxy* proxy)
+{	//Restores sorted order of sweep list after the bounds of proxy have changed.
+	//Proxies usually move a short distance each frame, so only a few swaps are needed.
+	const float minX = Blah_Entity_Broadphase_Proxy_minX(proxy);
+	size_t index = proxy->sweepIndex;
+
+	if (proxy->radius > sweepMaxRadius) { sweepMaxRadius = proxy->radius; }
+	while (index > 0 && Blah_Entity_Broadphase_Proxy_minX(sweepList.proxies[index - 1]) > minX) {
+		blah_entity_broadphase_sweepSet(index, sweepList.proxies[index - 1]);
+		index--;
+	}
+	while (index + 1 < sweepList.count && Blah_Entity_Broadphase_Proxy_minX(sweepList.proxies[index + 1]) < minX) {
+		blah_entity_broadphase_sweepSet(index, sweepList.proxies[index + 1]);
+		index++;
+	}
+	blah_entity_broadphase_sweepSet(index, proxy);
+}
+
+static int blah_entity_broadphase_compareMinX(const void* proxy1, const void* proxy2)
+{	//qsort comparison of two proxy pointers by lowest x coordinate
+	const float minX1 = Blah_Entity_Broadphase_Proxy_minX(*(Blah_Entity_Broadphase_Proxy* const*)proxy1);
+	const float minX2 = Blah_Entity_Broadphase_Proxy_minX(*(Blah_Entity_Broadphase_Proxy* const*)proxy2);
+	return (minX1 > minX2) - (minX1 < minX2);
+}
+
+static void blah_entity_broadphase_sweepSort()
+{	//Fully sorts the sweep list and recalculates the largest proxy radius
+	qsort(sweepList.proxies, sweepList.count, sizeof(Blah_Entity_Broadphase_Proxy*), blah_entity_broadphase_compareMinX);
+	sweepMaxRadius = 0;
+	for (size_t index = 0; index < sweepList.count; index++) {
+		Blah_Entity_Broadphase_Proxy* proxy = sweepList.proxies[index];
+		proxy->sweepIndex = index;
+		if (proxy->radius > sweepMaxRadius) { sweepMaxRadius = proxy->radius; }
+	}
+}
+
+static void blah_entity_broadphase_sweepQuery(const Blah_Entity_Broadphase_Proxy* queryProxy)
+{	//Collects entities from the sweep list overlapping the query proxy along the x axis, then
+	//filters them by sphere overlap.  No proxy starting lower than the query start minus the
+	//largest diameter can reach the query, so the scan begins there.
+	const float scanStart = Blah_Entity_Broadphase_Proxy_minX(queryProxy) - 2 * sweepMaxRadius;
+	const float scanEnd = queryProxy->centre.x + queryProxy->radius;
+	size_t low = 0, high = sweepList.count;
+
+	while (low < high) { //Binary search for first proxy at or beyond scan start
+		const size_t middle = low + (high - low) / 2;
+		if (Blah_Entity_Broadphase_Proxy_minX(sweepList.proxies[middle]) < scanStart) { low = middle + 1; } else { high = middle; }
+	}
+	for (size_t index = low; index < sweepList.count; index++) {
+		Blah_Entity_Broadphase_Proxy* proxy = sweepList.proxies[index];
+		if (Blah_Entity_Broadphase_Proxy_minX(proxy) > scanEnd) { break; }
+		if (proxy != queryProxy && Blah_Entity_Broadphase_Proxy_overlaps(proxy, queryProxy)) {
+			Blah_Entity_Broadphase_addResult(proxy->entity);
+		}
+	}
+}
+
+static int blah_entity_broadphase_compareSequence(const void* entity1, const void* entity2)
+{	//qsort comparison of two entity pointers by their proxy insertion order
+	const unsigned long sequence1 = (*(Blah_Entity* const*)entity1)->broadphaseProxy->sequence;
+	const unsigned long sequence2 = (*(Blah_Entity* const*)entity2)->broadphaseProxy->sequence;
+	return (sequence1 > sequence2) - (sequence1 < sequence2);
+}
+
+/* Function Definitions */
+
+void blah_entity_broadphase_deferUpdates(bool defer)
+{	//While deferred, updates of entity bounding volumes are ignored
+	updatesDeferred = defer;
+}
+
+float blah_entity_broadphase_getCellSize()
+{	//Returns the edge length of the cells in the spatial hash grid
+	return gridCellSize;
+}
+
+blah_entity_broadphase_type blah_entity_broadphase_getType()
+{	//Returns the broad-phase scheme currently in use
+	return broadphaseType;
+}
+
+void blah_entity_broadphase_insertEntity(Blah_Entity* entity)
+{	//Creates a proxy for the given entity and adds it to the broad-phase
+	Blah_Entity_Broadphase_Proxy* proxy = malloc(sizeof(Blah_Entity_Broadphase_Proxy));
+	if (proxy == NULL) { blah_error_raise(errno, "Failed to allocate broad-phase proxy for entity '%s'", entity->name); }
+
+	proxy->entity = entity;
+	proxy->sequence = nextSequence++;
+	proxy->inGrid = proxy->oversize = false;
+	proxy->queryStamp = 0;
+	Blah_Entity_Broadphase_Proxy_calculate(proxy);
+	entity->broadphaseProxy = proxy;
+
+	proxy->sweepIndex = sweepList.count;
+	Blah_Entity_Broadphase_Bucket_add(&sweepList, proxy);
+	if (broadphaseType == BLAH_ENTITY_BROADPHASE_SWEEP) {
+		blah_entity_broadphase_sweepUpdate(proxy);
+	} else if (broadphaseType == BLAH_ENTITY_BROADPHASE_GRID) {
+		blah_entity_broadphase_gridInsert(proxy);
+	}
+}
+
+Blah_Entity** blah_entity_broadphase_queryEntity(Blah_Entity* entity, size_t* count)
+{	//Returns an array of the entities whose bounding spheres overlap that of the given entity,
+	//in entity list order.  Entities without proxies are never reported.
+	Blah_Entity_Broadphase_Proxy tempProxy; //Stands in for entities which have no proxy
+	const Blah_Entity_Broadphase_Proxy* queryProxy = entity->broadphaseProxy;
+
+	if (queryProxy == NULL) {
+		tempProxy.entity = entity;
+		Blah_Entity_Broadphase_Proxy_calculate(&tempProxy);
+		queryProxy = &tempProxy;
+	}
+
+	queryCount = 0;
+	queryStamp++;
+	switch (broadphaseType) {
+		case BLAH_ENTITY_BROADPHASE_GRID :
+			blah_entity_broadphase_gridQuery(queryProxy);
+			break;
+		case BLAH_ENTITY_BROADPHASE_SWEEP :
+			blah_entity_broadphase_sweepQuery(queryProxy);
+			break;
+		default : //No culling, report every other entity
+			for (size_t index = 0; index < sweepList.count; index++) {
+				if (sweepList.proxies[index] != queryProxy) { Blah_Entity_Broadphase_addResult(sweepList.proxies[index]->entity); }
+			}
+			break;
+	}
+	// Report candidates in the same order as a walk of the entity list would find them
+	qsort(queryResults, queryCount, sizeof(Blah_Entity*), blah_entity_broadphase_compareSequence);
+
+	*count = queryCount;
+	return queryResults;
+}
+
+void blah_entity_broadphase_removeEntity(Blah_Entity* entity)
+{	//Removes the given entity from the broad-phase and destroys its proxy
+	Blah_Entity_Broadphase_Proxy* proxy = entity->broadphaseProxy;
+	if (proxy == NULL) { return; }
+
+	for (size_t index = 0; index < queryCount; index++) { //Invalidate entity in results still being processed
+		if (queryResults[index] == entity) { queryResults[index] = NULL; }
+	}
+	blah_entity_broadphase_gridRemove(proxy);
+	if (broadphaseType == BLAH_ENTITY_BROADPHASE_SWEEP) { //Sweep list order must be preserved
+		for (size_t index = proxy->sweepIndex + 1; index < sweepList.count; index++) {
+			blah_entity_broadphase_sweepSet(index - 1, sweepList.proxies[index]);
+		}
+		sweepList.count--;
+	} else {
+		blah_entity_broadphase_sweepSet(proxy->sweepIndex, sweepList.proxies[sweepList.count - 1]);
+		sweepList.count--;
+	}
+	if (sweepList.count == 0) { //Release all storage once the last entity is gone
+		for (size_t index = 0; index < BLAH_ENTITY_BROADPHASE_GRID_BUCKETS; index++) {
+			Blah_Entity_Broadphase_Bucket_disable(&gridBuckets[index]);
+		}
+		Blah_Entity_Broadphase_Bucket_disable(&gridOversize);
+		Blah_Entity_Broadphase_Bucket_disable(&sweepList);
+		sweepMaxRadius = 0;
+	}
+	entity->broadphaseProxy = NULL;
+	free(proxy);
+}
+
+void blah_entity_broadphase_setCellSize(float cellSize)
+{	//Sets the edge length of the cells in the spatial hash grid, rebuilding the grid if in use
+	if (cellSize <= 0) { blah_error_raise(EINVAL, "Invalid entity broad-phase cell size %f", cellSize); }
+	gridCellSize = cellSize;
+	if (broadphaseType == BLAH_ENTITY_BROADPHASE_GRID) {
+		blah_entity_broadphase_gridClear();
+		for (size_t index = 0; index < sweepList.count; index++) {
+			blah_entity_broadphase_gridInsert(sweepList.proxies[index]);
+		}
+	}
+}
+
+void blah_entity_broadphase_setType(blah_entity_broadphase_type type)
+{	//Selects the broad-phase scheme used for collision checking
+	blah_entity_broadphase_gridClear();
+	broadphaseType = type;
+	for (size_t index = 0; index < sweepList.count; index++) { //Bring all bounds up to date
+		Blah_Entity_Broadphase_Proxy_calculate(sweepList.proxies[index]);
+	}
+	if (type == BLAH_ENTITY_BROADPHASE_SWEEP) {
+		blah_entity_broadphase_sweepSort();
+	} else if (type == BLAH_ENTITY_BROADPHASE_GRID) {
+		for (size_t index = 0; index < sweepList.count; index++) {
+			blah_entity_broadphase_gridInsert(sweepList.proxies[index]);
+		}
+	}
+}
+
+void blah_entity_broadphase_updateEntity(Blah_Entity* entity)
+{	//Recalculates the bounding sphere of the given entity and moves its proxy accordingly
+	Blah_Entity_Broadphase_Proxy* proxy = entity->broadphaseProxy;
+	if (proxy == NULL || updatesDeferred) { return; }
+
+	Blah_Entity_Broadphase_Proxy_calculate(proxy);
+	if (broadphaseType == BLAH_ENTITY_BROADPHASE_SWEEP) {
+		blah_entity_broadphase_sweepUpdate(proxy);
+	} else if (broadphaseType == BLAH_ENTITY_BROADPHASE_GRID) {
+		blah_entity_broadphase_gridUpdate(proxy);
+	}
+}
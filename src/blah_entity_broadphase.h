@@ -0,0 +1,95 @@
+/* blah_entity_broadphase.h
+	Broad-phase collision culling for entities.  Every entity in the global entity list is
+	represented by a proxy, a bounding sphere around the entity's location which encloses all
+	of its objects.  Before the exact test in Blah_Entity_checkCollisionEntity is made, the
+	broad-phase is queried for those entities whose spheres overlap, so that the cost of collision
+	checking no longer grows with the square of the number of entities.
+	Two schemes are available, a uniform spatial hash grid and a sweep and prune list sorted along
+	the x axis.  The broad-phase may also be switched off, in which case every entity is tested. */
+
+#ifndef _BLAH_ENTITY_BROADPHASE
+
+#define _BLAH_ENTITY_BROADPHASE
+
+#include <stddef.h>
+
+#include "blah_point.h"
+#include "blah_types.h"
+
+/* Definitions */
+
+#define BLAH_ENTITY_BROADPHASE_GRID_BUCKETS 4096 //Number of hash buckets in spatial grid.  Must be a power of 2.
+#define BLAH_ENTITY_BROADPHASE_GRID_MAX_CELLS 64 //Proxies spanning more grid cells than this are kept in a separate list
+#define BLAH_ENTITY_BROADPHASE_DEFAULT_CELL_SIZE 10.0f //Default edge length of a grid cell in world units
+
+/* Forward Declarations */
+
+struct Blah_Entity;
+
+/* Type Definitions */
+
+typedef enum Blah_Entity_Broadphase_Type {
+	BLAH_ENTITY_BROADPHASE_NONE,	//No culling, each entity is tested against all other entities
+	BLAH_ENTITY_BROADPHASE_GRID,	//Uniform spatial hash grid
+	BLAH_ENTITY_BROADPHASE_SWEEP	//Sweep and prune along the x axis
+} blah_entity_broadphase_type;
+
+/* Structure Definitions */
+
+typedef struct Blah_Entity_Broadphase_Proxy { //Bounding volume of an entity held by the broad-phase
+	struct Blah_Entity* entity;		//Entity represented by the proxy
+	unsigned long sequence;			//Order of insertion, used to report candidates in entity list order
+	Blah_Point centre;				//Centre of bounding sphere, the entity location
+	float radius;					//Radius of bounding sphere enclosing all entity objects
+	bool inGrid;					//True if proxy is currently stored in the grid cells or oversize list
+	bool oversize;					//True if proxy spans too many cells and is kept in oversize list
+	int cellMin[3];					//Lowest grid cell coordinates occupied by proxy
+	int cellMax[3];					//Highest grid cell coordinates occupied by proxy
+	size_t sweepIndex;				//Position of proxy in the sweep and prune list
+	unsigned long queryStamp;		//Identifies the last query which reported this proxy
+} Blah_Entity_Broadphase_Proxy;
+
+/* Function Prototypes */
+
+#ifdef __cplusplus
+	extern "C" {
+#endif //__cplusplus
+
+void blah_entity_broadphase_deferUpdates(bool defer);
+	//While deferred, blah_entity_broadphase_updateEntity has no effect, so that entities may be moved
+	//on several threads at once.  Entities moved meanwhile must be updated once deferral has ended.
+
+float blah_entity_broadphase_getCellSize();
+	//Returns the edge length of the cells in the spatial hash grid
+
+blah_entity_broadphase_type blah_entity_broadphase_getType();
+	//Returns the broad-phase scheme currently in use
+
+void blah_entity_broadphase_insertEntity(struct Blah_Entity* entity);
+	//Creates a proxy for the given entity and adds it to the broad-phase
+
+struct Blah_Entity** blah_entity_broadphase_queryEntity(struct Blah_Entity* entity, size_t* count);
+	//Returns an array of the entities whose bounding spheres overlap that of the given entity,
+	//in the order they appear in the entity list, and stores the number of entries in *count.
+	//The given entity is not included.  The array is owned by the broad-phase and remains valid
+	//until the next query.  Entities destroyed before then are replaced by NULL pointers.
+
+void blah_entity_broadphase_removeEntity(struct Blah_Entity* entity);
+	//Removes the given entity from the broad-phase and destroys its proxy
+
+void blah_entity_broadphase_setCellSize(float cellSize);
+	//Sets the edge length of the cells in the spatial hash grid.  Should be roughly the
+	//diameter of a typical entity.  The grid is rebuilt if it is in use.
+
+void blah_entity_broadphase_setType(blah_entity_broadphase_type type);
+	//Selects the broad-phase scheme used for collision checking, rebuilding it from all
+	//entities with proxies.
+
+void blah_entity_broadphase_updateEntity(struct Blah_Entity* entity);
+	//Recalculates the bounding sphere of the given entity and moves its proxy accordingly
+
+#ifdef __cplusplus
+	}
+#endif //__cplusplus
+
+#endif
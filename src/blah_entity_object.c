@@ -8,6 +8,7 @@
 #include "blah_types.h"
 #include "blah_draw.h"
 #include "blah_macros.h"
+#include "blah_transform.h"
 #include "blah_util.h"
 
 /* Entity Object Function Declarations */
@@ -39,7 +40,9 @@ void Blah_Entity_Object_destroy(Blah_Entity_Object *entityObject)
 void Blah_Entity_Object_disable(Blah_Entity_Object *entityObject)
 {	//This function deinitialises the given entity object, by removing any allocated resources
 	//associated with it, apart from the memory structure containing the entity object itself.
-	Blah_Object_destroy(entityObject->object); //Destroy base object
+	if (!entityObject->sharedObject) { Blah_Object_destroy(entityObject->object); } //Destroy base object, if owned
+	blah_transform_remove(entityObject->transformIndex);
+	entityObject->transformIndex = BLAH_TRANSFORM_NONE;
 }
 
 float Blah_Entity_Object_distanceObject(Blah_Entity_Object *entityObject1, Blah_Entity_Object *entityObject2)
@@ -61,13 +64,18 @@ float Blah_Entity_Object_distanceObject(Blah_Entity_Object *entityObject1, Blah_
 
 void Blah_Entity_Object_draw(Blah_Entity_Object *entityObject)
 {	//Draw object in 3D space relative to parent entity
+	Blah_Entity_Object_drawAt(entityObject, &entityObject->objectMatrix);
+}
+
+void Blah_Entity_Object_drawAt(Blah_Entity_Object *entityObject, const Blah_Matrix *matrix)
+{	//Draw object in 3D space, placed by the given matrix relative to the current drawing matrix
 	if (entityObject->visible) {
 		blah_draw_pushMatrix();
-		blah_draw_multMatrix(&entityObject->objectMatrix);
+		blah_draw_multMatrix(matrix);
 		//If the entity object defines a special draw function, use it
 		if (entityObject->drawFunction) {
 			entityObject->drawFunction(entityObject);
-		} else { //Just use the standard object draw function
+		} else if (blah_draw_isObjectVisible(entityObject->object)) { //Just use the standard object draw function, unless out of view
 			Blah_Object_draw(entityObject->object);
 		}
 		blah_draw_popMatrix();
@@ -81,8 +89,10 @@ void Blah_Entity_Object_init(Blah_Entity_Object *entityObject, const char *name,
 	entityObject->object = objectPtr;
 	entityObject->drawFunction = NULL;
 	entityObject->visible = true;
+	entityObject->sharedObject = false;
 	Blah_Point_set(&entityObject->position, 0, 0, 0);
 	Blah_Matrix_setIdentity(&entityObject->objectMatrix);
+	entityObject->transformIndex = BLAH_TRANSFORM_NONE;
 	Blah_Vector_set(&entityObject->axisX, 1, 0, 0);
 	Blah_Vector_set(&entityObject->axisY, 0, 1, 0);
 	Blah_Vector_set(&entityObject->axisZ, 0, 0, 1);
@@ -104,6 +114,13 @@ Blah_Entity_Object *Blah_Entity_Object_new(const char* name, Blah_Object* object
 	return newEntityObject;
 }
 
+Blah_Entity_Object *Blah_Entity_Object_newShared(const char* name, Blah_Object* objectPtr)
+{	//Create a new entity object referencing an object it does not own.  Returns NULL on failure.
+	Blah_Entity_Object* newEntityObject = Blah_Entity_Object_new(name, objectPtr);
+	if (newEntityObject) { newEntityObject->sharedObject = true; }
+	return newEntityObject;
+}
+
 void Blah_Entity_Object_setDrawFunction(Blah_Entity_Object *entityObject, blah_entity_object_draw_func* function) {
 	//set pointer for draw function used by given entity object
 	entityObject->drawFunction = function;
@@ -112,6 +129,10 @@ void Blah_Entity_Object_setDrawFunction(Blah_Entity_Object *entityObject, blah_e
 void Blah_Entity_Object_setPosition(Blah_Entity_Object *entityObject, float x, float y, float z)
 {	//Alters entity object's position, relative to parent entity center.
 	Blah_Point_set(&entityObject->position, x,y,z);
+	Blah_Matrix_setTranslation(&entityObject->objectMatrix, x,y,z); //Position was otherwise ignored when drawing
+	if (entityObject->transformIndex != BLAH_TRANSFORM_NONE) {
+		blah_transform_setLocal(entityObject->transformIndex, &entityObject->objectMatrix);
+	}
 }
 
 void Blah_Entity_Object_setVisible(Blah_Entity_Object *entityObject, bool visFlag) {
@@ -1,6 +1,8 @@
 /* blah_entity_object.h
 	An entity object is an object constituting all or part of an entity.
-	Entity objects have a reference to an underlying geometric object	*/
+	Entity objects have a reference to an underlying geometric object, which they own and destroy
+	with themselves unless created shared.  A shared object can be referenced by any number of entity
+	objects, such as those of many entities built from one model, and is drawn as instances of it.	*/
 
 #ifndef _BLAH_ENTITY_OBJECT
 
@@ -33,9 +35,11 @@ typedef struct Blah_Entity_Object { //represents an object constituting an entit
 	Blah_Object *object;	//Pointer to the object
 	Blah_Point position; //objects's position in 3D, relative to entity center
 	Blah_Matrix objectMatrix; //structure's relative matrix.  Don't mess with it directly.
+	long transformIndex; //Node in the transform hierarchy, or BLAH_TRANSFORM_NONE until the entity is updated
 	Blah_Vector axisX, axisY, axisZ; //structure's own primary axes x,y, and z
 	blah_entity_object_draw_func* drawFunction;
 	bool visible;		//Visibility flag; If TRUE, then structure is drawn
+	bool sharedObject;	//If TRUE, the object is not owned, so is not destroyed with the entity object
 } Blah_Entity_Object;
 
 /* Entity Object Function prototypes */
@@ -53,11 +57,12 @@ void Blah_Entity_Object_deltaEntityObject(Blah_Entity_Object *entityObject1, Bla
 
 void Blah_Entity_Object_destroy(Blah_Entity_Object* entityObject);
 	//Destroys an entity object structure.  Frees memory occupied by entity object
-	//structure and also destroys the referenced base object.
+	//structure and also destroys the referenced base object, unless it is shared.
 
 void Blah_Entity_Object_disable(Blah_Entity_Object* entityObject);
 	//This function deinitialises the given entity object, by removing any allocated resources
 	//associated with it, apart from the memory structure containing the entity object itself.
+	//A shared base object is left for its owner to destroy.
 
 float Blah_Entity_Object_distanceObject(Blah_Entity_Object* entityObject1, Blah_Entity_Object* entityObject2);
 	//Returns true distance between two entity objects
@@ -65,6 +70,10 @@ float Blah_Entity_Object_distanceObject(Blah_Entity_Object* entityObject1, Blah_
 void Blah_Entity_Object_draw(Blah_Entity_Object* entityObject);
 	//Draw structure in scene
 
+void Blah_Entity_Object_drawAt(Blah_Entity_Object* entityObject, const Blah_Matrix* matrix);
+	//Draw structure in scene, multiplying the current drawing matrix by the given matrix rather
+	//than the object matrix.  Used to draw with world matrices from the transform hierarchy.
+
 void Blah_Entity_Object_init(Blah_Entity_Object* entityObject, const char *name, Blah_Object *objectPtr);
 	//Initialise an entity structure using supplied name and object pointer.
 
@@ -76,6 +85,10 @@ Blah_Entity_Object *Blah_Entity_Object_new(const char* name, Blah_Object* object
 	//Alloc a new entity object data structure and return pointer.
 	//Returns NULL on failure.  Defaults position to 0,0,0, visible True.
 
+Blah_Entity_Object *Blah_Entity_Object_newShared(const char* name, Blah_Object* objectPtr);
+	//Create a new entity object as Blah_Entity_Object_new, referencing an object it does not own.
+	//The object must outlive the entity object, and is destroyed by its owner.
+
 void Blah_Entity_Object_setDrawFunction(Blah_Entity_Object* entityObject, blah_entity_object_draw_func* function);
 	//set pointer for draw function used by given entity object
 
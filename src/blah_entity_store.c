@@ -0,0 +1,284 @@
+/* blah_entity_store.c
+	Defines the structure of arrays store for batched entities.  See blah_entity_store.h for reference.
+*/
+
+#include <stdlib.h>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#include "blah_entity_store.h"
+#include "blah_entity.h"
+#include "blah_entity_broadphase.h"
+#include "blah_matrix.h"
+#include "blah_quaternion.h"
+#include "blah_error.h"
+
+/* Definitions */
+
+#define BLAH_ENTITY_STORE_LANES 4 //Number of entities integrated together in each step of batched pass
+
+/* Structure Definitions */
+
+typedef struct Blah_Entity_Store { //Transform state of batched entities, one array per component
+	size_t count;					//Number of occupied slots
+	size_t capacity;				//Number of slots allocated in each array
+	Blah_Entity** entities;			//Entity owning each slot, NULL if removed during processing
+	float* locationX; float* locationY; float* locationZ;
+	float* velocityX; float* velocityY; float* velocityZ;
+	float* orientationX; float* orientationY; float* orientationZ; float* orientationW;
+	float* spinX; float* spinY; float* spinZ; float* spinW;	//Rotation applied each frame, formed from entity's rates of turn
+} Blah_Entity_Store;
+
+/* Static Globals - Private to entity_store.c */
+
+static Blah_Entity_Store entityStore = { .count = 0 };
+static bool storeProcessing = false;	//True while move functions are being called for stored entities
+static bool storeCompactPending = false; //True if entities were removed while processing, leaving empty slots
+
+/* Static Function Definitions */
+
+static float*** blah_entity_store_arrays(size_t* arrayCount)
+{	//Returns the addresses of all component arrays of the store, storing number of arrays in *arrayCount
+	static float** arrays[] = {
+		&entityStore.locationX, &entityStore.locationY, &entityStore.locationZ,
+		&entityStore.velocityX, &entityStore.velocityY, &entityStore.velocityZ,
+		&entityStore.orientationX, &entityStore.orientationY, &entityStore.orientationZ, &entityStore.orientationW,
+		&entityStore.spinX, &entityStore.spinY, &entityStore.spinZ, &entityStore.spinW,
+	};
+	*arrayCount = sizeof(arrays) / sizeof(arrays[0]);
+	return arrays;
+}
+
+static void blah_entity_store_grow()
+{	//Doubles the capacity of all arrays in the store
+	const size_t newCapacity = entityStore.capacity ? entityStore.capacity * 2 : 64;
+	size_t arrayCount;
+	float*** arrays = blah_entity_store_arrays(&arrayCount);
+	Blah_Entity** newEntities = realloc(entityStore.entities, newCapacity * sizeof(Blah_Entity*));
+
+	if (newEntities == NULL) { blah_error_raise(errno, "Failed to grow entity store"); }
+	entityStore.entities = newEntities;
+	for (size_t index = 0; index < arrayCount; index++) {
+		float* newArray = realloc(*arrays[index], newCapacity * sizeof(float));
+		if (newArray == NULL) { blah_error_raise(errno, "Failed to grow entity store"); }
+		*arrays[index] = newArray;
+	}
+	entityStore.capacity = newCapacity;
+}
+
+static void blah_entity_store_moveSlot(size_t dest, size_t source)
+{	//Copies all components of slot 'source' to slot 'dest', updating the owning entity
+	size_t arrayCount;
+	float*** arrays = blah_entity_store_arrays(&arrayCount);
+
+	for (size_t index = 0; index < arrayCount; index++) {
+		(*arrays[index])[dest] = (*arrays[index])[source];
+	}
+	entityStore.entities[dest] = entityStore.entities[source];
+	if (entityStore.entities[dest] != NULL) { entityStore.entities[dest]->storeIndex = (long)dest; }
+}
+
+static void blah_entity_store_compact()
+{	//Closes up slots left empty by entities removed during processing
+	size_t dest = 0;
+
+	for (size_t source = 0; source < entityStore.count; source++) {
+		if (entityStore.entities[source] != NULL) {
+			if (dest != source) { blah_entity_store_moveSlot(dest, source); }
+			dest++;
+		}
+	}
+	entityStore.count = dest;
+	storeCompactPending = false;
+}
+
+static void blah_entity_store_writeBack(size_t slot, const float* axes)
+{	//Writes location, orientation and matrix axes calculated for a slot back to the owning entity.
+	//'axes' points to the nine matrix axis components, BLAH_ENTITY_STORE_LANES floats apart.
+	Blah_Entity* entity = entityStore.entities[slot];
+	if (entity == NULL) { return; }
+
+	Blah_Point_set(&entity->location, entityStore.locationX[slot], entityStore.locationY[slot], entityStore.locationZ[slot]);
+	entity->orientation.x = entityStore.orientationX[slot];
+	entity->orientation.y = entityStore.orientationY[slot];
+	entity->orientation.z = entityStore.orientationZ[slot];
+	entity->orientation.w = entityStore.orientationW[slot];
+	Blah_Vector_set(&entity->axisX, axes[0 * BLAH_ENTITY_STORE_LANES], axes[1 * BLAH_ENTITY_STORE_LANES], axes[2 * BLAH_ENTITY_STORE_LANES]);
+	Blah_Vector_set(&entity->axisY, axes[3 * BLAH_ENTITY_STORE_LANES], axes[4 * BLAH_ENTITY_STORE_LANES], axes[5 * BLAH_ENTITY_STORE_LANES]);
+	Blah_Vector_set(&entity->axisZ, axes[6 * BLAH_ENTITY_STORE_LANES], axes[7 * BLAH_ENTITY_STORE_LANES], axes[8 * BLAH_ENTITY_STORE_LANES]);
+	blah_entity_broadphase_updateEntity(entity);
+}
+
+static void blah_entity_store_integrateSlot(size_t slot, float* axes)
+{	//Integrates a single slot with scalar arithmetic, in the same order of operations as
+	//Blah_Entity_animate, storing the nine matrix axis components BLAH_ENTITY_STORE_LANES floats apart
+	Blah_Quaternion orientation = { entityStore.orientationX[slot], entityStore.orientationY[slot],
+		entityStore.orientationZ[slot], entityStore.orientationW[slot] };
+	Blah_Quaternion spin = { entityStore.spinX[slot], entityStore.spinY[slot], entityStore.spinZ[slot], entityStore.spinW[slot] };
+	Blah_Matrix matrix;
+
+	entityStore.locationX[slot] += entityStore.velocityX[slot];
+	entityStore.locationY[slot] += entityStore.velocityY[slot];
+	entityStore.locationZ[slot] += entityStore.velocityZ[slot];
+
+	Blah_Quaternion_multiplyQuaternion(&orientation, &spin);
+	entityStore.orientationX[slot] = orientation.x;
+	entityStore.orientationY[slot] = orientation.y;
+	entityStore.orientationZ[slot] = orientation.z;
+	entityStore.orientationW[slot] = orientation.w;
+
+	Blah_Matrix_setRotationQuat(&matrix, &orientation);
+	axes[0 * BLAH_ENTITY_STORE_LANES] = matrix.axisX.x; axes[1 * BLAH_ENTITY_STORE_LANES] = matrix.axisX.y; axes[2 * BLAH_ENTITY_STORE_LANES] = matrix.axisX.z;
+	axes[3 * BLAH_ENTITY_STORE_LANES] = matrix.axisY.x; axes[4 * BLAH_ENTITY_STORE_LANES] = matrix.axisY.y; axes[5 * BLAH_ENTITY_STORE_LANES] = matrix.axisY.z;
+	axes[6 * BLAH_ENTITY_STORE_LANES] = matrix.axisZ.x; axes[7 * BLAH_ENTITY_STORE_LANES] = matrix.axisZ.y; axes[8 * BLAH_ENTITY_STORE_LANES] = matrix.axisZ.z;
+}
+
+#ifdef __SSE__
+static void blah_entity_store_integrateLanes(size_t slot, float* axes)
+{	//Integrates BLAH_ENTITY_STORE_LANES consecutive slots together with SSE arithmetic.  The order
+	//of operations matches the scalar path, so results are identical.
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+	__m128 qx = _mm_loadu_ps(entityStore.orientationX + slot), qy = _mm_loadu_ps(entityStore.orientationY + slot);
+	__m128 qz = _mm_loadu_ps(entityStore.orientationZ + slot), qw = _mm_loadu_ps(entityStore.orientationW + slot);
+	const __m128 sx = _mm_loadu_ps(entityStore.spinX + slot), sy = _mm_loadu_ps(entityStore.spinY + slot);
+	const __m128 sz = _mm_loadu_ps(entityStore.spinZ + slot), sw = _mm_loadu_ps(entityStore.spinW + slot);
+
+	_mm_storeu_ps(entityStore.locationX + slot, _mm_add_ps(_mm_loadu_ps(entityStore.locationX + slot), _mm_loadu_ps(entityStore.velocityX + slot)));
+	_mm_storeu_ps(entityStore.locationY + slot, _mm_add_ps(_mm_loadu_ps(entityStore.locationY + slot), _mm_loadu_ps(entityStore.velocityY + slot)));
+	_mm_storeu_ps(entityStore.locationZ + slot, _mm_add_ps(_mm_loadu_ps(entityStore.locationZ + slot), _mm_loadu_ps(entityStore.velocityZ + slot)));
+
+	// Orientation multiplied by spin, as Blah_Quaternion_multiplyQuaternion
+	const __m128 w = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(qw, sw), _mm_mul_ps(qx, sx)), _mm_mul_ps(qy, sy)), _mm_mul_ps(qz, sz));
+	const __m128 x = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(qw, sx), _mm_mul_ps(qx, sw)), _mm_mul_ps(qy, sz)), _mm_mul_ps(qz, sy));
+	const __m128 y = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(qw, sy), _mm_mul_ps(qy, sw)), _mm_mul_ps(qz, sx)), _mm_mul_ps(qx, sz));
+	const __m128 z = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(qw, sz), _mm_mul_ps(qz, sw)), _mm_mul_ps(qx, sy)), _mm_mul_ps(qy, sx));
+	qx = x; qy = y; qz = z; qw = w;
+	_mm_storeu_ps(entityStore.orientationX + slot, qx);
+	_mm_storeu_ps(entityStore.orientationY + slot, qy);
+	_mm_storeu_ps(entityStore.orientationZ + slot, qz);
+	_mm_storeu_ps(entityStore.orientationW + slot, qw);
+
+	// Rotation matrix axes, as Blah_Matrix_setRotationQuat
+	const __m128 xx = _mm_mul_ps(qx, qx), xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), xw = _mm_mul_ps(qx, qw);
+	const __m128 yy = _mm_mul_ps(qy, qy), yz = _mm_mul_ps(qy, qz), yw = _mm_mul_ps(qy, qw);
+	const __m128 zz = _mm_mul_ps(qz, qz), zw = _mm_mul_ps(qz, qw);
+	_mm_storeu_ps(axes + 0 * BLAH_ENTITY_STORE_LANES, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))));
+	_mm_storeu_ps(axes + 1 * BLAH_ENTITY_STORE_LANES, _mm_mul_ps(two, _mm_add_ps(xy, zw)));
+	_mm_storeu_ps(axes + 2 * BLAH_ENTITY_STORE_LANES, _mm_mul_ps(two, _mm_sub_ps(xz, yw)));
+	_mm_storeu_ps(axes + 3 * BLAH_ENTITY_STORE_LANES, _mm_mul_ps(two, _mm_sub_ps(xy, zw)));
+	_mm_storeu_ps(axes + 4 * BLAH_ENTITY_STORE_LANES, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))));
+	_mm_storeu_ps(axes + 5 * BLAH_ENTITY_STORE_LANES, _mm_mul_ps(two, _mm_add_ps(yz, xw)));
+	_mm_storeu_ps(axes + 6 * BLAH_ENTITY_STORE_LANES, _mm_mul_ps(two, _mm_add_ps(xz, yw)));
+	_mm_storeu_ps(axes + 7 * BLAH_ENTITY_STORE_LANES, _mm_mul_ps(two, _mm_sub_ps(yz, xw)));
+	_mm_storeu_ps(axes + 8 * BLAH_ENTITY_STORE_LANES, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))));
+}
+#endif //__SSE__
+
+/* Function Definitions */
+
+void blah_entity_store_addEntity(Blah_Entity* entity)
+{	//Adds the given entity to the store, copying its current transform state
+	if (entity->storeIndex >= 0) { return; } //Already stored
+	if (entityStore.count == entityStore.capacity) { blah_entity_store_grow(); }
+
+	entity->storeIndex = (long)entityStore.count;
+	entityStore.entities[entityStore.count++] = entity;
+	blah_entity_store_syncEntity(entity);
+}
+
+void blah_entity_store_destroyAll()
+{	//Releases all memory held by the store.  Entities still in the store are removed from it.
+	size_t arrayCount;
+	float*** arrays = blah_entity_store_arrays(&arrayCount);
+
+	for (size_t slot = 0; slot < entityStore.count; slot++) {
+		if (entityStore.entities[slot] != NULL) { entityStore.entities[slot]->storeIndex = -1; }
+	}
+	for (size_t index = 0; index < arrayCount; index++) {
+		free(*arrays[index]);
+		*arrays[index] = NULL;
+	}
+	free(entityStore.entities);
+	entityStore.entities = NULL;
+	entityStore.count = entityStore.capacity = 0;
+	storeCompactPending = false;
+}
+
+size_t blah_entity_store_getCount()
+{	//Returns the number of entities in the store
+	return entityStore.count;
+}
+
+void blah_entity_store_integrate()
+{	//Advances all stored entities by one frame and writes the results back to the entities
+	float axes[9 * BLAH_ENTITY_STORE_LANES]; //Matrix axis components, one row per component and one column per lane
+	size_t slot = 0;
+
+#ifdef __SSE__
+	for (; slot + BLAH_ENTITY_STORE_LANES <= entityStore.count; slot += BLAH_ENTITY_STORE_LANES) {
+		blah_entity_store_integrateLanes(slot, axes);
+		for (size_t lane = 0; lane < BLAH_ENTITY_STORE_LANES; lane++) {
+			blah_entity_store_writeBack(slot + lane, axes + lane);
+		}
+	}
+#endif //__SSE__
+	for (; slot < entityStore.count; slot++) { //Remaining slots, or all of them without SSE
+		blah_entity_store_integrateSlot(slot, axes);
+		blah_entity_store_writeBack(slot, axes);
+	}
+}
+
+void blah_entity_store_process()
+{	//Calls the move function of every stored entity, then integrates all stored entities.
+	//Move functions may destroy entities, so removed slots are only closed up afterwards.
+	storeProcessing = true;
+	for (size_t slot = 0; slot < entityStore.count; slot++) {
+		Blah_Entity* entity = entityStore.entities[slot];
+		if (entity != NULL && entity->moveFunction != NULL) { entity->moveFunction(entity); }
+	}
+	storeProcessing = false;
+	if (storeCompactPending) { blah_entity_store_compact(); }
+	blah_entity_store_integrate();
+}
+
+void blah_entity_store_removeEntity(Blah_Entity* entity)
+{	//Removes the given entity from the store.  Has no effect if the entity is not stored.
+	const long slot = entity->storeIndex;
+	if (slot < 0) { return; }
+
+	if (storeProcessing) { //Leave slot empty until processing has finished
+		entityStore.entities[slot] = NULL;
+		storeCompactPending = true;
+	} else { //Fill slot with last entity in store
+		blah_entity_store_moveSlot((size_t)slot, entityStore.count - 1);
+		entityStore.count--;
+	}
+	entity->storeIndex = -1;
+}
+
+void blah_entity_store_syncEntity(Blah_Entity* entity)
+{	//Copies the transform state of the given entity into the store
+	Blah_Quaternion spin;
+	const long slot = entity->storeIndex;
+	if (slot < 0) { return; }
+
+	entityStore.locationX[slot] = entity->location.x;
+	entityStore.locationY[slot] = entity->location.y;
+	entityStore.locationZ[slot] = entity->location.z;
+	entityStore.velocityX[slot] = entity->velocity.x;
+	entityStore.velocityY[slot] = entity->velocity.y;
+	entityStore.velocityZ[slot] = entity->velocity.z;
+	entityStore.orientationX[slot] = entity->orientation.x;
+	entityStore.orientationY[slot] = entity->orientation.y;
+	entityStore.orientationZ[slot] = entity->orientation.z;
+	entityStore.orientationW[slot] = entity->orientation.w;
+	// Rates of turn rarely change, so the quaternion formed from them is kept rather than recalculated every frame
+	Blah_Quaternion_formatEuler(&spin, entity->rotationAxisX, entity->rotationAxisY, entity->rotationAxisZ);
+	entityStore.spinX[slot] = spin.x;
+	entityStore.spinY[slot] = spin.y;
+	entityStore.spinZ[slot] = spin.z;
+	entityStore.spinW[slot] = spin.w;
+}
@@ -0,0 +1,59 @@
+/* blah_entity_store.h
+	The entity store holds the transform state of batched entities in contiguous arrays, one per
+	component (structure of arrays), so that all of them can be integrated in a single vectorised pass
+	each frame instead of one at a time through the entity list.
+	Batching is opt-in per entity with Blah_Entity_setBatched.  The Blah_Entity structure remains the
+	handle for a batched entity and its location, orientation and matrix are written back to it after
+	each pass, so drawing, collision and the rest of the entity API are unaffected.  The store is kept
+	up to date by the Blah_Entity set functions; code writing entity fields directly must call
+	blah_entity_store_syncEntity afterwards.
+	Move functions of batched entities are called for all of them before the batched pass, ahead of
+	the processing of the entity list. */
+
+#ifndef _BLAH_ENTITY_STORE
+
+#define _BLAH_ENTITY_STORE
+
+#include <stddef.h>
+
+#include "blah_types.h"
+
+/* Forward Declarations */
+
+struct Blah_Entity;
+
+/* Function Prototypes */
+
+#ifdef __cplusplus
+	extern "C" {
+#endif //__cplusplus
+
+void blah_entity_store_addEntity(struct Blah_Entity* entity);
+	//Adds the given entity to the store, copying its current transform state
+
+void blah_entity_store_destroyAll();
+	//Releases all memory held by the store.  Entities still in the store are removed from it.
+
+size_t blah_entity_store_getCount();
+	//Returns the number of entities in the store
+
+void blah_entity_store_integrate();
+	//Advances all stored entities by one frame.  Translates each location by its velocity and
+	//rotates each orientation by its rates of turn, then writes location, orientation and
+	//matrix back to the entity structures.
+
+void blah_entity_store_process();
+	//Calls the move function of every stored entity, then integrates all stored entities
+
+void blah_entity_store_removeEntity(struct Blah_Entity* entity);
+	//Removes the given entity from the store.  Has no effect if the entity is not stored.
+
+void blah_entity_store_syncEntity(struct Blah_Entity* entity);
+	//Copies the transform state of the given entity into the store.  Has no effect if the entity
+	//is not stored.
+
+#ifdef __cplusplus
+	}
+#endif //__cplusplus
+
+#endif
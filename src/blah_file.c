@@ -1,10 +1,20 @@
 /* blah_file.c
 	Defines common functions on files, using standard FILE* */
 
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200112L //For memory mapping
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include "blah_file.h"
 #include "blah_types.h"
@@ -13,11 +23,69 @@
 
 /* Private Function Prototypes */
 
+bool blah_file_hash(const char *filename, uint64_t *hash)
+{	// Stores a hash of the whole contents of the named file in *hash.  Returns false if the file could not be read.
+	size_t length;
+	const void *data = blah_file_map(filename, &length);
+
+	if (data == NULL) {
+		FILE *file = blah_file_open(filename, "rb"); //Empty files map to NULL but still exist
+		if (file == NULL) { return false; }
+		fclose(file);
+	}
+	*hash = blah_util_hash64(data, length);
+	blah_file_unmap(data, length);
+	return true;
+}
+
+const void *blah_file_map(const char *filename, size_t *length)
+{	// Maps the whole of the named file into memory for reading, storing its length in *length.
+	// Returns pointer to the read only file contents, or NULL on error or if the file is empty.
+	void *data = NULL;
+	*length = 0;
+#ifndef _WIN32
+	char osFilename[200];
+	struct stat fileStat;
+	int fileDescriptor;
+
+	blah_util_strncpy(osFilename, filename, blah_countof(osFilename) - 1);
+	blah_util_stringReplaceChar(osFilename, '\\', '/');
+	fileDescriptor = open(osFilename, O_RDONLY);
+	if (fileDescriptor < 0) { return NULL; }
+	if (fstat(fileDescriptor, &fileStat) == 0 && fileStat.st_size > 0) {
+		data = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		if (data == MAP_FAILED) {
+			data = NULL;
+		} else {
+			*length = (size_t)fileStat.st_size;
+			posix_madvise(data, *length, POSIX_MADV_SEQUENTIAL); //Contents are normally parsed front to back
+		}
+	}
+	close(fileDescriptor); //Mapping remains valid after the descriptor is closed
+#else
+	FILE *file = blah_file_open(filename, "rb");
+	long fileLength;
+
+	if (file == NULL) { return NULL; }
+	if (fseek(file, 0, SEEK_END) == 0 && (fileLength = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0) {
+		data = malloc((size_t)fileLength);
+		if (data != NULL && fread(data, (size_t)fileLength, 1, file) == 1) {
+			*length = (size_t)fileLength;
+		} else {
+			free(data);
+			data = NULL;
+		}
+	}
+	fclose(file);
+#endif
+	return data;
+}
+
 FILE *blah_file_open(const char *filename, const char* mode)
 {	// Simplifies opening files across different platforms.  Calls fopen()
 	// Parameters have same purpose as in fopen()
 	char osFilename[200];
-    blah_util_strncpy(osFilename, filename, blah_countof(osFilename));
+    blah_util_strncpy(osFilename, filename, blah_countof(osFilename) - 1);
 	blah_util_stringReplaceChar(osFilename, '\\', '/');
 	// change backslashes to forward slashes
 	return fopen(osFilename, mode);
@@ -27,8 +95,24 @@ bool blah_file_readX86(FILE* fileStream, void* dest, int byteLength);
 	// Reads a binary number of size 'byteLength' bytes into 'dest'
 	// and reverses it for x86 compatible registers.  Returns true on success, false error.
 
+size_t blah_file_getRemainingLength(FILE *file);
+	// Returns the number of bytes from the current position to the end of the stream,
+	// or SIZE_MAX if the stream cannot seek
+
 /* Private Function Definitions */
 
+size_t blah_file_getRemainingLength(FILE *file)
+{	// Returns the number of bytes from the current position to the end of the stream,
+	// or SIZE_MAX if the stream cannot seek
+	const long position = ftell(file);
+	long length;
+
+	if (position < 0 || fseek(file, 0, SEEK_END) != 0) { return SIZE_MAX; }
+	length = ftell(file);
+	if (fseek(file, position, SEEK_SET) != 0 || length < position) { return SIZE_MAX; }
+	return (size_t)(length - position);
+}
+
 bool blah_file_readX86(FILE* fileStream, void* dest, int byteLength)
 {	// Reads a binary number of size 'byteLength' bytes into 'dest'
 	// and reverses it for x86 compatible registers.  Returns true on success, false error.
@@ -95,3 +179,199 @@ bool blah_file_readUnsigned32(FILE *file, blah_unsigned32 *dest)
 	// Returns true on succes, false on error
 	return blah_file_readX86(file, dest, 4);
 }
+
+void blah_file_unmap(const void *data, size_t length)
+{	// Releases file contents mapped by blah_file_map(), given the length it returned
+	if (data == NULL) { return; }
+#ifndef _WIN32
+	munmap((void*)data, length);
+#else
+	(void)length;
+	free((void*)data);
+#endif
+}
+
+/* File Reader Function Definitions */
+
+void Blah_File_Reader_close(Blah_File_Reader *reader)
+{	// Releases the buffer or mapping of the reader and closes the file if the reader opened it
+	if (reader->ownsFile && reader->file != NULL) { fclose(reader->file); }
+	free(reader->buffer);
+	blah_file_unmap(reader->mapping, reader->mappingLength);
+	Blah_File_Reader_initMemory(reader, NULL, 0);
+}
+
+bool Blah_File_Reader_fill(Blah_File_Reader *reader, size_t count)
+{	// Makes at least 'count' bytes available in memory, moving unread bytes to the start
+	// of the buffer and refilling the rest of it from the stream
+	size_t available = (size_t)(reader->end - reader->current);
+
+	if (available >= count) { return true; }
+	if (reader->file == NULL) { return false; } //All data is already in memory
+
+	reader->offset += (size_t)(reader->current - reader->start);
+	reader->start = reader->current;
+	if (reader->offset > reader->streamLength || count > reader->streamLength - reader->offset) {
+		return false; //Not enough left in the file, so don't grow the buffer for a corrupt length
+	}
+	if (available > 0) { memmove(reader->buffer, reader->current, available); }
+	if (count > reader->bufferSize) { //Grow buffer to hold the whole of a large view
+		blah_unsigned8 *newBuffer = realloc(reader->buffer, count);
+		if (newBuffer == NULL) { return false; }
+		reader->buffer = newBuffer;
+		reader->bufferSize = count;
+	}
+	available += fread(reader->buffer + available, 1, reader->bufferSize - available, reader->file);
+	reader->start = reader->current = reader->buffer;
+	reader->end = reader->buffer + available;
+	return available >= count;
+}
+
+size_t Blah_File_Reader_getOffset(const Blah_File_Reader *reader)
+{	// Returns the current read position, as a byte offset from the start of the reader's data
+	return reader->offset + (size_t)(reader->current - reader->start);
+}
+
+bool Blah_File_Reader_getView(Blah_File_Reader *reader, size_t length, Blah_File_Reader *view)
+{	// Initialises view as a reader of the next 'length' bytes, and moves the reader past them
+	const blah_unsigned8 *bytes = Blah_File_Reader_take(reader, length);
+
+	if (bytes == NULL) { return false; }
+	Blah_File_Reader_initMemory(view, bytes, length);
+	return true;
+}
+
+void Blah_File_Reader_initMemory(Blah_File_Reader *reader, const void *data, size_t length)
+{	// Initialises a reader of 'length' bytes at 'data'
+	reader->start = reader->current = data;
+	reader->end = data ? reader->start + length : NULL;
+	reader->offset = 0;
+	reader->file = NULL;
+	reader->streamLength = 0;
+	reader->buffer = NULL;
+	reader->bufferSize = 0;
+	reader->mapping = NULL;
+	reader->mappingLength = 0;
+	reader->ownsFile = false;
+}
+
+bool Blah_File_Reader_initStream(Blah_File_Reader *reader, FILE *file, size_t bufferSize)
+{	// Initialises a reader of an open stream, read through a buffer of 'bufferSize' bytes
+	Blah_File_Reader_initMemory(reader, NULL, 0);
+	reader->buffer = malloc(bufferSize ? bufferSize : 1);
+	if (reader->buffer == NULL) { return false; }
+	reader->file = file;
+	reader->streamLength = blah_file_getRemainingLength(file);
+	reader->bufferSize = bufferSize ? bufferSize : 1;
+	reader->start = reader->current = reader->end = reader->buffer;
+	return true;
+}
+
+bool Blah_File_Reader_isEnd(Blah_File_Reader *reader)
+{	// Returns true if there are no more bytes to read
+	return reader->current == reader->end && !Blah_File_Reader_fill(reader, 1);
+}
+
+bool Blah_File_Reader_open(Blah_File_Reader *reader, const char *name, blah_file_reader_backend backend)
+{	// Opens the named file for reading with the given backend.  Returns false if it could not be opened.
+	if (backend == BLAH_FILE_READER_MAPPED) {
+		size_t length;
+		const void *data = blah_file_map(name, &length);
+
+		if (data == NULL) { return false; }
+		Blah_File_Reader_initMemory(reader, data, length);
+		reader->mapping = data;
+		reader->mappingLength = length;
+		return true;
+	} else {
+		FILE *file = blah_file_open(name, "rb");
+
+		if (file == NULL) { return false; }
+		if (!Blah_File_Reader_initStream(reader, file, BLAH_FILE_READER_BUFFER_SIZE)) {
+			fclose(file);
+			return false;
+		}
+		reader->ownsFile = true;
+		return true;
+	}
+}
+
+bool Blah_File_Reader_read(Blah_File_Reader *reader, void *dest, size_t count)
+{	// Copies the next 'count' bytes to dest.  Returns false if fewer remain, consuming what is left.
+	size_t available = (size_t)(reader->end - reader->current);
+
+	if (available >= count) {
+		if (count > 0) { memcpy(dest, reader->current, count); }
+		reader->current += count;
+		return true;
+	}
+	if (available > 0) { //Copy what is in memory, then read the rest from the stream
+		memcpy(dest, reader->current, available);
+		reader->current += available;
+		dest = (blah_unsigned8*)dest + available;
+		count -= available;
+	}
+	if (reader->file == NULL) { return false; }
+	if (count >= reader->bufferSize) { //Large reads go straight into dest rather than through the buffer
+		const size_t readCount = fread(dest, 1, count, reader->file);
+		reader->offset += (size_t)(reader->current - reader->start) + readCount;
+		reader->start = reader->current = reader->end = reader->buffer;
+		return readCount == count;
+	}
+	if (!Blah_File_Reader_fill(reader, count)) {
+		available = (size_t)(reader->end - reader->current);
+		memcpy(dest, reader->current, available);
+		reader->current += available;
+		return false;
+	}
+	memcpy(dest, reader->current, count);
+	reader->current += count;
+	return true;
+}
+
+char *Blah_File_Reader_readString(Blah_File_Reader *reader, size_t maxLength)
+{	// Reads a null terminated string of at most maxLength characters, returning an allocated copy or NULL
+	const size_t limit = maxLength + 1; //Characters and the null
+	const blah_unsigned8 *terminator = NULL;
+	size_t available = (size_t)(reader->end - reader->current), searchLength, length;
+	char *newString;
+
+	for (;;) {
+		searchLength = available < limit ? available : limit;
+		if (searchLength > 0) { terminator = memchr(reader->current, '\0', searchLength); }
+		if (terminator != NULL || searchLength == limit || reader->file == NULL) { break; }
+		Blah_File_Reader_fill(reader, limit); //Bring in up to the whole string limit
+		if ((size_t)(reader->end - reader->current) == available) { break; } //End of stream
+		available = (size_t)(reader->end - reader->current);
+	}
+	if (terminator == NULL) { return NULL; }
+
+	length = (size_t)(terminator - reader->current) + 1;
+	newString = malloc(length);
+	if (newString != NULL) {
+		memcpy(newString, reader->current, length);
+		reader->current += length;
+	}
+	return newString;
+}
+
+bool Blah_File_Reader_skip(Blah_File_Reader *reader, size_t count)
+{	// Moves the reader forward 'count' bytes.  Returns false if fewer remain, skipping all of them.
+	size_t available = (size_t)(reader->end - reader->current);
+
+	if (available >= count) {
+		reader->current += count;
+		return true;
+	}
+	reader->current = reader->end;
+	count -= available;
+	if (reader->file == NULL) { return false; }
+	while (count > 0) { //Read through the bytes, rather than seek, so that skipping past the end is detected
+		if (!Blah_File_Reader_fill(reader, 1)) { return false; }
+		available = (size_t)(reader->end - reader->current);
+		if (available > count) { available = count; }
+		reader->current += available;
+		count -= available;
+	}
+	return true;
+}
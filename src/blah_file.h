@@ -2,7 +2,11 @@
 	Defines common functions on files, using standard FILE*
 	These functions work on the assumption that the processor is an Intel
 	x86 compatible and that the binary values are ordered with least significant
-	last.  Intel values are stored in reverse order in memory.	*/
+	last.  Intel values are stored in reverse order in memory.
+	File readers (Blah_File_Reader) read binary files in blocks rather than a value at a time.  A reader
+	either maps the whole file into memory or reads it through a large buffer, and offers typed reads
+	of either byte order, which are inlined while the bytes are already in memory.  Views are readers
+	limited to a range of another reader's bytes, such as a chunk of an IFF file.	*/
 
 
 #ifndef _BLAH_FILE
@@ -12,7 +16,33 @@
 #define BLAH_FILE_MODE_OVERWRITE "w"
 
 #include "blah_types.h"
+#include <stddef.h>
 #include <stdio.h>
+#include <string.h>
+
+/* Definitions */
+
+#define BLAH_FILE_READER_BUFFER_SIZE 65536	//Default buffer size of buffered readers, in bytes
+
+/* Type Definitions */
+
+typedef enum Blah_File_Reader_Backend {BLAH_FILE_READER_MAPPED, BLAH_FILE_READER_BUFFERED} blah_file_reader_backend;
+
+/* Structure Definitions */
+
+typedef struct Blah_File_Reader {
+	const blah_unsigned8 *current;	//Next byte to read
+	const blah_unsigned8 *end;		//End of the bytes held in memory
+	const blah_unsigned8 *start;	//First byte held in memory, found at 'offset' in the data
+	size_t offset;
+	FILE *file;						//Stream the buffer is filled from, NULL if all data is held in memory
+	size_t streamLength;			//Bytes from the reader's start to the end of the stream, SIZE_MAX if unknown
+	blah_unsigned8 *buffer;			//Allocated buffer of a stream reader
+	size_t bufferSize;
+	const void *mapping;			//File mapped by the reader, NULL if none
+	size_t mappingLength;
+	bool ownsFile;					//If true, file is closed with the reader
+} Blah_File_Reader;
 
 #ifdef __cplusplus
 	extern "C" {
@@ -21,6 +51,16 @@
 
 /* Function Prototypes */
 
+// Stores a hash of the whole contents of the named file in *hash, see blah_util_hash64().
+// Returns false if the file could not be read.  An empty file hashes the same as no contents.
+bool blah_file_hash(const char* name, uint64_t* hash);
+
+// Maps the whole of the named file into memory for reading, storing its length in *length.
+// Returns pointer to the read only file contents, or NULL on error or if the file is empty.
+// Where memory mapping is not available the file is read into an allocated buffer instead.
+// The contents must be released with blah_file_unmap().
+const void* blah_file_map(const char* name, size_t* length);
+
 // Simplifies opening files across different platforms.  Calls fopen()
 // Parameters have same purpose as in fopen()
 FILE* blah_file_open(const char* name, const char* mode);
@@ -49,6 +89,122 @@ bool blah_file_readUnsigned32(FILE *file, blah_unsigned32 *dest);
 // Returns pointer to allocated string on success, null on error.
 char *blah_file_readString(FILE *file);
 
+// Releases file contents mapped by blah_file_map(), given the length it returned
+void blah_file_unmap(const void* data, size_t length);
+
+/* File Reader Function Prototypes */
+
+// Releases the buffer or mapping of the reader and closes the file if the reader opened it.
+// Views need not be closed.
+void Blah_File_Reader_close(Blah_File_Reader *reader);
+
+// Makes at least 'count' bytes from the current position available contiguously in memory,
+// reading more of the stream if needed.  Returns false if the data ends first, failing before
+// growing the buffer if fewer than 'count' bytes are left in the stream.
+// Called by the inline read functions when the bytes they need are not yet in memory.
+bool Blah_File_Reader_fill(Blah_File_Reader *reader, size_t count);
+
+// Returns the current read position, as a byte offset from the start of the reader's data
+size_t Blah_File_Reader_getOffset(const Blah_File_Reader *reader);
+
+// Initialises 'view' as a reader of the next 'length' bytes of the reader, and moves the reader past
+// them.  The view reads from memory, so it remains valid until the next read from 'reader'.
+// Returns false, without moving the reader, if fewer than 'length' bytes remain.
+bool Blah_File_Reader_getView(Blah_File_Reader *reader, size_t length, Blah_File_Reader *view);
+
+// Initialises a reader of 'length' bytes at 'data', which must remain valid while it is used
+void Blah_File_Reader_initMemory(Blah_File_Reader *reader, const void *data, size_t length);
+
+// Initialises a reader of an open stream, read through a buffer of 'bufferSize' bytes.
+// The stream is not closed with the reader.  Returns false if the buffer could not be allocated.
+bool Blah_File_Reader_initStream(Blah_File_Reader *reader, FILE *file, size_t bufferSize);
+
+// Returns true if there are no more bytes to read
+bool Blah_File_Reader_isEnd(Blah_File_Reader *reader);
+
+// Opens the named file for reading with the given backend.  Returns false if it could not be opened.
+// Empty files can only be opened buffered.
+bool Blah_File_Reader_open(Blah_File_Reader *reader, const char *name, blah_file_reader_backend backend);
+
+// Copies the next 'count' bytes to 'dest'.  Returns false if fewer remain, in which case what is left is consumed.
+bool Blah_File_Reader_read(Blah_File_Reader *reader, void *dest, size_t count);
+
+// Reads a null terminated string of at most 'maxLength' characters, and the null.  Returns an
+// allocated copy, or NULL without moving the reader if no null is found within maxLength + 1 bytes.
+char *Blah_File_Reader_readString(Blah_File_Reader *reader, size_t maxLength);
+
+// Moves the reader forward 'count' bytes.  Returns false if fewer remain, in which case all are skipped.
+bool Blah_File_Reader_skip(Blah_File_Reader *reader, size_t count);
+
+// Returns a pointer to the next 'count' bytes in memory and moves past them, or NULL without moving
+// if fewer remain.  The bytes remain valid until the next read from the reader.
+static inline const blah_unsigned8 *Blah_File_Reader_take(Blah_File_Reader *reader, size_t count)
+{
+	const blah_unsigned8 *bytes = reader->current;
+	if ((size_t)(reader->end - bytes) < count) {
+		if (!Blah_File_Reader_fill(reader, count)) { return NULL; }
+		bytes = reader->current;
+	}
+	reader->current = bytes + count;
+	return bytes;
+}
+
+// Typed reads, from most significant byte first (Big) or least significant byte first (Little) data.
+// Each returns false if the value extends beyond the end of the data.
+
+static inline bool Blah_File_Reader_readUnsigned8(Blah_File_Reader *reader, blah_unsigned8 *dest)
+{
+	const blah_unsigned8 *bytes = Blah_File_Reader_take(reader, 1);
+	if (bytes == NULL) { return false; }
+	*dest = bytes[0];
+	return true;
+}
+
+static inline bool Blah_File_Reader_readBigUnsigned16(Blah_File_Reader *reader, blah_unsigned16 *dest)
+{
+	const blah_unsigned8 *bytes = Blah_File_Reader_take(reader, 2);
+	if (bytes == NULL) { return false; }
+	*dest = (blah_unsigned16)((bytes[0] << 8) | bytes[1]);
+	return true;
+}
+
+static inline bool Blah_File_Reader_readBigInt16(Blah_File_Reader *reader, blah_int16 *dest)
+{
+	return Blah_File_Reader_readBigUnsigned16(reader, (blah_unsigned16*)dest);
+}
+
+static inline bool Blah_File_Reader_readBigUnsigned32(Blah_File_Reader *reader, blah_unsigned32 *dest)
+{
+	const blah_unsigned8 *bytes = Blah_File_Reader_take(reader, 4);
+	if (bytes == NULL) { return false; }
+	*dest = ((blah_unsigned32)bytes[0] << 24) | ((blah_unsigned32)bytes[1] << 16) | ((blah_unsigned32)bytes[2] << 8) | bytes[3];
+	return true;
+}
+
+static inline bool Blah_File_Reader_readBigFloat32(Blah_File_Reader *reader, blah_float32 *dest)
+{
+	blah_unsigned32 bits;
+	if (!Blah_File_Reader_readBigUnsigned32(reader, &bits)) { return false; }
+	memcpy(dest, &bits, sizeof(bits));
+	return true;
+}
+
+static inline bool Blah_File_Reader_readLittleUnsigned16(Blah_File_Reader *reader, blah_unsigned16 *dest)
+{
+	const blah_unsigned8 *bytes = Blah_File_Reader_take(reader, 2);
+	if (bytes == NULL) { return false; }
+	*dest = (blah_unsigned16)(bytes[0] | (bytes[1] << 8));
+	return true;
+}
+
+static inline bool Blah_File_Reader_readLittleUnsigned32(Blah_File_Reader *reader, blah_unsigned32 *dest)
+{
+	const blah_unsigned8 *bytes = Blah_File_Reader_take(reader, 4);
+	if (bytes == NULL) { return false; }
+	*dest = bytes[0] | ((blah_unsigned32)bytes[1] << 8) | ((blah_unsigned32)bytes[2] << 16) | ((blah_unsigned32)bytes[3] << 24);
+	return true;
+}
+
 #ifdef __cplusplus
 	}
 #endif //__cplusplus
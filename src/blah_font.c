@@ -114,6 +114,10 @@ void Blah_Font_printString2d(const Blah_Font* font, const char* text, int x, int
 	char tempChar = *charPointer;  // get first character in string
 	int xPos = x;
 
+	if (font->type == BLAH_FONT_TEXTURE) { //Texture fonts draw the whole string at once
+		Blah_Font_Texture_printString2d(font, text, x, y);
+		return;
+	}
 	while (tempChar) {  //loop until NULL char encountered
 		if (tempChar == '\n') { //if current character is a new line,
 			xPos = x;
@@ -3,15 +3,80 @@
 
 #include <malloc.h>
 #include <string.h>
+#include <errno.h>
 
 #include "blah_font_texture.h"
+#include "blah_atlas.h"
 #include "blah_debug.h"
 #include "blah_material.h"
 #include "blah_draw.h"
+#include "blah_error.h"
 #include "blah_macros.h"
 
+/* Static Globals - Private to font_texture.c */
+
+static Blah_Draw_Vertex2d *glyphVertices = NULL;	//Corners of glyphs waiting to be drawn, four per glyph
+static size_t glyphCount = 0, glyphCapacity = 0;
+static const Blah_Texture *glyphTexture = NULL;	//Texture shared by the glyphs waiting to be drawn
+static Blah_Material glyphMaterial;	//White, so glyphs show the colours of their texture
+static bool glyphMaterialReady = false;
+
+/* Static Function Definitions */
+
+static void Blah_Font_Texture_appendChar2d(const Blah_Font_Texture *font, char singleChar, int x, int y)
+{	//Adds the quad of a character to the glyph batch, growing it if required.  The batch must
+	//already be set to the texture of the font.
+	const Blah_Texture_Map *texMap = font->charMaps[(unsigned char)singleChar];
+	if (texMap != NULL) {
+		const float coordLeft = x, coordRight = x + (font->fontBase.width - 1);
+		const float coordBottom = y, coordTop = y + (font->fontBase.height - 1);
+		Blah_Draw_Vertex2d *vertex;
+
+		if (glyphCount == glyphCapacity) {
+			const size_t newCapacity = glyphCapacity ? glyphCapacity * 2 : 256;
+			Blah_Draw_Vertex2d *newVertices = realloc(glyphVertices, newCapacity * 4 * sizeof(Blah_Draw_Vertex2d));
+			if (newVertices == NULL) { blah_error_raise(errno, "Failed to grow glyph batch to %lu characters", (unsigned long)newCapacity); }
+			glyphVertices = newVertices;
+			glyphCapacity = newCapacity;
+		}
+		vertex = &glyphVertices[glyphCount++ * 4];
+		//Corners in the same order as the character mapping: top left, top right, bottom right, bottom left
+		vertex[0].location[0] = vertex[3].location[0] = coordLeft;
+		vertex[1].location[0] = vertex[2].location[0] = coordRight;
+		vertex[0].location[1] = vertex[1].location[1] = coordTop;
+		vertex[2].location[1] = vertex[3].location[1] = coordBottom;
+		for (int corner = 0; corner < 4; corner++) {
+			vertex[corner].texCoord[0] = texMap->mapping[corner].x;
+			vertex[corner].texCoord[1] = texMap->mapping[corner].y;
+		}
+	}
+}
+
+static void Blah_Font_Texture_beginGlyphs(const Blah_Font_Texture *font)
+{	//Prepares the glyph batch for characters of the font, drawing waiting glyphs of another texture first
+	if (glyphCount > 0 && glyphTexture != font->fontTexture) { blah_font_texture_flush(); }
+	glyphTexture = font->fontTexture;
+}
+
 /* Texture Font Functions */
 
+void Blah_Font_Texture_appendString2d(const Blah_Font_Texture *font, const char *text, int x, int y)
+{	// Adds a text string in the given font at supplied screen coordinates to the glyph batch,
+	// to be drawn by blah_font_texture_flush.  New line characters start a new line below.
+	int xPos = x;
+
+	Blah_Font_Texture_beginGlyphs(font);
+	for (const char *charPointer = text; *charPointer; charPointer++) {
+		if (*charPointer == '\n') { //if current character is a new line,
+			xPos = x;
+			y -= font->fontBase.height;
+		} else {
+			Blah_Font_Texture_appendChar2d(font, *charPointer, xPos, y);
+			xPos += font->fontBase.width; //advance to position for next character
+		}
+	}
+}
+
 void Blah_Font_Texture_destroy(Blah_Font_Texture *font)
 {	// Frees any allocated memory occupied by the texture font structure and destroys it
 	Blah_Font_Texture_disable(font); // Deallocate internal dynamically allocated resources
@@ -26,7 +91,11 @@ void Blah_Font_Texture_disable(Blah_Font_Texture *font)
 		if (font->charMaps[mapCount]) {	Blah_Texture_Map_destroy(font->charMaps[mapCount]); }
 	}
 
-	Blah_Texture_destroy(font->fontTexture);  //Destroy the texture which this font uses.
+	if (font->atlasEntry) {
+		Blah_Atlas_removeEntry(blah_atlas_getShared(), font->atlasEntry); //Release font image from shared atlas
+	} else {
+		Blah_Texture_destroy(font->fontTexture);  //Destroy the texture which this font uses.
+	}
 }
 
 bool Blah_Font_Texture_init(Blah_Font_Texture *font, const char *fontName, const Blah_Image *source,
@@ -50,10 +119,15 @@ bool Blah_Font_Texture_init(Blah_Font_Texture *font, const char *fontName, const
 	const unsigned int charsNum = charsHigh * charsWide;
 
 	Blah_Font_init(&font->fontBase, BLAH_FONT_TEXTURE, fontName, source, charWidth, charHeight);  // assign basic font properties
-	Blah_Texture* const fontTexture = Blah_Texture_fromImage(source); // Create new texture from source image
+	// Pack source image into the shared atlas, so that text in different fonts is drawn from one texture.
+	// Images too large for an atlas page get a texture of their own.
+	font->atlasEntry = Blah_Atlas_addImage(blah_atlas_getShared(), source);
+	if (font->atlasEntry) { Blah_Atlas_update(blah_atlas_getShared()); }
+	Blah_Texture* const fontTexture = font->atlasEntry ? font->atlasEntry->texture : Blah_Texture_fromImage(source); // Create new texture from source image
 	if (fontTexture) // Check that texture creation succeeded, then create character mappings
 	{
 		font->fontTexture = fontTexture;
+		Blah_Texture_setPinned(fontTexture, true); // Text must stay sharp however rarely it is drawn
 		memset(font->charMaps, 0, sizeof(font->charMaps)); // Zero out array of texture map pointers
 
 		Blah_Point coords[4];
@@ -79,6 +153,9 @@ bool Blah_Font_Texture_init(Blah_Font_Texture *font, const char *fontName, const
 				coords[0].y = coords[1].y = coordTop;
 				coords[2].y = coords[3].y = coordBottom;
 				coords[0].z = coords[1].z = coords[2].z = coords[3].z = 0;
+				if (font->atlasEntry) { //Move coordinates into the region of the atlas holding the source image
+					for (int coordIndex = 0; coordIndex < 4; coordIndex++) { Blah_Atlas_Entry_mapPoint(font->atlasEntry, &coords[coordIndex]); }
+				}
 				Blah_Texture_Map *newMap = Blah_Texture_Map_new(font->fontTexture, tempMapping); // Create new texture mapping for font character
 				if (newMap) {
                     font->charMaps[charCount] = newMap; // If mapping was created ok, assign the mapping for current character
@@ -122,31 +199,34 @@ Blah_Font_Texture* Blah_Font_Texture_new(const char* fontName, const Blah_Image*
 	return newFont;
 }
 
+void blah_font_texture_flush()
+{	// Draws the characters waiting in the glyph batch with a single draw call, and empties the batch
+	if (glyphCount > 0) {
+		if (!glyphMaterialReady) {
+			Blah_Material_init(&glyphMaterial);
+			Blah_Material_setColour(&glyphMaterial, 1,1,1,1);
+			glyphMaterialReady = true;
+		}
+		blah_draw_quads2d(glyphVertices, glyphCount, glyphTexture, &glyphMaterial);
+		glyphCount = 0;
+	}
+}
+
 // Prints a single text character using the given font at supplied screen
 // coordinates, in 2D mode.  Text is rendered in 3D mode to appear as 2D.
 void Blah_Font_Texture_printChar2d(const Blah_Font_Texture* font, char singleChar, int x, int y)
 {
-	Blah_Texture_Map *texMap = font->charMaps[(unsigned char)singleChar];
-	if (texMap != NULL) {
-        int coordLeft = x;
-        int coordRight = x + (font->fontBase.width - 1);
-        int coordBottom = y; int coordTop = y + (font->fontBase.height - 1);
-        Blah_Vertex vertices[4] = { {{coordLeft, coordTop, 0}, {0,0,1}},
-            {{coordRight, coordTop, 0}, {0,0,1}}, {{coordRight, coordBottom, 0}, {0,0,1}},
-            {{coordLeft, coordBottom, 0}, {0,0,1}} };
-        Blah_Vertex *vertexArray[5] = {&vertices[0], &vertices[1], &vertices[2], &vertices[3], NULL};
-
-        Blah_Material mat;
-        Blah_Material_setColour(&mat, 1,1,1,1);
-        blah_draw_polygon2d(vertexArray,texMap,&mat);
-    }
+	Blah_Font_Texture_beginGlyphs(font);
+	Blah_Font_Texture_appendChar2d(font, singleChar, x, y);
+	blah_font_texture_flush();
 }
 
 void Blah_Font_Texture_printString2d(const Blah_Font* font, const char* text, int x, int y)
 {
-    // TODO
     //Prints a text string using the given font at supplied screen coordinates,
-	//in 2D mode.  Text is not rendered in 3D mode.
+	//in 2D mode, drawing all its characters with a single draw call.
+	Blah_Font_Texture_appendString2d((const Blah_Font_Texture*)font, text, x, y);
+	blah_font_texture_flush();
 }
 
 void Blah_Font_Texture_printChar3d(const Blah_Font* font, char singleChar, const Blah_Matrix* matrix)
@@ -15,11 +15,16 @@
 
 /* Type Definitions */
 
+/* Forward Declarations */
+
+struct Blah_Atlas_Entry;
+
 /* Structure Definitions */
 
 typedef struct Blah_Font_Texture {
 	Blah_Font fontBase;
 	Blah_Texture* fontTexture; // Pointer to the texture to be used to render font
+	struct Blah_Atlas_Entry* atlasEntry; // Region of the shared atlas holding the font image, or NULL if fontTexture is its own
 	Blah_Texture_Map *charMaps[BLAH_FONT_NUM_CHARS]; // Texture coordinate mappings for each character from 0 to 255
 } Blah_Font_Texture;
 
@@ -29,6 +34,12 @@ typedef struct Blah_Font_Texture {
 	extern "C" {
 #endif //__cplusplus
 
+void Blah_Font_Texture_appendString2d(const Blah_Font_Texture* font, const char* text, int x, int y);
+	// Adds a text string in the given font at supplied screen coordinates, relative to the current
+	// drawport, to the glyph batch.  Characters of fonts sharing a texture, such as those in the
+	// shared atlas, collect in the batch until blah_font_texture_flush draws them all at once.
+	// Adding text of a font with another texture draws the batch first.
+
 void Blah_Font_Texture_destroy(Blah_Font_Texture* font);
 	// Frees any allocated memory occupied by the texture font structure and destroys it
 
@@ -46,6 +57,10 @@ bool Blah_Font_Texture_init(Blah_Font_Texture* font, const char* fontName, const
 	// This function implictly adds to the internal font tree.
 	// Returns TRUE on success, or FALSE on error.
 
+void blah_font_texture_flush();
+	// Draws the characters waiting in the glyph batch with a single draw call.  Must be called
+	// before the drawport they were added in changes.
+
 Blah_Font_Texture* Blah_Font_Texture_new(const char* fontName, const Blah_Image* source, const unsigned int charMap[BLAH_FONT_NUM_CHARS], int charWidth, int charHeigth);
 	// Creates a new textured font structure from source image using index char map
 	// and given width and height of each character.  Width and height of source
@@ -59,7 +74,7 @@ void Blah_Font_Texture_printChar2d(const Blah_Font_Texture* font, char singleCha
 
 void Blah_Font_Texture_printString2d(const Blah_Font* font, const char* text, int x, int y);
 	// Prints a text string using the given font at supplied screen coordinates,
-	// in 2D mode.  Text is not rendered in 3D mode.
+	// in 2D mode, drawing all its characters with a single draw call.
 
 void Blah_Font_Texture_printChar3d(const Blah_Font* font, char singleChar, const Blah_Matrix* matrix);
 	// Prints a single text character using the given font with orientation and position
@@ -12,6 +12,26 @@
 #include "blah_types.h"
 #include "blah_util.h"
 
+/* Private Function Declarations */
+
+static bool Blah_IFF_exhaust(Blah_File_Reader *view)
+{	//Skips all remaining data of a chunk or subchunk view, so that loops reading until the
+	//end of it terminate after a failed read.  Always returns false.
+	Blah_File_Reader_skip(view, (size_t)(view->end - view->current)); //Views are held in memory
+	return false;
+}
+
+static bool Blah_IFF_getView(Blah_File_Reader *reader, size_t dataLength, Blah_File_Reader *view, bool *padBytePresent)
+{	//Takes a view of data of given length from reader, and the pad byte following odd lengths
+	//if present.  A missing pad byte at the very end of the data is tolerated.
+	if ((dataLength & 1) && Blah_File_Reader_getView(reader, dataLength + 1, view)) {
+		*padBytePresent = true;
+		return true;
+	}
+	*padBytePresent = false;
+	return Blah_File_Reader_getView(reader, dataLength, view);
+}
+
 /* Public Function Declarations */
 
 void Blah_IFF_Chunk_destroy(Blah_IFF_Chunk *chunk)
@@ -19,41 +39,43 @@ void Blah_IFF_Chunk_destroy(Blah_IFF_Chunk *chunk)
 	free(chunk);
 }
 
-bool Blah_IFF_Chunk_get(Blah_IFF_Chunk *chunk, FILE *file)
-{	//Discards current settings of given chunk object and connects it to the specified
-	//file pointer.  Returns 0/false on error, 1/true on success
-
-	blah_unsigned32 chunkId, dataLength;
+bool Blah_IFF_Chunk_get(Blah_IFF_Chunk *chunk, Blah_File_Reader *reader)
+{	//Discards current settings of given chunk object and connects it to the next chunk
+	//of the reader.  Returns 0/false on error, 1/true on success
+	const blah_unsigned8 *header = Blah_File_Reader_take(reader, 4);
+	blah_unsigned32 dataLength;
 
-	fread(&chunkId, 4, 1, file); //Read 4 byte chunk_id tag into variable
-	blah_file_readUnsigned32(file, &dataLength); //Get chunk length
+	if (header == NULL) { return false; }
+	memcpy(&chunk->idTag, header, 4); //Tag is kept in file byte order, to compare with four character constants
+	if (!Blah_File_Reader_readBigUnsigned32(reader, &dataLength)) { return false; }
+	if (!Blah_IFF_getView(reader, dataLength, &chunk->reader, &chunk->padBytePresent)) { return false; }
 
-	chunk->idTag = chunkId;
 	chunk->dataLength = dataLength;
-	chunk->padBytePresent = dataLength & 1 ? true : false;
-	//If data length is uneven, we need a pad byte
 	chunk->chunkLength = BLAH_IFF_CHUNK_HEADER_LENGTH + dataLength +
 		(chunk->padBytePresent ? 1 : 0); //Assign total chunk length
-
-	chunk->filePointer = file;
-	chunk->currentOffset = 0;
+	chunk->data = chunk->reader.start;
 
 	return true;
 }
 
-bool Blah_IFF_Chunk_init(Blah_IFF_Chunk *chunk, FILE *file)
-{	//Initialises an IFF chunk structure from given file_pointer
+blah_unsigned32 Blah_IFF_Chunk_getOffset(const Blah_IFF_Chunk *chunk)
+{	//Returns current read position within data (offset into chunk data)
+	return (blah_unsigned32)Blah_File_Reader_getOffset(&chunk->reader);
+}
+
+bool Blah_IFF_Chunk_init(Blah_IFF_Chunk *chunk, Blah_File_Reader *reader)
+{	//Initialises an IFF chunk structure from the next chunk of the given reader
 	//All it really does is call Blah_IFF_Chunk_get()
 	//Returns TRUE on success on FALSE on error.
-	return Blah_IFF_Chunk_get(chunk, file);
+	return Blah_IFF_Chunk_get(chunk, reader);
 }
 
-Blah_IFF_Chunk *Blah_IFF_Chunk_new(FILE *file)
-{	//Creates a IFF chunk structure from given file_pointer
+Blah_IFF_Chunk *Blah_IFF_Chunk_new(Blah_File_Reader *reader)
+{	//Creates a IFF chunk structure from the next chunk of the given reader
 	//Returns NULL on error
 	Blah_IFF_Chunk *newChunk = (Blah_IFF_Chunk*)malloc(sizeof(Blah_IFF_Chunk));
 
-	if (!Blah_IFF_Chunk_init(newChunk, file)) //If intialisation failed
+	if (newChunk && !Blah_IFF_Chunk_init(newChunk, reader)) //If intialisation failed
 	{
 		free(newChunk); //Free the allocated memory and return NULL pointer
 		newChunk = NULL;
@@ -66,69 +88,58 @@ bool Blah_IFF_Chunk_readInt16(Blah_IFF_Chunk *chunk, blah_int16 *dest)
 {
     //Reads a 16bit signed integer value from IFF Chunk into 'dest'
 	//Returns true on success, false on error
-	chunk->currentOffset+=2; //Increment offset by 2 bytes (16bits)
-	return blah_file_readInt16(chunk->filePointer, dest);
+	return Blah_File_Reader_readBigInt16(&chunk->reader, dest) || Blah_IFF_exhaust(&chunk->reader);
 }
 
 bool Blah_IFF_Chunk_readUnsigned8(Blah_IFF_Chunk *chunk, blah_unsigned8 *dest)
 {
     // Reads a 8bit unsigned integer value from IFF Chunk into 'dest'
 	// Returns true on success, false on error
-	chunk->currentOffset++; // Increment offset by 1 bytes (8bits)
-	int newChar = fgetc(chunk->filePointer);
-	*dest = newChar;
-	return newChar != EOF;
+	return Blah_File_Reader_readUnsigned8(&chunk->reader, dest) || Blah_IFF_exhaust(&chunk->reader);
 }
 
 bool Blah_IFF_Chunk_readUnsigned16(Blah_IFF_Chunk *chunk, blah_unsigned16 *dest)
 {	//Reads a 16bit unsigned integer value from IFF Chunk into 'dest'
 	//Returns true on success, false on error
-	chunk->currentOffset+=2; //Increment offset by 2 bytes (16bits)
-	return blah_file_readUnsigned16(chunk->filePointer, dest);
+	return Blah_File_Reader_readBigUnsigned16(&chunk->reader, dest) || Blah_IFF_exhaust(&chunk->reader);
 }
 
 bool Blah_IFF_Chunk_readUnsigned32(Blah_IFF_Chunk *chunk, blah_unsigned32 *dest)
 {	//Reads a 32bit unsigned integer value from IFF chunk into 'dest'
 	//Returns true on success, false on error
-	chunk->currentOffset+=4; //Increment offset by 4 bytes (32bits)
-	return blah_file_readUnsigned32(chunk->filePointer, dest);
+	return Blah_File_Reader_readBigUnsigned32(&chunk->reader, dest) || Blah_IFF_exhaust(&chunk->reader);
 }
 
 size_t Blah_IFF_Chunk_read(Blah_IFF_Chunk *chunk, void *dest, size_t numBytes)
 {	//Reads num_bytes of information from chunk to dest
-	//Like fread, returns 0 on error or EOF.  Either way that's the end.
-	chunk->currentOffset+=numBytes; //Increment offset by num_bytes
-	return fread(dest, numBytes, 1, chunk->filePointer);
+	//Like fread, returns 0 on error or end of chunk.  Either way that's the end.
+	return Blah_File_Reader_read(&chunk->reader, dest, numBytes) ? 1 : 0;
 }
 
 bool Blah_IFF_Chunk_readFloat32(Blah_IFF_Chunk *chunk, blah_float32 *dest)
 {	//Reads a 32bit floating point value from IFF chunk into 'dest'
 	//Returns true on success, false on error
-	chunk->currentOffset+=4; //Increment offset by 4 bytes (32bits)
-	return blah_file_readFloat32(chunk->filePointer, dest);
+	return Blah_File_Reader_readBigFloat32(&chunk->reader, dest) || Blah_IFF_exhaust(&chunk->reader);
 }
 
 char *Blah_IFF_Chunk_readString(Blah_IFF_Chunk *chunk)
 {	//Reads a null terminated character string from chunk
 	//Returns pointer to allocated string on success, NULL on error
-	char *returnString = blah_file_readString(chunk->filePointer);
-	blah_unsigned32 dataLength;
-	if (returnString != NULL) {
-		dataLength = strlen(returnString) + 1; //string length +1 for null char
-		if (dataLength & 1) {
-			dataLength++;
-			fseek(chunk->filePointer,1, SEEK_CUR);
-		}
-		chunk->currentOffset+=dataLength;
-	} //If successful, update chunk pointer
+	char *returnString = Blah_File_Reader_readString(&chunk->reader, chunk->chunkLength);
+
+	if (returnString == NULL) { //No terminated string in chunk, so nothing more can be read
+		Blah_IFF_exhaust(&chunk->reader);
+		return NULL;
+	}
+	if ((strlen(returnString) + 1) & 1) { Blah_File_Reader_skip(&chunk->reader, 1); } //Skip pad byte after odd length
 	return returnString;
 }
 
 int Blah_IFF_Chunk_seek(Blah_IFF_Chunk *chunk, long offset)
-{	//Seeks into chunk file 'offset' number of points from current position
-	//Currently no error checking
-	chunk->currentOffset+=offset;
-	return fseek(chunk->filePointer, offset, SEEK_CUR);
+{	//Seeks forward into chunk data 'offset' number of bytes from current position
+	//Returns 0 on success, or -1 if offset is negative or beyond the end of the chunk
+	if (offset < 0) { return -1; }
+	return Blah_File_Reader_skip(&chunk->reader, (size_t)offset) ? 0 : -1;
 }
 
 /* Sub Chunk Functions */
@@ -139,28 +150,31 @@ void Blah_IFF_Subchunk_destroy(Blah_IFF_Subchunk *subchunk)
 }
 
 bool Blah_IFF_Subchunk_get(Blah_IFF_Subchunk *subchunk, Blah_IFF_Chunk *chunk)
-{	//Discards current settings of given subchunk object and connects it to the specified
-	//file pointer
-	blah_unsigned32 subchunkId;
+{	//Discards current settings of given subchunk object and connects it to the next
+	//subchunk of the specified chunk.  Returns false, exhausting the chunk, if it does not fit.
+	const blah_unsigned8 *header = Blah_File_Reader_take(&chunk->reader, 4);
 	blah_unsigned16 dataLength;
 
-	Blah_IFF_Chunk_read(chunk, &subchunkId, sizeof(blah_unsigned32));
-	//Read 4 byte chunk_id tag into variable
-	Blah_IFF_Chunk_readUnsigned16(chunk, &dataLength); //Get chunk length
+	if (header == NULL) { return Blah_IFF_exhaust(&chunk->reader); }
+	memcpy(&subchunk->idTag, header, 4); //Read 4 byte chunk_id tag into variable
+	if (!Blah_File_Reader_readBigUnsigned16(&chunk->reader, &dataLength) ||
+		!Blah_IFF_getView(&chunk->reader, dataLength, &subchunk->reader, &subchunk->padBytePresent)) {
+		return Blah_IFF_exhaust(&chunk->reader);
+	}
 
-	subchunk->idTag = subchunkId;
 	subchunk->dataLength = dataLength;
-	subchunk->padBytePresent = dataLength & 1 ? true : false;
-	//If data length is uneven, we need a pad byte
 	subchunk->subchunkLength = BLAH_IFF_SUBCHUNK_HEADER_LENGTH + dataLength +
 		(subchunk->padBytePresent ? 1 : 0); //Assign total chunk length
-
 	subchunk->parentChunk = chunk;
-	subchunk->currentOffset = 0;
 
 	return true;
 }
 
+blah_unsigned32 Blah_IFF_Subchunk_getOffset(const Blah_IFF_Subchunk *subchunk)
+{	//Returns current read position (offset into subchunk data)
+	return (blah_unsigned32)Blah_File_Reader_getOffset(&subchunk->reader);
+}
+
 bool Blah_IFF_Subchunk_init(Blah_IFF_Subchunk *subchunk, Blah_IFF_Chunk *chunk)
 {	//Intialises a subchunk structure, given parent chunk structure.
 	//All it does is call Blah_IFF_Subchunk_get()
@@ -173,7 +187,7 @@ Blah_IFF_Subchunk *Blah_IFF_Subchunk_new(Blah_IFF_Chunk *chunk)
 
 	Blah_IFF_Subchunk *newSubchunk = (Blah_IFF_Subchunk*)malloc(sizeof(Blah_IFF_Subchunk));
 
-	if (!Blah_IFF_Subchunk_init(newSubchunk, chunk)) //If failed to initialise subchunk
+	if (newSubchunk && !Blah_IFF_Subchunk_init(newSubchunk, chunk)) //If failed to initialise subchunk
 	{
 		Blah_IFF_Subchunk_destroy(newSubchunk); //Free allocated memory
 		newSubchunk = NULL; //Return NULL pointer
@@ -185,62 +199,54 @@ Blah_IFF_Subchunk *Blah_IFF_Subchunk_new(Blah_IFF_Chunk *chunk)
 bool Blah_IFF_Subchunk_readUnsigned8(Blah_IFF_Subchunk *subchunk, blah_unsigned8 *dest)
 {	//Reads a 8bit unsigned integer value from IFF subchunk into 'dest'
 	//Returns true on success, false on error
-	subchunk->currentOffset++; //Increment offset by 1 byte (8bits)
-	return Blah_IFF_Chunk_readUnsigned8(subchunk->parentChunk, dest);
+	return Blah_File_Reader_readUnsigned8(&subchunk->reader, dest) || Blah_IFF_exhaust(&subchunk->reader);
 }
 
 bool Blah_IFF_Subchunk_readInt16(Blah_IFF_Subchunk *subchunk, blah_int16 *dest)
 {	//Reads a 16bit signed integer value from IFF subchunk into 'dest'
 	//Returns true on success, false on error
-	subchunk->currentOffset+=2; //Increment offset by 2 bytes (16bits)
-	return Blah_IFF_Chunk_readInt16(subchunk->parentChunk, dest);
+	return Blah_File_Reader_readBigInt16(&subchunk->reader, dest) || Blah_IFF_exhaust(&subchunk->reader);
 }
 
 bool Blah_IFF_Subchunk_readUnsigned16(Blah_IFF_Subchunk *subchunk, blah_unsigned16 *dest)
 {	//Reads a 16bit unsigned integer value from IFF subchunk into 'dest'
-	subchunk->currentOffset+=2; //Increment offset by 2 bytes (16bits)
-	return Blah_IFF_Chunk_readUnsigned16(subchunk->parentChunk, dest);
+	return Blah_File_Reader_readBigUnsigned16(&subchunk->reader, dest) || Blah_IFF_exhaust(&subchunk->reader);
 }
 
 bool Blah_IFF_Subchunk_readUnsigned32(Blah_IFF_Subchunk *subchunk, blah_unsigned32 *dest)
 {	//Reads a 32bit unsigned integer value from IFF subchunk into 'dest'
 	//Returns true on success, false on error
-	subchunk->currentOffset+=4; //Increment offset by 4 bytes (32bits)
-	return Blah_IFF_Chunk_readUnsigned32(subchunk->parentChunk, dest);
+	return Blah_File_Reader_readBigUnsigned32(&subchunk->reader, dest) || Blah_IFF_exhaust(&subchunk->reader);
 }
 
 bool Blah_IFF_Subchunk_readFloat32(Blah_IFF_Subchunk *subchunk, blah_float32 *dest)
 {	//Reads a 32bit floating point value from IFF subchunk into 'dest'
 	//Returns true on success, false on error
-	subchunk->currentOffset+=4; //Increment offset by 4 bytes (32bits)
-	return Blah_IFF_Chunk_readFloat32(subchunk->parentChunk, dest);
+	return Blah_File_Reader_readBigFloat32(&subchunk->reader, dest) || Blah_IFF_exhaust(&subchunk->reader);
 }
 
-size_t Blah_IFF_SubchunkRead(Blah_IFF_Subchunk *subchunk, void *dest, size_t numBytes)
+size_t Blah_IFF_Subchunk_read(Blah_IFF_Subchunk *subchunk, void *dest, size_t numBytes)
 {	//Reads num_bytes of information from subchunk to dest
-	//Like fread, returns 0 on error or EOF.  Either way that's the end.
-	subchunk->currentOffset+=numBytes; //Increment offset by num_bytes
-	return Blah_IFF_Chunk_read(subchunk->parentChunk, dest, numBytes);
+	//Like fread, returns 0 on error or end of subchunk.  Either way that's the end.
+	return Blah_File_Reader_read(&subchunk->reader, dest, numBytes) ? 1 : 0;
 }
 
 char *Blah_IFF_Subchunk_readString(Blah_IFF_Subchunk *subchunk)
 {	//Reads a null terminated character string from subchunk
 	//Returns pointer to allocated string on success, NULL on error
-	char *returnString = Blah_IFF_Chunk_readString(subchunk->parentChunk);
-	blah_unsigned32 dataLength;
-	if (returnString) {
-		dataLength = strlen(returnString) +1; //Add 1 for null char
-		if (dataLength & 1)
-			dataLength++;
-		subchunk->currentOffset+=dataLength;
+	char *returnString = Blah_File_Reader_readString(&subchunk->reader, subchunk->subchunkLength);
+
+	if (returnString == NULL) { //No terminated string in subchunk, so nothing more can be read
+		Blah_IFF_exhaust(&subchunk->reader);
+		return NULL;
 	}
-	//If successful, update chunk pointer
+	if ((strlen(returnString) + 1) & 1) { Blah_File_Reader_skip(&subchunk->reader, 1); } //Skip pad byte after odd length
 	return returnString;
 }
 
 int Blah_IFF_Subchunk_seek(Blah_IFF_Subchunk *subchunk, long offset)
-{	//Seeks into chunk data 'offset' number of points from current position
-	//Currently no error checking
-	subchunk->currentOffset+=offset;
-	return Blah_IFF_Chunk_seek(subchunk->parentChunk, offset);
+{	//Seeks forward into subchunk data 'offset' number of bytes from current position
+	//Returns 0 on success, or -1 if offset is negative or beyond the end of the subchunk
+	if (offset < 0) { return -1; }
+	return Blah_File_Reader_skip(&subchunk->reader, (size_t)offset) ? 0 : -1;
 }
@@ -1,14 +1,18 @@
 /* blah_iff.h
 	Defines common functions for files that comply to the IFF
-	(interchangeable file format), 	*/
+	(interchangeable file format).
+	Chunks are read from a file reader (see blah_file.h).  Each chunk and subchunk holds a view of its
+	own data, so reads are checked against its length, and the reader it came from is always left at
+	the following chunk however much of the data was parsed. */
 
 
 #ifndef _BLAH_IFF
 
 #define _BLAH_IFF
 
+#include "blah_file.h"
 #include "blah_types.h"
-#include <stdio.h>
+#include <stddef.h>
 
 /* Definitions */
 
@@ -21,18 +25,18 @@ typedef struct Blah_IFF_Chunk {
 	blah_unsigned32 idTag;			//sequence of four bytes, identifies chunk type
 	blah_unsigned32 dataLength;	//length of the data in the chunk (in bytes)
 	blah_unsigned32 chunkLength;	//Total length of chunk (including header tag and pad byte if present)
-	FILE *filePointer;				//file pointer holds chunk data, after the header
+	Blah_File_Reader reader;		//view of chunk data, and pad byte if present
+	const blah_unsigned8 *data;		//chunk data in memory, valid until the next read from the parent reader
 	bool padBytePresent;		//Signifies if a pad byte of data is required to make even data length
-	blah_unsigned32 currentOffset; //current read position within data (offset into chunk data)
 } Blah_IFF_Chunk;
 
 typedef struct Blah_IFF_Subchunk {
 	blah_unsigned32 idTag;		//sequence of four bytes, identifies subchunk type
 	blah_unsigned16 dataLength;	//length of the data in the subchunk (in bytes)
 	blah_unsigned32 subchunkLength;	//Total length of subchunk (including header tag and pad byte if present)
+	Blah_File_Reader reader;		//view of subchunk data within parent chunk, and pad byte if present
 	Blah_IFF_Chunk *parentChunk;	//Parent chunk that holds chunk data
 	bool padBytePresent;		//Signifies if a pad byte of data is required to make even data length
-	blah_unsigned32 currentOffset; //current read position (offset into subchunk data)
 } Blah_IFF_Subchunk;
 
 /* Function Prototypes */
@@ -44,17 +48,22 @@ typedef struct Blah_IFF_Subchunk {
 void Blah_IFF_Chunk_destroy(Blah_IFF_Chunk *chunk);
 	//Destroys chunk structure pointed to by chunk
 
-bool Blah_IFF_Chunk_get(Blah_IFF_Chunk *chunk, FILE *file);
-	//Discards current settings of given chunk object and connects it to the specified
-	//file pointer
+bool Blah_IFF_Chunk_get(Blah_IFF_Chunk *chunk, Blah_File_Reader *reader);
+	//Discards current settings of given chunk object and connects it to the next chunk
+	//of the reader, moving the reader past it.  Returns false if the header, or the chunk
+	//data it describes, does not fit in the remaining data.  A missing pad byte at the
+	//very end of the data is tolerated.
 
-bool Blah_IFF_Chunk_init(Blah_IFF_Chunk *chunk, FILE *file);
-	//Initialises an IFF chunk structure from given file_pointer
+blah_unsigned32 Blah_IFF_Chunk_getOffset(const Blah_IFF_Chunk *chunk);
+	//Returns current read position within data (offset into chunk data)
+
+bool Blah_IFF_Chunk_init(Blah_IFF_Chunk *chunk, Blah_File_Reader *reader);
+	//Initialises an IFF chunk structure from the next chunk of the given reader
 	//All it really does is call Blah_IFF_Chunk_get()
 	//Returns TRUE on success on FALSE on error.
 
-Blah_IFF_Chunk *Blah_IFF_Chunk_new(FILE *file);
-	//Creates a IFF chunk structure from given file_pointer
+Blah_IFF_Chunk *Blah_IFF_Chunk_new(Blah_File_Reader *reader);
+	//Creates a IFF chunk structure from the next chunk of the given reader
 	//Returns NULL on error
 
 bool Blah_IFF_Chunk_readFloat32(Blah_IFF_Chunk *chunk, blah_float32 *dest);
@@ -80,15 +89,15 @@ bool Blah_IFF_Chunk_readUnsigned32(Blah_IFF_Chunk *chunk,
 
 size_t Blah_IFF_Chunk_read(Blah_IFF_Chunk *chunk, void *dest, size_t numBytes);
 	//Reads num_bytes of information from chunk to dest
-	//Like fread, returns 0 on error or EOF.  Either way that's the end.
+	//Like fread, returns 0 on error or end of chunk.  Either way that's the end.
 
 char *Blah_IFF_Chunk_readString(Blah_IFF_Chunk *chunk);
 	//Reads a null terminated character string from chunk
 	//Returns pointer to allocated string on success, NULL on error
 
 int Blah_IFF_Chunk_seek(Blah_IFF_Chunk *chunk, long offset);
-	//Seeks into chunk file 'offset' number of points from current position
-	//Currently no error checking
+	//Seeks forward into chunk data 'offset' number of bytes from current position
+	//Returns 0 on success, or -1 if offset is negative or beyond the end of the chunk
 
 /* Subchunk Prototypes */
 
@@ -100,8 +109,12 @@ void Blah_IFF_Subchunk_destroy(Blah_IFF_Subchunk *subchunk);
 	//Destroys chunk structure pointed to by subchunk
 
 bool Blah_IFF_Subchunk_get(Blah_IFF_Subchunk *subchunk, Blah_IFF_Chunk *chunk);
-	//Discards current settings of given subchunk object and connects it to the specified
-	//chunk pointer
+	//Discards current settings of given subchunk object and connects it to the next
+	//subchunk of the specified chunk, moving the chunk past it.  Returns false if the
+	//subchunk does not fit in the remaining chunk data, leaving the chunk exhausted.
+
+blah_unsigned32 Blah_IFF_Subchunk_getOffset(const Blah_IFF_Subchunk *subchunk);
+	//Returns current read position (offset into subchunk data)
 
 bool Blah_IFF_Subchunk_init(Blah_IFF_Subchunk *subchunk, Blah_IFF_Chunk *chunk);
 	//Intialises a subchunk structure, given parent chunk structure.
@@ -130,15 +143,15 @@ bool Blah_IFF_Subchunk_readFloat32(Blah_IFF_Subchunk *subchunk, blah_float32 *de
 
 size_t Blah_IFF_Subchunk_read(Blah_IFF_Subchunk *subchunk, void *dest, size_t numBytes);
 	//Reads num_bytes of information from subchunk to dest
-	//Like fread, returns 0 on error or EOF.  Either way that's the end.
+	//Like fread, returns 0 on error or end of subchunk.  Either way that's the end.
 
 char *Blah_IFF_Subchunk_readString(Blah_IFF_Subchunk *subchunk);
 	//Reads a null terminated character string from subchunk
 	//Returns pointer to allocated string on success, NULL on error
 
 int Blah_IFF_Subchunk_seek(Blah_IFF_Subchunk *subchunk, long offset);
-	//Seeks into chunk data 'offset' number of points from current position
-	//Currently no error checking
+	//Seeks forward into subchunk data 'offset' number of bytes from current position
+	//Returns 0 on success, or -1 if offset is negative or beyond the end of the subchunk
 
 #ifdef __cplusplus
 	}
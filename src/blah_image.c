@@ -13,9 +13,10 @@
 #include "blah_file.h"
 #include "blah_types.h"
 #include "blah_error.h"
+#include "blah_profile.h"
 
 /* Private locals */
-Blah_Tree imageTree = {"", NULL, NULL, 0}; //Binary tree of all images
+Blah_Tree imageTree = { .name = "images", .hashIndex = true }; //Binary tree of all images, hashed for blah_image_find
 
 /* Private Function Prototypes */
 
@@ -63,8 +64,8 @@ void blah_image_destroyAll()
 
 
 void Blah_Image_disable(Blah_Image *image)
-{
-	Blah_Tree_removeElement(&imageTree, image->name);
+{	//Images from Blah_Image_fromFile are not in the tree, so must not remove another image of the same name
+	if (blah_image_find(image->name) == image) { Blah_Tree_removeElement(&imageTree, image->name); }
 	free(image->pixelData); //Free buffer full of pixel data
 }
 
@@ -107,16 +108,31 @@ bool Blah_Image_init(Blah_Image *image, const char *name, unsigned char pixelDep
 	return result;
 }
 
+// Makes a new image from the targa file given by 'filename', returning NULL on failure rather than
+// raising an error, as it may be called by loader worker threads.
+Blah_Image* Blah_Image_decode(const char* filename) {
+	Blah_File_Reader reader;
+	if (!Blah_File_Reader_open(&reader, filename, BLAH_FILE_READER_MAPPED)) { return NULL; }
+	Blah_Image* const newImage = Blah_Image_Targa_fromReader(filename, &reader);
+	Blah_File_Reader_close(&reader);
+	return newImage;
+}
+
 // Creates a new Image structure from file given by 'filename'.
 Blah_Image* Blah_Image_fromFile(const char* filename) {
-	FILE* fileStream = blah_file_open(filename, "rb");
-	if (fileStream == NULL) {
+	Blah_File_Reader reader;
+	if (!Blah_File_Reader_open(&reader, filename, BLAH_FILE_READER_MAPPED)) {
 	    // If failed to open file, exit with error
 	    blah_error_raise(errno, "Blah_Image_fromFile() failed to open filename '%s'", filename);
 	    return NULL;
     }
-	Blah_Image* const newImage = Blah_Image_Targa_fromFile(filename, fileStream);
-	fclose(fileStream);
+	BLAH_PROFILE_BEGIN("Blah_Image_fromFile");
+	Blah_Image* const newImage = Blah_Image_Targa_fromReader(filename, &reader);
+	Blah_File_Reader_close(&reader);
+	BLAH_PROFILE_END();
+	if (newImage == NULL) { // Corrupt or incomplete file, or out of memory
+	    blah_error_raise(errno, "Blah_Image_fromFile() failed to decode targa image '%s'", filename);
+	}
 	return newImage;
 }
 
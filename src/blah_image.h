@@ -53,7 +53,7 @@ void Blah_Image_copyRasterData(const Blah_Image* source, void *destination, unsi
 	// pointer will skip an additional 'row_skip' bytes after each row is copied.
 
 void Blah_Image_destroy(Blah_Image *image);
-	// Destroys an image structure and removes from tree
+	// Destroys an image structure and removes from tree, if it was added to it
 
 void blah_image_destroyAll();
 	// Garbage collection function to deallocate all images still in memory
@@ -78,7 +78,13 @@ Blah_Image* Blah_Image_fromImage(const Blah_Image* source, const char* name, int
 // Function returns true if there were no errrors encountered
 
 
+// Makes a new image from the targa file given by 'filename', without raising an error.  Returns NULL if
+// the file could not be opened or is corrupt, incomplete or of an unsupported type.  The image is not
+// added to the image tree, so images may be decoded on any thread.
+Blah_Image* Blah_Image_decode(const char* filename);
+
 // Creates a new Image structure from a file given by 'filename'.  Memory is allocated etc
+// Raises an error if the file could not be opened or decoded.
 Blah_Image* Blah_Image_fromFile(const char* filename);
 
 
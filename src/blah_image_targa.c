@@ -7,7 +7,7 @@
 #include <string.h>
 
 #include "blah_image_targa.h"
-#include "blah_error.h"
+#include "blah_file.h"
 
 #define BLAH_IMAGE_TARGA_HEADER_LENGTH 18
 
@@ -37,31 +37,33 @@ extern bool Blah_Image_init(Blah_Image *image, const char *name, unsigned char p
 
 // Subfunction to deal with uncompressed colour mapped targas
 // Load targa image from file into raw pixel data in memory
-static bool Blah_Image_Targa_loadMapped(Blah_Image* newImage, FILE *fileStream, const Blah_Image_Targa_Header* header, const char* imageName)
+static bool Blah_Image_Targa_loadMapped(Blah_Image* newImage, Blah_File_Reader *reader, const Blah_Image_Targa_Header* header, const char* imageName)
 {
 	unsigned int numPixels = header->width * header->height; //Total number of pixels in image
 	unsigned char mapEntryByteSize = header->colourMapEntrySize >> 3;
 	unsigned char pixelByteSize = header->pixelSize >> 3;
 	unsigned long colourMapSize = mapEntryByteSize * header->colourMapCount;
 
+	if (pixelByteSize == 0 || pixelByteSize > 2) { return false; } // Only 8 or 16 bit indices
+	if (header->colourMapCount == 0 || (header->colourMapEntrySize != 24 && header->colourMapEntrySize != 32)) {
+		return false; // Only non-empty maps of BGR or BGRA entries
+	}
+
 	// Initialise the image structure dimensions etc and with allocated raster data buffer
-	Blah_Image_init(newImage, imageName, header->colourMapEntrySize, header->width,
-		header->height,	mapEntryByteSize == 3 ? BLAH_PIXEL_FORMAT_BGR : BLAH_PIXEL_FORMAT_BGRA);
+	if (!Blah_Image_init(newImage, imageName, header->colourMapEntrySize, header->width,
+		header->height,	mapEntryByteSize == 3 ? BLAH_PIXEL_FORMAT_BGR : BLAH_PIXEL_FORMAT_BGRA)) { return false; }
 
 	uint8_t colourMap[colourMapSize]; // Allocate Temporary pointer to store colour map data
-	if (fread(colourMap, colourMapSize, 1, fileStream) < 1) { // Read colour map from file into buffer
-        blah_error_raise(errno, "Failed to read colour map from targa image '%s'", imageName);
+	if (!Blah_File_Reader_read(reader, colourMap, colourMapSize)) { // Read colour map from file into buffer
         return false;
 	}
 
-	uint8_t indexBuffer[numPixels * pixelByteSize]; // Allocate temporary buffer to store pixel indices
-	if (fread(indexBuffer, pixelByteSize, numPixels, fileStream) < numPixels) { // Read pixel map indexes into buffer
-        blah_error_raise(errno, "Failed to read pixel indices from targa image '%s'", imageName);
-        return false;
-	}
+	// Pixel indices are used where they lie in the reader, rather than copied to a buffer first
+	const uint8_t* indexBuffer = Blah_File_Reader_take(reader, (size_t)numPixels * pixelByteSize);
+	if (indexBuffer == NULL) { return false; }
 	// Construct raw image from colour map indices
 
-	void* tempIndexPointer = indexBuffer; 	//Navigates pixel index buffer
+	const uint8_t* tempIndexPointer = indexBuffer; 	//Navigates pixel index buffer
 	void* tempRasterPointer = newImage->pixelData; // Navigates constructed raster buffer
 	//temp_raster pointer will be used to navigate raster buffer
 	for (unsigned int pixelCounter = 0 ; pixelCounter < numPixels ; pixelCounter++) {
@@ -69,6 +71,7 @@ static bool Blah_Image_Targa_loadMapped(Blah_Image* newImage, FILE *fileStream,
 		//Get next palette index from pixel index buffer and store in temp_index
 		memcpy(&tempIndex, tempIndexPointer, pixelByteSize);
 		tempIndexPointer += pixelByteSize;  //Advance pointer to next index
+		if (tempIndex + header->colourMapOrigin >= header->colourMapCount) { return false; } //Index outside colour map
 		memcpy(tempRasterPointer, colourMap + ((tempIndex + header->colourMapOrigin) * mapEntryByteSize), mapEntryByteSize);
 		//Copy colour map entry data for pixel into raster data
 		tempRasterPointer += mapEntryByteSize; //Advance raster data pointer
@@ -77,195 +80,221 @@ static bool Blah_Image_Targa_loadMapped(Blah_Image* newImage, FILE *fileStream,
 	return true;	//Return complete raw image data
 }
 
+// Fills dest with 'count' copies of the pixel of 'pixelByteSize' bytes at 'pixel' and returns the end of
+// the run.  Pixels of up to 4 bytes are repeated into a 16 byte pattern, so long runs are written 16 bytes
+// at a time.  Inlined with a constant pixel size, so the copies compile to plain stores.
+static inline uint8_t* Blah_Image_Targa_fillRun(uint8_t* dest, const uint8_t* pixel, size_t pixelByteSize, size_t count)
+{
+	size_t remainingBytes = pixelByteSize * count;
+
+	if (pixelByteSize <= 4 && remainingBytes >= 16) {
+		uint8_t pattern[16 + 4]; // Room for the last pixel to be copied whole
+		const size_t patternStep = 16 / pixelByteSize * pixelByteSize; // Whole pixels in each 16 byte store
+		for (size_t patternOffset = 0; patternOffset < 16; patternOffset += pixelByteSize) {
+			memcpy(pattern + patternOffset, pixel, pixelByteSize);
+		}
+		while (remainingBytes >= 16) {
+			memcpy(dest, pattern, 16);
+			dest += patternStep;
+			remainingBytes -= patternStep;
+		}
+	}
+	for (; remainingBytes > 0; remainingBytes -= pixelByteSize, dest += pixelByteSize) {
+		memcpy(dest, pixel, pixelByteSize);
+	}
+	return dest;
+}
+
+// Decodes run length encoded packets from reader into 'numPixels' pixels of 'rasterByteSize' bytes.
+// Packet pixels are 'pixelByteSize' bytes, either the pixel itself or, if colourMap is given, an index
+// to which colourMapOrigin is added to find its entry.  Returns false if the data ends early, a run
+// would overrun the raster or an index lies outside the colour map.
+static inline bool Blah_Image_Targa_decodeRLEPixels(Blah_File_Reader* reader, uint8_t* raster, size_t numPixels, size_t rasterByteSize,
+	size_t pixelByteSize, const uint8_t* colourMap, size_t colourMapCount, size_t colourMapOrigin)
+{
+	uint8_t* rasterPointer = raster;
+	uint8_t* const rasterEnd = raster + numPixels * rasterByteSize;
+
+	while (rasterPointer < rasterEnd) {
+		const uint8_t* packet = Blah_File_Reader_take(reader, 1); // Get next packet byte
+		if (packet == NULL) { return false; }
+		const uint8_t packetByte = *packet;
+		const size_t runLength = (packetByte & 127) + 1; // Get run length from 7 other bits
+		if (runLength * rasterByteSize > (size_t)(rasterEnd - rasterPointer)) { return false; }
+
+		// Take the packet's pixel data where it lies, whether a repeated pixel or a run of raw pixels
+		const uint8_t* source = Blah_File_Reader_take(reader, packetByte & 128 ? pixelByteSize : runLength * pixelByteSize);
+		if (source == NULL) { return false; }
+
+		if (colourMap == NULL) {
+			if (packetByte & 128) { // Repeated pixel
+				rasterPointer = Blah_Image_Targa_fillRun(rasterPointer, source, rasterByteSize, runLength);
+			} else { // Raw pixels are already in raster format
+				memcpy(rasterPointer, source, runLength * rasterByteSize);
+				rasterPointer += runLength * rasterByteSize;
+			}
+		} else if (packetByte & 128) { // Repeated colour map entry
+			const size_t mapIndex = (pixelByteSize == 2 ? source[0] | (source[1] << 8) : source[0]) + colourMapOrigin;
+			if (mapIndex >= colourMapCount) { return false; }
+			rasterPointer = Blah_Image_Targa_fillRun(rasterPointer, colourMap + mapIndex * rasterByteSize, rasterByteSize, runLength);
+		} else { // Run of indices, stored least significant byte first
+			for (const uint8_t* const sourceEnd = source + runLength * pixelByteSize; source < sourceEnd; source += pixelByteSize) {
+				const size_t mapIndex = (pixelByteSize == 2 ? source[0] | (source[1] << 8) : source[0]) + colourMapOrigin;
+				if (mapIndex >= colourMapCount) { return false; }
+				memcpy(rasterPointer, colourMap + mapIndex * rasterByteSize, rasterByteSize);
+				rasterPointer += rasterByteSize;
+			}
+		}
+	}
+	return true;
+}
+
+// Decodes run length encoded pixels or colour map indices, see Blah_Image_Targa_decodeRLEPixels().
+// Common pixel and index sizes get their own copy of the decoder, with sizes known at compile time.
+static bool Blah_Image_Targa_decodeRLE(Blah_File_Reader* reader, uint8_t* raster, size_t numPixels, uint8_t rasterByteSize,
+	uint8_t pixelByteSize, const uint8_t* colourMap, size_t colourMapCount, size_t colourMapOrigin)
+{
+	if (pixelByteSize == 0 || (colourMap && pixelByteSize > 2)) { return false; } // Only 8 or 16 bit indices
+
+	if (colourMap == NULL) {
+		switch (pixelByteSize) {
+			case 3 : return Blah_Image_Targa_decodeRLEPixels(reader, raster, numPixels, 3, 3, NULL, 0, 0);
+			case 4 : return Blah_Image_Targa_decodeRLEPixels(reader, raster, numPixels, 4, 4, NULL, 0, 0);
+		}
+	} else if (pixelByteSize == 1) {
+		switch (rasterByteSize) {
+			case 3 : return Blah_Image_Targa_decodeRLEPixels(reader, raster, numPixels, 3, 1, colourMap, colourMapCount, colourMapOrigin);
+			case 4 : return Blah_Image_Targa_decodeRLEPixels(reader, raster, numPixels, 4, 1, colourMap, colourMapCount, colourMapOrigin);
+		}
+	}
+	return Blah_Image_Targa_decodeRLEPixels(reader, raster, numPixels, rasterByteSize, pixelByteSize, colourMap, colourMapCount, colourMapOrigin);
+}
+
 // Subfunction to deal with run length encoded colour mapped targas
-static bool Blah_Image_Targa_loadRLEMapped(Blah_Image* newImage, FILE *fileStream, const Blah_Image_Targa_Header* header, const char* imageName)
+static bool Blah_Image_Targa_loadRLEMapped(Blah_Image* newImage, Blah_File_Reader *reader, const Blah_Image_Targa_Header* header, const char* imageName)
 {
 	const size_t numPixels = header->width * header->height; // Total number of pixels in image
 	const uint8_t mapEntryByteSize = header->colourMapEntrySize >> 3;
 	const uint8_t pixelByteSize = header->pixelSize >> 3;
 	const unsigned long colourMapSize = mapEntryByteSize * header->colourMapCount;
 
+	if (header->colourMapCount == 0 || (header->colourMapEntrySize != 24 && header->colourMapEntrySize != 32)) {
+		return false; // Only non-empty maps of BGR or BGRA entries
+	}
+
 	// Initiase new image structure with dimensions and allocate pixel data buffer
-	Blah_Image_init(newImage, imageName, header->colourMapEntrySize, header->width,
-		header->height,	mapEntryByteSize == 3 ? BLAH_PIXEL_FORMAT_BGR : BLAH_PIXEL_FORMAT_BGRA);
+	if (!Blah_Image_init(newImage, imageName, header->colourMapEntrySize, header->width,
+		header->height,	mapEntryByteSize == 3 ? BLAH_PIXEL_FORMAT_BGR : BLAH_PIXEL_FORMAT_BGRA)) { return false; }
 
     uint8_t colourMap[colourMapSize]; // Allocate temp storage for colour map
-	if (fread(colourMap, colourMapSize, 1, fileStream) < 1) { // Read colour map from file into buffer
-        blah_error_raise(errno, "Failed dot read colour map from targa image '%s'", imageName);
+	if (!Blah_File_Reader_read(reader, colourMap, colourMapSize)) { // Read colour map from file into buffer
         return false;
 	}
 
-   	// Construct raw image from colour map indices
-	uint8_t indexBuffer[128 * pixelByteSize]; // Allocate index buffer for largest possible run of indices
-	void* tempRasterPointer = newImage->pixelData; // temp_raster pointer will be used to navigate raster buffer
-	long remainingPixels = numPixels; // counts down constructed pixels till complete (0) left
-	while (remainingPixels > 0) {
-		uint8_t pixelPacket;
-		fread(&pixelPacket, 1, 1, fileStream); //get next packet byte from file
-		uint8_t runLength = (pixelPacket & 127) +1 ; //Get run length from 7 other bits
-		remainingPixels -= runLength; //update total remaining pixels
-		if (pixelPacket & 128) { //test if high bit (7) is set.  If so, run follows
-            // Process run
-			unsigned int tempIndex = 0;
-			fread(&tempIndex, pixelByteSize, 1, fileStream);
-			// Read repeated pixel index from file following run length packet
-			void* tempColourMapPointer = colourMap + ((tempIndex + header->colourMapOrigin) * mapEntryByteSize);
-			while (runLength > 0) {
-				memcpy(tempRasterPointer, tempColourMapPointer, mapEntryByteSize);
-				//Copy colour map entry data for pixel into raster data
-				tempRasterPointer += mapEntryByteSize;
-				runLength--;
-			}
-		} else { // Read run of raw indices
-			fread(indexBuffer, pixelByteSize, runLength, fileStream);
-			void* tempIndexPointer = indexBuffer; //Set temp index pointer to start of buffer
-			while (runLength > 0) {
-				unsigned int tempIndex = 0;
-				// Get next palette index from pixel index buffer and store in temp_index
-				memcpy(&tempIndex, tempIndexPointer, pixelByteSize);
-				tempIndexPointer+=pixelByteSize;  //Advance pointer to next index
-				memcpy(tempRasterPointer, colourMap + ((tempIndex + header->colourMapOrigin) * mapEntryByteSize), mapEntryByteSize);
-				// Copy colour map entry data for pixel into raster data
-				tempRasterPointer+=mapEntryByteSize; // Advance raster data pointer
-				runLength--;
-			}
-		}
-	}
-
-	return true;	//Return complete raw image data
+	// Fails if the indices are corrupt or incomplete
+	return Blah_Image_Targa_decodeRLE(reader, newImage->pixelData, numPixels, mapEntryByteSize, pixelByteSize,
+		colourMap, header->colourMapCount, header->colourMapOrigin);
 }
 
 // Subfunction to deal with uncompressed raw RGB targas
-static bool Blah_Image_Targa_loadRGB(Blah_Image *newImage, FILE *fileStream, const Blah_Image_Targa_Header* header, const char* imageName)
+static bool Blah_Image_Targa_loadRGB(Blah_Image *newImage, Blah_File_Reader *reader, const Blah_Image_Targa_Header* header, const char* imageName)
 {
 	const size_t numPixels = header->width * header->height; //Total number of pixels in image
 	const uint8_t mapEntryByteSize = header->colourMapType ? header->colourMapEntrySize >> 3 : 0;
 	const uint8_t pixelByteSize = header->pixelSize >> 3;
 	const unsigned long colourMapSize = mapEntryByteSize * header->colourMapCount;
 
+	if (header->pixelSize != 24 && header->pixelSize != 32) { return false; } // Only BGR or BGRA pixels
+
 	// Initiase new image structure with dimensions and allocate pixel data buffer
-	Blah_Image_init(newImage, imageName, header->pixelSize, header->width,
-		header->height, pixelByteSize==3 ? BLAH_PIXEL_FORMAT_BGR : BLAH_PIXEL_FORMAT_BGRA);
+	if (!Blah_Image_init(newImage, imageName, header->pixelSize, header->width,
+		header->height, pixelByteSize==3 ? BLAH_PIXEL_FORMAT_BGR : BLAH_PIXEL_FORMAT_BGRA)) { return false; }
 
-	if (fseek(fileStream, colourMapSize, SEEK_CUR) != 0) { // Skip colour map in file if there is one defined
-        blah_error_raise(errno, "Failed to seek past colour map in targa image '%s'", imageName);
+	if (!Blah_File_Reader_skip(reader, colourMapSize)) { // Skip colour map in file if there is one defined
         return false;
 	}
 
-	if (fread(newImage->pixelData, pixelByteSize, numPixels, fileStream) < numPixels) { // Construct raw image directly from file
-        blah_error_raise(errno, "Failed to read RGB pixel data from targa image '%s'", imageName);
-    }
-
-	return true;	//Return complete raw image data
+	// Construct raw image directly from file
+	return Blah_File_Reader_read(reader, newImage->pixelData, numPixels * pixelByteSize);
 }
 
 // Subfunction to deal with run length encoded RGB targas
-static bool Blah_Image_Targa_loadRLERGB(Blah_Image* newImage, FILE *fileStream, const Blah_Image_Targa_Header* header, const char* imageName)
+static bool Blah_Image_Targa_loadRLERGB(Blah_Image* newImage, Blah_File_Reader *reader, const Blah_Image_Targa_Header* header, const char* imageName)
 {
 	const size_t numPixels = header->width * header->height; // Total number of pixels in image
 	const uint8_t mapEntryByteSize = header->colourMapType ? header->colourMapEntrySize >> 3 : 0;
 	const uint8_t pixelByteSize = header->pixelSize >> 3;
 	const unsigned long colourMapSize = mapEntryByteSize * header->colourMapCount;
 
+	if (header->pixelSize != 24 && header->pixelSize != 32) { return false; } // Only BGR or BGRA pixels
+
 	// Initiase new image structure with dimensions and allocate pixel data buffer
-	Blah_Image_init(newImage, imageName, header->pixelSize, header->width,
-		header->height, pixelByteSize==3 ? BLAH_PIXEL_FORMAT_BGR : BLAH_PIXEL_FORMAT_BGRA);
+	if (!Blah_Image_init(newImage, imageName, header->pixelSize, header->width,
+		header->height, pixelByteSize==3 ? BLAH_PIXEL_FORMAT_BGR : BLAH_PIXEL_FORMAT_BGRA)) { return false; }
 
-	if (fseek(fileStream, colourMapSize, SEEK_CUR) != 0) { // Skip colour map in file if there is one defined
-	    blah_error_raise(errno, "Failed to seek past colour map in targa image '%s'", imageName);
+	if (!Blah_File_Reader_skip(reader, colourMapSize)) { // Skip colour map in file if there is one defined
         return false;
 	}
 
-	//Construct raw image directly from file
-	void* tempRasterPointer = newImage->pixelData; // temp_raster pointer will be used to navigate raster buffer
-	long remainingPixels = numPixels; // counts down constructed pixels till complete (0) left
-	while (remainingPixels > 0) {
-        uint8_t pixelPacket;
-		fread(&pixelPacket, 1, 1, fileStream); //get next packet byte from file
-		uint8_t runLength = (pixelPacket & 127) +1 ; //Get run length from 7 other bits
-		remainingPixels -= runLength; //update total remaining pixels
-		if (pixelPacket & 128) { //test if high bit (7) is set.  If so, run follows
-			//Process repeated run
-			unsigned int tempPixel = 0;
-			fread(&tempPixel, pixelByteSize, 1, fileStream);
-			//Read repeated pixel index from file following run length packet
-			while (runLength > 0) {
-				memcpy(tempRasterPointer, &tempPixel, pixelByteSize);
-				//Copy colour map entry data for pixel into raster data
-				tempRasterPointer+=pixelByteSize;
-				runLength--;
-			}
-		} else { //Read run of raw pixels
-			fread(tempRasterPointer, pixelByteSize, runLength, fileStream);
-			tempRasterPointer+=(runLength * pixelByteSize);
-			//Advance raster data pointer
-		}
-	}
-
-	return true;	//Return complete raw image data
+	// Fails if the pixels are corrupt or incomplete
+	return Blah_Image_Targa_decodeRLE(reader, newImage->pixelData, numPixels, pixelByteSize, pixelByteSize, NULL, 0, 0);
 }
 
 // Read 18 bytes packed into the file and unpack into a useful structure
-static bool Blah_Image_Targa_Header_load(Blah_Image_Targa_Header* dest, FILE* fileStream)
+static bool Blah_Image_Targa_Header_load(Blah_Image_Targa_Header* dest, Blah_File_Reader* reader)
 {
-    // Read header from file into temporary storage
-    char headerBytes[BLAH_IMAGE_TARGA_HEADER_LENGTH];
-    if (fread(headerBytes, BLAH_IMAGE_TARGA_HEADER_LENGTH, 1, fileStream) != 1) {
-		blah_error_raise(errno, "Could not load header for targa image");
+    // Unpack header fields, stored least significant byte first, into useful structure
+    if (!Blah_File_Reader_readUnsigned8(reader, &dest->idFieldLength) ||
+        !Blah_File_Reader_readUnsigned8(reader, &dest->colourMapType) ||
+        !Blah_File_Reader_readUnsigned8(reader, &dest->imageTypeCode) ||
+        !Blah_File_Reader_readLittleUnsigned16(reader, &dest->colourMapOrigin) ||
+        !Blah_File_Reader_readLittleUnsigned16(reader, &dest->colourMapCount) ||
+        !Blah_File_Reader_readUnsigned8(reader, &dest->colourMapEntrySize) ||
+        !Blah_File_Reader_readLittleUnsigned16(reader, &dest->imageOriginX) ||
+        !Blah_File_Reader_readLittleUnsigned16(reader, &dest->imageOriginY) ||
+        !Blah_File_Reader_readLittleUnsigned16(reader, &dest->width) ||
+        !Blah_File_Reader_readLittleUnsigned16(reader, &dest->height) ||
+        !Blah_File_Reader_readUnsigned8(reader, &dest->pixelSize) ||
+        !Blah_File_Reader_readUnsigned8(reader, &dest->imageDescriptor)) {
 		return false;
 	}
-    // Unpack header bytes into useful structure
-    dest->idFieldLength = headerBytes[0];
-    dest->colourMapType = headerBytes[1];
-    dest->imageTypeCode = headerBytes[2];
-    dest->colourMapOrigin = *(uint16_t*)(headerBytes+3);
-    dest->colourMapCount = *(uint16_t*)(headerBytes+5);
-    dest->colourMapEntrySize = headerBytes[7];
-    dest->imageOriginX = *(uint16_t*)(headerBytes+8);
-    dest->imageOriginY = *(uint16_t*)(headerBytes+10);
-    dest->width = *(uint16_t*)(headerBytes+12);
-    dest->height = *(uint16_t*)(headerBytes+14);
-    dest->pixelSize = headerBytes[16];
-    dest->imageDescriptor = headerBytes[17];
     return true;
 }
 
-static bool Blah_Image_Targa_load(Blah_Image* image, const char* imageName, FILE* fileStream) {
+// Returns false if the header or data is incomplete or corrupt, or the image type is unsupported
+static bool Blah_Image_Targa_load(Blah_Image* image, const char* imageName, Blah_File_Reader* reader) {
 	Blah_Image_Targa_Header header;
-	Blah_Image_Targa_Header_load(&header, fileStream);
+	if (!Blah_Image_Targa_Header_load(&header, reader)) { return false; }
 
 	// Skip Image identification data to colour map
-    if (fseek(fileStream, header.idFieldLength, SEEK_CUR) == -1) {
-        blah_error_raise(errno, "Couldn't seek past identification field in targa image: %s", imageName);
-        return false;
-    }
+    if (!Blah_File_Reader_skip(reader, header.idFieldLength)) { return false; }
 
     switch (header.imageTypeCode) {
         case BLAH_IMAGE_TARGA_MAPPED :
-            Blah_Image_Targa_loadMapped(image, fileStream, &header, imageName);
-            break;
+            return Blah_Image_Targa_loadMapped(image, reader, &header, imageName);
         case BLAH_IMAGE_TARGA_RLE_MAPPED :
-            Blah_Image_Targa_loadRLEMapped(image, fileStream, &header, imageName);
-            break;
+            return Blah_Image_Targa_loadRLEMapped(image, reader, &header, imageName);
         case BLAH_IMAGE_TARGA_RGB :
-            Blah_Image_Targa_loadRGB(image, fileStream, &header, imageName);
-            break;
+            return Blah_Image_Targa_loadRGB(image, reader, &header, imageName);
         case BLAH_IMAGE_TARGA_RLE_RGB :
-            Blah_Image_Targa_loadRLERGB(image, fileStream, &header, imageName);
-            break;
+            return Blah_Image_Targa_loadRLERGB(image, reader, &header, imageName);
         default:
-            blah_error_raise(0, "Could not load targa image file '%s' because its type is unsupported", imageName);
-            break;
+            return false;
     }
-	return true;
 }
 
-// Creates a new Image structure from targa file stream.  Memory is allocated etc
-Blah_Image* Blah_Image_Targa_fromFile(const char *fileName, FILE *fileStream)
+// Creates a new Image structure from targa data read from the given reader.  Memory is allocated etc
+// Returns NULL without raising an error if the data is corrupt, so that images may be decoded on any thread
+Blah_Image* Blah_Image_Targa_fromReader(const char *fileName, Blah_File_Reader *reader)
 {
 	Blah_Image *newImage = malloc(sizeof(Blah_Image)); //Pointer for new Image structure
     if (newImage != NULL) {
-        Blah_Image_Targa_load(newImage, fileName, fileStream);
+        newImage->pixelData = NULL; //Only allocated once the header has been read
+        if (!Blah_Image_Targa_load(newImage, fileName, reader)) {
+            free(newImage->pixelData);
+            free(newImage);
+            newImage = NULL;
+        }
     }
 
 	return newImage; //Return pointer whether it be null or valid image
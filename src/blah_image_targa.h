@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <stdint.h>
 
+#include "blah_file.h"
 #include "blah_image.h"
 
 /* Defines */
@@ -44,8 +45,9 @@ typedef struct Blah_Image_Targa_Header { //Represents a raw data image in raster
 	extern "C" {
 #endif //__cplusplus
 
-Blah_Image *Blah_Image_Targa_fromFile(const char *filename, FILE *fileStream);
-	//Creates a new Image structure from file 'filename'.  Memory is allocated etc
+Blah_Image *Blah_Image_Targa_fromReader(const char *filename, Blah_File_Reader *reader);
+	//Creates a new Image structure named 'filename' from targa data read from the given reader.
+	//Memory is allocated etc
 
 // void Blah_Image_Targa_printInfo(Blah_Image_Targa_Header *header);
 	//Prints info to the screen about targa, extracted from header information
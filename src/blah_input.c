@@ -7,6 +7,7 @@
 #include "blah_input.h"
 #include "blah_input_keyboard.h"
 #include "blah_debug.h"
+#include "blah_profile.h"
 
 /* Global Variables */
 
@@ -30,6 +31,7 @@ void blah_input_exit() { //shutdown input component
 }
 
 void blah_input_main() { //updates current status of all monitored user input devices
-
+	BLAH_PROFILE_BEGIN("blah_input_main");
 	blah_input_keyboard_main();  //update keyboard status
+	BLAH_PROFILE_END();
 }
@@ -0,0 +1,123 @@
+/* blah_job.c
+	Defines the job pool.  See blah_job.h for reference. */
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <threads.h>
+
+#include "blah_job.h"
+#include "blah_error.h"
+#include "blah_profile.h"
+
+/* Private Globals */
+
+static thrd_t workers[BLAH_JOB_MAX_THREADS];
+static unsigned int workerCount = 0;		//Number of worker threads running, only changed by calling thread
+static once_flag syncOnce = ONCE_FLAG_INIT;
+static mtx_t jobMutex;						//Guards the current run and stopping flag
+static cnd_t startCondition;				//Signalled when a run begins or workers must stop
+static cnd_t doneCondition;					//Signalled when the last worker has finished its part of a run
+static unsigned long runGeneration = 0;		//Incremented for each run, so workers notice a new one
+static blah_job_func* runFunction = NULL;
+static void* runData = NULL;
+static size_t runJobCount = 0;
+static atomic_size_t nextJob;				//Index of next job to be taken in the current run
+static unsigned int busyWorkers = 0;		//Workers which have not yet finished their part of the current run
+static bool stopping = false;
+
+/* Static Function Definitions */
+
+static void blah_job_initSync()
+{	//Creates the mutex and conditions shared with the worker threads, once per process
+	if (mtx_init(&jobMutex, mtx_plain) != thrd_success || cnd_init(&startCondition) != thrd_success
+		|| cnd_init(&doneCondition) != thrd_success) {
+		blah_error_raise(errno, "Failed to create job pool synchronisation objects");
+	}
+}
+
+static void blah_job_take(blah_job_func* function, size_t jobCount, void* data)
+{	//Takes and performs jobs of a run until none are left
+	size_t jobIndex;
+	while ((jobIndex = atomic_fetch_add_explicit(&nextJob, 1, memory_order_relaxed)) < jobCount) {
+		function(jobIndex, data);
+	}
+}
+
+static int blah_job_work(void* arg)
+{	//Worker thread routine.  Waits for each run, takes part in it and reports when done.
+	//Arg holds the run generation when the worker was created, so that no later run is missed.
+	unsigned long seenGeneration = (unsigned long)(uintptr_t)arg;
+
+	blah_profile_setThreadName("job worker");
+	mtx_lock(&jobMutex);
+	while (true) {
+		while (!stopping && runGeneration == seenGeneration) { cnd_wait(&startCondition, &jobMutex); }
+		if (stopping) { break; }
+		seenGeneration = runGeneration;
+		blah_job_func* function = runFunction; //Copy run while holding the mutex
+		const size_t jobCount = runJobCount;
+		void* data = runData;
+		mtx_unlock(&jobMutex);
+		blah_job_take(function, jobCount, data);
+		mtx_lock(&jobMutex);
+		if (--busyWorkers == 0) { cnd_signal(&doneCondition); }
+	}
+	mtx_unlock(&jobMutex);
+	return 0;
+}
+
+/* Function Definitions */
+
+void blah_job_exit()
+{	//Stops all worker threads
+	if (workerCount == 0) { return; }
+	mtx_lock(&jobMutex);
+	stopping = true;
+	cnd_broadcast(&startCondition);
+	mtx_unlock(&jobMutex);
+	while (workerCount > 0) { thrd_join(workers[--workerCount], NULL); }
+	stopping = false;
+}
+
+unsigned int blah_job_getThreadCount()
+{	//Returns the number of threads jobs are spread across, including the calling thread
+	return workerCount + 1;
+}
+
+bool blah_job_init(unsigned int threadCount)
+{	//Starts or stops worker threads so that jobs are spread across threadCount threads
+	const unsigned int wanted = threadCount > BLAH_JOB_MAX_THREADS ? BLAH_JOB_MAX_THREADS : (threadCount > 0 ? threadCount - 1 : 0);
+
+	call_once(&syncOnce, blah_job_initSync);
+	if (wanted < workerCount) { blah_job_exit(); } //Workers cannot be told apart, so restart them all
+	while (workerCount < wanted && thrd_create(&workers[workerCount], blah_job_work, (void*)(uintptr_t)runGeneration) == thrd_success) {
+		workerCount++;
+	}
+	return wanted == 0 || workerCount > 0;
+}
+
+void blah_job_run(blah_job_func* function, size_t jobCount, void* data)
+{	//Calls function for every job index across the worker threads and the calling thread
+	if (workerCount == 0 || jobCount < 2) { //Nothing to share, so run jobs in order here
+		for (size_t jobIndex = 0; jobIndex < jobCount; jobIndex++) { function(jobIndex, data); }
+		return;
+	}
+
+	mtx_lock(&jobMutex);
+	runFunction = function;
+	runData = data;
+	runJobCount = jobCount;
+	atomic_store_explicit(&nextJob, 0, memory_order_relaxed);
+	busyWorkers = workerCount;
+	runGeneration++;
+	cnd_broadcast(&startCondition);
+	mtx_unlock(&jobMutex);
+
+	blah_job_take(function, jobCount, data);
+
+	//Wait for every worker to finish, so none is still taking jobs when the next run begins.
+	//Releasing the mutex also makes the workers' writes visible to the calling thread.
+	mtx_lock(&jobMutex);
+	while (busyWorkers > 0) { cnd_wait(&doneCondition, &jobMutex); }
+	mtx_unlock(&jobMutex);
+}
@@ -0,0 +1,51 @@
+/* blah_job.h
+	The job pool spreads work which can be divided into independent jobs across a pool of worker
+	threads, with the calling thread taking part.  blah_job_run calls a function once for every job
+	index and returns once all of them are done, so work is forked and joined within a single call.
+	Jobs are taken in index order, but may run in any order and at the same time as each other, so
+	a job must only write to data no other job reads or writes.  Without worker threads, jobs run
+	in index order on the calling thread.  The pool is used by the entity update, see blah_entity.h. */
+
+#ifndef _BLAH_JOB
+
+#define _BLAH_JOB
+
+#include <stddef.h>
+
+#include "blah_types.h"
+
+/* Definitions */
+
+#define BLAH_JOB_MAX_THREADS 16	//Maximum number of worker threads
+
+/* Function Type Definitions */
+
+typedef void blah_job_func(size_t jobIndex, void* data);
+	//Performs the job of given index.  Data is the pointer passed to blah_job_run.
+
+/* Function Prototypes */
+
+#ifdef __cplusplus
+	extern "C" {
+#endif //__cplusplus
+
+void blah_job_exit();
+	//Stops all worker threads.  Must not be called while jobs are running.
+
+unsigned int blah_job_getThreadCount();
+	//Returns the number of threads jobs are spread across, the worker threads and the calling thread
+
+bool blah_job_init(unsigned int threadCount);
+	//Starts worker threads so that jobs are spread across the given number of threads, including the
+	//thread calling blah_job_run.  Stops surplus worker threads if fewer are wanted than are running.
+	//Returns false if no worker thread could be started when at least one was wanted.
+
+void blah_job_run(blah_job_func* function, size_t jobCount, void* data);
+	//Calls function for every job index from 0 to jobCount-1, across the worker threads and the
+	//calling thread, and returns once all jobs are done.  Must only be called from one thread.
+
+#ifdef __cplusplus
+	}
+#endif //__cplusplus
+
+#endif
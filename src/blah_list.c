@@ -1,27 +1,160 @@
 #include <malloc.h>
+#include <stdatomic.h>
 #include <string.h>
 #include <stdio.h>
+#include <threads.h>
 
 
 #include "blah_list.h"
 #include "blah_types.h"
 #include "blah_macros.h"
 #include "blah_util.h"
+#include "blah_error.h"
+
+/* Structure Definitions */
+
+typedef struct Blah_List_Pool_Slab { //Block of list elements allocated together
+	struct Blah_List_Pool_Slab* next;	//Next slab allocated by the same pool
+	Blah_List_Element elements[BLAH_LIST_POOL_SLAB_ELEMENTS];
+} Blah_List_Pool_Slab;
+
+typedef struct Blah_List_Pool { //Recycles list elements to avoid a malloc for every element
+	Blah_List_Element* freeElements;	//Unused elements, linked through their next pointers
+	Blah_List_Pool_Slab* slabs;			//All slabs allocated by the pool
+	Blah_List_Pool_Stats stats;
+} Blah_List_Pool;
+
+/* Static Globals - Private to list.c */
+
+#ifdef BLAH_LIST_POOL_THREAD_LOCAL
+static _Thread_local Blah_List_Pool elementPool;
+#else
+static Blah_List_Pool elementPool;
+#ifndef BLAH_LIST_NO_POOL
+static atomic_flag elementPoolLock = ATOMIC_FLAG_INIT;	//Held by the thread using the pool while it is shared
+#endif
+static atomic_int elementPoolSharers;	//Number of blah_list_pool_share(true) calls not yet undone
+#endif
+
+/* Element Pool Function Definitions */
+
+#ifndef BLAH_LIST_NO_POOL
+static inline bool blah_list_pool_lock()
+{	//Acquires the pool lock if the pool is shared between threads.  Returns true if it was acquired.
+#ifndef BLAH_LIST_POOL_THREAD_LOCAL
+	if (atomic_load_explicit(&elementPoolSharers, memory_order_relaxed)) {
+		while (atomic_flag_test_and_set_explicit(&elementPoolLock, memory_order_acquire)) { thrd_yield(); } //Holder may be descheduled
+		return true;
+	}
+#endif
+	return false;
+}
+
+static inline void blah_list_pool_unlock(bool locked)
+{	//Releases the pool lock if it was acquired by blah_list_pool_lock
+#ifndef BLAH_LIST_POOL_THREAD_LOCAL
+	if (locked) { atomic_flag_clear_explicit(&elementPoolLock, memory_order_release); }
+#endif
+}
+
+static Blah_List_Element *blah_list_pool_takeElement()
+{	//Takes an unused element from the pool, allocating a new slab if none remain
+	Blah_List_Element *element = elementPool.freeElements;
+
+	if (element != NULL) {
+		elementPool.stats.hits++;
+	} else {
+		Blah_List_Pool_Slab *newSlab = malloc(sizeof(Blah_List_Pool_Slab));
+		if (newSlab == NULL) { return NULL; }
+		newSlab->next = elementPool.slabs;
+		elementPool.slabs = newSlab;
+		elementPool.stats.slabs++;
+		elementPool.stats.misses++;
+		//Chain all but the first element of the new slab into the free list
+		for (int index = 1; index < BLAH_LIST_POOL_SLAB_ELEMENTS - 1; index++) {
+			newSlab->elements[index].next = &newSlab->elements[index + 1];
+		}
+		newSlab->elements[BLAH_LIST_POOL_SLAB_ELEMENTS - 1].next = NULL;
+		element = &newSlab->elements[0];
+		element->next = &newSlab->elements[1];
+	}
+	elementPool.freeElements = element->next;
+	elementPool.stats.inUse++;
+	return element;
+}
+
+static void blah_list_pool_giveElement(Blah_List_Element *element)
+{	//Returns an element to the pool for reuse
+	element->next = elementPool.freeElements;
+	elementPool.freeElements = element;
+	elementPool.stats.inUse--;
+}
+#endif //BLAH_LIST_NO_POOL
+
+bool blah_list_pool_destroyAll()
+{	//Frees all slabs held by the element pool, if no elements are in use
+	if (elementPool.stats.inUse > 0) { return false; }
+
+	while (elementPool.slabs != NULL) {
+		Blah_List_Pool_Slab *slab = elementPool.slabs;
+		elementPool.slabs = slab->next;
+		free(slab);
+	}
+	elementPool.freeElements = NULL;
+	elementPool.stats.slabs = 0;
+	return true;
+}
+
+void blah_list_pool_share(bool shared)
+{	//Counts threads sharing the pool, which is locked around each use while the count is non zero
+#ifndef BLAH_LIST_POOL_THREAD_LOCAL
+	atomic_fetch_add(&elementPoolSharers, shared ? 1 : -1);
+#endif
+}
+
+void blah_list_pool_getStats(Blah_List_Pool_Stats *stats)
+{	//Copies usage counters of the element pool into *stats
+	*stats = elementPool.stats;
+}
+
+void blah_list_pool_resetStats()
+{	//Sets the hit and miss counters of the element pool to zero
+	elementPool.stats.hits = elementPool.stats.misses = 0;
+}
 
 /* Element Function Definitions */
 Blah_List_Element *Blah_List_Element_new(void *data)
 {	//Creates a new list element.  Returns a pointer to newly created element
 	//on success, or NULL pointer if error occurred.
+#ifdef BLAH_LIST_NO_POOL
 	Blah_List_Element *newElement = malloc(sizeof(Blah_List_Element));
+#else
+	const bool locked = blah_list_pool_lock();
+	Blah_List_Element *newElement = blah_list_pool_takeElement();
+	blah_list_pool_unlock(locked);
+#endif
 
 	if (newElement) //Check that memory allocation succeeded
 	{
 		Blah_List_Element_init(newElement, data); //Initialise new structure
+	} else {
+		blah_error_raise(errno, "Failed to allocate list element");
 	}
 
 	return newElement;
 }
 
+void Blah_List_Element_destroy(Blah_List_Element *element)
+{	//Returns an element created with Blah_List_Element_new to the element pool
+#ifdef BLAH_LIST_NO_POOL
+	free(element);
+#else
+	const bool locked = blah_list_pool_lock();
+	blah_list_pool_giveElement(element);
+	blah_list_pool_unlock(locked);
+#endif
+}
+
 void Blah_List_Element_init(Blah_List_Element *element, void *data)
 {	//Initialises given element structure
 	element->prev=element->next=NULL;
@@ -78,27 +211,40 @@ Blah_List_Element *Blah_List_findElement(const Blah_List *list, const void *data
 	return tempElement;
 }
 
+static void Blah_List_unlinkElement(Blah_List *list, Blah_List_Element *element)
+{	//Unlinks element from the list it belongs to.  Does not free element or data.
+	//Deal with previous link
+	if (element->prev==NULL)  //if current element is first in the list
+		list->first=element->next;		//second element now becomes first
+	else
+		element->prev->next=element->next; //else link prev with next
+	//Deal with next link
+	if (element->next!=NULL)
+		element->next->prev=element->prev; //next element gets prev link from current element
+	else //if removing last element of list, update the last element pointer
+		list->last=element->prev;
+	list->length--;
+}
+
 bool Blah_List_removeElement(Blah_List *list, void *data) {
 	//remove given list element from liste.  Does not destroy data
 	Blah_List_Element *tempElement = Blah_List_findElement(list, data);
 
 	if (tempElement) { //if a matching element was found
-		//Deal with previous link
-		if (tempElement->prev==NULL)  //if current element is first in the list
-			list->first=tempElement->next;		//second element now becomes first
-		else
-			tempElement->prev->next=tempElement->next; //else link prev with next
-		//Deal with next link
-		if (tempElement->next!=NULL)
-			tempElement->next->prev=tempElement->prev; //next element gets prev link from current element
-		else //if removing last element of list, update the last element pointer
-			list->last=tempElement->prev;
-		list->length--;
+		Blah_List_unlinkElement(list, tempElement);
+		Blah_List_Element_destroy(tempElement);
 		return true;	//removed matching element
 	} else
 		return false;	//no match was found
 }
 
+void Blah_List_removeElementHandle(Blah_List *list, Blah_List_Element *element) {
+	//Removes the given element, as returned by Blah_List_appendElement or Blah_List_insertElement,
+	//from the list in constant time.  Does not destroy data.
+	Blah_List_unlinkElement(list, element);
+	Blah_List_Element_destroy(element);
+}
+
 /* Function Blah_List_pop_element
 	Removes first element from list and returns data pointer */
 void *Blah_List_popElement(Blah_List *list) {
@@ -110,7 +256,9 @@ void *Blah_List_popElement(Blah_List *list) {
 		list->first = tempElement->next; //make next element first element
 		if (list->first) //If new first element pointer is valid
 			list->first->prev = NULL; //Set prev pointer of new first element to NULL
-		free(tempElement);				//Once list is reconstructed, free element structure
+		else
+			list->last = NULL; //List is now empty
+		Blah_List_Element_destroy(tempElement);	//Once list is reconstructed, free element structure
 		list->length--;
 	}
 
@@ -124,7 +272,7 @@ void Blah_List_removeAll(Blah_List *list) {
 	while (tempElement!=NULL) {
 		freeElement = tempElement;  //remember current pointer
 		tempElement = tempElement->next;  //prepare for next element
-		free(freeElement);	//free current element
+		Blah_List_Element_destroy(freeElement);	//free current element
 	}
 	list->first=list->last=NULL;
 	list->length=0;
@@ -132,27 +280,27 @@ void Blah_List_removeAll(Blah_List *list) {
 
 // clears all memory allocated for elements and data but does not destroy basic list header
 void Blah_List_destroyElements(Blah_List *list) {
-	Blah_List_Element *tempElement = list->first;
+	Blah_List_Element *tempElement;
 	blah_list_element_dest_func* destFunc = list->destroyElementFunction ? list->destroyElementFunction : free;
 	//If there is a valid destory function, we will use it, else we will just use free()
 
-	while (tempElement != NULL) {
-		Blah_List_Element *destElement = tempElement;  //remember current pointer
-		tempElement = tempElement->next;  //prepare for next element
-		destFunc(destElement->data); //Call destroy function to free/destroy data
-		free(destElement);	//free current element
+	//Always destroy the first element, so that destroy functions may remove their own data from the
+	//list (e.g. Blah_Entity_destroy using its element handle) without invalidating the walk
+	while ((tempElement = list->first) != NULL) {
+		destFunc(tempElement->data); //Call destroy function to free/destroy data
+		if (list->first == tempElement) { //Destroy function did not remove the element itself
+			Blah_List_unlinkElement(list, tempElement);
+			Blah_List_Element_destroy(tempElement);	//free current element
+		}
 	}
-	list->first = list->last = NULL;  //clear list to empty
-	list->length = 0;
 }
 
-
 void Blah_List_destroy(Blah_List *list) { //clears all memory allocated for elements, list header and contained data
 	Blah_List_destroyElements(list);	//remove all elements and data
 	free(list);	//clear the list itself
 }
 
-void Blah_List_appendElement(Blah_List *list, void *data) { //adds a new element with given data pointer
+Blah_List_Element *Blah_List_appendElement(Blah_List *list, void *data) { //adds a new element with given data pointer
 	Blah_List_Element *newElement = Blah_List_Element_new(data);
 	//Deal with previous link
 	if (list->first==NULL) //if list is empty
@@ -163,9 +311,10 @@ void Blah_List_appendElement(Blah_List *list, void *data) { //adds a new element
 		list->last=newElement;			//make new last
 	}
 	list->length++;
+	return newElement;
 }
 
-void Blah_List_insertElement(Blah_List *list, void *data) { //inserts a new element with given data pointer
+Blah_List_Element *Blah_List_insertElement(Blah_List *list, void *data) { //inserts a new element with given data pointer
 	Blah_List_Element *newElement = Blah_List_Element_new(data);
 	//Deal with previous link
 	if (list->first==NULL) //if list is empty
@@ -176,6 +325,7 @@ void Blah_List_insertElement(Blah_List *list, void *data) { //inserts a new elem
 		list->first=newElement;		//make first element pointer of list point to new element
 	}
 	list->length++;
+	return newElement;
 }
 
 
@@ -225,53 +375,104 @@ void *Blah_List_search(Blah_List* list, blah_list_search_func* searchFunction, v
 }
 
 void Blah_List_sort(Blah_List* list, blah_list_sort_func* compareFunction) {
-	//Performs a linear sort of the list, using the supplied function to compare two elements.
+	//Performs a stable merge sort of the list, using the supplied function to compare two elements.
+	//Works bottom up, merging neighbouring runs of 1, 2, 4... elements in place by relinking them,
+	//so no recursion or extra memory is needed.
 	//compare_function is called as comp((void*)elem1->data,(void*)elem2->data).
 	//compare_function should behave like strcmp() and return a value smaller than 0
 	//if elem1->data < elem2->data, return 0 if equal, or > 0 if elem1->data > elem2->data
+	Blah_List_Element *head = list->first, *tail;
+	int runSize = 1, merges;
+
+	if (head == NULL) { return; } //Nothing to sort
+
+	do {
+		Blah_List_Element *left = head;
+		head = tail = NULL;
+		merges = 0;
+		while (left) { //Merge each pair of neighbouring runs
+			Blah_List_Element *right = left;
+			int leftSize = 0, rightSize = runSize;
+			merges++;
+			while (right && leftSize < runSize) { //Step over left run to find start of right run
+				leftSize++;
+				right = right->next;
+			}
+			while (leftSize > 0 || (rightSize > 0 && right)) {
+				Blah_List_Element *takeElement;
+				//Take from the left run unless the right element is strictly smaller, keeping the sort stable
+				if (leftSize == 0) {
+					takeElement = right; right = right->next; rightSize--;
+				} else if (rightSize == 0 || !right || compareFunction(right->data, left->data) >= 0) {
+					takeElement = left; left = left->next; leftSize--;
+				} else {
+					takeElement = right; right = right->next; rightSize--;
+				}
+				if (tail) { tail->next = takeElement; } else { head = takeElement; }
+				takeElement->prev = tail;
+				tail = takeElement;
+			}
+			left = right; //Next pair starts after the right run
+		}
+		tail->next = NULL;
+		runSize *= 2;
+	} while (merges > 1); //Finished once a pass merges a single pair, covering the whole list
+
+	list->first = head;
+	list->last = tail;
+}
+
+void Blah_List_sortNearly(Blah_List* list, blah_list_sort_func* compareFunction) {
+	//Performs a stable sort of a list which is expected to be almost in order already, such as a
+	//draw list re-sorted each frame.  Uses an insertion sort, which costs little more than a single
+	//pass when few elements are out of place.  If the list turns out to be far from sorted, the
+	//rest of the work is handed over to Blah_List_sort.
 	Blah_List_Element *currentElement, *nextElement, *compareElement;
+	long budget = 8L * list->length + 64; //Number of backward steps allowed before giving up
 	bool placeFound;
 
 	if (list->first) { //Make sure list isn't empty before continuing
 		currentElement = list->first->next; //We want to start comparing second elem
-		if (currentElement) { //Don't continue if there isn't a second element!
-			while (currentElement) { //Process each element in order until end of list
-				nextElement = currentElement->next; //hold pointer to next element
-				compareElement = currentElement->prev;
-				placeFound = false;
-				while (compareElement && !placeFound) {
-					if (compareFunction(currentElement->data, compareElement->data) < 0)
-						compareElement = compareElement->prev; //step backwards
-					else
-						placeFound = true;
-				}
-				if (compareElement != currentElement->prev) {
-				/* If last compared element is not the previous in the chain,
-					then we need to shift the element along in the list to where it should be */
-
-					//remove current_element from list and relink
-					currentElement->prev->next = currentElement->next;
-					if (currentElement->next)
-						currentElement->next->prev = currentElement->prev;
-					else //We must be moving the last element in the list
-						list->last=currentElement->prev; //fix pointer to last element
-
-					if (!compareElement) { //Reinsert element at beginning of list
-						currentElement->next=list->first;  //link first element to current element
-						list->first->prev=currentElement;  //link current to original first
-						list->first=currentElement;		//make first element pointer of list point to new element
-						currentElement->prev=NULL;
-					} else { //Reinsert in appropriate position
-						//fix link to next element
-						compareElement->next->prev = currentElement;
-						currentElement->next = compareElement->next;
-						//fix link to prev element
-						compareElement->next = currentElement;
-						currentElement->prev = compareElement;
+		while (currentElement) { //Process each element in order until end of list
+			nextElement = currentElement->next; //hold pointer to next element
+			compareElement = currentElement->prev;
+			placeFound = false;
+			while (compareElement && !placeFound) {
+				if (compareFunction(currentElement->data, compareElement->data) < 0) {
+					compareElement = compareElement->prev; //step backwards
+					if (--budget < 0) { //Too much out of order, a merge sort will be quicker
+						Blah_List_sort(list, compareFunction);
+						return;
 					}
+				} else
+					placeFound = true;
+			}
+			if (compareElement != currentElement->prev) {
+			/* If last compared element is not the previous in the chain,
+				then we need to shift the element along in the list to where it should be */
+
+				//remove current_element from list and relink
+				currentElement->prev->next = currentElement->next;
+				if (currentElement->next)
+					currentElement->next->prev = currentElement->prev;
+				else //We must be moving the last element in the list
+					list->last=currentElement->prev; //fix pointer to last element
+
+				if (!compareElement) { //Reinsert element at beginning of list
+					currentElement->next=list->first;  //link first element to current element
+					list->first->prev=currentElement;  //link current to original first
+					list->first=currentElement;		//make first element pointer of list point to new element
+					currentElement->prev=NULL;
+				} else { //Reinsert in appropriate position
+					//fix link to next element
+					compareElement->next->prev = currentElement;
+					currentElement->next = compareElement->next;
+					//fix link to prev element
+					compareElement->next = currentElement;
+					currentElement->prev = compareElement;
 				}
-				currentElement = nextElement; //Begin processing next element
 			}
+			currentElement = nextElement; //Begin processing next element
 		}
 	}
 }
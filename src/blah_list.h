@@ -6,6 +6,12 @@
 #define _BLAH_LIST
 
 #define BLAH_LIST_NAME_LENGTH 20  //number of characters allowed for name property
+#define BLAH_LIST_POOL_SLAB_ELEMENTS 256  //number of list elements allocated together when the element pool is empty
+
+// List elements are recycled through a pool rather than allocated individually with malloc.
+// Define BLAH_LIST_POOL_THREAD_LOCAL to give each thread its own pool, or BLAH_LIST_NO_POOL
+// to allocate every element with malloc (e.g. when checking for leaks).  A single pool shared
+// by several threads must be locked with blah_list_pool_share() for as long as they run.
 
 #include "blah_types.h"
 
@@ -32,6 +38,13 @@ typedef struct Blah_List_Element { //defines a simple element structure to hold
 	void* data;					//pointer to element data
 } Blah_List_Element;
 
+typedef struct Blah_List_Pool_Stats { //Usage counters of the list element pool
+	unsigned long hits;		//Number of elements supplied from the pool without calling malloc
+	unsigned long misses;	//Number of elements which required a new slab to be allocated
+	unsigned long slabs;	//Number of slabs currently allocated
+	unsigned long inUse;	//Number of elements currently in use by lists
+} Blah_List_Pool_Stats;
+
 typedef struct Blah_List {
 	char name[BLAH_LIST_NAME_LENGTH+1];//name of list!
 	Blah_List_Element* first;		//pointer to start of element list
@@ -50,6 +63,10 @@ Blah_List_Element *Blah_List_Element_new(void *data);
 	//Creates a new list element.  Returns a pointer to newly created element
 	//on success, or NULL pointer if error occurred.
 
+void Blah_List_Element_destroy(Blah_List_Element *element);
+	//Returns an element created with Blah_List_Element_new to the element pool.
+	//Does not destroy the element data.
+
 void Blah_List_Element_init(Blah_List_Element *element,  void *data);
 	//Initialises given element structure
 
@@ -57,11 +74,29 @@ void Blah_List_Element_callFunction(Blah_List_Element* element, blah_list_elemen
 void Blah_List_Element_callWithArg(Blah_List_Element* element, blah_list_element_func_1arg* function, void *arg);
 bool Blah_List_Element_callArgReturnBool(Blah_List_Element* element, blah_list_search_func* func, void* arg);
 
+/* Element Pool Function Prototypes */
+
+bool blah_list_pool_destroyAll();
+	//Frees all slabs held by the element pool of the calling thread.  Only succeeds if no
+	//elements are in use, else returns false and nothing is freed.
+
+void blah_list_pool_getStats(Blah_List_Pool_Stats *stats);
+	//Copies usage counters of the element pool of the calling thread into *stats
+
+void blah_list_pool_resetStats();
+	//Sets the hit and miss counters of the element pool of the calling thread to zero
+
+void blah_list_pool_share(bool shared);
+	//Call with true before starting other threads which create or destroy list elements, and
+	//with false once they have finished.  While any such calls with true are not yet matched by
+	//calls with false, the element pool is locked around each use.  No effect on thread local pools.
+
 /* List Function Prototypes */
 
 
-void Blah_List_appendElement(Blah_List* list, void* data);
-	//Appends a new element to the end of the list with given data ptr
+Blah_List_Element *Blah_List_appendElement(Blah_List* list, void* data);
+	//Appends a new element to the end of the list with given data ptr.
+	//Returns the new element, which may be kept as a handle for Blah_List_removeElementHandle.
 
 void Blah_List_callFunction(Blah_List* list, blah_list_element_func* function);
 	//Calls function for each element, using data pointer as argument to given function
@@ -78,7 +113,8 @@ void Blah_List_destroy(Blah_List *list);
 	// Clears all memory occupied by list and elements
 
 void Blah_List_destroyElements(Blah_List *list);
-	// clears all memory allocated for elements and data but does not destroy basic list header
+	// clears all memory allocated for elements and data but does not destroy basic list header.
+	// The destroy function may remove the element it was called for from the list.
 
 Blah_List_Element *Blah_List_findElement(const Blah_List *list, const void *data);
 	// Finds list element with given data
@@ -86,8 +122,9 @@ Blah_List_Element *Blah_List_findElement(const Blah_List *list, const void *data
 void Blah_List_init(Blah_List *list, const char *name);
 	// Sets the name of the list, and all element pointers to NULL
 
-void Blah_List_insertElement(Blah_List *list, void *data);
-	// Inserts a new element at the beginning of the list with given data ptr
+Blah_List_Element *Blah_List_insertElement(Blah_List *list, void *data);
+	// Inserts a new element at the beginning of the list with given data ptr.
+	// Returns the new element, which may be kept as a handle for Blah_List_removeElementHandle.
 
 Blah_List *Blah_List_new(const char *name);
 	// Creates a new empty list given a name as a null terminated string in parameter 'name'.
@@ -103,7 +140,12 @@ void Blah_List_removeAll(Blah_List *list);
 
 bool Blah_List_removeElement(Blah_List *list, void *data);
 	// Removes element with given data from list.  Does not free data pointed to by list element.
-	// Returns zero if error
+	// Returns zero if error.  Searches the list for the data, see Blah_List_removeElementHandle.
+
+void Blah_List_removeElementHandle(Blah_List *list, Blah_List_Element *element);
+	// Removes the given element of the list in constant time.  'element' must be a handle returned
+	// by Blah_List_appendElement or Blah_List_insertElement for this list and is invalid afterwards.
+	// Does not free data pointed to by list element.
 
 void* Blah_List_search(Blah_List* list, blah_list_search_func* searchFunction, void* searchArg);
 	// Calls search_function for each element of the list, using the element's data
@@ -116,11 +158,16 @@ void Blah_List_setDestroyElementFunction(Blah_List* list, blah_list_element_dest
 	// contained in elements of this list
 
 void Blah_List_sort(Blah_List* list, blah_list_sort_func* compareFunction);
-	// Performs a linear sort of the list, using the supplied function to compare two elements.
+	// Performs a stable merge sort of the list, using the supplied function to compare two elements.
 	// compare_function is called as comp((void*)elem1->data,(void*)elem2->data).
 	// compare_function should behave like strcmp() and return a value smaller than 0
 	// if elem1->data < elem2->data, return 0 if equal, or > 0 if elem1->data > elem2->data
 
+void Blah_List_sortNearly(Blah_List* list, blah_list_sort_func* compareFunction);
+	// Performs a stable sort of a list which is already nearly in order, e.g. one re-sorted every frame
+	// with small changes.  Close to linear time in that case, and no worse than Blah_List_sort otherwise.
+	// compare_function is used as for Blah_List_sort.
+
 #ifdef __cplusplus
 	}
 #endif //__cplusplus
@@ -0,0 +1,290 @@
+/* blah_loader.c
+	Defines functions for loading assets on worker threads.  See blah_loader.h for reference. */
+
+#include <malloc.h>
+#include <threads.h>
+
+#include "blah_loader.h"
+#include "blah_error.h"
+#include "blah_list.h"
+#include "blah_profile.h"
+#include "blah_time.h"
+#include "blah_util.h"
+
+/* Definitions */
+
+#define BLAH_LOADER_MAX_THREADS 16
+
+/* Structure Definitions */
+
+typedef struct Blah_Loader_Queue { //First in, first out queue of requests linked through their next pointers
+	Blah_Loader_Request* first;
+	Blah_Loader_Request* last;
+} Blah_Loader_Queue;
+
+/* Private Globals */
+
+static thrd_t workers[BLAH_LOADER_MAX_THREADS];
+static unsigned int workerCount = 0;		//Number of worker threads running, only changed by main thread
+static once_flag syncOnce = ONCE_FLAG_INIT;
+static mtx_t queuedMutex;					//Guards queued requests and stopping flag
+static cnd_t queuedCondition;				//Signalled when a request is queued or workers must stop
+static mtx_t decodedMutex;					//Guards decoded requests
+static Blah_Loader_Queue queued, decoded;
+static bool stopping = false;
+static unsigned long frameBudget = BLAH_LOADER_DEFAULT_FRAME_BUDGET;
+
+/* Static Function Definitions */
+
+static void blah_loader_initSync()
+{	//Creates the mutexes and condition shared with the worker threads, once per process
+	if (mtx_init(&queuedMutex, mtx_plain) != thrd_success || mtx_init(&decodedMutex, mtx_plain) != thrd_success
+		|| cnd_init(&queuedCondition) != thrd_success) {
+		blah_error_raise(errno, "Failed to create loader synchronisation objects");
+	}
+}
+
+static void Blah_Loader_Queue_push(Blah_Loader_Queue *queue, Blah_Loader_Request *request)
+{	//Appends request to the end of the queue
+	request->next = NULL;
+	if (queue->last) { queue->last->next = request; } else { queue->first = request; }
+	queue->last = request;
+}
+
+static Blah_Loader_Request *Blah_Loader_Queue_pop(Blah_Loader_Queue *queue)
+{	//Removes and returns the request at the front of the queue, or NULL if empty
+	Blah_Loader_Request *request = queue->first;
+
+	if (request) {
+		queue->first = request->next;
+		if (queue->first == NULL) { queue->last = NULL; }
+	}
+	return request;
+}
+
+static void Blah_Loader_Request_release(Blah_Loader_Request *request)
+{	//Drops one reference to the request, freeing it when none remain
+	if (atomic_fetch_sub(&request->references, 1) == 1) { free(request); }
+}
+
+static void Blah_Loader_Request_decode(Blah_Loader_Request *request)
+{	//Reads and decodes the asset of the request.  Called on a worker thread, so a missing or corrupt
+	//file fails the request rather than raising an error, which would exit from this thread.
+	BLAH_PROFILE_BEGIN("Blah_Loader_Request_decode");
+	atomic_store(&request->state, BLAH_LOADER_STATE_DECODING);
+	if (request->type == BLAH_LOADER_ASSET_MODEL) {
+		request->asset = Blah_Model_decode(request->fileName);
+	} else {
+		request->asset = Blah_Image_decode(request->fileName);
+	}
+	atomic_store(&request->state, request->asset ? BLAH_LOADER_STATE_DECODED : BLAH_LOADER_STATE_FAILED);
+	BLAH_PROFILE_END();
+}
+
+static void Blah_Loader_Request_discard(Blah_Loader_Request *request)
+{	//Fails a request which will not be completed, destroying its decoded asset
+	if (request->asset) {
+		if (request->type == BLAH_LOADER_ASSET_MODEL) { //Not in the model tree, so must not be destroyed by name
+			Blah_Model_disable(request->asset);
+			free(request->asset);
+		} else {
+			Blah_Image_destroy(request->asset);
+		}
+		request->asset = NULL;
+	}
+	atomic_store(&request->state, BLAH_LOADER_STATE_FAILED);
+	Blah_Loader_Request_release(request);
+}
+
+static void Blah_Loader_Request_complete(Blah_Loader_Request *request)
+{	//Finishes a decoded request on the main thread and calls its callback
+	BLAH_PROFILE_BEGIN("Blah_Loader_Request_complete");
+	if (Blah_Loader_Request_getState(request) != BLAH_LOADER_STATE_FAILED) { //Failed decodes only need their callback
+		if (request->type == BLAH_LOADER_ASSET_MODEL) {
+			Blah_Model_finishDecode(request->asset);
+		} else if (request->type == BLAH_LOADER_ASSET_TEXTURE) { //Image is NULL if the texture already existed when queued
+			Blah_Image *image = request->asset;
+			Blah_Texture *texture = blah_texture_find(image ? image->name : request->fileName);
+			if (!texture && image) { texture = Blah_Texture_fromImage(image); }
+			if (image) { Blah_Image_destroy(image); }
+			request->asset = texture;
+		}
+		atomic_store(&request->state, request->asset ? BLAH_LOADER_STATE_COMPLETE : BLAH_LOADER_STATE_FAILED);
+	}
+
+	//Checked only now, as the handle may be destroyed on another thread while the asset is finished
+	if (atomic_load(&request->references) == 1) { //Caller has destroyed the handle, so nobody to hand a loaded image to
+		if (request->type == BLAH_LOADER_ASSET_IMAGE && request->asset) { Blah_Image_destroy(request->asset); }
+	} else if (request->callback) {
+		request->callback(request, request->userData);
+	}
+	Blah_Loader_Request_release(request);
+	BLAH_PROFILE_END();
+}
+
+static int blah_loader_work(void *unused)
+{	//Worker thread function.  Decodes queued requests until asked to stop.
+	Blah_Loader_Request *request;
+
+	blah_profile_setThreadName("loader worker");
+	mtx_lock(&queuedMutex);
+	while (true) {
+		while (!stopping && queued.first == NULL) { cnd_wait(&queuedCondition, &queuedMutex); }
+		if (stopping) { break; }
+		request = Blah_Loader_Queue_pop(&queued);
+		mtx_unlock(&queuedMutex);
+
+		Blah_Loader_Request_decode(request);
+		mtx_lock(&decodedMutex);
+		Blah_Loader_Queue_push(&decoded, request);
+		mtx_unlock(&decodedMutex);
+
+		mtx_lock(&queuedMutex);
+	}
+	mtx_unlock(&queuedMutex);
+	return 0;
+}
+
+static Blah_Loader_Request *Blah_Loader_Request_new(blah_loader_asset_type type, const char *fileName, blah_loader_callback_func *callback, void *userData)
+{	//Creates a new request, starting the loader first if needed.  Returns NULL if the loader could not be started.
+	Blah_Loader_Request *request;
+
+	if (workerCount == 0 && !blah_loader_init(BLAH_LOADER_DEFAULT_THREADS)) { return NULL; }
+
+	request = malloc(sizeof(Blah_Loader_Request));
+	if (request == NULL) { blah_error_raise(errno, "Failed to allocate request to load '%s'", fileName); }
+	blah_util_strncpy(request->fileName, fileName, BLAH_LOADER_FILENAME_LENGTH);
+	request->type = type;
+	atomic_init(&request->state, BLAH_LOADER_STATE_QUEUED);
+	atomic_init(&request->references, 2); //One for the caller, one for the loader
+	request->asset = NULL;
+	request->callback = callback;
+	request->userData = userData;
+	request->next = NULL;
+	return request;
+}
+
+static Blah_Loader_Request *Blah_Loader_Request_queue(Blah_Loader_Request *request)
+{	//Hands the request to the worker threads, and returns it
+	if (request) {
+		mtx_lock(&queuedMutex);
+		Blah_Loader_Queue_push(&queued, request);
+		cnd_signal(&queuedCondition);
+		mtx_unlock(&queuedMutex);
+	}
+	return request;
+}
+
+/* Function Definitions */
+
+void blah_loader_exit()
+{	//Stops the worker threads and fails all requests not yet complete
+	Blah_Loader_Request *request;
+
+	if (workerCount == 0) { return; }
+
+	mtx_lock(&queuedMutex);
+	stopping = true;
+	cnd_broadcast(&queuedCondition);
+	mtx_unlock(&queuedMutex);
+	while (workerCount > 0) { thrd_join(workers[--workerCount], NULL); }
+	stopping = false;
+	blah_list_pool_share(false);
+
+	while ((request = Blah_Loader_Queue_pop(&queued))) { Blah_Loader_Request_discard(request); }
+	while ((request = Blah_Loader_Queue_pop(&decoded))) { Blah_Loader_Request_discard(request); }
+}
+
+bool blah_loader_init(unsigned int threadCount)
+{	//Starts worker threads, unless already running
+	if (workerCount > 0) { return true; }
+
+	call_once(&syncOnce, blah_loader_initSync);
+	if (threadCount > BLAH_LOADER_MAX_THREADS) { threadCount = BLAH_LOADER_MAX_THREADS; }
+	blah_list_pool_share(true); //Decoding creates list elements on the worker threads
+	while (workerCount < threadCount && thrd_create(&workers[workerCount], blah_loader_work, NULL) == thrd_success) {
+		workerCount++;
+	}
+	if (workerCount == 0) { blah_list_pool_share(false); }
+	return workerCount > 0;
+}
+
+Blah_Loader_Request *blah_loader_loadImage(const char *fileName, blah_loader_callback_func *callback, void *userData)
+{	//Queues an image to be decoded by a worker thread
+	return Blah_Loader_Request_queue(Blah_Loader_Request_new(BLAH_LOADER_ASSET_IMAGE, fileName, callback, userData));
+}
+
+Blah_Loader_Request *blah_loader_loadModel(const char *fileName, blah_loader_callback_func *callback, void *userData)
+{	//Queues a model to be decoded by a worker thread
+	return Blah_Loader_Request_queue(Blah_Loader_Request_new(BLAH_LOADER_ASSET_MODEL, fileName, callback, userData));
+}
+
+Blah_Loader_Request *blah_loader_loadTexture(const char *fileName, blah_loader_callback_func *callback, void *userData)
+{	//Queues a texture image to be decoded by a worker thread, unless the texture already exists
+	Blah_Loader_Request *request = Blah_Loader_Request_new(BLAH_LOADER_ASSET_TEXTURE, fileName, callback, userData);
+
+	if (request && blah_texture_find(fileName)) { //Nothing to decode, so complete on next call of blah_loader_main
+		atomic_store(&request->state, BLAH_LOADER_STATE_DECODED);
+		mtx_lock(&decodedMutex);
+		Blah_Loader_Queue_push(&decoded, request);
+		mtx_unlock(&decodedMutex);
+		return request;
+	}
+	return Blah_Loader_Request_queue(request);
+}
+
+void blah_loader_main()
+{	//Completes decoded requests until the frame budget is spent, at least one per call
+	const uint64_t startTime = blah_time_getNanoseconds(); //Monotonic, so clock adjustments don't end the frame early
+	Blah_Loader_Request *request;
+
+	if (workerCount == 0) { return; }
+
+	BLAH_PROFILE_BEGIN("blah_loader_main");
+	do {
+		mtx_lock(&decodedMutex);
+		request = Blah_Loader_Queue_pop(&decoded);
+		mtx_unlock(&decodedMutex);
+		if (request == NULL) { break; }
+		Blah_Loader_Request_complete(request);
+	} while ((blah_time_getNanoseconds() - startTime) / 1000 < frameBudget);
+	BLAH_PROFILE_END();
+}
+
+void blah_loader_setFrameBudget(unsigned long microseconds)
+{	//Sets the time blah_loader_main may spend per call
+	frameBudget = microseconds;
+}
+
+/* Request Function Definitions */
+
+void Blah_Loader_Request_destroy(Blah_Loader_Request *request)
+{	//Releases the caller's reference to the request
+	Blah_Loader_Request_release(request);
+}
+
+Blah_Image *Blah_Loader_Request_getImage(const Blah_Loader_Request *request)
+{	//Returns the loaded image, or NULL if not a completed image request
+	return request->type == BLAH_LOADER_ASSET_IMAGE && Blah_Loader_Request_getState(request) == BLAH_LOADER_STATE_COMPLETE ? request->asset : NULL;
+}
+
+Blah_Model *Blah_Loader_Request_getModel(const Blah_Loader_Request *request)
+{	//Returns the loaded model, or NULL if not a completed model request
+	return request->type == BLAH_LOADER_ASSET_MODEL && Blah_Loader_Request_getState(request) == BLAH_LOADER_STATE_COMPLETE ? request->asset : NULL;
+}
+
+blah_loader_state Blah_Loader_Request_getState(const Blah_Loader_Request *request)
+{	//Returns the current state of the request
+	return (blah_loader_state)atomic_load(&((Blah_Loader_Request*)request)->state);
+}
+
+Blah_Texture *Blah_Loader_Request_getTexture(const Blah_Loader_Request *request)
+{	//Returns the loaded texture, or NULL if not a completed texture request
+	return request->type == BLAH_LOADER_ASSET_TEXTURE && Blah_Loader_Request_getState(request) == BLAH_LOADER_STATE_COMPLETE ? request->asset : NULL;
+}
+
+bool Blah_Loader_Request_isDone(const Blah_Loader_Request *request)
+{	//Returns true if the request is complete or has failed
+	const blah_loader_state state = Blah_Loader_Request_getState(request);
+	return state == BLAH_LOADER_STATE_COMPLETE || state == BLAH_LOADER_STATE_FAILED;
+}
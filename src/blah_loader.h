@@ -0,0 +1,120 @@
+/* blah_loader.h
+	The loader reads and decodes models, images and textures on a pool of worker threads, so that
+	loading assets does not stall the frame.  Only the steps which need the drawing context or touch
+	engine wide state (creating textures, adding models to the model tree) are left for the main
+	thread, which completes decoded requests from blah_engine_main within a time budget per frame.
+	Each load returns a request handle, which can be polled for its state, and an optional callback
+	is called on the main thread when the request is complete or has failed.  The handle belongs to
+	the caller and must be released with Blah_Loader_Request_destroy, which may be done at any time.
+	A missing file or an image which cannot be decoded fails its request, where loading it directly
+	would raise an error.  A model file cut short loads the chunks it holds, as when loaded directly.
+	Models and textures are added to their trees for garbage collection as when loaded directly,
+	while images belong to the caller, as with Blah_Image_fromFile. */
+
+#ifndef _BLAH_LOADER
+
+#define _BLAH_LOADER
+
+#include <stdatomic.h>
+
+#include "blah_types.h"
+#include "blah_image.h"
+#include "blah_model.h"
+#include "blah_texture.h"
+
+/* Definitions */
+
+#define BLAH_LOADER_FILENAME_LENGTH 255
+#define BLAH_LOADER_DEFAULT_THREADS 2	//Number of worker threads started by the first load, if blah_loader_init was not called
+#define BLAH_LOADER_DEFAULT_FRAME_BUDGET 2000	//Microseconds per frame spent completing decoded requests
+
+/* Type Definitions */
+
+typedef enum Blah_Loader_Asset_Type {BLAH_LOADER_ASSET_MODEL, BLAH_LOADER_ASSET_IMAGE,
+	BLAH_LOADER_ASSET_TEXTURE} blah_loader_asset_type;
+
+typedef enum Blah_Loader_State {
+	BLAH_LOADER_STATE_QUEUED,	//Waiting for a worker thread
+	BLAH_LOADER_STATE_DECODING,	//Being read and decoded by a worker thread
+	BLAH_LOADER_STATE_DECODED,	//Waiting for the main thread to complete it
+	BLAH_LOADER_STATE_COMPLETE,	//Asset is ready to use
+	BLAH_LOADER_STATE_FAILED	//File could not be opened or decoded, or loader was shut down first
+} blah_loader_state;
+
+struct Blah_Loader_Request;
+
+typedef void blah_loader_callback_func(struct Blah_Loader_Request* request, void* userData);
+	//Called on the main thread once a request is complete or has failed
+
+/* Structure Definitions */
+
+typedef struct Blah_Loader_Request {
+	char fileName[BLAH_LOADER_FILENAME_LENGTH+1];
+	blah_loader_asset_type type;
+	atomic_int state;			//blah_loader_state, written by worker threads
+	atomic_int references;		//Held by the caller until destroyed, and by the loader until complete
+	void* asset;				//Model, image or texture, once decoded
+	blah_loader_callback_func* callback;	//NULL if none
+	void* userData;				//Passed to callback
+	struct Blah_Loader_Request* next;	//Next request in the same queue
+} Blah_Loader_Request;
+
+/* Function Prototypes */
+
+#ifdef __cplusplus
+	extern "C" {
+#endif //__cplusplus
+
+void blah_loader_exit();
+	//Stops all worker threads after they finish their current request.  Requests not yet complete
+	//are failed without calling their callbacks, and their decoded assets are destroyed.
+
+bool blah_loader_init(unsigned int threadCount);
+	//Starts the given number of worker threads.  Returns false if no thread could be started.
+	//Has no effect and returns true if the loader is already running.
+
+Blah_Loader_Request* blah_loader_loadImage(const char* fileName, blah_loader_callback_func* callback, void* userData);
+	//Queues an image to be loaded from the given targa file.  The completed image is not added
+	//to the image tree and is owned by the caller.  Returns NULL if the loader could not be started.
+
+Blah_Loader_Request* blah_loader_loadModel(const char* fileName, blah_loader_callback_func* callback, void* userData);
+	//Queues a model to be loaded from the given lightwave file, along with the textures of its
+	//surfaces.  Returns NULL if the loader could not be started.
+
+Blah_Loader_Request* blah_loader_loadTexture(const char* fileName, blah_loader_callback_func* callback, void* userData);
+	//Queues a texture to be created from the given targa file, or found if a texture of the same
+	//name already exists.  Returns NULL if the loader could not be started.
+
+void blah_loader_main();
+	//Completes decoded requests and calls their callbacks, until the frame budget is spent.  At
+	//least one request is completed per call, so loading always progresses.  Called by blah_engine_main.
+
+void blah_loader_setFrameBudget(unsigned long microseconds);
+	//Sets the time blah_loader_main may spend per call completing decoded requests
+
+void Blah_Loader_Request_destroy(Blah_Loader_Request* request);
+	//Releases the caller's handle to a request.  If the request is not yet complete, it is still
+	//completed, but its callback is not called and a loaded image is destroyed.  A handle destroyed
+	//on another thread while blah_loader_main is completing the request may miss this, in which case
+	//the callback is still called and the image belongs to the caller, as if destroyed just after.
+
+Blah_Image* Blah_Loader_Request_getImage(const Blah_Loader_Request* request);
+	//Returns the loaded image, or NULL if request is not a completed image request
+
+Blah_Model* Blah_Loader_Request_getModel(const Blah_Loader_Request* request);
+	//Returns the loaded model, or NULL if request is not a completed model request
+
+blah_loader_state Blah_Loader_Request_getState(const Blah_Loader_Request* request);
+	//Returns the current state of the request.  May be called from any thread.
+
+Blah_Texture* Blah_Loader_Request_getTexture(const Blah_Loader_Request* request);
+	//Returns the loaded texture, or NULL if request is not a completed texture request
+
+bool Blah_Loader_Request_isDone(const Blah_Loader_Request* request);
+	//Returns true if the request is complete or has failed
+
+#ifdef __cplusplus
+	}
+#endif //__cplusplus
+
+#endif
@@ -18,7 +18,8 @@ Blah_Material *Blah_Material_fromSurface(Blah_Model_Surface *surface) {
 	Blah_Material_setAmbient(newMaterial, surface->colour.red, surface->colour.green,
 		surface->colour.blue, matTransparency); //Set material ambient colour
 	Blah_Material_setDiffuse(newMaterial, surface->colour.red * surface->diffuse,
-		surface->colour.green * surface->diffuse, surface->colour.blue * surface->diffuse, 1);
+		surface->colour.green * surface->diffuse, surface->colour.blue * surface->diffuse, matTransparency);
+		//Diffuse alpha is used for lit surfaces, so it must carry the transparency too
 	Blah_Material_setSpecular(newMaterial, surface->colour.red * surface->specular,
 		surface->colour.green * surface->specular, surface->colour.blue * surface->specular, 1);
 	Blah_Material_setEmission(newMaterial, surface->colour.red * surface->luminosity,
@@ -28,6 +29,11 @@ Blah_Material *Blah_Material_fromSurface(Blah_Model_Surface *surface) {
 	return newMaterial;
 }
 
+bool Blah_Material_isTranslucent(const Blah_Material *material)
+{	//Returns true if the material is partly transparent
+	return material->diffuse.alpha < 1.0f || material->ambient.alpha < 1.0f;
+}
+
 void Blah_Material_init(Blah_Material *material)
 {	//Initialises given material structure to defaults
 	Blah_Material_setDefaults(material);	//For now, all this function does is call the setDefaults function
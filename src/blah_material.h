@@ -44,6 +44,10 @@ typedef struct Blah_Material {
 Blah_Material *Blah_Material_fromSurface(struct Blah_Model_Surface *surface);
 	//Creates a new material from a model surface
 
+bool Blah_Material_isTranslucent(const Blah_Material *material);
+	//Returns true if the material is partly transparent, so surfaces using it must be
+	//drawn after opaque surfaces and ordered back to front
+
 void Blah_Material_init(Blah_Material *material);
 	//Initialises given material structure to defaults
 
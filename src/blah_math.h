@@ -0,0 +1,349 @@
+/* blah_math.h
+	Inline matrix and quaternion arithmetic, for use where it is called often enough that the cost
+	of a function call matters, such as in per entity or per vertex loops.  The Blah_Matrix, Blah_Point,
+	Blah_Vector and Blah_Quaternion functions which do the same work are wrappers around these.
+	The instruction set is chosen when compiling.  SSE2 is used wherever it is available, which is
+	always on x86-64, and AVX is used in addition for the array transforms when building with -mavx
+	or -mavx2.  Elsewhere, or when BLAH_MATH_NO_SIMD is defined, plain C is used instead.
+	Matrix products and transforms add their terms in the same order whichever is used, so results
+	are identical unless the compiler contracts the plain C into fused multiply-adds.  Inversion and
+	normalisation sum in a different order, so may differ in the last bit.
+	Matrices are column major, as OpenGL, with axisX to axisZ and location as the columns, so
+	transforming by a*b transforms by b first and then by a. */
+
+#ifndef _BLAH_MATH
+
+#define _BLAH_MATH
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "blah_matrix.h"
+#include "blah_point.h"
+#include "blah_quaternion.h"
+#include "blah_types.h"
+#include "blah_vector.h"
+
+#if !defined(BLAH_MATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+	#define BLAH_MATH_SSE2
+	#include <emmintrin.h>
+	#ifdef __AVX__
+		#define BLAH_MATH_AVX
+		#include <immintrin.h>
+	#endif //__AVX__
+#endif //BLAH_MATH_NO_SIMD
+
+/* Definitions */
+
+#define BLAH_MATH_SLERP_LINEAR_DOT 0.9995f	//Cosine of half angle above which slerp interpolates linearly
+
+#ifdef BLAH_MATH_SSE2
+	//Selects lanes i0 and i1 of u and lanes i2 and i3 of v
+	#define BLAH_MATH_SHUFFLE(u, v, i0, i1, i2, i3) _mm_shuffle_ps(u, v, _MM_SHUFFLE(i3, i2, i1, i0))
+#endif //BLAH_MATH_SSE2
+
+/* Static Inline Function Definitions */
+
+static inline float blah_math_getMatrixElement(const Blah_Matrix *matrix, int row, int column)
+{	//Returns the element of the matrix at given row and column, each from 0 to 3
+	return ((const float*)matrix)[row + 4 * column];
+}
+
+static inline void blah_math_multiplyMatrices(Blah_Matrix *dest, const Blah_Matrix *matrix1, const Blah_Matrix *matrix2)
+{	//Stores matrix1*matrix2 in dest, which may be either of them
+	const float *left = (const float*)matrix1;
+	const float *right = (const float*)matrix2;
+#if defined(BLAH_MATH_AVX)
+	//Two result columns at once, each the left columns weighted by a right column's elements
+	const __m256 left0 = _mm256_broadcast_ps((const __m128*)left), left1 = _mm256_broadcast_ps((const __m128*)(left + 4));
+	const __m256 left2 = _mm256_broadcast_ps((const __m128*)(left + 8)), left3 = _mm256_broadcast_ps((const __m128*)(left + 12));
+	__m256 result[2];
+	for (int half = 0; half < 2; half++) {
+		const __m256 columns = _mm256_loadu_ps(right + 8 * half);
+		result[half] = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+			_mm256_mul_ps(left0, _mm256_permute_ps(columns, 0x00)), _mm256_mul_ps(left1, _mm256_permute_ps(columns, 0x55))),
+			_mm256_mul_ps(left2, _mm256_permute_ps(columns, 0xAA))), _mm256_mul_ps(left3, _mm256_permute_ps(columns, 0xFF)));
+	}
+	_mm256_storeu_ps((float*)dest, result[0]);
+	_mm256_storeu_ps((float*)dest + 8, result[1]);
+#elif defined(BLAH_MATH_SSE2)
+	const __m128 left0 = _mm_loadu_ps(left), left1 = _mm_loadu_ps(left + 4);
+	const __m128 left2 = _mm_loadu_ps(left + 8), left3 = _mm_loadu_ps(left + 12);
+	__m128 result[4];
+	for (int column = 0; column < 4; column++) {
+		const __m128 weights = _mm_loadu_ps(right + 4 * column);
+		result[column] = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(left0, BLAH_MATH_SHUFFLE(weights, weights, 0, 0, 0, 0)), _mm_mul_ps(left1, BLAH_MATH_SHUFFLE(weights, weights, 1, 1, 1, 1))),
+			_mm_mul_ps(left2, BLAH_MATH_SHUFFLE(weights, weights, 2, 2, 2, 2))), _mm_mul_ps(left3, BLAH_MATH_SHUFFLE(weights, weights, 3, 3, 3, 3)));
+	}
+	for (int column = 0; column < 4; column++) { _mm_storeu_ps((float*)dest + 4 * column, result[column]); }
+#else
+	float result[16];
+	for (int column = 0; column < 4; column++) {
+		for (int row = 0; row < 4; row++) {
+			result[row + 4 * column] = left[row] * right[4 * column] + left[row + 4] * right[4 * column + 1]
+				+ left[row + 8] * right[4 * column + 2] + left[row + 12] * right[4 * column + 3];
+		}
+	}
+	memcpy(dest, result, sizeof(result));
+#endif
+}
+
+static inline bool blah_math_invertMatrix(Blah_Matrix *dest, const Blah_Matrix *matrix)
+{	//Stores the inverse of matrix in dest, which may be the same matrix.  Returns false, leaving
+	//dest unchanged, if the matrix has no inverse.
+	const float *m = (const float*)matrix;
+#ifdef BLAH_MATH_SSE2
+	//Inverts as four 2x2 blocks A B C D, each held in one register as a row major 2x2 matrix.  The
+	//column major matrix is read as its row major transpose, whose inverse is transposed back by
+	//reading it column major in turn.  Adj(X) is the adjugate, |X| the determinant of block X.
+	const __m128 row0 = _mm_loadu_ps(m), row1 = _mm_loadu_ps(m + 4), row2 = _mm_loadu_ps(m + 8), row3 = _mm_loadu_ps(m + 12);
+	const __m128 a = _mm_movelh_ps(row0, row1), b = _mm_movehl_ps(row1, row0);
+	const __m128 c = _mm_movelh_ps(row2, row3), d = _mm_movehl_ps(row3, row2);
+	const __m128 blockDets = _mm_sub_ps( //|A| |B| |C| |D|
+		_mm_mul_ps(BLAH_MATH_SHUFFLE(row0, row2, 0, 2, 0, 2), BLAH_MATH_SHUFFLE(row1, row3, 1, 3, 1, 3)),
+		_mm_mul_ps(BLAH_MATH_SHUFFLE(row0, row2, 1, 3, 1, 3), BLAH_MATH_SHUFFLE(row1, row3, 0, 2, 0, 2)));
+	const __m128 detA = BLAH_MATH_SHUFFLE(blockDets, blockDets, 0, 0, 0, 0);
+	const __m128 detB = BLAH_MATH_SHUFFLE(blockDets, blockDets, 1, 1, 1, 1);
+	const __m128 detC = BLAH_MATH_SHUFFLE(blockDets, blockDets, 2, 2, 2, 2);
+	const __m128 detD = BLAH_MATH_SHUFFLE(blockDets, blockDets, 3, 3, 3, 3);
+	//Adj(D)*C and Adj(A)*B
+	const __m128 adjDC = _mm_sub_ps(_mm_mul_ps(BLAH_MATH_SHUFFLE(d, d, 3, 3, 0, 0), c),
+		_mm_mul_ps(BLAH_MATH_SHUFFLE(d, d, 1, 1, 2, 2), BLAH_MATH_SHUFFLE(c, c, 2, 3, 0, 1)));
+	const __m128 adjAB = _mm_sub_ps(_mm_mul_ps(BLAH_MATH_SHUFFLE(a, a, 3, 3, 0, 0), b),
+		_mm_mul_ps(BLAH_MATH_SHUFFLE(a, a, 1, 1, 2, 2), BLAH_MATH_SHUFFLE(b, b, 2, 3, 0, 1)));
+	//Adjugates of the blocks of the inverse, before division by the determinant:
+	//X = |D|A - B*Adj(D)*C, W = |A|D - C*Adj(A)*B, Y = |B|C - D*Adj(Adj(A)*B), Z = |C|B - A*Adj(Adj(D)*C)
+	__m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), _mm_add_ps(_mm_mul_ps(b, BLAH_MATH_SHUFFLE(adjDC, adjDC, 0, 3, 0, 3)),
+		_mm_mul_ps(BLAH_MATH_SHUFFLE(b, b, 1, 0, 3, 2), BLAH_MATH_SHUFFLE(adjDC, adjDC, 2, 1, 2, 1))));
+	__m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), _mm_add_ps(_mm_mul_ps(c, BLAH_MATH_SHUFFLE(adjAB, adjAB, 0, 3, 0, 3)),
+		_mm_mul_ps(BLAH_MATH_SHUFFLE(c, c, 1, 0, 3, 2), BLAH_MATH_SHUFFLE(adjAB, adjAB, 2, 1, 2, 1))));
+	__m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), _mm_sub_ps(_mm_mul_ps(d, BLAH_MATH_SHUFFLE(adjAB, adjAB, 3, 0, 3, 0)),
+		_mm_mul_ps(BLAH_MATH_SHUFFLE(d, d, 1, 0, 3, 2), BLAH_MATH_SHUFFLE(adjAB, adjAB, 2, 1, 2, 1))));
+	__m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), _mm_sub_ps(_mm_mul_ps(a, BLAH_MATH_SHUFFLE(adjDC, adjDC, 3, 0, 3, 0)),
+		_mm_mul_ps(BLAH_MATH_SHUFFLE(a, a, 1, 0, 3, 2), BLAH_MATH_SHUFFLE(adjDC, adjDC, 2, 1, 2, 1))));
+	//|M| = |A||D| + |B||C| - trace(Adj(A)*B*Adj(D)*C)
+	__m128 trace = _mm_mul_ps(adjAB, BLAH_MATH_SHUFFLE(adjDC, adjDC, 0, 2, 1, 3));
+	trace = _mm_add_ps(trace, BLAH_MATH_SHUFFLE(trace, trace, 2, 3, 0, 1));
+	trace = _mm_add_ps(trace, BLAH_MATH_SHUFFLE(trace, trace, 1, 0, 3, 2));
+	const __m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+	if (_mm_cvtss_f32(det) == 0) { return false; }
+	const __m128 signedReciprocal = _mm_div_ps(_mm_setr_ps(1, -1, -1, 1), det);
+	x = _mm_mul_ps(x, signedReciprocal); y = _mm_mul_ps(y, signedReciprocal);
+	z = _mm_mul_ps(z, signedReciprocal); w = _mm_mul_ps(w, signedReciprocal);
+	//Takes the adjugate of each block while storing
+	_mm_storeu_ps((float*)dest, BLAH_MATH_SHUFFLE(x, y, 3, 1, 3, 1));
+	_mm_storeu_ps((float*)dest + 4, BLAH_MATH_SHUFFLE(x, y, 2, 0, 2, 0));
+	_mm_storeu_ps((float*)dest + 8, BLAH_MATH_SHUFFLE(z, w, 3, 1, 3, 1));
+	_mm_storeu_ps((float*)dest + 12, BLAH_MATH_SHUFFLE(z, w, 2, 0, 2, 0));
+	return true;
+#else
+	//Cofactor expansion, reusing the 2x2 determinants of the top two and bottom two rows
+	const float s0 = m[0] * m[5] - m[4] * m[1], s1 = m[0] * m[9] - m[8] * m[1], s2 = m[0] * m[13] - m[12] * m[1];
+	const float s3 = m[4] * m[9] - m[8] * m[5], s4 = m[4] * m[13] - m[12] * m[5], s5 = m[8] * m[13] - m[12] * m[9];
+	const float c5 = m[10] * m[15] - m[14] * m[11], c4 = m[6] * m[15] - m[14] * m[7], c3 = m[6] * m[11] - m[10] * m[7];
+	const float c2 = m[2] * m[15] - m[14] * m[3], c1 = m[2] * m[11] - m[10] * m[3], c0 = m[2] * m[7] - m[6] * m[3];
+	const float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	float result[16];
+
+	if (det == 0) { return false; }
+	const float reciprocal = 1 / det;
+	result[0] = (m[5] * c5 - m[9] * c4 + m[13] * c3) * reciprocal;
+	result[4] = (-m[4] * c5 + m[8] * c4 - m[12] * c3) * reciprocal;
+	result[8] = (m[7] * s5 - m[11] * s4 + m[15] * s3) * reciprocal;
+	result[12] = (-m[6] * s5 + m[10] * s4 - m[14] * s3) * reciprocal;
+	result[1] = (-m[1] * c5 + m[9] * c2 - m[13] * c1) * reciprocal;
+	result[5] = (m[0] * c5 - m[8] * c2 + m[12] * c1) * reciprocal;
+	result[9] = (-m[3] * s5 + m[11] * s2 - m[15] * s1) * reciprocal;
+	result[13] = (m[2] * s5 - m[10] * s2 + m[14] * s1) * reciprocal;
+	result[2] = (m[1] * c4 - m[5] * c2 + m[13] * c0) * reciprocal;
+	result[6] = (-m[0] * c4 + m[4] * c2 - m[12] * c0) * reciprocal;
+	result[10] = (m[3] * s4 - m[7] * s2 + m[15] * s0) * reciprocal;
+	result[14] = (-m[2] * s4 + m[6] * s2 - m[14] * s0) * reciprocal;
+	result[3] = (-m[1] * c3 + m[5] * c1 - m[9] * c0) * reciprocal;
+	result[7] = (m[0] * c3 - m[4] * c1 + m[8] * c0) * reciprocal;
+	result[11] = (-m[3] * s3 + m[7] * s1 - m[11] * s0) * reciprocal;
+	result[15] = (m[2] * s3 - m[6] * s1 + m[10] * s0) * reciprocal;
+	memcpy(dest, result, sizeof(result));
+	return true;
+#endif //BLAH_MATH_SSE2
+}
+
+static inline void blah_math_transformTriple(float *dest, const float *src, const Blah_Matrix *matrix, bool translate)
+{	//Transforms three coordinates by the matrix, including its translation if translate is true.
+	//Dest may be the same as src.  Use blah_math_transformPoint or blah_math_transformVector.
+	const float *m = (const float*)matrix;
+#ifdef BLAH_MATH_SSE2
+	__m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(m), _mm_set1_ps(src[0])),
+		_mm_mul_ps(_mm_loadu_ps(m + 4), _mm_set1_ps(src[1]))), _mm_mul_ps(_mm_loadu_ps(m + 8), _mm_set1_ps(src[2])));
+	if (translate) { result = _mm_add_ps(result, _mm_loadu_ps(m + 12)); }
+	_mm_storel_pi((__m64*)dest, result); //Stores only three floats, as dest may be followed by other data
+	_mm_store_ss(dest + 2, _mm_movehl_ps(result, result));
+#else
+	float result[3];
+	for (int row = 0; row < 3; row++) {
+		result[row] = m[row] * src[0] + m[row + 4] * src[1] + m[row + 8] * src[2];
+		if (translate) { result[row] += m[row + 12]; }
+	}
+	memcpy(dest, result, sizeof(result));
+#endif //BLAH_MATH_SSE2
+}
+
+static inline void blah_math_transformPoint(Blah_Point *dest, const Blah_Point *point, const Blah_Matrix *matrix)
+{	//Stores in dest the point transformed by the matrix, including its translation
+	blah_math_transformTriple((float*)dest, (const float*)point, matrix, true);
+}
+
+static inline void blah_math_transformVector(Blah_Vector *dest, const Blah_Vector *vector, const Blah_Matrix *matrix)
+{	//Stores in dest the vector transformed by the matrix, without its translation
+	blah_math_transformTriple((float*)dest, (const float*)vector, matrix, false);
+}
+
+#ifdef BLAH_MATH_SSE2
+static inline void blah_math_transformQuad(float *dest, const float *src, const float *elements, bool translate)
+{	//Transforms four consecutive triples of coordinates at once by the matrix elements, a copy which
+	//cannot overlap dest.  All are read before any is written, so dest may be the same as src.
+	//Triples are read and written as three registers x0y0z0x1 y1z1x2y2 z2x3y3z3, rearranged to and
+	//from one register per coordinate.
+	const __m128 in0 = _mm_loadu_ps(src), in1 = _mm_loadu_ps(src + 4), in2 = _mm_loadu_ps(src + 8);
+	const __m128 aa = BLAH_MATH_SHUFFLE(in0, in1, 1, 1, 0, 0), bb = BLAH_MATH_SHUFFLE(in0, in1, 2, 2, 1, 1);
+	const __m128 x = BLAH_MATH_SHUFFLE(in0, BLAH_MATH_SHUFFLE(in1, in2, 2, 2, 1, 1), 0, 3, 0, 2);
+	const __m128 y = BLAH_MATH_SHUFFLE(aa, BLAH_MATH_SHUFFLE(in1, in2, 3, 3, 2, 2), 0, 2, 0, 2);
+	const __m128 z = BLAH_MATH_SHUFFLE(bb, in2, 0, 2, 0, 3);
+	__m128 out[3];
+
+	for (int row = 0; row < 3; row++) {
+		out[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(elements[row]), x), _mm_mul_ps(_mm_set1_ps(elements[row + 4]), y)),
+			_mm_mul_ps(_mm_set1_ps(elements[row + 8]), z));
+		if (translate) { out[row] = _mm_add_ps(out[row], _mm_set1_ps(elements[row + 12])); }
+	}
+	_mm_storeu_ps(dest, BLAH_MATH_SHUFFLE(BLAH_MATH_SHUFFLE(out[0], out[1], 0, 0, 0, 0), BLAH_MATH_SHUFFLE(out[2], out[0], 0, 0, 1, 1), 0, 2, 0, 2));
+	_mm_storeu_ps(dest + 4, BLAH_MATH_SHUFFLE(BLAH_MATH_SHUFFLE(out[1], out[2], 1, 1, 1, 1), BLAH_MATH_SHUFFLE(out[0], out[1], 2, 2, 2, 2), 0, 2, 0, 2));
+	_mm_storeu_ps(dest + 8, BLAH_MATH_SHUFFLE(BLAH_MATH_SHUFFLE(out[2], out[0], 2, 2, 3, 3), BLAH_MATH_SHUFFLE(out[1], out[2], 3, 3, 3, 3), 0, 2, 0, 2));
+}
+#endif //BLAH_MATH_SSE2
+
+#ifdef BLAH_MATH_AVX
+#define BLAH_MATH_SHUFFLE256(u, v, i0, i1, i2, i3) _mm256_shuffle_ps(u, v, _MM_SHUFFLE(i3, i2, i1, i0))
+
+static inline void blah_math_transformOctet(float *dest, const float *src, const float *elements, bool translate)
+{	//As blah_math_transformQuad, for eight triples, with the first four in the low half of each
+	//register and the last four in the high half.  Shuffles stay within each half.
+	const __m256 in0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src)), _mm_loadu_ps(src + 12), 1);
+	const __m256 in1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 4)), _mm_loadu_ps(src + 16), 1);
+	const __m256 in2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 8)), _mm_loadu_ps(src + 20), 1);
+	const __m256 aa = BLAH_MATH_SHUFFLE256(in0, in1, 1, 1, 0, 0), bb = BLAH_MATH_SHUFFLE256(in0, in1, 2, 2, 1, 1);
+	const __m256 x = BLAH_MATH_SHUFFLE256(in0, BLAH_MATH_SHUFFLE256(in1, in2, 2, 2, 1, 1), 0, 3, 0, 2);
+	const __m256 y = BLAH_MATH_SHUFFLE256(aa, BLAH_MATH_SHUFFLE256(in1, in2, 3, 3, 2, 2), 0, 2, 0, 2);
+	const __m256 z = BLAH_MATH_SHUFFLE256(bb, in2, 0, 2, 0, 3);
+	__m256 out[3], packed[3];
+
+	for (int row = 0; row < 3; row++) {
+		out[row] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(elements[row]), x), _mm256_mul_ps(_mm256_set1_ps(elements[row + 4]), y)),
+			_mm256_mul_ps(_mm256_set1_ps(elements[row + 8]), z));
+		if (translate) { out[row] = _mm256_add_ps(out[row], _mm256_set1_ps(elements[row + 12])); }
+	}
+	packed[0] = BLAH_MATH_SHUFFLE256(BLAH_MATH_SHUFFLE256(out[0], out[1], 0, 0, 0, 0), BLAH_MATH_SHUFFLE256(out[2], out[0], 0, 0, 1, 1), 0, 2, 0, 2);
+	packed[1] = BLAH_MATH_SHUFFLE256(BLAH_MATH_SHUFFLE256(out[1], out[2], 1, 1, 1, 1), BLAH_MATH_SHUFFLE256(out[0], out[1], 2, 2, 2, 2), 0, 2, 0, 2);
+	packed[2] = BLAH_MATH_SHUFFLE256(BLAH_MATH_SHUFFLE256(out[2], out[0], 2, 2, 3, 3), BLAH_MATH_SHUFFLE256(out[1], out[2], 3, 3, 3, 3), 0, 2, 0, 2);
+	for (int part = 0; part < 3; part++) {
+		_mm_storeu_ps(dest + 4 * part, _mm256_castps256_ps128(packed[part]));
+		_mm_storeu_ps(dest + 12 + 4 * part, _mm256_extractf128_ps(packed[part], 1));
+	}
+}
+#endif //BLAH_MATH_AVX
+
+static inline void blah_math_transformTriples(float *dest, const float *src, size_t count, const Blah_Matrix *matrix, bool translate)
+{	//Transforms count consecutive triples of coordinates by the matrix.  Dest may be the same as src,
+	//but must not otherwise overlap it.  Use blah_math_transformPoints or blah_math_transformVectors.
+#ifdef BLAH_MATH_SSE2
+	float elements[16]; //Copied, so the compiler knows writes to dest cannot change them and keeps them in registers
+
+	memcpy(elements, matrix, sizeof(elements));
+#ifdef BLAH_MATH_AVX
+	for (; count >= 8; count -= 8, dest += 24, src += 24) { blah_math_transformOctet(dest, src, elements, translate); }
+#endif //BLAH_MATH_AVX
+	for (; count >= 4; count -= 4, dest += 12, src += 12) { blah_math_transformQuad(dest, src, elements, translate); }
+#endif //BLAH_MATH_SSE2
+	for (; count > 0; count--, dest += 3, src += 3) { blah_math_transformTriple(dest, src, matrix, translate); }
+}
+
+static inline void blah_math_transformPoints(Blah_Point *dest, const Blah_Point *points, size_t count, const Blah_Matrix *matrix)
+{	//Stores in dest count points transformed by the matrix, including its translation.  Dest may be
+	//the same array as points, but must not otherwise overlap it.
+	blah_math_transformTriples((float*)dest, (const float*)points, count, matrix, true);
+}
+
+static inline void blah_math_transformVectors(Blah_Vector *dest, const Blah_Vector *vectors, size_t count, const Blah_Matrix *matrix)
+{	//Stores in dest count vectors transformed by the matrix, without its translation.  Dest may be
+	//the same array as vectors, but must not otherwise overlap it.
+	blah_math_transformTriples((float*)dest, (const float*)vectors, count, matrix, false);
+}
+
+static inline void blah_math_multiplyQuaternions(Blah_Quaternion *dest, const Blah_Quaternion *quat1, const Blah_Quaternion *quat2)
+{	//Stores quat1*quat2 in dest, which may be either of them.  Rotating by the result rotates by
+	//quat2 and then by quat1.
+#ifdef BLAH_MATH_SSE2
+	//Each lane sums four products in the same order as the plain C, subtracting by negating
+	const __m128 q1 = _mm_loadu_ps(&quat1->x), q2 = _mm_loadu_ps(&quat2->x);
+	const __m128 sign1 = _mm_setr_ps(0, 0, 0, -0.0f), sign2 = _mm_set1_ps(-0.0f);
+	const __m128 term0 = _mm_mul_ps(BLAH_MATH_SHUFFLE(q1, q1, 3, 3, 3, 3), q2);
+	const __m128 term1 = _mm_xor_ps(_mm_mul_ps(BLAH_MATH_SHUFFLE(q1, q1, 0, 1, 2, 0), BLAH_MATH_SHUFFLE(q2, q2, 3, 3, 3, 0)), sign1);
+	const __m128 term2 = _mm_xor_ps(_mm_mul_ps(BLAH_MATH_SHUFFLE(q1, q1, 1, 2, 0, 1), BLAH_MATH_SHUFFLE(q2, q2, 2, 0, 1, 1)), sign1);
+	const __m128 term3 = _mm_xor_ps(_mm_mul_ps(BLAH_MATH_SHUFFLE(q1, q1, 2, 0, 1, 2), BLAH_MATH_SHUFFLE(q2, q2, 1, 2, 0, 2)), sign2);
+	_mm_storeu_ps(&dest->x, _mm_add_ps(_mm_add_ps(_mm_add_ps(term0, term1), term2), term3));
+#else
+	const float w = quat1->w * quat2->w - quat1->x * quat2->x - quat1->y * quat2->y - quat1->z * quat2->z;
+	const float x = quat1->w * quat2->x + quat1->x * quat2->w + quat1->y * quat2->z - quat1->z * quat2->y;
+	const float y = quat1->w * quat2->y + quat1->y * quat2->w + quat1->z * quat2->x - quat1->x * quat2->z;
+	const float z = quat1->w * quat2->z + quat1->z * quat2->w + quat1->x * quat2->y - quat1->y * quat2->x;
+
+	dest->x = x; dest->y = y; dest->z = z; dest->w = w;
+#endif //BLAH_MATH_SSE2
+}
+
+static inline void blah_math_normaliseQuaternion(Blah_Quaternion *quat)
+{	//Scales the quaternion to unit length, so that it is a pure rotation.  A zero quaternion is unchanged.
+#ifdef BLAH_MATH_SSE2
+	const __m128 q = _mm_loadu_ps(&quat->x);
+	__m128 lengthSquared = _mm_mul_ps(q, q);
+	lengthSquared = _mm_add_ps(lengthSquared, BLAH_MATH_SHUFFLE(lengthSquared, lengthSquared, 2, 3, 0, 1));
+	lengthSquared = _mm_add_ps(lengthSquared, BLAH_MATH_SHUFFLE(lengthSquared, lengthSquared, 1, 0, 3, 2));
+	if (_mm_cvtss_f32(lengthSquared) > 0) { _mm_storeu_ps(&quat->x, _mm_div_ps(q, _mm_sqrt_ps(lengthSquared))); }
+#else
+	const float length = sqrtf(quat->x * quat->x + quat->y * quat->y + quat->z * quat->z + quat->w * quat->w);
+	if (length > 0) {
+		quat->x /= length; quat->y /= length; quat->z /= length; quat->w /= length;
+	}
+#endif //BLAH_MATH_SSE2
+}
+
+static inline void blah_math_slerpQuaternions(Blah_Quaternion *dest, const Blah_Quaternion *quat1, const Blah_Quaternion *quat2, float fraction)
+{	//Stores in dest the rotation the given fraction of the way from quat1 to quat2 at constant angular
+	//speed, taking the shorter way round.  Dest may be either quaternion.  Both should be unit length.
+	float dot = quat1->x * quat2->x + quat1->y * quat2->y + quat1->z * quat2->z + quat1->w * quat2->w;
+	const float sign = dot < 0 ? -1.0f : 1.0f; //q and -q are the same rotation, so take the nearer
+	float from, to;
+
+	dot *= sign;
+	if (dot > BLAH_MATH_SLERP_LINEAR_DOT) { //Sine of angle too small to divide by, but linear is as good
+		from = 1 - fraction; to = fraction * sign;
+	} else {
+		const float angle = acosf(dot);
+		const float sine = sinf(angle);
+		from = sinf((1 - fraction) * angle) / sine;
+		to = sinf(fraction * angle) / sine * sign;
+	}
+#ifdef BLAH_MATH_SSE2
+	_mm_storeu_ps(&dest->x, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&quat1->x), _mm_set1_ps(from)),
+		_mm_mul_ps(_mm_loadu_ps(&quat2->x), _mm_set1_ps(to))));
+#else
+	const float x = quat1->x * from + quat2->x * to, y = quat1->y * from + quat2->y * to;
+	const float z = quat1->z * from + quat2->z * to, w = quat1->w * from + quat2->w * to;
+	dest->x = x; dest->y = y; dest->z = z; dest->w = w;
+#endif //BLAH_MATH_SSE2
+	blah_math_normaliseQuaternion(dest); //Removes rounding drift, and the error of the linear case
+}
+
+#endif
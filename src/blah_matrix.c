@@ -6,6 +6,7 @@
 #include "blah_matrix.h"
 #include "blah_quaternion.h"
 #include "blah_macros.h"
+#include "blah_math.h"
 
 /* Function Definitions */
 
@@ -39,26 +40,15 @@ void Blah_Matrix_init(Blah_Matrix *matrix)
 	Blah_Matrix_setIdentity(matrix);
 }
 
-// FIXME - This function relies upon the matrix structure being packed into memory as an array
-// of 16 floats, which is likely assuming same alignment for both structures, but not guaranteed
-/* void Blah_Matrix_multiply(Blah_Matrix *matrix1, Blah_Matrix *matrix2) {  //multiplies matrix_1 by matrix_2
-	int resultCell, matrix1Cell, matrix2Cell, count;
-	float result[16]={0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0};
-
-	for (resultCell = 0; resultCell < blah_countof(result); resultCell++) {
-		//result[result_cell] = 0;
-		// THIS LOOKS ALL WRONG.  IT PROBABLY NEVER WORKED AND HAS NEVER BEEN USED
-		matrix1Cell = resultCell & 3;	//result_cell mod 4
-		matrix2Cell = resultCell & 252; //result_cell integer div 4 * 4
-		for (count = 0;count < 4;count++) {
-			result[resultCell] += ((float*)matrix1)[matrix1Cell] * ((float*)matrix2)[matrix2Cell];
-			matrix1Cell += 4;
-			matrix2Cell++;
-		} //sum products of m2 * m1
-	}
-    // Copy the result into matrix1
-    memcpy(matrix1, result, sizeof(float)*16); //copy result data into matrix_1
-} */
+bool Blah_Matrix_invert(Blah_Matrix *matrix)
+{	//Replaces the matrix with its inverse, if it has one
+	return blah_math_invertMatrix(matrix, matrix);
+}
+
+void Blah_Matrix_multiply(Blah_Matrix *matrix1, Blah_Matrix *matrix2)
+{	//multiplies matrix_1 by matrix_2
+	blah_math_multiplyMatrices(matrix1, matrix1, matrix2);
+}
 
 Blah_Matrix *Blah_Matrix_new()
 {	//constructs a new identity matrix
@@ -118,3 +108,12 @@ void Blah_Matrix_sprintf(char *dest, Blah_Matrix *matrixSrc) {
 		matrix[3],matrix[7],matrix[11],matrix[15]);
 }
 
+void Blah_Matrix_transformPoints(Blah_Matrix *matrix, Blah_Point *points, size_t count)
+{	//Multiplies the coordinates of each point by the matrix, including its translation
+	blah_math_transformPoints(points, points, count, matrix);
+}
+
+void Blah_Matrix_transformVectors(Blah_Matrix *matrix, Blah_Vector *vectors, size_t count)
+{	//Multiplies each vector by the matrix, without its translation
+	blah_math_transformVectors(vectors, vectors, count, matrix);
+}
@@ -4,9 +4,12 @@
 
 #define _BLAH_MATRIX
 
+#include <stddef.h>
+
 #include "blah_vector.h"
 #include "blah_point.h"
 #include "blah_quaternion.h"
+#include "blah_types.h"
 
 typedef struct Blah_Matrix { //Vector is a complex array of float values representing location and orientation in 3d space
 	Blah_Vector axisX; float scaleX;
@@ -30,8 +33,12 @@ void Blah_Matrix_formatQuaternion(Blah_Matrix *matrix, Blah_Quaternion *quat);
 void Blah_Matrix_init(Blah_Matrix *matrix);
 	//Initialises a matrix structure (just sets to identity matrix)
 
-// void Blah_Matrix_multiply(Blah_Matrix *matrix1, Blah_Matrix *matrix2);
-	//multiplies matrix_1 by matrix_2
+bool Blah_Matrix_invert(Blah_Matrix *matrix);
+	//Replaces the matrix with its inverse.  Returns false, leaving it unchanged, if it has none.
+
+void Blah_Matrix_multiply(Blah_Matrix *matrix1, Blah_Matrix *matrix2);
+	//Multiplies matrix_1 by matrix_2 and stores result in matrix_1, as glMultMatrix does, so that
+	//transforming by the result transforms by matrix_2 first
 
 Blah_Matrix *Blah_Matrix_new();
 	//constructs a new identity matrix
@@ -56,6 +63,12 @@ void Blah_Matrix_setTranslation(Blah_Matrix *matrix, float x, float y, float z);
 
 void Blah_Matrix_sprintf(char *dest, Blah_Matrix *matrixSrc);
 
+void Blah_Matrix_transformPoints(Blah_Matrix *matrix, Blah_Point *points, size_t count);
+	//Multiplies the coordinates of each of count points by the matrix, including its translation
+
+void Blah_Matrix_transformVectors(Blah_Matrix *matrix, Blah_Vector *vectors, size_t count);
+	//Multiplies each of count vectors by the matrix, without its translation, as for normals
+
 #ifdef __cplusplus
 	}
 #endif //__cplusplus
@@ -0,0 +1,228 @@
+/* blah_mesh.c
+	Defines functions which compile objects into meshes of indexed triangles.  See blah_mesh.h for reference. */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blah_mesh.h"
+#include "blah_error.h"
+#include "blah_file.h"
+#include "blah_object.h"
+
+/* Externally Referenced Variables */
+
+extern Blah_Material blah_draw_defaultMaterial;
+
+/* Structure Definitions */
+
+typedef struct Blah_Mesh_Sort_Entry { //Primitive to compile, with key to group it by
+	const Blah_Primitive* primitive;
+	Blah_Material* material;
+	const Blah_Texture* texture;
+	size_t index;				//Position in object, to keep order within groups
+} Blah_Mesh_Sort_Entry;
+
+/* Static Function Definitions */
+
+static size_t Blah_Mesh_triangleCount(const Blah_Primitive *primitive, size_t vertexCount)
+{	//Returns number of triangles a compilable primitive with given number of vertices is made of
+	switch (primitive->type) {
+		case BLAH_PRIMITIVE_TRIANGLE : return vertexCount / 3;
+		case BLAH_PRIMITIVE_QUADRILATERAL : return vertexCount / 4 * 2;
+		default : return vertexCount - 2; //polygon fan or triangle strip
+	}
+}
+
+static blah_unsigned32 *Blah_Mesh_addTriangles(blah_unsigned32 *indices, const Blah_Primitive *primitive, size_t vertexCount, blah_unsigned32 base)
+{	//Writes indices of the triangles of primitive, whose vertices start at index 'base', and
+	//returns the position following the last index written.  Winding matches GL primitive modes.
+	size_t vertexIndex;
+
+	switch (primitive->type) {
+		case BLAH_PRIMITIVE_TRIANGLE :
+			for (vertexIndex = 0; vertexIndex + 3 <= vertexCount; vertexIndex += 3) {
+				*indices++ = base + vertexIndex; *indices++ = base + vertexIndex + 1; *indices++ = base + vertexIndex + 2;
+			}
+			break;
+		case BLAH_PRIMITIVE_QUADRILATERAL :
+			for (vertexIndex = 0; vertexIndex + 4 <= vertexCount; vertexIndex += 4) {
+				*indices++ = base + vertexIndex; *indices++ = base + vertexIndex + 1; *indices++ = base + vertexIndex + 2;
+				*indices++ = base + vertexIndex; *indices++ = base + vertexIndex + 2; *indices++ = base + vertexIndex + 3;
+			}
+			break;
+		case BLAH_PRIMITIVE_TRIANLGE_STRIP :
+			for (vertexIndex = 2; vertexIndex < vertexCount; vertexIndex++) {
+				if (vertexIndex & 1) { //Odd triangles are reversed to keep winding consistent
+					*indices++ = base + vertexIndex - 1; *indices++ = base + vertexIndex - 2; *indices++ = base + vertexIndex;
+				} else {
+					*indices++ = base + vertexIndex - 2; *indices++ = base + vertexIndex - 1; *indices++ = base + vertexIndex;
+				}
+			}
+			break;
+		default : //Convex polygon drawn as a fan around the first vertex
+			for (vertexIndex = 2; vertexIndex < vertexCount; vertexIndex++) {
+				*indices++ = base; *indices++ = base + vertexIndex - 1; *indices++ = base + vertexIndex;
+			}
+			break;
+	}
+	return indices;
+}
+
+static int Blah_Mesh_compareSortEntries(const void *entry1, const void *entry2)
+{	//Orders primitives by material, then texture, then original position
+	const Blah_Mesh_Sort_Entry *sortEntry1 = entry1, *sortEntry2 = entry2;
+
+	if (sortEntry1->material != sortEntry2->material) { return sortEntry1->material < sortEntry2->material ? -1 : 1; }
+	if (sortEntry1->texture != sortEntry2->texture) { return sortEntry1->texture < sortEntry2->texture ? -1 : 1; }
+	return sortEntry1->index < sortEntry2->index ? -1 : (sortEntry1->index > sortEntry2->index);
+}
+
+/* Function Definitions */
+
+void Blah_Mesh_compileObject(Blah_Mesh *mesh, const Blah_Object *object)
+{	//Builds the arrays of the mesh from the compilable primitives of the object, grouped by material and texture
+	Blah_Mesh_Sort_Entry *entries;
+	Blah_Mesh_Vertex *vertex;
+	blah_unsigned32 *index;
+	size_t entryCount = 0, vertexCount = 0, indexCount = 0, groupCount = 0, immediateCount = 0;
+
+	Blah_Mesh_disable(mesh);
+	entries = malloc(sizeof(Blah_Mesh_Sort_Entry) * (object->primitives.length + 1));
+	if (entries == NULL) { blah_error_raise(errno, "Failed to allocate %lu primitive entries to compile object", (unsigned long)object->primitives.length); }
+
+	//Gather primitives to compile and count vertices and triangle indices
+	for (size_t primIndex = 0; primIndex < object->primitives.length; primIndex++) {
+		const Blah_Primitive *primitive = object->primitives.elements[primIndex];
+		if (Blah_Mesh_isCompilable(primitive)) {
+			size_t primVertexCount = 0;
+			while (primitive->sequence[primVertexCount]) { primVertexCount++; }
+			entries[entryCount].primitive = primitive;
+			entries[entryCount].material = primitive->material ? primitive->material : &blah_draw_defaultMaterial;
+			entries[entryCount].texture = primitive->textureMap ? primitive->textureMap->texture : NULL;
+			entries[entryCount].index = primIndex;
+			entryCount++;
+			vertexCount += primVertexCount;
+			indexCount += Blah_Mesh_triangleCount(primitive, primVertexCount) * 3;
+		} else if (primitive->sequence) {
+			immediateCount++;
+		}
+	}
+	qsort(entries, entryCount, sizeof(Blah_Mesh_Sort_Entry), Blah_Mesh_compareSortEntries);
+
+	//Vertices and indices share one allocation, vertices first to keep their alignment
+	mesh->storage = malloc(sizeof(Blah_Mesh_Vertex) * vertexCount + sizeof(blah_unsigned32) * (indexCount + 1));
+	mesh->groups = malloc(sizeof(Blah_Mesh_Group) * (entryCount + 1));
+	if (mesh->storage == NULL || mesh->groups == NULL) {
+		blah_error_raise(errno, "Failed to allocate buffers for %lu vertices to compile object", (unsigned long)vertexCount);
+	}
+	mesh->vertices = mesh->storage;
+	mesh->indices = (blah_unsigned32*)(mesh->vertices + vertexCount);
+
+	//Write one vertex per primitive corner, since texture coordinates belong to primitives
+	vertex = mesh->vertices;
+	index = mesh->indices;
+	for (size_t entryIndex = 0; entryIndex < entryCount; entryIndex++) {
+		const Blah_Mesh_Sort_Entry *entry = &entries[entryIndex];
+		const Blah_Primitive *primitive = entry->primitive;
+		const Blah_Point *mapping = primitive->textureMap ? primitive->textureMap->mapping : NULL;
+		const blah_unsigned32 base = (blah_unsigned32)(vertex - mesh->vertices);
+		size_t primVertexCount = 0;
+
+		if (groupCount == 0 || mesh->groups[groupCount - 1].material != entry->material || mesh->groups[groupCount - 1].texture != entry->texture) {
+			mesh->groups[groupCount].material = entry->material; //Start a new group
+			mesh->groups[groupCount].texture = entry->texture;
+			mesh->groups[groupCount].firstIndex = (blah_unsigned32)(index - mesh->indices);
+			mesh->groups[groupCount].indexCount = 0;
+			groupCount++;
+		}
+		while (primitive->sequence[primVertexCount]) {
+			const Blah_Vertex *sourceVertex = primitive->sequence[primVertexCount];
+			vertex->location[0] = sourceVertex->location.x;
+			vertex->location[1] = sourceVertex->location.y;
+			vertex->location[2] = sourceVertex->location.z;
+			vertex->normal[0] = sourceVertex->normal.x;
+			vertex->normal[1] = sourceVertex->normal.y;
+			vertex->normal[2] = sourceVertex->normal.z;
+			vertex->texCoord[0] = mapping ? mapping[primVertexCount].x : 0;
+			vertex->texCoord[1] = mapping ? mapping[primVertexCount].y : 0;
+			vertex++;
+			primVertexCount++;
+		}
+		blah_unsigned32 *groupStart = index;
+		index = Blah_Mesh_addTriangles(index, primitive, primVertexCount, base);
+		mesh->groups[groupCount - 1].indexCount += (blah_unsigned32)(index - groupStart);
+	}
+	free(entries);
+
+	mesh->vertexCount = vertexCount;
+	mesh->indexCount = indexCount;
+	mesh->groupCount = groupCount;
+	mesh->immediateCount = immediateCount;
+}
+
+void Blah_Mesh_disable(Blah_Mesh *mesh)
+{	//Releases everything owned by the mesh, leaving it empty
+	free(mesh->storage);
+	free(mesh->groups);
+	if (mesh->mapping) { blah_file_unmap(mesh->mapping, mesh->mappingLength); }
+	Blah_Mesh_init(mesh);
+}
+
+void Blah_Mesh_getRadius(const Blah_Mesh *mesh, float *radius)
+{	//Raises *radius to the largest distance of a vertex from the origin
+	float squareRadius = *radius * *radius;
+
+	for (size_t vertexIndex = 0; vertexIndex < mesh->vertexCount; vertexIndex++) {
+		const float *location = mesh->vertices[vertexIndex].location;
+		const float squareDistance = location[0] * location[0] + location[1] * location[1] + location[2] * location[2];
+		if (squareDistance > squareRadius) { squareRadius = squareDistance; }
+	}
+	*radius = sqrtf(squareRadius);
+}
+
+void Blah_Mesh_init(Blah_Mesh *mesh)
+{	//Initialises the mesh to be empty
+	mesh->vertices = NULL;
+	mesh->vertexCount = 0;
+	mesh->indices = NULL;
+	mesh->indexCount = 0;
+	mesh->groups = NULL;
+	mesh->groupCount = 0;
+	mesh->immediateCount = 0;
+	mesh->storage = NULL;
+	mesh->mapping = NULL;
+	mesh->mappingLength = 0;
+}
+
+bool Blah_Mesh_isCompilable(const Blah_Primitive *primitive)
+{	//Returns true if primitive is made of triangles which can be compiled into a mesh
+	if (primitive->sequence == NULL || primitive->sequence[0] == NULL || primitive->sequence[1] == NULL || primitive->sequence[2] == NULL) {
+		return false; //Need at least 3 vertices
+	}
+	switch (primitive->type) {
+		case BLAH_PRIMITIVE_POLYGON :
+		case BLAH_PRIMITIVE_TRIANGLE :
+		case BLAH_PRIMITIVE_QUADRILATERAL :
+		case BLAH_PRIMITIVE_TRIANLGE_STRIP :
+			return true;
+		default :
+			return false;
+	}
+}
+
+void Blah_Mesh_scale(Blah_Mesh *mesh, float scaleFactor)
+{	//Multiplies every vertex location by scaleFactor, copying vertices out of a file mapping first
+	if (mesh->storage == NULL && mesh->vertexCount > 0) {
+		Blah_Mesh_Vertex *vertices = malloc(sizeof(Blah_Mesh_Vertex) * mesh->vertexCount);
+		if (vertices == NULL) { blah_error_raise(errno, "Failed to allocate %lu vertices to scale mesh", (unsigned long)mesh->vertexCount); }
+		memcpy(vertices, mesh->vertices, sizeof(Blah_Mesh_Vertex) * mesh->vertexCount);
+		mesh->vertices = mesh->storage = vertices;
+	}
+	for (size_t vertexIndex = 0; vertexIndex < mesh->vertexCount; vertexIndex++) {
+		float *location = mesh->vertices[vertexIndex].location;
+		location[0] *= scaleFactor;
+		location[1] *= scaleFactor;
+		location[2] *= scaleFactor;
+	}
+}
@@ -0,0 +1,81 @@
+/* blah_mesh.h
+	A mesh is the drawing ready form of an object: one array of interleaved vertex attributes and
+	one array of triangle indices, with the indices grouped into ranges sharing a material and texture.
+	Meshes are compiled from the primitives of an object before they are handed to the drawing API,
+	and are also the contents of baked object files, so loading those needs no further processing. */
+
+#ifndef _BLAH_MESH
+
+#define _BLAH_MESH
+
+#include <stddef.h>
+
+#include "blah_types.h"
+#include "blah_material.h"
+#include "blah_primitive.h"
+#include "blah_texture.h"
+
+/* Forward Declarations */
+
+struct Blah_Object;
+
+/* Structure Definitions */
+
+typedef struct Blah_Mesh_Vertex { //Interleaved vertex attributes, one per primitive corner
+	float location[3];
+	float normal[3];
+	float texCoord[2];
+} Blah_Mesh_Vertex;
+
+typedef struct Blah_Mesh_Group { //Range of triangle indices drawn with the same material and texture
+	Blah_Material* material;
+	const Blah_Texture* texture;	//NULL if untextured
+	blah_unsigned32 firstIndex;
+	blah_unsigned32 indexCount;
+} Blah_Mesh_Group;
+
+typedef struct Blah_Mesh {
+	Blah_Mesh_Vertex* vertices;
+	size_t vertexCount;
+	blah_unsigned32* indices;	//Three per triangle, into vertices
+	size_t indexCount;
+	Blah_Mesh_Group* groups;	//Index ranges in order of drawing, sorted by material then texture
+	size_t groupCount;
+	size_t immediateCount;		//Number of primitives of the source object which could not be compiled
+	void* storage;				//Allocation holding vertices and indices, NULL if they are not owned by the mesh
+	const void* mapping;		//File mapping the arrays point into, NULL if none
+	size_t mappingLength;
+} Blah_Mesh;
+
+/* Function Prototypes */
+
+#ifdef __cplusplus
+	extern "C" {
+#endif //__cplusplus
+
+void Blah_Mesh_compileObject(Blah_Mesh* mesh, const struct Blah_Object* object);
+	//Builds the arrays of the mesh from the compilable primitives of the given object, one vertex per
+	//primitive corner.  Primitives keep their order within each group.  Any previous contents of the
+	//mesh are released.  Raises an error if memory could not be allocated.
+
+void Blah_Mesh_disable(Blah_Mesh* mesh);
+	//Releases the storage, groups and file mapping owned by the mesh, leaving it empty
+
+void Blah_Mesh_getRadius(const Blah_Mesh* mesh, float* radius);
+	//Raises *radius to the largest distance of any mesh vertex from the origin, if larger
+
+void Blah_Mesh_init(Blah_Mesh* mesh);
+	//Initialises the mesh to be empty
+
+bool Blah_Mesh_isCompilable(const Blah_Primitive* primitive);
+	//Returns true if the primitive is made of triangles which can be compiled into a mesh
+
+void Blah_Mesh_scale(Blah_Mesh* mesh, float scaleFactor);
+	//Multiplies the location of every mesh vertex by scaleFactor.  Vertices lying in a file mapping
+	//are first copied into storage owned by the mesh.
+
+#ifdef __cplusplus
+	}
+#endif //__cplusplus
+
+#endif
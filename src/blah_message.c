@@ -4,6 +4,7 @@
 
 #include <string.h>
 #include <stdarg.h>
+#include <stdbool.h>
 
 #include "blah_message.h"
 #include "blah_time.h"
@@ -37,13 +38,10 @@ void blah_message_writeToFileVA(FILE* file, const char* messageFormat, va_list v
     fflush(file);
 }
 
-// Internal function that accepts va_list directly like vprintf for internal use.
-// Write formatted error message to file stream with new line character appended and flush the stream
-// All errors going to a FILE should use this function.
-void blah_message_writeErrorToFileVA(FILE* file, int errorCode, const char* messageFormat, va_list varArgs)
+// Internal function only.  Write the error code and its description to file, as at the start of error messages.
+// Does not append new line character or flush the stream
+static void blah_message_writeErrorCodeToFile(FILE* file, int errorCode)
 {
-    // Write timestamp first
-    blah_message_writeTimeStampToFile(file);
     // Write the error code to the file stream
     char errorCodeString[ERROR_CODE_MAX_LENGTH];
     if (errorCode == 0 || snprintf(errorCodeString, blah_countof(errorCodeString), "%d", errorCode) >= ERROR_CODE_MAX_LENGTH) {
@@ -57,13 +55,34 @@ void blah_message_writeErrorToFileVA(FILE* file, int errorCode, const char* mess
         strerror_s(errorDescription, sizeof(errorDescription), errorCode);
         fprintf(file, " - %s", errorDescription);
     }
+    fputs(".  ", file); // The formatted message supplied with the error code follows
+}
+
+// Internal function that accepts va_list directly like vprintf for internal use.
+// Write formatted error message to file stream with new line character appended and flush the stream
+// All errors going to a FILE should use this function.
+void blah_message_writeErrorToFileVA(FILE* file, int errorCode, const char* messageFormat, va_list varArgs)
+{
+    // Write timestamp first
+    blah_message_writeTimeStampToFile(file);
+    blah_message_writeErrorCodeToFile(file, errorCode);
     // Now print the formatted message supplied with the error code
-    fputs(".  ", file);
     vfprintf(file, messageFormat, varArgs); // Adds new line automatically
     fputc('\n', file);
     fflush(file);
 }
 
+// Internal function used by the log writer thread, which formats messages in advance and timestamps them itself.
+// Write a formatted message preceded by the given time string, and by the error code if it is an error, followed
+// by a new line character.  Does not flush the stream, so that messages can be written in batches.
+void blah_message_writeRecordToFile(FILE* file, const char* timeString, bool isError, int errorCode, const char* message)
+{
+    fprintf(file, "%s ", timeString);
+    if (isError) { blah_message_writeErrorCodeToFile(file, errorCode); }
+    fputs(message, file);
+    fputc('\n', file);
+}
+
 // Write formatted message to given FILE stream.
 // A new line character is appened to the end of the output and flush the stream
 void blah_message_writeToFile(FILE* file, const char* messageFormat, ...)
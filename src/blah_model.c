@@ -13,11 +13,13 @@
 #include "blah_util.h"
 #include "blah_file.h"
 #include "blah_error.h"
+#include "blah_profile.h"
 
 /* External Function Prototypes */
 
-extern Blah_Model *Blah_Model_Lightwave_load(char *filename, FILE *fileStream);
-	//Creates a new Image structure.  Memory is allocated etc
+extern Blah_Model *Blah_Model_Lightwave_load(char *filename, Blah_File_Reader *reader, bool deferTextures);
+	//Creates a new model from lightwave object data read from the given reader.  The model is not
+	//added to the model tree.  If deferTextures is true, texture images are left in the texture maps.
 
 /* Private internal globals */
 
@@ -50,24 +52,82 @@ bool Blah_Model_init(Blah_Model *model, char *modelName) {
 	Blah_List_init(&model->faces,"model faces list");
 	Blah_List_setDestroyElementFunction(&model->faces, (blah_list_element_dest_func*)Blah_Model_Face_destroy);
 	Blah_List_init(&model->surfaces,"model surfaces list");
+	Blah_List_setDestroyElementFunction(&model->surfaces, (blah_list_element_dest_func*)Blah_Model_Surface_destroy);
+	model->vertexBlock = NULL;
+	model->vertexBlockLength = 0;
+	model->faceBlock = NULL;
+	model->faceBlockLength = 0;
 	return true;
 }
 
 void Blah_Model_disable(Blah_Model *model) {
-	Blah_List_destroyElements(&model->vertices);
-	Blah_List_destroyElements(&model->faces);
+	Blah_List_Element *element;
+
+	//Vertices and faces allocated in blocks by a loader are freed with their block
+	for (element = model->vertices.first; element; element = element->next) {
+		Blah_Vertex *vertex = element->data;
+		if (!model->vertexBlock || vertex < model->vertexBlock || vertex >= model->vertexBlock + model->vertexBlockLength) { free(vertex); }
+	}
+	Blah_List_removeAll(&model->vertices);
+	for (element = model->faces.first; element; element = element->next) {
+		Blah_Model_Face *face = element->data;
+		if (!model->faceBlock || face < model->faceBlock || face >= model->faceBlock + model->faceBlockLength) {
+			Blah_Model_Face_destroy(face);
+		} else {
+			Blah_Model_Face_disable(face);
+		}
+	}
+	Blah_List_removeAll(&model->faces);
+	free(model->vertexBlock);
+	free(model->faceBlock);
+	model->vertexBlock = NULL;
+	model->faceBlock = NULL;
+	model->vertexBlockLength = model->faceBlockLength = 0;
 	Blah_List_destroyElements(&model->surfaces);
 }
 
 
+static void Blah_Model_Texture_Map_finishDecode(Blah_Model_Texture_Map *map) {
+	//Replaces the image awaiting upload with a texture, sharing any existing texture of the same name
+	if (map->image) {
+		map->texture = blah_texture_find(map->image->name);
+		if (!map->texture) { map->texture = Blah_Texture_fromImage(map->image); }
+		Blah_Image_destroy(map->image);
+		map->image = NULL;
+	}
+}
+
+static void Blah_Model_Surface_finishDecode(Blah_Model_Surface *surface) {
+	Blah_List_callFunction(&surface->textures, (blah_list_element_func*)Blah_Model_Texture_Map_finishDecode);
+}
+
+Blah_Model *Blah_Model_decode(char *filename) {
+	//Maps the whole file into memory and parses it in place, without creating textures
+	Blah_File_Reader reader;
+	if (!Blah_File_Reader_open(&reader, filename, BLAH_FILE_READER_MAPPED)) { return NULL; }
+	Blah_Model *newModel = Blah_Model_Lightwave_load(filename, &reader, true);
+	Blah_File_Reader_close(&reader);
+	return newModel;
+}
+
+void Blah_Model_finishDecode(Blah_Model *model) {
+	Blah_List_callFunction(&model->surfaces, (blah_list_element_func*)Blah_Model_Surface_finishDecode);
+	Blah_Tree_insertElement(&blah_model_tree, model->name, model);  //add model to internal tree for garbage collection
+}
+
 Blah_Model* Blah_Model_load(char* filename) {
-	FILE* fileStream = blah_file_open(filename, "rb");
-	if (!fileStream) {
+	//Maps the whole file into memory and parses it in place
+	Blah_File_Reader reader;
+	if (!Blah_File_Reader_open(&reader, filename, BLAH_FILE_READER_MAPPED)) {
         blah_error_raise(errno, "Failed to open model file '%s'", filename);
         return NULL;
     }
-	Blah_Model* newModel = Blah_Model_Lightwave_load(filename, fileStream);
-	fclose(fileStream);
+	BLAH_PROFILE_BEGIN("Blah_Model_load");
+	Blah_Model* newModel = Blah_Model_Lightwave_load(filename, &reader, false);
+	Blah_File_Reader_close(&reader);
+	if (!newModel) { blah_error_raise(errno, "Failed to allocate model '%s'", filename); }
+	Blah_Tree_insertElement(&blah_model_tree, newModel->name, newModel);  //add new model to internal tree for garbage collection
+	BLAH_PROFILE_END();
 	return newModel;
 }
 
@@ -171,6 +231,11 @@ void Blah_Model_scaleVertex(Blah_Vertex *vertex, float *scaleFactor) {
 	vertex->location.z*=*scaleFactor;
 }
 
+void Blah_Model_Texture_Map_destroy(Blah_Model_Texture_Map *map) {
+	if (map->image) { Blah_Image_destroy(map->image); }
+	free(map);
+}
+
 Blah_Model_Texture_Map *Blah_Model_Texture_Map_new(Blah_Texture *texture, char projectionAxis, blah_model_texture_projection proj) {
 	Blah_Model_Texture_Map *map = malloc(sizeof(Blah_Model_Texture_Map));
 	//Ensure memory allocation succeeded before intiialising
@@ -180,6 +245,7 @@ Blah_Model_Texture_Map *Blah_Model_Texture_Map_new(Blah_Texture *texture, char p
 
 void Blah_Model_Texture_Map_init(Blah_Model_Texture_Map *map, Blah_Texture *texture, char projectionAxis, blah_model_texture_projection proj) {
 	map->texture = texture;
+	map->image = NULL;
 	map->projectionAxis = projectionAxis;
 	map->projectionMode = proj;
 	Blah_Point_set(&map->textureCenter, 0,0,0);
@@ -46,6 +46,7 @@ typedef struct Blah_Model_Surface {
 typedef struct Blah_Model_Texture_Map {
 	char projectionAxis;		//'x', 'y', 'z' - denotes axis of projection
 	Blah_Texture *texture; 		//pointer to texture used in mapping
+	Blah_Image *image;			//Decoded image awaiting upload as the texture, else NULL
 	Blah_Point textureCenter;	//Coordinates of texture center, relative to model coordinates
 	Blah_Vector textureSize;	//Size of area covered by texture in floats x,y,z
 	blah_model_texture_projection projectionMode;
@@ -61,6 +62,10 @@ typedef struct Blah_Model { //Represents a 3d model
 	Blah_List faces;		//List of (Blah_Model_Face)faces composing model
 	Blah_List surfaces;		//List of (Blah_Model_Surface)surface types
 	char name[BLAH_MODEL_NAME_LENGTH+1];
+	Blah_Vertex *vertexBlock;	//Single allocation holding vertices created by a loader, or NULL
+	size_t vertexBlockLength;	//Number of vertices in vertexBlock
+	Blah_Model_Face *faceBlock;	//Single allocation holding faces created by a loader, or NULL
+	size_t faceBlockLength;		//Number of faces in faceBlock
 } Blah_Model;
 
 /* Function Prototypes */
@@ -91,7 +96,19 @@ bool Blah_Model_init(Blah_Model *model, char *modelName);
 	//list of faces, and list of surfaces.
 
 void Blah_Model_disable(Blah_Model *model);
-	//Frees all allocated memory for structure internals
+	//Frees all allocated memory for structure internals.  Vertices and faces in the
+	//model's vertex and face blocks are freed with the blocks, others individually.
+
+Blah_Model *Blah_Model_decode(char *filename);
+	//Creates a new model from file without touching any engine wide state, so that it may be called
+	//from any thread.  Texture images are loaded into the texture maps but not made into textures,
+	//and the model is not added to the model tree until Blah_Model_finishDecode() is called.
+	//Returns NULL if the file could not be opened.
+
+void Blah_Model_finishDecode(Blah_Model *model);
+	//Completes a model created by Blah_Model_decode(), on the thread which owns the drawing context.
+	//Textures are created from the images awaiting upload, reusing existing textures of the same
+	//name, the images are destroyed, and the model is added to the model tree.
 
 Blah_Model *Blah_Model_load(char *filename);
 	//Creates a new model structure.  Memory is allocated etc
@@ -110,6 +127,9 @@ void Blah_Model_scale(Blah_Model *model, float scaleFactor);
 
 /* Texture Map Functions */
 
+void Blah_Model_Texture_Map_destroy(Blah_Model_Texture_Map *map);
+	//Destroys a texture map object, along with any image still awaiting upload.  The texture is not destroyed.
+
 Blah_Model_Texture_Map *Blah_Model_Texture_Map_new(Blah_Texture *texture, char projectionAxis, blah_model_texture_projection proj);
 	//Construct a new texture map object and return pointer
 
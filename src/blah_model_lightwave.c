@@ -3,10 +3,14 @@
 */
 
 #include <malloc.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "blah_model_lightwave.h"
 #include "blah_debug.h"
+#include "blah_error.h"
 #include "blah_util.h"
 #include "blah_file.h"
 #include "blah_types.h"
@@ -15,9 +19,15 @@
 #include "blah_list.h"
 #include "blah_iff.h"
 
+/* Definitions */
+
+#define BLAH_MODEL_LIGHTWAVE_SWAP_POINTS 1024 //Number of points byte swapped together from mapped data
+
 /* Private Globals */
 
-static Blah_Debug_Log blah_model_lightwave_log = { .filePointer = NULL };
+static _Thread_local Blah_Debug_Log blah_model_lightwave_log = { .filePointer = NULL }; //Models may be decoded by several threads at once
+static _Thread_local char blah_model_lightwave_logName[BLAH_DEBUG_LOG_NAME_LENGTH+1] = ""; //Set by the thread's first model
+static atomic_uint blah_model_lightwave_logCount = 0; //Threads which have named a log so far
 
 /* Private Function Prototypes */
 
@@ -99,9 +109,10 @@ static unsigned long Blah_Model_Lightwave_readTextureColourSubchunk(Blah_Model_L
 	//from a texture colour (TCLR) subchunk into the current lightwave
 	//texture parameters
 
-static unsigned long Blah_Model_Lightwave_readTextureFilenameSubchunk(Blah_Model_Lightwave_Surface_Texture *texture, Blah_IFF_Subchunk *subchunk);
+static unsigned long Blah_Model_Lightwave_readTextureFilenameSubchunk(Blah_Model_Lightwave_Surface_Texture *texture, Blah_IFF_Subchunk *subchunk, bool deferTextures);
 	//Reads the name of the file to be used as a texture image map from a texture
-	//image (TIMG) subchunk into the given lightwave texture parameters structure
+	//image (TIMG) subchunk into the given lightwave texture parameters structure.
+	//If deferTextures is true, only the image is loaded and no texture is created.
 
 static unsigned long Blah_Model_Lightwave_readTextureFlagsSubchunk(Blah_Model_Lightwave_Surface_Texture *texture, Blah_IFF_Subchunk *subchunk);
 	//Reads the flags for a surface texture from a texture
@@ -110,9 +121,9 @@ static unsigned long Blah_Model_Lightwave_readTextureFlagsSubchunk(Blah_Model_Li
 
 /* Main Functions */
 
-static unsigned long Blah_Model_Lightwave_getSize(FILE *fileStream);
+static unsigned long Blah_Model_Lightwave_getSize(Blah_File_Reader *reader);
 	//Returns the size of the lightwave object data (in bytes).
-	//Returns 0 if the file stream does not contain a valid lightwave object
+	//Returns 0 if the reader does not contain a valid lightwave object
 
 static unsigned long Blah_Model_Lightwave_readPointsChunk(Blah_Model_Lightwave *model, Blah_IFF_Chunk *chunk);
 	//Constructs a list of points in model, using data from the points chunk
@@ -140,15 +151,15 @@ static unsigned long Blah_Model_Lightwave_readTextureFlagsSubchunk(Blah_Model_Li
 	Blah_IFF_Subchunk_readUnsigned16(subchunk, &textureFlags);
 	//Now set the texture flags
 	if (textureFlags & BLAH_MODEL_LIGHTWAVE_TEXTURE_X_AXIS) {
-		Blah_Debug_Log_message(&blah_model_lightwave_log, "Texture x axis");
+		BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Texture x axis");
 		texture->xAxis = true;
 	}
 	if (textureFlags & BLAH_MODEL_LIGHTWAVE_TEXTURE_Y_AXIS) {
-		Blah_Debug_Log_message(&blah_model_lightwave_log, "Texture y axis");
+		BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Texture y axis");
 		texture->yAxis = true;
 	}
 	if (textureFlags & BLAH_MODEL_LIGHTWAVE_TEXTURE_Z_AXIS) {
-		Blah_Debug_Log_message(&blah_model_lightwave_log, "Texture z axis");
+		BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Texture z axis");
 		texture->zAxis = true;
 	}
 
@@ -158,7 +169,7 @@ static unsigned long Blah_Model_Lightwave_readTextureFlagsSubchunk(Blah_Model_Li
 static unsigned long Blah_Model_Lightwave_readTextureWrapSubchunk(Blah_Model_Lightwave_Surface_Texture *texture, Blah_IFF_Subchunk *subchunk) {
 	//Reads the wrap options for a surface texture from a texture
 	//wrap options (TWRP) subchunk into the given lightwave texture parameters structure
-	char debugString[200], *modeString=NULL;
+	char *modeString=NULL;
 	blah_unsigned16 widthWrap, heightWrap;
 	//read the width and height wrapping options as 16bit unsigned values
 	Blah_IFF_Subchunk_readUnsigned16(subchunk, &widthWrap);
@@ -176,8 +187,7 @@ static unsigned long Blah_Model_Lightwave_readTextureWrapSubchunk(Blah_Model_Lig
 		case BLAH_MODEL_LIGHTWAVE_WRAP_MIRROR :
 			modeString = "mirror\0"; break;
 	}
-	sprintf(debugString, "Texture width wrap: %s\n",modeString);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, debugString);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Texture width wrap: %s\n",modeString);
 
 	switch (heightWrap) {
 		case BLAH_MODEL_LIGHTWAVE_WRAP_BLACK :
@@ -189,8 +199,7 @@ static unsigned long Blah_Model_Lightwave_readTextureWrapSubchunk(Blah_Model_Lig
 		case BLAH_MODEL_LIGHTWAVE_WRAP_MIRROR :
 			modeString = "mirror\0"; break;
 	}
-	sprintf(debugString, "Texture height wrap: %s\n",modeString);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, debugString);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Texture height wrap: %s\n",modeString);
 
 	return subchunk->subchunkLength;
 }
@@ -199,15 +208,13 @@ static unsigned long Blah_Model_Lightwave_readTextureSizeSubchunk(Blah_Model_Lig
 	//Reads the size of the texture from a texture size (TSIZ) subchunk
 	//into the current lightwave texture parameters
 	blah_float32 sizeX, sizeY, sizeZ;
-	char debugString[200];
 
 	//Read x,y, and z values as 32bit floating points
 	Blah_IFF_Subchunk_readFloat32(subchunk, &sizeX);
 	Blah_IFF_Subchunk_readFloat32(subchunk, &sizeY);
 	Blah_IFF_Subchunk_readFloat32(subchunk, &sizeZ);
 
-	sprintf(debugString, "Texture size: %f,%f,%f",sizeZ,sizeY,sizeZ);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, debugString);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Texture size: %f,%f,%f",sizeZ,sizeY,sizeZ);
 
 	Blah_Vector_set(&texture->size, sizeX, sizeY, sizeZ);
 
@@ -219,15 +226,13 @@ static unsigned long Blah_Model_Lightwave_readTextureCenterSubchunk(Blah_Model_L
 	//surface, from a texture center (TCTR) subchunk into the current lightwave
 	//texture parameters
 	blah_float32 centerX, centerY, centerZ;
-	char debugString[200];
 
 	//Read x,y, and z values as 32bit floating points
 	Blah_IFF_Subchunk_readFloat32(subchunk, &centerX);
 	Blah_IFF_Subchunk_readFloat32(subchunk, &centerY);
 	Blah_IFF_Subchunk_readFloat32(subchunk, &centerZ);
 
-	sprintf(debugString, "Texture center: %f,%f,%f",centerX,centerY,centerZ);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, debugString);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Texture center: %f,%f,%f",centerX,centerY,centerZ);
 
 	Blah_Point_set(&texture->center, centerX, centerY, centerZ);
 
@@ -239,7 +244,6 @@ static unsigned long Blah_Model_Lightwave_readTextureColourSubchunk(Blah_Model_L
 	//from a texture colour (TCLR) subchunk into the current lightwave
 	//texture parameters
 	blah_unsigned8 red, green, blue;
-	char debugString[200];
 
 	Blah_IFF_Subchunk_readUnsigned8(subchunk, &red);
 	Blah_IFF_Subchunk_readUnsigned8(subchunk, &green);
@@ -248,45 +252,50 @@ static unsigned long Blah_Model_Lightwave_readTextureColourSubchunk(Blah_Model_L
 
 	Blah_Colour_set(&texture->colour, (float)red/255.0, (float)green/255.0, (float)blue/255.0, 1);
 
-	sprintf(debugString, "Texture colour: %f,%f,%f,%f",texture->colour.red,
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Texture colour: %f,%f,%f,%f",texture->colour.red,
 			texture->colour.green,texture->colour.blue,texture->colour.alpha);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, debugString);
 
 	return subchunk->subchunkLength;
 }
 
 
-static unsigned long Blah_Model_Lightwave_readTextureFilenameSubchunk(Blah_Model_Lightwave_Surface_Texture *lwTexture, Blah_IFF_Subchunk *subchunk) {
+static unsigned long Blah_Model_Lightwave_readTextureFilenameSubchunk(Blah_Model_Lightwave_Surface_Texture *lwTexture, Blah_IFF_Subchunk *subchunk, bool deferTextures) {
 	//Reads the name of the file to be used as a texture image map from a texture
 	//image (TIMG) subchunk into the given lightwave texture parameters structure
-	char *tempString, debugString[200];
+	char *tempString;
 	Blah_Image *tempImage;
 	Blah_Texture *texture;
 
-	Blah_Debug_Log_message(&blah_model_lightwave_log, "Reading texture filename");
-	sprintf(debugString, "Length of texture filename chunk:%u", subchunk->subchunkLength);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, debugString);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Reading texture filename");
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Length of texture filename chunk:%u", subchunk->subchunkLength);
 
 	tempString = Blah_IFF_Subchunk_readString(subchunk);
-	sprintf(debugString, "image filename read:%s",tempString);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, debugString);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "image filename read:%s",tempString);
 	blah_util_strncpy(lwTexture->fileName, tempString, BLAH_MODEL_LIGHTWAVE_TEXTURE_FILENAME_LENGTH);
+	if (deferTextures) { //Textures and the image tree belong to the drawing thread, so only load the image
+		if (lwTexture->image) { Blah_Image_destroy(lwTexture->image); }
+		lwTexture->image = Blah_Image_decode(tempString); //NULL if missing or corrupt, leaving the surface untextured
+		free(tempString);
+		if (subchunk->padBytePresent)
+			Blah_IFF_Subchunk_seek(subchunk, 1); //If length is odd, then seek one pad byte
+		return subchunk->subchunkLength;
+	}
 	//Try to locate an existing texture from same image
 	texture = blah_texture_find(tempString);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, "looking for texture");
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "looking for texture");
 
 	if (!texture) { //if no texture found
-		Blah_Debug_Log_message(&blah_model_lightwave_log, "texture not found, looking for image");
+		BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "texture not found, looking for image");
 
 		tempImage = blah_image_find(tempString); //try to locate existing copy of image
 		if (!tempImage) { //if no copy of same image found
-			Blah_Debug_Log_message(&blah_model_lightwave_log, "image not found");
+			BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "image not found");
 			tempImage = Blah_Image_fromFile(tempString); //load it from file
 		}
 
-		Blah_Debug_Log_message(&blah_model_lightwave_log, "tried to load file");
+		BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "tried to load file");
 		if (tempImage) { //if loading image successful, create new texture from it
-			Blah_Debug_Log_message(&blah_model_lightwave_log, "image loaded, creating texture");
+			BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "image loaded, creating texture");
 			texture = Blah_Texture_fromImage(tempImage); //create texture from image
 		}
 	}
@@ -303,17 +312,15 @@ static unsigned long Blah_Model_Lightwave_readTextureFilenameSubchunk(Blah_Model
 static unsigned long Blah_Model_Lightwave_readColourTextureSubchunk(Blah_Model_Lightwave_Surface_Texture *texture, Blah_IFF_Subchunk *subchunk) {
 	//Reads the type of the texture from a colour texture (CTEX) subchunk
 	//into the current lightwave texture parameters
-	char *tempString, debugString[200];
+	char *tempString;
 
-	Blah_Debug_Log_message(&blah_model_lightwave_log, "Reading colour texture");
-	sprintf(debugString, "Length of colour texture chunk:%u",subchunk->subchunkLength);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, debugString);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Reading colour texture");
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Length of colour texture chunk:%u",subchunk->subchunkLength);
 
 	tempString = Blah_IFF_Subchunk_readString(subchunk);
 	if (!strcmp(tempString, "Planar Image Map"))
 		texture->projectionMode = BLAH_MODEL_TEXTURE_PROJECTION_PLANAR;
-	sprintf(debugString, "texture type read:%s",tempString);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, debugString);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "texture type read:%s",tempString);
 	blah_util_strncpy(texture->type, tempString, BLAH_MODEL_LIGHTWAVE_TEXTURE_TYPE_LENGTH);
 	free(tempString);
 
@@ -447,44 +454,42 @@ static unsigned long Blah_Model_Lightwave_skipSubchunk(Blah_IFF_Subchunk *subchu
 	//subchunk less the subchunk header (it has already been read)
 	//Returns number of bytes skipped or 0 if failure
 	blah_unsigned32 skipLength;
-	char tempString[BLAH_DEBUG_MESSAGE_LENGTH];
 
 	skipLength = subchunk->subchunkLength - BLAH_IFF_SUBCHUNK_HEADER_LENGTH;
-	sprintf(tempString, "Skipping subchunk length:%u",skipLength);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, tempString);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Skipping subchunk length:%u",skipLength);
 
 
-	if (Blah_IFF_Chunk_seek(subchunk->parentChunk, skipLength)) //Skip subchunk length
+	if (Blah_IFF_Subchunk_seek(subchunk, skipLength)) //Skip subchunk length
 		return 0; //Positive return from seek means failure, return 0
 	else
 		return subchunk->subchunkLength;	//Return the size of the subchunk skipped
 }
 
-static unsigned long Blah_Model_Lightwave_getSize(FILE *fileStream) {
+static unsigned long Blah_Model_Lightwave_getSize(Blah_File_Reader *reader) {
 	//Returns the size of the lightwave object data (in bytes).
-	//Returns 0 if the file stream does not contain a valid lightwave object
-	char tempString[BLAH_DEBUG_MESSAGE_LENGTH];
-	blah_unsigned32 fileTag, lwobTag, lwobLength;
+	//Returns 0 if the reader does not contain a valid lightwave object
+	blah_unsigned32 fileTag, lwobTag = 0, lwobLength = 0;
 	unsigned long returnLength = 0;
+	const blah_unsigned8 *tag = Blah_File_Reader_take(reader, 4);
 
-	fread(&lwobTag, sizeof(blah_unsigned32), 1, fileStream);
-	blah_file_readUnsigned32(fileStream, &lwobLength);
+	if (tag) { memcpy(&lwobTag, tag, sizeof(blah_unsigned32)); } //Tags are kept in file byte order
+	Blah_File_Reader_readBigUnsigned32(reader, &lwobLength);
 
 	if (lwobTag != BLAH_MODEL_LIGHTWAVE_FORM) {
-		sprintf(tempString, "IFF form tag is:%x\n",lwobTag);
-		Blah_Debug_Log_message(&blah_model_lightwave_log, tempString);
+		BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "IFF form tag is:%x\n",lwobTag);
 		Blah_Debug_Log_message(&blah_model_lightwave_log, "File is not an IFF file");
 	} else {
-		Blah_Debug_Log_message(&blah_model_lightwave_log, "File header conforms to IFF format");
-		sprintf(tempString, "IFF data length is: %u\n",lwobLength);
-		Blah_Debug_Log_message(&blah_model_lightwave_log, tempString);
+		BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "File header conforms to IFF format");
+		BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "IFF data length is: %u\n",lwobLength);
 
-		fread(&fileTag, sizeof(blah_unsigned32), 1, fileStream);
+		tag = Blah_File_Reader_take(reader, 4);
+		fileTag = 0;
+		if (tag) { memcpy(&fileTag, tag, sizeof(blah_unsigned32)); }
 
 		if (fileTag != BLAH_MODEL_LIGHTWAVE_LWOB)
 			Blah_Debug_Log_message(&blah_model_lightwave_log, "IFF data is not a lightwave object");
 		else {
-			Blah_Debug_Log_message(&blah_model_lightwave_log, "Identified file as lightwave format");
+			BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Identified file as lightwave format");
 			returnLength = lwobLength - 4;
 		}
 	}
@@ -499,7 +504,7 @@ static unsigned long Blah_Model_Lightwave_skipChunk(Blah_IFF_Chunk *chunk) {
 
 	skipLength = chunk->chunkLength - BLAH_IFF_CHUNK_HEADER_LENGTH;
 
-	if (fseek(chunk->filePointer, skipLength, SEEK_CUR)) //Skip chunk length
+	if (Blah_IFF_Chunk_seek(chunk, skipLength)) //Skip chunk length
 		return 0; //Positive return from seek means failure, return 0
 	else
 		return chunk->chunkLength;	//Return the size of the chunk skipped
@@ -512,13 +517,34 @@ static unsigned long Blah_Model_Lightwave_readPointsChunk(Blah_Model_Lightwave *
 	blah_unsigned32 numPoints, pointCount;
 	blah_float32 tempX, tempY, tempZ;
 
-	char tempString[100];
 
-	Blah_Debug_Log_message(&blah_model_lightwave_log, "Reading points list");
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Reading points list");
 	numPoints = chunk->dataLength / 12; //divide by 12 bytes for num points
-	sprintf(tempString, "Number of points:%u",numPoints);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, tempString);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, "called list init - blah points");
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Number of points:%u",numPoints);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "called list init - blah points");
+
+	if (!model->newModel->vertexBlock && numPoints) {
+		//Points held in memory are byte swapped in bulk and stored in a single vertex block
+		blah_float32 coords[BLAH_MODEL_LIGHTWAVE_SWAP_POINTS * 3];
+		Blah_Vertex *vertexBlock = malloc(sizeof(Blah_Vertex) * numPoints);
+
+		if (vertexBlock == NULL) {
+			Blah_Debug_Log_message(&blah_model_lightwave_log, "Failed to allocate vertex block");
+			return chunk->chunkLength;
+		}
+		model->newModel->vertexBlock = vertexBlock;
+		model->newModel->vertexBlockLength = numPoints;
+		for (pointCount = 0; pointCount < numPoints; pointCount += BLAH_MODEL_LIGHTWAVE_SWAP_POINTS) {
+			const blah_unsigned32 swapCount = numPoints - pointCount < BLAH_MODEL_LIGHTWAVE_SWAP_POINTS ? numPoints - pointCount : BLAH_MODEL_LIGHTWAVE_SWAP_POINTS;
+			blah_util_byteSwap32Array(coords, chunk->data + pointCount * 12, swapCount * 3);
+			for (blah_unsigned32 swapIndex = 0; swapIndex < swapCount; swapIndex++) {
+				Blah_Vertex *vertex = &vertexBlock[pointCount + swapIndex];
+				Blah_Vertex_init(vertex, coords[swapIndex * 3], coords[swapIndex * 3 + 1], coords[swapIndex * 3 + 2]);
+				Blah_Model_addVertex(model->newModel, vertex);
+			}
+		}
+		return chunk->chunkLength;
+	}
 
 	for (pointCount = 0; pointCount < numPoints; pointCount++) {
 		Blah_IFF_Chunk_readFloat32(chunk, &tempX);
@@ -530,6 +556,62 @@ static unsigned long Blah_Model_Lightwave_readPointsChunk(Blah_Model_Lightwave *
 	return chunk->chunkLength; //Return the size of the data parsed (and pad byte if present)
 }
 
+static blah_unsigned16 Blah_Model_Lightwave_readBigEndian16(const blah_unsigned8 *bytes) {
+	//Returns the 16bit value stored most significant byte first at given address
+	return (blah_unsigned16)((bytes[0] << 8) | bytes[1]);
+}
+
+static void Blah_Model_Lightwave_readFacesMemory(Blah_Model_Lightwave *model, Blah_IFF_Chunk *chunk, Blah_Model_Surface **surfacePointers) {
+	//Parses the polygon list of a chunk from its data in memory.  The polygons are counted first, so
+	//that all faces are stored in a single face block, then indices are read straight from
+	//the chunk data.  Polygons referring to surfaces which don't exist are not added to a surface.
+	const blah_unsigned8 *data = chunk->data;
+	const blah_unsigned32 dataLength = chunk->dataLength;
+	const unsigned long numSurfaces = model->newModel->surfaces.length;
+	blah_unsigned32 offset = 0, numFaces = 0;
+	Blah_Model_Face *faceBlock;
+
+	//Count complete polygons, each a vertex count, the vertex indices and a surface index
+	while (offset + 2 <= dataLength) {
+		const blah_unsigned32 polygonLength = 4 + 2 * (blah_unsigned32)Blah_Model_Lightwave_readBigEndian16(data + offset);
+		if (polygonLength > dataLength - offset) { break; }
+		offset += polygonLength;
+		numFaces++;
+	}
+	Blah_IFF_Chunk_seek(chunk, dataLength); //Whole chunk is consumed here
+	if (numFaces == 0) { return; }
+
+	faceBlock = malloc(sizeof(Blah_Model_Face) * numFaces);
+	if (faceBlock == NULL) {
+		Blah_Debug_Log_message(&blah_model_lightwave_log, "Failed to allocate face block");
+		return;
+	}
+	model->newModel->faceBlock = faceBlock;
+	model->newModel->faceBlockLength = numFaces;
+
+	offset = 0;
+	for (blah_unsigned32 faceCount = 0; faceCount < numFaces; faceCount++) {
+		Blah_Model_Face *face = &faceBlock[faceCount];
+		const blah_unsigned16 numVertices = Blah_Model_Lightwave_readBigEndian16(data + offset);
+		blah_int16 surfaceIndex;
+
+		offset += 2;
+		Blah_Model_Face_init(face);
+		for (blah_unsigned16 vertexCount = 0; vertexCount < numVertices; vertexCount++, offset += 2) {
+			Blah_Model_Face_addIndex(face, Blah_Model_Lightwave_readBigEndian16(data + offset));
+		}
+		surfaceIndex = (blah_int16)Blah_Model_Lightwave_readBigEndian16(data + offset);
+		offset += 2;
+		if (surfaceIndex < 0)
+			BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log,"negative surface index - detail polygons\n");
+
+		face->surface = surfaceIndex;
+		Blah_Model_addFace(model->newModel, face);
+		if (surfaceIndex > 0 && (unsigned long)surfaceIndex <= numSurfaces)
+			Blah_Model_Surface_addFace(surfacePointers[surfaceIndex-1], face);
+	}
+}
+
 static unsigned long Blah_Model_Lightwave_readFacesChunk(Blah_Model_Lightwave *model, Blah_IFF_Chunk *chunk) {
 	//Parses a polygon list chunk from an IFF chunk
 	//Creates an array of pointers to allocated PRIMITVE structures in model
@@ -537,15 +619,20 @@ static unsigned long Blah_Model_Lightwave_readFacesChunk(Blah_Model_Lightwave *m
 	blah_unsigned16 numVertices, vertexCount, vertexIndex;
 	blah_int16 surfaceIndex;
 	Blah_Model_Face *tempFace;
-	char tempString[100];
 	Blah_Model_Surface **surfacePointers; //temporary pointer array for indexing
+	const unsigned long numSurfaces = model->newModel->surfaces.length;
 
-	Blah_Debug_Log_message(&blah_model_lightwave_log, "Reading facess list");
-	sprintf(tempString, "Length of faces chunk:%u",chunk->chunkLength);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, tempString);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Reading facess list");
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Length of faces chunk:%u",chunk->chunkLength);
 	surfacePointers = (Blah_Model_Surface**)Blah_List_createPointerstring(&model->newModel->surfaces);
 
-	while (chunk->currentOffset < chunk->dataLength-1) { //While end of data not reached
+	if (!model->newModel->faceBlock) {
+		Blah_Model_Lightwave_readFacesMemory(model, chunk, surfacePointers);
+		free(surfacePointers);
+		return chunk->chunkLength;
+	}
+
+	while (Blah_IFF_Chunk_getOffset(chunk) + 1 < chunk->dataLength) { //While end of data not reached
 		Blah_IFF_Chunk_readUnsigned16(chunk, &numVertices);
 		//Read number of vertices for next polygon
 
@@ -560,18 +647,17 @@ static unsigned long Blah_Model_Lightwave_readFacesChunk(Blah_Model_Lightwave *m
 		Blah_IFF_Chunk_readInt16(chunk, &surfaceIndex);
 		//Read surface index from file
 		if (surfaceIndex < 0)
-			Blah_Debug_Log_message(&blah_model_lightwave_log,"negative surface index - detail polygons\n");
+			BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log,"negative surface index - detail polygons\n");
 
 		tempFace->surface = surfaceIndex;
 
 		Blah_Model_addFace(model->newModel, tempFace);
-		if (surfaceIndex > 0)
+		if (surfaceIndex > 0 && (unsigned long)surfaceIndex <= numSurfaces)
 			Blah_Model_Surface_addFace(surfacePointers[surfaceIndex-1], tempFace);
 	}
 
 	free(surfacePointers);
-	sprintf(tempString, "Faces found:%d",model->newModel->faces.length);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, tempString);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Faces found:%d",model->newModel->faces.length);
 
 	return chunk->chunkLength; //return length of chunk read
 }
@@ -579,18 +665,16 @@ static unsigned long Blah_Model_Lightwave_readFacesChunk(Blah_Model_Lightwave *m
 static unsigned long Blah_Model_Lightwave_readSurfacelistChunk(Blah_Model_Lightwave *model, Blah_IFF_Chunk *chunk) {
 	//Parses a surface list chunk from a lightwave file
 	//Creates an list of empty surfaces.  Returns number of bytes read
-	char *tempString, debugString[200];
+	char *tempString;
 	Blah_Model_Surface *newSurface;
 
-	Blah_Debug_Log_message(&blah_model_lightwave_log, "Reading surfaces list");
-	sprintf(debugString, "Length of surface list chunk:%u",chunk->chunkLength);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, debugString);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Reading surfaces list");
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Length of surface list chunk:%u",chunk->chunkLength);
 
-	while (chunk->currentOffset < chunk->dataLength -1) {
+	while (Blah_IFF_Chunk_getOffset(chunk) + 1 < chunk->dataLength) {
 		//While end of chunk data not reached
 		tempString = Blah_IFF_Chunk_readString(chunk);
-		sprintf(debugString, "Surface name read:%s",tempString);
-		Blah_Debug_Log_message(&blah_model_lightwave_log, debugString);
+		BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Surface name read:%s",tempString);
 		newSurface = Blah_Model_Surface_new(tempString);
 		Blah_Model_addSurface(model->newModel, newSurface);
 		//Add the new surface to the list of surfaces in new model
@@ -611,7 +695,6 @@ static unsigned long Blah_Model_Lightwave_readSurfaceChunk(Blah_Model_Lightwave
 	//in the surfaces list of the given model
 	//Returns the number of bytes in the chunk data
 
-	char tempString[BLAH_DEBUG_MESSAGE_LENGTH];
 	char *surfaceName;
 	Blah_Model_Lightwave_Surface tempSurface;
 	Blah_Model_Lightwave_Surface_Texture tempTexture;
@@ -622,31 +705,27 @@ static unsigned long Blah_Model_Lightwave_readSurfaceChunk(Blah_Model_Lightwave
 	memset(&tempSurface, 0, sizeof(Blah_Model_Lightwave_Surface));
 	memset(&tempTexture, 0, sizeof(Blah_Model_Lightwave_Surface_Texture));
 
-	Blah_Debug_Log_message(&blah_model_lightwave_log, "Reading surface chunk");
-	sprintf(tempString, "Length of surface chunk:%u",chunk->chunkLength);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, tempString);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Reading surface chunk");
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Length of surface chunk:%u",chunk->chunkLength);
 
 	surfaceName = Blah_IFF_Chunk_readString(chunk); //Read surface name from chunk
-	sprintf(tempString, "Read surface name:%s",surfaceName);
-	Blah_Debug_Log_message(&blah_model_lightwave_log, tempString);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Read surface name:%s",surfaceName);
 
-	Blah_Debug_Log_message(&blah_model_lightwave_log, "Searching for a surface matching name");
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Searching for a surface matching name");
 	currentSurface = Blah_Tree_findElement(&model->surfacesTree, surfaceName)->data;
 
 	if (currentSurface)
-		Blah_Debug_Log_message(&blah_model_lightwave_log, "Found a surface matching name");
+		BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Found a surface matching name");
 	else
-		Blah_Debug_Log_message(&blah_model_lightwave_log, "No matching surface found");
+		BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "No matching surface found");
 
-	while (chunk->currentOffset < chunk->dataLength-1) {
+	while (Blah_IFF_Chunk_getOffset(chunk) + 1 < chunk->dataLength) {
 		//While end of chunk not reached
-		Blah_IFF_Subchunk_get(&tempSubchunk, chunk); //read next subchunk header
-		sprintf(tempString, "Subchunk format:%c%c%c%c",
+		if (!Blah_IFF_Subchunk_get(&tempSubchunk, chunk)) { break; } //read next subchunk header
+		BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Subchunk format:%c%c%c%c",
 			((unsigned char*)&tempSubchunk.idTag)[0], ((unsigned char*)&tempSubchunk.idTag)[1],
 			((unsigned char*)&tempSubchunk.idTag)[2], ((unsigned char*)&tempSubchunk.idTag)[3]);
 
-		Blah_Debug_Log_message(&blah_model_lightwave_log, tempString);
-
 		switch (tempSubchunk.idTag) { //Switch depending apon sub chunk type
 			case BLAH_MODEL_LIGHTWAVE_SURFACE_COLOUR :
 				Blah_Model_Lightwave_readColourSubchunk(&tempSurface, &tempSubchunk);
@@ -694,7 +773,7 @@ static unsigned long Blah_Model_Lightwave_readSurfaceChunk(Blah_Model_Lightwave
 				Blah_Model_Lightwave_readTextureColourSubchunk(&tempTexture, &tempSubchunk);
 				break;
 			case BLAH_MODEL_LIGHTWAVE_TEXTURE_IMAGE :
-				Blah_Model_Lightwave_readTextureFilenameSubchunk(&tempTexture, &tempSubchunk);
+				Blah_Model_Lightwave_readTextureFilenameSubchunk(&tempTexture, &tempSubchunk, model->deferTextures);
 				break;
 			case BLAH_MODEL_LIGHTWAVE_TEXTURE_FLAGS :
 				Blah_Model_Lightwave_readTextureFlagsSubchunk(&tempTexture, &tempSubchunk);
@@ -704,13 +783,13 @@ static unsigned long Blah_Model_Lightwave_readSurfaceChunk(Blah_Model_Lightwave
 				break;
 
 			default: //Skip unhandled sub chunk
-				Blah_Debug_Log_message(&blah_model_lightwave_log, "Skipping Subchunk");
+				BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Skipping Subchunk");
 				Blah_Model_Lightwave_skipSubchunk(&tempSubchunk);
 				break;
 		}
 	}
 
-	Blah_Debug_Log_message(&blah_model_lightwave_log, tempString);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Finished surface chunk:%s", surfaceName);
 
 	if (chunk->padBytePresent)
 		Blah_IFF_Chunk_seek(chunk, 1);	//If length is odd, then skip pad byte
@@ -735,10 +814,11 @@ static unsigned long Blah_Model_Lightwave_readSurfaceChunk(Blah_Model_Lightwave
 	//Must NOT forget this -  have to make sure there is a valid texture first before
 	//mapping.  Sleep depravation error caused much debugging work to find this duh.
 
-	if (tempTexture.texture) { //check for valid texture
+	if (tempTexture.texture || tempTexture.image) { //check for valid texture, or image to make one from
 		newMap = Blah_Model_Texture_Map_new(tempTexture.texture,
 			tempTexture.xAxis ? 'x' : (tempTexture.yAxis ? 'y' : 'z'),
 			tempTexture.projectionMode);
+		newMap->image = tempTexture.image;
 		Blah_Model_Texture_Map_setCenter(newMap, tempTexture.center.x,
 			tempTexture.center.y, tempTexture.center.z);
 		Blah_Model_Texture_Map_setSize(newMap, tempTexture.size.x,
@@ -749,58 +829,71 @@ static unsigned long Blah_Model_Lightwave_readSurfaceChunk(Blah_Model_Lightwave
 	return chunk->chunkLength; //Add four bytes for chunk length value
 }
 
+static unsigned long Blah_Model_Lightwave_readChunk(Blah_Model_Lightwave *model, Blah_IFF_Chunk *chunk) {
+	//Reads the given chunk according to its type into the model
+	//Returns the number of bytes in the chunk, or 0 if failure
+
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Chunk format:%c%c%c%c",
+		((unsigned char*)&chunk->idTag)[0], ((unsigned char*)&chunk->idTag)[1],
+		((unsigned char*)&chunk->idTag)[2], ((unsigned char*)&chunk->idTag)[3]);
+
+	switch (chunk->idTag) {  //Switch depending apon chunk type
+		case BLAH_MODEL_LIGHTWAVE_POINTLIST : //Load point list
+			return Blah_Model_Lightwave_readPointsChunk(model, chunk);
+		case BLAH_MODEL_LIGHTWAVE_FACELIST : //Read polygons
+			return Blah_Model_Lightwave_readFacesChunk(model, chunk);
+		case BLAH_MODEL_LIGHTWAVE_SURFACELIST : //Read surface list
+			return Blah_Model_Lightwave_readSurfacelistChunk(model, chunk);
+		case BLAH_MODEL_LIGHTWAVE_SURFACE : //Read surface chunk
+			return Blah_Model_Lightwave_readSurfaceChunk(model, chunk);
+		default: //Skip unhandled chunk
+			BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Skipping Chunk");
+			return Blah_Model_Lightwave_skipChunk(chunk);
+	}
+}
+
 /* Public Functions */
 
-Blah_Model *Blah_Model_Lightwave_load(char *filename, FILE *fileStream) {
-	//Creates a new model structure.  Memory is allocated etc
+Blah_Model *Blah_Model_Lightwave_load(char *filename, Blah_File_Reader *reader, bool deferTextures) {
+	//Creates a new model structure from lightwave object data read from the given reader.
+	//Each chunk is read as a view of its data, so the reader moves on by the length of the
+	//chunk however much of it was parsed.  The model is not added to the model tree, so that
+	//models may be decoded away from the drawing thread, in which case deferTextures is true.
 	Blah_Model_Lightwave lightwaveTemp;
-	unsigned long lwobLength, bytesRemaining, bytesRead;
+	unsigned long bytesRemaining;
 	//bytes_remaining holds the number of data bytes in the file, following the LWOB tag
-	char tempString[BLAH_DEBUG_MESSAGE_LENGTH];
 	Blah_IFF_Chunk dataChunk;
 
+	lightwaveTemp.newModel = malloc(sizeof(Blah_Model));
+	if (!lightwaveTemp.newModel) { return NULL; } //Left to the caller, which may be a loader thread
 	Blah_Tree_init(&lightwaveTemp.surfacesTree, "LightwaveSurfaceTree");
-	lightwaveTemp.newModel = Blah_Model_new(filename);
+	Blah_Model_init(lightwaveTemp.newModel, filename);
+	lightwaveTemp.deferTextures = deferTextures;
 	//Create new model inside lightwave temp structure
 
-	Blah_Debug_Log_init(&blah_model_lightwave_log, "blah_lightwave"); //Blah_Debug_Log_init(&blah_model_lightwave_log, "blah_lightwave");
-	Blah_Debug_Log_message(&blah_model_lightwave_log, "Begin reading lightwave file");
+	if (!blah_model_lightwave_logName[0]) { //Each thread writes its own file, the first keeping the plain name
+		unsigned int logIndex = atomic_fetch_add(&blah_model_lightwave_logCount, 1);
+		if (logIndex) { snprintf(blah_model_lightwave_logName, sizeof(blah_model_lightwave_logName), "blah_lightwave_%u", logIndex); }
+		else { blah_util_strncpy(blah_model_lightwave_logName, "blah_lightwave", BLAH_DEBUG_LOG_NAME_LENGTH); }
+	}
+	Blah_Debug_Log_init(&blah_model_lightwave_log, blah_model_lightwave_logName);
+	BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Begin reading lightwave file");
 
-	bytesRemaining = lwobLength = Blah_Model_Lightwave_getSize(fileStream);
+	bytesRemaining = Blah_Model_Lightwave_getSize(reader);
 
 	while (bytesRemaining) { //Read chunks
-		Blah_IFF_Chunk_get(&dataChunk, fileStream);
-		sprintf(tempString, "Chunk format:%c%c%c%c",
-			((unsigned char*)&dataChunk.idTag)[0], ((unsigned char*)&dataChunk.idTag)[1],
-			((unsigned char*)&dataChunk.idTag)[2], ((unsigned char*)&dataChunk.idTag)[3]);
-		Blah_Debug_Log_message(&blah_model_lightwave_log, tempString);
-
-		switch (dataChunk.idTag) {  //Switch depending apon chunk type
-			case BLAH_MODEL_LIGHTWAVE_POINTLIST : //Load point list
-				bytesRead = Blah_Model_Lightwave_readPointsChunk(&lightwaveTemp, &dataChunk);
-				break;
-			case BLAH_MODEL_LIGHTWAVE_FACELIST : //Read polygons
-				bytesRead = Blah_Model_Lightwave_readFacesChunk(&lightwaveTemp, &dataChunk);
-				break;
-			case BLAH_MODEL_LIGHTWAVE_SURFACELIST : //Read surface list
-				bytesRead = Blah_Model_Lightwave_readSurfacelistChunk(&lightwaveTemp, &dataChunk);
-				break;
-			case BLAH_MODEL_LIGHTWAVE_SURFACE : //Read surface chunk
-				bytesRead = Blah_Model_Lightwave_readSurfaceChunk(&lightwaveTemp, &dataChunk);
-				break;
-			default: //Skip unhandled chunk
-				Blah_Debug_Log_message(&blah_model_lightwave_log, "Skipping Chunk");
-				bytesRead = Blah_Model_Lightwave_skipChunk(&dataChunk);
-				break;
+		if (!Blah_IFF_Chunk_get(&dataChunk, reader)) {
+			Blah_Debug_Log_message(&blah_model_lightwave_log, "Chunk extends beyond end of data");
+			break;
 		}
+		Blah_Model_Lightwave_readChunk(&lightwaveTemp, &dataChunk);
 
-		if (bytesRemaining < bytesRead || !bytesRead)
+		if (bytesRemaining < dataChunk.chunkLength)
 			bytesRemaining = 0;
 		else
-			bytesRemaining -= bytesRead;
+			bytesRemaining -= dataChunk.chunkLength;
 
-		sprintf(tempString, "Bytes remaining %lu", bytesRemaining);
-		Blah_Debug_Log_message(&blah_model_lightwave_log, tempString);
+		BLAH_DEBUG_LOG_VERBOSE(&blah_model_lightwave_log, "Bytes remaining %lu", bytesRemaining);
 	}
 
 	Blah_Tree_removeAll(&lightwaveTemp.surfacesTree);
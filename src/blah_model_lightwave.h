@@ -111,6 +111,7 @@ typedef enum Blah_Model_Lightwave_Texture_Wrap {BLAH_MODEL_LIGHTWAVE_WRAP_BLACK=
 typedef struct Blah_Model_Lightwave {
 	Blah_Tree surfacesTree;	//Binary Tree of surface names, index into model surfaces
 	Blah_Model *newModel;
+	bool deferTextures;		//Leave texture images in the texture maps, rather than creating textures
 } Blah_Model_Lightwave;
 
 typedef struct Blah_Model_Lightwave_Surface {
@@ -153,6 +154,7 @@ typedef struct Blah_Model_Lightwave_Surface_Texture {
 	Blah_Vector falloff;
 	Blah_Vector velocity;
 	Blah_Texture *texture; //pointer to the texture used for this surface
+	Blah_Image *image;	//image to make the texture from, if textures are deferred
 	Blah_Colour colour;
 	/* Texture flags */
 	bool xAxis;
@@ -8,16 +8,45 @@
 #include <math.h>
 
 #include "blah_object.h"
+#include "blah_atlas.h"
 #include "blah_macros.h"
 #include "blah_entity.h"
 #include "blah_primitive.h"
 #include "blah_draw.h"
+#include "blah_error.h"
+#include "blah_file.h"
+#include "blah_image.h"
+#include "blah_mesh.h"
 #include "blah_model.h"
+#include "blah_texture.h"
+#include "blah_util.h"
 
-/* Function Declarations */
+/* Externally Referenced Variables */
 
-Blah_Object *Blah_Object_fromModel(Blah_Model *model) {
-	//Primitives and vertices are duplicated from model to create new object
+extern Blah_Material blah_draw_defaultMaterial;
+
+/* Static Globals - Private to object.c */
+
+static bool objectAtlasTextures = false;	//If true, small model textures are packed into the shared atlas
+
+/* Static Function Declarations */
+
+static Blah_Atlas_Entry *Blah_Object_findAtlasEntry(Blah_Atlas *atlas, const Blah_Model_Surface *surface) {
+	//Returns the atlas entry for the texture of the surface, adding it if needed, or NULL if it
+	//has no texture or the texture is too large to share a page
+	const Blah_Texture *texture;
+	Blah_Atlas_Entry *entry;
+
+	if (atlas == NULL || surface->textures.first == NULL) { return NULL; }
+	texture = ((Blah_Model_Texture_Map*)surface->textures.first->data)->texture;
+	if (texture == NULL || texture->width > BLAH_OBJECT_ATLAS_MAX_SIZE || texture->height > BLAH_OBJECT_ATLAS_MAX_SIZE) { return NULL; }
+	entry = Blah_Atlas_find(atlas, texture->name);
+	return entry != NULL ? entry : Blah_Atlas_addTexture(atlas, texture);
+}
+
+static Blah_Object *Blah_Object_convertModel(Blah_Model *model, Blah_Atlas *atlas) {
+	//Primitives and vertices are duplicated from model to create new object.  If an atlas is
+	//given, primitives of small textures mapped without tiling are drawn from it instead.
 	Blah_Object *newObject;
 	Blah_List_Element *tempIndexElement, *tempFaceElement, *tempSurfaceElement, *tempVertexElement;
 	Blah_Vertex **tempVerticesPointerArray;
@@ -28,6 +57,7 @@ Blah_Object *Blah_Object_fromModel(Blah_Model *model) {
 	const Blah_Point* mappingIndices[300]; //big dodgy temporary array to hold mapping indices
 	Blah_Model_Surface *currentSurface;
 	Blah_Model_Texture_Map *texMap=NULL;
+	Blah_Atlas_Entry *atlasEntry;
 
 	long vertexCount;
 	int vertexIndex;
@@ -38,6 +68,8 @@ Blah_Object *Blah_Object_fromModel(Blah_Model *model) {
 	Blah_Vector normal;
 
 	newObject = Blah_Object_new();
+	Blah_Array_reserve(&newObject->vertices, model->vertices.length);
+	Blah_Array_reserve(&newObject->primitives, model->faces.length);
 	//Create a temporary array with pointers to all vertices for indexing purposes
 	tempVerticesPointerArray = malloc(sizeof(Blah_Vertex*) * model->vertices.length);
 	tempVertexElement = model->vertices.first;
@@ -56,6 +88,7 @@ Blah_Object *Blah_Object_fromModel(Blah_Model *model) {
 		//Create material from current surface and add it to the new model
 		tempMaterial = Blah_Material_fromSurface(currentSurface);
 		Blah_Object_addMaterial(newObject, tempMaterial);
+		atlasEntry = Blah_Object_findAtlasEntry(atlas, currentSurface);
 		//Create object primitives from model faces
 		tempFaceElement = currentSurface->faces.first;
 		while (tempFaceElement) { //while not yet end of model faces
@@ -116,8 +149,17 @@ Blah_Object *Blah_Object_fromModel(Blah_Model *model) {
 			Blah_Primitive_setMaterial(newPrim, tempMaterial);
 			Blah_Object_addPrimitive(newObject, newPrim);
 
-            // Map texture if appropriate
-			if (texMap) { Blah_Primitive_mapTexture(newPrim, texMap->texture, mappingIndices); }
+            // Map texture if appropriate, from the atlas if the texture is not tiled across the primitive
+			if (texMap) {
+				bool withinTexture = atlasEntry != NULL;
+				for (tempIndex = 0; withinTexture && tempIndex < vertexCount; tempIndex++) {
+					withinTexture = mappingArray[tempIndex].x <= 1 && mappingArray[tempIndex].y <= 1;
+				}
+				if (withinTexture) {
+					for (tempIndex = 0; tempIndex < vertexCount; tempIndex++) { Blah_Atlas_Entry_mapPoint(atlasEntry, &mappingArray[tempIndex]); }
+				}
+				Blah_Primitive_mapTexture(newPrim, withinTexture ? atlasEntry->texture : texMap->texture, mappingIndices);
+			}
 
             // get next face to make into primitive
 			/* FIXME - BIG UGLY MESS TO MAKE NORMALS FOR VERTICES */
@@ -138,6 +180,7 @@ Blah_Object *Blah_Object_fromModel(Blah_Model *model) {
 	}
 
 	free(tempVerticesPointerArray);
+	if (atlas) { Blah_Atlas_update(atlas); }
 
 	//Free all temp memory buffers
 	Blah_Object_updateBounds(newObject);
@@ -145,10 +188,24 @@ Blah_Object *Blah_Object_fromModel(Blah_Model *model) {
 	return newObject;
 }
 
+/* Function Declarations */
+
+Blah_Object *Blah_Object_fromModel(Blah_Model *model) {
+	//Primitives and vertices are duplicated from model to create new object
+	return Blah_Object_convertModel(model, objectAtlasTextures ? blah_atlas_getShared() : NULL);
+}
+
 void Blah_Object_destroy(Blah_Object *object) {//standard destroy routine for object
-	Blah_List_destroyElements(&object->primitives);
-	Blah_List_destroyElements(&object->vertices);
+	Blah_Array_destroyElements(&object->primitives);
+	Blah_Array_disable(&object->primitives);
+	Blah_Array_destroyElements(&object->vertices);
+	Blah_Array_disable(&object->vertices);
 	Blah_List_destroyElements(&object->materials);
+	if (object->drawBatch) { blah_draw_releaseObject(object); }
+	if (object->mesh) {
+		Blah_Mesh_disable(object->mesh);
+		free(object->mesh);
+	}
 	free(object);
 }
 
@@ -156,20 +213,28 @@ void Blah_Object_draw(Blah_Object *object) {
 	//Draw object in space using the current drawing matrix
 	if (object->drawFunction != NULL) { // if draw function defined, use it
 		object->drawFunction(object);
- 	} else { // call primitive draw function to draw all primitives
-		Blah_List_callFunction(&object->primitives,(blah_list_element_func*)Blah_Primitive_draw);
+ 	} else { // draw all primitives
+		blah_draw_object(object);
  	}
 }
 
+void Blah_Object_invalidate(Blah_Object *object) {
+	//Marks the compiled drawing buffers of the object as out of date
+	object->drawBatchDirty = true;
+}
+
 void Blah_Object_init(Blah_Object *object) {
 	Blah_Point_set(&object->frameTopLeftFront, 0, 0, 0);
 	Blah_Point_set(&object->frameBottomRightBack, 0, 0, 0);
 	object->boundRadius = 0;
 	Blah_Object_setDrawFunction(object,NULL);
-	Blah_List_init(&object->primitives, "object primitives");
-	Blah_List_init(&object->vertices, "resource vertices");
+	Blah_Array_init(&object->primitives, "object primitives");
+	Blah_Array_init(&object->vertices, "resource vertices");
 	Blah_List_init(&object->materials, "resource materials");
-	object->primitives.destroyElementFunction = (blah_list_element_dest_func*)Blah_Primitive_destroy;
+	object->primitives.destroyElementFunction = (blah_array_element_dest_func*)Blah_Primitive_destroy;
+	object->drawBatch = NULL;
+	object->drawBatchDirty = false;
+	object->mesh = NULL;
 }
 
 Blah_Object *Blah_Object_new() {
@@ -180,6 +245,11 @@ Blah_Object *Blah_Object_new() {
 	return newObject;
 }
 
+void blah_object_setAtlasTextures(bool atlasTextures) {
+	//Sets whether objects converted from models draw small textures from the shared atlas
+	objectAtlasTextures = atlasTextures;
+}
+
 void Blah_Object_setDrawFunction(Blah_Object* object, blah_object_draw_func* function) {
 	object->drawFunction = function;
 }
@@ -197,12 +267,19 @@ void Blah_Object_setColour(Blah_Object *object, float red, float green, float bl
 
 void Blah_Object_setMaterial(Blah_Object* object, Blah_Material* material) {
 	//Set the material used by all primitives belonging to the object
-	Blah_List_callWithArg(&object->primitives, (blah_list_element_func_1arg*)Blah_Primitive_setMaterial, material);
+	Blah_Array_callWithArg(&object->primitives, (blah_array_element_func_1arg*)Blah_Primitive_setMaterial, material);
+	if (object->mesh) {
+		for (size_t groupIndex = 0; groupIndex < object->mesh->groupCount; groupIndex++) {
+			object->mesh->groups[groupIndex].material = material;
+		}
+	}
+	Blah_Object_invalidate(object);
 }
 
 void Blah_Object_mapTextureAuto(Blah_Object *obj, Blah_Texture *texture) {
 	//Map given texture to all primitives of given object
-	Blah_List_callWithArg(&obj->primitives, (blah_list_element_func_1arg*)Blah_Primitive_mapTextureAuto, texture);
+	Blah_Array_callWithArg(&obj->primitives, (blah_array_element_func_1arg*)Blah_Primitive_mapTextureAuto, texture);
+	Blah_Object_invalidate(obj);
 
 	/* prim->texture = texture;
 	if (prim->texture_mapping) { //If there is a pre-existing mapping, need to destroy it
@@ -216,7 +293,7 @@ Blah_Vertex *Blah_Object_addVertex(Blah_Object *object, float x, float y, float
 	//Convenience function to add a vertex to the list of vertices
 	//Returns handle to new vertex
 	Blah_Vertex *newVertex = Blah_Vertex_new(x,y,z);
-	Blah_List_appendElement(&object->vertices,newVertex);
+	Blah_Array_appendElement(&object->vertices,newVertex);
 	return newVertex;
 }
 
@@ -226,15 +303,30 @@ void Blah_Object_addVertices(Blah_Object *object, Blah_Point *vertices[]) {
 	int vertexIndex = 0;
 
 	while (vertices[vertexIndex]) {
-		Blah_List_appendElement(&object->vertices,vertices[vertexIndex]);
+		Blah_Array_appendElement(&object->vertices,vertices[vertexIndex]);
 		vertexIndex++;
 	}
 }
 
+static void Blah_Object_extendBounds(Blah_Object* object, Blah_Primitive* primitive) {
+	//Grows the bounding radius of the object to enclose all vertices of the given primitive
+	Blah_Vertex **vertexList = primitive->sequence;
+	Blah_Point origin = {0,0,0};
+	float tempRadius;
+
+	if (vertexList) { //if there is a vertex list
+		for (int vertexIndex = 0; vertexList[vertexIndex]; vertexIndex++) {
+			tempRadius = Blah_Point_distancePoint(&origin, &vertexList[vertexIndex]->location);
+			if (tempRadius > object->boundRadius) { object->boundRadius = tempRadius; } // update max radius
+		}
+	}
+}
+
 void Blah_Object_addPrimitive(Blah_Object *object, Blah_Primitive *primitive) {
 	//Adds a 3d primitive to an object's list of primitives
-	Blah_List_appendElement(&object->primitives, primitive);
-	//Blah_Object_update_bounds(object);
+	Blah_Array_appendElement(&object->primitives, primitive);
+	Blah_Object_invalidate(object);
+	Blah_Object_extendBounds(object, primitive);
 }
 
 void Blah_Object_addMaterial(Blah_Object *object, Blah_Material *material) {
@@ -246,30 +338,11 @@ void Blah_Object_addMaterial(Blah_Object *object, Blah_Material *material) {
 
 void Blah_Object_updateBounds(Blah_Object* object) {
 	//Calculates the collision boundaries of an object
-
-	Blah_List_Element *primElement;
-	Blah_Vertex **vertexList;
-	Blah_Point origin = {0,0,0};
-	int vertexIndex;
-	float maxRadius = 0;
-	float tempRadius;
-
-	primElement = object->primitives.first;
-
-	while (primElement) {
-		vertexList = ((Blah_Primitive*)primElement->data)->sequence;
-		if (vertexList) { //if there is a vertex list
-			vertexIndex = 0;
-
-			while (vertexList[vertexIndex]) {
-				tempRadius = Blah_Point_distancePoint(&origin, &vertexList[vertexIndex]->location);
-				if (tempRadius > maxRadius) { maxRadius = tempRadius; } // update max radius
-				vertexIndex++;
-			}
-		}
-		primElement = primElement->next;
+	object->boundRadius = 0;
+	for (size_t primIndex = 0; primIndex < object->primitives.length; primIndex++) {
+		Blah_Object_extendBounds(object, (Blah_Primitive*)object->primitives.elements[primIndex]);
 	}
-	object->boundRadius = maxRadius;
+	if (object->mesh) { Blah_Mesh_getRadius(object->mesh, &object->boundRadius); }
 }
 
 static void Blah_Object_scalePoint(Blah_Point *point, float *scaleFactor) {
@@ -278,6 +351,280 @@ static void Blah_Object_scalePoint(Blah_Point *point, float *scaleFactor) {
 
 void Blah_Object_scale(Blah_Object* object, float scaleFactor) {
 	//Alters every vertex in the object by multiplying each coordinate by scale_factor
-	Blah_List_callWithArg(&object->vertices, (blah_list_element_func_1arg*)Blah_Object_scalePoint, &scaleFactor);
+	Blah_Array_callWithArg(&object->vertices, (blah_array_element_func_1arg*)Blah_Object_scalePoint, &scaleFactor);
+	if (object->mesh) { Blah_Mesh_scale(object->mesh, scaleFactor); }
 	Blah_Object_updateBounds(object);
+	Blah_Object_invalidate(object);
+}
+
+/* Baked Object Functions */
+
+static bool Blah_Object_isLittleEndian() {
+	//Returns true if the host stores words least significant byte first, as baked object files do
+	const blah_unsigned32 one = 1;
+	return *(const unsigned char*)&one == 1;
+}
+
+static blah_unsigned32 Blah_Object_bakedWord(const blah_unsigned32 *words, size_t index) {
+	//Returns the word at given index of a mapped baked object file in host byte order
+	blah_unsigned32 word = words[index];
+	if (!Blah_Object_isLittleEndian()) { blah_util_byteSwap32Array(&word, &word, 1); }
+	return word;
+}
+
+static float Blah_Object_bakedFloat(const blah_unsigned32 *words, size_t index) {
+	//Returns the word at given index of a mapped baked object file as a float
+	const blah_unsigned32 word = Blah_Object_bakedWord(words, index);
+	float value;
+	memcpy(&value, &word, sizeof(value));
+	return value;
+}
+
+static bool Blah_Object_writeWords(FILE *file, const void *words, size_t count) {
+	//Writes 'count' 32 bit words to file in little endian order.  Returns false on error.
+	blah_unsigned32 buffer[256];
+	const blah_unsigned32 *source = words;
+
+	if (Blah_Object_isLittleEndian()) { return fwrite(words, sizeof(blah_unsigned32), count, file) == count; }
+	while (count > 0) {
+		const size_t chunkCount = count < blah_countof(buffer) ? count : blah_countof(buffer);
+		blah_util_byteSwap32Array(buffer, source, chunkCount);
+		if (fwrite(buffer, sizeof(blah_unsigned32), chunkCount, file) != chunkCount) { return false; }
+		source += chunkCount;
+		count -= chunkCount;
+	}
+	return true;
+}
+
+static blah_unsigned32 Blah_Object_tableIndex(const void **table, size_t *length, const void *entry) {
+	//Returns the index of entry in table, appending it if not yet present
+	for (size_t index = 0; index < *length; index++) {
+		if (table[index] == entry) { return (blah_unsigned32)index; }
+	}
+	table[*length] = entry;
+	return (blah_unsigned32)(*length)++;
+}
+
+static Blah_Texture *Blah_Object_findTexture(const char *name) {
+	//Returns the texture with given name, creating it from the image of that name or file if needed
+	Blah_Texture *texture = blah_texture_find(name);
+
+	if (texture == NULL) {
+		Blah_Image *image = blah_image_find(name);
+		if (image == NULL) { image = Blah_Image_fromFile(name); }
+		if (image != NULL) { texture = Blah_Texture_fromImage(image); }
+	}
+	return texture;
+}
+
+Blah_Object *Blah_Object_loadBaked(const char *filename, uint64_t sourceHash) {
+	//Maps the baked object file and uses its mesh arrays in place, building only the group,
+	//material and texture tables
+	size_t length, vertexWords, indexWords, groupWords, materialWords;
+	const blah_unsigned32 *words = blah_file_map(filename, &length);
+	blah_unsigned32 vertexCount, indexCount, groupCount, materialCount, textureCount;
+	Blah_Material **materials;
+	Blah_Texture **textures;
+	Blah_Object *newObject;
+	Blah_Mesh *mesh;
+
+	if (words == NULL) { return NULL; }
+	if (length < BLAH_OBJECT_BAKED_HEADER_WORDS * sizeof(blah_unsigned32) || length % sizeof(blah_unsigned32) != 0
+		|| Blah_Object_bakedWord(words, 0) != BLAH_OBJECT_BAKED_MAGIC || Blah_Object_bakedWord(words, 1) != BLAH_OBJECT_BAKED_VERSION
+		|| (sourceHash != 0 && (Blah_Object_bakedWord(words, 2) != (blah_unsigned32)sourceHash
+			|| Blah_Object_bakedWord(words, 3) != (blah_unsigned32)(sourceHash >> 32)))) {
+		blah_file_unmap(words, length);
+		return NULL;
+	}
+	vertexCount = Blah_Object_bakedWord(words, 4);
+	indexCount = Blah_Object_bakedWord(words, 5);
+	groupCount = Blah_Object_bakedWord(words, 6);
+	materialCount = Blah_Object_bakedWord(words, 7);
+	textureCount = Blah_Object_bakedWord(words, 8);
+	vertexWords = (size_t)vertexCount * (sizeof(Blah_Mesh_Vertex) / sizeof(blah_unsigned32));
+	indexWords = indexCount;
+	groupWords = (size_t)groupCount * 4;
+	materialWords = (size_t)materialCount * BLAH_OBJECT_BAKED_MATERIAL_WORDS;
+	//Counts are 32 bit, so the sums cannot overflow a 64 bit size
+	if ((uint64_t)BLAH_OBJECT_BAKED_HEADER_WORDS + vertexWords + indexWords + groupWords + materialWords
+		+ (uint64_t)textureCount * BLAH_OBJECT_BAKED_NAME_WORDS != length / sizeof(blah_unsigned32)) {
+		blah_file_unmap(words, length);
+		return NULL;
+	}
+
+	const blah_unsigned32 *vertexWord = words + BLAH_OBJECT_BAKED_HEADER_WORDS;
+	const blah_unsigned32 *indexWord = vertexWord + vertexWords;
+	const blah_unsigned32 *groupWord = indexWord + indexWords;
+	const blah_unsigned32 *materialWord = groupWord + groupWords;
+	const char *textureName = (const char*)(materialWord + materialWords);
+
+	//Check references before using anything, so a damaged file cannot cause reads out of range
+	for (size_t groupIndex = 0; groupIndex < groupCount; groupIndex++) {
+		const blah_unsigned32 materialIndex = Blah_Object_bakedWord(groupWord, groupIndex * 4);
+		const blah_unsigned32 textureIndex = Blah_Object_bakedWord(groupWord, groupIndex * 4 + 1);
+		const blah_unsigned32 firstIndex = Blah_Object_bakedWord(groupWord, groupIndex * 4 + 2);
+		const blah_unsigned32 groupIndexCount = Blah_Object_bakedWord(groupWord, groupIndex * 4 + 3);
+		if ((materialIndex >= materialCount && materialIndex != BLAH_OBJECT_BAKED_NONE)
+			|| (textureIndex >= textureCount && textureIndex != BLAH_OBJECT_BAKED_NONE)
+			|| firstIndex > indexCount || groupIndexCount > indexCount - firstIndex) {
+			blah_file_unmap(words, length);
+			return NULL;
+		}
+	}
+	for (size_t index = 0; index < indexCount; index++) {
+		if (Blah_Object_bakedWord(indexWord, index) >= vertexCount) {
+			blah_file_unmap(words, length);
+			return NULL;
+		}
+	}
+
+	newObject = Blah_Object_new();
+	mesh = malloc(sizeof(Blah_Mesh));
+	materials = malloc(sizeof(Blah_Material*) * (materialCount + 1));
+	textures = malloc(sizeof(Blah_Texture*) * (textureCount + 1));
+	if (newObject == NULL || mesh == NULL || materials == NULL || textures == NULL) {
+		blah_error_raise(errno, "Failed to allocate object loaded from '%s'", filename);
+	}
+	Blah_Mesh_init(mesh);
+	mesh->mapping = words; //Mesh now owns the mapping
+	mesh->mappingLength = length;
+	mesh->vertexCount = vertexCount;
+	mesh->indexCount = indexCount;
+	if (Blah_Object_isLittleEndian()) { //Use the arrays where they are mapped
+		mesh->vertices = (Blah_Mesh_Vertex*)vertexWord;
+		mesh->indices = (blah_unsigned32*)indexWord;
+	} else {
+		mesh->storage = malloc(sizeof(blah_unsigned32) * (vertexWords + indexWords + 1));
+		if (mesh->storage == NULL) { blah_error_raise(errno, "Failed to allocate %lu vertices loaded from '%s'", (unsigned long)vertexCount, filename); }
+		blah_util_byteSwap32Array(mesh->storage, vertexWord, vertexWords + indexWords);
+		mesh->vertices = mesh->storage;
+		mesh->indices = (blah_unsigned32*)(mesh->vertices + vertexCount);
+	}
+
+	for (size_t materialIndex = 0; materialIndex < materialCount; materialIndex++) {
+		const blah_unsigned32 *source = materialWord + materialIndex * BLAH_OBJECT_BAKED_MATERIAL_WORDS;
+		Blah_Material *material = Blah_Material_new();
+		if (material == NULL) { blah_error_raise(errno, "Failed to allocate material loaded from '%s'", filename); }
+		Blah_Colour_set(&material->ambient, Blah_Object_bakedFloat(source, 0), Blah_Object_bakedFloat(source, 1), Blah_Object_bakedFloat(source, 2), Blah_Object_bakedFloat(source, 3));
+		Blah_Colour_set(&material->diffuse, Blah_Object_bakedFloat(source, 4), Blah_Object_bakedFloat(source, 5), Blah_Object_bakedFloat(source, 6), Blah_Object_bakedFloat(source, 7));
+		Blah_Colour_set(&material->specular, Blah_Object_bakedFloat(source, 8), Blah_Object_bakedFloat(source, 9), Blah_Object_bakedFloat(source, 10), Blah_Object_bakedFloat(source, 11));
+		Blah_Colour_set(&material->emission, Blah_Object_bakedFloat(source, 12), Blah_Object_bakedFloat(source, 13), Blah_Object_bakedFloat(source, 14), Blah_Object_bakedFloat(source, 15));
+		material->shininess = Blah_Object_bakedWord(source, 16);
+		Blah_Object_addMaterial(newObject, material);
+		materials[materialIndex] = material;
+	}
+	for (size_t textureIndex = 0; textureIndex < textureCount; textureIndex++) {
+		char name[BLAH_OBJECT_BAKED_NAME_WORDS * 4 + 1];
+		blah_util_strncpy(name, textureName + textureIndex * BLAH_OBJECT_BAKED_NAME_WORDS * 4, BLAH_OBJECT_BAKED_NAME_WORDS * 4);
+		textures[textureIndex] = Blah_Object_findTexture(name);
+	}
+
+	mesh->groups = malloc(sizeof(Blah_Mesh_Group) * (groupCount + 1));
+	if (mesh->groups == NULL) { blah_error_raise(errno, "Failed to allocate %lu groups loaded from '%s'", (unsigned long)groupCount, filename); }
+	for (size_t groupIndex = 0; groupIndex < groupCount; groupIndex++) {
+		const blah_unsigned32 materialIndex = Blah_Object_bakedWord(groupWord, groupIndex * 4);
+		const blah_unsigned32 textureIndex = Blah_Object_bakedWord(groupWord, groupIndex * 4 + 1);
+		Blah_Mesh_Group *group = &mesh->groups[groupIndex];
+		group->material = materialIndex == BLAH_OBJECT_BAKED_NONE ? &blah_draw_defaultMaterial : materials[materialIndex];
+		group->texture = textureIndex == BLAH_OBJECT_BAKED_NONE ? NULL : textures[textureIndex];
+		group->firstIndex = Blah_Object_bakedWord(groupWord, groupIndex * 4 + 2);
+		group->indexCount = Blah_Object_bakedWord(groupWord, groupIndex * 4 + 3);
+	}
+	mesh->groupCount = groupCount;
+	free(materials);
+	free(textures);
+
+	newObject->mesh = mesh;
+	newObject->boundRadius = Blah_Object_bakedFloat(words, 9);
+	return newObject;
+}
+
+Blah_Object *Blah_Object_loadCached(char *modelFilename, const char *bakedFilename) {
+	//Loads the baked object if it is up to date with the model file, else rebuilds it from the model
+	uint64_t sourceHash;
+	Blah_Object *newObject;
+	Blah_Model *model;
+
+	if (!blah_file_hash(modelFilename, &sourceHash)) { return NULL; }
+	newObject = Blah_Object_loadBaked(bakedFilename, sourceHash);
+	if (newObject != NULL) { return newObject; }
+
+	model = Blah_Model_load(modelFilename);
+	if (model == NULL) { return NULL; }
+	newObject = Blah_Object_convertModel(model, NULL); //Baked files name textures, so cannot refer to atlas pages
+	Blah_Model_destroy(model);
+	Blah_Object_save(newObject, bakedFilename, sourceHash); //Failing to write the cache only costs the next load time
+	return newObject;
+}
+
+bool Blah_Object_save(Blah_Object *object, const char *filename, uint64_t sourceHash) {
+	//Writes the mesh of the object, compiling it from the primitives if the object has none
+	Blah_Mesh compiledMesh;
+	const Blah_Mesh *mesh = object->mesh;
+	const void **materials, **textures;
+	size_t materialCount = 0, textureCount = 0;
+	blah_unsigned32 *groupWords;
+	FILE *file;
+	bool success;
+
+	if (mesh == NULL) {
+		Blah_Mesh_init(&compiledMesh);
+		Blah_Mesh_compileObject(&compiledMesh, object);
+		mesh = &compiledMesh;
+	}
+	materials = malloc(sizeof(void*) * (mesh->groupCount + 1));
+	textures = malloc(sizeof(void*) * (mesh->groupCount + 1));
+	groupWords = malloc(sizeof(blah_unsigned32) * 4 * (mesh->groupCount + 1));
+	if (materials == NULL || textures == NULL || groupWords == NULL) {
+		blah_error_raise(errno, "Failed to allocate tables to save object to '%s'", filename);
+	}
+
+	//Number the materials and textures used by groups in order of first use
+	for (size_t groupIndex = 0; groupIndex < mesh->groupCount; groupIndex++) {
+		const Blah_Mesh_Group *group = &mesh->groups[groupIndex];
+		groupWords[groupIndex * 4] = group->material == &blah_draw_defaultMaterial ? BLAH_OBJECT_BAKED_NONE
+			: Blah_Object_tableIndex(materials, &materialCount, group->material);
+		groupWords[groupIndex * 4 + 1] = group->texture == NULL ? BLAH_OBJECT_BAKED_NONE
+			: Blah_Object_tableIndex(textures, &textureCount, group->texture);
+		groupWords[groupIndex * 4 + 2] = group->firstIndex;
+		groupWords[groupIndex * 4 + 3] = group->indexCount;
+	}
+
+	file = blah_file_open(filename, "wb");
+	success = file != NULL;
+	if (success) {
+		blah_unsigned32 header[BLAH_OBJECT_BAKED_HEADER_WORDS] = {BLAH_OBJECT_BAKED_MAGIC, BLAH_OBJECT_BAKED_VERSION,
+			(blah_unsigned32)sourceHash, (blah_unsigned32)(sourceHash >> 32), (blah_unsigned32)mesh->vertexCount,
+			(blah_unsigned32)mesh->indexCount, (blah_unsigned32)mesh->groupCount, (blah_unsigned32)materialCount,
+			(blah_unsigned32)textureCount, 0};
+		memcpy(&header[9], &object->boundRadius, sizeof(float));
+
+		success = Blah_Object_writeWords(file, header, BLAH_OBJECT_BAKED_HEADER_WORDS)
+			&& Blah_Object_writeWords(file, mesh->vertices, mesh->vertexCount * (sizeof(Blah_Mesh_Vertex) / sizeof(blah_unsigned32)))
+			&& Blah_Object_writeWords(file, mesh->indices, mesh->indexCount)
+			&& Blah_Object_writeWords(file, groupWords, mesh->groupCount * 4);
+		for (size_t materialIndex = 0; success && materialIndex < materialCount; materialIndex++) {
+			const Blah_Material *material = materials[materialIndex];
+			blah_unsigned32 materialWords[BLAH_OBJECT_BAKED_MATERIAL_WORDS];
+			memcpy(&materialWords[0], &material->ambient, sizeof(Blah_Colour));
+			memcpy(&materialWords[4], &material->diffuse, sizeof(Blah_Colour));
+			memcpy(&materialWords[8], &material->specular, sizeof(Blah_Colour));
+			memcpy(&materialWords[12], &material->emission, sizeof(Blah_Colour));
+			materialWords[16] = material->shininess;
+			success = Blah_Object_writeWords(file, materialWords, BLAH_OBJECT_BAKED_MATERIAL_WORDS);
+		}
+		for (size_t textureIndex = 0; success && textureIndex < textureCount; textureIndex++) {
+			char name[BLAH_OBJECT_BAKED_NAME_WORDS * 4] = {0};
+			blah_util_strncpy(name, ((const Blah_Texture*)textures[textureIndex])->name, sizeof(name) - 1);
+			success = fwrite(name, sizeof(name), 1, file) == 1;
+		}
+		success = fclose(file) == 0 && success;
+		if (!success) { remove(filename); } //Don't leave a partial file to be found later
+	}
+
+	free(materials);
+	free(textures);
+	free(groupWords);
+	if (mesh == &compiledMesh) { Blah_Mesh_disable(&compiledMesh); }
+	return success;
 }
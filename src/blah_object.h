@@ -1,5 +1,8 @@
 /* blah_object.h
-	Objects are represented as a collection of primitives. */
+	Objects are represented as a collection of primitives.
+	Objects can also be saved as baked object files, holding the compiled mesh (see blah_mesh.h) with
+	its materials and texture names, and loaded back from them without per vertex or per primitive
+	work.  Baked objects have no primitives or resource vertices, only their mesh. */
 
 #ifndef _BLAH_OBJECT
 
@@ -9,11 +12,35 @@
 #include "blah_types.h"
 #include "blah_primitive.h"
 #include "blah_list.h"
+#include "blah_array.h"
+#include "blah_mesh.h"
 #include "blah_model.h"
 
+/* Definitions */
+
+/* Baked object files are little endian 32 bit words, laid out so they can be used where mapped:
+	header		BLAH_OBJECT_BAKED_HEADER_WORDS words: magic, version, source hash low and high words,
+				vertex, index, group, material and texture counts, bound radius (float)
+	vertices	8 floats each, as Blah_Mesh_Vertex
+	indices		3 per triangle
+	groups		4 words each: material index, texture index, first index, index count.
+				Index BLAH_OBJECT_BAKED_NONE means default material or no texture.
+	materials	17 words each: ambient, diffuse, specular and emission colours, shininess
+	textures	BLAH_OBJECT_BAKED_NAME_WORDS words each, a null padded texture name */
+
+#define BLAH_OBJECT_BAKED_MAGIC			0x4F424C42	//"BLBO" in little endian unsigned long format
+#define BLAH_OBJECT_BAKED_VERSION		1			//Increase whenever the layout changes
+#define BLAH_OBJECT_BAKED_HEADER_WORDS	10
+#define BLAH_OBJECT_BAKED_MATERIAL_WORDS 17
+#define BLAH_OBJECT_BAKED_NAME_WORDS	((BLAH_TEXTURE_NAME_LENGTH + 4) / 4)
+#define BLAH_OBJECT_BAKED_NONE			0xFFFFFFFF
+
+#define BLAH_OBJECT_ATLAS_MAX_SIZE		256	//Largest width and height of model textures packed into the shared atlas
+
 /* Forward Declarations */
 
 struct Blah_Object;
+struct Blah_Draw_Batch;
 
 /* Function Type Definitions */
 
@@ -26,9 +53,12 @@ typedef struct Blah_Object { //represents a single object as a collection of pri
 	blah_object_draw_func* drawFunction;
 	Blah_Point frameTopLeftFront, frameBottomRightBack;
 	float boundRadius;
-	Blah_List primitives;	//List of primitives that compose object
-	Blah_List vertices;		//List of resource vertices for possible use to construct primitives
+	Blah_Array primitives;	//Array of primitives that compose object
+	Blah_Array vertices;	//Array of resource vertices for possible use to construct primitives
 	Blah_List materials;	//List of materials used to draw object
+	struct Blah_Draw_Batch* drawBatch;	//Primitives compiled into buffers by the drawing API, NULL until first drawn
+	bool drawBatchDirty;	//If true, primitives or vertices have changed since drawBatch was compiled
+	Blah_Mesh* mesh;		//Mesh loaded from a baked object file, drawn in place of primitives.  NULL if none.
 } Blah_Object;
 
 /* Object Function prototypes */
@@ -40,15 +70,42 @@ typedef struct Blah_Object { //represents a single object as a collection of pri
 void Blah_Object_draw(Blah_Object *object);
 	//Draw object in space using the current drawing matrix
 
+void Blah_Object_invalidate(Blah_Object *object);
+	//Marks the compiled drawing buffers of the object as out of date, so they are rebuilt when it is next drawn.
+	//Must be called after changing vertices or primitives of the object other than through Blah_Object functions.
+
 void Blah_Object_init(Blah_Object *object);
 	//Initialise object structure with default values
 
 Blah_Object *Blah_Object_new();
 	//Alloc a new Object structure and return pointer
 
+Blah_Object *Blah_Object_loadBaked(const char *filename, uint64_t sourceHash);
+	//Loads an object from the named baked object file, mapping it into memory so the mesh arrays
+	//are used in place.  If sourceHash is not zero it must match the hash the file was saved with.
+	//Returns NULL if the file is missing, invalid, of another version or saved from other source contents.
+
+Blah_Object *Blah_Object_loadCached(char *modelFilename, const char *bakedFilename);
+	//Loads the object for the named model file from the given baked object file, if that was saved
+	//from the current contents of the model file.  Otherwise loads the model, converts it to an
+	//object and saves that as the baked object file for next time.  Returns NULL on error.
+
 Blah_Object *Blah_Object_fromModel(Blah_Model *model);
 	//Produces an object with all the details of the supplied model
 	//The model is not altered from this process in any way
+	//Small textures are drawn from the shared atlas if enabled with blah_object_setAtlasTextures
+
+bool Blah_Object_save(Blah_Object *object, const char *filename, uint64_t sourceHash);
+	//Writes the compiled mesh, materials and texture names of the object to the named baked object
+	//file, together with the hash of the source it was made from, e.g. from blah_file_hash.
+	//Primitives which are not made of triangles are left out.  Returns false on error.
+
+void blah_object_setAtlasTextures(bool atlasTextures);
+	//If true, Blah_Object_fromModel packs model textures no larger than BLAH_OBJECT_ATLAS_MAX_SIZE
+	//into the shared atlas (see blah_atlas.h), and maps primitives whose texture coordinates stay
+	//within the texture onto it, so objects with many small textures need fewer bindings.  Objects
+	//made this way should not be saved as baked object files, which name textures to load.
+	//Off by default.  Blah_Object_loadCached never uses the atlas.
 
 void Blah_Object_setDrawFunction(Blah_Object* object, blah_object_draw_func* function);
 	//set pointer for draw function
@@ -60,7 +117,7 @@ void Blah_Object_setColour(Blah_Object *object, float red, float green, float bl
 	//Sets the colour of all an object's materials, which are used by its primitives
 
 void Blah_Object_setMaterial(Blah_Object *object, Blah_Material *material);
-	//Set the material used by all primitives belonging to the object
+	//Set the material used by all primitives, or all mesh groups, belonging to the object
 
 Blah_Vertex *Blah_Object_addVertex(Blah_Object *object, float x, float y, float z);
 	//Convenience function to add a vertex to the list of vertices
@@ -82,7 +139,7 @@ void Blah_Object_updateBounds(Blah_Object* object);
 	//Calculates the collision boundaries of an object
 
 void Blah_Object_scale(Blah_Object *object, float scaleFactor);
-	//Alters every vertex in the object by multiplying each coordinate by scale_factor
+	//Alters every vertex in the object, including those of its mesh, by multiplying each coordinate by scale_factor
 
 #ifdef __cplusplus
 	}
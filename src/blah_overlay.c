@@ -8,10 +8,35 @@
 #include "blah_draw.h"
 #include "blah_overlay.h"
 #include "blah_colour.h"
+#include "blah_font_texture.h"
 #include "blah_image.h"
 #include "blah_types.h"
 #include "blah_util.h"
 
+/* Externally Referenced Variables */
+
+extern Blah_Draw_Stats blah_draw_stats;
+
+/* Static Function Declarations */
+
+static void Blah_Overlay_drawText(Blah_Overlay_Text *text) {
+	//Adds plain text in a texture font to the glyph batch, and draws any other text at once
+	if (text->visible && text->drawFunction == NULL && text->fontStyle->type == BLAH_FONT_TEXTURE) {
+		Blah_Font_Texture_appendString2d((const Blah_Font_Texture*)text->fontStyle, text->stringBuffer, text->position.x, text->position.y);
+	} else if (text->visible) {
+		blah_font_texture_flush(); //Keep text drawn in order
+		Blah_Overlay_Text_draw(text);
+	}
+}
+
+static void Blah_Overlay_drawContents(Blah_Overlay *overlay) {
+	//Draws all text of the overlay relative to the current drawport.
+	//Text in texture fonts sharing a texture is drawn together in a single call
+	Blah_List_callFunction(&overlay->textList, (blah_list_element_func*)Blah_Overlay_drawText);
+	blah_font_texture_flush();
+	blah_draw_stats.overlayRedraws++;
+}
+
 /* Function Declarations */
 
 void Blah_Overlay_init(Blah_Overlay *overlay, unsigned int layerNum, char *name, unsigned int width, unsigned int height) {
@@ -23,6 +48,11 @@ void Blah_Overlay_init(Blah_Overlay *overlay, unsigned int layerNum, char *name,
 	Blah_List_init(&overlay->textList, "overlay text list");
 	Blah_List_init(&overlay->imageList, "overlay image list");
 	overlay->visible = true;
+	overlay->scene = NULL; //not in a scene until added
+	overlay->sceneElement = NULL;
+	overlay->cached = true;
+	overlay->dirty = true; //Layer has not been drawn yet
+	overlay->layer = (Blah_Draw_Layer){ .textureHandle = 0 };
 }
 
 Blah_Overlay *Blah_Overlay_new(unsigned int layerNum, char *name, unsigned int width, unsigned int height) {
@@ -52,15 +82,33 @@ Blah_Overlay_Text *Blah_Overlay_addText(Blah_Overlay *overlay, char *name,
 void Blah_Overlay_addOverlayText(Blah_Overlay *overlay, Blah_Overlay_Text *text) {
 	//Adds the overlay text object to the list of text in the given overlay
 	Blah_List_appendElement(&overlay->textList, text);
+	text->parent = overlay;
+	if (text->drawFunction) { Blah_Overlay_setCached(overlay, false); } //Its output may change every frame
+	overlay->dirty = true;
 }
 
 void Blah_Overlay_draw(Blah_Overlay *overlay) {
-	//Draws the overlay in 2D space infront of the rendered 3D scene
-	//FIXME - need to set clipping planes
+	//Draws the overlay in 2D space infront of the rendered 3D scene.
+	//Cached overlays are drawn into their layer only if dirty, then composited.
 	if (overlay->visible) { //only draw overlay if it is visible
 		blah_draw_pushDrawport();
-		blah_draw_setDrawport(overlay->posX, overlay->posY, overlay->posX+overlay->width-1, overlay->posX+overlay->height-1);
-		Blah_List_callFunction(&overlay->textList, (blah_list_element_func*)Blah_Overlay_Text_draw);
+		if (overlay->cached && overlay->dirty) {
+			if (blah_draw_beginLayer(&overlay->layer, overlay->width, overlay->height)) {
+				blah_draw_setDrawport(0, 0, overlay->width-1, overlay->height-1); //Layer origin is the overlay origin
+				Blah_Overlay_drawContents(overlay);
+				blah_draw_endLayer(&overlay->layer);
+				overlay->dirty = false;
+			} else { //No offscreen targets, so draw directly from now on
+				overlay->cached = false;
+			}
+		}
+		blah_draw_setDrawport(overlay->posX, overlay->posY, overlay->posX+overlay->width-1, overlay->posY+overlay->height-1);
+		if (overlay->cached) {
+			blah_draw_compositeLayer(&overlay->layer);
+			blah_draw_stats.overlayComposites++;
+		} else {
+			Blah_Overlay_drawContents(overlay);
+		}
 		blah_draw_popDrawport();
 	}
 }
@@ -70,9 +118,22 @@ void Blah_Overlay_destroy(Blah_Overlay *overlay) {
 	//contained in the overlay's internal lists.
 	Blah_List_destroyElements(&overlay->textList);
 	Blah_List_destroyElements(&overlay->imageList);
+	blah_draw_releaseLayer(&overlay->layer);
 	free(overlay);
 }
 
+void Blah_Overlay_invalidate(Blah_Overlay *overlay) {
+	//Marks the overlay's contents as changed, so that a cached overlay is drawn into its layer again
+	overlay->dirty = true;
+}
+
+void Blah_Overlay_setCached(Blah_Overlay *overlay, bool cached) {
+	//Enables or disables drawing the overlay through its offscreen layer
+	if (!cached) { blah_draw_releaseLayer(&overlay->layer); }
+	overlay->cached = cached;
+	overlay->dirty = true;
+}
+
 void Blah_Overlay_setVisible(Blah_Overlay *overlay, bool vis) {
 	//Sets the visibility flag of the given overlay
 	overlay->visible = vis;
@@ -1,13 +1,20 @@
 /* blah_overlay.h - Data structure to represent a 2 dimensional overlay pane.
 	Overlays can contain images and text.  Overlays have a position relative to
 	2D physical screen dimensions, increasing from bottom left corner.  Elements
-	are positioned within the overlay, using coordinates in the same manner. */
+	are positioned within the overlay, using coordinates in the same manner.
+	Cached overlays draw their text into an offscreen layer only when it has changed, and otherwise
+	composite the layer as a single quad.  Changes made through the Blah_Overlay_Text functions mark
+	the overlay dirty.  Text drawn by its own draw function cannot be followed, so adding such text to
+	an overlay disables its caching.  Caching may be enabled again afterwards, in which case the overlay
+	must be marked dirty with Blah_Overlay_invalidate whenever that text changes.
+	Text of cached overlays is clipped to the overlay's width and height. */
 
 #ifndef _BLAH_OVERLAY
 
 #define _BLAH_OVERLAY
 
 #include "blah_colour.h"
+#include "blah_draw_layer.h"
 #include "blah_image.h"
 #include "blah_types.h"
 #include "blah_list.h"
@@ -21,6 +28,10 @@
 
 /* Type Definitions */
 
+/* Forward Declarations */
+
+struct Blah_Scene;
+
 /* Structure Definitions */
 
 typedef struct Blah_Overlay {
@@ -32,6 +43,11 @@ typedef struct Blah_Overlay {
 	Blah_List textList; //List of text objects within overlay
 	Blah_List imageList; //List of images within overlay
 	bool visible;	//If TRUE, overlay is drawn
+	struct Blah_Scene* scene;	//Scene the overlay was last added to, or NULL
+	Blah_List_Element* sceneElement;	//Element of the overlay list of that scene holding the overlay
+	bool cached;	//If TRUE, text is drawn into layer when changed, and layer is composited each frame
+	bool dirty;		//If TRUE, text has changed since it was last drawn into layer
+	Blah_Draw_Layer layer;	//Offscreen copy of the overlay's text
 } Blah_Overlay;
 
 /* Font Function Prototypes */
@@ -57,6 +73,9 @@ void Blah_Overlay_destroy(Blah_Overlay *overlay);
 void Blah_Overlay_draw(Blah_Overlay *overlay);
 	//Draws the overlay in 2D space infront of the rendered 3D scene
 
+void Blah_Overlay_invalidate(Blah_Overlay *overlay);
+	//Marks the overlay's contents as changed, so that a cached overlay is drawn into its layer again
+
 void Blah_Overlay_init(Blah_Overlay *overlay, unsigned int layerNum, char *name, unsigned int width, unsigned int height);
 	//Initialise overlay structure with defaults.
 
@@ -67,6 +86,11 @@ Blah_Overlay *Blah_Overlay_new(unsigned int layerNum, char *name, unsigned int w
 	//Creates a new overlay structure with given name.
 	//Returns NULL on error.
 
+void Blah_Overlay_setCached(Blah_Overlay *overlay, bool cached);
+	//Enables or disables drawing the overlay through its offscreen layer.  Enabled by default.
+	//Caching is disabled if the drawing API has no offscreen targets, or when the overlay is given
+	//text with its own draw function.
+
 void Blah_Overlay_setPosition(Blah_Overlay *overlay, unsigned int x, unsigned int y);
 	//Sets the position of the overlay given physical screen coordinates, relative
 	//to physical origin bottom left corner (0,0)
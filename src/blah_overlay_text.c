@@ -7,11 +7,19 @@
 #include <string.h>
 
 #include "blah_text_2d.h"
+#include "blah_overlay.h"
 #include "blah_overlay_text.h"
 #include "blah_types.h"
 #include "blah_macros.h"
 #include "blah_util.h"
 
+/* Static Function Declarations */
+
+static void Blah_Overlay_Text_invalidate(Blah_Overlay_Text *text) {
+	//Marks the parent overlay dirty, so that its cached layer is drawn again
+	if (text->parent) { Blah_Overlay_invalidate(text->parent); }
+}
+
 /* Structure Function declarations */
 
 void Blah_Overlay_Text_destroy(Blah_Overlay_Text *text) {
@@ -65,21 +73,32 @@ Blah_Overlay_Text* Blah_Overlay_Text_new(const char* name, unsigned int size, co
 void Blah_Overlay_Text_setDrawFunction(Blah_Overlay_Text* text, blah_overlay_text_draw_func* function) {
 	//set pointer for draw function
 	text->drawFunction = function;
+	if (function && text->parent) { Blah_Overlay_setCached(text->parent, false); } //Its output may change every frame
+	Blah_Overlay_Text_invalidate(text);
 }
 
 void Blah_Overlay_Text_setPosition(Blah_Overlay_Text *text, float x, float y) {
 	//set object's position indicated by 2D coordinates
-	Blah_Point_set(&text->position, x,y,0);
+	if (text->position.x != x || text->position.y != y) {
+		Blah_Point_set(&text->position, x,y,0);
+		Blah_Overlay_Text_invalidate(text);
+	}
 }
 
 void Blah_Overlay_Text_setText(Blah_Overlay_Text *text, char *string) {
 	//Copies the character string pointed to by 'string', to the overlay text buffer
-	blah_util_strncpy(text->stringBuffer,string, text->bufferSize);
+	if (strncmp(text->stringBuffer, string, text->bufferSize) != 0) { //Text set every frame to the same string leaves the overlay cached
+		blah_util_strncpy(text->stringBuffer,string, text->bufferSize);
+		Blah_Overlay_Text_invalidate(text);
+	}
 }
 
 void Blah_Overlay_Text_setVisible(Blah_Overlay_Text *text, bool visFlag) {
 	//Sets the visibility flag of the overlay text to the value given by vis_flag
 	//True will make the text visible and drawn, FALSE will make it invisible
-	text->visible = visFlag;
+	if (text->visible != visFlag) {
+		text->visible = visFlag;
+		Blah_Overlay_Text_invalidate(text);
+	}
 }
 
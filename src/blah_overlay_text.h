@@ -62,7 +62,7 @@ Blah_Overlay_Text *Blah_Overlay_Text_new(const char *name, unsigned int size, co
 	//font style.  Alloc a new Structure and return pointer
 
 void Blah_Overlay_Text_setDrawFunction(Blah_Overlay_Text* text, blah_overlay_text_draw_func* func);
-	//set pointer for draw function
+	//set pointer for draw function.  Disables caching of the parent overlay, see Blah_Overlay_setCached
 
 void Blah_Overlay_Text_setPosition(Blah_Overlay_Text *text, float x, float y);
 	//set object's position indicated by 2D coordinates
@@ -7,6 +7,7 @@
 #include "blah_point.h"
 #include "blah_vector.h"
 #include "blah_matrix.h"
+#include "blah_math.h"
 
 /* Function Declarations */
 
@@ -59,21 +60,7 @@ void Blah_Point_translateByVector(Blah_Point *point, Blah_Vector *vector) {
 }
 
 void Blah_Point_multiplyMatrix(Blah_Point *point, Blah_Matrix *matrix) { //Multiplies point coordinates by a given matrix
-	int resultCell, matrixCell, count;
-	float result[3]={0,0,0};
-	
-	for (resultCell=0;resultCell<3;resultCell++) {
-		//result[result_cell] = 0;
-		matrixCell=resultCell & 3;	//result_cell mod 4
-		
-		for (count=0;count<3;count++) {
-			result[resultCell] += ((float*)point)[count] * ((float*)matrix)[matrixCell];
-			matrixCell+=4;
-		} //sum products of v * m
-		result[resultCell] += ((float*)matrix)[matrixCell];
-	}
-	
-	memcpy(point, result, sizeof(float)*3); //copy result data into vector
+	blah_math_transformPoint(point, point, matrix);
 }
 
 void Blah_Point_scale(Blah_Point *point, float scaleFactor) {
@@ -0,0 +1,322 @@
+/* blah_profile.c
+	Defines the frame profiler.  See blah_profile.h for reference. */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+#include "blah_profile.h"
+#include "blah_error.h"
+#include "blah_file.h"
+#include "blah_time.h"
+
+/* Structure Definitions */
+
+typedef struct Blah_Profile_Record { //A closed zone
+	const char* name;
+	uint64_t start;				//Clock when opened, in nanoseconds
+	uint64_t duration;			//Nanoseconds until closed
+	unsigned int depth;			//Number of zones open around it
+} Blah_Profile_Record;
+
+typedef struct Blah_Profile_Thread { //Records of one thread, written only by that thread
+	Blah_Profile_Record records[BLAH_PROFILE_RING_SIZE];
+	atomic_size_t written;		//Number of records ever written, the next goes at written modulo ring size
+	size_t cleared;				//Value of written when last cleared, earlier records are not read
+	const char* openNames[BLAH_PROFILE_MAX_DEPTH];
+	uint64_t openStarts[BLAH_PROFILE_MAX_DEPTH];
+	unsigned int depth;			//Number of zones open, may exceed BLAH_PROFILE_MAX_DEPTH
+	unsigned int id;
+	char name[BLAH_PROFILE_THREAD_NAME_LENGTH+1];
+	struct Blah_Profile_Thread* next;
+} Blah_Profile_Thread;
+
+typedef struct Blah_Profile_Sample { //Duration of one run of a zone, for summaries
+	const char* name;
+	uint64_t duration;
+} Blah_Profile_Sample;
+
+/* Private Globals */
+
+static atomic_bool enabled = false;
+static once_flag syncOnce = ONCE_FLAG_INIT;
+static mtx_t threadsMutex;				//Guards the list of threads
+static Blah_Profile_Thread* threads = NULL;
+static unsigned int threadCount = 0;
+static uint64_t startTime = 0;			//Clock when recording was first enabled, the zero time of traces
+static thread_local Blah_Profile_Thread* currentThread = NULL;
+static thread_local char pendingName[BLAH_PROFILE_THREAD_NAME_LENGTH+1];	//Name set before the thread first recorded
+
+/* Static Function Definitions */
+
+static void blah_profile_initSync()
+{	//Creates the mutex guarding the list of threads, once per process
+	if (mtx_init(&threadsMutex, mtx_plain) != thrd_success) {
+		blah_error_raise(errno, "Failed to create profiler synchronisation objects");
+	}
+}
+
+static Blah_Profile_Thread* blah_profile_addThread()
+{	//Creates the ring buffer of the calling thread and adds it to the list of threads
+	Blah_Profile_Thread* thread = malloc(sizeof(Blah_Profile_Thread));
+	if (thread == NULL) { blah_error_raise(errno, "Failed to allocate profiler ring buffer"); }
+
+	atomic_init(&thread->written, 0);
+	thread->cleared = 0;
+	thread->depth = 0;
+	call_once(&syncOnce, blah_profile_initSync);
+	mtx_lock(&threadsMutex);
+	thread->id = ++threadCount;
+	if (pendingName[0]) {
+		strcpy(thread->name, pendingName);
+	} else {
+		snprintf(thread->name, sizeof(thread->name), "thread %u", thread->id);
+	}
+	thread->next = threads;
+	threads = thread;
+	mtx_unlock(&threadsMutex);
+	currentThread = thread;
+	return thread;
+}
+
+static size_t Blah_Profile_Thread_getFirst(const Blah_Profile_Thread* thread, size_t written)
+{	//Returns the number of the oldest record which can still be read, given the number written
+	const size_t oldest = written > BLAH_PROFILE_RING_SIZE ? written - BLAH_PROFILE_RING_SIZE : 0;
+	return oldest > thread->cleared ? oldest : thread->cleared;
+}
+
+static int blah_profile_compareNames(const char* name1, const char* name2)
+{	//Orders zone names.  Names are usually string literals, so the same zone has the same pointer.
+	return name1 == name2 ? 0 : strcmp(name1, name2);
+}
+
+static int blah_profile_compareSamples(const void* sample1, const void* sample2)
+{	//Orders samples by zone name, then duration
+	const Blah_Profile_Sample* first = sample1;
+	const Blah_Profile_Sample* second = sample2;
+	const int nameOrder = blah_profile_compareNames(first->name, second->name);
+
+	if (nameOrder != 0) { return nameOrder; }
+	return first->duration < second->duration ? -1 : (first->duration > second->duration);
+}
+
+static Blah_Profile_Sample* blah_profile_gatherSamples(size_t* sampleCount)
+{	//Returns all readable records of all threads as samples sorted by zone and duration.
+	//Must be called with the list of threads locked.  Returns NULL if there are none.
+	Blah_Profile_Sample* samples;
+	size_t total = 0, count = 0;
+
+	for (Blah_Profile_Thread* thread = threads; thread; thread = thread->next) {
+		const size_t written = atomic_load_explicit(&thread->written, memory_order_acquire);
+		total += written - Blah_Profile_Thread_getFirst(thread, written);
+	}
+	*sampleCount = 0;
+	if (total == 0) { return NULL; }
+	samples = malloc(total * sizeof(Blah_Profile_Sample));
+	if (samples == NULL) { blah_error_raise(errno, "Failed to allocate profiler summary"); }
+
+	for (Blah_Profile_Thread* thread = threads; thread && count < total; thread = thread->next) {
+		const size_t written = atomic_load_explicit(&thread->written, memory_order_acquire);
+		for (size_t index = Blah_Profile_Thread_getFirst(thread, written); index < written && count < total; index++) {
+			const Blah_Profile_Record record = thread->records[index % BLAH_PROFILE_RING_SIZE];
+			//Drop the record if the thread may have since started writing over it
+			if (atomic_load_explicit(&thread->written, memory_order_acquire) - index >= BLAH_PROFILE_RING_SIZE) { continue; }
+			samples[count].name = record.name;
+			samples[count++].duration = record.duration;
+		}
+	}
+	qsort(samples, count, sizeof(Blah_Profile_Sample), blah_profile_compareSamples);
+	*sampleCount = count;
+	return samples;
+}
+
+static void blah_profile_writeString(FILE* file, const char* string)
+{	//Writes string as a quoted JSON string
+	fputc('"', file);
+	for (; *string; string++) {
+		if (*string == '"' || *string == '\\') { fputc('\\', file); }
+		if ((unsigned char)*string >= ' ') { fputc(*string, file); }
+	}
+	fputc('"', file);
+}
+
+/* Function Definitions */
+
+void blah_profile_begin(const char* name)
+{	//Opens a zone on the calling thread.  While recording is disabled, threads which have recorded
+	//still open a nameless zone, so that the next end closes it rather than a zone opened earlier.
+	Blah_Profile_Thread* thread = currentThread;
+
+	if (!atomic_load_explicit(&enabled, memory_order_relaxed)) {
+		if (thread == NULL) { return; } //No zones can be open
+		name = NULL;
+	} else if (thread == NULL) {
+		thread = blah_profile_addThread();
+	}
+	if (thread->depth < BLAH_PROFILE_MAX_DEPTH) {
+		thread->openNames[thread->depth] = name;
+		thread->openStarts[thread->depth] = name ? blah_time_getNanoseconds() : 0;
+	}
+	thread->depth++;
+}
+
+void blah_profile_clear()
+{	//Discards all records made so far
+	call_once(&syncOnce, blah_profile_initSync);
+	mtx_lock(&threadsMutex);
+	for (Blah_Profile_Thread* thread = threads; thread; thread = thread->next) {
+		thread->cleared = atomic_load_explicit(&thread->written, memory_order_acquire);
+	}
+	mtx_unlock(&threadsMutex);
+}
+
+void blah_profile_end()
+{	//Closes the zone most recently opened on the calling thread and records it.  Zones opened while
+	//recording was enabled are still closed after it is disabled, so that nesting stays balanced.
+	Blah_Profile_Thread* thread = currentThread;
+	Blah_Profile_Record* record;
+	size_t written;
+
+	if (thread == NULL || thread->depth == 0) { return; } //Opened before the thread first recorded
+	if (--thread->depth >= BLAH_PROFILE_MAX_DEPTH) { return; }
+	if (thread->openNames[thread->depth] == NULL) { return; } //Opened while not recording
+
+	written = atomic_load_explicit(&thread->written, memory_order_relaxed);
+	record = &thread->records[written % BLAH_PROFILE_RING_SIZE];
+	record->name = thread->openNames[thread->depth];
+	record->start = thread->openStarts[thread->depth];
+	record->duration = blah_time_getNanoseconds() - record->start;
+	record->depth = thread->depth;
+	atomic_store_explicit(&thread->written, written + 1, memory_order_release); //Publish record to readers
+}
+
+void blah_profile_exit()
+{	//Releases the ring buffers of all threads
+	atomic_store(&enabled, false);
+	call_once(&syncOnce, blah_profile_initSync);
+	mtx_lock(&threadsMutex);
+	while (threads) {
+		Blah_Profile_Thread* next = threads->next;
+		free(threads);
+		threads = next;
+	}
+	threadCount = 0;
+	mtx_unlock(&threadsMutex);
+	currentThread = NULL; //Other threads have stopped, so only the calling thread's pointer remains
+}
+
+size_t blah_profile_getSummary(Blah_Profile_Zone_Summary* summaries, size_t maxCount)
+{	//Copies a summary of each zone recorded into summaries, returning the number of zones
+	Blah_Profile_Sample* samples;
+	size_t sampleCount, zoneCount = 0, first = 0;
+
+	call_once(&syncOnce, blah_profile_initSync);
+	mtx_lock(&threadsMutex);
+	samples = blah_profile_gatherSamples(&sampleCount);
+	mtx_unlock(&threadsMutex);
+
+	while (first < sampleCount) { //Samples of each zone are together, in order of duration
+		size_t last = first;
+		uint64_t total = 0;
+		while (last < sampleCount && blah_profile_compareNames(samples[first].name, samples[last].name) == 0) {
+			total += samples[last++].duration;
+		}
+		if (zoneCount < maxCount) {
+			const size_t count = last - first;
+			Blah_Profile_Zone_Summary* summary = &summaries[zoneCount];
+			summary->name = samples[first].name;
+			summary->count = count;
+			summary->minimum = samples[first].duration;
+			summary->average = total / count;
+			summary->percentile99 = samples[first + (count * 99 + 99) / 100 - 1].duration;
+			summary->maximum = samples[last - 1].duration;
+			summary->total = total;
+		}
+		zoneCount++;
+		first = last;
+	}
+	free(samples);
+	return zoneCount;
+}
+
+bool blah_profile_isEnabled()
+{	//Returns true if zones are being recorded
+	return atomic_load(&enabled);
+}
+
+void blah_profile_setEnabled(bool flag)
+{	//Starts or stops recording zones
+	if (flag && startTime == 0) { startTime = blah_time_getNanoseconds(); }
+	atomic_store(&enabled, flag);
+}
+
+void blah_profile_setThreadName(const char* name)
+{	//Names the calling thread in traces
+	char* dest = currentThread ? currentThread->name : pendingName;
+	snprintf(dest, BLAH_PROFILE_THREAD_NAME_LENGTH+1, "%s", name);
+}
+
+bool blah_profile_writeSummary(const char* fileName)
+{	//Writes a table of the durations of each zone to the named file
+	const size_t zoneCount = blah_profile_getSummary(NULL, 0);
+	Blah_Profile_Zone_Summary* summaries;
+	FILE* file;
+	bool writeOK;
+
+	summaries = malloc((zoneCount ? zoneCount : 1) * sizeof(Blah_Profile_Zone_Summary));
+	if (summaries == NULL) { return false; }
+	file = fopen(fileName, BLAH_FILE_MODE_OVERWRITE);
+	if (file == NULL) { free(summaries); return false; }
+
+	//Zones may have been recorded since counting, so only as many as counted are written
+	const size_t count = blah_profile_getSummary(summaries, zoneCount);
+	fprintf(file, "%-32s %10s %12s %12s %12s %12s %14s\n", "zone", "count", "min us", "avg us", "p99 us", "max us", "total us");
+	for (size_t index = 0; index < count && index < zoneCount; index++) {
+		const Blah_Profile_Zone_Summary* summary = &summaries[index];
+		fprintf(file, "%-32s %10zu %12.3f %12.3f %12.3f %12.3f %14.3f\n", summary->name, summary->count,
+			summary->minimum / 1000.0, summary->average / 1000.0, summary->percentile99 / 1000.0,
+			summary->maximum / 1000.0, summary->total / 1000.0);
+	}
+	writeOK = !ferror(file);
+	writeOK = fclose(file) == 0 && writeOK;
+	free(summaries);
+	return writeOK;
+}
+
+bool blah_profile_writeTrace(const char* fileName)
+{	//Writes all records as Chrome trace event JSON to the named file.  Each record becomes a complete
+	//event, with times in microseconds since recording was first enabled.
+	FILE* file = fopen(fileName, BLAH_FILE_MODE_OVERWRITE);
+	bool writeOK, firstEvent = true;
+
+	if (file == NULL) { return false; }
+	fputs("{\"traceEvents\":[", file);
+	call_once(&syncOnce, blah_profile_initSync);
+	mtx_lock(&threadsMutex);
+	for (Blah_Profile_Thread* thread = threads; thread; thread = thread->next) {
+		const size_t written = atomic_load_explicit(&thread->written, memory_order_acquire);
+		size_t index = Blah_Profile_Thread_getFirst(thread, written);
+
+		fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+			firstEvent ? "" : ",", thread->id);
+		blah_profile_writeString(file, thread->name);
+		fputs("}}", file);
+		firstEvent = false;
+
+		for (; index < written; index++) {
+			const Blah_Profile_Record record = thread->records[index % BLAH_PROFILE_RING_SIZE];
+			//Drop the record if the thread may have since started writing over it
+			if (atomic_load_explicit(&thread->written, memory_order_acquire) - index >= BLAH_PROFILE_RING_SIZE) { continue; }
+			fputs(",\n{\"name\":", file);
+			blah_profile_writeString(file, record.name);
+			fprintf(file, ",\"cat\":\"blah\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+				(record.start - startTime) / 1000.0, record.duration / 1000.0, thread->id);
+		}
+	}
+	mtx_unlock(&threadsMutex);
+	fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+	writeOK = !ferror(file);
+	return fclose(file) == 0 && writeOK;
+}
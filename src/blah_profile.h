@@ -0,0 +1,93 @@
+/* blah_profile.h
+	The profiler records how long named zones of code take, such as each frame, each simulation step
+	or each asset decoded.  A zone is opened with BLAH_PROFILE_BEGIN and closed with BLAH_PROFILE_END
+	in the same function, on every path out of it, and zones may nest.  Each thread records the zones
+	it closes into a ring buffer of its own, so recording takes no lock and the oldest records are
+	overwritten once BLAH_PROFILE_RING_SIZE are held.  Recording is off until blah_profile_setEnabled,
+	and building with BLAH_NO_PROFILE defined removes the macros altogether.
+	Records can be written as a Chrome trace, to be viewed with chrome://tracing or Perfetto, and as a
+	summary of the duration of each zone.  Both are meant to be written while other threads are idle,
+	as records being overwritten while they are read are dropped.
+	Measured by bench/bench_profile.c, timing a million empty zones on one core of a virtualised Xeon,
+	a zone costs about 85ns while recording, of which 70ns is reading the monotonic clock twice, and
+	about 3ns while not. */
+
+#ifndef _BLAH_PROFILE
+
+#define _BLAH_PROFILE
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "blah_types.h"
+
+/* Definitions */
+
+#define BLAH_PROFILE_RING_SIZE 65536	//Records kept for each thread
+#define BLAH_PROFILE_MAX_DEPTH 32	//Deepest nesting of zones recorded, deeper zones are ignored
+#define BLAH_PROFILE_THREAD_NAME_LENGTH 31
+
+#ifdef BLAH_NO_PROFILE
+	#define BLAH_PROFILE_BEGIN(name) ((void)0)
+	#define BLAH_PROFILE_END() ((void)0)
+#else
+	#define BLAH_PROFILE_BEGIN(name) blah_profile_begin(name)	//Opens zone of given name, a string literal
+	#define BLAH_PROFILE_END() blah_profile_end()	//Closes the zone most recently opened on this thread
+#endif //BLAH_NO_PROFILE
+
+/* Structure Definitions */
+
+typedef struct Blah_Profile_Zone_Summary { //Durations of all recorded runs of a zone, in nanoseconds
+	const char* name;
+	size_t count;			//Number of runs recorded
+	uint64_t minimum;
+	uint64_t average;
+	uint64_t percentile99;	//Duration no longer than 99 percent of runs
+	uint64_t maximum;
+	uint64_t total;
+} Blah_Profile_Zone_Summary;
+
+/* Function Prototypes */
+
+#ifdef __cplusplus
+	extern "C" {
+#endif //__cplusplus
+
+void blah_profile_begin(const char* name);
+	//Opens a zone on the calling thread.  Use BLAH_PROFILE_BEGIN rather than calling directly.
+
+void blah_profile_clear();
+	//Discards all records made so far
+
+void blah_profile_end();
+	//Closes the zone most recently opened on the calling thread and records it.  Use BLAH_PROFILE_END.
+
+void blah_profile_exit();
+	//Releases the ring buffers of all threads.  Called by the engine once its threads have stopped.
+
+size_t blah_profile_getSummary(Blah_Profile_Zone_Summary* summaries, size_t maxCount);
+	//Copies a summary of each zone recorded, sorted by name, into summaries, up to maxCount of them.
+	//Returns the number of zones recorded, which may be more than maxCount.
+
+bool blah_profile_isEnabled();
+	//Returns true if zones are being recorded
+
+void blah_profile_setEnabled(bool flag);
+	//Starts or stops recording zones.  Default is false.
+
+void blah_profile_setThreadName(const char* name);
+	//Names the calling thread in traces.  Threads are otherwise named by the order they first recorded.
+
+bool blah_profile_writeSummary(const char* fileName);
+	//Writes a table of the minimum, average, 99th percentile and maximum duration of each zone, in
+	//microseconds, to the named file.  Returns false if the file could not be written.
+
+bool blah_profile_writeTrace(const char* fileName);
+	//Writes all records as Chrome trace event JSON to the named file.  Returns false if the file
+	//could not be written.
+
+#ifdef __cplusplus
+	}
+#endif //__cplusplus
+
+#endif
@@ -6,6 +6,7 @@
 #include <stddef.h>
 
 #include "blah_quaternion.h"
+#include "blah_math.h"
 
 
 /* Function Declarations */
@@ -56,16 +57,34 @@ void Blah_Quaternion_formatEuler(Blah_Quaternion * quat, float x, float y, float
 	}
 }
 
+void Blah_Quaternion_interpolate(Blah_Quaternion *dest, const Blah_Quaternion *quat1, const Blah_Quaternion *quat2, float fraction) {
+	//Normalised linear interpolation from quat1 to quat2
+	const float dot = quat1->x * quat2->x + quat1->y * quat2->y + quat1->z * quat2->z + quat1->w * quat2->w;
+	const float from = 1 - fraction;
+	const float to = dot < 0 ? -fraction : fraction; //q and -q are the same rotation, so take the nearer
+	float length;
+
+	Blah_Quaternion_set(dest, quat1->x * from + quat2->x * to, quat1->y * from + quat2->y * to,
+		quat1->z * from + quat2->z * to, quat1->w * from + quat2->w * to);
+	length = sqrtf(dest->x * dest->x + dest->y * dest->y + dest->z * dest->z + dest->w * dest->w);
+	if (length > 0) {
+		dest->x /= length; dest->y /= length; dest->z /= length; dest->w /= length;
+	}
+}
+
 void Blah_Quaternion_setIdentity(Blah_Quaternion *quat) {
 	quat->w = 1; quat->x = quat->y = quat->z = 0;
 }
 
 
 void Blah_Quaternion_multiplyQuaternion(Blah_Quaternion *quat1, Blah_Quaternion *quat2) {
-	float w = (quat1->w * quat2->w) - (quat1->x * quat2->x) - (quat1->y * quat2->y) - (quat1->z * quat2->z);
-	float x = (quat1->w * quat2->x) + (quat1->x * quat2->w) + (quat1->y * quat2->z)	- (quat1->z * quat2->y);
-	float y = (quat1->w * quat2->y) + (quat1->y * quat2->w) + (quat1->z * quat2->x) - (quat1->x * quat2->z);
-	float z = (quat1->w * quat2->z) + (quat1->z * quat2->w) + (quat1->x * quat2->y) - (quat1->y * quat2->x);
+	blah_math_multiplyQuaternions(quat1, quat1, quat2);
+}
+
+void Blah_Quaternion_normalise(Blah_Quaternion *quat) {
+	blah_math_normaliseQuaternion(quat);
+}
 
-	quat1->w = w; quat1->x = x; quat1->y = y; quat1->z = z;
+void Blah_Quaternion_slerp(Blah_Quaternion *dest, const Blah_Quaternion *quat1, const Blah_Quaternion *quat2, float fraction) {
+	blah_math_slerpQuaternions(dest, quat1, quat2, fraction);
 }
@@ -27,15 +27,26 @@ void Blah_Quaternion_init(Blah_Quaternion *quat, Blah_Vector *axis, float angle)
 void Blah_Quaternion_formatAxisAngle(Blah_Quaternion *quat, Blah_Vector *axis, float angle);
 	//Format a quaternion given axis and rotation angle
 
+void Blah_Quaternion_interpolate(Blah_Quaternion *dest, const Blah_Quaternion *quat1, const Blah_Quaternion *quat2, float fraction);
+	//Stores in dest the rotation the given fraction of the way from quat1 to quat2, taking the shorter
+	//way round.  Uses normalised linear interpolation, which is close to spherical for small steps.
+
 void Blah_Quaternion_multiplyQuaternion(Blah_Quaternion *quat1, Blah_Quaternion *quat2);
 	//Multiplies quat_1 by quat_2 and stores result in quat_1
 
+void Blah_Quaternion_normalise(Blah_Quaternion *quat);
+	//Scales the quaternion to unit length, so that it is a pure rotation
+
 void Blah_Quaternion_setIdentity(Blah_Quaternion *quat);
 	//Set quaternion to identity multiplication matrix (no rotation)
 
 void Blah_Quaternion_formatEuler(Blah_Quaternion * quat, float x, float y, float z);
 	//Format a quaternion given 3 euler angles x,y and z
 
+void Blah_Quaternion_slerp(Blah_Quaternion *dest, const Blah_Quaternion *quat1, const Blah_Quaternion *quat2, float fraction);
+	//Stores in dest the rotation the given fraction of the way from quat1 to quat2, taking the shorter
+	//way round, by spherical linear interpolation, which turns at constant speed
+
 #ifdef __cplusplus
 	}
 #endif //__cplusplus		
@@ -6,11 +6,14 @@
 #include "blah_types.h"
 #include "blah_primitive.h"
 #include "blah_list.h"
+#include "blah_array.h"
 #include "blah_scene.h"
 #include "blah_scene_object.h"
 #include "blah_object.h"
 #include "blah_entity.h"
 #include "blah_draw.h"
+#include "blah_profile.h"
+#include "blah_transform.h"
 
 /* Global variables, private to blah_scene.c */
 
@@ -26,7 +29,7 @@ static void Blah_Scene_setupLight(Blah_Light *light);
 
 void Blah_Scene_addEntity(Blah_Scene *scene, Blah_Entity *entity) {
 	//Adds the given entity to the scene's internal collection of entities
-	Blah_List_appendElement(&scene->entities, entity);
+	Blah_Array_appendElement(&scene->entities, entity);
 }
 
 void Blah_Scene_addLight(Blah_Scene *scene, Blah_Light *light) {
@@ -44,13 +47,15 @@ Blah_Scene_Object *Blah_Scene_addObject(Blah_Scene *scene, Blah_Object *object)
 
 void Blah_Scene_addOverlay(Blah_Scene *scene, Blah_Overlay *overlay) {
 	//Adds given overlay to the scene's list of overlays
-	Blah_List_appendElement(&scene->overlays, overlay);
+	overlay->sceneElement = Blah_List_appendElement(&scene->overlays, overlay);
+	overlay->scene = scene; //Remember element, for removal without searching the list
 }
 
 void Blah_Scene_addSceneObject(Blah_Scene *scene, Blah_Scene_Object *sceneObject) {
 	//Adds the given scene object to the scene's internal collection
 	//of scene objects.
-	Blah_List_appendElement(&scene->objects, sceneObject);
+	sceneObject->sceneIndex = (long)scene->objects.length; //Remember index, for removal without searching
+	Blah_Array_appendElement(&scene->objects, sceneObject);
 }
 
 void Blah_Scene_destroy(Blah_Scene *scene) {
@@ -62,21 +67,34 @@ void Blah_Scene_destroy(Blah_Scene *scene) {
 
 void Blah_Scene_disable(Blah_Scene *scene) {
 	//Destroy all entities and scene_objects belonging to the scene.
-	Blah_List_destroyElements(&scene->objects);
-	Blah_List_destroyElements(&scene->entities);
+	Blah_Array_destroyElements(&scene->objects);
+	Blah_Array_disable(&scene->objects);
+	Blah_Array_destroyElements(&scene->entities);
+	Blah_Array_disable(&scene->entities);
 	Blah_List_destroyElements(&scene->overlays);
 	Blah_List_destroyElements(&scene->lights);
 }
 
 void Blah_Scene_draw(Blah_Scene *scene) {
+	BLAH_PROFILE_BEGIN("Blah_Scene_draw");
 	//Setup lighting parameters
 	blah_draw_setAmbientLight(scene->ambientLightRed, scene->ambientLightGreen,	scene->ambientLightBlue, scene->ambientLightAlpha);
 	Blah_List_callFunction(&scene->lights, (blah_list_element_func*)Blah_Scene_setupLight);
 
-	//Draw the scene with all scene objects, entities and overlays contained within
-	Blah_List_callFunction(&scene->objects, (blah_list_element_func*)Blah_Scene_Object_draw);
-	Blah_List_callFunction(&scene->entities, (blah_list_element_func*)Blah_Entity_draw);
+	//Place entities for this frame, recalculating only the world matrices which have changed
+	BLAH_PROFILE_BEGIN("blah_transform_update");
+	Blah_Array_callFunction(&scene->entities, (blah_array_element_func*)Blah_Entity_updateTransform);
+	blah_transform_update();
+	BLAH_PROFILE_END();
+
+	//Draw the scene with all scene objects, entities and overlays contained within.
+	//Objects and entities are collected in the render queue and drawn sorted, before the overlays.
+	blah_draw_beginQueue();
+	Blah_Array_callFunction(&scene->objects, (blah_array_element_func*)Blah_Scene_Object_draw);
+	Blah_Array_callFunction(&scene->entities, (blah_array_element_func*)Blah_Entity_draw);
+	blah_draw_flushQueue();
 	Blah_List_callFunction(&scene->overlays, (blah_list_element_func*)Blah_Overlay_draw);
+	BLAH_PROFILE_END();
 }
 
 /* void Blah_Scene_draw_all() {
@@ -93,10 +111,10 @@ void Blah_Scene_draw(Blah_Scene *scene) {
 void Blah_Scene_init(Blah_Scene* scene) {
 	Blah_Point_set(&scene->origin, 0,0,0);
 	Blah_Matrix_setIdentity(&scene->sceneMatrix);
-	Blah_List_init(&scene->entities, "Scene Entities");
-	Blah_List_setDestroyElementFunction(&scene->entities, (blah_list_element_dest_func*)Blah_Entity_destroy);
-	Blah_List_init(&scene->objects, "Scene Objects");
-	Blah_List_setDestroyElementFunction(&scene->objects, (blah_list_element_dest_func*)Blah_Scene_Object_destroy);
+	Blah_Array_init(&scene->entities, "Scene Entities");
+	Blah_Array_setDestroyElementFunction(&scene->entities, (blah_array_element_dest_func*)Blah_Entity_destroy);
+	Blah_Array_init(&scene->objects, "Scene Objects");
+	Blah_Array_setDestroyElementFunction(&scene->objects, (blah_array_element_dest_func*)Blah_Scene_Object_destroy);
 	Blah_List_init(&scene->overlays, "Scene Overlays");
 	Blah_List_setDestroyElementFunction(&scene->overlays, (blah_list_element_dest_func*)Blah_Overlay_destroy);
 	Blah_List_init(&scene->lights, "Scene Lights");
@@ -129,17 +147,23 @@ Blah_Scene *Blah_Scene_new() {
 
 void Blah_Scene_removeLight(Blah_Scene *scene, Blah_Light *light) {
 	//Removes specified light from the scene
-	Blah_List_removeElement(&scene->overlays, light);
+	Blah_List_removeElement(&scene->lights, light);
 }
 
 void Blah_Scene_removeOverlay(Blah_Scene *scene, Blah_Overlay *overlay) {
 	//Removes specified overlay from the scene
-	Blah_List_removeElement(&scene->overlays, overlay);
+	if (overlay->scene == scene && overlay->sceneElement) {
+		Blah_List_removeElementHandle(&scene->overlays, overlay->sceneElement);
+		overlay->scene = NULL;
+		overlay->sceneElement = NULL;
+	} else { //Overlay has been added to another scene since, so search for it
+		Blah_List_removeElement(&scene->overlays, overlay);
+	}
 }
 
 void Blah_Scene_removeEntity(Blah_Scene *scene, Blah_Entity *entity) {
 	//Removes the given entity from the scene's internal collection of entities
-	Blah_List_removeElement(&scene->entities, entity);
+	Blah_Array_removeElement(&scene->entities, entity);
 }
 
 /* void Blah_Scene_removeObject(Blah_Scene *scene, Blah_Object *sceneObject);
@@ -148,8 +172,18 @@ void Blah_Scene_removeEntity(Blah_Scene *scene, Blah_Entity *entity) {
 
 void Blah_Scene_removeSceneObject(Blah_Scene *scene, Blah_Scene_Object *sceneObject) {
 	//Removes the given scene object from the scene's internal collection of scene
-	//objects
-	Blah_List_removeElement(&scene->objects, sceneObject);
+	//objects.  The last scene object is moved into the place of the removed one.
+	long index = sceneObject->sceneIndex;
+	Blah_Scene_Object *movedObject;
+
+	if (index < 0 || (size_t)index >= scene->objects.length || scene->objects.elements[index] != sceneObject) {
+		//Object has been added to another scene since, so search for it
+		index = Blah_Array_findIndex(&scene->objects, sceneObject);
+		if (index < 0) { return; }
+	}
+	movedObject = Blah_Array_removeIndexUnordered(&scene->objects, (size_t)index);
+	if (movedObject) { movedObject->sceneIndex = index; }
+	sceneObject->sceneIndex = -1;
 }
 
 void Blah_Scene_setAmbientLight(Blah_Scene *scene, float red, float green, float blue, float alpha) {
@@ -9,6 +9,7 @@
 #include "blah_types.h"
 #include "blah_primitive.h"
 #include "blah_list.h"
+#include "blah_array.h"
 #include "blah_scene_object.h"
 #include "blah_object.h"
 #include "blah_entity.h"
@@ -35,8 +36,8 @@ typedef void blah_scene_draw_func(struct Blah_Scene* scene); //This function typ
 typedef struct Blah_Scene { //represents an object in the world
 	Blah_Point origin; //center point of scene
 	Blah_Matrix sceneMatrix; //scene's matrix.  Don't mess with it directly.
-	Blah_List objects;	//List of passive objects in the scene
-	Blah_List entities;		//List of active entities in scene
+	Blah_Array objects;		//Array of passive objects in the scene
+	Blah_Array entities;	//Array of active entities in scene
 	Blah_List overlays;		//List of 2D overlays, drawn infront of rendered 3D
 	Blah_List lights;		//List of light sources used to render scene (Blah_Light)
 	//Lighting info
@@ -100,6 +101,7 @@ void Blah_Scene_removeOverlay(Blah_Scene *scene, Blah_Overlay *overlay);
 
 void Blah_Scene_removeSceneObject(Blah_Scene *scene, Blah_Scene_Object *sceneObject);
     // Removes the given scene object from the scene's internal collection of scene objects
+    // in constant time.  The last scene object takes the place of the removed one in drawing order.
 
 void Blah_Scene_setAmbientLight(Blah_Scene *scene, float red, float green, float blue, float alpha);
     // Sets the ambient light properties of the scene
@@ -46,7 +46,7 @@ void Blah_Scene_Object_draw(Blah_Scene_Object *sceneObject) {
 		//If the entity object defines a special draw function, use it
 		if (sceneObject->drawFunction)
 			sceneObject->drawFunction(sceneObject);
-		else //Just use the standard object draw function
+		else if (blah_draw_isObjectVisible(sceneObject->object)) //Just use the standard object draw function, unless out of view
 			Blah_Object_draw(sceneObject->object);
 		blah_draw_popMatrix();
 	}
@@ -62,6 +62,7 @@ void Blah_Scene_Object_init(Blah_Scene_Object *sceneObject, char *name, Blah_Obj
 	Blah_Vector_set(&sceneObject->axisZ, 0,0,0);
 	sceneObject->drawFunction = NULL;
 	sceneObject->visible = true; //visible by default
+	sceneObject->sceneIndex = -1; //not in a scene until added
 }
 
 void Blah_Scene_Object_setDrawFunction(Blah_Scene_Object* sceneObject, blah_scene_object_draw_func* function) {
@@ -33,6 +33,7 @@ typedef struct Blah_Scene_Object { //represents an scene object in the world
 	Blah_Vector axisX, axisY, axisZ; // object's own primary axes x,y, and z
 	blah_scene_object_draw_func* drawFunction;
 	bool visible;		// Visibility flag; If TRUE, then object is drawn
+	long sceneIndex;	// Index in the object array of the scene holding the object, or -1 if not in a scene
 } Blah_Scene_Object;
 
 /* Structure Function prototypes */
@@ -9,19 +9,112 @@
 #include "blah_tree.h"
 #include "blah_util.h"
 #include "blah_types.h"
+#include "blah_error.h"
 
 /* Private local variables */
 
-static Blah_Tree textureTree = {"", NULL, NULL, 0};	//Tree of all constructed textures in memory, key is file name
+static Blah_Tree textureTree = { .name = "textures", .hashIndex = true,	//Tree of all constructed textures in memory, key is file name.  Hashed for blah_texture_find
+	.destroyElementFunction = (blah_tree_element_dest_func*)Blah_Texture_destroy };	//Releases mip chain and residency along with the texture
+static Blah_List residencyList = { .name = "texture residency" };	//Textures whose levels may be dropped, least recently drawn first
+static Blah_Texture_Stats textureStats = { .budgetBytes = BLAH_TEXTURE_DEFAULT_BUDGET };
+static unsigned long currentFrame = 1;	//Textures never drawn have lastUsedFrame 0
 
+/* Static Function Declarations */
+
+static size_t blah_texture_getLevelBytes(const Blah_Texture *texture, unsigned int level)
+{	//Returns the number of bytes in given level of the texture's mip chain
+	const unsigned int width = texture->width >> level, height = texture->height >> level;
+	return (size_t)(width ? width : 1) * (height ? height : 1) * (texture->pixelDepth >> 3);
+}
+
+static size_t blah_texture_getChainBytes(const Blah_Texture *texture, unsigned int fromLevel)
+{	//Returns the number of bytes in the levels of the texture's mip chain from given level onwards
+	size_t bytes = 0;
+	for (unsigned int level = fromLevel; level < texture->levelCount; level++) { bytes += blah_texture_getLevelBytes(texture, level); }
+	return bytes;
+}
+
+static inline void blah_texture_downsample(unsigned char *dest, const unsigned char *source,
+	unsigned int sourceWidth, unsigned int sourceHeight, const unsigned int channels)
+{	//Writes the next mip level of the source level into dest, each pixel the average of a 2x2 block.
+	//A source with a single row or column is averaged with itself.
+	const unsigned int width = sourceWidth > 1 ? sourceWidth / 2 : 1, height = sourceHeight > 1 ? sourceHeight / 2 : 1;
+	const size_t sourceRowBytes = (size_t)sourceWidth * channels;
+	const size_t nextRow = sourceHeight > 1 ? sourceRowBytes : 0, nextPixel = sourceWidth > 1 ? channels : 0;
+
+	for (unsigned int y = 0; y < height; y++) {
+		const unsigned char *row = source + 2 * y * nextRow;
+		for (unsigned int x = 0; x < width; x++) {
+			const unsigned char *pixel = row + 2 * x * nextPixel;
+			for (unsigned int channel = 0; channel < channels; channel++) {
+				*dest++ = (unsigned char)((pixel[channel] + pixel[channel + nextPixel] + pixel[channel + nextRow]
+					+ pixel[channel + nextRow + nextPixel] + 2) >> 2);
+			}
+		}
+	}
+}
+
+static void Blah_Texture_fillLevels(Blah_Texture *texture, const void *pixelData)
+{	//Fills the texture's allocated mip chain from full size pixel data
+	const unsigned int channels = texture->pixelDepth >> 3;
+	unsigned char *level;
+
+	memcpy(texture->levelData, pixelData, blah_texture_getLevelBytes(texture, 0));
+	level = texture->levelData;
+	for (unsigned int levelIndex = 1; levelIndex < texture->levelCount; levelIndex++) {
+		unsigned char *nextLevel = level + blah_texture_getLevelBytes(texture, levelIndex - 1);
+		const unsigned int width = texture->width >> (levelIndex - 1), height = texture->height >> (levelIndex - 1);
+		switch (channels) { //Constant channel counts let the compiler unroll and vectorise the filter
+			case 3 : blah_texture_downsample(nextLevel, level, width ? width : 1, height ? height : 1, 3); break;
+			case 4 : blah_texture_downsample(nextLevel, level, width ? width : 1, height ? height : 1, 4); break;
+			default : blah_texture_downsample(nextLevel, level, width ? width : 1, height ? height : 1, channels); break;
+		}
+		level = nextLevel;
+	}
+}
+
+static void Blah_Texture_createLevels(Blah_Texture *texture, const Blah_Image *sourceImage)
+{	//Allocates the texture's mip chain and fills it from the source image
+	texture->levelCount = 1;
+	while ((texture->width >> texture->levelCount) || (texture->height >> texture->levelCount)) { texture->levelCount++; }
+	texture->levelData = malloc(blah_texture_getChainBytes(texture, 0));
+	if (texture->levelData == NULL) { blah_error_raise(errno, "Failed to allocate mip chain for texture '%s'", texture->name); }
+	Blah_Texture_fillLevels(texture, sourceImage->pixelData);
+}
+
+static void Blah_Texture_setBaseLevel(Blah_Texture *texture, unsigned int baseLevel)
+{	//Uploads the texture's mip chain from given level, updating the counters
+	const size_t newBytes = blah_texture_getChainBytes(texture, baseLevel);
+
+	if (baseLevel > texture->baseLevel) {
+		textureStats.levelsDropped += baseLevel - texture->baseLevel;
+	} else {
+		textureStats.levelsRestored += texture->baseLevel - baseLevel;
+	}
+	texture->baseLevel = baseLevel;
+	Blah_Texture_gl_updateLevels(texture);
+	textureStats.residentBytes += newBytes - texture->residentBytes;
+	textureStats.uploadBytes += newBytes;
+	texture->residentBytes = newBytes;
+}
 
 /* Function Declarations */
 
 Blah_Texture* Blah_Texture_fromImage(const Blah_Image* sourceImage) {
 	// Creates a new texture from a source image, adds to texture_tree and retunrs pointer to new texture object.
 	// If an error occurs, this function returns a NULL pointer.
-    const blah_texture_handle handle = Blah_Texture_gl_new(sourceImage);
-	return Blah_Texture_new(sourceImage->name, sourceImage->width, sourceImage->height, handle, sourceImage->pixelFormat, sourceImage->pixelDepth);
+	Blah_Texture *texture = Blah_Texture_new(sourceImage->name, sourceImage->width, sourceImage->height, 0, sourceImage->pixelFormat, sourceImage->pixelDepth);
+
+	if (texture != NULL) {
+		Blah_Texture_createLevels(texture, sourceImage);
+		texture->handle = Blah_Texture_gl_newLevels(texture);
+		texture->residentBytes = blah_texture_getChainBytes(texture, 0);
+		textureStats.residentBytes += texture->residentBytes;
+		textureStats.uploadBytes += texture->residentBytes;
+		texture->lastUsedFrame = currentFrame; //Counts as just drawn, keeping the residency list in order of drawing
+		texture->residencyElement = Blah_List_appendElement(&residencyList, texture);
+	}
+	return texture;
 }
 
 
@@ -33,6 +126,9 @@ void Blah_Texture_destroy(Blah_Texture *texture) {
 void Blah_Texture_disable(Blah_Texture *texture) {
 	Blah_Tree_removeElement(&textureTree, texture->name); //Remove texture by name
 	Blah_Texture_gl_destroy(texture->handle);
+	if (texture->residencyElement) { Blah_List_removeElementHandle(&residencyList, texture->residencyElement); }
+	textureStats.residentBytes -= texture->residentBytes;
+	free(texture->levelData);
 }
 
 Blah_Texture *blah_texture_find(const char *name) {
@@ -58,6 +154,48 @@ void Blah_Texture_init(Blah_Texture *texture, const char* name, unsigned int wid
     blah_util_strncpy(texture->name, name, BLAH_TEXTURE_NAME_LENGTH);
     //Call API specific function to create a texture and return handle to it
     texture->handle = handle;
+    texture->levelCount = 1;
+    texture->baseLevel = 0;
+    texture->pinned = false;
+    texture->levelData = NULL;
+    texture->residentBytes = 0;
+    texture->lastUsedFrame = 0;
+    texture->residencyElement = NULL;
+}
+
+void blah_texture_getStats(Blah_Texture_Stats *stats) {
+	//Copies the counters of texture memory use into *stats
+	*stats = textureStats;
+}
+
+void blah_texture_main() {
+	//Restores levels of textures drawn in the previous frame, then drops levels of idle textures while over budget
+	Blah_List_Element *element;
+
+	currentFrame++;
+	textureStats.uploadBytes = 0;
+	textureStats.levelsDropped = textureStats.levelsRestored = 0;
+
+	//Most recently drawn textures are at the end of the list
+	for (element = residencyList.last; element; element = element->prev) {
+		Blah_Texture *texture = element->data;
+		if (texture->lastUsedFrame + 1 < currentFrame) { break; }
+		if (texture->baseLevel > 0) { Blah_Texture_setBaseLevel(texture, texture->baseLevel - 1); }
+	}
+
+	element = residencyList.first;
+	while (element && textureStats.residentBytes > textureStats.budgetBytes) {
+		Blah_Texture *texture = element->data;
+		unsigned int baseLevel = texture->baseLevel;
+		if (texture->lastUsedFrame + BLAH_TEXTURE_IDLE_FRAMES >= currentFrame) { break; } //Remaining textures are drawn more recently
+		//Drop as many levels as needed at once, to upload the texture only once, but keep the coarsest level
+		while (baseLevel + 1 < texture->levelCount && textureStats.residentBytes - texture->residentBytes
+			+ blah_texture_getChainBytes(texture, baseLevel) > textureStats.budgetBytes) {
+			baseLevel++;
+		}
+		if (baseLevel != texture->baseLevel && !texture->pinned) { Blah_Texture_setBaseLevel(texture, baseLevel); }
+		element = element->next;
+	}
 }
 
 Blah_Texture *Blah_Texture_new(const char* name, unsigned int width, unsigned int height, blah_texture_handle handle,
@@ -116,6 +254,37 @@ void Blah_Texture_Map_destroy(Blah_Texture_Map *map) {
 	free(map);
 }
 
+void blah_texture_setBudget(size_t bytes) {
+	//Sets the bytes of texture levels which may be uploaded before levels are dropped
+	textureStats.budgetBytes = bytes;
+}
+
+void Blah_Texture_setPinned(Blah_Texture *texture, bool pinned) {
+	//Pins the texture, restoring all its levels, or unpins it
+	texture->pinned = pinned;
+	if (pinned && texture->baseLevel > 0) { Blah_Texture_setBaseLevel(texture, 0); }
+}
+
+void Blah_Texture_update(Blah_Texture *texture, const void *pixelData) {
+	//Replaces the contents of the texture with pixel data of the same size and format, regenerating the mip chain
+	Blah_Texture_fillLevels(texture, pixelData);
+	Blah_Texture_gl_updateLevels(texture);
+	textureStats.uploadBytes += texture->residentBytes;
+}
+
+void Blah_Texture_use(const Blah_Texture *texture) {
+	//Records that the texture is drawn in this frame, moving it to the end of the residency list.
+	//Only residency bookkeeping is changed, hence taking a constant texture as drawing code does.
+	Blah_Texture *usedTexture = (Blah_Texture*)texture;
+
+	if (usedTexture->lastUsedFrame == currentFrame) { return; }
+	usedTexture->lastUsedFrame = currentFrame;
+	if (usedTexture->residencyElement && usedTexture->residencyElement != residencyList.last) {
+		Blah_List_removeElementHandle(&residencyList, usedTexture->residencyElement);
+		usedTexture->residencyElement = Blah_List_appendElement(&residencyList, usedTexture);
+	}
+}
+
 void blah_texture_destroyAll() {
 	//Destroys and deallocates all textures still in memory
 	Blah_Tree_destroyElements(&textureTree);
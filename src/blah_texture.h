@@ -1,17 +1,26 @@
 /* blah_texture.h
 	Header file for blah_texture.c
-	Defines structure for textures and functions to manipulate textures */
+	Defines structure for textures and functions to manipulate textures
+	Textures made from images keep a mip chain, box filtered at load time, in system memory.  While
+	the uploaded levels of all textures exceed the texture memory budget, textures not drawn for a
+	while lose their finest levels, least recently drawn first, and regain them once drawn again. */
 
 #ifndef _BLAH_TEXTURE
 
 #define _BLAH_TEXTURE
 
+#include <stddef.h>
+
 #include "blah_image.h"
+#include "blah_list.h"
 #include "blah_point.h"
 
 /* Defines */
 
 #define BLAH_TEXTURE_NAME_LENGTH 50
+#define BLAH_TEXTURE_MAX_LEVELS 32	//Enough mip levels for any texture size
+#define BLAH_TEXTURE_DEFAULT_BUDGET ((size_t)256 << 20)	//Bytes of texture levels which may be uploaded before levels are dropped
+#define BLAH_TEXTURE_IDLE_FRAMES 60	//Frames a texture must go undrawn before its levels may be dropped
 
 /* Type Definitions */
 
@@ -27,9 +36,23 @@ typedef struct Blah_Texture {
 	blah_texture_handle handle;		//Handle to texture, e.g. GLuint tex name for OpenGL
 	blah_pixel_format pixelFormat;	//Format texture pixels are stored in
 	unsigned char pixelDepth;	//Colour depth of pixels in bits per pixel e.g. 32
-	// unsigned char mipMapLevel;
+	unsigned char levelCount;	//Number of levels in the mip chain, level 0 being full size
+	unsigned char baseLevel;	//Finest level uploaded, above 0 while finer levels are dropped
+	bool pinned;				//Levels of pinned textures are never dropped
+	void *levelData;			//All levels of the mip chain, finest first, or NULL if not kept
+	size_t residentBytes;		//Bytes of the levels currently uploaded
+	unsigned long lastUsedFrame;	//Frame the texture was last drawn in
+	Blah_List_Element *residencyElement;	//Position in order of drawing, NULL if levels are never dropped
 } Blah_Texture;
 
+typedef struct Blah_Texture_Stats { //Counters of texture memory use
+	size_t residentBytes;		//Bytes of all texture levels currently uploaded
+	size_t budgetBytes;			//Bytes which may be uploaded before levels of idle textures are dropped
+	size_t uploadBytes;			//Bytes uploaded since the start of the frame
+	unsigned long levelsDropped;	//Levels dropped since the start of the frame
+	unsigned long levelsRestored;	//Levels restored since the start of the frame
+} Blah_Texture_Stats;
+
 typedef struct Blah_Texture_Map {
 	Blah_Point *mapping; // Pointer to an allocated array of texture coordinates
 								// NULL means auto mapping.  Need one per vertex in sequence
@@ -44,6 +67,7 @@ typedef struct Blah_Texture_Map {
 
 Blah_Texture* Blah_Texture_fromImage(const Blah_Image* sourceImage);
 	// Creates a new texture from a source image, adds to texture_tree and returns pointer to new texture object.
+	// A mip chain is generated from the image and kept, so that levels can be dropped and restored.
 	// If an error occurs, this function returns a NULL pointer.
 
 void Blah_Texture_destroy(Blah_Texture *texture);
@@ -52,6 +76,9 @@ void Blah_Texture_destroy(Blah_Texture *texture);
 void Blah_Texture_disable(Blah_Texture *texture);
 	// free texture resources and remove texture from the tree
 
+void blah_texture_getStats(Blah_Texture_Stats *stats);
+	// Copies the counters of texture memory use into *stats
+
 Blah_Texture *blah_texture_find(const char *name);
 	// Attempts to find a texture with given name in the texture tree.  Texture names
 	// are used as keys in the binary tree.  Returns pointer to texture if successful
@@ -61,10 +88,28 @@ void Blah_Texture_init(Blah_Texture *texture, const char* name, unsigned int wid
  blah_pixel_format pixelFormat, unsigned char pixelDepth /*, unsigned char mipMapLevel */);
     // Initialise texture object.
 
+void blah_texture_main();
+	// Begins a new frame.  Restores a level to each texture drawn in the previous frame which has
+	// levels dropped, then drops levels of textures not drawn recently, least recently drawn first,
+	// until the uploaded levels fit within the budget.  Called by blah_engine_main.
+
 Blah_Texture *Blah_Texture_new(const char* name, unsigned int width, unsigned int height, blah_texture_handle handle,
  blah_pixel_format pixelFormat, unsigned char pixelDepth /*, unsigned char mipMapLevel */);
     // Create new texture object, add to internal list of textures and return pointer
 
+void blah_texture_setBudget(size_t bytes);
+	// Sets the bytes of texture levels which may be uploaded before levels of idle textures are dropped
+
+void Blah_Texture_setPinned(Blah_Texture *texture, bool pinned);
+	// Pinned textures keep all their levels uploaded, restoring any dropped levels immediately
+
+void Blah_Texture_update(Blah_Texture *texture, const void *pixelData);
+	// Replaces the contents of a texture made from an image with new pixel data of the same width, height
+	// and pixel format, regenerating its mip chain and uploading the levels currently in use.
+
+void Blah_Texture_use(const Blah_Texture *texture);
+	// Records that the texture is drawn in the current frame.  Called by the drawing API when binding.
+
 // Texture Map functions
 
 bool Blah_Texture_Map_init(Blah_Texture_Map *map, const Blah_Texture* texture, const Blah_Point* mapping[]);
@@ -5,37 +5,66 @@
 
 #include "blah_texture.h"
 
-/* Function Declarations */
-
-blah_texture_handle Blah_Texture_gl_new(const Blah_Image* sourceImage) {
-	//Creates a new texture from a source image
-	GLuint newTextureName;	//OpenGL texture name
-	GLenum texturePixelFormat;
-	GLenum sourceFormat;
+/* Static Function Declarations */
 
-	switch(sourceImage->pixelFormat) {
+static void Blah_Texture_gl_getFormats(blah_pixel_format pixelFormat, GLenum *texturePixelFormat, GLenum *sourceFormat) {
+	//Returns the GL internal format and source data format for the given pixel format
+	switch(pixelFormat) {
 		case BLAH_PIXEL_FORMAT_RGBA :
-			texturePixelFormat = GL_RGBA;
-			sourceFormat = GL_RGBA;
+			*texturePixelFormat = GL_RGBA;
+			*sourceFormat = GL_RGBA;
 			break;
 		case BLAH_PIXEL_FORMAT_BGRA :
-			texturePixelFormat = GL_RGBA;
-			sourceFormat = GL_BGRA;
+			*texturePixelFormat = GL_RGBA;
+			*sourceFormat = GL_BGRA;
 			break;
 		case BLAH_PIXEL_FORMAT_RGB :
-			texturePixelFormat = GL_RGB;
-			sourceFormat = GL_RGB;
+			*texturePixelFormat = GL_RGB;
+			*sourceFormat = GL_RGB;
 			break;
 		case BLAH_PIXEL_FORMAT_BGR :
-			texturePixelFormat = GL_RGB;
-			sourceFormat = GL_BGR;
+			*texturePixelFormat = GL_RGB;
+			*sourceFormat = GL_BGR;
 			break;
 		default :
-			texturePixelFormat = GL_RGBA;
-			sourceFormat = GL_RGBA;
+			*texturePixelFormat = GL_RGBA;
+			*sourceFormat = GL_RGBA;
 			break;
 	}
+}
+
+static void Blah_Texture_gl_specifyLevels(const Blah_Texture* texture) {
+	//Specifies the levels of the bound GL texture from the texture's mip chain, starting at its base level
+	const unsigned int channels = texture->pixelDepth >> 3;
+	const unsigned char *levelData = texture->levelData;
+	GLenum texturePixelFormat, sourceFormat;
+
+	Blah_Texture_gl_getFormats(texture->pixelFormat, &texturePixelFormat, &sourceFormat);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1); //Rows of small RGB levels are not padded to four bytes
+	for (unsigned int level = 0; level < texture->levelCount; level++) {
+		const GLsizei width = texture->width >> level ? texture->width >> level : 1;
+		const GLsizei height = texture->height >> level ? texture->height >> level : 1;
+		if (level >= texture->baseLevel) {
+			glTexImage2D(GL_TEXTURE_2D, level - texture->baseLevel, texturePixelFormat, width, height, 0,
+				sourceFormat, GL_UNSIGNED_BYTE, levelData);
+		}
+		levelData += (size_t)width * height * channels;
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture->levelCount - 1 - texture->baseLevel);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture->levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);	// Trilinear Filtering
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);	// Linear Filtering
+}
+
+/* Function Declarations */
+
+blah_texture_handle Blah_Texture_gl_new(const Blah_Image* sourceImage) {
+	//Creates a new texture from a source image
+	GLuint newTextureName;	//OpenGL texture name
+	GLenum texturePixelFormat;
+	GLenum sourceFormat;
 
+	Blah_Texture_gl_getFormats(sourceImage->pixelFormat, &texturePixelFormat, &sourceFormat);
 	glGenTextures(1,&newTextureName); //Get a new texture name using OpenGL API
 	glBindTexture(GL_TEXTURE_2D, newTextureName);
 	glTexImage2D(GL_TEXTURE_2D, 0, texturePixelFormat, sourceImage->width,
@@ -48,6 +77,31 @@ blah_texture_handle Blah_Texture_gl_new(const Blah_Image* sourceImage) {
 	return (blah_texture_handle)newTextureName;
 }
 
+blah_texture_handle Blah_Texture_gl_newLevels(const Blah_Texture* texture) {
+	//Creates a new texture from the texture's mip chain, keeping the current binding
+	GLuint newTextureName;	//OpenGL texture name
+	GLint boundTextureName;
+
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTextureName); //Drawing code tracks the bound texture
+	glGenTextures(1, &newTextureName);
+	glBindTexture(GL_TEXTURE_2D, newTextureName);
+	Blah_Texture_gl_specifyLevels(texture);
+	glBindTexture(GL_TEXTURE_2D, (GLuint)boundTextureName);
+
+	return (blah_texture_handle)newTextureName;
+}
+
+void Blah_Texture_gl_updateLevels(const Blah_Texture* texture) {
+	//Respecifies the texture from its mip chain, keeping the current binding.  Levels beyond the
+	//new maximum level are left in place but unused.
+	GLint boundTextureName;
+
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTextureName);
+	glBindTexture(GL_TEXTURE_2D, (GLuint)texture->handle);
+	Blah_Texture_gl_specifyLevels(texture);
+	glBindTexture(GL_TEXTURE_2D, (GLuint)boundTextureName);
+}
+
 void Blah_Texture_gl_destroy(blah_texture_handle handle) {
 	//Destroys a texture
 	GLuint temp = (GLuint)handle;
@@ -7,6 +7,7 @@
 #define _BLAH_TEXTURE_GL
 
 #include "blah_image.h"
+#include "blah_texture.h"
 
 /* Public Function Prototypes */
 
@@ -17,6 +18,12 @@
 blah_texture_handle Blah_Texture_gl_new(const Blah_Image* sourceImage);
 	//Creates a new internal GL texture from a source image
 
+blah_texture_handle Blah_Texture_gl_newLevels(const Blah_Texture* texture);
+	//Creates a new internal GL texture from the levels of the texture's mip chain, from its base level
+
+void Blah_Texture_gl_updateLevels(const Blah_Texture* texture);
+	//Respecifies the GL texture from the levels of the texture's mip chain, after its base level changed
+
 void Blah_Texture_gl_destroy(blah_texture_handle handle);
 	//Destroys a GL texture given handle
 
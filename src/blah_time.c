@@ -2,8 +2,16 @@
     Time related routines
 */
 
+#define _POSIX_C_SOURCE 200809L	//For clock_gettime and localtime_r
+
+#include <threads.h>
+
 #include "blah_time.h"
 
+/* Definitions */
+
+#define BLAH_TIME_NANOSECONDS 1000000000ULL	//Nanoseconds in a second
+
 /* Private Local Types */
 typedef struct tm tm;
 
@@ -23,7 +31,11 @@ static void blah_time_formatTM(const tm* noTimeZone, const char* formatString, c
 static void blah_time_toLocalTM(const blah_time* epochTime, tm* localTM)
 {
     // Use localtime_s or locatime_r depending upon which one is available
+#ifdef _WIN32
     localtime_s(localTM, epochTime);
+#else
+    localtime_r(epochTime, localTM);
+#endif
 }
 
 /* Public Functions */
@@ -34,6 +46,27 @@ void blah_time_getCurrentUTC(blah_time* dest)
     time((time_t*)dest);
 }
 
+// Returns nanoseconds elapsed on a monotonic clock since an arbitrary point
+uint64_t blah_time_getNanoseconds()
+{
+    struct timespec now;
+#ifdef CLOCK_MONOTONIC
+    clock_gettime(CLOCK_MONOTONIC, &now);
+#else
+    timespec_get(&now, TIME_UTC); // Not monotonic, but the best C11 offers
+#endif
+    return (uint64_t)now.tv_sec * BLAH_TIME_NANOSECONDS + (uint64_t)now.tv_nsec;
+}
+
+// Suspends the calling thread for at least the given number of nanoseconds
+void blah_time_sleep(uint64_t nanoseconds)
+{
+    struct timespec duration = { .tv_sec = (time_t)(nanoseconds / BLAH_TIME_NANOSECONDS),
+        .tv_nsec = (long)(nanoseconds % BLAH_TIME_NANOSECONDS) };
+    // Sleep again for the remaining time if woken by a signal
+    while (thrd_sleep(&duration, &duration) == -1) { }
+}
+
 // Formats given epoch GMT time as a time-only value in the local zone
 void Blah_Time_toLocalTimeString(const blah_time* epochTime, char* dest, size_t charCount)
 {
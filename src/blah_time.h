@@ -6,6 +6,7 @@
 
 #define _BLAH_TIME
 
+#include <stdint.h>
 #include <time.h>
 
 /* Type Definitions */
@@ -18,6 +19,13 @@ typedef time_t blah_time;
 // Retrieve the current time in UTC into timespec pointed by 'dest'
 void blah_time_getCurrentUTC(blah_time* dest);
 
+// Returns nanoseconds elapsed on a monotonic clock since an arbitrary point, for measuring intervals.
+// Unlike the UTC time, it is never set back or forward.
+uint64_t blah_time_getNanoseconds();
+
+// Suspends the calling thread for at least the given number of nanoseconds
+void blah_time_sleep(uint64_t nanoseconds);
+
 // Formats given epoch GMT time as a time-only string in the local zone
 void Blah_Time_toLocalTimeString(const blah_time* epochTime, char* dest, size_t charCount);
 
@@ -0,0 +1,244 @@
+/* blah_transform.c
+	Defines the transform hierarchy.  See blah_transform.h for reference. */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "blah_transform.h"
+#include "blah_error.h"
+#include "blah_math.h"
+
+/* Definitions */
+
+#define BLAH_TRANSFORM_USED 1		//Slot holds a node
+#define BLAH_TRANSFORM_DIRTY 2		//Local matrix or parent changed since the last update
+#define BLAH_TRANSFORM_UPDATED 4	//World matrix recalculated by the last update
+
+/* Static Globals - Private to transform.c */
+
+static Blah_Matrix* transformLocals = NULL;
+static Blah_Matrix* transformWorlds = NULL;
+static long* transformParents = NULL;		//Parent of each node, or next free slot for removed nodes
+static long* transformFirstChildren = NULL;	//First child of each node, heading the list linked by siblings
+static long* transformNextSiblings = NULL;	//Next and previous children of the same parent, so that
+static long* transformPrevSiblings = NULL;	//removing a node visits only its own children
+static unsigned char* transformFlags = NULL;
+static long* transformOrder = NULL;			//Indices of nodes, every parent before its children
+static size_t transformCount = 0;			//Number of slots used, by nodes or removed nodes
+static size_t transformCapacity = 0;		//Number of slots allocated in each array
+static size_t transformOrderLength = 0;
+static bool transformOrderDirty = false;	//True if nodes were added, removed or moved since the order was built
+static long transformFreeSlot = BLAH_TRANSFORM_NONE;	//Most recently removed slot, heading the chain of free slots
+
+/* Static Function Definitions */
+
+static void blah_transform_grow()
+{	//Doubles the capacity of all arrays of the hierarchy
+	const size_t newCapacity = transformCapacity ? transformCapacity * 2 : 64;
+	Blah_Matrix* newLocals = realloc(transformLocals, newCapacity * sizeof(Blah_Matrix));
+	if (newLocals == NULL) { blah_error_raise(errno, "Failed to grow transform hierarchy"); }
+	transformLocals = newLocals;
+	Blah_Matrix* newWorlds = realloc(transformWorlds, newCapacity * sizeof(Blah_Matrix));
+	if (newWorlds == NULL) { blah_error_raise(errno, "Failed to grow transform hierarchy"); }
+	transformWorlds = newWorlds;
+	long* newParents = realloc(transformParents, newCapacity * sizeof(long));
+	if (newParents == NULL) { blah_error_raise(errno, "Failed to grow transform hierarchy"); }
+	transformParents = newParents;
+	unsigned char* newFlags = realloc(transformFlags, newCapacity);
+	if (newFlags == NULL) { blah_error_raise(errno, "Failed to grow transform hierarchy"); }
+	transformFlags = newFlags;
+	long* newOrder = realloc(transformOrder, newCapacity * sizeof(long));
+	if (newOrder == NULL) { blah_error_raise(errno, "Failed to grow transform hierarchy"); }
+	transformOrder = newOrder;
+	long* newFirstChildren = realloc(transformFirstChildren, newCapacity * sizeof(long));
+	if (newFirstChildren == NULL) { blah_error_raise(errno, "Failed to grow transform hierarchy"); }
+	transformFirstChildren = newFirstChildren;
+	long* newNextSiblings = realloc(transformNextSiblings, newCapacity * sizeof(long));
+	if (newNextSiblings == NULL) { blah_error_raise(errno, "Failed to grow transform hierarchy"); }
+	transformNextSiblings = newNextSiblings;
+	long* newPrevSiblings = realloc(transformPrevSiblings, newCapacity * sizeof(long));
+	if (newPrevSiblings == NULL) { blah_error_raise(errno, "Failed to grow transform hierarchy"); }
+	transformPrevSiblings = newPrevSiblings;
+	transformCapacity = newCapacity;
+}
+
+static void blah_transform_link(long node, long parent)
+{	//Sets the parent of the node, adding it to the front of the parent's children
+	transformParents[node] = parent;
+	transformPrevSiblings[node] = BLAH_TRANSFORM_NONE;
+	if (parent == BLAH_TRANSFORM_NONE) { //Root nodes are not linked to each other
+		transformNextSiblings[node] = BLAH_TRANSFORM_NONE;
+		return;
+	}
+	transformNextSiblings[node] = transformFirstChildren[parent];
+	if (transformFirstChildren[parent] != BLAH_TRANSFORM_NONE) { transformPrevSiblings[transformFirstChildren[parent]] = node; }
+	transformFirstChildren[parent] = node;
+}
+
+static void blah_transform_unlink(long node)
+{	//Removes the node from the children of its parent, leaving it a root node
+	const long parent = transformParents[node];
+	if (parent == BLAH_TRANSFORM_NONE) { return; }
+	if (transformPrevSiblings[node] != BLAH_TRANSFORM_NONE) {
+		transformNextSiblings[transformPrevSiblings[node]] = transformNextSiblings[node];
+	} else {
+		transformFirstChildren[parent] = transformNextSiblings[node];
+	}
+	if (transformNextSiblings[node] != BLAH_TRANSFORM_NONE) {
+		transformPrevSiblings[transformNextSiblings[node]] = transformPrevSiblings[node];
+	}
+	transformParents[node] = transformNextSiblings[node] = transformPrevSiblings[node] = BLAH_TRANSFORM_NONE;
+}
+
+static void blah_transform_buildOrder()
+{	//Sorts nodes by their depth in the hierarchy, so that every parent is visited before its children.
+	//Nodes of the same depth stay in index order, so that matrices are visited mostly in memory order.
+	size_t* depths = malloc(transformCount * sizeof(size_t));
+	size_t* starts;
+	size_t maxDepth = 0;
+
+	transformOrderDirty = false;
+	transformOrderLength = 0;
+	if (transformCount == 0) { free(depths); return; }
+	if (depths == NULL) { blah_error_raise(errno, "Failed to order transform hierarchy"); }
+	for (size_t node = 0; node < transformCount; node++) {
+		size_t depth = 0;
+		if (!(transformFlags[node] & BLAH_TRANSFORM_USED)) { continue; }
+		for (long parent = transformParents[node]; parent != BLAH_TRANSFORM_NONE; parent = transformParents[parent]) { depth++; }
+		depths[node] = depth;
+		if (depth > maxDepth) { maxDepth = depth; }
+	}
+	starts = calloc(maxDepth + 2, sizeof(size_t)); //Position in order of the first node of each depth
+	if (starts == NULL) { blah_error_raise(errno, "Failed to order transform hierarchy"); }
+	for (size_t node = 0; node < transformCount; node++) {
+		if (transformFlags[node] & BLAH_TRANSFORM_USED) { starts[depths[node] + 1]++; }
+	}
+	for (size_t depth = 1; depth <= maxDepth + 1; depth++) { starts[depth] += starts[depth - 1]; }
+	for (size_t node = 0; node < transformCount; node++) {
+		if (transformFlags[node] & BLAH_TRANSFORM_USED) { transformOrder[starts[depths[node]]++] = (long)node; }
+	}
+	transformOrderLength = starts[maxDepth];
+	free(starts);
+	free(depths);
+}
+
+/* Function Definitions */
+
+long blah_transform_add(long parent)
+{	//Adds a node with an identity local matrix as a child of parent, and returns its index
+	long node = transformFreeSlot;
+
+	if (node != BLAH_TRANSFORM_NONE) { //Reuse most recently removed slot
+		transformFreeSlot = transformParents[node];
+	} else {
+		if (transformCount == transformCapacity) { blah_transform_grow(); }
+		node = (long)transformCount++;
+	}
+	Blah_Matrix_setIdentity(&transformLocals[node]);
+	Blah_Matrix_setIdentity(&transformWorlds[node]);
+	transformFirstChildren[node] = BLAH_TRANSFORM_NONE;
+	blah_transform_link(node, parent);
+	transformFlags[node] = BLAH_TRANSFORM_USED | BLAH_TRANSFORM_DIRTY;
+	transformOrderDirty = true;
+	return node;
+}
+
+void blah_transform_destroyAll()
+{	//Releases all memory held by the hierarchy
+	free(transformLocals);
+	free(transformWorlds);
+	free(transformParents);
+	free(transformFlags);
+	free(transformOrder);
+	free(transformFirstChildren);
+	free(transformNextSiblings);
+	free(transformPrevSiblings);
+	transformLocals = transformWorlds = NULL;
+	transformParents = transformOrder = NULL;
+	transformFirstChildren = transformNextSiblings = transformPrevSiblings = NULL;
+	transformFlags = NULL;
+	transformCount = transformCapacity = transformOrderLength = 0;
+	transformOrderDirty = false;
+	transformFreeSlot = BLAH_TRANSFORM_NONE;
+}
+
+size_t blah_transform_getCount()
+{	//Returns the number of node slots, the length of the world matrix array
+	return transformCount;
+}
+
+long blah_transform_getParent(long node)
+{	//Returns the index of the parent of the node, or BLAH_TRANSFORM_NONE
+	return transformParents[node];
+}
+
+const Blah_Matrix *blah_transform_getWorld(long node)
+{	//Returns the world matrix of the node as at the last update
+	return &transformWorlds[node];
+}
+
+const Blah_Matrix *blah_transform_getWorldMatrices()
+{	//Returns the world matrices of all nodes, indexed by node
+	return transformWorlds;
+}
+
+void blah_transform_remove(long node)
+{	//Removes the node, making its children root nodes
+	if (node == BLAH_TRANSFORM_NONE || !(transformFlags[node] & BLAH_TRANSFORM_USED)) { return; }
+	while (transformFirstChildren[node] != BLAH_TRANSFORM_NONE) {
+		const long child = transformFirstChildren[node];
+		blah_transform_unlink(child);
+		transformFlags[child] |= BLAH_TRANSFORM_DIRTY;
+	}
+	blah_transform_unlink(node);
+	transformFlags[node] = 0;
+	transformParents[node] = transformFreeSlot;
+	transformFreeSlot = node;
+	transformOrderDirty = true;
+}
+
+bool blah_transform_setLocal(long node, const Blah_Matrix *local)
+{	//Sets the local matrix of the node, marking it for recalculation if it has changed
+	if (memcmp(&transformLocals[node], local, sizeof(Blah_Matrix)) == 0) { return false; }
+	transformLocals[node] = *local;
+	transformFlags[node] |= BLAH_TRANSFORM_DIRTY;
+	return true;
+}
+
+bool blah_transform_setParent(long node, long parent)
+{	//Makes the node a child of parent, unless that would make it its own ancestor
+	for (long ancestor = parent; ancestor != BLAH_TRANSFORM_NONE; ancestor = transformParents[ancestor]) {
+		if (ancestor == node) { return false; }
+	}
+	if (transformParents[node] != parent) {
+		blah_transform_unlink(node);
+		blah_transform_link(node, parent);
+		transformFlags[node] |= BLAH_TRANSFORM_DIRTY;
+		transformOrderDirty = true;
+	}
+	return true;
+}
+
+size_t blah_transform_update()
+{	//Recalculates the world matrices of changed nodes and their descendants, parents first
+	size_t updated = 0;
+
+	if (transformOrderDirty) { blah_transform_buildOrder(); }
+	for (size_t position = 0; position < transformOrderLength; position++) {
+		const long node = transformOrder[position];
+		const long parent = transformParents[node];
+		if ((transformFlags[node] & BLAH_TRANSFORM_DIRTY)
+			|| (parent != BLAH_TRANSFORM_NONE && (transformFlags[parent] & BLAH_TRANSFORM_UPDATED))) {
+			if (parent == BLAH_TRANSFORM_NONE) {
+				transformWorlds[node] = transformLocals[node];
+			} else {
+				blah_math_multiplyMatrices(&transformWorlds[node], &transformWorlds[parent], &transformLocals[node]);
+			}
+			transformFlags[node] = BLAH_TRANSFORM_USED | BLAH_TRANSFORM_UPDATED;
+			updated++;
+		} else {
+			transformFlags[node] = BLAH_TRANSFORM_USED;
+		}
+	}
+	return updated;
+}
@@ -0,0 +1,71 @@
+/* blah_transform.h
+	The transform hierarchy holds the matrices placing entities, and the objects composing them, in the
+	world.  Each node has a local matrix, relative to its parent node, and a world matrix, the product of
+	the local matrices of the node and all of its ancestors.  Nodes are kept flattened in arrays, with
+	the world matrices contiguous, indexed by node, so that they can be handed to the renderer together.
+	blah_transform_update recalculates world matrices once per frame, visiting parents before children,
+	and only for nodes whose local matrix has changed or whose parent's world matrix was recalculated,
+	so the matrices of still objects are not recalculated.  Blah_Scene_draw updates the hierarchy
+	before drawing.  Entities and entity objects are given nodes by Blah_Entity_updateTransform.
+	Nothing here depends on the drawing API, so the hierarchy can be used without a video mode. */
+
+#ifndef _BLAH_TRANSFORM
+
+#define _BLAH_TRANSFORM
+
+#include <stddef.h>
+
+#include "blah_matrix.h"
+#include "blah_types.h"
+
+/* Definitions */
+
+#define BLAH_TRANSFORM_NONE -1	//Node index meaning no node, such as the parent of a root node
+
+/* Function Prototypes */
+
+#ifdef __cplusplus
+	extern "C" {
+#endif //__cplusplus
+
+long blah_transform_add(long parent);
+	//Adds a node with an identity local matrix, as a child of the given node or as a root node if
+	//parent is BLAH_TRANSFORM_NONE, and returns its index.  Its world matrix is set at the next update.
+
+void blah_transform_destroyAll();
+	//Releases all memory held by the hierarchy.  Indices of nodes become invalid.
+
+size_t blah_transform_getCount();
+	//Returns the number of node slots, including those of removed nodes, which is the length of the
+	//array returned by blah_transform_getWorldMatrices
+
+long blah_transform_getParent(long node);
+	//Returns the index of the parent of the node, or BLAH_TRANSFORM_NONE if it is a root node
+
+const Blah_Matrix *blah_transform_getWorld(long node);
+	//Returns the world matrix of the node as at the last update.  The pointer is valid until a node is added.
+
+const Blah_Matrix *blah_transform_getWorldMatrices();
+	//Returns the world matrices of all nodes, indexed by node.  Slots of removed nodes hold stale
+	//matrices.  The pointer is valid until a node is added.
+
+void blah_transform_remove(long node);
+	//Removes the node.  Its children become root nodes, keeping their local matrices.
+
+bool blah_transform_setLocal(long node, const Blah_Matrix *local);
+	//Sets the local matrix of the node.  The node is only marked for recalculation if the matrix
+	//differs from its current one.  Returns true if it did.
+
+bool blah_transform_setParent(long node, long parent);
+	//Makes the node a child of parent, or a root node if parent is BLAH_TRANSFORM_NONE.
+	//Returns false, changing nothing, if parent is the node or one of its descendants.
+
+size_t blah_transform_update();
+	//Recalculates the world matrices of nodes whose local matrices, or the world matrices of whose
+	//ancestors, have changed since the last update.  Returns the number recalculated.
+
+#ifdef __cplusplus
+	}
+#endif //__cplusplus
+
+#endif
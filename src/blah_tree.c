@@ -7,29 +7,175 @@
 #include "blah_types.h"
 #include "blah_macros.h"
 #include "blah_util.h"
+#include "blah_error.h"
 
 /* Private internal functions */
 
-// static Blah_Tree_Element **Blah_Tree_Element_findPosition(Blah_Tree_Element **beginAddr, char *key);
-    // Returns address of pointer where element should be located in tree
+static unsigned long blah_tree_hashKey(const char *key) {
+	// Returns FNV-1a hash of key, limited to the characters stored in an element keystring
+	unsigned long hash = 2166136261UL;
+	for (int index = 0; index < BLAH_TREE_ELEMENT_NAME_LENGTH && key[index]; index++) {
+		hash = (hash ^ (unsigned char)key[index]) * 16777619UL;
+	}
+	return hash;
+}
 
-static void Blah_Tree_Element_recursiveCall(Blah_Tree_Element *element, blah_tree_element_func* function) {
-	// Recurse into left and right elements of parent element and
-	// call function for with data pointer for every element
-	if (element->left) {
-		Blah_Tree_Element_recursiveCall(element->left, function);
+static int Blah_Tree_Element_height(const Blah_Tree_Element *element) {
+	// Returns height of subtree rooted at element, 0 for an empty subtree
+	return element ? element->height : 0;
+}
+
+static void Blah_Tree_Element_updateHeight(Blah_Tree_Element *element) {
+	// Recalculates height of element from the heights of its children
+	const int leftHeight = Blah_Tree_Element_height(element->left);
+	const int rightHeight = Blah_Tree_Element_height(element->right);
+	element->height = (leftHeight > rightHeight ? leftHeight : rightHeight) + 1;
+}
+
+static Blah_Tree_Element *Blah_Tree_Element_rotateLeft(Blah_Tree_Element *element) {
+	// Rotates subtree left, making right child the new root.  Returns new root.
+	Blah_Tree_Element *newRoot = element->right;
+	element->right = newRoot->left;
+	newRoot->left = element;
+	Blah_Tree_Element_updateHeight(element);
+	Blah_Tree_Element_updateHeight(newRoot);
+	return newRoot;
+}
+
+static Blah_Tree_Element *Blah_Tree_Element_rotateRight(Blah_Tree_Element *element) {
+	// Rotates subtree right, making left child the new root.  Returns new root.
+	Blah_Tree_Element *newRoot = element->left;
+	element->left = newRoot->right;
+	newRoot->right = element;
+	Blah_Tree_Element_updateHeight(element);
+	Blah_Tree_Element_updateHeight(newRoot);
+	return newRoot;
+}
+
+static Blah_Tree_Element *Blah_Tree_Element_balance(Blah_Tree_Element *element) {
+	// Restores balance of subtree after an insertion or removal below element,
+	// where children differ in height by at most 2.  Returns new root of subtree.
+	const int balance = Blah_Tree_Element_height(element->left) - Blah_Tree_Element_height(element->right);
+
+	if (balance > 1) { // Left heavy
+		if (Blah_Tree_Element_height(element->left->left) < Blah_Tree_Element_height(element->left->right)) {
+			element->left = Blah_Tree_Element_rotateLeft(element->left);
+		}
+		return Blah_Tree_Element_rotateRight(element);
+	} else if (balance < -1) { // Right heavy
+		if (Blah_Tree_Element_height(element->right->right) < Blah_Tree_Element_height(element->right->left)) {
+			element->right = Blah_Tree_Element_rotateRight(element->right);
+		}
+		return Blah_Tree_Element_rotateLeft(element);
+	}
+	Blah_Tree_Element_updateHeight(element);
+	return element;
+}
+
+static Blah_Tree_Element *Blah_Tree_Element_insert(Blah_Tree_Element *element, Blah_Tree_Element *newElement, bool *inserted) {
+	// Inserts newElement into subtree rooted at element, unless an element with the same key
+	// already exists.  Sets *inserted accordingly and returns new root of subtree.
+	if (!element) {
+		*inserted = true;
+		return newElement;
+	}
+	const int stringComp = strcmp(newElement->keystring, element->keystring);
+	if (!stringComp) { // key already present
+		*inserted = false;
+		return element;
+	} else if (stringComp < 0) {
+		element->left = Blah_Tree_Element_insert(element->left, newElement, inserted);
 	} else {
-		Blah_Tree_Element_callFunction(element, function);
-		if (element->right) { Blah_Tree_Element_recursiveCall(element->right, function); }
+		element->right = Blah_Tree_Element_insert(element->right, newElement, inserted);
+	}
+	return *inserted ? Blah_Tree_Element_balance(element) : element;
+}
+
+static Blah_Tree_Element *Blah_Tree_Element_removeLeftmost(Blah_Tree_Element *element, Blah_Tree_Element **leftmost) {
+	// Unlinks the leftmost element of subtree into *leftmost.  Returns new root of subtree.
+	if (!element->left) {
+		*leftmost = element;
+		return element->right;
+	}
+	element->left = Blah_Tree_Element_removeLeftmost(element->left, leftmost);
+	return Blah_Tree_Element_balance(element);
+}
+
+static Blah_Tree_Element *Blah_Tree_Element_remove(Blah_Tree_Element *element, const char *key, Blah_Tree_Element **removed) {
+	// Unlinks element with given key from subtree into *removed, which is left unchanged if
+	// there is no such element.  Returns new root of subtree.
+	if (!element) { return NULL; }
+
+	const int stringComp = strcmp(key, element->keystring);
+	if (stringComp < 0) {
+		element->left = Blah_Tree_Element_remove(element->left, key, removed);
+	} else if (stringComp > 0) {
+		element->right = Blah_Tree_Element_remove(element->right, key, removed);
+	} else { // Found element to remove
+		Blah_Tree_Element *successor;
+		*removed = element;
+		if (!element->left) { return element->right; }
+		if (!element->right) { return element->left; }
+		// Replace with the next element in sort order, taken from right subtree
+		element->right = Blah_Tree_Element_removeLeftmost(element->right, &successor);
+		successor->left = element->left;
+		successor->right = element->right;
+		return Blah_Tree_Element_balance(successor);
 	}
+	return *removed ? Blah_Tree_Element_balance(element) : element;
+}
+
+static void Blah_Tree_hashInsert(Blah_Tree *tree, Blah_Tree_Element *element) {
+	// Adds element to the hash index of the tree
+	Blah_Tree_Element **bucket = &tree->hashBuckets[element->keyHash & (tree->hashSize - 1)];
+	element->hashNext = *bucket;
+	*bucket = element;
+}
+
+static void Blah_Tree_Element_rehash(Blah_Tree *tree, Blah_Tree_Element *element) {
+	// Adds all elements of subtree to the hash index of the tree
+	if (element) {
+		Blah_Tree_Element_rehash(tree, element->left);
+		Blah_Tree_hashInsert(tree, element);
+		Blah_Tree_Element_rehash(tree, element->right);
+	}
+}
+
+static void Blah_Tree_hashResize(Blah_Tree *tree, unsigned int hashSize) {
+	// Reallocates hash index with given number of buckets and re-indexes all elements
+	Blah_Tree_Element **newBuckets = calloc(hashSize, sizeof(Blah_Tree_Element*));
+
+	if (!newBuckets) {
+		blah_error_raise(errno, "Failed to allocate hash index of %u buckets for tree '%s'", hashSize, tree->name);
+	}
+	free(tree->hashBuckets);
+	tree->hashBuckets = newBuckets;
+	tree->hashSize = hashSize;
+	Blah_Tree_Element_rehash(tree, tree->first);
+}
+
+static void Blah_Tree_hashRemove(Blah_Tree *tree, Blah_Tree_Element *element) {
+	// Removes element from the hash index of the tree
+	Blah_Tree_Element **link = &tree->hashBuckets[element->keyHash & (tree->hashSize - 1)];
+
+	while (*link != element) { link = &(*link)->hashNext; }
+	*link = element->hashNext;
+}
+
+static void Blah_Tree_Element_recursiveCall(Blah_Tree_Element *element, blah_tree_element_func* function) {
+	// Recurse into left and right elements of parent element and
+	// call function for with data pointer for every element, in sort order
+	if (element->left) { Blah_Tree_Element_recursiveCall(element->left, function); }
+	Blah_Tree_Element_callFunction(element, function);
+	if (element->right) { Blah_Tree_Element_recursiveCall(element->right, function); }
 }
 
 static void Blah_Tree_Element_recursiveCallWithArg(Blah_Tree_Element* element, blah_tree_element_func_1arg* function, void* arg) {
 	// Recurse into left and right elements of parent element and
-	// call function for with data pointer for every element with single argument 'arg'
+	// call function for with data pointer for every element with single argument 'arg', in sort order
 	if (element->left) { Blah_Tree_Element_recursiveCallWithArg(element->left, function, arg); } // call for left if valid
-	if (element->right) { Blah_Tree_Element_recursiveCallWithArg(element->right, function, arg); } // call for right if valid
 	Blah_Tree_Element_callWithArg(element, function, arg);
+	if (element->right) { Blah_Tree_Element_recursiveCallWithArg(element->right, function, arg); } // call for right if valid
 }
 
 static void Blah_Tree_Element_recursiveRemove(Blah_Tree_Element *element) {
@@ -55,40 +201,17 @@ static void Blah_Tree_Element_recursiveDestroy(Blah_Tree_Element *element, blah_
 Blah_Tree_Element *Blah_Tree_Element_new(const char* key, void *data) {
 	//Creates a new tree element
 	Blah_Tree_Element *newElement = malloc(sizeof(Blah_Tree_Element));
-	newElement->left = newElement->right = NULL;
+
+	if (!newElement) { blah_error_raise(errno, "Failed to allocate tree element '%s'", key); }
+	newElement->left = newElement->right = newElement->hashNext = NULL;
 	blah_util_strncpy(newElement->keystring, key, BLAH_TREE_ELEMENT_NAME_LENGTH);
 	newElement->data = data;
+	newElement->height = 1;
+	newElement->keyHash = blah_tree_hashKey(newElement->keystring);
 
 	return newElement;
 }
 
-static Blah_Tree_Element **Blah_Tree_Element_findPosition(Blah_Tree_Element **beginAddr, const char *key) {
-	//Returns address of pointer where element should be located in tree
-	Blah_Tree_Element *tempElement = *(Blah_Tree_Element **)beginAddr;
-	Blah_Tree_Element **positionAddr = beginAddr;
-	bool found = false;
-	int stringComp;
-
-	while (tempElement && !found) {
-		stringComp = strcmp(key, tempElement->keystring);
-		if (!stringComp) { //check if key strings match
-			found = true;  //set found flag to true
-		}
-		else {
-			if (stringComp < 0) { //if element should go left of current element
-				positionAddr = &tempElement->left;
-				tempElement = tempElement->left; //navigate left
-			} else {
-				positionAddr = &tempElement->right;
-				tempElement = tempElement->right; //navigate right
-			}
-		}
-	}
-
-	return positionAddr;
-}
-
-
 void Blah_Tree_Element_callFunction(Blah_Tree_Element* element, blah_tree_element_func* function) {
 	//call function with data pointer of element
 	function(element->data);
@@ -110,17 +233,12 @@ void* Blah_Tree_Element_search(Blah_Tree_Element *treeElement, blah_tree_search_
 	//element's data as the argument and 'arg' as a second argument.  Returns the data
 	//pointer of the first element for which search_function returns true, or
 	//NULL if no match;
-	if (treeElement->left) {
-		return Blah_Tree_Element_search(treeElement->left, searchFunction, arg);
-	} else {
-		if (Blah_Tree_Element_callArgReturnBool(treeElement, searchFunction, arg)) {
-			return treeElement->data;
-		} else if (treeElement->right) {
-			return Blah_Tree_Element_search(treeElement->right, searchFunction, arg);
-		} else {
-			return NULL;
-		}
-	}
+	void *match = NULL;
+
+	if (treeElement->left) { match = Blah_Tree_Element_search(treeElement->left, searchFunction, arg); }
+	if (!match && Blah_Tree_Element_callArgReturnBool(treeElement, searchFunction, arg)) { match = treeElement->data; }
+	if (!match && treeElement->right) { match = Blah_Tree_Element_search(treeElement->right, searchFunction, arg); }
+	return match;
 }
 
 
@@ -131,19 +249,58 @@ void Blah_Tree_init(Blah_Tree *tree, const char *name) {
 	tree->count=0;
 	blah_util_strncpy(tree->name, name, BLAH_TREE_NAME_LENGTH);  //set name property
 	tree->destroyElementFunction = NULL;
+	tree->hashIndex = false;
+	tree->hashBuckets = NULL;
+	tree->hashSize = 0;
+}
+
+void Blah_Tree_disable(Blah_Tree *tree) {
+	//Removes all elements and frees the hash index.  Does not free data
+	Blah_Tree_removeAll(tree);
+	free(tree->hashBuckets);
+	tree->hashBuckets = NULL;
+	tree->hashSize = 0;
+}
+
+void Blah_Tree_setHashIndex(Blah_Tree *tree, bool hashIndex) {
+	//Enables or disables indexing of the tree elements by key hash
+	tree->hashIndex = hashIndex;
+	if (hashIndex && tree->first) { // Index existing elements
+		unsigned int hashSize = BLAH_TREE_HASH_INITIAL_SIZE;
+		while (hashSize < tree->count) { hashSize *= 2; }
+		Blah_Tree_hashResize(tree, hashSize);
+	} else if (!hashIndex) {
+		free(tree->hashBuckets);
+		tree->hashBuckets = NULL;
+		tree->hashSize = 0;
+	}
 }
 
 Blah_Tree *Blah_Tree_new(char *name) { //Creates a new empty tree given name
 	Blah_Tree *newTree = malloc(sizeof(Blah_Tree));
-	Blah_Tree_init(newTree, name);
+	if (newTree != NULL) { Blah_Tree_init(newTree, name); }
 	return newTree;
 }
 
 Blah_Tree_Element *Blah_Tree_findElement(Blah_Tree *tree, const char *key) {
 	// finds and returns a pointer to the element structure holding data pointer
 	// or NULL if no element found with matching key string
-	Blah_Tree_Element **elementPtrAddr = Blah_Tree_Element_findPosition(&tree->first, key);
-	return *elementPtrAddr;
+	Blah_Tree_Element *element;
+
+	if (tree->hashBuckets) { // Look up in hash index, comparing precomputed hashes before keys
+		const unsigned long keyHash = blah_tree_hashKey(key);
+		element = tree->hashBuckets[keyHash & (tree->hashSize - 1)];
+		while (element && (element->keyHash != keyHash || strcmp(key, element->keystring))) {
+			element = element->hashNext;
+		}
+	} else { // Binary search of tree
+		int stringComp;
+		element = tree->first;
+		while (element && (stringComp = strcmp(key, element->keystring))) {
+			element = stringComp < 0 ? element->left : element->right;
+		}
+	}
+	return element;
 }
 
 void* Blah_Tree_search(Blah_Tree *tree, blah_tree_search_func* searchFunction, void *arg) {
@@ -152,29 +309,18 @@ void* Blah_Tree_search(Blah_Tree *tree, blah_tree_search_func* searchFunction, v
 	// for which search_function returns true, or NULL if no match;
 
 	/* Simply return value from recursive element search function */
-	return Blah_Tree_Element_search(tree->first, searchFunction, arg);
+	return tree->first ? Blah_Tree_Element_search(tree->first, searchFunction, arg) : NULL;
 }
 
 
 bool Blah_Tree_removeElement(Blah_Tree *tree, const char* key) {
 	//remove given tree element from tree.  Does not destroy data
-	Blah_Tree_Element **elementPtrAddr;
-	Blah_Tree_Element *removeMe;
-	Blah_Tree_Element **newPtrAddr;
-
-	elementPtrAddr = Blah_Tree_Element_findPosition(&tree->first, key);
-	removeMe = *elementPtrAddr;
+	Blah_Tree_Element *removeMe = NULL;
 
+	tree->first = Blah_Tree_Element_remove(tree->first, key, &removeMe);
 	if (removeMe) { // if a matching element was found
-		if (!removeMe->left) { // if there is no left element attached
-			*elementPtrAddr = removeMe->right; // link parent with right element
-		} else if (!removeMe->right) { // if there is no right element
-			*elementPtrAddr = removeMe->left; // link parent with left element
-		} else { // deal with both elements
-			*elementPtrAddr = removeMe->left; // link parent with left element
-			newPtrAddr = Blah_Tree_Element_findPosition(elementPtrAddr, removeMe->right->keystring);
-			*newPtrAddr = removeMe->right;	// Insert right element at appropriate position
-		}
+		if (tree->hashBuckets) { Blah_Tree_hashRemove(tree, removeMe); }
+		free(removeMe);
 		tree->count--;
 		return true;
 	} else {
@@ -184,7 +330,8 @@ bool Blah_Tree_removeElement(Blah_Tree *tree, const char* key) {
 
 void Blah_Tree_removeAll(Blah_Tree *tree) {
 	//removes all elements but retains empty tree structure.  Does not free data
-	Blah_Tree_Element_recursiveRemove(tree->first); //call free on all element pointers
+	if (tree->first) { Blah_Tree_Element_recursiveRemove(tree->first); } //call free on all element pointers
+	if (tree->hashBuckets) { memset(tree->hashBuckets, 0, tree->hashSize * sizeof(Blah_Tree_Element*)); }
 	tree->first = NULL;
 	tree->count = 0;
 }
@@ -194,15 +341,20 @@ void Blah_Tree_destroyElements(Blah_Tree *tree) {
 	if (tree->first) {
 		blah_tree_element_dest_func* destFunc = tree->destroyElementFunction ? tree->destroyElementFunction : free;
 		//If there is a valid destory function, we will use it, else we will just use free()
-		Blah_Tree_Element_recursiveDestroy(tree->first, destFunc); //call free on all element pointers
+		Blah_Tree_Element *root = tree->first;
+		//Detach elements first, so that destroy functions removing their own data from the tree
+		//(e.g. Blah_Font_destroy) will not find them
 		tree->first = NULL;
 		tree->count = 0;
+		if (tree->hashBuckets) { memset(tree->hashBuckets, 0, tree->hashSize * sizeof(Blah_Tree_Element*)); }
+		Blah_Tree_Element_recursiveDestroy(root, destFunc); //call free on all element pointers
 	}
 }
 
 void Blah_Tree_destroy(Blah_Tree *tree) {
 	//clears all memory allocated for elements, tree header and contained data
 	Blah_Tree_destroyElements(tree);	//remove all elements and data
+	free(tree->hashBuckets);
 	free(tree);	//clear the tree itself
 }
 
@@ -210,22 +362,33 @@ bool Blah_Tree_insertElement(Blah_Tree *tree, const char* key, void *data) {
 	// inserts a new element with given key and data pointer
 	// Returns TRUE on success, or FALSE if an element with same key already exists
 
-	Blah_Tree_Element **newPtrAddr = Blah_Tree_Element_findPosition(&tree->first, key);
-	if (*newPtrAddr) { // If search found existing element,
+	Blah_Tree_Element *newElement = Blah_Tree_Element_new(key, data);
+	bool inserted = false;
+
+	tree->first = Blah_Tree_Element_insert(tree->first, newElement, &inserted);
+	if (!inserted) { // If search found existing element,
+		free(newElement);
 		return false;
-	} else {
-		*newPtrAddr = Blah_Tree_Element_new(key, data);
-		tree->count++;  // Create new tree element structure and insert into pointer
-		return true;
 	}
+	tree->count++;
+	if (tree->hashIndex) { // Add to hash index, growing it to keep about one element per bucket
+		if (!tree->hashBuckets) {
+			Blah_Tree_hashResize(tree, BLAH_TREE_HASH_INITIAL_SIZE); // indexes the new element too
+		} else if (tree->count > tree->hashSize) {
+			Blah_Tree_hashResize(tree, tree->hashSize * 2);
+		} else {
+			Blah_Tree_hashInsert(tree, newElement);
+		}
+	}
+	return true;
 }
 
 
 void Blah_Tree_callFunction(Blah_Tree* tree, blah_tree_element_func* function) {
 	// call function for with data pointer for every element
-	Blah_Tree_Element_recursiveCall(tree->first, function);
+	if (tree->first) { Blah_Tree_Element_recursiveCall(tree->first, function); }
 }
 
 void Blah_Tree_callWithArg(Blah_Tree* tree, blah_tree_element_func_1arg* function, void* arg) {
-	Blah_Tree_Element_recursiveCallWithArg(tree->first, function, arg);
+	if (tree->first) { Blah_Tree_Element_recursiveCallWithArg(tree->first, function, arg); }
 }
@@ -1,11 +1,16 @@
 /* blah_tree.h - Implements a binary tree structure.
-	Tree structure maintains the pointer to the first Blah_Tree_Element structure */
+	Tree structure maintains the pointer to the first Blah_Tree_Element structure.
+	The tree is kept height balanced (AVL) on insertion and removal, so keys inserted in sorted
+	order, as happens when resources are loaded alphabetically, do not degrade it into a list.
+	Trees with the hashIndex flag set also index their elements in a hash table of precomputed key
+	hashes, making Blah_Tree_findElement constant time while traversal stays in key order. */
 #ifndef _BLAH_TREE
 
 #define _BLAH_TREE
 
 #define BLAH_TREE_NAME_LENGTH	20  //number of characters allowed for name property
 #define BLAH_TREE_ELEMENT_NAME_LENGTH	50
+#define BLAH_TREE_HASH_INITIAL_SIZE	64	//number of hash buckets allocated on first insertion into a hashed tree
 
 #include "blah_types.h"
 
@@ -46,6 +51,9 @@ typedef struct Blah_Tree_Element {
 	struct Blah_Tree_Element *left;	//pointer to left element
 	struct Blah_Tree_Element *right;	//pointer to right element
 	void *data;					//pointer to element data
+	int height;					//height of subtree rooted at this element, 1 for a leaf
+	unsigned long keyHash;		//hash of keystring
+	struct Blah_Tree_Element *hashNext;	//next element in same hash bucket
 } Blah_Tree_Element;
 
 typedef struct Blah_Tree {
@@ -53,6 +61,9 @@ typedef struct Blah_Tree {
 	Blah_Tree_Element* first;		//pointer to first element in tree
 	blah_tree_element_dest_func* destroyElementFunction; //custom function to destroy element data
 	unsigned int count;					//number of elements in the tree
+	bool hashIndex;						//If true, elements are also indexed by key hash for fast finds
+	Blah_Tree_Element** hashBuckets;	//hash table of elements, allocated on first insertion
+	unsigned int hashSize;				//number of hash buckets, always a power of 2
 } Blah_Tree;
 
 /* Element Function Prototypes */
@@ -104,8 +115,15 @@ void Blah_Tree_callWithArg(Blah_Tree* tree, blah_tree_element_func_1arg* functio
 void Blah_Tree_init(Blah_Tree* tree, const char* name);
 	// Function Blah_Tree_init_function: Sets the name of the tree, and first element pointer to NULL
 
+void Blah_Tree_disable(Blah_Tree* tree);
+	// Removes all elements and frees the hash index.  Does not free data
+
+void Blah_Tree_setHashIndex(Blah_Tree* tree, bool hashIndex);
+	// Enables or disables indexing of the tree elements by key hash.  When enabled,
+	// Blah_Tree_findElement takes constant time rather than time logarithmic in the tree size.
+
 Blah_Tree_Element* Blah_Tree_findElement(Blah_Tree* tree, const char* key);
-	//Function Blah_Tree_find_element: Finds tree element with given key */
+	//Function Blah_Tree_find_element: Finds tree element with given key, or NULL if not found
 
 void* Blah_Tree_search(Blah_Tree* tree, blah_tree_search_func* searchFunction, void* arg);
 	// Calls search_function for each element of the tree in sort order, using the
@@ -118,7 +136,9 @@ void Blah_Tree_destroy(Blah_Tree *tree);
 	// Clears all memory occupied by tree and elements
 
 void Blah_Tree_destroyElements(Blah_Tree *tree);
-	// clears all memory allocated for elements and data but does not destroy basic tree header
+	// clears all memory allocated for elements and data but does not destroy basic tree header.
+	// Elements are detached before data is destroyed, so destroy functions may attempt to remove
+	// their own data from the tree.
 
 void Blah_Tree_removeAll(Blah_Tree *tree);
 	// removes all elements but retains empty tree structure.  Does not free data
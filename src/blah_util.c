@@ -2,6 +2,9 @@
 
 #include <stdlib.h>
 #include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "blah_util.h"
 #include "blah_types.h"
@@ -26,6 +29,28 @@ void blah_util_byteSwap(void *byteArray, int numBytes) {
 		(unsigned char*)byte_array) */
 }
 
+void blah_util_byteSwap32Array(void *dest, const void *source, size_t count) {
+	//Copies 'count' 32bit values from source to dest, reversing the byte order of each
+	const unsigned char *from = source;
+	unsigned char *to = dest;
+	size_t index = 0;
+
+#ifdef __SSE2__
+	for (; index + 4 <= count; index += 4) { //Four values at a time
+		__m128i values = _mm_loadu_si128((const __m128i*)(from + index * 4));
+		values = _mm_or_si128(_mm_slli_epi16(values, 8), _mm_srli_epi16(values, 8)); //Swap bytes of each 16bit half
+		values = _mm_shufflelo_epi16(values, _MM_SHUFFLE(2,3,0,1)); //Then swap the halves
+		values = _mm_shufflehi_epi16(values, _MM_SHUFFLE(2,3,0,1));
+		_mm_storeu_si128((__m128i*)(to + index * 4), values);
+	}
+#endif
+	for (; index < count; index++) {
+		const unsigned char *value = from + index * 4;
+		const unsigned char byte0 = value[0], byte1 = value[1], byte2 = value[2], byte3 = value[3];
+		to[index * 4] = byte3; to[index * 4 + 1] = byte2; to[index * 4 + 2] = byte1; to[index * 4 + 3] = byte0;
+	}
+}
+
 int blah_util_byteSwapInt(int swapMe) {
 	//Returns the given integer with byte order reversed
 	int tempInt = swapMe;
@@ -64,6 +89,22 @@ unsigned int blah_util_ceilPowerOf2(unsigned int num) {
 	return powOf2;
 }
 
+uint64_t blah_util_hash64(const void *data, size_t length) {
+	//Returns an FNV-1a style hash of the data, mixing in 64bit words rather than single bytes
+	//so that hashing large files costs little next to reading them
+	const unsigned char *bytes = data;
+	uint64_t hash = UINT64_C(14695981039346656037), word;
+	size_t index = 0;
+
+	for (; index + sizeof(word) <= length; index += sizeof(word)) {
+		memcpy(&word, bytes + index, sizeof(word)); //Data need not be aligned
+		hash = (hash ^ word) * UINT64_C(1099511628211);
+		hash ^= hash >> 32; //Fold high bits down, since multiplication only carries upwards
+	}
+	for (; index < length; index++) { hash = (hash ^ bytes[index]) * UINT64_C(1099511628211); }
+	return hash ^ (uint64_t)length;
+}
+
 int blah_util_randRangeInt(int min, int max) { //returns a random integer in the range of min..max
 	int range, result;
 
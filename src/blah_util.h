@@ -6,6 +6,8 @@
 
 #define _BLAH_UTIL
 
+#include <stddef.h>
+
 #include "blah_types.h"
 
 /* Function Prototypes */
@@ -20,6 +22,10 @@ int blah_util_randRangeInt(int min, int max);
 void blah_util_byteSwap(void *byteArray, int numBytes);
 	//Swaps an array num_bytes in memory, at address byte_array
 
+void blah_util_byteSwap32Array(void *dest, const void *source, size_t count);
+	//Copies 'count' 32bit values from source to dest, reversing the byte order of each.
+	//Source and dest may be the same but must not otherwise overlap.  Neither need be aligned.
+
 int blah_util_byteSwapInt(int swapMe);
 	//Returns the given integer with byte order reversed
 
@@ -36,6 +42,10 @@ unsigned int blah_util_ceilPowerOf2(unsigned int num);
 	//Returns an integer which is a power of 2 and equal or greater than given
 	//integer 'num'
 
+uint64_t blah_util_hash64(const void *data, size_t length);
+	//Returns a 64bit hash of 'length' bytes at 'data', suitable for detecting changed contents.
+	//Words are read in host byte order, so hashes differ between little and big endian machines.
+
 char *blah_util_strncpy(char *to, const char* from, size_t count);
 	//Behaves like standard C strncpy, but always appends an extra NULL char in addition
 	//to the size_t count bytes.  Therefore, if the source contains atleast (count) bytes,
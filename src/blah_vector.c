@@ -5,6 +5,7 @@
 
 #include "blah_vector.h"
 #include "blah_matrix.h"
+#include "blah_math.h"
 
 Blah_Vector *Blah_Vector_new(float x, float y, float z) { //Creates new vector struct and returns pointer
 	Blah_Vector *newVector = (Blah_Vector*)malloc(sizeof(Blah_Vector));
@@ -37,21 +38,8 @@ void Blah_Vector_scale(Blah_Vector *vector, float scaleFactor) {
 }	
 	
 void Blah_Vector_multiplyMatrix(Blah_Vector *vector, Blah_Matrix *matrix) { //Multiplys a vector by a given matrix
-	int resultCell, matrixCell, count;
-	float result[3]={0,0,0};
-	
-	for (resultCell=0;resultCell<3;resultCell++) {
-		//result[result_cell] = 0;
-		matrixCell=resultCell & 3;	//result_cell mod 4
-		
-		for (count=0;count<3;count++) {
-			result[resultCell] += ((float*)vector)[count] * ((float*)matrix)[matrixCell];
-			matrixCell+=4;
-		} //sum products of v * m
-		result[resultCell] += ((float*)matrix)[matrixCell];
-	}
-	
-	memcpy(vector, result, sizeof(float)*3); //copy result data into vector
+	//Includes the matrix translation, as a point would.  Use Blah_Matrix_transformVectors for directions.
+	blah_math_transformPoint((Blah_Point*)vector, (const Blah_Point*)vector, matrix);
 }
 
 void Blah_Vector_sprintf(char *dest, Blah_Vector *vector) {
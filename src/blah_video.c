@@ -17,6 +17,7 @@
 #include "blah_entity.h"
 #include "blah_list.h"
 #include "blah_debug.h"
+#include "blah_profile.h"
 #include "blah_util.h"
 
 /* Globals Variables */
@@ -30,7 +31,8 @@ Blah_Video_API blah_video_SDL = {
     .setFullScreenFunction = blah_video_sdl_setFullScreen,
     .updateBufferFunction = blah_video_sdl_updateBuffer,
 	.setDoubleBufferedFunction = blah_video_sdl_setDoubleBuffered,
-	.setModeFunction = blah_video_sdl_setMode
+	.setModeFunction = blah_video_sdl_setMode,
+	.getProcAddressFunction = blah_video_sdl_getProcAddress
 };
 
 const Blah_Video_Mode *blah_video_currentMode = NULL;	// A pointer to the current mode being used
@@ -63,6 +65,18 @@ static int blah_video_modeCompare(const Blah_Video_Mode* mode1, const Blah_Video
 	return 0; //modes are identical as far as resolution and colour depth
 }
 
+// Stores the list element of each available mode in the mode, for stepping to neighbouring modes
+static void blah_video_linkModes() {
+	for (Blah_List_Element* element = blah_video_modes.first; element; element = element->next) {
+		((Blah_Video_Mode*)element->data)->listElement = element;
+	}
+}
+
+// Returns the list element holding the given mode
+static const Blah_List_Element* blah_video_findModeElement(const Blah_Video_Mode* mode) {
+	return mode->listElement ? mode->listElement : Blah_List_findElement(&blah_video_modes, mode);
+}
+
 // Returns true if the video mode name matches the given name to search
 static bool blah_video_modeSearch(const Blah_Video_Mode* mode, const char* modeName) {
 	return !strcmp(mode->name, modeName) ? true : false;
@@ -88,6 +102,7 @@ bool blah_video_init() {
 	} else if (blah_video_currentAPI->initFunction(&blah_video_settings) ) { // Call current API init
         // Sort video modes list
         Blah_List_sort(&blah_video_modes, (blah_list_sort_func*)blah_video_modeCompare);
+        blah_video_linkModes();
         blah_video_settings.initialised = true;
         Blah_Debug_Log_message(&blah_video_log, "blah_video_init() successful.");
         return true;
@@ -97,11 +112,13 @@ bool blah_video_init() {
 }
 
 void blah_video_main() { // Handles video buffer swapping and drawing
+	BLAH_PROFILE_BEGIN("blah_video_main");
     blah_video_clearBuffer(); // Clear the video to begin new frame
 	blah_draw_main();	// Call the main drawing routine to set perspective and draw
 						// all objects and entities with automated drawing.
 	blah_video_updateBuffer(); //Update all the changes from the drawing buffer to video memory for new frame
 	if (blah_video_currentMode->doubleBuffered) { blah_video_swapBuffers(); } // If double buffering enabled, swap buffers
+	BLAH_PROFILE_END();
 }
 
 // Exit video engine component if appropriate
@@ -173,6 +190,12 @@ bool blah_video_setMode(const Blah_Video_Mode* mode) {
 	}
 }
 
+void *blah_video_getProcAddress(const char* name) {
+	//Returns the address of the named OpenGL function of the current context, or NULL if not found
+	if (!blah_video_currentAPI->getProcAddressFunction) { return NULL; }
+	return blah_video_currentAPI->getProcAddressFunction(name);
+}
+
 const Blah_Video_Mode* blah_video_getCurrentMode() {
 	//Returns a pointer to the video mode structure representing the current mode
 	return blah_video_currentMode;
@@ -213,7 +236,7 @@ const Blah_Video_Mode *blah_video_getNextMode(const Blah_Video_Mode *mode) {
 	// colour depth.  Returns a pointer to the new mode found or NULL if there is no
 	// higher resolution mode available with requested colour depth;
 	const Blah_Video_Mode *nextMode = NULL;
-	const Blah_List_Element* const modeElement = Blah_List_findElement(&blah_video_modes, mode);
+	const Blah_List_Element* const modeElement = blah_video_findModeElement(mode);
 	const Blah_List_Element* const nextElement = modeElement->next;
 	if (nextElement != NULL) { //If there is a next mode in the list, continue
 		const Blah_Video_Mode* const peekMode = (Blah_Video_Mode*)nextElement->data;
@@ -226,7 +249,7 @@ const Blah_Video_Mode *blah_video_getPrevMode(const Blah_Video_Mode* mode) {
 	//Searches for a lower resolution mode than the given mode, using the same
 	//colour depth.  Returns a pointer to the new mode found or NULL if there is no
 	//lower resolution mode available with requested colour depth;
-	const Blah_List_Element *modeElement = Blah_List_findElement(&blah_video_modes, mode);
+	const Blah_List_Element *modeElement = blah_video_findModeElement(mode);
 	const Blah_List_Element *prevElement = modeElement->prev;
 
 	if (prevElement) { //If there is a prev mode in the list, continue
@@ -263,6 +286,7 @@ Blah_Video_Mode* Blah_Video_Mode_new(char *name, bool fullScreen,
 	newMode->height = height;
 	newMode->colourDepth = bppDepth;
 	newMode->doubleBuffered = doubleBuffered;
+	newMode->listElement = NULL; //Linked once the list of available modes is sorted
 
 	return newMode;
 }
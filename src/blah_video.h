@@ -45,6 +45,9 @@ typedef void blah_video_api_db_func(bool fullFlag);
 typedef bool blah_video_api_mode_func(const Blah_Video_Mode* mode);
 	//This type of function is called to change the mode of the video subsystem
 
+typedef void *blah_video_api_proc_func(const char* name);
+	//This type of function is called to find an OpenGL function of the current context by name
+
 /* Data Structures */
 
 typedef struct Blah_Video_API { //Defines functions to use with a specific API
@@ -57,6 +60,7 @@ typedef struct Blah_Video_API { //Defines functions to use with a specific API
 	blah_video_api_update_func* updateBufferFunction;
 	blah_video_api_db_func* setDoubleBufferedFunction;
 	blah_video_api_mode_func* setModeFunction;
+	blah_video_api_proc_func* getProcAddressFunction;
 } Blah_Video_API;
 
 typedef struct Blah_Video_Settings { //Stores all current configuration settings for video
@@ -70,6 +74,7 @@ typedef struct Blah_Video_Mode { 	//Represents a physical display video mode
 	unsigned int width;  			//Width of video mode in pixels
 	unsigned int height; 			//Height of video mode in pixels
 	unsigned int colourDepth;		//Pixel colour depth, in bits per pixel windowed
+	Blah_List_Element* listElement;	//Element of the list of available modes, NULL if not listed
 } Blah_Video_Mode;
 
 /* Video Function Prototypes */
@@ -109,6 +114,10 @@ bool blah_video_isDoubleBuffered();
 bool blah_video_setMode(const Blah_Video_Mode* mode);
 	// Sets the display device to the given mode.  Returns TRUE upon success, else false
 
+void *blah_video_getProcAddress(const char* name);
+	// Returns the address of the named OpenGL function of the current context, or NULL if it has none
+	// or the video API cannot look functions up.  Used for functions added after OpenGL 1.1.
+
 const Blah_Video_Mode *blah_video_getCurrentMode();
 	// Returns a pointer to the video mode structure representing the current mode
 
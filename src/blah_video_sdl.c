@@ -161,3 +161,8 @@ bool blah_video_sdl_setMode(const Blah_Video_Mode* mode) {
 		return false;
 	}
 }
+
+void *blah_video_sdl_getProcAddress(const char *name) {
+	//Looks the function up through SDL, which knows the OpenGL library of the context
+	return SDL_GL_GetProcAddress(name);
+}
@@ -33,6 +33,9 @@ void blah_video_sdl_updateBuffer();
 bool blah_video_sdl_setMode(const Blah_Video_Mode *mode);
 	//Use SDL libraries to set display device in given mode
 
+void *blah_video_sdl_getProcAddress(const char *name);
+	//Returns the address of the named OpenGL function, or NULL if the context has none
+
 #ifdef __cplusplus
 	}
 #endif //__cplusplus
@@ -0,0 +1,16 @@
+/* test_compat.c
+	Functions the engine takes from the platform which some platforms lack, so that the tests and
+	benchmarks link anywhere they can be built. */
+
+#include <stddef.h>
+#include <string.h>
+
+#ifndef _WIN32
+int strerror_s(char *buffer, size_t bufferSize, int errorCode)
+{	//Copies the description of errorCode into buffer, as the Windows function does
+	if (buffer == NULL || bufferSize == 0) { return 1; }
+	strncpy(buffer, strerror(errorCode), bufferSize - 1);
+	buffer[bufferSize - 1] = '\0';
+	return 0;
+}
+#endif //_WIN32
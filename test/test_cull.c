@@ -0,0 +1,224 @@
+/* test_cull.c
+	Checks view culling of blah_draw_isObjectVisible against a brute force reference, for boxes placed
+	at random, turned and scaled, under random viewing parameters.  The reference transforms a grid
+	of points over each box's surface into eye coordinates in double precision, from the viewing
+	parameters alone, and a box with any point inside the viewing volume must not be culled.  No
+	drawing context is made, so the OpenGL calls made while setting the perspective do nothing.
+	Returns nonzero if any check fails. */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blah_draw.h"
+#include "blah_material.h"
+#include "blah_object.h"
+#include "blah_primitive.h"
+#include "blah_video.h"
+
+/* Definitions */
+
+#define TEST_CULL_VIEWS 200			//Random sets of viewing parameters
+#define TEST_CULL_OBJECTS 500		//Random boxes placed under each
+#define TEST_CULL_GRID 9			//Points along each edge of the grid over each face of a box
+#define TEST_CULL_TOLERANCE 1e-3	//Margin inside the viewing volume, above the rounding of the engine's floats
+
+#define TEST_CULL_CHECK(condition, ...) do { if (!(condition)) { \
+	if (failures++ < 20) { printf(__VA_ARGS__); } } } while (0)
+	//Counts a failure, printing only the first few
+
+/* Externally Referenced Variables */
+
+Blah_Video_Mode *blah_video_currentMode = NULL;	//No video mode, as blah_video.c needs SDL
+
+/* Video Functions */
+
+void *blah_video_getProcAddress(const char *name)
+{	//No drawing context, so no extension functions
+	(void)name;
+	return NULL;
+}
+
+/* Static Globals */
+
+static int failures = 0;
+
+/* Static Functions */
+
+static double test_cull_random(double low, double high)
+{	//Returns a random number between low and high
+	return low + (high - low) * rand() / RAND_MAX;
+}
+
+static Blah_Object *test_cull_newBox(Blah_Material *material, const double low[3], const double high[3])
+{	//Creates an object of the six faces of the box between corners low and high
+	static const int faces[6][4] = {{0, 1, 3, 2}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 3, 7, 6}, {0, 2, 6, 4}, {1, 3, 7, 5}};
+	Blah_Object *box = Blah_Object_new();
+	Blah_Vertex *corners[8];
+
+	for (int corner = 0; corner < 8; corner++) {
+		corners[corner] = Blah_Object_addVertex(box, corner & 1 ? high[0] : low[0], corner & 2 ? high[1] : low[1], corner & 4 ? high[2] : low[2]);
+	}
+	for (int face = 0; face < 6; face++) {
+		Blah_Vertex *vertices[5] = {corners[faces[face][0]], corners[faces[face][1]], corners[faces[face][2]], corners[faces[face][3]], NULL};
+		Blah_Primitive *quad = Blah_Primitive_new(BLAH_PRIMITIVE_QUADRILATERAL, vertices, 4);
+		Blah_Primitive_setMaterial(quad, material);
+		Blah_Object_addPrimitive(box, quad);
+	}
+	return box;
+}
+
+static void test_cull_lookAt(double view[16], const double eye[3], const double focus[3], const double normal[3])
+{	//Sets view to the column major matrix taking world to eye coordinates, as gluLookAt does
+	double forward[3], side[3], up[3], length;
+
+	for (int axis = 0; axis < 3; axis++) { forward[axis] = focus[axis] - eye[axis]; }
+	length = sqrt(forward[0] * forward[0] + forward[1] * forward[1] + forward[2] * forward[2]);
+	for (int axis = 0; axis < 3; axis++) { forward[axis] /= length; }
+	side[0] = forward[1] * normal[2] - forward[2] * normal[1];
+	side[1] = forward[2] * normal[0] - forward[0] * normal[2];
+	side[2] = forward[0] * normal[1] - forward[1] * normal[0];
+	length = sqrt(side[0] * side[0] + side[1] * side[1] + side[2] * side[2]);
+	for (int axis = 0; axis < 3; axis++) { side[axis] /= length; }
+	up[0] = side[1] * forward[2] - side[2] * forward[1];
+	up[1] = side[2] * forward[0] - side[0] * forward[2];
+	up[2] = side[0] * forward[1] - side[1] * forward[0];
+
+	for (int column = 0; column < 3; column++) {
+		view[column * 4] = side[column];
+		view[column * 4 + 1] = up[column];
+		view[column * 4 + 2] = -forward[column];
+		view[column * 4 + 3] = 0;
+	}
+	view[12] = -(side[0] * eye[0] + side[1] * eye[1] + side[2] * eye[2]);
+	view[13] = -(up[0] * eye[0] + up[1] * eye[1] + up[2] * eye[2]);
+	view[14] = forward[0] * eye[0] + forward[1] * eye[1] + forward[2] * eye[2];
+	view[15] = 1;
+}
+
+static void test_cull_randomPlacement(double placement[16])
+{	//Sets placement to a random rotation, followed by a random scale on each axis and translation
+	double axis[3], angle = test_cull_random(0, 6.3), length, scale[3];
+
+	for (int index = 0; index < 3; index++) {
+		axis[index] = test_cull_random(-1, 1);
+		scale[index] = test_cull_random(0.2, 3);
+	}
+	length = sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]) + 1e-9;
+	for (int index = 0; index < 3; index++) { axis[index] /= length; }
+	const double c = cos(angle), s = sin(angle), t = 1 - c;
+	const double rotation[3][3] = { //Columns of the rotation about axis
+		{t * axis[0] * axis[0] + c, t * axis[0] * axis[1] + s * axis[2], t * axis[0] * axis[2] - s * axis[1]},
+		{t * axis[0] * axis[1] - s * axis[2], t * axis[1] * axis[1] + c, t * axis[1] * axis[2] + s * axis[0]},
+		{t * axis[0] * axis[2] + s * axis[1], t * axis[1] * axis[2] - s * axis[0], t * axis[2] * axis[2] + c}};
+	for (int column = 0; column < 3; column++) {
+		for (int row = 0; row < 3; row++) { placement[column * 4 + row] = rotation[column][row] * scale[row]; }
+		placement[column * 4 + 3] = 0;
+		placement[12 + column] = test_cull_random(-120, 120);
+	}
+	placement[15] = 1;
+}
+
+static void test_cull_transform(double result[3], const double matrix[16], const double point[3])
+{	//Transforms the point by the column major matrix
+	for (int row = 0; row < 3; row++) {
+		result[row] = matrix[row] * point[0] + matrix[row + 4] * point[1] + matrix[row + 8] * point[2] + matrix[row + 12];
+	}
+}
+
+static bool test_cull_isBoxVisible(const double view[16], const double placement[16], const double low[3], const double high[3],
+	double halfWidth, double halfHeight, double depth)
+{	//Returns true if any point of the grid over the faces of the box lies inside the viewing volume
+	for (int fixedAxis = 0; fixedAxis < 3; fixedAxis++) {
+		for (int side = 0; side < 2; side++) {
+			for (int step1 = 0; step1 < TEST_CULL_GRID; step1++) {
+				for (int step2 = 0; step2 < TEST_CULL_GRID; step2++) {
+					const int axis1 = (fixedAxis + 1) % 3, axis2 = (fixedAxis + 2) % 3;
+					double point[3], world[3], eye[3];
+					point[fixedAxis] = side ? high[fixedAxis] : low[fixedAxis];
+					point[axis1] = low[axis1] + (high[axis1] - low[axis1]) * step1 / (TEST_CULL_GRID - 1);
+					point[axis2] = low[axis2] + (high[axis2] - low[axis2]) * step2 / (TEST_CULL_GRID - 1);
+					test_cull_transform(world, placement, point);
+					test_cull_transform(eye, view, world);
+					if (fabs(eye[0]) <= halfWidth - TEST_CULL_TOLERANCE && fabs(eye[1]) <= halfHeight - TEST_CULL_TOLERANCE
+							&& eye[2] <= -TEST_CULL_TOLERANCE && eye[2] >= TEST_CULL_TOLERANCE - depth) { return true; }
+				}
+			}
+		}
+	}
+	return false;
+}
+
+/* Main */
+
+int main()
+{
+	Blah_Material material;
+	unsigned long culled = 0, drawn = 0, keptOutside = 0;
+
+	blah_draw_init();
+	Blah_Material_init(&material);
+	srand(3);
+
+	for (int viewNumber = 0; viewNumber < TEST_CULL_VIEWS; viewNumber++) {
+		double eye[3], focus[3], normal[3] = {0, 1, 0}, view[16];
+		const double fieldX = test_cull_random(0.3, 2.0), fieldY = test_cull_random(0.3, 2.0), depth = test_cull_random(20, 300);
+		Blah_Draw_Stats statsBefore, statsAfter;
+		unsigned long viewCulled = 0;
+
+		for (int axis = 0; axis < 3; axis++) {
+			eye[axis] = test_cull_random(-50, 50);
+			focus[axis] = eye[axis] + test_cull_random(-60, 60);
+		}
+		blah_draw_setViewpoint(eye[0], eye[1], eye[2]);
+		blah_draw_setFocalPoint(focus[0], focus[1], focus[2]);
+		blah_draw_setViewNormal(normal[0], normal[1], normal[2]);
+		blah_draw_setFieldOfVision(fieldX, fieldY);
+		blah_draw_setDepthOfVision(depth);
+		blah_draw_resetMatrix();
+		blah_draw_updatePerspective();
+		blah_draw_getStats(&statsBefore);
+		test_cull_lookAt(view, eye, focus, normal);
+
+		{	//The viewing volume of the orthographic projection, sized at the focal distance
+			const double distance = sqrt((focus[0] - eye[0]) * (focus[0] - eye[0]) + (focus[1] - eye[1]) * (focus[1] - eye[1])
+				+ (focus[2] - eye[2]) * (focus[2] - eye[2]));
+			const double halfWidth = distance * tan(fieldX / 2), halfHeight = distance * tan(fieldY / 2);
+
+			for (int objectNumber = 0; objectNumber < TEST_CULL_OBJECTS; objectNumber++) {
+				double low[3], high[3], placement[16];
+				float placementElements[16];
+				Blah_Matrix placementMatrix;
+				for (int axis = 0; axis < 3; axis++) { //Boxes are not centred on their origin
+					low[axis] = test_cull_random(-6, 2);
+					high[axis] = low[axis] + test_cull_random(0.1, 8);
+				}
+				test_cull_randomPlacement(placement);
+				for (int index = 0; index < 16; index++) { placementElements[index] = placement[index]; }
+				memcpy(&placementMatrix, placementElements, sizeof(Blah_Matrix));
+
+				Blah_Object *box = test_cull_newBox(&material, low, high);
+				blah_draw_pushMatrix();
+				blah_draw_multMatrix(&placementMatrix);
+				const bool visible = blah_draw_isObjectVisible(box);
+				blah_draw_popMatrix();
+				const bool reference = test_cull_isBoxVisible(view, placement, low, high, halfWidth, halfHeight, depth);
+				TEST_CULL_CHECK(visible || !reference, "view %d object %d culled while inside the viewing volume\n", viewNumber, objectNumber);
+				if (visible) { drawn++; } else { culled++; viewCulled++; }
+				if (visible && !reference) { keptOutside++; }
+				Blah_Object_destroy(box);
+			}
+		}
+		blah_draw_getStats(&statsAfter);
+		statsAfter.objectsDrawn -= statsBefore.objectsDrawn;
+		statsAfter.objectsCulled -= statsBefore.objectsCulled;
+		TEST_CULL_CHECK(statsAfter.objectsCulled == viewCulled && statsAfter.objectsDrawn == TEST_CULL_OBJECTS - viewCulled,
+			"view %d stats counted %lu drawn and %lu culled\n", viewNumber, statsAfter.objectsDrawn, statsAfter.objectsCulled);
+	}
+	TEST_CULL_CHECK(culled > 0 && drawn > 0, "no objects %s\n", culled ? "drawn" : "culled");
+
+	printf("test_cull: %d failures, %lu drawn, %lu culled, %lu outside kept by their bounding sphere\n",
+		failures, drawn, culled, keptOutside);
+	return failures != 0;
+}
@@ -0,0 +1,431 @@
+/* test_loader.c
+	Loads a batch of lightwave models and targa images through the loader's worker threads at once,
+	with the OpenGL texture upload replaced by a stub which counts uploads and checks that it is
+	only called on the main thread.  The assets are written by the test, so each loaded model and
+	image is compared with the data it was written from.  Textures shared between models must be
+	uploaded once.  Missing files and corrupt images must fail their requests without stopping the
+	rest, and a model file cut short must load the chunks before the cut.  Polygons of a second
+	polygon list referring to surfaces which don't exist must be loaded without a surface.
+	Build with SANITIZE=1 to also catch memory errors.  Returns nonzero if any check fails. */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+
+#include "blah_loader.h"
+#include "blah_model.h"
+#include "blah_texture.h"
+
+/* Definitions */
+
+#define TEST_LOADER_THREADS 4
+#define TEST_LOADER_MODELS 12
+#define TEST_LOADER_IMAGES 12
+#define TEST_LOADER_TEXTURES 4			//Each shared by the surfaces of several models
+#define TEST_LOADER_GRID 24				//Points along each side of the grid of a model's vertices
+#define TEST_LOADER_POLYGONS 3000
+#define TEST_LOADER_IMAGE_SIDE 256
+#define TEST_LOADER_TEXTURE_SIDE 64
+#define TEST_LOADER_HEADER_LENGTH 18
+#define TEST_LOADER_NAME_LENGTH 40
+
+#define TEST_LOADER_CHECK(condition, ...) do { if (!(condition)) { \
+	if (failures++ < 20) { printf(__VA_ARGS__); } } } while (0)
+	//Counts a failure, printing only the first few
+
+/* Structure Definitions */
+
+typedef struct Test_Loader_Model { //What a model file was written from
+	char fileName[TEST_LOADER_NAME_LENGTH];
+	char textureName[TEST_LOADER_NAME_LENGTH];
+	float points[TEST_LOADER_GRID * TEST_LOADER_GRID][3];
+	unsigned short polygons[TEST_LOADER_POLYGONS][5];	//Vertex count, up to four indices
+} Test_Loader_Model;
+
+typedef struct Test_Loader_Image { //What an image file was written from
+	char fileName[TEST_LOADER_NAME_LENGTH];
+	unsigned int side;
+	unsigned char *pixels;
+} Test_Loader_Image;
+
+/* Static Globals */
+
+static int failures = 0;
+static thrd_t mainThread;
+static int uploads = 0, callbacks = 0;
+
+/* Texture Upload Stubs */
+
+blah_texture_handle Blah_Texture_gl_new(const Blah_Image *sourceImage)
+{	//Counts the upload in place of creating an OpenGL texture
+	TEST_LOADER_CHECK(thrd_equal(thrd_current(), mainThread), "texture %s uploaded from a worker thread\n", sourceImage->name);
+	return ++uploads;
+}
+
+blah_texture_handle Blah_Texture_gl_newLevels(const Blah_Texture *texture)
+{	//Counts the upload in place of creating an OpenGL texture
+	TEST_LOADER_CHECK(thrd_equal(thrd_current(), mainThread), "texture %s uploaded from a worker thread\n", texture->name);
+	return ++uploads;
+}
+
+void Blah_Texture_gl_updateLevels(const Blah_Texture *texture)
+{
+	TEST_LOADER_CHECK(thrd_equal(thrd_current(), mainThread), "texture %s updated from a worker thread\n", texture->name);
+}
+
+void Blah_Texture_gl_destroy(blah_texture_handle handle)
+{
+	(void)handle;
+}
+
+/* Static Functions */
+
+static unsigned char *test_loader_put16(unsigned char *dest, unsigned int value)
+{	//Stores a 16 bit value most significant byte first, returning the end of it
+	dest[0] = value >> 8;
+	dest[1] = value & 255;
+	return dest + 2;
+}
+
+static unsigned char *test_loader_put32(unsigned char *dest, uint32_t value)
+{	//Stores a 32 bit value most significant byte first, returning the end of it
+	return test_loader_put16(test_loader_put16(dest, value >> 16), value & 65535);
+}
+
+static unsigned char *test_loader_putFloat(unsigned char *dest, float value)
+{	//Stores a float most significant byte first, returning the end of it
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return test_loader_put32(dest, bits);
+}
+
+static unsigned char *test_loader_putString(unsigned char *dest, const char *string)
+{	//Stores a null terminated string padded to an even length, returning the end of it
+	const size_t length = strlen(string) + 1;
+	memcpy(dest, string, length);
+	dest += length;
+	if (length & 1) { *dest++ = 0; }
+	return dest;
+}
+
+static unsigned char *test_loader_beginChunk(unsigned char *dest, const char *tag, int lengthSize)
+{	//Stores the tag of a chunk, or a subchunk if lengthSize is 2, leaving room for its length
+	memcpy(dest, tag, 4);
+	return dest + 4 + lengthSize;
+}
+
+static unsigned char *test_loader_endChunk(unsigned char *start, unsigned char *end, int lengthSize)
+{	//Stores the length of the chunk started at start and ending at end, padding it to an even length
+	const size_t length = end - start - 4 - lengthSize;
+	if (lengthSize == 2) { test_loader_put16(start + 4, length); } else { test_loader_put32(start + 4, length); }
+	if (length & 1) { *end++ = 0; }
+	return end;
+}
+
+static size_t test_loader_writeModel(unsigned char *data, Test_Loader_Model *model)
+{	//Writes a lightwave object of random points and polygons over two surfaces, the second textured.
+	//Returns the length of the file.
+	unsigned char *form, *chunk, *subchunk, *dest = data;
+	const int numPoints = TEST_LOADER_GRID * TEST_LOADER_GRID;
+
+	form = dest;
+	dest = test_loader_beginChunk(dest, "FORM", 4);
+	memcpy(dest, "LWOB", 4);
+	dest += 4;
+
+	chunk = dest;
+	dest = test_loader_beginChunk(dest, "PNTS", 4);
+	for (int point = 0; point < numPoints; point++) {
+		model->points[point][0] = (point % TEST_LOADER_GRID) * 0.1f;
+		model->points[point][1] = (point / TEST_LOADER_GRID) * 0.1f;
+		model->points[point][2] = (float)rand() / RAND_MAX;
+		for (int axis = 0; axis < 3; axis++) { dest = test_loader_putFloat(dest, model->points[point][axis]); }
+	}
+	dest = test_loader_endChunk(chunk, dest, 4);
+
+	chunk = dest;
+	dest = test_loader_beginChunk(dest, "SRFS", 4);
+	dest = test_loader_putString(test_loader_putString(dest, "Default"), "Textured");
+	dest = test_loader_endChunk(chunk, dest, 4);
+
+	chunk = dest;
+	dest = test_loader_beginChunk(dest, "POLS", 4);
+	for (int polygon = 0; polygon < TEST_LOADER_POLYGONS; polygon++) {
+		unsigned short *written = model->polygons[polygon];
+		written[0] = 3 + rand() % 2;
+		dest = test_loader_put16(dest, written[0]);
+		for (int index = 1; index <= written[0]; index++) {
+			written[index] = rand() % numPoints;
+			dest = test_loader_put16(dest, written[index]);
+		}
+		dest = test_loader_put16(dest, 1 + (polygon & 1)); //Surfaces alternate
+	}
+	dest = test_loader_endChunk(chunk, dest, 4);
+
+	chunk = dest;
+	dest = test_loader_beginChunk(dest, "SURF", 4);
+	dest = test_loader_putString(dest, "Default");
+	subchunk = dest;
+	dest = test_loader_beginChunk(dest, "COLR", 2);
+	*dest++ = 200; *dest++ = 100; *dest++ = 50; *dest++ = 0;
+	dest = test_loader_endChunk(subchunk, dest, 2);
+	dest = test_loader_endChunk(chunk, dest, 4);
+
+	chunk = dest;
+	dest = test_loader_beginChunk(dest, "SURF", 4);
+	dest = test_loader_putString(dest, "Textured");
+	subchunk = dest;
+	dest = test_loader_beginChunk(dest, "COLR", 2);
+	*dest++ = 20; *dest++ = 10; *dest++ = 250; *dest++ = 0;
+	dest = test_loader_endChunk(subchunk, dest, 2);
+	subchunk = dest;
+	dest = test_loader_putString(test_loader_beginChunk(dest, "CTEX", 2), "Planar Image Map");
+	dest = test_loader_endChunk(subchunk, dest, 2);
+	subchunk = dest;
+	dest = test_loader_put16(test_loader_beginChunk(dest, "TFLG", 2), 2);
+	dest = test_loader_endChunk(subchunk, dest, 2);
+	subchunk = dest;
+	dest = test_loader_beginChunk(dest, "TSIZ", 2);
+	for (int axis = 0; axis < 3; axis++) { dest = test_loader_putFloat(dest, axis + 1); }
+	dest = test_loader_endChunk(subchunk, dest, 2);
+	subchunk = dest;
+	dest = test_loader_putString(test_loader_beginChunk(dest, "TIMG", 2), model->textureName);
+	dest = test_loader_endChunk(subchunk, dest, 2);
+	dest = test_loader_endChunk(chunk, dest, 4);
+
+	return test_loader_endChunk(form, dest, 4) - data;
+}
+
+static size_t test_loader_writeSurfaceModel(unsigned char *data)
+{	//Writes a lightwave object of one surface and two polygon lists of a triangle each, the triangle of
+	//the second list referring to a surface past the end of the surface list.  Returns the length of the file.
+	unsigned char *form, *chunk, *dest = data;
+
+	form = dest;
+	dest = test_loader_beginChunk(dest, "FORM", 4);
+	memcpy(dest, "LWOB", 4);
+	dest += 4;
+
+	chunk = dest;
+	dest = test_loader_beginChunk(dest, "PNTS", 4);
+	for (int point = 0; point < 3; point++) {
+		for (int axis = 0; axis < 3; axis++) { dest = test_loader_putFloat(dest, point == axis); }
+	}
+	dest = test_loader_endChunk(chunk, dest, 4);
+
+	chunk = dest;
+	dest = test_loader_beginChunk(dest, "SRFS", 4);
+	dest = test_loader_putString(dest, "Default");
+	dest = test_loader_endChunk(chunk, dest, 4);
+
+	for (int list = 0; list < 2; list++) { //The second list is read after the face block is taken
+		chunk = dest;
+		dest = test_loader_put16(test_loader_beginChunk(dest, "POLS", 4), 3);
+		for (int index = 0; index < 3; index++) { dest = test_loader_put16(dest, index); }
+		dest = test_loader_put16(dest, list ? 0x7fff : 1);
+		dest = test_loader_endChunk(chunk, dest, 4);
+	}
+
+	return test_loader_endChunk(form, dest, 4) - data;
+}
+
+static size_t test_loader_writeImage(unsigned char *data, Test_Loader_Image *image)
+{	//Writes an uncompressed 24 bit targa image of random pixels, keeping a copy of its pixels.
+	//Returns the length of the file.
+	const size_t pixelBytes = (size_t)image->side * image->side * 3;
+
+	memset(data, 0, TEST_LOADER_HEADER_LENGTH);
+	data[2] = 2; //Uncompressed RGB
+	data[12] = data[14] = image->side & 255;
+	data[13] = data[15] = image->side >> 8;
+	data[16] = 24;
+	image->pixels = malloc(pixelBytes);
+	for (size_t index = 0; index < pixelBytes; index++) { image->pixels[index] = rand(); }
+	memcpy(data + TEST_LOADER_HEADER_LENGTH, image->pixels, pixelBytes);
+	return TEST_LOADER_HEADER_LENGTH + pixelBytes;
+}
+
+static void test_loader_writeFile(const char *fileName, const unsigned char *data, size_t length)
+{	//Writes the file, exiting if it cannot be written
+	FILE *file = fopen(fileName, "wb");
+
+	if (file == NULL || fwrite(data, 1, length, file) != length) {
+		printf("test_loader: failed to write %s\n", fileName);
+		exit(1);
+	}
+	fclose(file);
+}
+
+static void test_loader_callback(Blah_Loader_Request *request, void *userData)
+{	//Counts callbacks, which must be on the main thread once the request is done
+	(void)userData;
+	TEST_LOADER_CHECK(thrd_equal(thrd_current(), mainThread), "callback of %s on a worker thread\n", request->fileName);
+	TEST_LOADER_CHECK(Blah_Loader_Request_isDone(request), "callback of %s before it was done\n", request->fileName);
+	callbacks++;
+}
+
+static void test_loader_compareModel(const Test_Loader_Model *written, const Blah_Model *model)
+{	//Checks the loaded model against what its file was written from
+	const Blah_List_Element *element;
+	int index = 0;
+
+	TEST_LOADER_CHECK(model->vertices.length == TEST_LOADER_GRID * TEST_LOADER_GRID && model->faces.length == TEST_LOADER_POLYGONS,
+		"%s has %lu vertices and %lu faces\n", written->fileName, (unsigned long)model->vertices.length, (unsigned long)model->faces.length);
+	for (element = model->vertices.first; element && index < TEST_LOADER_GRID * TEST_LOADER_GRID; element = element->next, index++) {
+		const Blah_Point *location = &((const Blah_Vertex*)element->data)->location;
+		TEST_LOADER_CHECK(location->x == written->points[index][0] && location->y == written->points[index][1]
+			&& location->z == written->points[index][2], "%s vertex %d misplaced\n", written->fileName, index);
+	}
+	index = 0;
+	for (element = model->faces.first; element && index < TEST_LOADER_POLYGONS; element = element->next, index++) {
+		const Blah_Model_Face *face = element->data;
+		const unsigned short *polygon = written->polygons[index];
+		bool same = face->surface == 1 + (index & 1) && face->indices.length == polygon[0];
+		int corner = 1;
+		for (const Blah_List_Element *indexElement = face->indices.first; same && indexElement; indexElement = indexElement->next) {
+			same = (size_t)indexElement->data == polygon[corner++];
+		}
+		TEST_LOADER_CHECK(same, "%s face %d differs\n", written->fileName, index);
+	}
+
+	for (element = model->surfaces.first; element; element = element->next) {
+		const Blah_Model_Surface *surface = element->data;
+		const bool textured = strcmp(surface->name, "Textured") == 0;
+		const Blah_Model_Texture_Map *map = surface->textures.first ? surface->textures.first->data : NULL;
+		TEST_LOADER_CHECK(fabsf(surface->colour.red - (textured ? 20 : 200) / 255.0f) < 1e-6f
+			&& fabsf(surface->colour.blue - (textured ? 250 : 50) / 255.0f) < 1e-6f, "%s surface %s discoloured\n", written->fileName, surface->name);
+		TEST_LOADER_CHECK(surface->textures.length == (textured ? 1 : 0), "%s surface %s has %lu textures\n", written->fileName,
+			surface->name, (unsigned long)surface->textures.length);
+		if (map) {
+			TEST_LOADER_CHECK(map->image == NULL && map->texture && map->texture == blah_texture_find(written->textureName)
+				&& map->texture->width == TEST_LOADER_TEXTURE_SIDE, "%s texture map not completed with %s\n", written->fileName, written->textureName);
+		}
+	}
+}
+
+static void test_loader_compareImage(const Test_Loader_Image *written, const Blah_Image *image)
+{	//Checks the loaded image against what its file was written from
+	TEST_LOADER_CHECK(image && image->width == written->side && image->height == written->side && image->pixelDepth == 24
+		&& memcmp(image->pixelData, written->pixels, (size_t)written->side * written->side * 3) == 0, "%s decoded wrongly\n", written->fileName);
+}
+
+/* Main */
+
+int main()
+{
+	static Test_Loader_Model models[TEST_LOADER_MODELS];
+	static Test_Loader_Image images[TEST_LOADER_IMAGES], textures[TEST_LOADER_TEXTURES];
+	Blah_Loader_Request *modelRequests[TEST_LOADER_MODELS], *imageRequests[TEST_LOADER_IMAGES];
+	static Test_Loader_Image corruptImage = {"test_loader_corrupt.tga", TEST_LOADER_TEXTURE_SIDE, NULL};
+	Blah_Loader_Request *missing, *corrupt, *truncated, *badSurface, *existingTexture, *dropped;
+	unsigned char *data = malloc(TEST_LOADER_HEADER_LENGTH + TEST_LOADER_IMAGE_SIDE * TEST_LOADER_IMAGE_SIDE * 3);
+	size_t length;
+	int frames = 0, expectedCallbacks = TEST_LOADER_MODELS + TEST_LOADER_IMAGES + 5;
+
+	mainThread = thrd_current();
+	srand(15);
+	for (int index = 0; index < TEST_LOADER_TEXTURES; index++) {
+		snprintf(textures[index].fileName, TEST_LOADER_NAME_LENGTH, "test_loader_texture%d.tga", index);
+		textures[index].side = TEST_LOADER_TEXTURE_SIDE;
+		test_loader_writeFile(textures[index].fileName, data, test_loader_writeImage(data, &textures[index]));
+	}
+	for (int index = 0; index < TEST_LOADER_IMAGES; index++) {
+		snprintf(images[index].fileName, TEST_LOADER_NAME_LENGTH, "test_loader_image%d.tga", index);
+		images[index].side = TEST_LOADER_IMAGE_SIDE;
+		test_loader_writeFile(images[index].fileName, data, test_loader_writeImage(data, &images[index]));
+	}
+	for (int index = 0; index < TEST_LOADER_MODELS; index++) {
+		snprintf(models[index].fileName, TEST_LOADER_NAME_LENGTH, "test_loader_model%d.lwo", index);
+		strcpy(models[index].textureName, textures[index % TEST_LOADER_TEXTURES].fileName);
+		length = test_loader_writeModel(data, &models[index]);
+		test_loader_writeFile(models[index].fileName, data, length);
+	}
+	test_loader_writeFile("test_loader_truncated.lwo", data, length / 2); //The last model cut short in its polygons
+	test_loader_writeFile("test_loader_badsurface.lwo", data, test_loader_writeSurfaceModel(data));
+	length = test_loader_writeImage(data, &corruptImage);
+	data[16] = 12; //An unsupported pixel size
+	test_loader_writeFile(corruptImage.fileName, data, length);
+
+	if (!blah_loader_init(TEST_LOADER_THREADS)) { printf("test_loader: failed to start worker threads\n"); return 1; }
+	for (int index = 0; index < TEST_LOADER_MODELS; index++) {
+		modelRequests[index] = blah_loader_loadModel(models[index].fileName, test_loader_callback, NULL);
+	}
+	for (int index = 0; index < TEST_LOADER_IMAGES; index++) {
+		imageRequests[index] = blah_loader_loadImage(images[index].fileName, test_loader_callback, NULL);
+	}
+	missing = blah_loader_loadModel("test_loader_missing.lwo", test_loader_callback, NULL);
+	corrupt = blah_loader_loadImage(corruptImage.fileName, test_loader_callback, NULL);
+	truncated = blah_loader_loadModel("test_loader_truncated.lwo", test_loader_callback, NULL);
+	badSurface = blah_loader_loadModel("test_loader_badsurface.lwo", test_loader_callback, NULL);
+	existingTexture = blah_loader_loadTexture(textures[0].fileName, test_loader_callback, NULL);
+	dropped = blah_loader_loadImage(images[0].fileName, test_loader_callback, NULL);
+	Blah_Loader_Request_destroy(dropped); //Still decoded, but its image is destroyed and no callback made
+
+	while (callbacks < expectedCallbacks && frames < 100000) { //Frames of about a millisecond, as the engine would run
+		const struct timespec frameTime = {0, 1000000};
+		blah_loader_main();
+		frames++;
+		thrd_sleep(&frameTime, NULL);
+	}
+	TEST_LOADER_CHECK(callbacks == expectedCallbacks, "%d of %d callbacks made\n", callbacks, expectedCallbacks);
+
+	for (int index = 0; index < TEST_LOADER_MODELS; index++) {
+		const Blah_Model *model = Blah_Loader_Request_getModel(modelRequests[index]);
+		TEST_LOADER_CHECK(model, "%s not loaded, state %d\n", models[index].fileName, Blah_Loader_Request_getState(modelRequests[index]));
+		if (model) { test_loader_compareModel(&models[index], model); }
+	}
+	for (int index = 0; index < TEST_LOADER_IMAGES; index++) {
+		test_loader_compareImage(&images[index], Blah_Loader_Request_getImage(imageRequests[index]));
+	}
+	TEST_LOADER_CHECK(Blah_Loader_Request_getState(missing) == BLAH_LOADER_STATE_FAILED, "missing model not failed\n");
+	TEST_LOADER_CHECK(Blah_Loader_Request_getState(corrupt) == BLAH_LOADER_STATE_FAILED, "corrupt image not failed\n");
+	{	//Points come before the polygons which were cut short
+		const Blah_Model *model = Blah_Loader_Request_getModel(truncated);
+		TEST_LOADER_CHECK(model && model->vertices.length == TEST_LOADER_GRID * TEST_LOADER_GRID && model->faces.length == 0,
+			"truncated model not loaded up to its polygons\n");
+	}
+	{	//Both triangles are kept, but only the first is added to the surface
+		const Blah_Model *model = Blah_Loader_Request_getModel(badSurface);
+		const Blah_Model_Surface *surface = model && model->surfaces.first ? model->surfaces.first->data : NULL;
+		TEST_LOADER_CHECK(model && model->faces.length == 2 && surface && surface->faces.length == 1,
+			"polygons with a surface index past the surface list not loaded without a surface\n");
+	}
+	TEST_LOADER_CHECK(Blah_Loader_Request_getTexture(existingTexture) == blah_texture_find(textures[0].fileName),
+		"texture loaded again instead of found\n");
+	TEST_LOADER_CHECK(uploads == TEST_LOADER_TEXTURES, "%d textures uploaded, not %d\n", uploads, TEST_LOADER_TEXTURES);
+
+	for (int index = 0; index < TEST_LOADER_IMAGES; index++) {
+		Blah_Image *image = Blah_Loader_Request_getImage(imageRequests[index]);
+		if (image) { Blah_Image_destroy(image); }
+		Blah_Loader_Request_destroy(imageRequests[index]);
+		remove(images[index].fileName);
+		free(images[index].pixels);
+	}
+	for (int index = 0; index < TEST_LOADER_MODELS; index++) {
+		Blah_Loader_Request_destroy(modelRequests[index]);
+		remove(models[index].fileName);
+	}
+	for (int index = 0; index < TEST_LOADER_TEXTURES; index++) {
+		remove(textures[index].fileName);
+		free(textures[index].pixels);
+	}
+	Blah_Loader_Request_destroy(missing);
+	Blah_Loader_Request_destroy(corrupt);
+	Blah_Loader_Request_destroy(truncated);
+	Blah_Loader_Request_destroy(badSurface);
+	Blah_Loader_Request_destroy(existingTexture);
+	remove(corruptImage.fileName);
+	remove("test_loader_truncated.lwo");
+	remove("test_loader_badsurface.lwo");
+	free(corruptImage.pixels);
+	blah_loader_exit();
+	blah_model_destroyAll();
+	blah_texture_destroyAll();
+	free(data);
+
+	printf("test_loader: %d failures, %d requests completed in %d frames\n", failures, callbacks, frames);
+	return failures != 0;
+}
@@ -0,0 +1,206 @@
+/* test_math.c
+	Checks the inline math layer of blah_math.h against the plain C it replaced, and against double
+	precision references where the order of operations differs.  Built once for each instruction set
+	by the Makefile, so that the SSE2, AVX and plain C paths are all covered.  Returns nonzero if any
+	check fails. */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blah_math.h"
+
+/* Definitions */
+
+#define TEST_MATH_ITERATIONS 100000
+#define TEST_MATH_MAX_POINTS 13	//Covers the remainders of both the four and eight point loops
+
+#define TEST_MATH_CHECK(condition, ...) do { if (!(condition)) { \
+	if (failures++ < 20) { printf(__VA_ARGS__); } } } while (0)
+	//Counts a failure, printing only the first few
+
+/* Static Globals */
+
+static int failures = 0;
+
+/* Static Functions */
+
+static float test_math_random()
+{	//Returns a random coordinate in the range -2 to 2
+	return (float)rand() / RAND_MAX * 4 - 2;
+}
+
+static void test_math_randomMatrix(Blah_Matrix *matrix)
+{	//Fills all sixteen elements, including the bottom row, with random values
+	float *elements = (float*)matrix;
+	for (int index = 0; index < 16; index++) { elements[index] = test_math_random(); }
+}
+
+static void test_math_scalarTransformPoint(float *point, const float *elements)
+{	//Transforms the point as Blah_Point_multiplyMatrix did before the math layer
+	float result[3] = {0, 0, 0};
+	for (int row = 0; row < 3; row++) {
+		int elementIndex = row;
+		for (int column = 0; column < 3; column++) {
+			result[row] += point[column] * elements[elementIndex];
+			elementIndex += 4;
+		}
+		result[row] += elements[elementIndex];
+	}
+	memcpy(point, result, sizeof(result));
+}
+
+static void test_math_scalarMultiplyQuaternions(Blah_Quaternion *quat1, const Blah_Quaternion *quat2)
+{	//Multiplies quat1 by quat2 as Blah_Quaternion_multiply did before the math layer
+	float w = (quat1->w * quat2->w) - (quat1->x * quat2->x) - (quat1->y * quat2->y) - (quat1->z * quat2->z);
+	float x = (quat1->w * quat2->x) + (quat1->x * quat2->w) + (quat1->y * quat2->z) - (quat1->z * quat2->y);
+	float y = (quat1->w * quat2->y) + (quat1->y * quat2->w) + (quat1->z * quat2->x) - (quat1->x * quat2->z);
+	float z = (quat1->w * quat2->z) + (quat1->z * quat2->w) + (quat1->x * quat2->y) - (quat1->y * quat2->x);
+	quat1->w = w; quat1->x = x; quat1->y = y; quat1->z = z;
+}
+
+static void test_math_referenceMultiply(double *result, const float *left, const float *right)
+{	//Multiplies two column major matrices in double precision
+	for (int column = 0; column < 4; column++) {
+		for (int row = 0; row < 4; row++) {
+			double sum = 0;
+			for (int term = 0; term < 4; term++) { sum += (double)left[row + 4 * term] * right[term + 4 * column]; }
+			result[row + 4 * column] = sum;
+		}
+	}
+}
+
+static void test_math_checkMatrices(Blah_Matrix *left, Blah_Matrix *right, double *maxInverseError)
+{	//Checks the product and inverse of two random matrices
+	const float *leftElements = (float*)left, *rightElements = (float*)right;
+	Blah_Matrix product, aliased, inverse;
+	double reference[16];
+
+	test_math_referenceMultiply(reference, leftElements, rightElements);
+	blah_math_multiplyMatrices(&product, left, right);
+	for (int column = 0; column < 4; column++) {
+		for (int row = 0; row < 4; row++) { //Terms are added in the same order as plain C, so results are identical
+			const float expected = leftElements[row] * rightElements[4 * column] + leftElements[row + 4] * rightElements[4 * column + 1]
+				+ leftElements[row + 8] * rightElements[4 * column + 2] + leftElements[row + 12] * rightElements[4 * column + 3];
+			TEST_MATH_CHECK(expected == ((float*)&product)[row + 4 * column], "multiply differs from plain C at %d,%d\n", row, column);
+			TEST_MATH_CHECK(fabs(expected - reference[row + 4 * column]) < 1e-4, "multiply inaccurate at %d,%d\n", row, column);
+		}
+	}
+
+	aliased = *left; //Destination may be either operand
+	blah_math_multiplyMatrices(&aliased, &aliased, right);
+	TEST_MATH_CHECK(memcmp(&aliased, &product, sizeof(Blah_Matrix)) == 0, "multiply into left operand differs\n");
+	aliased = *right;
+	blah_math_multiplyMatrices(&aliased, left, &aliased);
+	TEST_MATH_CHECK(memcmp(&aliased, &product, sizeof(Blah_Matrix)) == 0, "multiply into right operand differs\n");
+
+	if (blah_math_invertMatrix(&inverse, left)) { //Error of left*inverse from identity, relative to the inverse's largest element
+		double identity[16], largest = 1;
+		test_math_referenceMultiply(identity, leftElements, (float*)&inverse);
+		for (int index = 0; index < 16; index++) { largest = fmax(largest, fabs(((float*)&inverse)[index])); }
+		for (int index = 0; index < 16; index++) {
+			*maxInverseError = fmax(*maxInverseError, fabs(identity[index] - (index % 5 == 0)) / largest);
+		}
+	}
+}
+
+static void test_math_checkPoints(Blah_Matrix *matrix, int pointCount)
+{	//Checks transforming an array of random points and vectors, in place and into another array
+	const float *elements = (float*)matrix;
+	Blah_Point points[TEST_MATH_MAX_POINTS], transformed[TEST_MATH_MAX_POINTS];
+
+	for (int index = 0; index < TEST_MATH_MAX_POINTS; index++) {
+		points[index] = (Blah_Point){test_math_random(), test_math_random(), test_math_random()};
+	}
+
+	blah_math_transformPoints(transformed, points, pointCount, matrix);
+	for (int index = 0; index < pointCount; index++) {
+		float expected[3] = {points[index].x, points[index].y, points[index].z};
+		test_math_scalarTransformPoint(expected, elements);
+		TEST_MATH_CHECK(memcmp(expected, &transformed[index], sizeof(expected)) == 0, "point %d of %d differs\n", index, pointCount);
+	}
+
+	memcpy(transformed, points, sizeof(points));
+	blah_math_transformPoints(transformed, transformed, pointCount, matrix);
+	for (int index = 0; index < TEST_MATH_MAX_POINTS; index++) {
+		float expected[3] = {points[index].x, points[index].y, points[index].z};
+		if (index < pointCount) { test_math_scalarTransformPoint(expected, elements); } //Points past the count are untouched
+		TEST_MATH_CHECK(memcmp(expected, &transformed[index], sizeof(expected)) == 0, "point %d of %d differs in place\n", index, pointCount);
+	}
+
+	blah_math_transformVectors((Blah_Vector*)transformed, (Blah_Vector*)points, pointCount, matrix);
+	for (int index = 0; index < pointCount; index++) {
+		for (int row = 0; row < 3; row++) {
+			const float expected = elements[row] * points[index].x + elements[row + 4] * points[index].y + elements[row + 8] * points[index].z;
+			TEST_MATH_CHECK(expected == ((float*)&transformed[index])[row], "vector %d of %d differs\n", index, pointCount);
+		}
+	}
+}
+
+static void test_math_checkQuaternions()
+{	//Checks multiplying, normalising and interpolating random quaternions
+	Blah_Quaternion quat1 = {test_math_random(), test_math_random(), test_math_random(), test_math_random()};
+	Blah_Quaternion quat2 = {test_math_random(), test_math_random(), test_math_random(), test_math_random()};
+	Blah_Quaternion expected = quat1, product, interpolated;
+	const float amount = (float)rand() / RAND_MAX;
+
+	test_math_scalarMultiplyQuaternions(&expected, &quat2);
+	blah_math_multiplyQuaternions(&product, &quat1, &quat2);
+	TEST_MATH_CHECK(memcmp(&expected, &product, sizeof(Blah_Quaternion)) == 0, "quaternion multiply differs\n");
+
+	blah_math_normaliseQuaternion(&quat1);
+	blah_math_normaliseQuaternion(&quat2);
+	TEST_MATH_CHECK(fabs(sqrt(quat1.x * quat1.x + quat1.y * quat1.y + quat1.z * quat1.z + quat1.w * quat1.w) - 1) < 1e-6,
+		"normalised quaternion is not unit length\n");
+
+	blah_math_slerpQuaternions(&interpolated, &quat1, &quat2, amount);
+	{	//Reference slerp in double precision along the shorter arc
+		double dot = quat1.x * quat2.x + quat1.y * quat2.y + quat1.z * quat2.z + quat1.w * quat2.w;
+		const double sign = dot < 0 ? -1 : 1;
+		dot = fabs(dot);
+		const double angle = acos(fmin(dot, 1));
+		const double weight1 = angle > 1e-3 ? sin((1 - amount) * angle) / sin(angle) : 1 - amount;
+		const double weight2 = (angle > 1e-3 ? sin(amount * angle) / sin(angle) : amount) * sign;
+		double reference[4] = {quat1.x * weight1 + quat2.x * weight2, quat1.y * weight1 + quat2.y * weight2,
+			quat1.z * weight1 + quat2.z * weight2, quat1.w * weight1 + quat2.w * weight2};
+		const double length = sqrt(reference[0] * reference[0] + reference[1] * reference[1]
+			+ reference[2] * reference[2] + reference[3] * reference[3]);
+		for (int index = 0; index < 4; index++) {
+			TEST_MATH_CHECK(fabs(((float*)&interpolated)[index] - reference[index] / length) < 1e-4, "slerp differs in element %d\n", index);
+		}
+	}
+}
+
+/* Main */
+
+int main()
+{
+	double maxInverseError = 0;
+
+	srand(1);
+	for (int iteration = 0; iteration < TEST_MATH_ITERATIONS; iteration++) {
+		Blah_Matrix left, right;
+		test_math_randomMatrix(&left);
+		test_math_randomMatrix(&right);
+		test_math_checkMatrices(&left, &right, &maxInverseError);
+		test_math_checkPoints(&left, iteration % (TEST_MATH_MAX_POINTS + 1));
+		test_math_checkQuaternions();
+	}
+	TEST_MATH_CHECK(maxInverseError < 1e-3, "inverse error %g too large\n", maxInverseError);
+
+	{	//A singular matrix is not inverted, and is left unchanged when inverted in place
+		Blah_Matrix singular = {{1, 2, 3}, 4, {2, 4, 6}, 8, {0, 1, 0}, 0, {0, 0, 0}, 1}, original = singular;
+		TEST_MATH_CHECK(!blah_math_invertMatrix(&singular, &singular), "singular matrix inverted\n");
+		TEST_MATH_CHECK(memcmp(&singular, &original, sizeof(Blah_Matrix)) == 0, "singular matrix changed\n");
+	}
+
+	{	//Half way between no rotation and two radians about z is one radian
+		Blah_Quaternion identity = {0, 0, 0, 1}, rotation = {0, 0, sinf(1.0f), cosf(1.0f)}, halfway;
+		blah_math_slerpQuaternions(&halfway, &identity, &rotation, 0.5f);
+		TEST_MATH_CHECK(fabsf(halfway.z - sinf(0.5f)) < 1e-6 && fabsf(halfway.w - cosf(0.5f)) < 1e-6, "slerp midpoint wrong\n");
+	}
+
+	printf("test_math: %d failures, largest inverse error %.2g\n", failures, maxInverseError);
+	return failures != 0;
+}
@@ -0,0 +1,235 @@
+/* test_targa.c
+	Fuzzes the targa decoder of blah_image_targa.c, including Blah_Image_Targa_decodeRLEPixels, with
+	random images of each supported type, many of them corrupted, truncated or extended.  Each is
+	decoded from memory and through a stream with a small buffer, and the result is compared with a
+	plain per pixel reference decoder which accepts and rejects the same data.  A stream reader is
+	also checked to reject a view past the end of its data without growing its buffer.  Build with
+	SANITIZE=1 to also catch reads and writes out of bounds.  Returns nonzero if any check fails. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blah_file.h"
+#include "blah_image.h"
+#include "blah_image_targa.h"
+
+/* Definitions */
+
+#define TEST_TARGA_IMAGES 200000
+#define TEST_TARGA_MAX_SIDE 24		//Largest width and height, small so that many runs cross rows
+#define TEST_TARGA_HEADER_LENGTH 18
+
+#define TEST_TARGA_CHECK(condition, ...) do { if (!(condition)) { \
+	if (failures++ < 20) { printf(__VA_ARGS__); } } } while (0)
+	//Counts a failure, printing only the first few
+
+/* Static Globals */
+
+static int failures = 0;
+
+/* Static Functions */
+
+static int test_targa_random(int count)
+{	//Returns a random number from 0 to count-1
+	return rand() % count;
+}
+
+static void test_targa_put16(uint8_t *dest, unsigned int value)
+{	//Stores a 16 bit value least significant byte first
+	dest[0] = value & 255;
+	dest[1] = value >> 8;
+}
+
+static size_t test_targa_generate(uint8_t *data)
+{	//Writes a random targa image of a supported type, with the header fields in range, and returns its length
+	static const uint8_t types[] = {BLAH_IMAGE_TARGA_MAPPED, BLAH_IMAGE_TARGA_RGB, BLAH_IMAGE_TARGA_RLE_MAPPED, BLAH_IMAGE_TARGA_RLE_RGB};
+	const uint8_t type = types[test_targa_random(4)];
+	const bool mapped = type == BLAH_IMAGE_TARGA_MAPPED || type == BLAH_IMAGE_TARGA_RLE_MAPPED;
+	const bool encoded = type == BLAH_IMAGE_TARGA_RLE_MAPPED || type == BLAH_IMAGE_TARGA_RLE_RGB;
+	const unsigned int width = test_targa_random(TEST_TARGA_MAX_SIDE + 1), height = test_targa_random(TEST_TARGA_MAX_SIDE + 1);
+	const unsigned int idLength = test_targa_random(4) ? 0 : test_targa_random(8);
+	const unsigned int mapCount = mapped || test_targa_random(4) == 0 ? 1 + test_targa_random(300) : 0;
+	const unsigned int mapOrigin = mapped ? test_targa_random(3) : 0;
+	const unsigned int mapEntrySize = test_targa_random(2) ? 24 : 32;
+	const unsigned int pixelSize = mapped ? (test_targa_random(4) ? 8 : 16) : (test_targa_random(2) ? 24 : 32);
+	const size_t pixelByteSize = pixelSize / 8;
+	const size_t numPixels = (size_t)width * height;
+	size_t length = TEST_TARGA_HEADER_LENGTH;
+
+	data[0] = idLength;
+	data[1] = mapCount ? 1 : 0;
+	data[2] = type;
+	test_targa_put16(data + 3, mapOrigin);
+	test_targa_put16(data + 5, mapCount);
+	data[7] = mapCount ? mapEntrySize : 0;
+	test_targa_put16(data + 8, 0);
+	test_targa_put16(data + 10, 0);
+	test_targa_put16(data + 12, width);
+	test_targa_put16(data + 14, height);
+	data[16] = pixelSize;
+	data[17] = 0;
+	for (size_t index = 0; index < idLength + mapCount * (mapEntrySize / 8); index++) { data[length++] = rand(); }
+
+	for (size_t pixel = 0; pixel < numPixels;) {
+		size_t runLength = 1, dataPixels;
+		if (encoded) { //Packet header, then one pixel for a repeat or runLength pixels for a raw run
+			const bool repeat = test_targa_random(2);
+			runLength = 1 + test_targa_random(128);
+			if (runLength > numPixels - pixel) { runLength = numPixels - pixel; }
+			data[length++] = (repeat ? 128 : 0) | (runLength - 1);
+			dataPixels = repeat ? 1 : runLength;
+		} else {
+			dataPixels = 1;
+		}
+		for (size_t index = 0; index < dataPixels; index++) {
+			if (mapped) { //Indices mostly within the map
+				const unsigned int mapIndex = test_targa_random(mapCount < 256 ? mapCount : 256);
+				data[length++] = mapIndex;
+				if (pixelByteSize == 2) { data[length++] = 0; }
+			} else {
+				for (size_t byte = 0; byte < pixelByteSize; byte++) { data[length++] = rand(); }
+			}
+		}
+		pixel += runLength;
+	}
+	return length;
+}
+
+static size_t test_targa_mutate(uint8_t *data, size_t length)
+{	//Corrupts, truncates or extends the image one time in four each, returning the new length
+	switch (test_targa_random(4)) {
+		case 1 :
+			if (length) { data[test_targa_random(length)] = rand(); }
+			break;
+		case 2 :
+			if (length) { length = test_targa_random(length); }
+			break;
+		case 3 :
+			data[length++] = rand();
+			break;
+	}
+	return length;
+}
+
+static size_t test_targa_get16(const uint8_t *source)
+{	//Returns a 16 bit value stored least significant byte first
+	return source[0] | (source[1] << 8);
+}
+
+static uint8_t *test_targa_reference(const uint8_t *data, size_t length, size_t *rasterLength)
+{	//Decodes the image a pixel at a time, returning its raster, or NULL wherever the engine must fail
+	if (length < TEST_TARGA_HEADER_LENGTH) { return NULL; }
+	const uint8_t type = data[2];
+	const bool mapped = type == BLAH_IMAGE_TARGA_MAPPED || type == BLAH_IMAGE_TARGA_RLE_MAPPED;
+	const bool encoded = type == BLAH_IMAGE_TARGA_RLE_MAPPED || type == BLAH_IMAGE_TARGA_RLE_RGB;
+	const size_t mapOrigin = test_targa_get16(data + 3), mapCount = test_targa_get16(data + 5);
+	const size_t mapEntryByteSize = data[7] / 8, pixelByteSize = data[16] / 8;
+	const size_t numPixels = test_targa_get16(data + 12) * test_targa_get16(data + 14);
+	const size_t rasterByteSize = mapped ? mapEntryByteSize : pixelByteSize;
+	size_t offset = TEST_TARGA_HEADER_LENGTH + data[0];
+	const uint8_t *colourMap;
+	uint8_t *raster;
+
+	if (!mapped && !encoded && type != BLAH_IMAGE_TARGA_RGB) { return NULL; }
+	if (mapped && (mapCount == 0 || (data[7] != 24 && data[7] != 32) || pixelByteSize == 0 || pixelByteSize > 2)) { return NULL; }
+	if (!mapped && data[16] != 24 && data[16] != 32) { return NULL; }
+	colourMap = data + offset;
+	offset += mapCount * (mapped || data[1] ? mapEntryByteSize : 0); //Maps of RGB images are skipped
+	if (offset > length) { return NULL; }
+	*rasterLength = numPixels * rasterByteSize;
+	raster = malloc(*rasterLength + 1);
+
+	for (size_t pixel = 0; pixel < numPixels;) {
+		size_t runLength = 1;
+		bool repeat = false;
+		if (encoded) {
+			if (offset >= length) { free(raster); return NULL; }
+			repeat = data[offset] & 128;
+			runLength = (data[offset++] & 127) + 1;
+			if (runLength > numPixels - pixel) { free(raster); return NULL; }
+		}
+		const size_t dataLength = (repeat ? 1 : runLength) * pixelByteSize;
+		if (length - offset < dataLength) { free(raster); return NULL; }
+		for (size_t index = 0; index < runLength; index++) {
+			const uint8_t *source = data + offset + (repeat ? 0 : index * pixelByteSize);
+			if (mapped) {
+				const size_t mapIndex = (pixelByteSize == 2 ? test_targa_get16(source) : source[0]) + mapOrigin;
+				if (mapIndex >= mapCount) { free(raster); return NULL; }
+				source = colourMap + mapIndex * mapEntryByteSize;
+			}
+			memcpy(raster + (pixel + index) * rasterByteSize, source, rasterByteSize);
+		}
+		offset += dataLength;
+		pixel += runLength;
+	}
+	return raster;
+}
+
+static void test_targa_compare(Blah_Image *image, const uint8_t *expected, size_t expectedLength, const char *backend, int imageNumber)
+{	//Checks a decoded image, or its failure, against the reference
+	TEST_TARGA_CHECK((image != NULL) == (expected != NULL), "image %d %s from %s reader\n", imageNumber,
+		image ? "accepted" : "rejected", backend);
+	if (image && expected) {
+		TEST_TARGA_CHECK((size_t)image->width * image->height * (image->pixelDepth / 8) == expectedLength
+			&& memcmp(image->pixelData, expected, expectedLength) == 0, "image %d decoded wrongly from %s reader\n", imageNumber, backend);
+	}
+	if (image) { Blah_Image_destroy(image); }
+}
+
+/* Main */
+
+int main()
+{
+	const size_t dataCapacity = TEST_TARGA_HEADER_LENGTH + 8 + 300 * 4 + TEST_TARGA_MAX_SIDE * TEST_TARGA_MAX_SIDE * 5 + 1;
+	uint8_t *data = malloc(dataCapacity);
+	long accepted = 0;
+
+	srand(11);
+	for (int imageNumber = 0; imageNumber < TEST_TARGA_IMAGES; imageNumber++) {
+		const size_t length = test_targa_mutate(data, test_targa_generate(data));
+		uint8_t *copy = malloc(length ? length : 1); //Exactly the data's size, so overreads are caught
+		size_t expectedLength = 0;
+		uint8_t *expected;
+		Blah_File_Reader reader;
+		FILE *stream;
+
+		memcpy(copy, data, length);
+		expected = test_targa_reference(copy, length, &expectedLength);
+		if (expected) { accepted++; }
+
+		Blah_File_Reader_initMemory(&reader, copy, length);
+		test_targa_compare(Blah_Image_Targa_fromReader("fuzz", &reader), expected, expectedLength, "memory", imageNumber);
+		Blah_File_Reader_close(&reader);
+
+		stream = length ? fmemopen(copy, length, "rb") : tmpfile();
+		if (stream && Blah_File_Reader_initStream(&reader, stream, 1 + test_targa_random(64))) {
+			test_targa_compare(Blah_Image_Targa_fromReader("fuzz", &reader), expected, expectedLength, "stream", imageNumber);
+			Blah_File_Reader_close(&reader);
+		}
+		if (stream) { fclose(stream); }
+		free(expected);
+		free(copy);
+	}
+
+	{	//A view longer than the rest of the stream fails without growing the buffer to its length
+		static const uint8_t bytes[] = {1, 2, 3, 4, 5, 6, 7, 8};
+		Blah_File_Reader reader, view;
+		blah_unsigned8 first;
+		FILE *stream = fmemopen((void*)bytes, sizeof(bytes), "rb");
+
+		if (stream && Blah_File_Reader_initStream(&reader, stream, 4)) {
+			Blah_File_Reader_readUnsigned8(&reader, &first);
+			TEST_TARGA_CHECK(!Blah_File_Reader_getView(&reader, 0xfffffff0u, &view) && reader.bufferSize == 4 &&
+				Blah_File_Reader_getOffset(&reader) == 1, "stream view past end of data was not rejected\n");
+			TEST_TARGA_CHECK(Blah_File_Reader_getView(&reader, 7, &view) && Blah_File_Reader_getOffset(&reader) == 8,
+				"stream view of the rest of the data failed\n");
+			Blah_File_Reader_close(&reader);
+		}
+		if (stream) { fclose(stream); }
+	}
+	free(data);
+
+	printf("test_targa: %d failures, %ld of %d images valid\n", failures, accepted, TEST_TARGA_IMAGES);
+	return failures != 0;
+}
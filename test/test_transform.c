@@ -0,0 +1,182 @@
+/* test_transform.c
+	Checks the transform hierarchy of blah_transform.h.  After random additions, removals, moves and
+	local matrix changes, every world matrix must equal the product of its parent's world matrix and
+	its local matrix, and every parent must match a copy kept by the test.  Tearing down a large
+	hierarchy must take time linear in its size.  Returns nonzero if any check fails. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blah_math.h"
+#include "blah_time.h"
+#include "blah_transform.h"
+
+/* Definitions */
+
+#define TEST_TRANSFORM_NODES 500		//Largest number of nodes in the random hierarchy
+#define TEST_TRANSFORM_STEPS 20000		//Random operations on the hierarchy
+#define TEST_TRANSFORM_ENTITIES 50000	//Root nodes of the hierarchy torn down, each with three children
+#define TEST_TRANSFORM_TEARDOWN_LIMIT 1000000000	//Nanoseconds allowed for teardown, far beyond linear time
+
+#define TEST_TRANSFORM_CHECK(condition, ...) do { if (!(condition)) { \
+	if (failures++ < 20) { printf(__VA_ARGS__); } } } while (0)
+	//Counts a failure, printing only the first few
+
+/* Static Globals */
+
+static int failures = 0;
+static long nodes[TEST_TRANSFORM_NODES];	//Indices of the nodes in use by the random test
+static long parents[TEST_TRANSFORM_NODES];	//Expected parent of each node, as a position in nodes
+static Blah_Matrix locals[TEST_TRANSFORM_NODES];
+static int nodeCount = 0;
+
+/* Static Functions */
+
+static Blah_Matrix test_transform_translation(float x, float y, float z)
+{	//Returns a matrix translating by x, y and z
+	Blah_Matrix matrix;
+	Blah_Matrix_setIdentity(&matrix);
+	Blah_Matrix_setTranslation(&matrix, x, y, z);
+	return matrix;
+}
+
+static int test_transform_random(int count)
+{	//Returns a random number from 0 to count-1
+	return rand() % count;
+}
+
+static bool test_transform_isAncestor(int ancestor, int position)
+{	//Returns true if the node at ancestor is the node at position or one of its ancestors
+	for (; position != -1; position = parents[position]) {
+		if (position == ancestor) { return true; }
+	}
+	return false;
+}
+
+static int test_transform_find(long node)
+{	//Returns the position in nodes of the given node
+	for (int position = 0; position < nodeCount; position++) {
+		if (nodes[position] == node) { return position; }
+	}
+	return -1;
+}
+
+static void test_transform_randomStep()
+{	//Adds, removes, moves or changes the local matrix of a random node
+	const int operation = nodeCount < 2 ? 0 : test_transform_random(4);
+	const int position = nodeCount ? test_transform_random(nodeCount) : 0;
+
+	if (operation == 0 && nodeCount < TEST_TRANSFORM_NODES) { //Add
+		const int parent = nodeCount && test_transform_random(4) ? test_transform_random(nodeCount) : -1;
+		nodes[nodeCount] = blah_transform_add(parent == -1 ? BLAH_TRANSFORM_NONE : nodes[parent]);
+		parents[nodeCount] = parent;
+		Blah_Matrix_setIdentity(&locals[nodeCount]);
+		nodeCount++;
+	} else if (operation == 1) { //Remove, making the children root nodes
+		blah_transform_remove(nodes[position]);
+		nodeCount--;
+		for (int child = 0; child < nodeCount + 1; child++) {
+			if (parents[child] == position) { parents[child] = -1; }
+		}
+		nodes[position] = nodes[nodeCount]; //Move the last node into the gap
+		parents[position] = parents[nodeCount];
+		locals[position] = locals[nodeCount];
+		for (int child = 0; child < nodeCount; child++) {
+			if (parents[child] == nodeCount) { parents[child] = position; }
+		}
+	} else if (operation == 2) { //Move, refused if it would make a cycle
+		const int parent = test_transform_random(4) ? test_transform_random(nodeCount) : -1;
+		const bool cycle = parent != -1 && test_transform_isAncestor(position, parent);
+		TEST_TRANSFORM_CHECK(blah_transform_setParent(nodes[position], parent == -1 ? BLAH_TRANSFORM_NONE : nodes[parent]) == !cycle,
+			"setParent %s a cycle\n", cycle ? "allowed" : "refused");
+		if (!cycle) { parents[position] = parent; }
+	} else if (nodeCount) { //Change local matrix
+		locals[position] = test_transform_translation(test_transform_random(9) - 4, test_transform_random(9) - 4, test_transform_random(9) - 4);
+		blah_transform_setLocal(nodes[position], &locals[position]);
+	}
+}
+
+static void test_transform_checkAll()
+{	//Checks the parent and world matrix of every node against the test's own copy
+	for (int position = 0; position < nodeCount; position++) {
+		const long parent = blah_transform_getParent(nodes[position]);
+		Blah_Matrix expected = locals[position];
+		TEST_TRANSFORM_CHECK(test_transform_find(parent) == parents[position], "parent of node %ld wrong\n", nodes[position]);
+		if (parents[position] != -1) { blah_math_multiplyMatrices(&expected, blah_transform_getWorld(nodes[parents[position]]), &locals[position]); }
+		TEST_TRANSFORM_CHECK(memcmp(&expected, blah_transform_getWorld(nodes[position]), sizeof(Blah_Matrix)) == 0,
+			"world matrix of node %ld wrong\n", nodes[position]);
+	}
+}
+
+static void test_transform_checkChain()
+{	//Checks a chain of three nodes, recalculating only what has changed
+	const long root = blah_transform_add(BLAH_TRANSFORM_NONE), middle = blah_transform_add(root), leaf = blah_transform_add(middle);
+	Blah_Matrix matrix;
+
+	matrix = test_transform_translation(1, 0, 0); blah_transform_setLocal(root, &matrix);
+	matrix = test_transform_translation(0, 2, 0); blah_transform_setLocal(middle, &matrix);
+	matrix = test_transform_translation(0, 0, 3); blah_transform_setLocal(leaf, &matrix);
+	TEST_TRANSFORM_CHECK(blah_transform_update() == 3, "chain not calculated\n");
+	TEST_TRANSFORM_CHECK(blah_transform_getWorld(leaf)->location.x == 1 && blah_transform_getWorld(leaf)->location.y == 2
+		&& blah_transform_getWorld(leaf)->location.z == 3, "chain world matrix wrong\n");
+	TEST_TRANSFORM_CHECK(blah_transform_update() == 0, "unchanged chain recalculated\n");
+	TEST_TRANSFORM_CHECK(!blah_transform_setLocal(leaf, &matrix) && blah_transform_update() == 0, "same local matrix recalculated\n");
+	matrix = test_transform_translation(0, 5, 0); blah_transform_setLocal(middle, &matrix);
+	TEST_TRANSFORM_CHECK(blah_transform_update() == 2, "only middle and leaf should be recalculated\n");
+
+	blah_transform_remove(middle);
+	TEST_TRANSFORM_CHECK(blah_transform_getParent(leaf) == BLAH_TRANSFORM_NONE, "child of removed node not made root\n");
+	TEST_TRANSFORM_CHECK(blah_transform_update() == 1 && blah_transform_getWorld(leaf)->location.z == 3
+		&& blah_transform_getWorld(leaf)->location.x == 0, "child of removed node not recalculated\n");
+	TEST_TRANSFORM_CHECK(blah_transform_add(root) == middle, "slot of removed node not reused\n");
+	blah_transform_destroyAll();
+}
+
+static void test_transform_checkTeardown()
+{	//Times removing every node of a hierarchy of entities with three objects each
+	const size_t nodeTotal = TEST_TRANSFORM_ENTITIES * 4;
+	long *entities = malloc(nodeTotal * sizeof(long)); //Each entity followed by its objects
+	uint64_t startTime;
+
+	if (entities == NULL) { failures++; return; }
+	for (size_t entity = 0; entity < nodeTotal; entity += 4) {
+		entities[entity] = blah_transform_add(BLAH_TRANSFORM_NONE);
+		for (int object = 1; object <= 3; object++) { entities[entity + object] = blah_transform_add(entities[entity]); }
+	}
+	blah_transform_update();
+
+	startTime = blah_time_getNanoseconds();
+	for (size_t node = 0; node < nodeTotal; node++) { //Entity first, then its objects, as Blah_Entity_disable does
+		blah_transform_remove(entities[node]);
+	}
+	const uint64_t elapsed = blah_time_getNanoseconds() - startTime;
+	TEST_TRANSFORM_CHECK(blah_transform_update() == 0, "removed nodes recalculated\n");
+	TEST_TRANSFORM_CHECK(elapsed < TEST_TRANSFORM_TEARDOWN_LIMIT, "teardown of %zu nodes took %llu ns\n",
+		nodeTotal, (unsigned long long)elapsed);
+	printf("test_transform: removed %zu nodes in %.2f ms\n", nodeTotal, elapsed / 1e6);
+	blah_transform_destroyAll();
+	free(entities);
+}
+
+/* Main */
+
+int main()
+{
+	test_transform_checkChain();
+
+	srand(1);
+	for (int step = 0; step < TEST_TRANSFORM_STEPS; step++) {
+		test_transform_randomStep();
+		if (step % 10 == 0) {
+			blah_transform_update();
+			test_transform_checkAll();
+		}
+	}
+	blah_transform_destroyAll();
+
+	test_transform_checkTeardown();
+
+	printf("test_transform: %d failures\n", failures);
+	return failures != 0;
+}